@@ -0,0 +1,825 @@
+/*  dawinfo_benchmarks: timings for the sender's hot paths, as a table and
+    optionally as JSON for Tools/compare_benchmarks.py.
+
+        dawinfo_benchmarks [--json <file>] [--filter <text>] [--quick]
+
+    Each benchmark is calibrated to run for a fixed time per sample, sampled
+    several times, and reported as the median (and fastest) time per
+    operation. --quick cuts the run time down for smoke testing; its numbers
+    aren't meant for comparison.
+*/
+
+#include "Common/Clock.h"
+#include "Common/Config.h"
+#include "Common/Mapping.h"
+#include "Common/Messages.h"
+#include "Common/Simd.h"
+#include "Common/SpscRing.h"
+#include "Receiver/TransportClock.h"
+#include "Sender/AnalysisInput.h"
+#include "Sender/ConfigManager.h"
+#include "Sender/FramePublisher.h"
+#include "Sender/MetadataCache.h"
+#include "Sender/MidiForwarder.h"
+#include "Sender/ParameterObserver.h"
+#include "Sender/QualityGovernor.h"
+#include "Sender/StereoImageMeter.h"
+#include "Sender/WaveformPublisher.h"
+
+#if DAWINFO_BENCHMARK_SOCKETS
+ #include "Sender/ControlChannel.h"
+ #include "Sender/WebSocketServer.h"
+#endif
+
+#if defined (__GLIBC__)
+ #include <malloc.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    struct Result
+    {
+        std::string name, unit;
+        double nsPerOp = 0, minNsPerOp = 0;
+        std::uint64_t iterations = 0;
+    };
+
+    struct Settings
+    {
+        HostTimeNs sampleNs = 50000000;
+        int numSamples = 7;
+        std::string filter;
+    };
+
+    Settings settings;
+    std::vector<Result> results;
+
+    /** Keeps a value alive so the work producing it isn't optimised away. */
+    volatile std::uint64_t sinkHole = 0;
+
+    template <typename T>
+    void keep (const T& value)
+    {
+        std::uint64_t bits = 0;
+        std::memcpy (&bits, &value, std::min (sizeof (bits), sizeof (T)));
+        sinkHole = sinkHole + bits;
+    }
+
+    /** body (n) performs n operations. */
+    template <typename Body>
+    void run (const char* name, const char* unit, Body&& body)
+    {
+        if (! settings.filter.empty() && std::string (name).find (settings.filter) == std::string::npos)
+            return;
+
+        // Grow the batch until one takes a tenth of a sample.
+        std::uint64_t n = 1;
+
+        for (;;)
+        {
+            const auto t0 = monotonicNowNs();
+            body (n);
+            const auto elapsed = monotonicNowNs() - t0;
+
+            if (elapsed * 10 >= settings.sampleNs || n >= (1ull << 40))
+            {
+                n = std::max<std::uint64_t> (1, static_cast<std::uint64_t> (static_cast<double> (n) * settings.sampleNs
+                                                                               / static_cast<double> (std::max<HostTimeNs> (elapsed, 1))));
+                break;
+            }
+
+            n *= 4;
+        }
+
+        std::vector<double> samples;
+
+        for (int s = 0; s < settings.numSamples; ++s)
+        {
+            const auto t0 = monotonicNowNs();
+            body (n);
+            samples.push_back (static_cast<double> (monotonicNowNs() - t0) / static_cast<double> (n));
+        }
+
+        std::sort (samples.begin(), samples.end());
+        results.push_back ({ name, unit, samples[samples.size() / 2], samples.front(), n });
+        std::printf ("  %-34s %12.1f ns/%-8s (min %.1f)\n", name, samples[samples.size() / 2], unit, samples.front());
+        std::fflush (stdout);
+    }
+
+    struct NullSink : PacketSink
+    {
+        std::size_t bytes = 0;
+
+        bool send (const std::uint8_t*, std::size_t size) override
+        {
+            bytes += size;
+            return true;
+        }
+    };
+
+    TransportSnapshot exampleTransport()
+    {
+        TransportSnapshot t;
+        t.timeNs = 123456789;
+        t.ppq = 17.25;
+        t.bpm = 128.0;
+        t.barStartPpq = 16.0;
+        t.barNumber = 4;
+        t.isPlaying = true;
+        return t;
+    }
+
+    //==============================================================================
+    void encoding()
+    {
+        std::uint8_t buffer[256];
+        const auto t = exampleTransport();
+
+        run ("encode/transport_schema", "message", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                OscWriter w (buffer, sizeof (buffer));
+                schema::Codec<messages::Transport>::write (w, t);
+                keep (buffer[40]);
+            }
+        });
+
+        run ("encode/transport_generic", "message", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                OscWriter w (buffer, sizeof (buffer));
+                w.beginMessage (messages::Transport::address, "hdddiiiiidd");
+                w.addInt64 (t.timeNs);
+                w.addFloat64 (t.ppq);
+                w.addFloat64 (t.bpm);
+                w.addFloat64 (t.barStartPpq);
+                w.addInt32 (t.barNumber);
+                w.addInt32 (t.timeSigNumerator);
+                w.addInt32 (t.timeSigDenominator);
+                w.addInt32 (t.isPlaying);
+                w.addInt32 (t.isLooping);
+                w.addFloat64 (t.loopStartPpq);
+                w.addFloat64 (t.loopEndPpq);
+                w.endMessage();
+                keep (buffer[40]);
+            }
+        });
+
+        OscWriter w (buffer, sizeof (buffer));
+        schema::Codec<messages::Transport>::write (w, t);
+        const auto size = w.getSize();
+
+        run ("decode/transport_schema", "message", [&] (std::uint64_t n)
+        {
+            TransportSnapshot out;
+
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                schema::Codec<messages::Transport>::decode (buffer, size, out);
+                keep (out.ppq);
+            }
+        });
+
+        run ("decode/transport_generic", "message", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                OscMessage m;
+                parseOscMessage (buffer, size, m);
+                OscArgumentReader r (m);
+                std::int64_t timeNs = 0;
+                double ppq = 0;
+                r.readInt64 (timeNs);
+                r.readFloat64 (ppq);
+                keep (ppq);
+            }
+        });
+    }
+
+    void batching()
+    {
+        NullSink sink;
+        StreamSequencer seq;
+        PacketBatcher batcher (StreamId::midi, 1400);
+
+        run ("batch/midi_messages", "message", [&] (std::uint64_t n)
+        {
+            batcher.begin (sink, seq);
+
+            for (std::uint64_t i = 0; i < n; ++i)
+                batcher.add<messages::Midi> ({ static_cast<HostTimeNs> (i), 0x90, 60, 100 });
+
+            keep (batcher.end());
+        });
+
+        MidiForwarder forwarder;
+        const BlockMidiEvent block[] = { { 0, { 0x90, 60, 100 }, 3 }, { 64, { 0xb0, 1, 10 }, 3 },
+                                         { 128, { 0xb0, 1, 20 }, 3 }, { 200, { 0x80, 60, 0 }, 3 } };
+
+        run ("batch/midi_forward_block", "block", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                forwarder.pushBlock (block, 4, static_cast<HostTimeNs> (i) * 5333333, 48000.0);
+                keep (forwarder.forward (sink, seq, static_cast<HostTimeNs> (i) * 5333333));
+            }
+        });
+    }
+
+    void rings()
+    {
+        SpscRing<MidiEvent> ring (1024);
+
+        run ("ring/spsc_same_thread", "item", [&] (std::uint64_t n)
+        {
+            MidiEvent e;
+
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                ring.push ({ static_cast<HostTimeNs> (i), 0x90, 1, 2 });
+                ring.pop (e);
+            }
+
+            keep (e.timeNs);
+        });
+
+        run ("ring/spsc_cross_thread", "item", [&] (std::uint64_t n)
+        {
+            std::thread consumer ([&]
+            {
+                MidiEvent e;
+
+                for (std::uint64_t got = 0; got < n;)
+                {
+                    if (ring.pop (e))
+                        ++got;
+                    else
+                        std::this_thread::yield();
+                }
+            });
+
+            for (std::uint64_t i = 0; i < n;)
+            {
+                if (ring.push ({ static_cast<HostTimeNs> (i), 0x90, 1, 2 }))
+                    ++i;
+                else
+                    std::this_thread::yield();
+            }
+
+            consumer.join();
+        });
+
+        FramePublisher publisher (16, 2);
+        std::vector<NullSink> receivers (8);
+        PacketSink* sinks[8];
+
+        for (int i = 0; i < 8; ++i)
+            sinks[i] = &receivers[static_cast<std::size_t> (i)];
+
+        StreamSequencer seq;
+        const auto t = exampleTransport();
+
+        run ("publish/frame_cycle_8_sinks", "cycle", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                auto* f = publisher.beginFrame();
+                f->transport = t;
+
+                if (i % 32 == 0)
+                    f->addEvent (EventType::beat, static_cast<HostTimeNs> (i));
+
+                publisher.submitFrame (f);
+                keep (publisher.publish (sinks, 8, seq));
+            }
+        });
+    }
+
+    void metering()
+    {
+        constexpr int blockSize = 512;
+        std::vector<float> left (blockSize), right (blockSize);
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            left[static_cast<std::size_t> (i)] = std::sin (static_cast<float> (i) * 0.05f);
+            right[static_cast<std::size_t> (i)] = 0.5f * std::cos (static_cast<float> (i) * 0.031f);
+        }
+
+        const float* channels[] = { left.data(), right.data() };
+        WaveformPublisher waveform (2);
+        waveform.prepare();
+
+        run ("metering/peak_block_stereo_512", "block", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                waveform.pushBlock (channels, 2, blockSize);
+
+                if (i % 8 == 7)
+                    waveform.update();
+            }
+
+            waveform.update();
+        });
+
+        // The stereo image meter's kernel against its reference, then the
+        // whole meter with its vectorscope reservoir, a frame every 1.5 blocks.
+        run ("metering/stereo_sums_512", "block", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+                keep (kernels::stereoSums (left.data(), right.data(), blockSize).lr);
+        });
+
+        run ("metering/stereo_sums_512_scalar", "block", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+                keep (kernels::scalar::stereoSums (left.data(), right.data(), blockSize).lr);
+        });
+
+        StereoImageMeter stereo;
+        StereoImageMeter::Frame stereoFrame;
+
+        run ("metering/stereo_image_512", "block", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                stereo.process (left.data(), right.data(), blockSize);
+
+                if (i % 3 != 0)
+                {
+                    stereo.endFrame (static_cast<HostTimeNs> (i), stereoFrame);
+                    keep (stereoFrame.meter.correlation);
+                }
+            }
+        });
+
+        ParameterObserver parameters (64);
+        NullSink sink;
+        StreamSequencer seq;
+
+        run ("metering/parameters_64_block", "block", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                const auto timeNs = static_cast<HostTimeNs> (i) * 10666666;
+
+                for (int p = 0; p < 64; ++p)
+                    parameters.observe (p, 0.5f + 0.4f * std::sin (static_cast<float> (i) * 0.01f + static_cast<float> (p)), timeNs);
+
+                if (i % 4 == 3)
+                    keep (parameters.publish (sink, seq, timeNs));
+            }
+        });
+
+        TransportClock clock;
+        auto t = exampleTransport();
+
+        run ("receiver/transport_clock_update", "snapshot", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                t.timeNs += 10666666;
+                t.ppq += 10666666 * t.bpm / 60.0e9;
+                clock.update (t);
+                keep (clock.ppqAt (t.timeNs + 1000000));
+            }
+        });
+    }
+
+    /** SIMD kernels against their scalar references, per 512-frame block,
+        then the whole analysis input from each host rate.
+    */
+    void conversion()
+    {
+        constexpr int blockSize = 512;
+        std::vector<std::vector<float>> host (12, std::vector<float> (blockSize));
+        std::vector<const float*> channels;
+
+        for (std::size_t c = 0; c < host.size(); ++c)
+        {
+            for (int i = 0; i < blockSize; ++i)
+                host[c][static_cast<std::size_t> (i)] = std::sin (static_cast<float> (i) * 0.01f * static_cast<float> (c + 1));
+
+            channels.push_back (host[c].data());
+        }
+
+        std::vector<float> left (blockSize), right (blockSize);
+        float* out[] = { left.data(), right.data() };
+
+        struct Layout
+        {
+            const char* simdName;
+            const char* scalarName;
+            int numChannels;
+        };
+
+        for (const auto& l : { Layout { "convert/downmix_stereo", "convert/downmix_stereo_scalar", 2 },
+                               Layout { "convert/downmix_5.1", "convert/downmix_5.1_scalar", 6 },
+                               Layout { "convert/downmix_7.1.4", "convert/downmix_7.1.4_scalar", 12 } })
+        {
+            const auto m = DownmixMatrix::create (layoutForChannelCount (l.numChannels), l.numChannels, 2);
+
+            run (l.simdName, "block", [&] (std::uint64_t n)
+            {
+                for (std::uint64_t i = 0; i < n; ++i)
+                {
+                    kernels::downmix (channels.data(), blockSize, m, out);
+                    keep (left[7]);
+                }
+            });
+
+            run (l.scalarName, "block", [&] (std::uint64_t n)
+            {
+                for (std::uint64_t i = 0; i < n; ++i)
+                {
+                    kernels::scalar::downmix (channels.data(), blockSize, m, out);
+                    keep (left[7]);
+                }
+            });
+        }
+
+        std::vector<float> interleaved (2 * blockSize, 0.25f);
+        std::vector<std::int16_t> pcm (2 * blockSize, 1234);
+
+        run ("convert/deinterleave_stereo", "block", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                kernels::deinterleave (interleaved.data(), 2, blockSize, out);
+                keep (right[9]);
+            }
+        });
+
+        run ("convert/deinterleave_stereo_scalar", "block", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                kernels::scalar::deinterleave (interleaved.data(), 2, blockSize, out);
+                keep (right[9]);
+            }
+        });
+
+        run ("convert/int16_stereo", "block", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                kernels::deinterleave (pcm.data(), 2, blockSize, out);
+                keep (right[9]);
+            }
+        });
+
+        run ("convert/int16_stereo_scalar", "block", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                kernels::scalar::deinterleave (pcm.data(), 2, blockSize, out);
+                keep (right[9]);
+            }
+        });
+
+        // Per second of host audio: the downmix grows with the host rate,
+        // the resampled analysis output doesn't.
+        struct Rate
+        {
+            const char* name;
+            double hz;
+        };
+
+        for (const auto& r : { Rate { "convert/analysis_input_44k", 44100.0 }, Rate { "convert/analysis_input_48k", 48000.0 },
+                               Rate { "convert/analysis_input_96k", 96000.0 }, Rate { "convert/analysis_input_192k", 192000.0 } })
+        {
+            AnalysisInput input;
+            input.prepare (r.hz, 2, blockSize);
+            const int blocksPerSecond = static_cast<int> (r.hz / blockSize);
+
+            run (r.name, "second", [&] (std::uint64_t n)
+            {
+                for (std::uint64_t i = 0; i < n; ++i)
+                    for (int b = 0; b < blocksPerSecond; ++b)
+                        keep (input.process (channels.data(), 2, blockSize).numFrames);
+            });
+        }
+    }
+
+    /** Typical mappings interpreted against the same thing written in C++:
+        one value at a time for BPM, whole arrays for level banks and spectra.
+    */
+    void mapping()
+    {
+        Mapping bpm, levels, tilt;
+        std::string error;
+        Mapping::compile ("clamp ((x - 60) / 120, 0, 1)", bpm, error);
+        Mapping::compile ("scale (db (x), -60, 0, 0, 1)", levels, error);
+        Mapping::compile ("(x - 0.5) * (x - 0.5) * 4 + i / n", tilt, error);
+
+        run ("mapping/bpm", "value", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+                keep (bpm.evaluate (static_cast<float> (i & 255)));
+        });
+
+        run ("mapping/bpm_native", "value", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                volatile float x = static_cast<float> (i & 255);
+                keep (std::clamp ((x - 60.0f) / 120.0f, 0.0f, 1.0f));
+            }
+        });
+
+        std::vector<float> bank (64), spectrum (512), out (512);
+
+        for (std::size_t i = 0; i < spectrum.size(); ++i)
+            spectrum[i] = 0.001f + static_cast<float> (i % 97) / 97.0f;
+
+        std::copy (spectrum.begin(), spectrum.begin() + 64, bank.begin());
+
+        run ("mapping/levels_64", "bank", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                levels.evaluate (bank.data(), out.data(), 64);
+                keep (out[5]);
+            }
+        });
+
+        run ("mapping/levels_64_native", "bank", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                for (std::size_t j = 0; j < 64; ++j)
+                    out[j] = (20.0f * std::log10 (std::max (bank[j], 1.0e-10f)) + 60.0f) / 60.0f;
+
+                keep (out[5]);
+            }
+        });
+
+        run ("mapping/spectrum_512", "spectrum", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                tilt.evaluate (spectrum.data(), out.data(), 512);
+                keep (out[5]);
+            }
+        });
+
+        run ("mapping/spectrum_512_native", "spectrum", [&] (std::uint64_t n)
+        {
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                for (std::size_t j = 0; j < 512; ++j)
+                    out[j] = (spectrum[j] - 0.5f) * (spectrum[j] - 0.5f) * 4.0f + static_cast<float> (j) / 512.0f;
+
+                keep (out[5]);
+            }
+        });
+    }
+
+    void configuration()
+    {
+        const std::string text =
+            "destinations = 10.0.0.5:9000, 10.0.0.6:9000\n"
+            "features = transport levels midi waveform\n"
+            "transport.rate = 120\nlevels.rate = 60\nevents.redundancy = 3\n";
+
+        run ("config/parse", "file", [&] (std::uint64_t n)
+        {
+            std::string error;
+
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                SenderConfig c;
+                config::parse (text, c, error);
+                keep (c.transportRateHz);
+            }
+        });
+    }
+
+    /** What a plugin instance builds between being created and its first
+        block, with the default features: waveform, sockets and threads are
+        left until they're enabled. Scanning hosts and a session with an
+        instance on every track pay this many times over.
+    */
+    struct Instance
+    {
+        ConfigManager config;
+        FramePublisher frames;
+        MidiForwarder midi;
+        ParameterObserver parameters { 64 };
+        MetadataCache metadata;
+        WaveformPublisher waveform { 2 };
+        QualityGovernor governor;
+        AnalysisInput analysis;
+
+       #if DAWINFO_BENCHMARK_SOCKETS
+        WebSocketServer webSocket;
+       #endif
+
+        void prepare (double sampleRate, int blockSize)
+        {
+            analysis.prepare (sampleRate, 2, blockSize);
+        }
+    };
+
+    /** Bytes held by the heap, or 0 where that can't be asked. */
+    std::size_t heapInUse()
+    {
+       #if defined (__GLIBC__)
+        const auto info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+       #else
+        return 0;
+       #endif
+    }
+
+    void startup()
+    {
+        // A session is a track's worth of instances at once; the tracks
+        // after the first find the shared tables already made.
+        for (const int count : { 1, 100 })
+        {
+            const std::string name = count == 1 ? "startup/instance_ready" : "startup/session_ready_" + std::to_string (count);
+
+            run (name.c_str(), count == 1 ? "instance" : "session", [&] (std::uint64_t n)
+            {
+                for (std::uint64_t i = 0; i < n; ++i)
+                {
+                    std::vector<std::unique_ptr<Instance>> instances;
+
+                    for (int j = 0; j < count; ++j)
+                    {
+                        instances.push_back (std::make_unique<Instance>());
+                        instances.back()->prepare (44100.0, 512);
+                    }
+
+                    keep (instances.back()->analysis.getResampler().getUpFactor());
+                }
+            });
+
+            const auto before = heapInUse();
+            std::vector<std::unique_ptr<Instance>> instances;
+
+            for (int j = 0; j < count; ++j)
+            {
+                instances.push_back (std::make_unique<Instance>());
+                instances.back()->prepare (44100.0, 512);
+            }
+
+            if (const auto after = heapInUse(); after > before)
+                std::printf ("  %-34s %12.1f KB/instance\n", (name + "/memory").c_str(),
+                             static_cast<double> (after - before) / count / 1024.0);
+
+            // With the waveform switched on as well.
+            if (count == 1)
+            {
+                const auto withoutWaveform = heapInUse();
+                const std::vector<float> silence (64);
+                const float* channels[] = { silence.data(), silence.data() };
+                auto& waveform = instances.back()->waveform;
+                waveform.prepare();
+                waveform.pushBlock (channels, 2, 64);
+                waveform.update();
+                std::printf ("  %-34s %12.1f KB\n", "startup/waveform_prepare/memory",
+                             static_cast<double> (heapInUse() - withoutWaveform) / 1024.0);
+            }
+        }
+    }
+
+#if DAWINFO_BENCHMARK_SOCKETS
+    void loopback()
+    {
+        ControlChannel channel;
+
+        if (! channel.start (0, true))
+        {
+            std::printf ("  (loopback benchmarks skipped: no socket)\n");
+            return;
+        }
+
+        std::atomic<bool> running { true };
+
+        std::thread sender ([&]
+        {
+            StreamSequencer seq;
+
+            while (running)
+                if (channel.waitForCommands (20))
+                    channel.service (seq, monotonicNowNs());
+        });
+
+        UdpSocket client;
+        client.open (0, true);
+        const Endpoint target { Endpoint::loopbackAddress, static_cast<std::uint16_t> (channel.getPort()) };
+        std::uint8_t request[64], reply[512];
+        OscWriter w (request, sizeof (request));
+        control::writeCommand (w, { control::CommandType::querySnapshot, 1, 0, 0, 0.0 });
+        const auto requestSize = w.getSize();
+
+        run ("loopback/control_round_trip", "request", [&] (std::uint64_t n)
+        {
+            Endpoint from;
+
+            for (std::uint64_t i = 0; i < n; ++i)
+            {
+                client.sendTo (target, request, requestSize);
+                client.receive (reply, sizeof (reply), from, 1000);
+            }
+        });
+
+        running = false;
+        sender.join();
+    }
+#endif
+
+    //==============================================================================
+    bool writeJson (const std::string& path)
+    {
+        FILE* f = path == "-" ? stdout : std::fopen (path.c_str(), "w");
+
+        if (f == nullptr)
+            return false;
+
+        std::fprintf (f, "{\n  \"suite\": \"dawinfo\",\n  \"version\": 1,\n  \"benchmarks\": [\n");
+
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& r = results[i];
+            std::fprintf (f, "    { \"name\": \"%s\", \"unit\": \"%s\", \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f, \"iterations\": %llu }%s\n",
+                          r.name.c_str(), r.unit.c_str(), r.nsPerOp, r.minNsPerOp,
+                          static_cast<unsigned long long> (r.iterations), i + 1 < results.size() ? "," : "");
+        }
+
+        std::fprintf (f, "  ]\n}\n");
+
+        if (f != stdout)
+            std::fclose (f);
+
+        return true;
+    }
+}
+
+int main (int argc, char** argv)
+{
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        if (arg == "--json" && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            settings.filter = argv[++i];
+        }
+        else if (arg == "--quick")
+        {
+            settings.sampleNs = 2000000;
+            settings.numSamples = 3;
+        }
+        else
+        {
+            std::fprintf (stderr, "usage: %s [--json <file>] [--filter <text>] [--quick]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::printf ("dawinfo benchmarks (%s)\n", simd::instructionSet());
+    encoding();
+    batching();
+    rings();
+    metering();
+    conversion();
+    mapping();
+    configuration();
+    startup();
+
+   #if DAWINFO_BENCHMARK_SOCKETS
+    loopback();
+   #endif
+
+    if (! jsonPath.empty() && ! writeJson (jsonPath))
+    {
+        std::fprintf (stderr, "couldn't write %s\n", jsonPath.c_str());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "FuzzTarget.h"
+#include "Common/Config.h"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+/*  The text parsers: config files (config::parse, and with it every key's
+    value parser), mapping expressions and IPv4 addresses.
+
+    A config that parses has to come back the same through format() and
+    parse(). A mapping that compiles has to compile to the same program from
+    its own source, and its array form has to agree with the one-value form.
+*/
+namespace
+{
+    using namespace dawinfo;
+
+    bool sameProgram (const Mapping& a, const Mapping& b)
+    {
+        if (a.getNumInstructions() != b.getNumInstructions())
+            return false;
+
+        for (int i = 0; i < a.getNumInstructions(); ++i)
+        {
+            const auto& x = a.getInstruction (i);
+            const auto& y = b.getInstruction (i);
+
+            if (x.op != y.op || std::memcmp (&x.a, &y.a, sizeof (x.a)) != 0 || std::memcmp (&x.b, &y.b, sizeof (x.b)) != 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool agree (float a, float b)
+    {
+        if (std::isnan (a) || std::isnan (b))
+            return std::isnan (a) && std::isnan (b);
+
+        if (std::isinf (a) || std::isinf (b))
+            return a == b || std::abs (a - b) <= 1.0e-3f * std::max (std::abs (a), std::abs (b));
+
+        return std::abs (a - b) <= 1.0e-4f * std::max ({ 1.0f, std::abs (a), std::abs (b) });
+    }
+
+    void checkConfig (std::string_view text)
+    {
+        SenderConfig c;
+        std::string error;
+
+        if (! config::parse (text, c, error))
+        {
+            DAWINFO_FUZZ_CHECK (! error.empty());
+            return;
+        }
+
+        const auto formatted = config::format (c);
+        SenderConfig reloaded;
+        DAWINFO_FUZZ_CHECK (config::parse (formatted, reloaded, error) && config::format (reloaded) == formatted);
+        config::validate (c, error);
+    }
+
+    void checkMapping (std::string_view text)
+    {
+        Mapping m;
+        std::string error;
+
+        if (! Mapping::compile (text, m, error))
+        {
+            DAWINFO_FUZZ_CHECK (! error.empty());
+            return;
+        }
+
+        Mapping again;
+        DAWINFO_FUZZ_CHECK (Mapping::compile (m.getSource(), again, error) && sameProgram (m, again));
+
+        constexpr int n = 19;
+        float in[n], out[n];
+
+        for (int i = 0; i < n; ++i)
+            in[i] = (static_cast<float> (i) - 6.0f) * 0.37f;
+
+        m.evaluate (in, out, n);
+
+        for (int i = 0; i < n; ++i)
+            DAWINFO_FUZZ_CHECK (agree (out[i], m.evaluate (in[i], i, n)));
+    }
+
+    void checkIpv4 (std::string_view text)
+    {
+        std::uint32_t address = 0, again = 0;
+
+        if (! config::parseIpv4 (text, address))
+            return;
+
+        const auto dotted = std::to_string (address >> 24) + "." + std::to_string ((address >> 16) & 0xff) + "."
+                              + std::to_string ((address >> 8) & 0xff) + "." + std::to_string (address & 0xff);
+
+        DAWINFO_FUZZ_CHECK (config::parseIpv4 (dotted, again) && again == address);
+    }
+}
+
+namespace dawinfo::fuzz
+{
+    std::vector<Input> seeds()
+    {
+        const char* texts[] = {
+            "# a comment\n"
+            "destinations = 127.0.0.1:9000, 192.168.1.20:9001\n"
+            "multicast.group = 239.255.0.1:9100\n"
+            "multicast.ttl = 2\n"
+            "features = transport levels spectrum events midi\n"
+            "transport.rate = 120\n"
+            "levels.rate = 30\n"
+            "parameters.tolerance = 0.01\n"
+            "map.bpm = clamp ((x - 60) / 120, 0, 1)\n"
+            "map.spectrum = x * gain (3 * i / n)\n",
+            "features = all\nwaveform.liveLevel = 4\nwebsocket.port = 8080\nmemory.compact = 1\n",
+            "scale (db (x), -60, 0, 0, 1)",
+            "-x ^ 2 + sqrt (abs (x)) + log (exp (1)) + log10 (100) + floor (1.5) + min (x, pi) + max (x, 1e3) + pow (x, .5e1)",
+            "10.0.0.255",
+        };
+
+        std::vector<Input> result;
+
+        for (const char* text : texts)
+            result.emplace_back (text, text + std::strlen (text));
+
+        return result;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput (const std::uint8_t* data, std::size_t size)
+{
+    const std::string_view text (reinterpret_cast<const char*> (data), size);
+
+    checkConfig (text);
+    checkMapping (text);
+    checkIpv4 (text);
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include "FuzzTarget.h"
+#include "Common/Config.h"
+#include "Common/Control.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+/*  What the control listener does with a datagram (ControlChannel::listen()):
+    every message in it through control::decodeCommand(), plus the
+    /dawinfo/config/<key> messages ConfigManager::handleMessage() applies.
+
+    A command that decodes is written out with writeCommand() and has to
+    decode to the same command; a config change that applies has to survive
+    config::format() and config::parse().
+*/
+namespace
+{
+    using namespace dawinfo;
+
+    /** The listener's receive buffer; anything longer arrives truncated. */
+    constexpr std::size_t maxCommandPacket = 1500;
+
+    bool sameCommand (const control::Command& a, const control::Command& b)
+    {
+        return a.type == b.type && a.token == b.token && a.streams == b.streams && a.durationMs == b.durationMs
+                && std::memcmp (&a.ppq, &b.ppq, sizeof (a.ppq)) == 0 && a.feature == b.feature
+                && a.fromNs == b.fromNs && a.toNs == b.toNs && a.maxFrames == b.maxFrames
+                && a.peaks.level == b.peaks.level && a.peaks.firstBin == b.peaks.firstBin && a.peaks.numBins == b.peaks.numBins;
+    }
+
+    void checkCommand (const OscMessage& m)
+    {
+        control::Command command;
+
+        if (! control::decodeCommand (m, command))
+            return;
+
+        DAWINFO_FUZZ_CHECK (std::isfinite (command.ppq));
+
+        std::uint8_t buffer[256];
+        OscWriter w (buffer, sizeof (buffer));
+        control::writeCommand (w, command);
+        DAWINFO_FUZZ_CHECK (! w.hasOverflowed());
+
+        OscMessage again;
+        control::Command decoded;
+        DAWINFO_FUZZ_CHECK (parseOscMessage (w.getData(), w.getSize(), again));
+        DAWINFO_FUZZ_CHECK (control::decodeCommand (again, decoded) && sameCommand (decoded, command));
+    }
+
+    void checkConfig (const OscMessage& m)
+    {
+        SenderConfig c;
+        std::string error;
+
+        if (! config::applyMessage (m, c, error))
+        {
+            DAWINFO_FUZZ_CHECK (! error.empty());
+            return;
+        }
+
+        const auto text = config::format (c);
+        SenderConfig reloaded;
+        DAWINFO_FUZZ_CHECK (config::parse (text, reloaded, error) && config::format (reloaded) == text);
+    }
+}
+
+namespace dawinfo::fuzz
+{
+    std::vector<Input> seeds()
+    {
+        std::vector<Input> result;
+        std::uint8_t buffer[1024];
+        OscWriter w (buffer, sizeof (buffer));
+
+        auto command = [] (control::CommandType type)
+        {
+            control::Command c;
+            c.type = type;
+            c.token = 42;
+            c.streams = control::streamBit (StreamId::transport) | control::streamBit (StreamId::levels);
+            c.durationMs = 5000;
+            c.ppq = 16.5;
+            c.feature = history::Feature::spectrum;
+            c.fromNs = -10000000000;
+            c.maxFrames = 512;
+            c.peaks = { 2, -1, 300 };
+            return c;
+        };
+
+        for (int type = 0; type <= static_cast<int> (control::CommandType::queryPeaks); ++type)
+        {
+            w.reset();
+            control::writeCommand (w, command (static_cast<control::CommandType> (type)));
+            result.push_back (toInput (w));
+        }
+
+        // The short forms a hand-written controller sends.
+        w.reset();
+        w.beginMessage (control::locateAddress, "f");
+        w.addFloat32 (4.0f);
+        w.endMessage();
+        result.push_back (toInput (w));
+
+        // Locate targets that must be refused.
+        w.reset();
+        w.beginBundle();
+        w.beginMessage (control::locateAddress, "f");
+        w.addFloat32 (std::numeric_limits<float>::quiet_NaN());
+        w.endMessage();
+        w.beginMessage (control::locateAddress, "d");
+        w.addFloat64 (std::numeric_limits<double>::infinity());
+        w.endMessage();
+        w.beginMessage (control::locateAddress, "d");
+        w.addFloat64 (-std::numeric_limits<double>::infinity());
+        w.endMessage();
+        result.push_back (toInput (w));
+
+        w.reset();
+        w.beginBundle();
+        w.beginMessage (control::pingAddress, "");
+        w.endMessage();
+        w.beginMessage (control::historyAddress, "ihh");
+        w.addInt32 (0);
+        w.addInt64 (0);
+        w.addInt64 (-1000000000);
+        w.endMessage();
+        result.push_back (toInput (w));
+
+        w.reset();
+        w.beginBundle();
+        w.beginMessage ("/dawinfo/config/features", "s");
+        w.addString ("transport levels midi");
+        w.endMessage();
+        w.beginMessage ("/dawinfo/config/levels.rate", "f");
+        w.addFloat32 (30.0f);
+        w.endMessage();
+        w.beginMessage ("/dawinfo/config/events.redundancy", "i");
+        w.addInt32 (3);
+        w.endMessage();
+        w.beginMessage ("/dawinfo/config/map.levels", "s");
+        w.addString ("db(x) * 0.5 + 1");
+        w.endMessage();
+        result.push_back (toInput (w));
+
+        return result;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput (const std::uint8_t* data, std::size_t size)
+{
+    using namespace dawinfo;
+
+    dawinfo::forEachOscMessage (data, std::min (size, maxCommandPacket), [] (const OscMessage& m)
+    {
+        checkCommand (m);
+        checkConfig (m);
+    });
+
+    return 0;
+}
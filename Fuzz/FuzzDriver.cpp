@@ -0,0 +1,309 @@
+#include "FuzzTarget.h"
+
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+
+#if defined (__SANITIZE_ADDRESS__)
+ #define DAWINFO_FUZZ_ASAN 1
+#elif defined (__has_feature)
+ #if __has_feature (address_sanitizer)
+  #define DAWINFO_FUZZ_ASAN 1
+ #endif
+#endif
+
+#if DAWINFO_FUZZ_ASAN
+ #include <sanitizer/common_interface_defs.h>
+#endif
+
+/*  Stands in for libFuzzer where there isn't one (gcc, or a plain test run).
+
+        dawinfo_fuzz_<target> [--runs N] [--seed S] [--max-size N]
+        dawinfo_fuzz_<target> --write-corpus <dir>
+        dawinfo_fuzz_<target> <file or dir>...
+
+    With no files it runs the target's seeds and then N mutations of them:
+    not coverage-guided, so it finds less than libFuzzer does, but it is
+    deterministic for a given seed and keeps every target building and
+    running under ctest. An input that crashes is saved to crash-input in
+    the working directory. Files are replayed as they are, which is how a
+    crash from either engine is reproduced. --write-corpus saves the seeds to
+    start a libFuzzer corpus from.
+*/
+namespace
+{
+    using dawinfo::fuzz::Input;
+
+    const Input* current = nullptr;
+
+    /** Saves the input that was running when the target crashed. */
+    void saveCurrent()
+    {
+        if (current == nullptr)
+            return;
+
+        if (auto* file = std::fopen ("crash-input", "wb"))
+        {
+            std::fwrite (current->data(), 1, current->size(), file);
+            std::fclose (file);
+            std::fprintf (stderr, "saved the input (%zu bytes) to crash-input\n", current->size());
+        }
+
+        current = nullptr;
+    }
+
+    extern "C" void onCrash (int signal)
+    {
+        saveCurrent();
+        std::signal (signal, SIG_DFL);
+        std::raise (signal);
+    }
+
+    void saveCrashes()
+    {
+        for (const int signal : { SIGABRT, SIGSEGV, SIGFPE, SIGILL })
+            std::signal (signal, onCrash);
+
+       #if DAWINFO_FUZZ_ASAN
+        __sanitizer_set_death_callback (saveCurrent);
+       #endif
+    }
+
+    /** Runs one input from a buffer of exactly its size, so reading past the
+        end is caught by AddressSanitizer rather than landing in slack.
+    */
+    void run (const Input& input)
+    {
+        current = &input;
+        std::unique_ptr<std::uint8_t[]> copy (new std::uint8_t[std::max<std::size_t> (input.size(), 1)]);
+        std::copy (input.begin(), input.end(), copy.get());
+        LLVMFuzzerTestOneInput (input.empty() ? nullptr : copy.get(), input.size());
+        current = nullptr;
+    }
+
+    /** Byte values and big-endian words that tend to sit on a boundary. */
+    constexpr std::uint8_t interestingBytes[] = { 0x00, 0x01, 0x7f, 0x80, 0xff, ',', '/', 'i', 'h', 'b', 's', '#' };
+    constexpr std::uint32_t interestingWords[] = { 0, 1, 2, 3, 4, 0x7fffffff, 0x80000000, 0xffffffff, 0xfffffffc, 0x100, 0x10000 };
+
+    class Mutator
+    {
+    public:
+        Mutator (std::uint32_t seed, std::size_t maxSize) : random (seed), maxSize (maxSize) {}
+
+        Input mutate (const std::vector<Input>& seeds)
+        {
+            Input input = seeds.empty() ? Input() : seeds[pick (seeds.size())];
+            const auto numEdits = 1 + pick (4);
+
+            for (std::size_t i = 0; i < numEdits; ++i)
+                edit (input, seeds);
+
+            if (input.size() > maxSize)
+                input.resize (maxSize);
+
+            return input;
+        }
+
+    private:
+        std::size_t pick (std::size_t n)    { return n > 0 ? std::uniform_int_distribution<std::size_t> (0, n - 1) (random) : 0; }
+        std::uint8_t byte()                 { return static_cast<std::uint8_t> (random()); }
+
+        void edit (Input& input, const std::vector<Input>& seeds)
+        {
+            const auto at = pick (input.size() + 1);
+
+            switch (pick (input.empty() ? 3 : 10))
+            {
+                case 0:     // insert random bytes
+                {
+                    const auto n = 1 + pick (8);
+                    for (std::size_t i = 0; i < n; ++i)
+                        input.insert (input.begin() + static_cast<std::ptrdiff_t> (at), byte());
+                    break;
+                }
+
+                case 1:     // splice in part of another seed
+                {
+                    if (seeds.empty())
+                        break;
+
+                    const auto& other = seeds[pick (seeds.size())];
+                    const auto from = pick (other.size() + 1);
+                    const auto n = pick (other.size() - from + 1);
+                    input.insert (input.begin() + static_cast<std::ptrdiff_t> (at), other.begin() + static_cast<std::ptrdiff_t> (from),
+                                  other.begin() + static_cast<std::ptrdiff_t> (from + n));
+                    break;
+                }
+
+                case 2:     // replace with random bytes
+                {
+                    input.resize (pick (64));
+                    for (auto& b : input)
+                        b = byte();
+                    break;
+                }
+
+                case 3:     // flip a bit
+                    input[pick (input.size())] ^= static_cast<std::uint8_t> (1u << pick (8));
+                    break;
+
+                case 4:     // set a byte
+                    input[pick (input.size())] = byte();
+                    break;
+
+                case 5:     // set a byte to a boundary value
+                    input[pick (input.size())] = interestingBytes[pick (std::size (interestingBytes))];
+                    break;
+
+                case 6:     // overwrite a big-endian word, usually an aligned one
+                {
+                    const auto word = interestingWords[pick (std::size (interestingWords))];
+                    auto pos = pick (input.size());
+                    pos -= (pick (4) != 0 ? pos % 4 : 0);
+
+                    for (std::size_t i = 0; i < 4 && pos + i < input.size(); ++i)
+                        input[pos + i] = static_cast<std::uint8_t> (word >> (24 - 8 * i));
+                    break;
+                }
+
+                case 7:     // erase a range
+                {
+                    const auto from = pick (input.size());
+                    const auto n = 1 + pick (std::min<std::size_t> (input.size() - from, 16));
+                    input.erase (input.begin() + static_cast<std::ptrdiff_t> (from), input.begin() + static_cast<std::ptrdiff_t> (from + n));
+                    break;
+                }
+
+                case 8:     // truncate
+                    input.resize (pick (input.size()));
+                    break;
+
+                default:    // duplicate a range
+                {
+                    const auto from = pick (input.size());
+                    const auto n = 1 + pick (std::min<std::size_t> (input.size() - from, 32));
+                    const Input chunk (input.begin() + static_cast<std::ptrdiff_t> (from), input.begin() + static_cast<std::ptrdiff_t> (from + n));
+                    input.insert (input.begin() + static_cast<std::ptrdiff_t> (at), chunk.begin(), chunk.end());
+                    break;
+                }
+            }
+        }
+
+        std::mt19937 random;
+        const std::size_t maxSize;
+    };
+
+    bool readFile (const std::filesystem::path& path, Input& input)
+    {
+        std::ifstream file (path, std::ios::binary);
+        input.assign (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char>());
+        return ! file.bad();
+    }
+
+    int writeCorpus (const std::filesystem::path& dir)
+    {
+        std::error_code error;
+        std::filesystem::create_directories (dir, error);
+        const auto seeds = dawinfo::fuzz::seeds();
+
+        for (std::size_t i = 0; i < seeds.size(); ++i)
+        {
+            std::ofstream file (dir / ("seed-" + std::to_string (i)), std::ios::binary);
+            file.write (reinterpret_cast<const char*> (seeds[i].data()), static_cast<std::streamsize> (seeds[i].size()));
+
+            if (! file)
+            {
+                std::fprintf (stderr, "couldn't write to %s\n", dir.string().c_str());
+                return 1;
+            }
+        }
+
+        std::printf ("wrote %zu seeds to %s\n", seeds.size(), dir.string().c_str());
+        return 0;
+    }
+}
+
+int main (int argc, char** argv)
+{
+    long runs = 10000;
+    std::uint32_t seed = 1;
+    std::size_t maxSize = 4096;
+    std::vector<std::filesystem::path> paths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--runs" && hasValue)                 runs = std::strtol (argv[++i], nullptr, 10);
+        else if (arg == "--seed" && hasValue)            seed = static_cast<std::uint32_t> (std::strtoul (argv[++i], nullptr, 10));
+        else if (arg == "--max-size" && hasValue)        maxSize = std::strtoul (argv[++i], nullptr, 10);
+        else if (arg == "--write-corpus" && hasValue)    return writeCorpus (argv[++i]);
+        else if (arg.rfind ("--", 0) == 0)
+        {
+            std::fprintf (stderr, "usage: %s [--runs N] [--seed S] [--max-size N] [--write-corpus dir] [file or dir...]\n", argv[0]);
+            return 2;
+        }
+        else
+        {
+            paths.push_back (arg);
+        }
+    }
+
+    if (! paths.empty())
+    {
+        std::size_t replayed = 0;
+
+        for (const auto& path : paths)
+        {
+            std::vector<std::filesystem::path> files;
+
+            if (std::filesystem::is_directory (path))
+            {
+                for (const auto& entry : std::filesystem::directory_iterator (path))
+                    if (entry.is_regular_file())
+                        files.push_back (entry.path());
+            }
+            else
+            {
+                files.push_back (path);
+            }
+
+            for (const auto& file : files)
+            {
+                Input input;
+
+                if (! readFile (file, input))
+                {
+                    std::fprintf (stderr, "couldn't read %s\n", file.string().c_str());
+                    return 1;
+                }
+
+                run (input);
+                ++replayed;
+            }
+        }
+
+        std::printf ("%s: replayed %zu inputs\n", argv[0], replayed);
+        return 0;
+    }
+
+    saveCrashes();
+    const auto seeds = dawinfo::fuzz::seeds();
+
+    for (const auto& input : seeds)
+        run (input);
+
+    Mutator mutator (seed, maxSize);
+
+    for (long i = 0; i < runs; ++i)
+        run (mutator.mutate (seeds));
+
+    std::printf ("%s: %zu seeds and %ld mutations passed\n", argv[0], seeds.size(), runs);
+    return 0;
+}
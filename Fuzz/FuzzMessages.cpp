@@ -0,0 +1,219 @@
+#include "FuzzTarget.h"
+#include "Common/History.h"
+#include "Common/Messages.h"
+#include "Common/Metadata.h"
+#include "Common/Peaks.h"
+
+/*  Every published message a receiver decodes: the fixed-layout schema
+    (Messages.h), waveform summaries and requests, history chunks, the
+    vectorscope cloud and the metadata messages.
+
+    Whatever decodes is written back out from the decoded value. A schema
+    message has to come back byte for byte, since its decoder refuses any
+    wire value its member can't hold. Elsewhere the first rewrite may differ
+    from the input (a sample quantized again), but it has to decode, and
+    rewriting that has to give the same bytes: an encoder and decoder that
+    agree have a fixed point.
+*/
+namespace
+{
+    using namespace dawinfo;
+
+    bool rewriteSchema (const OscMessage& m, OscWriter& w)
+    {
+        return messages::Published::dispatch (m, [&w] (auto msg, const auto& value)
+        {
+            schema::Codec<decltype (msg)>::write (w, value);
+        });
+    }
+
+    bool rewritePeaks (const OscMessage& m, OscWriter& w)
+    {
+        peaks::SummaryHeader h;
+        const std::uint8_t* packed = nullptr;
+
+        if (peaks::decodeSummary (m, h, packed))
+        {
+            const auto numValues = static_cast<std::size_t> (h.numBins) * static_cast<std::size_t> (h.numChannels);
+            std::vector<PeakBin> bins (numValues);
+
+            for (std::size_t i = 0; i < numValues; ++i)
+                bins[i] = peaks::unpack (packed, i);
+
+            peaks::writeSummary (w, h, bins.data());
+            return true;
+        }
+
+        peaks::Request request;
+
+        if (peaks::decodeRequest (m, request))
+        {
+            peaks::writeRequest (w, request);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool rewriteHistory (const OscMessage& m, OscWriter& w)
+    {
+        history::ChunkHeader h;
+        const std::uint8_t* packedTimes = nullptr;
+        const std::uint8_t* packedValues = nullptr;
+
+        if (! history::decodeChunk (m, h, packedTimes, packedValues))
+            return false;
+
+        const auto numFrames = static_cast<std::size_t> (h.numFrames);
+        const auto numValues = numFrames * static_cast<std::size_t> (h.numValues);
+        std::vector<HostTimeNs> times (numFrames);
+        std::vector<float> values (numValues);
+
+        for (std::size_t i = 0; i < numFrames; ++i)
+            times[i] = history::timeAt (h, packedTimes, i);
+
+        for (std::size_t i = 0; i < numValues; ++i)
+            values[i] = history::valueAt (packedValues, i);
+
+        history::writeChunk (w, h, times.data(), values.data());
+        return true;
+    }
+
+    bool rewriteVectorscope (const OscMessage& m, OscWriter& w)
+    {
+        HostTimeNs timeNs = 0;
+        int numPoints = 0;
+        const std::uint8_t* packed = nullptr;
+
+        if (! vectorscope::decodePoints (m, timeNs, numPoints, packed))
+            return false;
+
+        std::vector<vectorscope::Point> points (static_cast<std::size_t> (numPoints));
+
+        for (std::size_t i = 0; i < points.size(); ++i)
+            points[i] = vectorscope::unpack (packed, i);
+
+        vectorscope::writePoints (w, timeNs, points.data(), numPoints);
+        return true;
+    }
+
+    bool rewriteMetadata (const OscMessage& m, OscWriter& w)
+    {
+        metadata::Header header;
+        TrackInfo track;
+        std::uint32_t id = 0;
+        std::size_t offset = 0, total = 0, numIds = 0;
+        const std::uint8_t* packedIds = nullptr;
+
+        if (metadata::decodeHeader (m, header))
+            metadata::writeHeader (w, header);
+        else if (metadata::decodeTrack (m, track))
+            metadata::writeTrack (w, track);
+        else if (metadata::decodeRemoved (m, id))
+            metadata::writeRemoved (w, id);
+        else if (metadata::decodeOrderChunk (m, offset, total, packedIds, numIds))
+        {
+            std::vector<std::uint32_t> ids (numIds);
+
+            for (std::size_t i = 0; i < numIds; ++i)
+                ids[i] = readBigEndian32 (packedIds + i * 4);
+
+            metadata::writeOrderChunk (w, offset, total, ids.data(), numIds);
+        }
+        else
+            return false;
+
+        return true;
+    }
+
+    /** Writes a decoded message back out. False if it isn't one of ours. */
+    bool rewrite (const OscMessage& m, OscWriter& w)
+    {
+        return rewriteSchema (m, w) || rewritePeaks (m, w) || rewriteHistory (m, w)
+                || rewriteVectorscope (m, w) || rewriteMetadata (m, w);
+    }
+
+    void check (const OscMessage& m)
+    {
+        // Decoders clamp what they accept to what an encoder writes, so the
+        // rewrite never needs more room than the message came in.
+        std::vector<std::uint8_t> first (m.size), second (m.size);
+        OscWriter w (first.data(), first.size());
+
+        if (! rewrite (m, w))
+            return;
+
+        DAWINFO_FUZZ_CHECK (! w.hasOverflowed());
+
+        OscWriter exact (second.data(), second.size());
+
+        if (rewriteSchema (m, exact))
+            DAWINFO_FUZZ_CHECK (exact.getSize() == m.size && std::equal (m.data, m.data + m.size, second.begin()));
+
+        OscMessage again;
+        OscWriter w2 (second.data(), second.size());
+        DAWINFO_FUZZ_CHECK (parseOscMessage (w.getData(), w.getSize(), again));
+        DAWINFO_FUZZ_CHECK (rewrite (again, w2) && ! w2.hasOverflowed());
+        DAWINFO_FUZZ_CHECK (w2.getSize() == w.getSize() && std::equal (first.begin(), first.begin() + static_cast<std::ptrdiff_t> (w.getSize()), second.begin()));
+    }
+}
+
+namespace dawinfo::fuzz
+{
+    std::vector<Input> seeds()
+    {
+        std::vector<Input> result;
+        std::vector<std::uint8_t> buffer (4096);
+        OscWriter w (buffer.data(), buffer.size());
+
+        // One of every schema message, alone and together in a bundle.
+        messages::Published::forEach ([&] (auto msg)
+        {
+            w.reset();
+            schema::Codec<decltype (msg)>::write (w, typename decltype (msg)::Value {});
+            result.push_back (toInput (w));
+        });
+
+        w.reset();
+        w.beginBundle();
+        messages::Published::forEach ([&] (auto msg) { schema::Codec<decltype (msg)>::write (w, typename decltype (msg)::Value {}); });
+        result.push_back (toInput (w));
+
+        const PeakBin bins[] = { { -0.5f, 0.5f }, { -1.0f, 1.0f }, { 0.0f, 0.25f }, { -0.1f, 0.1f } };
+        w.reset();
+        peaks::writeSummary (w, { 2, 2, 2, 100 }, bins);
+        result.push_back (toInput (w));
+
+        w.reset();
+        peaks::writeRequest (w, { 1, -1, 64 });
+        result.push_back (toInput (w));
+
+        const HostTimeNs times[] = { 1000000, 2000000, 3500000 };
+        const float values[] = { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f };
+        w.reset();
+        history::writeChunk (w, { 7, history::Feature::levels, 1, 2, 3, true, 1000000 }, times, values);
+        result.push_back (toInput (w));
+
+        const vectorscope::Point points[] = { { 0.0f, 0.5f }, { -0.25f, 0.25f }, { 1.0f, -1.0f } };
+        w.reset();
+        vectorscope::writePoints (w, 123456789, points, 3);
+        result.push_back (toInput (w));
+
+        const std::uint32_t ids[] = { 3, 1, 2 };
+        w.reset();
+        w.beginBundle();
+        metadata::writeHeader (w, { 1, 2, 0, 1, false });
+        metadata::writeTrack (w, { 3, "Bass", 0xff336699, 2 });
+        metadata::writeRemoved (w, 4);
+        metadata::writeOrderChunk (w, 0, 3, ids, 3);
+        result.push_back (toInput (w));
+
+        return result;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput (const std::uint8_t* data, std::size_t size)
+{
+    dawinfo::forEachOscMessage (data, size, [] (const dawinfo::OscMessage& m) { check (m); });
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "FuzzTarget.h"
+#include "Common/Messages.h"
+#include "Receiver/LinkMonitor.h"
+#include "Receiver/MetadataMirror.h"
+#include "Receiver/ParameterMirror.h"
+#include "Receiver/TempoMapMirror.h"
+
+/*  The receiver helpers that keep state across packets: the metadata,
+    tempo map and parameter mirrors, and the link monitor. The input is a
+    run of length-prefixed packets (see fuzz::forEachPacket), each handed to
+    all four, and the mirrors are queried after every one.
+*/
+namespace
+{
+    using namespace dawinfo;
+
+    struct Receiver
+    {
+        MetadataMirror metadata;
+        TempoMapMirror tempo;
+        ParameterMirror parameters { 8 };
+        LinkMonitor link;
+        std::vector<std::int32_t> paramIds;
+
+        void handle (const std::uint8_t* data, std::size_t size)
+        {
+            metadata.handlePacket (data, size);
+            tempo.handlePacket (data, size);
+            parameters.handlePacket (data, size);
+            link.observePacket (data, size);
+
+            forEachOscMessage (data, size, [this] (const OscMessage& m)
+            {
+                ParameterSegment s;
+
+                if (schema::Codec<messages::Parameter>::decode (m, s) && paramIds.size() < 16)
+                    paramIds.push_back (s.paramId);
+            });
+
+            query();
+        }
+
+        void query()
+        {
+            const auto tracks = metadata.getTracks();
+
+            for (const auto& t : tracks)
+                DAWINFO_FUZZ_CHECK (metadata.findTrack (t.id) != nullptr);
+
+            const auto& map = tempo.getMap();
+            DAWINFO_FUZZ_CHECK (map.segments.size() <= static_cast<std::size_t> (TempoMap::maxSegments));
+
+            BeatTime beats[16];
+            const double from = map.segments.empty() ? 0.0 : map.segments.back().startPpq;
+            DAWINFO_FUZZ_CHECK (map.predictBeats (from, 0, beats, 16) <= 16);
+            map.bpmAt (from + 1.0);
+            map.secondsBetween (0.0, from);
+
+            for (const auto id : paramIds)
+            {
+                DAWINFO_FUZZ_CHECK (parameters.hasParameter (id));
+                parameters.valueAt (id, 0);
+                parameters.valueAt (id, 1000000000);
+                parameters.latestValue (id);
+            }
+
+            link.getTotals();
+        }
+    };
+}
+
+namespace dawinfo::fuzz
+{
+    std::vector<Input> seeds()
+    {
+        std::vector<Input> result;
+        std::uint8_t buffer[1024];
+        OscWriter w (buffer, sizeof (buffer));
+
+        // A metadata full sync, then a delta.
+        Input input;
+        w.beginBundle();
+        writeSequence (w, StreamId::metadata, 1);
+        metadata::writeHeader (w, { 0, 1, 0, 1, true });
+        metadata::writeTrack (w, { 10, "Drums", 0xffcc0000, 2 });
+        metadata::writeTrack (w, { 11, "Bass", 0xff00cc00, 1 });
+        const std::uint32_t order[] = { 11, 10 };
+        metadata::writeOrderChunk (w, 0, 2, order, 2);
+        appendPacket (input, w);
+
+        w.reset();
+        w.beginBundle();
+        writeSequence (w, StreamId::metadata, 2);
+        metadata::writeHeader (w, { 1, 2, 0, 1, false });
+        metadata::writeRemoved (w, 11);
+        metadata::writeOrderChunk (w, 0, 1, order + 1, 1);
+        appendPacket (input, w);
+        result.push_back (input);
+
+        // A two-part tempo map.
+        input.clear();
+
+        for (std::int32_t part = 0; part < 2; ++part)
+        {
+            TempoMapHeader h;
+            h.version = 1;
+            h.part = part;
+            h.numParts = 2;
+            h.firstSegment = part;
+            h.numSegments = 2;
+            h.isLooping = true;
+            h.loopStartPpq = 0.0;
+            h.loopEndPpq = 16.0;
+
+            TempoSegment s;
+            s.startPpq = 8.0 * part;
+            s.bpm = 100.0 + 20.0 * part;
+            s.barNumber = 2 * part;
+
+            w.reset();
+            w.beginBundle();
+            writeSequence (w, StreamId::tempo, static_cast<std::uint32_t> (part));
+            schema::Codec<messages::TempoHeader>::write (w, h);
+            schema::Codec<messages::TempoSegment>::write (w, s);
+            appendPacket (input, w);
+        }
+
+        result.push_back (input);
+
+        // Parameter segments for two parameters.
+        input.clear();
+        w.reset();
+        w.beginBundle();
+        writeSequence (w, StreamId::parameters, 5);
+        schema::Codec<messages::Parameter>::write (w, { 1, 0, 500000000, 0.0f, 1.0f });
+        schema::Codec<messages::Parameter>::write (w, { 2, 100, 0, 0.5f, 0.5f });
+        schema::Codec<messages::Parameter>::write (w, { 1, 500000000, 250000000, 1.0f, 0.25f });
+        appendPacket (input, w);
+        result.push_back (input);
+
+        return result;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput (const std::uint8_t* data, std::size_t size)
+{
+    Receiver receiver;
+    dawinfo::fuzz::forEachPacket (data, size, [&] (const std::uint8_t* packet, std::size_t packetSize)
+    {
+        receiver.handle (packet, packetSize);
+    });
+
+    return 0;
+}
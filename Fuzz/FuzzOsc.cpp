@@ -0,0 +1,191 @@
+#include "FuzzTarget.h"
+
+#include <cstring>
+
+/*  The OSC packet parser every decoder sits on: bundles, messages and each
+    argument type OscArgumentReader knows.
+*/
+namespace
+{
+    using namespace dawinfo;
+
+    /** Reads every argument, appending its tag and bytes to record. False
+        if a tag isn't one the reader knows or an argument doesn't fit.
+    */
+    bool readAll (const OscMessage& m, std::vector<std::uint8_t>& record)
+    {
+        OscArgumentReader r (m);
+
+        auto append = [&record] (const void* p, std::size_t n)
+        {
+            const auto* bytes = static_cast<const std::uint8_t*> (p);
+            record.insert (record.end(), bytes, bytes + n);
+        };
+
+        for (const char tag : m.typeTags)
+        {
+            record.push_back (static_cast<std::uint8_t> (tag));
+            bool ok = false;
+
+            switch (tag)
+            {
+                case 'i': { std::int32_t v = 0; ok = r.readInt32 (v);   append (&v, sizeof (v)); break; }
+                case 'f': { float v = 0;        ok = r.readFloat32 (v); append (&v, sizeof (v)); break; }
+                case 'h': { std::int64_t v = 0; ok = r.readInt64 (v);   append (&v, sizeof (v)); break; }
+                case 'd': { double v = 0;       ok = r.readFloat64 (v); append (&v, sizeof (v)); break; }
+
+                case 's':
+                {
+                    std::string_view s;
+
+                    if ((ok = r.readString (s)))
+                    {
+                        DAWINFO_FUZZ_CHECK (fuzz::isInside (s.data(), s.size(), m.arguments, m.argumentsSize));
+                        DAWINFO_FUZZ_CHECK (std::memchr (s.data(), 0, s.size()) == nullptr);
+                        append (s.data(), s.size());
+                        record.push_back (0);
+                    }
+
+                    break;
+                }
+
+                case 'b':
+                {
+                    const std::uint8_t* blob = nullptr;
+                    std::size_t blobSize = 0;
+
+                    if ((ok = r.readBlob (blob, blobSize)))
+                    {
+                        DAWINFO_FUZZ_CHECK (fuzz::isInside (blob, blobSize, m.arguments, m.argumentsSize));
+                        append (&blobSize, sizeof (blobSize));
+                        append (blob, blobSize);
+                    }
+
+                    break;
+                }
+
+                default:
+                    return false;
+            }
+
+            if (! ok)
+            {
+                DAWINFO_FUZZ_CHECK (! r.isValid());
+                return false;
+            }
+        }
+
+        DAWINFO_FUZZ_CHECK (r.isAtEnd() && r.isValid());
+        return true;
+    }
+
+    /** Writes the message back out from what was read. */
+    void rewrite (OscWriter& w, const OscMessage& m)
+    {
+        OscArgumentReader r (m);
+        w.beginMessage (m.address, m.typeTags);
+
+        for (const char tag : m.typeTags)
+        {
+            switch (tag)
+            {
+                case 'i': { std::int32_t v = 0; r.readInt32 (v);   w.addInt32 (v); break; }
+                case 'f': { float v = 0;        r.readFloat32 (v); w.addFloat32 (v); break; }
+                case 'h': { std::int64_t v = 0; r.readInt64 (v);   w.addInt64 (v); break; }
+                case 'd': { double v = 0;       r.readFloat64 (v); w.addFloat64 (v); break; }
+                case 's': { std::string_view s; r.readString (s);  w.addString (s); break; }
+
+                default:
+                {
+                    const std::uint8_t* blob = nullptr;
+                    std::size_t blobSize = 0;
+                    r.readBlob (blob, blobSize);
+                    w.addBlob (blob, blobSize);
+                    break;
+                }
+            }
+        }
+
+        w.endMessage();
+    }
+
+    void check (const OscMessage& m, const std::uint8_t* data, std::size_t size)
+    {
+        DAWINFO_FUZZ_CHECK (fuzz::isInside (m.data, m.size, data, size));
+        DAWINFO_FUZZ_CHECK (m.size % 4 == 0 && ! m.address.empty() && m.address[0] == '/');
+        DAWINFO_FUZZ_CHECK (fuzz::isInside (m.address.data(), m.address.size(), m.data, m.size));
+        DAWINFO_FUZZ_CHECK (fuzz::isInside (m.typeTags.data(), m.typeTags.size(), m.data, m.size));
+        DAWINFO_FUZZ_CHECK (fuzz::isInside (m.arguments, m.argumentsSize, m.data, m.size));
+
+        std::vector<std::uint8_t> record;
+
+        if (! readAll (m, record))
+            return;
+
+        // A message that reads cleanly reads the same once written out again,
+        // and writing it out never takes more room than it came in.
+        std::vector<std::uint8_t> buffer (m.size);
+        OscWriter w (buffer.data(), buffer.size());
+        rewrite (w, m);
+        DAWINFO_FUZZ_CHECK (! w.hasOverflowed());
+
+        OscMessage again;
+        std::vector<std::uint8_t> againRecord;
+        DAWINFO_FUZZ_CHECK (parseOscMessage (w.getData(), w.getSize(), again));
+        DAWINFO_FUZZ_CHECK (again.address == m.address && again.typeTags == m.typeTags);
+        DAWINFO_FUZZ_CHECK (readAll (again, againRecord) && againRecord == record);
+    }
+}
+
+namespace dawinfo::fuzz
+{
+    std::vector<Input> seeds()
+    {
+        std::vector<Input> result;
+        std::uint8_t buffer[512];
+        const std::uint8_t blob[] = { 1, 2, 3, 4, 5 };
+
+        OscWriter w (buffer, sizeof (buffer));
+        w.beginMessage ("/all/types", "ifhdsb");
+        w.addInt32 (-7);
+        w.addFloat32 (0.25f);
+        w.addInt64 (1234567890123LL);
+        w.addFloat64 (3.5);
+        w.addString ("hello");
+        w.addBlob (blob, sizeof (blob));
+        w.endMessage();
+        result.push_back (toInput (w));
+
+        w.reset();
+        w.beginBundle();
+        w.beginMessage ("/a", "i");
+        w.addInt32 (1);
+        w.endMessage();
+        w.beginMessage ("/b", "sb");
+        w.addString ("");
+        w.addBlob (blob, 0);
+        w.endMessage();
+        result.push_back (toInput (w));
+
+        w.reset();
+        w.beginMessage ("/empty", "");
+        w.endMessage();
+        result.push_back (toInput (w));
+
+        return result;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput (const std::uint8_t* data, std::size_t size)
+{
+    using namespace dawinfo;
+
+    forEachOscMessage (data, size, [&] (const OscMessage& m) { check (m, data, size); });
+
+    OscMessage m;
+
+    if (parseOscMessage (data, size, m))
+        check (m, data, size);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Common/Osc.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/*  Shared by the fuzz targets in this directory. Each Fuzz*.cpp defines the
+    libFuzzer entry point, LLVMFuzzerTestOneInput(), plus fuzz::seeds(): a few
+    well-formed inputs to start mutating from.
+
+    With clang and DAWINFO_LIBFUZZER the targets link against libFuzzer.
+    Otherwise they link against FuzzDriver.cpp, which replays inputs from
+    files (to reproduce a crash) or runs the seeds and a fixed number of
+    seeded mutations of them; ctest runs them that way. Either way, build
+    with DAWINFO_SANITIZE so a bad read stops the run where it happens.
+
+    A target's job is to feed the input to a parser and check what comes back:
+    every view a decoder hands out is read to the end, so a size it got wrong
+    is an out-of-bounds read under AddressSanitizer, and whatever decodes is
+    written out again and decoded a second time to check nothing changes.
+    Failed checks abort, which both engines report as a crash.
+*/
+namespace dawinfo::fuzz
+{
+    using Input = std::vector<std::uint8_t>;
+
+    /** Well-formed inputs to mutate from; defined by each target. */
+    std::vector<Input> seeds();
+
+    /** Reads every byte of a view, so a wrong size shows up under ASan. */
+    inline std::uint32_t touch (const std::uint8_t* data, std::size_t size) noexcept
+    {
+        std::uint32_t sum = 0;
+
+        for (std::size_t i = 0; i < size; ++i)
+            sum = sum * 31 + data[i];
+
+        return sum;
+    }
+
+    inline bool isInside (const void* view, std::size_t viewSize, const std::uint8_t* data, std::size_t size) noexcept
+    {
+        const auto* p = static_cast<const std::uint8_t*> (view);
+        return viewSize == 0 || (p >= data && viewSize <= size && p - data <= static_cast<std::ptrdiff_t> (size - viewSize));
+    }
+
+    /** Splits an input into packets, each prefixed with a big-endian 16-bit
+        length, for targets that keep state across packets. A short last
+        packet gets what's left.
+    */
+    template <typename Fn>
+    void forEachPacket (const std::uint8_t* data, std::size_t size, Fn&& fn)
+    {
+        while (size >= 2)
+        {
+            const auto length = std::min<std::size_t> ((std::size_t (data[0]) << 8) | data[1], size - 2);
+            fn (data + 2, length);
+            data += 2 + length;
+            size -= 2 + length;
+        }
+    }
+
+    /** The inverse of forEachPacket(), for building seeds. */
+    inline void appendPacket (Input& input, const OscWriter& w)
+    {
+        input.push_back (static_cast<std::uint8_t> (w.getSize() >> 8));
+        input.push_back (static_cast<std::uint8_t> (w.getSize()));
+        input.insert (input.end(), w.getData(), w.getData() + w.getSize());
+    }
+
+    inline Input toInput (const OscWriter& w)
+    {
+        return Input (w.getData(), w.getData() + w.getSize());
+    }
+}
+
+#define DAWINFO_FUZZ_CHECK(cond) \
+    do { if (! (cond)) { std::fprintf (stderr, "%s:%d: fuzz check failed: %s\n", __FILE__, __LINE__, #cond); \
+         std::abort(); } } while (false)
+
+/** Runs one input; always returns 0. */
+extern "C" int LLVMFuzzerTestOneInput (const std::uint8_t* data, std::size_t size);
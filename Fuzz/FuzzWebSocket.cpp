@@ -0,0 +1,102 @@
+#include "FuzzTarget.h"
+#include "Common/WebSocket.h"
+
+#include <cstring>
+
+/*  What WebSocketServer reads from a browser: the opening handshake's
+    headers and frame headers.
+
+    A header that parses comes back the same through writeFrameHeader(), and
+    masking a payload twice gives it back.
+*/
+namespace
+{
+    using namespace dawinfo;
+
+    void checkFrame (const std::uint8_t* data, std::size_t size)
+    {
+        websocket::FrameHeader h;
+        const int n = websocket::parseFrameHeader (data, size, h);
+
+        if (n <= 0)
+            return;
+
+        DAWINFO_FUZZ_CHECK (static_cast<std::size_t> (n) <= size && static_cast<std::size_t> (n) <= websocket::maxHeaderSize);
+
+        std::uint8_t header[websocket::maxHeaderSize];
+        websocket::FrameHeader again;
+        const auto written = websocket::writeFrameHeader (header, h);
+        DAWINFO_FUZZ_CHECK (written <= websocket::maxHeaderSize);
+        DAWINFO_FUZZ_CHECK (websocket::parseFrameHeader (header, written, again) == static_cast<int> (written));
+        DAWINFO_FUZZ_CHECK (again.final == h.final && again.opcode == h.opcode && again.masked == h.masked
+                             && again.payloadSize == h.payloadSize && (! h.masked || again.mask == h.mask));
+
+        // What follows the header, as far as it goes, unmasked in two pieces
+        // and masked again in one.
+        const auto payloadSize = std::min<std::uint64_t> (h.payloadSize, size - static_cast<std::size_t> (n));
+        std::vector<std::uint8_t> payload (data + n, data + n + payloadSize);
+        const auto split = payload.size() / 3;
+        websocket::applyMask (payload.data(), split, h.mask);
+        websocket::applyMask (payload.data() + split, payload.size() - split, h.mask, split);
+        websocket::applyMask (payload.data(), payload.size(), h.mask);
+        DAWINFO_FUZZ_CHECK (std::equal (payload.begin(), payload.end(), data + n));
+    }
+
+    void checkHandshake (std::string_view request)
+    {
+        for (const auto name : { "Sec-WebSocket-Key", "upgrade", "Connection", "Host" })
+        {
+            const auto value = websocket::findHeader (request, name);
+            DAWINFO_FUZZ_CHECK (fuzz::isInside (value.data(), value.size(), reinterpret_cast<const std::uint8_t*> (request.data()), request.size()));
+        }
+
+        const auto key = websocket::acceptKey (websocket::findHeader (request, "Sec-WebSocket-Key"));
+        DAWINFO_FUZZ_CHECK (key.size() == 28);
+    }
+}
+
+namespace dawinfo::fuzz
+{
+    std::vector<Input> seeds()
+    {
+        std::vector<Input> result;
+
+        const char* request =
+            "GET / HTTP/1.1\r\n"
+            "Host: localhost:8080\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+            "Sec-WebSocket-Version: 13\r\n\r\n";
+        result.emplace_back (request, request + std::strlen (request));
+
+        for (const std::uint64_t payloadSize : { 5u, 200u, 70000u })
+        {
+            websocket::FrameHeader h;
+            h.opcode = payloadSize > 100 ? websocket::binary : websocket::text;
+            h.masked = true;
+            h.mask = { 0x37, 0xfa, 0x21, 0x3d };
+            h.payloadSize = payloadSize;
+
+            std::uint8_t header[websocket::maxHeaderSize];
+            Input input (header, header + websocket::writeFrameHeader (header, h));
+            input.resize (input.size() + std::min<std::uint64_t> (payloadSize, 64), 'a');
+            result.push_back (input);
+        }
+
+        websocket::FrameHeader close;
+        close.opcode = websocket::close;
+        close.payloadSize = 2;
+        std::uint8_t header[websocket::maxHeaderSize];
+        result.emplace_back (header, header + websocket::writeFrameHeader (header, close));
+
+        return result;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput (const std::uint8_t* data, std::size_t size)
+{
+    checkFrame (data, size);
+    checkHandshake (std::string_view (reinterpret_cast<const char*> (data), size));
+    return 0;
+}
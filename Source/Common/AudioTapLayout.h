@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/*  Layout of the shared-memory audio tap: a header followed by one float
+    ring per channel, each capacityFrames long (a power of two). Frame n of
+    channel c lives at slot n & (capacityFrames - 1) of ring c.
+
+    The header's two frame counters form a seqlock over the rings. Before
+    copying a block the writer raises writeStart to the count it is about
+    to reach; after copying it sets writeEnd to the same. A reader may use
+    frames below writeEnd, and after using them checks writeStart: if it has
+    moved more than capacityFrames past the first frame read, the writer may
+    have overwritten that data while it was being read, so it is discarded.
+*/
+struct AudioTapHeader
+{
+    static constexpr std::uint32_t magicValue = 0x64617774;   // "dawt"
+    static constexpr std::uint32_t currentVersion = 1;
+
+    std::atomic<std::uint32_t> magic;       // set last, once the rest is valid
+    std::uint32_t version;
+    std::uint32_t numChannels;
+    std::uint32_t capacityFrames;
+    double sampleRate;
+
+    alignas (64) std::atomic<std::uint64_t> writeStart;
+    alignas (64) std::atomic<std::uint64_t> writeEnd;
+};
+
+static_assert (std::atomic<std::uint64_t>::is_always_lock_free, "tap counters must be lock-free to be shared");
+static_assert (std::atomic<std::uint32_t>::is_always_lock_free, "tap counters must be lock-free to be shared");
+
+namespace audiotap
+{
+    constexpr int maxChannels = 64;
+
+    constexpr std::size_t dataOffset = (sizeof (AudioTapHeader) + 63) & ~std::size_t (63);
+
+    constexpr std::size_t regionSize (std::uint32_t numChannels, std::uint32_t capacityFrames) noexcept
+    {
+        return dataOffset + std::size_t (numChannels) * capacityFrames * sizeof (float);
+    }
+
+    inline float* channelData (void* region, std::uint32_t capacityFrames, std::uint32_t channel) noexcept
+    {
+        return reinterpret_cast<float*> (static_cast<std::uint8_t*> (region) + dataOffset) + std::size_t (channel) * capacityFrames;
+    }
+
+    inline const float* channelData (const void* region, std::uint32_t capacityFrames, std::uint32_t channel) noexcept
+    {
+        return reinterpret_cast<const float*> (static_cast<const std::uint8_t*> (region) + dataOffset) + std::size_t (channel) * capacityFrames;
+    }
+}
+
+} // namespace dawinfo
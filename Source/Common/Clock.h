@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Common/Transport.h"
+
+#include <chrono>
+
+namespace dawinfo
+{
+
+/** The process's monotonic clock, in the units every timestamp uses. */
+inline HostTimeNs monotonicNowNs() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace dawinfo
@@ -0,0 +1,364 @@
+#include "Common/Config.h"
+
+#include <charconv>
+#include <cstdio>
+#include <utility>
+
+namespace dawinfo::config
+{
+
+const std::string_view featureNames[11] = {
+    "transport", "levels", "spectrum", "events", "metadata", "midi", "parameters", "waveform", "audioTap", "tempoMap",
+    "stereoImage"
+};
+
+namespace
+{
+    std::string_view trim (std::string_view s) noexcept
+    {
+        while (! s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\r'))
+            s.remove_prefix (1);
+
+        while (! s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+            s.remove_suffix (1);
+
+        return s;
+    }
+
+    template <typename Number>
+    bool parseNumber (std::string_view text, Number& out, Number min, Number max)
+    {
+        text = trim (text);
+        Number v {};
+        const auto result = std::from_chars (text.data(), text.data() + text.size(), v);
+
+        if (result.ec != std::errc() || result.ptr != text.data() + text.size() || ! (v >= min && v <= max))
+            return false;
+
+        out = v;
+        return true;
+    }
+
+    bool parseDestinations (std::string_view text, std::vector<Destination>& out)
+    {
+        std::vector<Destination> list;
+
+        while (! text.empty())
+        {
+            const auto comma = text.find (',');
+            const auto item = trim (text.substr (0, comma));
+            text = comma == std::string_view::npos ? std::string_view() : text.substr (comma + 1);
+
+            const auto colon = item.rfind (':');
+
+            if (colon == std::string_view::npos || colon == 0)
+                return false;
+
+            Destination d;
+            d.host.assign (item.data(), colon);
+
+            if (! parseNumber (item.substr (colon + 1), d.port, 1, 65535))
+                return false;
+
+            list.push_back (std::move (d));
+        }
+
+        out = std::move (list);
+        return true;
+    }
+
+    bool parseMulticastGroup (std::string_view text, MulticastOutput& out)
+    {
+        text = trim (text);
+
+        if (text.empty())
+        {
+            out.group.clear();
+            out.port = 0;
+            return true;
+        }
+
+        const auto colon = text.rfind (':');
+        std::uint32_t address = 0;
+        int port = 0;
+
+        if (colon == std::string_view::npos || ! parseIpv4 (text.substr (0, colon), address)
+             || (address >> 28) != 0xe || ! parseNumber (text.substr (colon + 1), port, 1, 65535))
+            return false;
+
+        out.group.assign (text.data(), colon);
+        out.port = port;
+        return true;
+    }
+
+    bool parseInterface (std::string_view text, std::string& out)
+    {
+        text = trim (text);
+        std::uint32_t address = 0;
+
+        if (! text.empty() && ! parseIpv4 (text, address))
+            return false;
+
+        out.assign (text.data(), text.size());
+        return true;
+    }
+
+    bool parseFeatures (std::string_view text, std::uint32_t& out)
+    {
+        std::uint32_t bits = 0;
+
+        while (! (text = trim (text)).empty())
+        {
+            const auto end = text.find_first_of (" \t,");
+            const auto name = text.substr (0, end);
+            text = end == std::string_view::npos ? std::string_view() : text.substr (end + 1);
+
+            if (name == "all")
+            {
+                bits |= feature::all;
+                continue;
+            }
+
+            bool found = false;
+
+            for (std::size_t i = 0; i < std::size (featureNames); ++i)
+            {
+                if (name == featureNames[i])
+                {
+                    bits |= 1u << i;
+                    found = true;
+                }
+            }
+
+            if (! found)
+                return false;
+        }
+
+        out = bits;
+        return true;
+    }
+
+    Mapping* findMapping (SenderConfig& c, std::string_view key) noexcept
+    {
+        if (key == "map.bpm")           return &c.bpmMapping;
+        if (key == "map.levels")        return &c.levelsMapping;
+        if (key == "map.spectrum")      return &c.spectrumMapping;
+        if (key == "map.parameters")    return &c.parameterMapping;
+        return nullptr;
+    }
+}
+
+//==============================================================================
+bool setValue (SenderConfig& c, std::string_view key, std::string_view value, std::string& error)
+{
+    bool ok = false;
+
+    if      (key == "destinations")          ok = parseDestinations (value, c.destinations);
+    else if (key == "multicast.group")       ok = parseMulticastGroup (value, c.multicast);
+    else if (key == "multicast.ttl")         ok = parseNumber (value, c.multicast.ttl, 0, 255);
+    else if (key == "multicast.interface")   ok = parseInterface (value, c.multicast.interface);
+    else if (key == "multicast.loopback")
+    {
+        int on = 0;
+        ok = parseNumber (value, on, 0, 1);
+        c.multicast.loopback = ok ? on != 0 : c.multicast.loopback;
+    }
+    else if (key == "features")              ok = parseFeatures (value, c.features);
+    else if (key == "transport.rate")        ok = parseNumber (value, c.transportRateHz, 0.1, 1000.0);
+    else if (key == "levels.rate")           ok = parseNumber (value, c.levelsRateHz, 0.1, 1000.0);
+    else if (key == "spectrum.rate")         ok = parseNumber (value, c.spectrumRateHz, 0.1, 1000.0);
+    else if (key == "events.redundancy")     ok = parseNumber (value, c.eventRedundancy, 0, 8);
+    else if (key == "packet.maxSize")        ok = parseNumber (value, c.maxPacketSize, 256, 65507);
+    else if (key == "midi.minIntervalMs")    ok = parseNumber (value, c.midiMinIntervalMs, 0.0, 1000.0);
+    else if (key == "midi.minDelta")         ok = parseNumber (value, c.midiMinDelta, 0, 127);
+    else if (key == "parameters.tolerance")  ok = parseNumber (value, c.parameterTolerance, 0.0f, 1.0f);
+    else if (key == "waveform.liveLevel")    ok = parseNumber (value, c.waveformLiveLevel, -1, 31);
+    else if (key == "websocket.port")        ok = parseNumber (value, c.websocketPort, 0, 65535);
+    else if (key == "memory.compact")
+    {
+        int on = 0;
+        ok = parseNumber (value, on, 0, 1);
+        c.compactMemory = ok ? on != 0 : c.compactMemory;
+    }
+    else if (auto* mapping = findMapping (c, key))
+    {
+        if (! Mapping::compile (trim (value), *mapping, error))
+        {
+            error = std::string (key) + " " + error;
+            return false;
+        }
+
+        return true;
+    }
+    else
+    {
+        error = "unknown key '" + std::string (key) + "'";
+        return false;
+    }
+
+    if (! ok)
+        error = "bad value '" + std::string (value) + "' for " + std::string (key);
+
+    return ok;
+}
+
+bool parse (std::string_view text, SenderConfig& c, std::string& error)
+{
+    SenderConfig result = c;
+    int lineNumber = 0;
+
+    while (! text.empty())
+    {
+        const auto newline = text.find ('\n');
+        auto line = text.substr (0, newline);
+        text = newline == std::string_view::npos ? std::string_view() : text.substr (newline + 1);
+        ++lineNumber;
+
+        line = trim (line.substr (0, line.find ('#')));
+
+        if (line.empty())
+            continue;
+
+        const auto equals = line.find ('=');
+
+        if (equals == std::string_view::npos)
+        {
+            error = "line " + std::to_string (lineNumber) + ": expected key = value";
+            return false;
+        }
+
+        if (! setValue (result, trim (line.substr (0, equals)), trim (line.substr (equals + 1)), error))
+        {
+            error = "line " + std::to_string (lineNumber) + ": " + error;
+            return false;
+        }
+    }
+
+    c = std::move (result);
+    return true;
+}
+
+bool validate (const SenderConfig& c, std::string& error)
+{
+    if (c.destinations.empty() && ! c.multicast.isEnabled() && c.websocketPort == 0 && c.features != 0)
+    {
+        error = "features are enabled but there are no destinations";
+        return false;
+    }
+
+    if (c.isEnabled (feature::parameters) && c.parameterTolerance <= 0.0f)
+    {
+        error = "parameter streaming needs a tolerance above zero";
+        return false;
+    }
+
+    return true;
+}
+
+bool applyMessage (const OscMessage& m, SenderConfig& c, std::string& error)
+{
+    if (m.address.substr (0, oscPrefix.size()) != oscPrefix)
+    {
+        error = "not a config message";
+        return false;
+    }
+
+    const auto key = m.address.substr (oscPrefix.size());
+    OscArgumentReader r (m);
+    char number[32];
+    std::string_view value;
+
+    if (m.typeTags == "s")
+    {
+        r.readString (value);
+    }
+    else if (m.typeTags == "i")
+    {
+        std::int32_t v = 0;
+        r.readInt32 (v);
+        value = std::string_view (number, static_cast<std::size_t> (std::snprintf (number, sizeof (number), "%d", v)));
+    }
+    else if (m.typeTags == "f")
+    {
+        float v = 0;
+        r.readFloat32 (v);
+        value = std::string_view (number, static_cast<std::size_t> (std::snprintf (number, sizeof (number), "%.9g", v)));
+    }
+    else
+    {
+        error = "config messages take one int, float or string";
+        return false;
+    }
+
+    SenderConfig result = c;
+
+    if (! setValue (result, key, value, error) || ! validate (result, error))
+        return false;
+
+    c = std::move (result);
+    return true;
+}
+
+std::string format (const SenderConfig& c)
+{
+    std::string out = "destinations = ";
+
+    for (std::size_t i = 0; i < c.destinations.size(); ++i)
+        out += (i > 0 ? ", " : "") + c.destinations[i].host + ":" + std::to_string (c.destinations[i].port);
+
+    if (c.multicast.isEnabled())
+        out += "\nmulticast.group = " + c.multicast.group + ":" + std::to_string (c.multicast.port)
+             + "\nmulticast.ttl = " + std::to_string (c.multicast.ttl)
+             + "\nmulticast.interface = " + c.multicast.interface
+             + "\nmulticast.loopback = " + (c.multicast.loopback ? "1" : "0");
+
+    out += "\nfeatures =";
+
+    for (std::size_t i = 0; i < std::size (featureNames); ++i)
+        if ((c.features & (1u << i)) != 0)
+            out += " " + std::string (featureNames[i]);
+
+    char buffer[512];
+    std::snprintf (buffer, sizeof (buffer),
+                   "\ntransport.rate = %.17g\nlevels.rate = %.17g\nspectrum.rate = %.17g\nevents.redundancy = %d\n"
+                   "packet.maxSize = %d\nmidi.minIntervalMs = %.17g\nmidi.minDelta = %d\n"
+                   "parameters.tolerance = %.9g\nwaveform.liveLevel = %d\nwebsocket.port = %d\nmemory.compact = %d\n",
+                   c.transportRateHz, c.levelsRateHz, c.spectrumRateHz, c.eventRedundancy, c.maxPacketSize,
+                   c.midiMinIntervalMs, c.midiMinDelta, static_cast<double> (c.parameterTolerance), c.waveformLiveLevel,
+                   c.websocketPort, c.compactMemory ? 1 : 0);
+
+    out += buffer;
+
+    for (const auto& [key, mapping] : { std::pair { "map.bpm", &c.bpmMapping }, std::pair { "map.levels", &c.levelsMapping },
+                                        std::pair { "map.spectrum", &c.spectrumMapping }, std::pair { "map.parameters", &c.parameterMapping } })
+        if (! mapping->getSource().empty())
+            out += std::string (key) + " = " + mapping->getSource() + "\n";
+
+    return out;
+}
+
+bool parseIpv4 (std::string_view text, std::uint32_t& address)
+{
+    std::uint32_t result = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const auto dot = i < 3 ? text.find ('.') : text.size();
+
+        if (dot == std::string_view::npos || dot == 0)
+            return false;
+
+        std::uint32_t part = 0;
+
+        if (! parseNumber (text.substr (0, dot), part, 0u, 255u))
+            return false;
+
+        result = (result << 8) | part;
+        text = i < 3 ? text.substr (dot + 1) : std::string_view();
+    }
+
+    address = result;
+    return true;
+}
+
+} // namespace dawinfo::config
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Common/Mapping.h"
+#include "Common/Osc.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dawinfo
+{
+
+/** Where the sender's packets go. */
+struct Destination
+{
+    std::string host;
+    int port = 0;
+
+    bool operator== (const Destination& o) const    { return port == o.port && host == o.host; }
+};
+
+/** Multicast output, sent alongside any unicast destinations. */
+struct MulticastOutput
+{
+    std::string group;              // empty when off
+    int port = 0;
+    int ttl = 1;
+    std::string interface;          // address of the outgoing interface; empty lets the OS pick
+    bool loopback = false;          // also deliver to receivers on the sending host
+
+    bool isEnabled() const noexcept     { return ! group.empty(); }
+
+    bool operator== (const MulticastOutput& o) const
+    {
+        return group == o.group && port == o.port && ttl == o.ttl && interface == o.interface && loopback == o.loopback;
+    }
+};
+
+/** Optional parts of the sender, as bits of SenderConfig::features. */
+namespace feature
+{
+    enum Bits : std::uint32_t
+    {
+        transport   = 1 << 0,
+        levels      = 1 << 1,
+        spectrum    = 1 << 2,
+        events      = 1 << 3,
+        metadata    = 1 << 4,
+        midi        = 1 << 5,
+        parameters  = 1 << 6,
+        waveform    = 1 << 7,
+        audioTap    = 1 << 8,
+        tempoMap    = 1 << 9,
+        stereoImage = 1 << 10,
+        all         = (1 << 11) - 1
+    };
+}
+
+//==============================================================================
+/**
+    Everything about the sender that can change while it runs.
+
+    A config is built and validated off the audio thread and never modified
+    once published; see ConfigManager. The same keys work in a config file
+    (one "key = value" per line, # for comments) and over OSC as
+    /dawinfo/config/<key> with a single argument:
+
+        destinations        host:port[, host:port ...]
+        multicast.group     group:port, e.g. 239.255.0.1:9000, or empty for off (stored, not yet applied)
+        multicast.ttl       0 - 255
+        multicast.interface dotted address of the outgoing interface, or empty
+        multicast.loopback  0 or 1
+        features            names from featureNames, space separated, or "all"
+        transport.rate      Hz
+        levels.rate         Hz
+        spectrum.rate       Hz
+        events.redundancy   0 - 8
+        packet.maxSize      bytes
+        midi.minIntervalMs  controller thinning interval
+        midi.minDelta       controller thinning step
+        parameters.tolerance
+        waveform.liveLevel  -1 for none
+        websocket.port      TCP port for browser dashboards, 0 for off (stored, not yet applied)
+        memory.compact      0 or 1: size rings from the rates, see BufferSizes
+        map.bpm             a Mapping for the value, or empty for none (stored, not yet applied)
+        map.levels
+        map.spectrum
+        map.parameters
+*/
+struct SenderConfig
+{
+    std::vector<Destination> destinations { { "127.0.0.1", 9000 } };
+    MulticastOutput multicast;      // for the host to pass to MulticastSink::open()
+    std::uint32_t features = feature::transport | feature::levels | feature::events | feature::metadata;
+
+    double transportRateHz = 60.0;
+    double levelsRateHz = 30.0;
+    double spectrumRateHz = 30.0;
+    int eventRedundancy = 2;
+    int maxPacketSize = 1400;
+    double midiMinIntervalMs = 0.0;
+    int midiMinDelta = 0;
+    float parameterTolerance = 0.002f;
+    int waveformLiveLevel = -1;
+    int websocketPort = 0;          // for the host to pass to WebSocketServer::start()
+    bool compactMemory = false;
+
+    // Compiled when set, so applying one only evaluates it. Nothing applies them yet.
+    Mapping bpmMapping, levelsMapping, spectrumMapping, parameterMapping;
+
+    std::uint64_t version = 0;      // assigned by ConfigManager on publish
+
+    bool isEnabled (feature::Bits f) const noexcept     { return (features & f) != 0; }
+};
+
+namespace config
+{
+    constexpr std::string_view oscPrefix = "/dawinfo/config/";
+
+    /** Feature names in bit order. */
+    extern const std::string_view featureNames[11];
+
+    /** Sets one key. On failure returns false, leaves the config as it was
+        and describes the problem in error.
+    */
+    bool setValue (SenderConfig&, std::string_view key, std::string_view value, std::string& error);
+
+    /** Applies a whole file's worth of lines on top of config. Stops at the
+        first bad line, reporting it with its line number.
+    */
+    bool parse (std::string_view text, SenderConfig&, std::string& error);
+
+    /** Checks the combination of values; setValue() only checks each on its own. */
+    bool validate (const SenderConfig&, std::string& error);
+
+    /** Applies a /dawinfo/config/<key> message. */
+    bool applyMessage (const OscMessage&, SenderConfig&, std::string& error);
+
+    /** Writes a config back out in file form. */
+    std::string format (const SenderConfig&);
+
+    /** Parses a dotted-quad IPv4 address into host byte order. */
+    bool parseIpv4 (std::string_view text, std::uint32_t& address);
+}
+
+} // namespace dawinfo
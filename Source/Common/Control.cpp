@@ -0,0 +1,172 @@
+#include "Common/Control.h"
+
+#include <cmath>
+
+namespace dawinfo::control
+{
+
+namespace
+{
+    struct AddressEntry
+    {
+        std::string_view address;
+        CommandType type;
+    };
+
+    constexpr AddressEntry addresses[] = {
+        { pingAddress,          CommandType::ping },
+        { snapshotAddress,      CommandType::querySnapshot },
+        { subscribeAddress,     CommandType::subscribe },
+        { unsubscribeAddress,   CommandType::unsubscribe },
+        { playAddress,          CommandType::play },
+        { stopAddress,          CommandType::stop },
+        { locateAddress,        CommandType::locate },
+        { historyAddress,       CommandType::queryHistory },
+        { peaksAddress,         CommandType::queryPeaks },
+    };
+
+    /** Reads an optional trailing int. */
+    bool readOptionalInt (OscArgumentReader& r, std::int32_t& out) noexcept
+    {
+        return r.isAtEnd() || (r.readInt32 (out) && r.isAtEnd());
+    }
+}
+
+void writeCommand (OscWriter& w, const Command& c) noexcept
+{
+    for (auto& a : addresses)
+    {
+        if (a.type != c.type)
+            continue;
+
+        switch (c.type)
+        {
+            case CommandType::subscribe:
+                w.beginMessage (a.address, "iii");
+                w.addInt32 (static_cast<std::int32_t> (c.streams));
+                w.addInt32 (c.durationMs);
+                break;
+
+            case CommandType::locate:
+                w.beginMessage (a.address, "di");
+                w.addFloat64 (c.ppq);
+                break;
+
+            case CommandType::queryHistory:
+                w.beginMessage (a.address, "ihhii");
+                w.addInt32 (static_cast<std::int32_t> (c.feature));
+                w.addInt64 (c.fromNs);
+                w.addInt64 (c.toNs);
+                w.addInt32 (c.maxFrames);
+                break;
+
+            case CommandType::queryPeaks:
+                w.beginMessage (a.address, "ihii");
+                w.addInt32 (c.peaks.level);
+                w.addInt64 (c.peaks.firstBin);
+                w.addInt32 (c.peaks.numBins);
+                break;
+
+            default:
+                w.beginMessage (a.address, "i");
+                break;
+        }
+
+        w.addInt32 (c.token);
+        w.endMessage();
+        return;
+    }
+}
+
+bool decodeCommand (const OscMessage& m, Command& c) noexcept
+{
+    Command result;
+    bool known = false;
+
+    for (auto& a : addresses)
+    {
+        if (m.address == a.address)
+        {
+            result.type = a.type;
+            known = true;
+        }
+    }
+
+    if (! known)
+        return false;
+
+    OscArgumentReader r (m);
+
+    if (result.type == CommandType::subscribe)
+    {
+        std::int32_t streams = 0;
+
+        if (! r.readInt32 (streams))
+            return false;
+
+        result.streams = static_cast<std::uint32_t> (streams);
+
+        if (! r.isAtEnd() && ! r.readInt32 (result.durationMs))
+            return false;
+
+        if (result.durationMs < 0 || result.durationMs > maxSubscriptionMs)
+            return false;
+    }
+
+    if (result.type == CommandType::locate)
+    {
+        float ppq = 0.0f;
+
+        if (! m.typeTags.empty() && m.typeTags[0] == 'f')
+        {
+            if (! r.readFloat32 (ppq))
+                return false;
+
+            result.ppq = ppq;
+        }
+        else if (! r.readFloat64 (result.ppq))
+        {
+            return false;
+        }
+
+        // The target goes straight to the host.
+        if (! std::isfinite (result.ppq))
+            return false;
+    }
+
+    if (result.type == CommandType::queryHistory)
+    {
+        std::int32_t feature = 0;
+
+        if (! (r.readInt32 (feature) && r.readInt64 (result.fromNs) && r.readInt64 (result.toNs)))
+            return false;
+
+        if (feature < 0 || feature >= static_cast<std::int32_t> (history::Feature::numFeatures))
+            return false;
+
+        result.feature = static_cast<history::Feature> (feature);
+
+        if (! r.isAtEnd() && ! r.readInt32 (result.maxFrames))
+            return false;
+
+        if (result.maxFrames < 0 || result.maxFrames > maxHistoryFrames)
+            return false;
+    }
+
+    if (result.type == CommandType::queryPeaks)
+    {
+        auto& p = result.peaks;
+
+        if (! (r.readInt32 (p.level) && r.readInt64 (p.firstBin) && r.readInt32 (p.numBins))
+             || p.level < 0 || p.numBins < 0)
+            return false;
+    }
+
+    if (! readOptionalInt (r, result.token))
+        return false;
+
+    c = result;
+    return true;
+}
+
+} // namespace dawinfo::control
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Common/History.h"
+#include "Common/Peaks.h"
+#include "Common/Protocol.h"
+
+#include <cstdint>
+#include <string_view>
+
+namespace dawinfo
+{
+
+/*  Commands a controller sends to the sender's control port, and the replies
+    it gets back on StreamId::control.
+
+        /ping               [,i token]
+        /query/snapshot     [,i token]          replies with the transport state
+        /subscribe          ,i streams [,i ms [,i token]]
+                                            streams has a bit per StreamId
+        /unsubscribe        [,i token]
+        /transport/play     [,i token]
+        /transport/stop     [,i token]
+        /transport/locate   ,d ppq [,i token]   a float ppq is accepted too; NaN and
+                                            infinities are refused
+        /query/history      ,ihh feature fromNs toNs [,i maxFrames [,i token]]
+                                            replies, then streams the window as
+                                            /dawinfo/history chunks (see History.h)
+        /dawinfo/peaks/request  ,ihi level firstBin numBins [,i token]
+                                            replies, then sends the range as
+                                            /dawinfo/peaks summaries (see Peaks.h)
+
+    The optional token is echoed in the /dawinfo/reply (see Messages.h) so a
+    controller can match replies to requests. A subscription lasts for the
+    given milliseconds, or defaultSubscriptionMs, and is renewed by sending
+    it again.
+
+    History windows are in sender time (TransportSnapshot::timeNs); times of
+    zero or less count back from when the query arrived, so 0 to -10 s is
+    "the last ten seconds". maxFrames caps the answer, and picks how coarse
+    a tier it comes from; 0 means defaultHistoryFrames.
+*/
+namespace control
+{
+    constexpr std::string_view pingAddress         = "/ping";
+    constexpr std::string_view snapshotAddress     = "/query/snapshot";
+    constexpr std::string_view subscribeAddress    = "/subscribe";
+    constexpr std::string_view unsubscribeAddress  = "/unsubscribe";
+    constexpr std::string_view playAddress         = "/transport/play";
+    constexpr std::string_view stopAddress         = "/transport/stop";
+    constexpr std::string_view locateAddress       = "/transport/locate";
+    constexpr std::string_view historyAddress      = "/query/history";
+    constexpr std::string_view peaksAddress        = peaks::requestAddress;
+
+    constexpr std::int32_t defaultSubscriptionMs = 10000;
+    constexpr std::int32_t maxSubscriptionMs = 3600 * 1000;
+    constexpr std::int32_t defaultHistoryFrames = 1024;
+    constexpr std::int32_t maxHistoryFrames = 16384;
+
+    enum class CommandType : std::int32_t
+    {
+        ping = 0,
+        querySnapshot,
+        subscribe,
+        unsubscribe,
+        play,
+        stop,
+        locate,
+        queryHistory,
+        queryPeaks
+    };
+
+    enum class Status : std::int32_t
+    {
+        ok = 0,
+        rejected,       // e.g. too many subscribers, or no history or waveform to answer from
+        busy            // the audio thread's mailbox was full
+    };
+
+    struct Command
+    {
+        CommandType type = CommandType::ping;
+        std::int32_t token = 0;
+        std::uint32_t streams = 0;          // subscribe
+        std::int32_t durationMs = 0;        // subscribe; 0 means the default
+        double ppq = 0.0;                   // locate
+        history::Feature feature = history::Feature::levels;    // queryHistory
+        HostTimeNs fromNs = 0, toNs = 0;    // queryHistory
+        std::int32_t maxFrames = 0;         // queryHistory; 0 means the default
+        peaks::Request peaks {};            // queryPeaks
+
+        /** Commands the audio thread has to carry out. */
+        bool isTransportCommand() const noexcept
+        {
+            return type == CommandType::play || type == CommandType::stop || type == CommandType::locate;
+        }
+    };
+
+    /** The body of every reply. */
+    struct Reply
+    {
+        std::int32_t token = 0;
+        CommandType command = CommandType::ping;
+        Status status = Status::ok;
+        HostTimeNs receivedNs = 0;          // when the command arrived, sender clock
+    };
+
+    constexpr std::uint32_t streamBit (StreamId s) noexcept
+    {
+        return 1u << static_cast<unsigned> (s);
+    }
+
+    void writeCommand (OscWriter&, const Command&) noexcept;
+
+    /** False for addresses that aren't commands or arguments that don't fit. */
+    bool decodeCommand (const OscMessage&, Command&) noexcept;
+}
+
+} // namespace dawinfo
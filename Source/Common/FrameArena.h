@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace dawinfo
+{
+
+/**
+    Bump allocator for everything one publish cycle needs: packet buffers,
+    message lists, scratch arrays.
+
+    The memory is allocated once in the constructor. allocate() just advances
+    an offset, and reset() rewinds it, so a whole cycle's worth of
+    allocations is freed at once in constant time. Only trivially
+    destructible types can live here, since nothing is destroyed.
+
+    One arena per thread: it does no locking. When a cycle asks for more than
+    the capacity, allocate() returns nullptr and counts an overflow; size the
+    arena from getHighWater() so that never happens in steady state.
+*/
+class FrameArena
+{
+public:
+    explicit FrameArena (std::size_t capacityBytes)
+        : capacity (capacityBytes), memory (std::make_unique<std::byte[]> (capacityBytes))
+    {
+    }
+
+    FrameArena (const FrameArena&) = delete;
+    FrameArena& operator= (const FrameArena&) = delete;
+
+    /** Raw bytes, or nullptr if the arena is full. */
+    void* allocate (std::size_t size, std::size_t alignment = alignof (std::max_align_t)) noexcept
+    {
+        const auto base = reinterpret_cast<std::uintptr_t> (memory.get());
+        const auto start = ((base + used + alignment - 1) & ~(static_cast<std::uintptr_t> (alignment) - 1)) - base;
+
+        if (start + size > capacity)
+        {
+            ++overflows;
+            return nullptr;
+        }
+
+        used = start + size;
+        highWater = used > highWater ? used : highWater;
+        return memory.get() + start;
+    }
+
+    /** Default-constructed array of n T, or nullptr if the arena is full. */
+    template <typename T>
+    T* allocateArray (std::size_t n) noexcept
+    {
+        static_assert (std::is_trivially_destructible_v<T>, "arena memory is released without running destructors");
+        static_assert (std::is_nothrow_default_constructible_v<T>);
+
+        auto* p = static_cast<T*> (allocate (n * sizeof (T), alignof (T)));
+
+        if (p != nullptr)
+            for (std::size_t i = 0; i < n; ++i)
+                new (p + i) T();
+
+        return p;
+    }
+
+    /** Ends the cycle: everything allocated since the last reset is gone. */
+    void reset() noexcept                           { used = 0; }
+
+    std::size_t getUsed() const noexcept            { return used; }
+    std::size_t getCapacity() const noexcept        { return capacity; }
+    std::size_t getHighWater() const noexcept       { return highWater; }
+    std::uint64_t getOverflows() const noexcept     { return overflows; }
+
+private:
+    const std::size_t capacity;
+    std::unique_ptr<std::byte[]> memory;
+    std::size_t used = 0, highWater = 0;
+    std::uint64_t overflows = 0;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,95 @@
+#include "Common/History.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace dawinfo::history
+{
+
+namespace
+{
+    void writeBigEndian32 (std::uint8_t* p, std::uint32_t v) noexcept
+    {
+        p[0] = static_cast<std::uint8_t> (v >> 24);
+        p[1] = static_cast<std::uint8_t> (v >> 16);
+        p[2] = static_cast<std::uint8_t> (v >> 8);
+        p[3] = static_cast<std::uint8_t> (v);
+    }
+
+    constexpr std::size_t paddedBlobSize (std::size_t bytes) noexcept
+    {
+        return 4 + ((bytes + 3) & ~std::size_t (3));
+    }
+}
+
+void writeChunk (OscWriter& w, const ChunkHeader& h, const HostTimeNs* times, const float* values) noexcept
+{
+    std::uint8_t packedTimes[maxChunkBytes], packedValues[maxChunkBytes];
+    const auto numValues = static_cast<std::size_t> (std::clamp (h.numValues, 0, maxValues));
+    const auto numFrames = static_cast<std::size_t> (std::clamp (h.numFrames, 0, maxFramesPerChunk (h.numValues)));
+
+    for (std::size_t i = 0; i < numFrames; ++i)
+    {
+        constexpr HostTimeNs maxOffsetUs = std::numeric_limits<std::int32_t>::max();
+        const auto offsetUs = std::clamp<HostTimeNs> ((times[i] - h.firstNs) / 1000, 0, maxOffsetUs);
+        writeBigEndian32 (packedTimes + i * 4, static_cast<std::uint32_t> (offsetUs));
+    }
+
+    for (std::size_t i = 0; i < numFrames * numValues; ++i)
+    {
+        std::uint32_t bits;
+        std::memcpy (&bits, values + i, sizeof (bits));
+        writeBigEndian32 (packedValues + i * 4, bits);
+    }
+
+    w.beginMessage (chunkAddress, "iiiiiihbb");
+    w.addInt32 (h.token);
+    w.addInt32 (static_cast<std::int32_t> (h.feature));
+    w.addInt32 (h.tier);
+    w.addInt32 (static_cast<std::int32_t> (numValues));
+    w.addInt32 (static_cast<std::int32_t> (numFrames));
+    w.addInt32 (h.isLast ? 1 : 0);
+    w.addInt64 (h.firstNs);
+    w.addBlob (packedTimes, numFrames * 4);
+    w.addBlob (packedValues, numFrames * numValues * 4);
+    w.endMessage();
+}
+
+std::size_t chunkSize (std::int32_t numFrames, int numValues) noexcept
+{
+    const auto frames = static_cast<std::size_t> (numFrames);
+
+    return 4 + OscWriter::paddedStringSize (chunkAddress.size()) + OscWriter::paddedStringSize (10)
+             + 6 * 4 + 8 + paddedBlobSize (frames * 4) + paddedBlobSize (frames * static_cast<std::size_t> (numValues) * 4);
+}
+
+//==============================================================================
+bool decodeChunk (const OscMessage& m, ChunkHeader& h, const std::uint8_t*& times, const std::uint8_t*& values) noexcept
+{
+    if (m.address != chunkAddress)
+        return false;
+
+    OscArgumentReader r (m);
+    std::int32_t feature = 0, isLast = 0;
+    std::size_t timesSize = 0, valuesSize = 0;
+
+    if (! (r.readInt32 (h.token) && r.readInt32 (feature) && r.readInt32 (h.tier) && r.readInt32 (h.numValues)
+            && r.readInt32 (h.numFrames) && r.readInt32 (isLast) && r.readInt64 (h.firstNs)
+            && r.readBlob (times, timesSize) && r.readBlob (values, valuesSize)))
+        return false;
+
+    h.feature = static_cast<Feature> (feature);
+    h.isLast = isLast != 0;
+
+    // Leaves room for timeAt() to add any 32-bit offset without overflowing.
+    constexpr HostTimeNs offsetRangeNs = (HostTimeNs (1) << 31) * 1000;
+    const bool firstNsInRange = h.firstNs >= std::numeric_limits<HostTimeNs>::min() + offsetRangeNs
+                                 && h.firstNs <= std::numeric_limits<HostTimeNs>::max() - offsetRangeNs;
+
+    return firstNsInRange && feature >= 0 && h.feature < Feature::numFeatures && h.tier >= 0
+            && h.numValues > 0 && h.numValues <= maxValues && h.numFrames >= 0
+            && timesSize == static_cast<std::size_t> (h.numFrames) * 4
+            && valuesSize == static_cast<std::size_t> (h.numFrames) * static_cast<std::size_t> (h.numValues) * 4;
+}
+
+} // namespace dawinfo::history
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Common/Osc.h"
+#include "Common/Transport.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace dawinfo
+{
+
+/*  Feature history goes out in chunks that carry packed blobs, so it isn't
+    a schema message (see WireType in Common/Schema.h).
+
+    A controller asks for a window with /query/history (see Control.h) and
+    gets the frames in it back on StreamId::control, from the control port,
+    a few chunks per sender cycle:
+
+        /dawinfo/history    ,iiiiiihbb  token feature tier numValues numFrames isLast firstNs times values
+
+    token echoes the request. times holds numFrames big-endian int32 offsets
+    from firstNs in microseconds; values holds numFrames * numValues
+    big-endian float32s, frame-major. The last chunk of a query has isLast
+    set; a window with nothing in it is answered with a single empty chunk.
+    Frames that fell out of the ring while the query was being streamed are
+    skipped, which shows as a gap in the times.
+*/
+namespace history
+{
+    constexpr std::string_view chunkAddress = "/dawinfo/history";
+
+    enum class Feature : std::int32_t
+    {
+        levels = 0,
+        spectrum,
+        numFeatures
+    };
+
+    /** Widest frame a history keeps, e.g. spectrum bins. */
+    constexpr int maxValues = 256;
+
+    /** Packed bytes per chunk, both blobs together. */
+    constexpr std::size_t maxChunkBytes = 1152;
+
+    struct ChunkHeader
+    {
+        std::int32_t token = 0;
+        Feature feature = Feature::levels;
+        std::int32_t tier = 0;
+        std::int32_t numValues = 0;
+        std::int32_t numFrames = 0;
+        bool isLast = false;
+        HostTimeNs firstNs = 0;
+    };
+
+    /** The most frames of the given width one chunk can carry. */
+    constexpr std::int32_t maxFramesPerChunk (int numValues) noexcept
+    {
+        return static_cast<std::int32_t> (maxChunkBytes / (4 + 4 * static_cast<std::size_t> (numValues < 1 ? 1 : numValues)));
+    }
+
+    /** times holds numFrames entries, values numFrames * numValues, frame-major. */
+    void writeChunk (OscWriter&, const ChunkHeader&, const HostTimeNs* times, const float* values) noexcept;
+
+    /** Bytes each chunk takes inside a bundle, including the size prefix. */
+    std::size_t chunkSize (std::int32_t numFrames, int numValues) noexcept;
+
+    /** times and values point into the message; read them with timeAt() and valueAt(). */
+    bool decodeChunk (const OscMessage&, ChunkHeader&, const std::uint8_t*& times, const std::uint8_t*& values) noexcept;
+
+    inline std::uint32_t readBigEndian32 (const std::uint8_t* p) noexcept
+    {
+        return (static_cast<std::uint32_t> (p[0]) << 24) | (static_cast<std::uint32_t> (p[1]) << 16)
+                 | (static_cast<std::uint32_t> (p[2]) << 8) | static_cast<std::uint32_t> (p[3]);
+    }
+
+    inline HostTimeNs timeAt (const ChunkHeader& h, const std::uint8_t* times, std::size_t frame) noexcept
+    {
+        return h.firstNs + static_cast<HostTimeNs> (static_cast<std::int32_t> (readBigEndian32 (times + frame * 4))) * 1000;
+    }
+
+    inline float valueAt (const std::uint8_t* values, std::size_t index) noexcept
+    {
+        const auto bits = readBigEndian32 (values + index * 4);
+        float f;
+        std::memcpy (&f, &bits, sizeof (f));
+        return f;
+    }
+}
+
+} // namespace dawinfo
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace dawinfo
+{
+
+/**
+    The most recent value of some state, written by one thread and read by
+    any number of others: a seqlock.
+
+    store() is wait-free and never blocks on readers, so the audio thread can
+    be the writer. A reader copies the value and retries if a store overlapped
+    the copy; it only ever sees complete values, and has to spin only while a
+    store is actually in progress.
+*/
+template <typename T>
+class LatestValue
+{
+public:
+    static_assert (std::is_trivially_copyable_v<T>, "values are copied byte-wise");
+
+    LatestValue() = default;
+    explicit LatestValue (const T& initial) noexcept : value (initial) {}
+
+    /** Writer thread only. */
+    void store (const T& v) noexcept
+    {
+        const auto s = sequence.load (std::memory_order_relaxed);
+        sequence.store (s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+        value = v;
+        sequence.store (s + 2, std::memory_order_release);
+    }
+
+    /** Any thread. */
+    T load() const noexcept
+    {
+        for (;;)
+        {
+            const auto before = sequence.load (std::memory_order_acquire);
+            T copy = value;
+            std::atomic_thread_fence (std::memory_order_acquire);
+
+            if ((before & 1) == 0 && sequence.load (std::memory_order_relaxed) == before)
+                return copy;
+        }
+    }
+
+    /** How many times store() has been called. */
+    std::uint64_t getVersion() const noexcept   { return sequence.load (std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<std::uint64_t> sequence { 0 };
+    T value {};
+};
+
+} // namespace dawinfo
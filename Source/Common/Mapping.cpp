@@ -0,0 +1,623 @@
+#include "Common/Mapping.h"
+#include "Common/Simd.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace dawinfo
+{
+
+namespace
+{
+    using Op = Mapping::Op;
+    using simd::Float4;
+
+    /** Elements mapped per pass over the program. */
+    constexpr int blockSize = 64;
+
+    /** Deeper nesting than this is refused rather than risking the parser's stack. */
+    constexpr int maxNesting = 64;
+
+    struct Function
+    {
+        std::string_view name;
+        int arity;
+        Op op;
+    };
+
+    constexpr Function functions[] = {
+        { "abs", 1, Op::abs }, { "sqrt", 1, Op::sqrt }, { "exp", 1, Op::exp }, { "log", 1, Op::log },
+        { "log10", 1, Op::log10 }, { "floor", 1, Op::floor }, { "db", 1, Op::db }, { "gain", 1, Op::gain },
+        { "min", 2, Op::min }, { "max", 2, Op::max }, { "pow", 2, Op::pow },
+        { "clamp", 3, Op::clamp }, { "scale", 5, Op::scale }
+    };
+
+    // min and max pick the same operand as SSE does, so both paths agree.
+    float minOf (float a, float b) noexcept     { return a < b ? a : b; }
+    float maxOf (float a, float b) noexcept     { return a > b ? a : b; }
+
+    float applyUnary (Op op, float v) noexcept
+    {
+        switch (op)
+        {
+            case Op::neg:       return -v;
+            case Op::abs:       return std::abs (v);
+            case Op::sqrt:      return std::sqrt (v);
+            case Op::exp:       return std::exp (v);
+            case Op::log:       return std::log (v);
+            case Op::log10:     return std::log10 (v);
+            case Op::floor:     return std::floor (v);
+            case Op::db:        return 20.0f * std::log10 (std::max (v, 1.0e-10f));
+            case Op::gain:      return std::pow (10.0f, v * 0.05f);
+            default:            return v;
+        }
+    }
+
+    float applyBinary (Op op, float a, float b) noexcept
+    {
+        switch (op)
+        {
+            case Op::add:       return a + b;
+            case Op::sub:       return a - b;
+            case Op::mul:       return a * b;
+            case Op::div:       return a / b;
+            case Op::pow:       return std::pow (a, b);
+            case Op::min:       return minOf (a, b);
+            case Op::max:       return maxOf (a, b);
+            default:            return a;
+        }
+    }
+
+    float applyScale (float v, float inLo, float inHi, float outLo, float outHi) noexcept
+    {
+        return outLo + (v - inLo) * (outHi - outLo) / (inHi - inLo);
+    }
+
+    //==============================================================================
+    template <typename Fn>
+    void eachLane (float* a, int width, Fn fn) noexcept
+    {
+        for (int j = 0; j < width; ++j)
+            a[j] = fn (a[j]);
+    }
+
+    template <typename Fn>
+    void eachFloat4 (float* a, int width, Fn fn) noexcept
+    {
+        for (int j = 0; j < width; j += 4)
+            fn (Float4::load (a + j)).store (a + j);
+    }
+
+    template <typename Fn>
+    void eachFloat4 (float* a, const float* b, int width, Fn fn) noexcept
+    {
+        for (int j = 0; j < width; j += 4)
+            fn (Float4::load (a + j), Float4::load (b + j)).store (a + j);
+    }
+
+    void fill (float* a, int width, float value) noexcept
+    {
+        std::fill (a, a + width, value);
+    }
+}
+
+//==============================================================================
+/** Recursive descent straight to stack code, folding as it goes. */
+class MappingCompiler
+{
+public:
+    MappingCompiler (std::string_view t, Mapping& m, std::string& e) : text (t), out (m), error (e) {}
+
+    bool run()
+    {
+        skipSpace();
+
+        if (pos == text.size())
+        {
+            emit ({ Op::input }, 1);
+            return ok;
+        }
+
+        expression();
+        skipSpace();
+
+        if (ok && pos != text.size())
+            fail ("unexpected '" + std::string (1, text[pos]) + "'");
+
+        return ok;
+    }
+
+private:
+    //==============================================================================
+    void expression()
+    {
+        term();
+
+        while (ok)
+        {
+            if (accept ('+'))       { term(); binary (Op::add); }
+            else if (accept ('-'))  { term(); binary (Op::sub); }
+            else                    break;
+        }
+    }
+
+    void term()
+    {
+        unary();
+
+        while (ok)
+        {
+            if (accept ('*'))       { unary(); binary (Op::mul); }
+            else if (accept ('/'))  { unary(); binary (Op::div); }
+            else                    break;
+        }
+    }
+
+    void unary()
+    {
+        if (++nesting > maxNesting)
+        {
+            fail ("nested too deeply");
+        }
+        else if (accept ('-'))
+        {
+            unary();
+            unaryOp (Op::neg);
+        }
+        else
+        {
+            power();
+        }
+
+        --nesting;
+    }
+
+    void power()
+    {
+        primary();
+
+        // Right-associative, and binds tighter than a leading minus: -x^2 is -(x^2).
+        if (ok && accept ('^'))
+        {
+            unary();
+            binary (Op::pow);
+        }
+    }
+
+    void primary()
+    {
+        skipSpace();
+
+        if (! ok)
+            return;
+
+        if (pos == text.size())
+            return fail ("expected a value");
+
+        const char c = text[pos];
+
+        if (c == '(')
+        {
+            ++pos;
+            expression();
+            expect (')');
+        }
+        else if ((c >= '0' && c <= '9') || c == '.')
+        {
+            number();
+        }
+        else if (isNameStart (c))
+        {
+            name();
+        }
+        else
+        {
+            fail ("unexpected '" + std::string (1, c) + "'");
+        }
+    }
+
+    void number()
+    {
+        float value = 0.0f;
+        const auto result = std::from_chars (text.data() + pos, text.data() + text.size(), value);
+
+        if (result.ec != std::errc() || ! std::isfinite (value))
+            return fail ("bad number");
+
+        pos = static_cast<std::size_t> (result.ptr - text.data());
+        constant (value);
+    }
+
+    void name()
+    {
+        const auto start = pos;
+
+        while (pos < text.size() && (isNameStart (text[pos]) || (text[pos] >= '0' && text[pos] <= '9')))
+            ++pos;
+
+        const auto word = text.substr (start, pos - start);
+
+        if (word == "x")        return emit ({ Op::input }, 1);
+        if (word == "i")        return emit ({ Op::index }, 1);
+        if (word == "n")        return emit ({ Op::count }, 1);
+        if (word == "pi")       return constant (3.14159265358979f);
+
+        const auto* f = std::find_if (std::begin (functions), std::end (functions), [&] (const Function& fn) { return fn.name == word; });
+
+        if (f == std::end (functions))
+        {
+            pos = start;
+            return fail ("unknown name '" + std::string (word) + "'");
+        }
+
+        expect ('(');
+
+        const auto wrongCount = std::string (f->name) + " takes " + std::to_string (f->arity)
+                              + (f->arity == 1 ? " argument" : " arguments");
+
+        for (int arg = 0; arg < f->arity && ok; ++arg)
+        {
+            if (arg > 0 && ! accept (','))
+                return fail (peek (')') ? wrongCount : "expected ','");
+
+            expression();
+        }
+
+        if (ok && ! accept (')'))
+            return fail (peek (',') ? wrongCount : "expected ')'");
+
+        if (f->arity == 1)          unaryOp (f->op);
+        else if (f->arity == 2)     binary (f->op);
+        else if (f->op == Op::clamp) clamp();
+        else                        scale();
+    }
+
+    //==============================================================================
+    void binary (Op op)
+    {
+        if (! ok)
+            return;
+
+        if (isConstant (0) && isConstant (1))
+        {
+            const auto b = takeConstant();
+            const auto a = takeConstant();
+            return constant (applyBinary (op, a, b));
+        }
+
+        if (isConstant (0))
+        {
+            const auto k = takeConstant();
+
+            switch (op)
+            {
+                case Op::add:   return immediate (Op::addK, k);
+                case Op::sub:   return immediate (Op::addK, -k);
+                case Op::mul:   return immediate (Op::mulK, k);
+                case Op::div:   return immediate (Op::divK, k);
+                case Op::pow:   return immediate (Op::powK, k);
+                case Op::min:   return immediate (Op::minK, k);
+                case Op::max:   return immediate (Op::maxK, k);
+                default:        break;
+            }
+        }
+
+        emit ({ op }, -1);
+    }
+
+    void immediate (Op op, float a, float b = 0.0f)
+    {
+        auto& last = out.program[static_cast<std::size_t> (out.numInstructions - 1)];
+
+        // x * a + b, the shape of every linear remap.
+        if (op == Op::addK && last.op == Op::mulK)
+        {
+            last = { Op::mulAddK, last.a, a };
+            return;
+        }
+
+        emit ({ op, a, b }, 0);
+    }
+
+    void unaryOp (Op op)
+    {
+        if (! ok)
+            return;
+
+        if (isConstant (0))
+            return constant (applyUnary (op, takeConstant()));
+
+        emit ({ op }, 0);
+    }
+
+    void clamp()
+    {
+        if (isConstant (0) && isConstant (1))
+        {
+            const auto hi = takeConstant();
+            const auto lo = takeConstant();
+
+            if (isConstant (0))
+                return constant (minOf (maxOf (takeConstant(), lo), hi));
+
+            return emit ({ Op::clampK, lo, hi }, 0);
+        }
+
+        emit ({ Op::clamp }, -2);
+    }
+
+    void scale()
+    {
+        if (isConstant (0) && isConstant (1) && isConstant (2) && isConstant (3))
+        {
+            const auto outHi = takeConstant();
+            const auto outLo = takeConstant();
+            const auto inHi = takeConstant();
+            const auto inLo = takeConstant();
+
+            if (inHi == inLo)
+                return fail ("scale needs an input range that isn't empty");
+
+            // A fixed range is a multiply and an add.
+            const auto k = (outHi - outLo) / (inHi - inLo);
+            constant (k);
+            binary (Op::mul);
+            constant (outLo - inLo * k);
+            return binary (Op::add);
+        }
+
+        emit ({ Op::scale }, -4);
+    }
+
+    //==============================================================================
+    void constant (float v)     { emit ({ Op::constant, v }, 1); }
+
+    void emit (Mapping::Instruction instruction, int stackChange)
+    {
+        if (! ok)
+            return;
+
+        if (out.numInstructions == Mapping::maxInstructions)
+            return fail ("too long");
+
+        depth += stackChange;
+
+        if (depth > Mapping::maxStack)
+            return fail ("needs too deep a stack");
+
+        out.program[static_cast<std::size_t> (out.numInstructions++)] = instruction;
+    }
+
+    bool isConstant (int fromTop) const noexcept
+    {
+        return out.numInstructions > fromTop
+            && out.program[static_cast<std::size_t> (out.numInstructions - 1 - fromTop)].op == Op::constant;
+    }
+
+    float takeConstant() noexcept
+    {
+        --depth;
+        return out.program[static_cast<std::size_t> (--out.numInstructions)].a;
+    }
+
+    //==============================================================================
+    static bool isNameStart (char c) noexcept
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    void skipSpace() noexcept
+    {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t'))
+            ++pos;
+    }
+
+    bool peek (char c) noexcept
+    {
+        skipSpace();
+        return pos < text.size() && text[pos] == c;
+    }
+
+    bool accept (char c) noexcept
+    {
+        skipSpace();
+
+        if (pos < text.size() && text[pos] == c)
+        {
+            ++pos;
+            return true;
+        }
+
+        return false;
+    }
+
+    void expect (char c)
+    {
+        if (ok && ! accept (c))
+            fail (std::string ("expected '") + c + "'");
+    }
+
+    void fail (const std::string& message)
+    {
+        if (ok)
+            error = "at column " + std::to_string (pos + 1) + ": " + message;
+
+        ok = false;
+    }
+
+    std::string_view text;
+    Mapping& out;
+    std::string& error;
+    std::size_t pos = 0;
+    int depth = 0, nesting = 0;
+    bool ok = true;
+};
+
+//==============================================================================
+Mapping::Mapping() noexcept
+{
+    program[0] = { Op::input };
+    numInstructions = 1;
+}
+
+bool Mapping::compile (std::string_view text, Mapping& out, std::string& error)
+{
+    Mapping m;
+    m.numInstructions = 0;
+
+    if (! MappingCompiler (text, m, error).run())
+        return false;
+
+    m.source.assign (text.data(), text.size());
+    out = std::move (m);
+    return true;
+}
+
+float Mapping::evaluate (float x, int index, int count) const noexcept
+{
+    float stack[maxStack];
+    int top = -1;
+
+    for (int p = 0; p < numInstructions; ++p)
+    {
+        const auto& in = program[static_cast<std::size_t> (p)];
+        float& v = stack[top < 0 ? 0 : top];
+
+        switch (in.op)
+        {
+            case Op::input:     stack[++top] = x; break;
+            case Op::index:     stack[++top] = static_cast<float> (index); break;
+            case Op::count:     stack[++top] = static_cast<float> (count); break;
+            case Op::constant:  stack[++top] = in.a; break;
+
+            case Op::add: case Op::sub: case Op::mul: case Op::div: case Op::pow: case Op::min: case Op::max:
+                stack[top - 1] = applyBinary (in.op, stack[top - 1], v);
+                --top;
+                break;
+
+            case Op::addK:      v = v + in.a; break;
+            case Op::mulK:      v = v * in.a; break;
+            case Op::mulAddK:   v = v * in.a + in.b; break;
+            case Op::divK:      v = v / in.a; break;
+            case Op::powK:      v = std::pow (v, in.a); break;
+            case Op::minK:      v = minOf (v, in.a); break;
+            case Op::maxK:      v = maxOf (v, in.a); break;
+            case Op::clampK:    v = minOf (maxOf (v, in.a), in.b); break;
+
+            case Op::clamp:
+                stack[top - 2] = minOf (maxOf (stack[top - 2], stack[top - 1]), v);
+                top -= 2;
+                break;
+
+            case Op::scale:
+                stack[top - 4] = applyScale (stack[top - 4], stack[top - 3], stack[top - 2], stack[top - 1], v);
+                top -= 4;
+                break;
+
+            default:            v = applyUnary (in.op, v); break;
+        }
+    }
+
+    return stack[0];
+}
+
+void Mapping::evaluate (const float* input, float* output, int n) const noexcept
+{
+    // Lanes past the end of a short block hold zeros and are never stored.
+    alignas (16) float stack[maxStack][blockSize];
+
+    for (int start = 0; start < n; start += blockSize)
+    {
+        const int length = std::min (blockSize, n - start);
+        const int width = (length + 3) & ~3;
+        int top = -1;
+
+        for (int p = 0; p < numInstructions; ++p)
+        {
+            const auto& in = program[static_cast<std::size_t> (p)];
+            float* v = stack[top < 0 ? 0 : top];
+            float* under = stack[top < 1 ? 0 : top - 1];
+            const auto a = Float4::broadcast (in.a), b = Float4::broadcast (in.b);
+
+            switch (in.op)
+            {
+                case Op::input:
+                    v = stack[++top];
+                    std::copy (input + start, input + start + length, v);
+                    std::fill (v + length, v + width, 0.0f);
+                    break;
+
+                case Op::index:
+                    v = stack[++top];
+
+                    for (int j = 0; j < width; ++j)
+                        v[j] = static_cast<float> (start + j);
+
+                    break;
+
+                case Op::count:     fill (stack[++top], width, static_cast<float> (n)); break;
+                case Op::constant:  fill (stack[++top], width, in.a); break;
+
+                case Op::add:   eachFloat4 (under, v, width, [] (Float4 x, Float4 y) { return x + y; }); --top; break;
+                case Op::sub:   eachFloat4 (under, v, width, [] (Float4 x, Float4 y) { return x - y; }); --top; break;
+                case Op::mul:   eachFloat4 (under, v, width, [] (Float4 x, Float4 y) { return x * y; }); --top; break;
+                case Op::div:   eachFloat4 (under, v, width, [] (Float4 x, Float4 y) { return x / y; }); --top; break;
+                case Op::min:   eachFloat4 (under, v, width, [] (Float4 x, Float4 y) { return min (x, y); }); --top; break;
+                case Op::max:   eachFloat4 (under, v, width, [] (Float4 x, Float4 y) { return max (x, y); }); --top; break;
+
+                case Op::pow:
+                    for (int j = 0; j < width; ++j)
+                        under[j] = std::pow (under[j], v[j]);
+
+                    --top;
+                    break;
+
+                case Op::addK:      eachFloat4 (v, width, [&] (Float4 x) { return x + a; }); break;
+                case Op::mulK:      eachFloat4 (v, width, [&] (Float4 x) { return x * a; }); break;
+                case Op::mulAddK:   eachFloat4 (v, width, [&] (Float4 x) { return x * a + b; }); break;
+                case Op::divK:      eachFloat4 (v, width, [&] (Float4 x) { return x / a; }); break;
+                case Op::minK:      eachFloat4 (v, width, [&] (Float4 x) { return min (x, a); }); break;
+                case Op::maxK:      eachFloat4 (v, width, [&] (Float4 x) { return max (x, a); }); break;
+                case Op::clampK:    eachFloat4 (v, width, [&] (Float4 x) { return min (max (x, a), b); }); break;
+                case Op::powK:      eachLane (v, width, [&] (float x) { return std::pow (x, in.a); }); break;
+                case Op::neg:       eachFloat4 (v, width, [] (Float4 x) { return Float4::zero() - x; }); break;
+
+                case Op::clamp:
+                {
+                    float* lo = stack[top - 1];
+                    float* value = stack[top - 2];
+
+                    for (int j = 0; j < width; j += 4)
+                        min (max (Float4::load (value + j), Float4::load (lo + j)), Float4::load (v + j)).store (value + j);
+
+                    top -= 2;
+                    break;
+                }
+
+                case Op::scale:
+                {
+                    float* value = stack[top - 4];
+
+                    for (int j = 0; j < width; j += 4)
+                    {
+                        const auto inLo = Float4::load (stack[top - 3] + j), inHi = Float4::load (stack[top - 2] + j);
+                        const auto outLo = Float4::load (stack[top - 1] + j), outHi = Float4::load (v + j);
+                        (outLo + (Float4::load (value + j) - inLo) * (outHi - outLo) / (inHi - inLo)).store (value + j);
+                    }
+
+                    top -= 4;
+                    break;
+                }
+
+                default:
+                    eachLane (v, width, [op = in.op] (float x) { return applyUnary (op, x); });
+                    break;
+            }
+        }
+
+        std::copy (stack[0], stack[0] + length, output + start);
+    }
+}
+
+} // namespace dawinfo
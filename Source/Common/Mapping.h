@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace dawinfo
+{
+
+//==============================================================================
+/**
+    A value mapping written as a small expression, for remapping and scaling
+    what the sender sends: BPM to 0..1, levels to dB, a tilt across a spectrum.
+
+        clamp ((x - 60) / 120, 0, 1)
+        scale (db (x), -60, 0, 0, 1)
+        x * gain (3 * i / n)
+
+    x is the input value. When a whole array is mapped, i is the element's
+    index and n the array's size; a single value has i = 0 and n = 1.
+    Operators are + - * / ^ (power, right-associative) and unary minus, with
+    the usual precedence. Constants: numbers and pi. Functions:
+
+        abs sqrt exp log log10 floor    one argument
+        db (v)          20 log10 v, floored at -200 dB
+        gain (dB)       10 ^ (dB / 20)
+        min max pow     two
+        clamp (v, lo, hi)
+        scale (v, inLo, inHi, outLo, outHi)   linear, not clamped
+
+    compile() turns the text into a flat program for a stack machine: no
+    tree, no pointers, nothing on the heap. Constant subexpressions are
+    folded, and an operation whose right operand is a constant carries it as
+    an immediate, so "(x - 60) / 120" is three instructions. Compile off the
+    audio thread; a compiled Mapping is a value, copied into the config.
+
+    evaluate() is noexcept and allocation-free. The array form runs each
+    instruction across a block of elements at a time, with SIMD for the
+    arithmetic, so a spectrum costs little more than the hand-written loop.
+*/
+class Mapping
+{
+public:
+    static constexpr int maxInstructions = 64;
+    static constexpr int maxStack = 16;
+
+    enum class Op : std::uint8_t
+    {
+        input, index, count, constant,
+        add, sub, mul, div, pow,
+        addK, mulK, mulAddK, divK, powK, minK, maxK, clampK,   // right operand(s) in the instruction
+        neg, abs, sqrt, exp, log, log10, floor, db, gain,
+        min, max, clamp, scale
+    };
+
+    struct Instruction
+    {
+        Op op = Op::constant;
+        float a = 0.0f, b = 0.0f;
+    };
+
+    /** The identity: x. */
+    Mapping() noexcept;
+
+    /** Returns false with a message naming the position if the text isn't a
+        valid mapping. An empty text is the identity.
+    */
+    static bool compile (std::string_view source, Mapping& out, std::string& error);
+
+    float evaluate (float x, int index = 0, int count = 1) const noexcept;
+
+    /** Maps n values; out may be the same array as in. */
+    void evaluate (const float* in, float* out, int n) const noexcept;
+
+    bool isIdentity() const noexcept                    { return numInstructions == 1 && program[0].op == Op::input; }
+    const std::string& getSource() const noexcept       { return source; }
+    int getNumInstructions() const noexcept             { return numInstructions; }
+    const Instruction& getInstruction (int i) const noexcept    { return program[static_cast<std::size_t> (i)]; }
+
+private:
+    friend class MappingCompiler;
+
+    std::array<Instruction, maxInstructions> program {};
+    int numInstructions = 0;
+    std::string source;
+};
+
+} // namespace dawinfo
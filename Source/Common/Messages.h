@@ -0,0 +1,227 @@
+#pragma once
+
+#include "Common/Control.h"
+#include "Common/Midi.h"
+#include "Common/Parameters.h"
+#include "Common/Protocol.h"
+#include "Common/Schema.h"
+#include "Common/StereoImage.h"
+#include "Common/TempoMap.h"
+
+#include <cmath>
+
+namespace dawinfo::messages
+{
+
+/*  The published schema. Each message is described once here; encoders,
+    decoders, the address table and the generated docs all come from these
+    descriptions. Changing a layout changes the static_asserts in
+    Tests/SchemaTests.cpp, which is the point: layout changes must be deliberate.
+*/
+
+using schema::Field;
+using schema::RateClass;
+
+struct Sequence
+{
+    using Value = SequenceHeader;
+    using Layout = schema::Fields<Field<&SequenceHeader::stream, std::int32_t>,
+                                  Field<&SequenceHeader::seq, std::int32_t>>;
+
+    static constexpr std::string_view address = "/dawinfo/seq";
+    static constexpr RateClass rate = RateClass::perBlock;
+    static constexpr std::array<std::string_view, 2> fieldNames { "stream", "seq" };
+    static constexpr std::string_view description = "First message of every packet: stream id and its packet counter.";
+
+    static bool validate (const Value& v) noexcept
+    {
+        return static_cast<std::size_t> (v.stream) < numStreams;
+    }
+};
+
+struct Transport
+{
+    using Value = TransportSnapshot;
+    using Layout = schema::Fields<Field<&TransportSnapshot::timeNs>,
+                                  Field<&TransportSnapshot::ppq>,
+                                  Field<&TransportSnapshot::bpm>,
+                                  Field<&TransportSnapshot::barStartPpq>,
+                                  Field<&TransportSnapshot::barNumber>,
+                                  Field<&TransportSnapshot::timeSigNumerator>,
+                                  Field<&TransportSnapshot::timeSigDenominator>,
+                                  Field<&TransportSnapshot::isPlaying, std::int32_t>,
+                                  Field<&TransportSnapshot::isLooping, std::int32_t>,
+                                  Field<&TransportSnapshot::loopStartPpq>,
+                                  Field<&TransportSnapshot::loopEndPpq>>;
+
+    static constexpr std::string_view address = "/dawinfo/transport";
+    static constexpr RateClass rate = RateClass::perBlock;
+    static constexpr std::array<std::string_view, 11> fieldNames {
+        "timeNs", "ppq", "bpm", "barStartPpq", "barNumber", "timeSigNumerator",
+        "timeSigDenominator", "isPlaying", "isLooping", "loopStartPpq", "loopEndPpq"
+    };
+    static constexpr std::string_view description = "Host transport state at the start of the block.";
+};
+
+struct Event
+{
+    using Value = DiscreteEvent;
+    using Layout = schema::Fields<Field<&DiscreteEvent::id, std::int32_t>,
+                                  Field<&DiscreteEvent::type, std::int32_t>,
+                                  Field<&DiscreteEvent::timeNs>,
+                                  Field<&DiscreteEvent::value>>;
+
+    static constexpr std::string_view address = "/dawinfo/event";
+    static constexpr RateClass rate = RateClass::onEvent;
+    static constexpr std::array<std::string_view, 4> fieldNames { "id", "type", "timeNs", "value" };
+    static constexpr std::string_view description = "A beat, onset or play/stop change; repeated for loss resilience.";
+
+    static bool validate (const Value& v) noexcept
+    {
+        return static_cast<std::int32_t> (v.type) >= 0 && v.type <= EventType::stop;
+    }
+};
+
+struct Midi
+{
+    using Value = MidiEvent;
+    using Layout = schema::Fields<Field<&MidiEvent::timeNs>,
+                                  Field<&MidiEvent::status, std::int32_t>,
+                                  Field<&MidiEvent::data1, std::int32_t>,
+                                  Field<&MidiEvent::data2, std::int32_t>>;
+
+    static constexpr std::string_view address = "/dawinfo/midi";
+    static constexpr RateClass rate = RateClass::onEvent;
+    static constexpr std::array<std::string_view, 4> fieldNames { "timeNs", "status", "data1", "data2" };
+    static constexpr std::string_view description = "A channel MIDI message from the host, timestamped to its sample.";
+
+    static bool validate (const Value& v) noexcept
+    {
+        return v.isChannelMessage() && v.data1 < 0x80 && v.data2 < 0x80;
+    }
+};
+
+struct Parameter
+{
+    using Value = ParameterSegment;
+    using Layout = schema::Fields<Field<&ParameterSegment::paramId>,
+                                  Field<&ParameterSegment::startNs>,
+                                  Field<&ParameterSegment::durationNs>,
+                                  Field<&ParameterSegment::startValue>,
+                                  Field<&ParameterSegment::endValue>>;
+
+    static constexpr std::string_view address = "/dawinfo/param";
+    static constexpr RateClass rate = RateClass::onEvent;
+    static constexpr std::array<std::string_view, 5> fieldNames { "paramId", "startNs", "durationNs", "startValue", "endValue" };
+    static constexpr std::string_view description = "A linear piece of a parameter's automation curve.";
+
+    static bool validate (const Value& v) noexcept
+    {
+        return v.paramId >= 0 && v.durationNs >= 0;
+    }
+};
+
+struct ControlReply
+{
+    using Value = control::Reply;
+    using Layout = schema::Fields<Field<&control::Reply::token>,
+                                  Field<&control::Reply::command, std::int32_t>,
+                                  Field<&control::Reply::status, std::int32_t>,
+                                  Field<&control::Reply::receivedNs>>;
+
+    static constexpr std::string_view address = "/dawinfo/reply";
+    static constexpr RateClass rate = RateClass::onDemand;
+    static constexpr std::array<std::string_view, 4> fieldNames { "token", "command", "status", "receivedNs" };
+    static constexpr std::string_view description = "Answers a control command; a snapshot query's packet also carries /dawinfo/transport.";
+
+    static bool validate (const Value& v) noexcept
+    {
+        return static_cast<std::int32_t> (v.command) >= 0 && v.command <= control::CommandType::queryPeaks
+                && static_cast<std::int32_t> (v.status) >= 0 && v.status <= control::Status::busy;
+    }
+};
+
+struct TempoHeader
+{
+    using Value = TempoMapHeader;
+    using Layout = schema::Fields<Field<&TempoMapHeader::baseVersion, std::int32_t>,
+                                  Field<&TempoMapHeader::version, std::int32_t>,
+                                  Field<&TempoMapHeader::part>,
+                                  Field<&TempoMapHeader::numParts>,
+                                  Field<&TempoMapHeader::replaceFrom>,
+                                  Field<&TempoMapHeader::firstSegment>,
+                                  Field<&TempoMapHeader::numSegments>,
+                                  Field<&TempoMapHeader::isLooping, std::int32_t>,
+                                  Field<&TempoMapHeader::loopStartPpq>,
+                                  Field<&TempoMapHeader::loopEndPpq>>;
+
+    static constexpr std::string_view address = "/dawinfo/tempo/header";
+    static constexpr RateClass rate = RateClass::onEvent;
+    static constexpr std::array<std::string_view, 10> fieldNames {
+        "baseVersion", "version", "part", "numParts", "replaceFrom", "firstSegment",
+        "numSegments", "isLooping", "loopStartPpq", "loopEndPpq"
+    };
+    static constexpr std::string_view description = "Opens a tempo map update: which segments it replaces, and the loop.";
+
+    static bool validate (const Value& v) noexcept
+    {
+        return v.numParts > 0 && v.numParts <= TempoMap::maxSegments && v.part >= 0 && v.part < v.numParts
+                && v.numSegments >= 0 && v.numSegments <= TempoMap::maxSegments
+                && v.replaceFrom >= 0 && v.replaceFrom <= v.numSegments
+                && v.firstSegment >= v.replaceFrom && v.firstSegment <= v.numSegments
+                && std::isfinite (v.loopStartPpq) && std::isfinite (v.loopEndPpq);
+    }
+};
+
+struct TempoSegment
+{
+    using Value = dawinfo::TempoSegment;
+    using Layout = schema::Fields<Field<&Value::startPpq>,
+                                  Field<&Value::bpm>,
+                                  Field<&Value::bpmPerQuarter>,
+                                  Field<&Value::barStartPpq>,
+                                  Field<&Value::barNumber>,
+                                  Field<&Value::timeSigNumerator>,
+                                  Field<&Value::timeSigDenominator>>;
+
+    static constexpr std::string_view address = "/dawinfo/tempo/segment";
+    static constexpr RateClass rate = RateClass::onEvent;
+    static constexpr std::array<std::string_view, 7> fieldNames {
+        "startPpq", "bpm", "bpmPerQuarter", "barStartPpq", "barNumber", "timeSigNumerator", "timeSigDenominator"
+    };
+    static constexpr std::string_view description = "One tempo map segment; follows /dawinfo/tempo/header in index order.";
+
+    static bool validate (const Value& v) noexcept
+    {
+        return v.bpm >= Value::minBpm && v.bpm <= Value::maxBpm && std::isfinite (v.bpmPerQuarter)
+                && std::isfinite (v.startPpq) && std::isfinite (v.barStartPpq)
+                && v.timeSigNumerator > 0 && v.timeSigDenominator > 0;
+    }
+};
+
+struct Stereo
+{
+    using Value = StereoMeter;
+    using Layout = schema::Fields<Field<&StereoMeter::timeNs>,
+                                  Field<&StereoMeter::correlation>,
+                                  Field<&StereoMeter::balance>,
+                                  Field<&StereoMeter::midDb>,
+                                  Field<&StereoMeter::sideDb>>;
+
+    static constexpr std::string_view address = "/dawinfo/stereo";
+    static constexpr RateClass rate = RateClass::perFrame;
+    static constexpr std::array<std::string_view, 5> fieldNames { "timeNs", "correlation", "balance", "midDb", "sideDb" };
+    static constexpr std::string_view description = "Stereo image meter: correlation, balance and mid/side levels; /dawinfo/vectorscope follows.";
+
+    static bool validate (const Value& v) noexcept
+    {
+        return v.correlation >= -1.0f && v.correlation <= 1.0f && v.balance >= -1.0f && v.balance <= 1.0f
+                && std::isfinite (v.midDb) && std::isfinite (v.sideDb);
+    }
+};
+
+/** Everything the sender publishes, in documentation order. */
+using Published = schema::MessageList<Sequence, Transport, Event, Midi, Parameter, ControlReply, TempoHeader, TempoSegment,
+                                      Stereo>;
+
+} // namespace dawinfo::messages
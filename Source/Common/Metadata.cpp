@@ -0,0 +1,152 @@
+#include "Common/Metadata.h"
+
+#include <algorithm>
+
+namespace dawinfo::metadata
+{
+
+namespace
+{
+    std::size_t messageSize (std::string_view address, std::size_t numTags, std::size_t argumentBytes) noexcept
+    {
+        return 4 + OscWriter::paddedStringSize (address.size())
+                 + OscWriter::paddedStringSize (numTags + 1) + argumentBytes;
+    }
+}
+
+void writeHeader (OscWriter& w, const Header& h) noexcept
+{
+    w.beginMessage (headerAddress, "iiiii");
+    w.addInt32 (static_cast<std::int32_t> (h.baseVersion));
+    w.addInt32 (static_cast<std::int32_t> (h.version));
+    w.addInt32 (h.part);
+    w.addInt32 (h.numParts);
+    w.addInt32 (h.isFullSync ? 1 : 0);
+    w.endMessage();
+}
+
+void writeTrack (OscWriter& w, const TrackInfo& t) noexcept
+{
+    w.beginMessage (trackAddress, "isii");
+    w.addInt32 (static_cast<std::int32_t> (t.id));
+    w.addString (t.name);
+    w.addInt32 (static_cast<std::int32_t> (t.colour));
+    w.addInt32 (t.numChannels);
+    w.endMessage();
+}
+
+void writeRemoved (OscWriter& w, std::uint32_t id) noexcept
+{
+    w.beginMessage (removedAddress, "i");
+    w.addInt32 (static_cast<std::int32_t> (id));
+    w.endMessage();
+}
+
+void writeOrderChunk (OscWriter& w, std::size_t offset, std::size_t total,
+                      const std::uint32_t* ids, std::size_t numIds) noexcept
+{
+    std::uint8_t packed[maxIdsPerOrderChunk * 4];
+    numIds = std::min (numIds, maxIdsPerOrderChunk);
+
+    for (std::size_t i = 0; i < numIds; ++i)
+    {
+        packed[i * 4]     = static_cast<std::uint8_t> (ids[i] >> 24);
+        packed[i * 4 + 1] = static_cast<std::uint8_t> (ids[i] >> 16);
+        packed[i * 4 + 2] = static_cast<std::uint8_t> (ids[i] >> 8);
+        packed[i * 4 + 3] = static_cast<std::uint8_t> (ids[i]);
+    }
+
+    w.beginMessage (orderAddress, "iib");
+    w.addInt32 (static_cast<std::int32_t> (offset));
+    w.addInt32 (static_cast<std::int32_t> (total));
+    w.addBlob (packed, numIds * 4);
+    w.endMessage();
+}
+
+std::size_t headerSize() noexcept                       { return messageSize (headerAddress, 5, 20); }
+std::size_t removedSize() noexcept                      { return messageSize (removedAddress, 1, 4); }
+std::size_t orderChunkSize (std::size_t numIds) noexcept { return messageSize (orderAddress, 3, 12 + numIds * 4); }
+
+std::size_t trackSize (const TrackInfo& t) noexcept
+{
+    return messageSize (trackAddress, 4, 12 + OscWriter::paddedStringSize (t.name.size()));
+}
+
+//==============================================================================
+bool decodeHeader (const OscMessage& m, Header& h) noexcept
+{
+    if (m.address != headerAddress)
+        return false;
+
+    OscArgumentReader r (m);
+    std::int32_t base = 0, version = 0, full = 0;
+
+    if (! (r.readInt32 (base) && r.readInt32 (version) && r.readInt32 (h.part)
+            && r.readInt32 (h.numParts) && r.readInt32 (full)))
+        return false;
+
+    if (h.numParts < 1 || h.numParts > maxParts || h.part < 0 || h.part >= h.numParts)
+        return false;
+
+    h.baseVersion = static_cast<std::uint32_t> (base);
+    h.version = static_cast<std::uint32_t> (version);
+    h.isFullSync = full != 0;
+    return true;
+}
+
+bool decodeTrack (const OscMessage& m, TrackInfo& t)
+{
+    if (m.address != trackAddress)
+        return false;
+
+    OscArgumentReader r (m);
+    std::int32_t id = 0, colour = 0;
+    std::string_view name;
+
+    if (! (r.readInt32 (id) && r.readString (name) && r.readInt32 (colour) && r.readInt32 (t.numChannels)))
+        return false;
+
+    t.id = static_cast<std::uint32_t> (id);
+    t.name.assign (name.data(), name.size());
+    t.colour = static_cast<std::uint32_t> (colour);
+    return true;
+}
+
+bool decodeRemoved (const OscMessage& m, std::uint32_t& id) noexcept
+{
+    if (m.address != removedAddress)
+        return false;
+
+    OscArgumentReader r (m);
+    std::int32_t v = 0;
+
+    if (! r.readInt32 (v))
+        return false;
+
+    id = static_cast<std::uint32_t> (v);
+    return true;
+}
+
+bool decodeOrderChunk (const OscMessage& m, std::size_t& offset, std::size_t& total,
+                       const std::uint8_t*& ids, std::size_t& numIds) noexcept
+{
+    if (m.address != orderAddress)
+        return false;
+
+    OscArgumentReader r (m);
+    std::int32_t o = 0, t = 0;
+    std::size_t blobSize = 0;
+
+    if (! (r.readInt32 (o) && r.readInt32 (t) && r.readBlob (ids, blobSize)))
+        return false;
+
+    if (o < 0 || t < 0 || t > maxTracks || (blobSize & 3) != 0 || static_cast<std::size_t> (o) + blobSize / 4 > static_cast<std::size_t> (t))
+        return false;
+
+    offset = static_cast<std::size_t> (o);
+    total = static_cast<std::size_t> (t);
+    numIds = blobSize / 4;
+    return true;
+}
+
+} // namespace dawinfo::metadata
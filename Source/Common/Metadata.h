@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Common/Osc.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace dawinfo
+{
+
+/** Slow-changing per-track information. */
+struct TrackInfo
+{
+    std::uint32_t id = 0;           // stable across renames and reorders
+    std::string name;
+    std::uint32_t colour = 0;       // 0xAARRGGBB
+    std::int32_t numChannels = 2;
+
+    bool operator== (const TrackInfo& o) const
+    {
+        return id == o.id && colour == o.colour && numChannels == o.numChannels && name == o.name;
+    }
+
+    bool operator!= (const TrackInfo& o) const  { return ! operator== (o); }
+};
+
+/*  Metadata messages carry strings, so they aren't schema messages (see
+    WireType in Common/Schema.h).
+
+    A metadata update is one or more packets on StreamId::metadata, each
+    starting with a header naming the version it moves from and to:
+
+        /dawinfo/meta/header  ,iiiii  baseVersion version part numParts isFullSync
+        /dawinfo/meta/track   ,isii   id name colour numChannels
+        /dawinfo/meta/removed ,i      id
+        /dawinfo/meta/order   ,iib    offset total ids   (big-endian uint32 ids)
+*/
+namespace metadata
+{
+    constexpr std::string_view headerAddress  = "/dawinfo/meta/header";
+    constexpr std::string_view trackAddress   = "/dawinfo/meta/track";
+    constexpr std::string_view removedAddress = "/dawinfo/meta/removed";
+    constexpr std::string_view orderAddress   = "/dawinfo/meta/order";
+
+    /** Track ids per order message. */
+    constexpr std::size_t maxIdsPerOrderChunk = 256;
+
+    /** The most tracks, and packets to an update, a receiver accepts: far
+        beyond any session, but a corrupt header or order message can't make
+        a mirror allocate gigabytes.
+    */
+    constexpr std::int32_t maxTracks = 65536;
+    constexpr std::int32_t maxParts = 65536;
+
+    struct Header
+    {
+        std::uint32_t baseVersion = 0;
+        std::uint32_t version = 0;
+        std::int32_t part = 0;
+        std::int32_t numParts = 1;
+        bool isFullSync = false;
+    };
+
+    void writeHeader (OscWriter&, const Header&) noexcept;
+    void writeTrack (OscWriter&, const TrackInfo&) noexcept;
+    void writeRemoved (OscWriter&, std::uint32_t id) noexcept;
+    void writeOrderChunk (OscWriter&, std::size_t offset, std::size_t total,
+                          const std::uint32_t* ids, std::size_t numIds) noexcept;
+
+    /** Bytes each message takes inside a bundle, including the size prefix. */
+    std::size_t headerSize() noexcept;
+    std::size_t trackSize (const TrackInfo&) noexcept;
+    std::size_t removedSize() noexcept;
+    std::size_t orderChunkSize (std::size_t numIds) noexcept;
+
+    bool decodeHeader (const OscMessage&, Header&) noexcept;
+    bool decodeTrack (const OscMessage&, TrackInfo&);
+    bool decodeRemoved (const OscMessage&, std::uint32_t& id) noexcept;
+
+    /** ids points into the message; read them with readBigEndian32. */
+    bool decodeOrderChunk (const OscMessage&, std::size_t& offset, std::size_t& total,
+                           const std::uint8_t*& ids, std::size_t& numIds) noexcept;
+}
+
+} // namespace dawinfo
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Common/Transport.h"
+
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/** A short (channel voice) MIDI message with a host timestamp. */
+struct MidiEvent
+{
+    HostTimeNs timeNs = 0;
+    std::uint8_t status = 0;
+    std::uint8_t data1 = 0;
+    std::uint8_t data2 = 0;
+
+    /** 0 = note off ... 6 = pitch bend; only valid for channel messages. */
+    int getTypeIndex() const noexcept   { return (status >> 4) - 8; }
+    int getChannel() const noexcept     { return status & 0x0f; }
+    bool isChannelMessage() const noexcept { return status >= 0x80 && status < 0xf0; }
+    bool isController() const noexcept  { return (status & 0xf0) == 0xb0; }
+
+    /** Bytes including the status byte; only valid for channel messages. */
+    int getLength() const noexcept
+    {
+        const auto type = status & 0xf0;
+        return type == 0xc0 || type == 0xd0 ? 2 : 3;
+    }
+};
+
+namespace midi
+{
+    /** Bits for MidiForwarder::Filter::typeMask, indexed by getTypeIndex(). */
+    enum TypeBits : std::uint8_t
+    {
+        noteOff         = 1 << 0,
+        noteOn          = 1 << 1,
+        polyPressure    = 1 << 2,
+        controller      = 1 << 3,
+        programChange   = 1 << 4,
+        channelPressure = 1 << 5,
+        pitchBend       = 1 << 6,
+        allTypes        = 0x7f
+    };
+}
+
+} // namespace dawinfo
@@ -0,0 +1,327 @@
+#include "Common/Osc.h"
+
+#include <cstring>
+
+namespace dawinfo
+{
+
+OscWriter::OscWriter (void* d, std::size_t c) noexcept
+    : data (static_cast<std::uint8_t*> (d)), capacity (c)
+{
+}
+
+void OscWriter::reset() noexcept
+{
+    size = 0;
+    messageSizeOffset = 0;
+    inBundle = inMessage = overflowed = false;
+}
+
+bool OscWriter::reserve (std::size_t n) noexcept
+{
+    if (overflowed || n > capacity - size)
+    {
+        overflowed = true;
+        return false;
+    }
+
+    return true;
+}
+
+void OscWriter::writeBigEndian32 (std::uint32_t v) noexcept
+{
+    if (! reserve (4))
+        return;
+
+    data[size++] = static_cast<std::uint8_t> (v >> 24);
+    data[size++] = static_cast<std::uint8_t> (v >> 16);
+    data[size++] = static_cast<std::uint8_t> (v >> 8);
+    data[size++] = static_cast<std::uint8_t> (v);
+}
+
+void OscWriter::writeBigEndian64 (std::uint64_t v) noexcept
+{
+    writeBigEndian32 (static_cast<std::uint32_t> (v >> 32));
+    writeBigEndian32 (static_cast<std::uint32_t> (v));
+}
+
+void OscWriter::writePaddedString (std::string_view s) noexcept
+{
+    const auto padded = paddedStringSize (s.size());
+
+    if (! reserve (padded))
+        return;
+
+    std::memcpy (data + size, s.data(), s.size());
+    std::memset (data + size + s.size(), 0, padded - s.size());
+    size += padded;
+}
+
+void OscWriter::beginBundle (std::uint64_t timeTag) noexcept
+{
+    reset();
+    writePaddedString ("#bundle");
+    writeBigEndian64 (timeTag);
+    inBundle = true;
+}
+
+void OscWriter::beginMessage (std::string_view address, std::string_view typeTags) noexcept
+{
+    if (inBundle)
+    {
+        messageSizeOffset = size;
+        writeBigEndian32 (0);
+    }
+    else
+    {
+        size = 0;
+    }
+
+    inMessage = true;
+    writePaddedString (address);
+
+    const auto padded = paddedStringSize (typeTags.size() + 1);
+
+    if (! reserve (padded))
+        return;
+
+    data[size] = ',';
+    std::memcpy (data + size + 1, typeTags.data(), typeTags.size());
+    std::memset (data + size + 1 + typeTags.size(), 0, padded - typeTags.size() - 1);
+    size += padded;
+}
+
+void OscWriter::endMessage() noexcept
+{
+    if (inBundle && inMessage && ! overflowed)
+    {
+        const auto length = static_cast<std::uint32_t> (size - messageSizeOffset - 4);
+        auto* p = data + messageSizeOffset;
+        p[0] = static_cast<std::uint8_t> (length >> 24);
+        p[1] = static_cast<std::uint8_t> (length >> 16);
+        p[2] = static_cast<std::uint8_t> (length >> 8);
+        p[3] = static_cast<std::uint8_t> (length);
+    }
+
+    inMessage = false;
+}
+
+void OscWriter::addInt32 (std::int32_t v) noexcept   { writeBigEndian32 (static_cast<std::uint32_t> (v)); }
+void OscWriter::addInt64 (std::int64_t v) noexcept   { writeBigEndian64 (static_cast<std::uint64_t> (v)); }
+
+void OscWriter::addFloat32 (float v) noexcept
+{
+    std::uint32_t bits;
+    std::memcpy (&bits, &v, sizeof (bits));
+    writeBigEndian32 (bits);
+}
+
+void OscWriter::addFloat64 (double v) noexcept
+{
+    std::uint64_t bits;
+    std::memcpy (&bits, &v, sizeof (bits));
+    writeBigEndian64 (bits);
+}
+
+void OscWriter::addString (std::string_view s) noexcept
+{
+    writePaddedString (s);
+}
+
+void OscWriter::addBlob (const void* blob, std::size_t blobSize) noexcept
+{
+    const auto padded = (blobSize + 3) & ~static_cast<std::size_t> (3);
+
+    writeBigEndian32 (static_cast<std::uint32_t> (blobSize));
+
+    if (! reserve (padded))
+        return;
+
+    if (blobSize > 0)
+        std::memcpy (data + size, blob, blobSize);
+
+    std::memset (data + size + blobSize, 0, padded - blobSize);
+    size += padded;
+}
+
+std::uint8_t* OscWriter::appendMessage (std::size_t messageSize) noexcept
+{
+    if (inBundle)
+        writeBigEndian32 (static_cast<std::uint32_t> (messageSize));
+    else
+        size = 0;
+
+    if (! reserve (messageSize))
+        return nullptr;
+
+    auto* start = data + size;
+    size += messageSize;
+    return start;
+}
+
+//==============================================================================
+std::uint32_t readBigEndian32 (const std::uint8_t* p) noexcept
+{
+    return (static_cast<std::uint32_t> (p[0]) << 24) | (static_cast<std::uint32_t> (p[1]) << 16)
+         | (static_cast<std::uint32_t> (p[2]) << 8)  |  static_cast<std::uint32_t> (p[3]);
+}
+
+std::uint64_t readBigEndian64 (const std::uint8_t* p) noexcept
+{
+    return (static_cast<std::uint64_t> (readBigEndian32 (p)) << 32) | readBigEndian32 (p + 4);
+}
+
+namespace
+{
+    /** Reads a padded string starting at offset; returns its padded size or 0. */
+    std::size_t readPaddedString (const std::uint8_t* data, std::size_t size, std::size_t offset,
+                                  std::string_view& result) noexcept
+    {
+        if (offset >= size)
+            return 0;
+
+        const auto* start = reinterpret_cast<const char*> (data + offset);
+        const auto* terminator = static_cast<const char*> (std::memchr (start, 0, size - offset));
+
+        if (terminator == nullptr)
+            return 0;
+
+        const auto length = static_cast<std::size_t> (terminator - start);
+        const auto padded = OscWriter::paddedStringSize (length);
+
+        if (padded > size - offset)
+            return 0;
+
+        result = std::string_view (start, length);
+        return padded;
+    }
+}
+
+bool isOscBundle (const std::uint8_t* data, std::size_t size) noexcept
+{
+    return size >= 16 && std::memcmp (data, "#bundle", 8) == 0;
+}
+
+bool parseOscMessage (const std::uint8_t* data, std::size_t size, OscMessage& m) noexcept
+{
+    if (size < 8 || (size & 3) != 0 || data[0] != '/')
+        return false;
+
+    const auto addressSize = readPaddedString (data, size, 0, m.address);
+
+    if (addressSize == 0)
+        return false;
+
+    std::string_view tags;
+    const auto tagsSize = readPaddedString (data, size, addressSize, tags);
+
+    if (tagsSize == 0 || tags.empty() || tags[0] != ',')
+        return false;
+
+    m.data = data;
+    m.size = size;
+    m.typeTags = tags.substr (1);
+    m.arguments = data + addressSize + tagsSize;
+    m.argumentsSize = size - addressSize - tagsSize;
+    return true;
+}
+
+//==============================================================================
+OscArgumentReader::OscArgumentReader (const OscMessage& m) noexcept : message (m) {}
+
+bool OscArgumentReader::take (char tag, std::size_t n) noexcept
+{
+    if (! valid || tagIndex >= message.typeTags.size()
+         || message.typeTags[tagIndex] != tag || n > message.argumentsSize - offset)
+    {
+        valid = false;
+        return false;
+    }
+
+    ++tagIndex;
+    return true;
+}
+
+bool OscArgumentReader::readInt32 (std::int32_t& v) noexcept
+{
+    if (! take ('i', 4))
+        return false;
+
+    v = static_cast<std::int32_t> (readBigEndian32 (message.arguments + offset));
+    offset += 4;
+    return true;
+}
+
+bool OscArgumentReader::readFloat32 (float& v) noexcept
+{
+    if (! take ('f', 4))
+        return false;
+
+    const auto bits = readBigEndian32 (message.arguments + offset);
+    std::memcpy (&v, &bits, sizeof (v));
+    offset += 4;
+    return true;
+}
+
+bool OscArgumentReader::readInt64 (std::int64_t& v) noexcept
+{
+    if (! take ('h', 8))
+        return false;
+
+    v = static_cast<std::int64_t> (readBigEndian64 (message.arguments + offset));
+    offset += 8;
+    return true;
+}
+
+bool OscArgumentReader::readFloat64 (double& v) noexcept
+{
+    if (! take ('d', 8))
+        return false;
+
+    const auto bits = readBigEndian64 (message.arguments + offset);
+    std::memcpy (&v, &bits, sizeof (v));
+    offset += 8;
+    return true;
+}
+
+bool OscArgumentReader::readString (std::string_view& v) noexcept
+{
+    if (! valid)
+        return false;
+
+    const auto n = readPaddedString (message.arguments, message.argumentsSize, offset, v);
+
+    if (n == 0 || ! take ('s', n))
+    {
+        valid = false;
+        return false;
+    }
+
+    offset += n;
+    return true;
+}
+
+bool OscArgumentReader::readBlob (const std::uint8_t*& blob, std::size_t& blobSize) noexcept
+{
+    if (! valid || message.argumentsSize - offset < 4)
+    {
+        valid = false;
+        return false;
+    }
+
+    const auto length = static_cast<std::size_t> (readBigEndian32 (message.arguments + offset));
+    const auto padded = (length + 3) & ~static_cast<std::size_t> (3);
+
+    if (length > message.argumentsSize || ! take ('b', 4 + padded))
+    {
+        valid = false;
+        return false;
+    }
+
+    blob = message.arguments + offset + 4;
+    blobSize = length;
+    offset += 4 + padded;
+    return true;
+}
+
+} // namespace dawinfo
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace dawinfo
+{
+
+/** OSC time tag meaning "immediately". */
+constexpr std::uint64_t oscImmediateTimeTag = 1;
+
+//==============================================================================
+/**
+    Writes OSC 1.0 messages and bundles into a caller-owned buffer.
+
+    Never allocates. Running out of space sets a sticky overflow flag and
+    every later write becomes a no-op, so callers check once at the end.
+    A message started inside a bundle is length-prefixed automatically.
+*/
+class OscWriter
+{
+public:
+    OscWriter (void* data, std::size_t capacity) noexcept;
+
+    void reset() noexcept;
+
+    void beginBundle (std::uint64_t timeTag = oscImmediateTimeTag) noexcept;
+
+    /** Type tags are given without the leading comma, e.g. "iif". */
+    void beginMessage (std::string_view address, std::string_view typeTags) noexcept;
+    void endMessage() noexcept;
+
+    void addInt32 (std::int32_t) noexcept;
+    void addFloat32 (float) noexcept;
+    void addInt64 (std::int64_t) noexcept;
+    void addFloat64 (double) noexcept;
+    void addString (std::string_view) noexcept;
+    void addBlob (const void* data, std::size_t size) noexcept;
+
+    /** Reserves space for a complete, pre-laid-out message of the given size
+        (a multiple of 4) and returns where to write it, or nullptr on overflow.
+        Used by the schema codecs, which fill in the bytes directly.
+    */
+    std::uint8_t* appendMessage (std::size_t messageSize) noexcept;
+
+    const std::uint8_t* getData() const noexcept    { return data; }
+    std::size_t getSize() const noexcept             { return size; }
+    std::size_t getCapacity() const noexcept         { return capacity; }
+    bool hasOverflowed() const noexcept              { return overflowed; }
+
+    /** Size of a padded OSC string, including its terminator. */
+    static constexpr std::size_t paddedStringSize (std::size_t length) noexcept
+    {
+        return (length + 4) & ~static_cast<std::size_t> (3);
+    }
+
+private:
+    bool reserve (std::size_t) noexcept;
+    void writeBigEndian32 (std::uint32_t) noexcept;
+    void writeBigEndian64 (std::uint64_t) noexcept;
+    void writePaddedString (std::string_view) noexcept;
+
+    std::uint8_t* data;
+    std::size_t capacity;
+    std::size_t size = 0;
+    std::size_t messageSizeOffset = 0;
+    bool inBundle = false;
+    bool inMessage = false;
+    bool overflowed = false;
+};
+
+//==============================================================================
+/** A parsed message. Views point into the packet buffer. */
+struct OscMessage
+{
+    const std::uint8_t* data = nullptr;     // the whole message
+    std::size_t size = 0;
+    std::string_view address;
+    std::string_view typeTags;      // without the leading comma
+    const std::uint8_t* arguments = nullptr;
+    std::size_t argumentsSize = 0;
+};
+
+/**
+    Reads the arguments of an OscMessage in order. Each read checks both the
+    type tag and the bounds; the first mismatch makes the reader invalid and
+    every later read fail.
+*/
+class OscArgumentReader
+{
+public:
+    explicit OscArgumentReader (const OscMessage&) noexcept;
+
+    bool readInt32 (std::int32_t&) noexcept;
+    bool readFloat32 (float&) noexcept;
+    bool readInt64 (std::int64_t&) noexcept;
+    bool readFloat64 (double&) noexcept;
+    bool readString (std::string_view&) noexcept;
+    bool readBlob (const std::uint8_t*& data, std::size_t& size) noexcept;
+
+    bool isValid() const noexcept            { return valid; }
+    bool isAtEnd() const noexcept            { return tagIndex == message.typeTags.size(); }
+
+private:
+    bool take (char tag, std::size_t size) noexcept;
+
+    OscMessage message;
+    std::size_t tagIndex = 0;
+    std::size_t offset = 0;
+    bool valid = true;
+};
+
+//==============================================================================
+/** Parses a single message. Returns false if the packet is malformed. */
+bool parseOscMessage (const std::uint8_t* data, std::size_t size, OscMessage&) noexcept;
+
+bool isOscBundle (const std::uint8_t* data, std::size_t size) noexcept;
+
+std::uint32_t readBigEndian32 (const std::uint8_t*) noexcept;
+std::uint64_t readBigEndian64 (const std::uint8_t*) noexcept;
+
+/**
+    Calls fn (const OscMessage&) for every message in a packet, descending into
+    nested bundles. Returns false if any part of the packet is malformed;
+    messages before the bad element have already been delivered.
+*/
+template <typename Fn>
+bool forEachOscMessage (const std::uint8_t* data, std::size_t size, Fn&& fn)
+{
+    if (! isOscBundle (data, size))
+    {
+        OscMessage m;
+
+        if (! parseOscMessage (data, size, m))
+            return false;
+
+        fn (static_cast<const OscMessage&> (m));
+        return true;
+    }
+
+    std::size_t offset = 16;
+
+    while (offset < size)
+    {
+        if (size - offset < 4)
+            return false;
+
+        const auto elementSize = static_cast<std::size_t> (readBigEndian32 (data + offset));
+        offset += 4;
+
+        if (elementSize > size - offset || (elementSize & 3) != 0)
+            return false;
+
+        if (! forEachOscMessage (data + offset, elementSize, fn))
+            return false;
+
+        offset += elementSize;
+    }
+
+    return true;
+}
+
+} // namespace dawinfo
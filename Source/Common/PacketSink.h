@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/** Somewhere finished packets go: a socket, a test shim, a recorder. */
+class PacketSink
+{
+public:
+    virtual ~PacketSink() = default;
+
+    /** Returns false if the packet could not be sent. */
+    virtual bool send (const std::uint8_t* data, std::size_t size) = 0;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Common/Transport.h"
+
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/** A stretch of automation: the parameter moves linearly from startValue to
+    endValue over durationNs. Zero duration means a plain value at startNs.
+*/
+struct ParameterSegment
+{
+    std::int32_t paramId = 0;
+    HostTimeNs startNs = 0;
+    HostTimeNs durationNs = 0;
+    float startValue = 0.0f;
+    float endValue = 0.0f;
+
+    HostTimeNs getEndNs() const noexcept  { return startNs + durationNs; }
+
+    float valueAt (HostTimeNs t) const noexcept
+    {
+        if (durationNs <= 0 || t >= getEndNs())
+            return endValue;
+
+        if (t <= startNs)
+            return startValue;
+
+        const auto alpha = static_cast<double> (t - startNs) / static_cast<double> (durationNs);
+        return static_cast<float> (startValue + alpha * (endValue - startValue));
+    }
+};
+
+} // namespace dawinfo
@@ -0,0 +1,84 @@
+#include "Common/Peaks.h"
+
+#include <cmath>
+
+namespace dawinfo::peaks
+{
+
+namespace
+{
+    std::int8_t quantize (float scaled) noexcept
+    {
+        return static_cast<std::int8_t> (std::clamp (scaled, -127.0f, 127.0f));
+    }
+}
+
+std::int8_t quantizeMin (float v) noexcept  { return quantize (std::floor (v * 127.0f)); }
+std::int8_t quantizeMax (float v) noexcept  { return quantize (std::ceil (v * 127.0f)); }
+
+void writeSummary (OscWriter& w, const SummaryHeader& h, const PeakBin* bins) noexcept
+{
+    std::uint8_t packed[maxSummaryBytes];
+    const auto numValues = static_cast<std::size_t> (std::clamp (h.numBins, 0, maxBinsPerSummary (h.numChannels)))
+                             * static_cast<std::size_t> (h.numChannels);
+
+    for (std::size_t i = 0; i < numValues; ++i)
+    {
+        packed[i * 2]     = static_cast<std::uint8_t> (quantizeMin (bins[i].min));
+        packed[i * 2 + 1] = static_cast<std::uint8_t> (quantizeMax (bins[i].max));
+    }
+
+    w.beginMessage (summaryAddress, "iiihb");
+    w.addInt32 (h.level);
+    w.addInt32 (h.numChannels);
+    w.addInt32 (static_cast<std::int32_t> (numValues / static_cast<std::size_t> (std::max (h.numChannels, 1))));
+    w.addInt64 (h.firstBin);
+    w.addBlob (packed, numValues * 2);
+    w.endMessage();
+}
+
+void writeRequest (OscWriter& w, const Request& r) noexcept
+{
+    w.beginMessage (requestAddress, "ihi");
+    w.addInt32 (r.level);
+    w.addInt64 (r.firstBin);
+    w.addInt32 (r.numBins);
+    w.endMessage();
+}
+
+std::size_t summarySize (std::int32_t numBins, int numChannels) noexcept
+{
+    const auto blobBytes = static_cast<std::size_t> (numBins) * static_cast<std::size_t> (numChannels) * 2;
+
+    return 4 + OscWriter::paddedStringSize (summaryAddress.size()) + OscWriter::paddedStringSize (6)
+             + 12 + 8 + 4 + ((blobBytes + 3) & ~std::size_t (3));
+}
+
+//==============================================================================
+bool decodeSummary (const OscMessage& m, SummaryHeader& h, const std::uint8_t*& packed) noexcept
+{
+    if (m.address != summaryAddress)
+        return false;
+
+    OscArgumentReader r (m);
+    std::size_t blobSize = 0;
+
+    if (! (r.readInt32 (h.level) && r.readInt32 (h.numChannels) && r.readInt32 (h.numBins)
+            && r.readInt64 (h.firstBin) && r.readBlob (packed, blobSize)))
+        return false;
+
+    return h.level >= 0 && h.numChannels > 0 && h.numChannels <= maxChannels && h.numBins >= 0 && h.firstBin >= 0
+            && blobSize == static_cast<std::size_t> (h.numBins) * static_cast<std::size_t> (h.numChannels) * 2;
+}
+
+bool decodeRequest (const OscMessage& m, Request& request) noexcept
+{
+    if (m.address != requestAddress)
+        return false;
+
+    OscArgumentReader r (m);
+    return r.readInt32 (request.level) && r.readInt64 (request.firstBin) && r.readInt32 (request.numBins)
+            && request.level >= 0 && request.numBins >= 0;
+}
+
+} // namespace dawinfo::peaks
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Common/Osc.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+
+namespace dawinfo
+{
+
+/** The sample range of one stretch of audio. */
+struct PeakBin
+{
+    float min = 0.0f;
+    float max = 0.0f;
+
+    void merge (const PeakBin& o) noexcept
+    {
+        min = std::min (min, o.min);
+        max = std::max (max, o.max);
+    }
+};
+
+/*  Waveform summaries carry a packed blob, so they aren't schema messages
+    (see WireType in Common/Schema.h).
+
+    Bin i at level L covers samples [i, i + 1) * samplesPerBin * 2^L since the
+    sender started. Live summaries go out on StreamId::waveform, answers to
+    requests on StreamId::control:
+
+        /dawinfo/peaks          ,iiihb  level numChannels numBins firstBin bins
+        /dawinfo/peaks/request  ,ihi    level firstBin numBins
+
+    The blob holds numBins * numChannels (min, max) pairs, bin-major, as
+    signed 8-bit values in 1/127ths of full scale. Minima round down and
+    maxima up, so a drawn waveform never understates a peak. A request with a
+    negative firstBin asks for the most recent numBins bins. Requests go to
+    the sender's control port (see Control.h).
+*/
+namespace peaks
+{
+    constexpr std::string_view summaryAddress = "/dawinfo/peaks";
+    constexpr std::string_view requestAddress = "/dawinfo/peaks/request";
+
+    constexpr int maxChannels = 8;
+
+    /** Packed bytes per summary message. */
+    constexpr std::size_t maxSummaryBytes = 1024;
+
+    struct SummaryHeader
+    {
+        std::int32_t level = 0;
+        std::int32_t numChannels = 1;
+        std::int32_t numBins = 0;
+        std::int64_t firstBin = 0;
+    };
+
+    struct Request
+    {
+        std::int32_t level = 0;
+        std::int64_t firstBin = -1;
+        std::int32_t numBins = 0;
+    };
+
+    /** The most bins of the given width one summary message can carry. */
+    constexpr std::int32_t maxBinsPerSummary (int numChannels) noexcept
+    {
+        return static_cast<std::int32_t> (maxSummaryBytes / (2 * static_cast<std::size_t> (std::max (numChannels, 1))));
+    }
+
+    /** bins holds numBins * numChannels entries, bin-major. */
+    void writeSummary (OscWriter&, const SummaryHeader&, const PeakBin* bins) noexcept;
+    void writeRequest (OscWriter&, const Request&) noexcept;
+
+    /** Bytes each message takes inside a bundle, including the size prefix. */
+    std::size_t summarySize (std::int32_t numBins, int numChannels) noexcept;
+
+    /** packed points into the message; read bins with unpack(). */
+    bool decodeSummary (const OscMessage&, SummaryHeader&, const std::uint8_t*& packed) noexcept;
+    bool decodeRequest (const OscMessage&, Request&) noexcept;
+
+    std::int8_t quantizeMin (float) noexcept;
+    std::int8_t quantizeMax (float) noexcept;
+
+    inline PeakBin unpack (const std::uint8_t* packed, std::size_t index) noexcept
+    {
+        return { static_cast<std::int8_t> (packed[index * 2]) / 127.0f,
+                 static_cast<std::int8_t> (packed[index * 2 + 1]) / 127.0f };
+    }
+}
+
+} // namespace dawinfo
@@ -0,0 +1,34 @@
+#include "Common/Protocol.h"
+#include "Common/Messages.h"
+
+namespace dawinfo
+{
+
+void writeSequence (OscWriter& w, StreamId stream, std::uint32_t seq) noexcept
+{
+    schema::Codec<messages::Sequence>::write (w, { stream, seq });
+}
+
+bool decodeSequence (const OscMessage& m, StreamId& stream, std::uint32_t& seq) noexcept
+{
+    SequenceHeader h;
+
+    if (! schema::Codec<messages::Sequence>::decode (m, h))
+        return false;
+
+    stream = h.stream;
+    seq = h.seq;
+    return true;
+}
+
+void writeEvent (OscWriter& w, const DiscreteEvent& e) noexcept
+{
+    schema::Codec<messages::Event>::write (w, e);
+}
+
+bool decodeEvent (const OscMessage& m, DiscreteEvent& e) noexcept
+{
+    return schema::Codec<messages::Event>::decode (m, e);
+}
+
+} // namespace dawinfo
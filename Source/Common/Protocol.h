@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Common/Osc.h"
+#include "Common/Transport.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/** Independent packet streams. Each carries its own sequence counter so a
+    receiver can tell which kind of data it lost.
+*/
+enum class StreamId : std::uint8_t
+{
+    transport = 0,
+    levels,
+    spectrum,
+    events,
+    metadata,
+    control,
+    midi,
+    parameters,
+    waveform,
+    tempo,
+    stereo,
+    numStreams
+};
+
+constexpr std::size_t numStreams = static_cast<std::size_t> (StreamId::numStreams);
+
+/** Discrete happenings that must not be missed, unlike continuous state. */
+enum class EventType : std::int32_t
+{
+    beat = 0,
+    downbeat,
+    onset,
+    play,
+    stop
+};
+
+struct DiscreteEvent
+{
+    std::uint32_t id = 0;           // unique per sender, increasing
+    EventType type = EventType::beat;
+    HostTimeNs timeNs = 0;
+    float value = 0.0f;
+};
+
+/** The first message of every packet, naming its stream. */
+struct SequenceHeader
+{
+    StreamId stream = StreamId::transport;
+    std::uint32_t seq = 0;
+};
+
+//==============================================================================
+/*  Convenience wrappers over the schema codecs in Common/Messages.h. */
+void writeSequence (OscWriter&, StreamId, std::uint32_t seq) noexcept;
+bool decodeSequence (const OscMessage&, StreamId&, std::uint32_t& seq) noexcept;
+
+void writeEvent (OscWriter&, const DiscreteEvent&) noexcept;
+bool decodeEvent (const OscMessage&, DiscreteEvent&) noexcept;
+
+} // namespace dawinfo
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace dawinfo
+{
+
+/**
+    Read-copy-update holder for an immutable object shared with real-time
+    readers.
+
+    Writers build a complete new object and publish() it; the pointer swap is
+    a single atomic exchange, so a reader sees either the old object or the
+    new one, never a mix. The old object is retired rather than deleted and
+    reclaimed later, once every registered reader has been seen to move past
+    it. Readers never lock, allocate, free or wait.
+
+    Each reading thread registers once (off the real-time path) and then
+    brackets every use with a ReadScope, typically one per audio block. Between
+    scopes a reader holds nothing, so an idle reader never delays reclamation.
+    Reclamation runs on the writer side, in publish() and collect().
+*/
+template <typename T>
+class RcuPointer
+{
+public:
+    static constexpr int maxReaders = 8;
+
+    explicit RcuPointer (std::unique_ptr<T> initial)
+        : current (initial.release())
+    {
+        for (auto& r : readers)
+            r.generation.store (idle, std::memory_order_relaxed);
+    }
+
+    ~RcuPointer()
+    {
+        delete current.load (std::memory_order_acquire);
+    }
+
+    RcuPointer (const RcuPointer&) = delete;
+    RcuPointer& operator= (const RcuPointer&) = delete;
+
+    //==============================================================================
+    /** A registered reader. Belongs to one thread. */
+    class Reader
+    {
+    public:
+        Reader() = default;
+        bool isValid() const noexcept   { return owner != nullptr; }
+
+    private:
+        friend class RcuPointer;
+        Reader (RcuPointer* o, int i) noexcept : owner (o), index (i) {}
+
+        RcuPointer* owner = nullptr;
+        int index = 0;
+    };
+
+    /** Pins the current object for the scope's lifetime. Wait-free. */
+    class ReadScope
+    {
+    public:
+        explicit ReadScope (const Reader& r) noexcept
+            : slot (r.owner->readers[static_cast<std::size_t> (r.index)].generation)
+        {
+            slot.store (r.owner->generation.load (std::memory_order_seq_cst), std::memory_order_seq_cst);
+            object = r.owner->current.load (std::memory_order_seq_cst);
+        }
+
+        ~ReadScope()
+        {
+            slot.store (idle, std::memory_order_release);
+        }
+
+        ReadScope (const ReadScope&) = delete;
+        ReadScope& operator= (const ReadScope&) = delete;
+
+        const T& operator*() const noexcept     { return *object; }
+        const T* operator->() const noexcept    { return object; }
+        const T* get() const noexcept           { return object; }
+
+    private:
+        std::atomic<std::uint64_t>& slot;
+        const T* object;
+    };
+
+    /** Claims a reader slot. Returns an invalid Reader if all are taken. */
+    Reader registerReader()
+    {
+        std::lock_guard<std::mutex> lock (writerLock);
+
+        for (int i = 0; i < maxReaders; ++i)
+        {
+            if (! readerInUse[static_cast<std::size_t> (i)])
+            {
+                readerInUse[static_cast<std::size_t> (i)] = true;
+                return { this, i };
+            }
+        }
+
+        return {};
+    }
+
+    void unregisterReader (Reader& r)
+    {
+        std::lock_guard<std::mutex> lock (writerLock);
+
+        if (r.owner == this)
+        {
+            readers[static_cast<std::size_t> (r.index)].generation.store (idle, std::memory_order_release);
+            readerInUse[static_cast<std::size_t> (r.index)] = false;
+        }
+
+        r = {};
+    }
+
+    //==============================================================================
+    /** Any non-real-time thread: swaps in a new object and retires the old one.
+        Returns the number of retired objects still waiting for readers.
+    */
+    std::size_t publish (std::unique_ptr<T> next)
+    {
+        std::lock_guard<std::mutex> lock (writerLock);
+
+        std::unique_ptr<T> old (current.exchange (next.release(), std::memory_order_seq_cst));
+        const auto retiredAt = generation.fetch_add (1, std::memory_order_seq_cst) + 1;
+        retired.push_back ({ std::move (old), retiredAt });
+        ++published;
+
+        return collectLocked();
+    }
+
+    /** Any non-real-time thread: frees retired objects no reader can still
+        hold. Returns the number still waiting.
+    */
+    std::size_t collect()
+    {
+        std::lock_guard<std::mutex> lock (writerLock);
+        return collectLocked();
+    }
+
+    /** Non-real-time threads only: a snapshot for code that can't hold a
+        ReadScope, e.g. to copy and modify. Safe while no publish() runs concurrently.
+    */
+    const T& getForWriter() const noexcept  { return *current.load (std::memory_order_acquire); }
+
+    std::uint64_t getGeneration() const noexcept    { return generation.load (std::memory_order_acquire); }
+    std::uint64_t getPublished() const noexcept     { return published; }
+    std::uint64_t getReclaimed() const noexcept     { return reclaimed; }
+
+private:
+    static constexpr std::uint64_t idle = ~std::uint64_t (0);
+
+    struct alignas (64) ReaderSlot
+    {
+        std::atomic<std::uint64_t> generation;
+    };
+
+    struct Retired
+    {
+        std::unique_ptr<T> object;
+        std::uint64_t generation;   // readers that started at or after this can't see it
+    };
+
+    std::size_t collectLocked()
+    {
+        std::uint64_t oldestInUse = idle;
+
+        for (auto& r : readers)
+            oldestInUse = std::min (oldestInUse, r.generation.load (std::memory_order_seq_cst));
+
+        std::size_t kept = 0;
+
+        for (auto& r : retired)
+        {
+            if (r.generation <= oldestInUse)
+                ++reclaimed;
+            else
+                retired[kept++] = std::move (r);
+        }
+
+        retired.resize (kept);
+        return kept;
+    }
+
+    std::atomic<T*> current;
+    std::atomic<std::uint64_t> generation { 0 };
+    std::array<ReaderSlot, maxReaders> readers;
+
+    std::mutex writerLock;
+    std::array<bool, maxReaders> readerInUse {};
+    std::vector<Retired> retired;
+    std::uint64_t published = 0, reclaimed = 0;
+};
+
+} // namespace dawinfo
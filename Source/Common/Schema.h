@@ -0,0 +1,340 @@
+#pragma once
+
+#include "Common/Osc.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace dawinfo::schema
+{
+
+/** How often a message is published; used for docs and rate planning. */
+enum class RateClass
+{
+    perBlock,       // once per host audio block
+    perFrame,       // at the analysis/visual frame rate
+    onEvent,        // when something happens
+    onDemand        // in reply to a request
+};
+
+constexpr std::string_view toString (RateClass r) noexcept
+{
+    switch (r)
+    {
+        case RateClass::perBlock:  return "per block";
+        case RateClass::perFrame:  return "per frame";
+        case RateClass::onEvent:   return "on event";
+        case RateClass::onDemand:  return "on demand";
+    }
+
+    return "?";
+}
+
+//==============================================================================
+/** The fixed-size OSC argument types a schema field can use on the wire.
+
+    Strings and blobs aren't among them. Messages that carry one (metadata,
+    peak summaries, history chunks, the vectorscope) are written and read
+    with the generic OscWriter and OscArgumentReader instead, and each caps
+    its variable part so a whole message stays well under a typical MTU.
+*/
+template <typename T> struct WireType;
+
+template <> struct WireType<std::int32_t> { static constexpr char tag = 'i'; static constexpr std::string_view name = "int32";   };
+template <> struct WireType<float>        { static constexpr char tag = 'f'; static constexpr std::string_view name = "float32"; };
+template <> struct WireType<std::int64_t> { static constexpr char tag = 'h'; static constexpr std::string_view name = "int64";   };
+template <> struct WireType<double>       { static constexpr char tag = 'd'; static constexpr std::string_view name = "float64"; };
+
+namespace detail
+{
+    template <typename Member> struct MemberPointer;
+
+    template <typename C, typename M>
+    struct MemberPointer<M C::*>
+    {
+        using Class = C;
+        using Type = M;
+    };
+
+    template <typename T>
+    void storeBigEndian (std::uint8_t* p, T value) noexcept
+    {
+        static_assert (sizeof (T) == 4 || sizeof (T) == 8);
+        std::conditional_t<sizeof (T) == 4, std::uint32_t, std::uint64_t> bits;
+        std::memcpy (&bits, &value, sizeof (bits));
+
+        for (std::size_t i = sizeof (T); i-- > 0;)
+        {
+            p[i] = static_cast<std::uint8_t> (bits);
+            bits >>= 8;
+        }
+    }
+
+    template <typename T>
+    T loadBigEndian (const std::uint8_t* p) noexcept
+    {
+        static_assert (sizeof (T) == 4 || sizeof (T) == 8);
+        std::conditional_t<sizeof (T) == 4, std::uint32_t, std::uint64_t> bits = 0;
+
+        for (std::size_t i = 0; i < sizeof (T); ++i)
+            bits = static_cast<decltype (bits)> ((bits << 8) | p[i]);
+
+        T value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+
+    template <typename Msg, typename = void>
+    struct HasValidate : std::false_type {};
+
+    template <typename Msg>
+    struct HasValidate<Msg, std::void_t<decltype (Msg::validate (std::declval<const typename Msg::Value&>()))>>
+        : std::true_type {};
+
+    template <typename Layout, std::size_t... I>
+    constexpr std::array<char, sizeof...(I) + 2> makeTypeTags (std::index_sequence<I...>) noexcept
+    {
+        return { ',', std::tuple_element_t<I, Layout>::tag..., '\0' };
+    }
+
+    /** Offsets of each field, plus one past the last as the total size. */
+    template <typename Layout, std::size_t... I>
+    constexpr std::array<std::size_t, sizeof...(I) + 1> makeOffsets (std::size_t headerSize, std::index_sequence<I...>) noexcept
+    {
+        constexpr std::size_t sizes[] = { std::tuple_element_t<I, Layout>::size..., 0 };
+        std::array<std::size_t, sizeof...(I) + 1> result {};
+        std::size_t offset = headerSize;
+
+        for (std::size_t i = 0; i < result.size(); ++i)
+        {
+            result[i] = offset;
+            offset += sizes[i];
+        }
+
+        return result;
+    }
+
+    /** Renders the padded address and type tag strings. */
+    template <std::size_t headerSize, std::size_t numTags>
+    constexpr std::array<std::uint8_t, headerSize> makeHeader (std::string_view address, std::size_t addressSize,
+                                                               const std::array<char, numTags>& tags) noexcept
+    {
+        std::array<std::uint8_t, headerSize> h {};
+
+        for (std::size_t i = 0; i < address.size(); ++i)
+            h[i] = static_cast<std::uint8_t> (address[i]);
+
+        for (std::size_t i = 0; i + 1 < numTags; ++i)
+            h[addressSize + i] = static_cast<std::uint8_t> (tags[i]);
+
+        return h;
+    }
+}
+
+//==============================================================================
+/**
+    Binds a data member to a wire type. The wire type defaults to the member's
+    own type; enums, bools and unsigned ints name an explicit one and are
+    converted with static_cast.
+
+    fromWire() refuses a wire value the member can't hold - stream 0x100 in a
+    uint8_t, 2 in a bool - so a message's validate() only ever sees values
+    that were actually sent.
+*/
+template <auto Member, typename Wire = typename detail::MemberPointer<decltype (Member)>::Type>
+struct Field
+{
+    using Class = typename detail::MemberPointer<decltype (Member)>::Class;
+    using MemberType = typename detail::MemberPointer<decltype (Member)>::Type;
+    using WireT = Wire;
+
+    static constexpr char tag = WireType<Wire>::tag;
+    static constexpr std::size_t size = sizeof (Wire);
+
+    static Wire toWire (const Class& c) noexcept           { return static_cast<Wire> (c.*Member); }
+    static bool fromWire (Class& c, Wire w) noexcept
+    {
+        c.*Member = static_cast<MemberType> (w);
+
+        if constexpr (std::is_same_v<Wire, MemberType>)
+            return true;
+        else
+            return static_cast<Wire> (c.*Member) == w;
+    }
+};
+
+template <typename... Fs>
+using Fields = std::tuple<Fs...>;
+
+//==============================================================================
+/**
+    Everything derived from a message description at compile time: the type
+    tag string, the pre-rendered address+tags header, the offset of every
+    field and the total size.
+
+    A message description is a struct with:
+        using Value = ...;                          // the C++ struct it carries
+        using Layout = schema::Fields<...>;         // wire fields, in order
+        static constexpr std::string_view address;
+        static constexpr RateClass rate;
+        static constexpr std::array<std::string_view, N> fieldNames;
+        static constexpr std::string_view description;
+    and optionally  static bool validate (const Value&)  to range-check decodes.
+
+    Every field is fixed size, so encoding is a header memcpy plus stores at
+    constant offsets, and decoding is one header compare plus loads.
+*/
+template <typename Msg>
+struct Codec
+{
+    using Value = typename Msg::Value;
+    using Layout = typename Msg::Layout;
+
+    static constexpr std::size_t numFields = std::tuple_size_v<Layout>;
+
+    static_assert (Msg::fieldNames.size() == numFields, "every field needs a name");
+    static_assert (! Msg::address.empty() && Msg::address.front() == '/', "OSC addresses start with '/'");
+
+    static constexpr std::size_t addressSize = OscWriter::paddedStringSize (Msg::address.size());
+    static constexpr std::size_t tagsSize = OscWriter::paddedStringSize (numFields + 1);
+    static constexpr std::size_t headerSize = addressSize + tagsSize;
+
+private:
+    static constexpr auto typeTagArray = detail::makeTypeTags<Layout> (std::make_index_sequence<numFields>());
+    static constexpr auto offsetArray = detail::makeOffsets<Layout> (headerSize, std::make_index_sequence<numFields>());
+
+public:
+    static constexpr auto header = detail::makeHeader<headerSize> (Msg::address, addressSize, typeTagArray);
+
+    /** The type tag string including its leading comma. */
+    static constexpr std::string_view typeTags { typeTagArray.data(), numFields + 1 };
+
+    /** Byte offset of field I from the start of the message. */
+    template <std::size_t I>
+    static constexpr std::size_t offsetOf = offsetArray[I];
+
+    static constexpr std::size_t wireSize = offsetArray[numFields];
+
+    /** Writes the whole message into out, which must hold wireSize bytes. */
+    static void encode (std::uint8_t* out, const Value& v) noexcept
+    {
+        std::memcpy (out, header.data(), headerSize);
+        encodeFields (out, v, std::make_index_sequence<numFields>());
+    }
+
+    /** Appends the message to a writer (inside a bundle or as the whole packet). */
+    static void write (OscWriter& w, const Value& v) noexcept
+    {
+        if (auto* out = w.appendMessage (wireSize))
+            encode (out, v);
+    }
+
+    /** Decodes a raw message. Fails unless the size, address and type tags
+        match exactly and every field holds a value its member can represent.
+    */
+    static bool decode (const std::uint8_t* data, std::size_t size, Value& v) noexcept
+    {
+        if (size != wireSize || std::memcmp (data, header.data(), headerSize) != 0)
+            return false;
+
+        if (! decodeFields (data, v, std::make_index_sequence<numFields>()))
+            return false;
+
+        if constexpr (detail::HasValidate<Msg>::value)
+            return Msg::validate (v);
+        else
+            return true;
+    }
+
+    static bool decode (const OscMessage& m, Value& v) noexcept
+    {
+        return decode (m.data, m.size, v);
+    }
+
+private:
+    template <std::size_t... I>
+    static void encodeFields (std::uint8_t* out, const Value& v, std::index_sequence<I...>) noexcept
+    {
+        (detail::storeBigEndian (out + offsetArray[I], std::tuple_element_t<I, Layout>::toWire (v)), ...);
+    }
+
+    template <std::size_t... I>
+    static bool decodeFields (const std::uint8_t* in, Value& v, std::index_sequence<I...>) noexcept
+    {
+        return (std::tuple_element_t<I, Layout>::fromWire (
+                    v, detail::loadBigEndian<typename std::tuple_element_t<I, Layout>::WireT> (in + offsetArray[I])) && ...);
+    }
+};
+
+//==============================================================================
+/** One row of the generated address table. */
+struct AddressEntry
+{
+    std::string_view address;
+    std::string_view typeTags;
+    RateClass rate;
+    std::size_t wireSize;
+};
+
+/**
+    The set of messages a stream publishes. Produces the OSC address table and
+    a dispatcher that hands each decoded message to a visitor.
+*/
+template <typename... Msgs>
+struct MessageList
+{
+    static constexpr std::size_t size = sizeof...(Msgs);
+
+    static constexpr std::array<AddressEntry, size> addressTable {
+        AddressEntry { Msgs::address, Codec<Msgs>::typeTags, Msgs::rate, Codec<Msgs>::wireSize }...
+    };
+
+    static constexpr bool addressesAreUnique() noexcept
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            for (std::size_t j = i + 1; j < size; ++j)
+                if (addressTable[i].address == addressTable[j].address)
+                    return false;
+
+        return true;
+    }
+
+    static_assert (addressesAreUnique(), "two schema messages share an OSC address");
+
+    /** Decodes m as whichever listed message it matches and calls
+        visitor (MsgDescription{}, const Value&). Returns false if none match.
+    */
+    template <typename Visitor>
+    static bool dispatch (const OscMessage& m, Visitor&& visitor)
+    {
+        return (tryDecode<Msgs> (m, visitor) || ...);
+    }
+
+    /** Calls fn (MsgDescription{}) for every message, in order. */
+    template <typename Fn>
+    static void forEach (Fn&& fn)
+    {
+        (fn (Msgs {}), ...);
+    }
+
+private:
+    template <typename Msg, typename Visitor>
+    static bool tryDecode (const OscMessage& m, Visitor& visitor)
+    {
+        typename Msg::Value v {};
+
+        if (! Codec<Msg>::decode (m, v))
+            return false;
+
+        visitor (Msg {}, static_cast<const typename Msg::Value&> (v));
+        return true;
+    }
+};
+
+} // namespace dawinfo::schema
@@ -0,0 +1,54 @@
+#include "Common/SchemaDocumentation.h"
+#include "Common/Messages.h"
+
+namespace dawinfo
+{
+
+namespace
+{
+    template <typename Msg, std::size_t... I>
+    void writeFields (std::ostream& out, std::index_sequence<I...>)
+    {
+        using C = schema::Codec<Msg>;
+
+        ((out << "| " << I << " | `" << Msg::fieldNames[I] << "` | "
+              << schema::WireType<typename std::tuple_element_t<I, typename Msg::Layout>::WireT>::name
+              << " | " << C::template offsetOf<I> << " |\n"), ...);
+    }
+
+    template <typename Msg>
+    void writeMessage (std::ostream& out)
+    {
+        using C = schema::Codec<Msg>;
+
+        out << "## `" << Msg::address << "`\n\n"
+            << Msg::description << "\n\n"
+            << "- Type tags: `" << C::typeTags << "`\n"
+            << "- Rate: " << schema::toString (Msg::rate) << "\n"
+            << "- Size: " << C::wireSize << " bytes\n\n"
+            << "| # | Field | Type | Offset |\n"
+            << "|---|-------|------|--------|\n";
+
+        writeFields<Msg> (out, std::make_index_sequence<C::numFields>());
+        out << "\n";
+    }
+}
+
+void writeSchemaMarkdown (std::ostream& out)
+{
+    out << "# dawInfoSender OSC schema\n\n"
+        << "Generated from Source/Common/Messages.h; do not edit.\n"
+        << "All values are big-endian. Offsets are from the start of the message.\n\n"
+        << "| Address | Type tags | Rate | Bytes |\n"
+        << "|---------|-----------|------|-------|\n";
+
+    for (auto& e : messages::Published::addressTable)
+        out << "| `" << e.address << "` | `" << e.typeTags << "` | " << schema::toString (e.rate)
+            << " | " << e.wireSize << " |\n";
+
+    out << "\n";
+
+    messages::Published::forEach ([&] (auto msg) { writeMessage<decltype (msg)> (out); });
+}
+
+} // namespace dawinfo
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <ostream>
+
+namespace dawinfo
+{
+
+/** Writes a Markdown reference of the published OSC schema, generated from
+    the message descriptions in Common/Messages.h.
+*/
+void writeSchemaMarkdown (std::ostream&);
+
+} // namespace dawinfo
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/**
+    Classifies 32-bit sequence numbers against a sliding window of the most
+    recent ones, in the style of an anti-replay window. Comparisons use serial
+    arithmetic so the counter may wrap.
+
+    A number far behind the window is taken to mean the sender restarted, and
+    the window resynchronises on it.
+*/
+template <std::size_t windowSize = 64>
+class SequenceWindow
+{
+public:
+    static_assert (windowSize >= 64 && windowSize % 64 == 0, "window must be whole 64-bit words");
+
+    enum class Result
+    {
+        first,          // the first number seen, or a resync
+        inOrder,        // exactly one past the highest seen
+        gap,            // ahead of the highest, skipping some numbers
+        late,           // behind the highest but not seen before
+        duplicate,      // seen before
+        tooOld          // behind the window; can't tell
+    };
+
+    static constexpr std::uint32_t resyncDistance = 1u << 16;
+
+    /** Classifies seq and records it. skipped receives the count of numbers
+        jumped over when the result is gap.
+    */
+    Result accept (std::uint32_t seq, std::uint32_t* skipped = nullptr) noexcept
+    {
+        if (skipped != nullptr)
+            *skipped = 0;
+
+        if (! started)
+        {
+            restart (seq);
+            return Result::first;
+        }
+
+        const auto distance = static_cast<std::int32_t> (seq - highest);
+
+        if (distance > 0)
+        {
+            if (static_cast<std::uint32_t> (distance) >= resyncDistance)
+            {
+                restart (seq);
+                return Result::first;
+            }
+
+            shiftBy (static_cast<std::uint32_t> (distance));
+            highest = seq;
+            bits[0] |= 1;
+
+            if (distance == 1)
+                return Result::inOrder;
+
+            if (skipped != nullptr)
+                *skipped = static_cast<std::uint32_t> (distance - 1);
+
+            return Result::gap;
+        }
+
+        const auto back = static_cast<std::uint32_t> (-static_cast<std::int64_t> (distance));
+
+        if (back >= resyncDistance)
+        {
+            restart (seq);
+            return Result::first;
+        }
+
+        if (back >= windowSize)
+            return Result::tooOld;
+
+        auto& word = bits[back / 64];
+        const auto bit = std::uint64_t (1) << (back % 64);
+
+        if ((word & bit) != 0)
+            return Result::duplicate;
+
+        word |= bit;
+        return Result::late;
+    }
+
+    void reset() noexcept           { started = false; }
+    bool hasStarted() const noexcept { return started; }
+    std::uint32_t getHighest() const noexcept { return highest; }
+
+private:
+    static constexpr std::size_t numWords = windowSize / 64;
+
+    void restart (std::uint32_t seq) noexcept
+    {
+        started = true;
+        highest = seq;
+        bits = {};
+        bits[0] = 1;
+    }
+
+    void shiftBy (std::uint32_t n) noexcept
+    {
+        if (n >= windowSize)
+        {
+            bits = {};
+            return;
+        }
+
+        const auto wordShift = n / 64;
+        const auto bitShift = n % 64;
+
+        for (std::size_t i = numWords; i-- > 0;)
+        {
+            std::uint64_t v = 0;
+
+            if (i >= wordShift)
+            {
+                v = bits[i - wordShift] << bitShift;
+
+                if (bitShift != 0 && i > wordShift)
+                    v |= bits[i - wordShift - 1] >> (64 - bitShift);
+            }
+
+            bits[i] = v;
+        }
+    }
+
+    std::array<std::uint64_t, numWords> bits {};
+    std::uint32_t highest = 0;
+    bool started = false;
+};
+
+} // namespace dawinfo
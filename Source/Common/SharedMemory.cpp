@@ -0,0 +1,82 @@
+#include "Common/SharedMemory.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dawinfo
+{
+
+bool SharedMemory::create (const std::string& regionName, std::size_t regionSize)
+{
+    close();
+    ::shm_unlink (regionName.c_str());
+
+    const int fd = ::shm_open (regionName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if (fd < 0)
+        return false;
+
+    void* mapped = MAP_FAILED;
+
+    if (::ftruncate (fd, static_cast<off_t> (regionSize)) == 0)
+        mapped = ::mmap (nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    ::close (fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        ::shm_unlink (regionName.c_str());
+        return false;
+    }
+
+    name = regionName;
+    data = mapped;
+    size = regionSize;
+    isOwner = true;
+    return true;
+}
+
+bool SharedMemory::open (const std::string& regionName)
+{
+    close();
+
+    const int fd = ::shm_open (regionName.c_str(), O_RDONLY, 0);
+
+    if (fd < 0)
+        return false;
+
+    struct stat info {};
+    void* mapped = MAP_FAILED;
+
+    if (::fstat (fd, &info) == 0 && info.st_size > 0)
+        mapped = ::mmap (nullptr, static_cast<std::size_t> (info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+
+    ::close (fd);
+
+    if (mapped == MAP_FAILED)
+        return false;
+
+    name = regionName;
+    data = mapped;
+    size = static_cast<std::size_t> (info.st_size);
+    isOwner = false;
+    return true;
+}
+
+void SharedMemory::close() noexcept
+{
+    if (data != nullptr)
+        ::munmap (data, size);
+
+    if (isOwner)
+        ::shm_unlink (name.c_str());
+
+    data = nullptr;
+    size = 0;
+    isOwner = false;
+    name.clear();
+}
+
+} // namespace dawinfo
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace dawinfo
+{
+
+/**
+    A named POSIX shared-memory region mapped into this process.
+
+    The creator owns the name and unlinks it when closed; other processes
+    open it by name. Names start with a slash, e.g. "/dawinfo_tap".
+*/
+class SharedMemory
+{
+public:
+    SharedMemory() = default;
+    ~SharedMemory()     { close(); }
+
+    SharedMemory (const SharedMemory&) = delete;
+    SharedMemory& operator= (const SharedMemory&) = delete;
+
+    /** Creates (replacing any stale region of the same name) and maps it, zero-filled. */
+    bool create (const std::string& name, std::size_t size);
+
+    /** Maps an existing region read-only. */
+    bool open (const std::string& name);
+
+    void close() noexcept;
+
+    bool isOpen() const noexcept        { return data != nullptr; }
+    void* getData() const noexcept      { return data; }
+    std::size_t getSize() const noexcept { return size; }
+
+private:
+    std::string name;
+    void* data = nullptr;
+    std::size_t size = 0;
+    bool isOwner = false;
+};
+
+} // namespace dawinfo
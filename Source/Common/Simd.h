@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define DAWINFO_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define DAWINFO_SIMD_NEON 1
+#endif
+
+namespace dawinfo::simd
+{
+
+/**
+    Four floats in a register, with the handful of operations the sample
+    kernels need. SSE2 on x86, NEON on ARM, plain arrays elsewhere, so
+    kernels are written once and every build has a working path.
+
+    Loads and stores are unaligned; the host's buffers come with no promises.
+*/
+struct Float4
+{
+   #if DAWINFO_SIMD_SSE2
+    __m128 v;
+
+    static Float4 load (const float* p) noexcept            { return { _mm_loadu_ps (p) }; }
+    static Float4 broadcast (float x) noexcept              { return { _mm_set1_ps (x) }; }
+    static Float4 zero() noexcept                           { return { _mm_setzero_ps() }; }
+    void store (float* p) const noexcept                    { _mm_storeu_ps (p, v); }
+
+    friend Float4 operator+ (Float4 a, Float4 b) noexcept   { return { _mm_add_ps (a.v, b.v) }; }
+    friend Float4 operator- (Float4 a, Float4 b) noexcept   { return { _mm_sub_ps (a.v, b.v) }; }
+    friend Float4 operator* (Float4 a, Float4 b) noexcept   { return { _mm_mul_ps (a.v, b.v) }; }
+    friend Float4 operator/ (Float4 a, Float4 b) noexcept   { return { _mm_div_ps (a.v, b.v) }; }
+    friend Float4 min (Float4 a, Float4 b) noexcept         { return { _mm_min_ps (a.v, b.v) }; }
+    friend Float4 max (Float4 a, Float4 b) noexcept         { return { _mm_max_ps (a.v, b.v) }; }
+
+    float sum() const noexcept
+    {
+        const __m128 pairs = _mm_add_ps (v, _mm_movehl_ps (v, v));
+        return _mm_cvtss_f32 (_mm_add_ss (pairs, _mm_shuffle_ps (pairs, pairs, 1)));
+    }
+
+    /** {a0, b0, a1, b1} and {a2, b2, a3, b3}. */
+    static void interleave (Float4 a, Float4 b, Float4& low, Float4& high) noexcept
+    {
+        low = { _mm_unpacklo_ps (a.v, b.v) };
+        high = { _mm_unpackhi_ps (a.v, b.v) };
+    }
+
+    /** The inverse: even and odd elements of {x, y}. */
+    static void deinterleave (Float4 x, Float4 y, Float4& even, Float4& odd) noexcept
+    {
+        even = { _mm_shuffle_ps (x.v, y.v, _MM_SHUFFLE (2, 0, 2, 0)) };
+        odd = { _mm_shuffle_ps (x.v, y.v, _MM_SHUFFLE (3, 1, 3, 1)) };
+    }
+   #elif DAWINFO_SIMD_NEON
+    float32x4_t v;
+
+    static Float4 load (const float* p) noexcept            { return { vld1q_f32 (p) }; }
+    static Float4 broadcast (float x) noexcept              { return { vdupq_n_f32 (x) }; }
+    static Float4 zero() noexcept                           { return { vdupq_n_f32 (0.0f) }; }
+    void store (float* p) const noexcept                    { vst1q_f32 (p, v); }
+
+    friend Float4 operator+ (Float4 a, Float4 b) noexcept   { return { vaddq_f32 (a.v, b.v) }; }
+    friend Float4 operator- (Float4 a, Float4 b) noexcept   { return { vsubq_f32 (a.v, b.v) }; }
+    friend Float4 operator* (Float4 a, Float4 b) noexcept   { return { vmulq_f32 (a.v, b.v) }; }
+   #if defined(__aarch64__)
+    friend Float4 operator/ (Float4 a, Float4 b) noexcept   { return { vdivq_f32 (a.v, b.v) }; }
+   #else
+    friend Float4 operator/ (Float4 a, Float4 b) noexcept
+    {
+        float x[4], y[4];
+        vst1q_f32 (x, a.v);
+        vst1q_f32 (y, b.v);
+
+        for (int i = 0; i < 4; ++i)
+            x[i] /= y[i];
+
+        return { vld1q_f32 (x) };
+    }
+   #endif
+    friend Float4 min (Float4 a, Float4 b) noexcept         { return { vminq_f32 (a.v, b.v) }; }
+    friend Float4 max (Float4 a, Float4 b) noexcept         { return { vmaxq_f32 (a.v, b.v) }; }
+
+    float sum() const noexcept
+    {
+        const float32x2_t pairs = vadd_f32 (vget_low_f32 (v), vget_high_f32 (v));
+        return vget_lane_f32 (vpadd_f32 (pairs, pairs), 0);
+    }
+
+    static void interleave (Float4 a, Float4 b, Float4& low, Float4& high) noexcept
+    {
+        const auto z = vzipq_f32 (a.v, b.v);
+        low = { z.val[0] };
+        high = { z.val[1] };
+    }
+
+    static void deinterleave (Float4 x, Float4 y, Float4& even, Float4& odd) noexcept
+    {
+        const auto u = vuzpq_f32 (x.v, y.v);
+        even = { u.val[0] };
+        odd = { u.val[1] };
+    }
+   #else
+    float v[4];
+
+    static Float4 load (const float* p) noexcept            { return { { p[0], p[1], p[2], p[3] } }; }
+    static Float4 broadcast (float x) noexcept              { return { { x, x, x, x } }; }
+    static Float4 zero() noexcept                           { return broadcast (0.0f); }
+    void store (float* p) const noexcept                    { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+
+    template <typename Op>
+    static Float4 apply (Float4 a, Float4 b, Op op) noexcept
+    {
+        return { { op (a.v[0], b.v[0]), op (a.v[1], b.v[1]), op (a.v[2], b.v[2]), op (a.v[3], b.v[3]) } };
+    }
+
+    friend Float4 operator+ (Float4 a, Float4 b) noexcept   { return apply (a, b, [] (float x, float y) { return x + y; }); }
+    friend Float4 operator- (Float4 a, Float4 b) noexcept   { return apply (a, b, [] (float x, float y) { return x - y; }); }
+    friend Float4 operator* (Float4 a, Float4 b) noexcept   { return apply (a, b, [] (float x, float y) { return x * y; }); }
+    friend Float4 operator/ (Float4 a, Float4 b) noexcept   { return apply (a, b, [] (float x, float y) { return x / y; }); }
+    friend Float4 min (Float4 a, Float4 b) noexcept         { return apply (a, b, [] (float x, float y) { return y < x ? y : x; }); }
+    friend Float4 max (Float4 a, Float4 b) noexcept         { return apply (a, b, [] (float x, float y) { return y > x ? y : x; }); }
+
+    float sum() const noexcept                              { return (v[0] + v[2]) + (v[1] + v[3]); }
+
+    static void interleave (Float4 a, Float4 b, Float4& low, Float4& high) noexcept
+    {
+        low = { { a.v[0], b.v[0], a.v[1], b.v[1] } };
+        high = { { a.v[2], b.v[2], a.v[3], b.v[3] } };
+    }
+
+    static void deinterleave (Float4 x, Float4 y, Float4& even, Float4& odd) noexcept
+    {
+        even = { { x.v[0], x.v[2], y.v[0], y.v[2] } };
+        odd = { { x.v[1], x.v[3], y.v[1], y.v[3] } };
+    }
+   #endif
+
+    Float4& operator+= (Float4 o) noexcept      { return *this = *this + o; }
+};
+
+/** The name of the instruction set in use, for benchmark output. */
+constexpr const char* instructionSet() noexcept
+{
+   #if DAWINFO_SIMD_SSE2
+    return "SSE2";
+   #elif DAWINFO_SIMD_NEON
+    return "NEON";
+   #else
+    return "scalar";
+   #endif
+}
+
+} // namespace dawinfo::simd
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Common/SpscRing.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace dawinfo
+{
+
+/**
+    A fixed set of snapshot objects handed from a producer thread to a
+    consumer thread and back, so neither ever allocates one.
+
+    The producer takes a free object with acquire(), fills it in place and
+    passes it on with submit(). The consumer takes submitted objects in order
+    with next() and hands each back with recycle() when done. Objects keep
+    whatever they own between uses (a reserved vector stays reserved), and
+    none is copied on the way.
+
+    All four calls are lock-free: two SpscRings of pointers, one each way.
+    If the consumer falls behind, acquire() returns nullptr and the producer
+    skips that snapshot rather than waiting.
+*/
+template <typename T>
+class SnapshotPool
+{
+public:
+    explicit SnapshotPool (std::size_t numObjects)
+        : objects (std::make_unique<T[]> (numObjects)), size (numObjects),
+          freeList (numObjects), submitted (numObjects)
+    {
+        for (std::size_t i = 0; i < numObjects; ++i)
+            freeList.push (&objects[i]);
+    }
+
+    /** Producer: a free object, or nullptr if all are in flight. */
+    T* acquire() noexcept
+    {
+        T* t = nullptr;
+        return freeList.pop (t) ? t : nullptr;
+    }
+
+    /** Producer: passes a filled object to the consumer. */
+    void submit (T* t) noexcept             { submitted.push (t); }
+
+    /** Consumer: the oldest submitted object, or nullptr. */
+    T* next() noexcept
+    {
+        T* t = nullptr;
+        return submitted.pop (t) ? t : nullptr;
+    }
+
+    /** Consumer: returns an object for reuse. */
+    void recycle (T* t) noexcept            { freeList.push (t); }
+
+    /** Every object, e.g. to reserve capacity before the threads start. */
+    T* begin() noexcept                     { return objects.get(); }
+    T* end() noexcept                       { return objects.get() + size; }
+
+    std::size_t getSize() const noexcept    { return size; }
+
+    /** The objects and both rings; not what the objects own. */
+    std::size_t getMemoryUsage() const noexcept
+    {
+        return size * sizeof (T) + freeList.getMemoryUsage() + submitted.getMemoryUsage();
+    }
+
+private:
+    std::unique_ptr<T[]> objects;
+    const std::size_t size;
+
+    // Neither can overflow: together they never hold more than size pointers.
+    SpscRing<T*> freeList, submitted;
+};
+
+} // namespace dawinfo
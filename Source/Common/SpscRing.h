@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace dawinfo
+{
+
+/**
+    Bounded single-producer/single-consumer queue.
+
+    Storage is allocated once in the constructor; push() and pop() never
+    allocate, lock or block, so the audio thread can be either end. The
+    capacity is rounded up to a power of two.
+*/
+template <typename T>
+class SpscRing
+{
+public:
+    static_assert (std::is_trivially_copyable_v<T>, "ring slots are copied, not constructed");
+
+    explicit SpscRing (std::size_t minCapacity)
+        : capacity (roundUpToPowerOfTwo (minCapacity)), mask (capacity - 1),
+          slots (std::make_unique<T[]> (capacity))
+    {
+    }
+
+    /** Producer: returns false if full. */
+    bool push (const T& item) noexcept
+    {
+        const auto w = writeIndex.load (std::memory_order_relaxed);
+
+        if (w - cachedReadIndex == capacity)
+        {
+            cachedReadIndex = readIndex.load (std::memory_order_acquire);
+
+            if (w - cachedReadIndex == capacity)
+                return false;
+        }
+
+        slots[w & mask] = item;
+        writeIndex.store (w + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer: returns false if empty. */
+    bool pop (T& item) noexcept
+    {
+        const auto r = readIndex.load (std::memory_order_relaxed);
+
+        if (r == cachedWriteIndex)
+        {
+            cachedWriteIndex = writeIndex.load (std::memory_order_acquire);
+
+            if (r == cachedWriteIndex)
+                return false;
+        }
+
+        item = slots[r & mask];
+        readIndex.store (r + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Approximate when called from either end while the other is active. */
+    std::size_t size() const noexcept
+    {
+        return writeIndex.load (std::memory_order_acquire) - readIndex.load (std::memory_order_acquire);
+    }
+
+    bool isEmpty() const noexcept               { return size() == 0; }
+    std::size_t getCapacity() const noexcept    { return capacity; }
+    std::size_t getMemoryUsage() const noexcept { return capacity * sizeof (T); }
+
+private:
+    static std::size_t roundUpToPowerOfTwo (std::size_t n) noexcept
+    {
+        std::size_t p = 1;
+
+        while (p < n)
+            p <<= 1;
+
+        return p;
+    }
+
+    const std::size_t capacity, mask;
+    std::unique_ptr<T[]> slots;
+
+    // Each end keeps its own index and a cached copy of the other's on its
+    // own cache line, so steady-state traffic doesn't bounce lines.
+    alignas (64) std::atomic<std::size_t> writeIndex { 0 };
+    std::size_t cachedReadIndex = 0;
+    alignas (64) std::atomic<std::size_t> readIndex { 0 };
+    std::size_t cachedWriteIndex = 0;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,48 @@
+#include "Common/StereoImage.h"
+
+namespace dawinfo::vectorscope
+{
+
+void writePoints (OscWriter& w, HostTimeNs timeNs, const Point* points, int numPoints) noexcept
+{
+    std::uint8_t packed[maxPoints * 2];
+    const auto n = static_cast<std::size_t> (std::clamp (numPoints, 0, maxPoints));
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        packed[i * 2]     = static_cast<std::uint8_t> (quantize (points[i].side));
+        packed[i * 2 + 1] = static_cast<std::uint8_t> (quantize (points[i].mid));
+    }
+
+    w.beginMessage (pointsAddress, "hib");
+    w.addInt64 (timeNs);
+    w.addInt32 (static_cast<std::int32_t> (n));
+    w.addBlob (packed, n * 2);
+    w.endMessage();
+}
+
+std::size_t pointsSize (int numPoints) noexcept
+{
+    const auto blobBytes = static_cast<std::size_t> (numPoints) * 2;
+
+    return 4 + OscWriter::paddedStringSize (pointsAddress.size()) + OscWriter::paddedStringSize (4)
+             + 8 + 4 + 4 + ((blobBytes + 3) & ~std::size_t (3));
+}
+
+bool decodePoints (const OscMessage& m, HostTimeNs& timeNs, int& numPoints, const std::uint8_t*& packed) noexcept
+{
+    if (m.address != pointsAddress)
+        return false;
+
+    OscArgumentReader r (m);
+    std::int32_t n = 0;
+    std::size_t blobSize = 0;
+
+    if (! (r.readInt64 (timeNs) && r.readInt32 (n) && r.readBlob (packed, blobSize)))
+        return false;
+
+    numPoints = n;
+    return n >= 0 && n <= maxPoints && blobSize == static_cast<std::size_t> (n) * 2;
+}
+
+} // namespace dawinfo::vectorscope
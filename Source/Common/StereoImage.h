@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Common/Osc.h"
+#include "Common/Transport.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+
+namespace dawinfo
+{
+
+/** A stereo image meter reading, over the meter's integration time. */
+struct StereoMeter
+{
+    static constexpr float minDb = -120.0f;
+
+    HostTimeNs timeNs = 0;
+    float correlation = 0.0f;       // +1 mono, 0 unrelated, -1 anti-phase; 0 in silence
+    float balance = 0.0f;           // -1 all left, +1 all right
+    float midDb = minDb;            // RMS of (L + R) / 2
+    float sideDb = minDb;           // RMS of (R - L) / 2
+};
+
+/*  The vectorscope's point cloud is a packed blob, so it isn't a schema
+    message (see WireType in Common/Schema.h). It follows /dawinfo/stereo in
+    the same packet on StreamId::stereo:
+
+        /dawinfo/vectorscope    ,hib    timeNs numPoints points
+
+    Each point is a (side, mid) pair of samples, side = (R - L) / 2 across
+    and mid = (L + R) / 2 up, as signed 8-bit values in 1/127ths of full
+    scale: mono draws a vertical line, anti-phase a horizontal one. The
+    points are a uniform sample of the frame, in no particular order.
+*/
+namespace vectorscope
+{
+    constexpr std::string_view pointsAddress = "/dawinfo/vectorscope";
+
+    constexpr int maxPoints = 512;
+
+    struct Point
+    {
+        float side = 0.0f;
+        float mid = 0.0f;
+    };
+
+    void writePoints (OscWriter&, HostTimeNs, const Point*, int numPoints) noexcept;
+
+    /** Bytes the message takes inside a bundle, including the size prefix. */
+    std::size_t pointsSize (int numPoints) noexcept;
+
+    /** packed points into the message; read points with unpack(). */
+    bool decodePoints (const OscMessage&, HostTimeNs&, int& numPoints, const std::uint8_t*& packed) noexcept;
+
+    inline std::int8_t quantize (float v) noexcept
+    {
+        return static_cast<std::int8_t> (std::clamp (v * 127.0f, -127.0f, 127.0f));
+    }
+
+    inline Point unpack (const std::uint8_t* packed, std::size_t index) noexcept
+    {
+        return { static_cast<std::int8_t> (packed[index * 2]) / 127.0f,
+                 static_cast<std::int8_t> (packed[index * 2 + 1]) / 127.0f };
+    }
+}
+
+} // namespace dawinfo
@@ -0,0 +1,180 @@
+#include "Common/TempoMap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dawinfo
+{
+
+namespace
+{
+    constexpr double epsilon = 1.0e-9;
+
+    /** Saturates, so a map with absurd values gives absurd bars rather than overflowing. */
+    std::int32_t saturateToInt32 (double v) noexcept
+    {
+        constexpr double lowest = -2147483648.0, highest = 2147483647.0;
+        return v >= highest ? static_cast<std::int32_t> (highest) : v > lowest ? static_cast<std::int32_t> (v) : static_cast<std::int32_t> (lowest);
+    }
+
+    /** Seconds across [a, b) inside one segment. */
+    double segmentSeconds (const TempoSegment& s, double a, double b) noexcept
+    {
+        double seconds = 0.0;
+
+        // Before the segment starts, its starting tempo holds.
+        if (a < s.startPpq)
+        {
+            const double end = std::min (b, s.startPpq);
+            seconds += 60.0 * (end - a) / s.bpmAt (a);
+            a = end;
+        }
+
+        if (b <= a)
+            return seconds;
+
+        const double k = s.bpmPerQuarter;
+
+        if (std::abs (k) < 1.0e-12)
+            return seconds + 60.0 * (b - a) / s.bpmAt (a);
+
+        // The line may run into a limit, after which the tempo holds there.
+        const double limit = k > 0.0 ? TempoSegment::maxBpm : TempoSegment::minBpm;
+        const double limitPpq = s.startPpq + (limit - s.bpm) / k;
+        const double rampEnd = std::clamp (limitPpq, a, b);
+
+        if (rampEnd > a)
+            seconds += 60.0 / k * std::log (s.bpmAt (rampEnd) / s.bpmAt (a));
+
+        return seconds + 60.0 * (b - rampEnd) / limit;
+    }
+}
+
+//==============================================================================
+double TempoSegment::bpmAt (double ppq) const noexcept
+{
+    return std::clamp (bpm + bpmPerQuarter * std::max (ppq - startPpq, 0.0), minBpm, maxBpm);
+}
+
+bool TempoSegment::sameMeter (const TempoSegment& o) const noexcept
+{
+    if (timeSigNumerator != o.timeSigNumerator || timeSigDenominator != o.timeSigDenominator)
+        return false;
+
+    const double bars = (o.barStartPpq - barStartPpq) / quarterNotesPerBar();
+    const double whole = std::round (bars);
+    return std::abs (bars - whole) < 1.0e-6 && o.barNumber - barNumber == static_cast<std::int32_t> (whole);
+}
+
+bool TempoSegment::operator== (const TempoSegment& o) const noexcept
+{
+    return startPpq == o.startPpq && bpm == o.bpm && bpmPerQuarter == o.bpmPerQuarter
+            && barStartPpq == o.barStartPpq && barNumber == o.barNumber
+            && timeSigNumerator == o.timeSigNumerator && timeSigDenominator == o.timeSigDenominator;
+}
+
+//==============================================================================
+const TempoSegment* TempoMap::findSegment (double ppq) const noexcept
+{
+    if (segments.empty())
+        return nullptr;
+
+    auto next = std::upper_bound (segments.begin(), segments.end(), ppq,
+                                  [] (double p, const TempoSegment& s) { return p < s.startPpq; });
+
+    return next == segments.begin() ? &segments.front() : &*(next - 1);
+}
+
+double TempoMap::bpmAt (double ppq) const noexcept
+{
+    const auto* s = findSegment (ppq);
+    return s != nullptr ? s->bpmAt (ppq) : 120.0;
+}
+
+double TempoMap::secondsBetween (double fromPpq, double toPpq) const noexcept
+{
+    if (toPpq <= fromPpq)
+        return 0.0;
+
+    if (segments.empty())
+        return 60.0 * (toPpq - fromPpq) / 120.0;
+
+    double seconds = 0.0;
+
+    for (double p = fromPpq; p < toPpq;)
+    {
+        const auto* s = findSegment (p);
+        const auto index = static_cast<std::size_t> (s - segments.data());
+        const double end = index + 1 < segments.size() ? std::min (toPpq, segments[index + 1].startPpq) : toPpq;
+
+        seconds += segmentSeconds (*s, p, end);
+        p = end;
+    }
+
+    return seconds;
+}
+
+int TempoMap::predictBeats (double fromPpq, HostTimeNs fromNs, BeatTime* out, int maxBeats) const noexcept
+{
+    if (segments.empty() || maxBeats <= 0)
+        return 0;
+
+    double p = fromPpq, seconds = 0.0;
+    bool inclusive = true;
+    int count = 0;
+
+    // Each pass either writes a beat or moves to a segment start or the loop
+    // start, so this bounds the work even for a degenerate map.
+    const int maxPasses = maxBeats * 4 + static_cast<int> (segments.size()) * 2 + 16;
+
+    for (int pass = 0; pass < maxPasses && count < maxBeats; ++pass)
+    {
+        const auto* s = findSegment (p);
+        const auto index = static_cast<std::size_t> (s - segments.data());
+        const double beatLength = s->quarterNotesPerBeat();
+
+        const double beatsIn = (p - s->barStartPpq) / beatLength;
+        double beatIndex = std::ceil (beatsIn - epsilon);
+
+        if (! inclusive && beatIndex <= beatsIn + epsilon)
+            beatIndex += 1.0;
+
+        const double q = s->barStartPpq + beatIndex * beatLength;
+
+        // The loop end comes first: carry on from the loop start.
+        if (hasLoop() && p < loopEndPpq && q >= loopEndPpq - epsilon)
+        {
+            seconds += secondsBetween (p, loopEndPpq);
+            p = loopStartPpq;
+            inclusive = true;
+            continue;
+        }
+
+        // A new segment comes first: its grid takes over from its start.
+        if (index + 1 < segments.size() && segments[index + 1].startPpq <= q + epsilon && segments[index + 1].startPpq > p + epsilon)
+        {
+            seconds += secondsBetween (p, segments[index + 1].startPpq);
+            p = segments[index + 1].startPpq;
+            inclusive = true;
+            continue;
+        }
+
+        seconds += secondsBetween (p, q);
+        p = q;
+        inclusive = false;
+
+        const double barLength = s->quarterNotesPerBar();
+        const double bars = std::floor ((q - s->barStartPpq) / barLength + epsilon);
+        const double beatInBar = std::round ((q - s->barStartPpq - bars * barLength) / beatLength);
+
+        auto& b = out[count++];
+        b.timeNs = fromNs + static_cast<HostTimeNs> (std::llround (seconds * 1.0e9));
+        b.ppq = q;
+        b.bar = saturateToInt32 (s->barNumber + bars);
+        b.beat = saturateToInt32 (beatInBar) % std::max (s->timeSigNumerator, 1);
+    }
+
+    return count;
+}
+
+} // namespace dawinfo
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Common/Transport.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace dawinfo
+{
+
+/** One stretch of a tempo map, in musical time. It runs from startPpq to the
+    next segment's start, and the last one runs on. The tempo moves linearly
+    with position, so a ramp is one segment; the meter holds throughout.
+*/
+struct TempoSegment
+{
+    static constexpr double minBpm = 1.0;
+    static constexpr double maxBpm = 1000.0;
+
+    double startPpq = 0.0;
+    double bpm = 120.0;                 // at startPpq
+    double bpmPerQuarter = 0.0;         // the ramp's slope; 0 for a steady tempo
+    double barStartPpq = 0.0;           // any bar line of this meter, which fixes the bar grid
+    std::int32_t barNumber = 0;         // zero-based number of the bar starting there
+    std::int32_t timeSigNumerator = 4;
+    std::int32_t timeSigDenominator = 4;
+
+    /** Before startPpq, the starting tempo; held between minBpm and maxBpm. */
+    double bpmAt (double ppq) const noexcept;
+    double quarterNotesPerBeat() const noexcept     { return timeSigDenominator > 0 ? 4.0 / timeSigDenominator : 1.0; }
+    double quarterNotesPerBar() const noexcept      { return timeSigNumerator * quarterNotesPerBeat(); }
+
+    /** Same time signature, bar grid and bar numbering; the bar lines
+        named may be any whole number of bars apart.
+    */
+    bool sameMeter (const TempoSegment&) const noexcept;
+
+    bool operator== (const TempoSegment&) const noexcept;
+    bool operator!= (const TempoSegment& o) const noexcept  { return ! operator== (o); }
+};
+
+/** Opens each tempo map packet. An update keeps the receiver's segments
+    before replaceFrom and replaces the rest, and may span several packets.
+    One that replaces from 0 is a full sync and applies to any version.
+*/
+struct TempoMapHeader
+{
+    std::uint32_t baseVersion = 0;      // the version the update applies to
+    std::uint32_t version = 0;
+    std::int32_t part = 0;
+    std::int32_t numParts = 1;
+    std::int32_t replaceFrom = 0;
+    std::int32_t firstSegment = 0;      // index of this packet's first segment
+    std::int32_t numSegments = 0;       // in the whole map
+    bool isLooping = false;
+    double loopStartPpq = 0.0;
+    double loopEndPpq = 0.0;
+};
+
+/** A beat as a receiver expects it to happen. */
+struct BeatTime
+{
+    HostTimeNs timeNs = 0;
+    double ppq = 0.0;
+    std::int32_t bar = 0;               // zero-based
+    std::int32_t beat = 0;              // zero-based, in time-signature beats
+
+    bool isDownbeat() const noexcept    { return beat == 0; }
+};
+
+//==============================================================================
+/**
+    The host's tempo map as far as it has been seen: tempo segments, meter
+    changes and the loop. The sender builds one from observed transport with
+    a TempoMapBuilder and publishes it on StreamId::tempo; a receiver keeps
+    a copy with a TempoMapMirror.
+
+    A receiver that knows where the playhead is now (from its TransportClock)
+    can then work out when coming beats and bars will fall, across tempo
+    changes, meter changes and loop wraps, and schedule ahead of them - a
+    lighting cue sent early to make up for a fixture's latency, say.
+    Positions before the first segment use the first; after the last, the
+    last's tempo line, held between TempoSegment::minBpm and maxBpm.
+*/
+struct TempoMap
+{
+    /** The most a map may hold; receivers reject larger ones. */
+    static constexpr std::int32_t maxSegments = 4096;
+
+    std::vector<TempoSegment> segments;     // by startPpq
+    bool isLooping = false;
+    double loopStartPpq = 0.0;
+    double loopEndPpq = 0.0;
+
+    /** The segment in force at ppq, or nullptr if there are none. */
+    const TempoSegment* findSegment (double ppq) const noexcept;
+
+    double bpmAt (double ppq) const noexcept;
+
+    /** Seconds the playhead takes from one position to a later one, ignoring the loop. */
+    double secondsBetween (double fromPpq, double toPpq) const noexcept;
+
+    /** Fills out with up to maxBeats beats after fromPpq, which the
+        playhead is at when fromNs; wraps at the loop end while looping.
+        Returns how many were written.
+    */
+    int predictBeats (double fromPpq, HostTimeNs fromNs, BeatTime* out, int maxBeats) const noexcept;
+
+    bool hasLoop() const noexcept   { return isLooping && loopEndPpq > loopStartPpq; }
+};
+
+} // namespace dawinfo
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/** Nanoseconds on a monotonic clock. Sender and receiver each use their own. */
+using HostTimeNs = std::int64_t;
+
+//==============================================================================
+/** The transport state published once per host block. */
+struct TransportSnapshot
+{
+    HostTimeNs timeNs = 0;          // when ppq was valid
+    double ppq = 0.0;               // position in quarter notes
+    double bpm = 120.0;
+    double barStartPpq = 0.0;       // ppq of the start of the current bar
+    std::int32_t barNumber = 0;     // zero-based index of the bar starting at barStartPpq
+    std::int32_t timeSigNumerator = 4;
+    std::int32_t timeSigDenominator = 4;
+    bool isPlaying = false;
+    bool isLooping = false;
+    double loopStartPpq = 0.0;
+    double loopEndPpq = 0.0;
+
+    /** Length of one bar in quarter notes. */
+    double quarterNotesPerBar() const noexcept
+    {
+        return timeSigDenominator > 0 ? timeSigNumerator * 4.0 / timeSigDenominator : 4.0;
+    }
+};
+
+} // namespace dawinfo
@@ -0,0 +1,172 @@
+#include "Common/UdpSocket.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace dawinfo
+{
+
+namespace
+{
+    sockaddr_in toSockAddr (const Endpoint& e) noexcept
+    {
+        sockaddr_in a {};
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl (e.address);
+        a.sin_port = htons (e.port);
+        return a;
+    }
+}
+
+bool resolveEndpoint (const std::string& host, int port, Endpoint& out)
+{
+    if (port <= 0 || port > 65535)
+        return false;
+
+    addrinfo hints {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* found = nullptr;
+
+    if (::getaddrinfo (host.c_str(), nullptr, &hints, &found) != 0 || found == nullptr)
+        return false;
+
+    const auto* a = reinterpret_cast<const sockaddr_in*> (found->ai_addr);
+    out.address = ntohl (a->sin_addr.s_addr);
+    out.port = static_cast<std::uint16_t> (port);
+    ::freeaddrinfo (found);
+    return true;
+}
+
+//==============================================================================
+bool UdpSocket::open (int requestedPort, bool loopbackOnly, bool sharePort)
+{
+    close();
+
+    if (requestedPort < 0 || requestedPort > 65535)
+        return false;
+
+    const int s = ::socket (AF_INET, SOCK_DGRAM, 0);
+
+    if (s < 0)
+        return false;
+
+    const int yes = 1;
+
+    if (sharePort)
+        ::setsockopt (s, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof (yes));
+
+    auto local = toSockAddr ({ loopbackOnly ? Endpoint::loopbackAddress : INADDR_ANY,
+                               static_cast<std::uint16_t> (requestedPort) });
+    socklen_t length = sizeof (local);
+
+    if (::bind (s, reinterpret_cast<const sockaddr*> (&local), sizeof (local)) != 0
+         || ::getsockname (s, reinterpret_cast<sockaddr*> (&local), &length) != 0)
+    {
+        ::close (s);
+        return false;
+    }
+
+    fd = s;
+    port = ntohs (local.sin_port);
+    return true;
+}
+
+void UdpSocket::close() noexcept
+{
+    if (fd >= 0)
+        ::close (fd);
+
+    fd = -1;
+    port = 0;
+}
+
+bool UdpSocket::sendTo (const Endpoint& to, const std::uint8_t* data, std::size_t size) noexcept
+{
+    if (fd < 0)
+        return false;
+
+    const auto a = toSockAddr (to);
+
+    // Never block: a full send queue is reported as congestion instead of
+    // holding up the sending thread.
+    const auto sent = ::sendto (fd, data, size, MSG_DONTWAIT, reinterpret_cast<const sockaddr*> (&a), sizeof (a));
+
+    if (sent == static_cast<ssize_t> (size))
+        return true;
+
+    sendFailures.fetch_add (1, std::memory_order_relaxed);
+
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS))
+        congestedSends.fetch_add (1, std::memory_order_relaxed);
+
+    return false;
+}
+
+bool UdpSocket::setSendBufferSize (int bytes) noexcept
+{
+    return fd >= 0 && bytes > 0 && ::setsockopt (fd, SOL_SOCKET, SO_SNDBUF, &bytes, sizeof (bytes)) == 0;
+}
+
+bool UdpSocket::setMulticastOptions (const MulticastOptions& o) noexcept
+{
+    if (fd < 0 || o.ttl < 0 || o.ttl > 255)
+        return false;
+
+    const unsigned char ttl = static_cast<unsigned char> (o.ttl);
+    const unsigned char loop = o.loopback ? 1 : 0;
+    in_addr interface {};
+    interface.s_addr = htonl (o.interface);
+
+    return ::setsockopt (fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof (ttl)) == 0
+        && ::setsockopt (fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof (loop)) == 0
+        && ::setsockopt (fd, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof (interface)) == 0;
+}
+
+bool UdpSocket::joinGroup (std::uint32_t group, std::uint32_t interface) noexcept
+{
+    ip_mreq request {};
+    request.imr_multiaddr.s_addr = htonl (group);
+    request.imr_interface.s_addr = htonl (interface);
+    return fd >= 0 && ::setsockopt (fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof (request)) == 0;
+}
+
+bool UdpSocket::leaveGroup (std::uint32_t group, std::uint32_t interface) noexcept
+{
+    ip_mreq request {};
+    request.imr_multiaddr.s_addr = htonl (group);
+    request.imr_interface.s_addr = htonl (interface);
+    return fd >= 0 && ::setsockopt (fd, IPPROTO_IP, IP_DROP_MEMBERSHIP, &request, sizeof (request)) == 0;
+}
+
+long UdpSocket::receive (std::uint8_t* buffer, std::size_t capacity, Endpoint& from, int timeoutMs) noexcept
+{
+    if (fd < 0)
+        return -1;
+
+    pollfd p { fd, POLLIN, 0 };
+    const int ready = ::poll (&p, 1, timeoutMs);
+
+    if (ready <= 0)
+        return ready;
+
+    sockaddr_in a {};
+    socklen_t length = sizeof (a);
+    const auto n = ::recvfrom (fd, buffer, capacity, 0, reinterpret_cast<sockaddr*> (&a), &length);
+
+    if (n < 0)
+        return -1;
+
+    from.address = ntohl (a.sin_addr.s_addr);
+    from.port = ntohs (a.sin_port);
+    return static_cast<long> (n);
+}
+
+} // namespace dawinfo
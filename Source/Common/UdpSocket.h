@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Common/PacketSink.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dawinfo
+{
+
+/** An IPv4 address and port, both in host byte order. */
+struct Endpoint
+{
+    std::uint32_t address = 0;
+    std::uint16_t port = 0;
+
+    static constexpr std::uint32_t loopbackAddress = 0x7f000001;
+
+    /** 224.0.0.0/4 */
+    bool isMulticast() const noexcept       { return (address >> 28) == 0xe; }
+
+    bool operator== (const Endpoint& o) const noexcept  { return address == o.address && port == o.port; }
+    bool operator!= (const Endpoint& o) const noexcept  { return ! operator== (o); }
+};
+
+/** Looks up an IPv4 host name or dotted address. Blocks on DNS; not for the audio thread. */
+bool resolveEndpoint (const std::string& host, int port, Endpoint&);
+
+/** How multicast packets leave this host. */
+struct MulticastOptions
+{
+    int ttl = 1;                        // 1 stays on the local subnet
+    std::uint32_t interface = 0;        // address of the outgoing interface; 0 lets the OS pick
+    bool loopback = false;              // also deliver to receivers on this host
+};
+
+//==============================================================================
+/**
+    A bound, non-connected UDP socket (POSIX).
+
+    sendTo() may be called from several threads at once; receive() belongs to
+    one thread. Neither allocates.
+*/
+class UdpSocket
+{
+public:
+    UdpSocket() = default;
+    ~UdpSocket()        { close(); }
+
+    UdpSocket (const UdpSocket&) = delete;
+    UdpSocket& operator= (const UdpSocket&) = delete;
+
+    /** Binds to the port on all interfaces, or loopback only. Port 0 picks a
+        free one. A shared port can be bound by several sockets at once, as
+        multicast receivers on one host need.
+    */
+    bool open (int port = 0, bool loopbackOnly = false, bool sharePort = false);
+    void close() noexcept;
+
+    bool isOpen() const noexcept        { return fd >= 0; }
+
+    /** The bound port, or 0 while closed. */
+    int getPort() const noexcept        { return port; }
+
+    /** Never blocks: a datagram the send queue has no room for fails, and
+        counts as congested.
+    */
+    bool sendTo (const Endpoint&, const std::uint8_t* data, std::size_t size) noexcept;
+
+    /** Failed sends so far, and how many of those failed because the socket
+        or interface queue was full (EAGAIN, ENOBUFS) rather than for good.
+    */
+    std::uint64_t getSendFailures() const noexcept      { return sendFailures.load (std::memory_order_relaxed); }
+    std::uint64_t getCongestedSends() const noexcept    { return congestedSends.load (std::memory_order_relaxed); }
+
+    /** Sending side: the kernel's send queue for this socket, in bytes. The
+        kernel may round it up. A smaller queue reports congestion sooner.
+    */
+    bool setSendBufferSize (int bytes) noexcept;
+
+    /** Sending side: TTL, interface and loopback for multicast sends. */
+    bool setMulticastOptions (const MulticastOptions&) noexcept;
+
+    /** Receiving side: joins or leaves a group on the given interface (0 for the default). */
+    bool joinGroup (std::uint32_t group, std::uint32_t interface = 0) noexcept;
+    bool leaveGroup (std::uint32_t group, std::uint32_t interface = 0) noexcept;
+
+    /** Waits up to timeoutMs for a datagram. Returns its size, 0 on timeout,
+        or -1 on error. Datagrams longer than capacity are truncated.
+    */
+    long receive (std::uint8_t* buffer, std::size_t capacity, Endpoint& from, int timeoutMs) noexcept;
+
+private:
+    int fd = -1;
+    int port = 0;
+    std::atomic<std::uint64_t> sendFailures { 0 }, congestedSends { 0 };
+};
+
+//==============================================================================
+/** Sends every packet to one endpoint through a shared socket. */
+class UdpSink : public PacketSink
+{
+public:
+    UdpSink (UdpSocket& s, const Endpoint& to) noexcept : socket (s), destination (to) {}
+
+    bool send (const std::uint8_t* data, std::size_t size) override
+    {
+        return socket.sendTo (destination, data, size);
+    }
+
+private:
+    UdpSocket& socket;
+    Endpoint destination;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,244 @@
+#include "Common/WebSocket.h"
+
+#include <cstring>
+
+namespace dawinfo::websocket
+{
+
+namespace
+{
+    constexpr std::string_view handshakeGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+    std::uint32_t rotateLeft (std::uint32_t x, int n) noexcept
+    {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    char lower (char c) noexcept
+    {
+        return c >= 'A' && c <= 'Z' ? static_cast<char> (c - 'A' + 'a') : c;
+    }
+
+    bool equalsIgnoringCase (std::string_view a, std::string_view b) noexcept
+    {
+        if (a.size() != b.size())
+            return false;
+
+        for (std::size_t i = 0; i < a.size(); ++i)
+            if (lower (a[i]) != lower (b[i]))
+                return false;
+
+        return true;
+    }
+
+    std::string_view trim (std::string_view s) noexcept
+    {
+        while (! s.empty() && (s.front() == ' ' || s.front() == '\t'))
+            s.remove_prefix (1);
+
+        while (! s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+            s.remove_suffix (1);
+
+        return s;
+    }
+}
+
+std::array<std::uint8_t, 20> sha1 (const void* data, std::size_t size) noexcept
+{
+    std::uint32_t h[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+    const auto* bytes = static_cast<const std::uint8_t*> (data);
+    const std::uint64_t bitLength = static_cast<std::uint64_t> (size) * 8;
+
+    // The message, a 0x80 byte, zeros to 56 mod 64, then the length: processed a block at a time.
+    const std::size_t total = (size + 8) / 64 * 64 + 64;
+
+    for (std::size_t block = 0; block < total; block += 64)
+    {
+        std::uint8_t chunk[64];
+
+        for (std::size_t i = 0; i < 64; ++i)
+        {
+            const auto at = block + i;
+
+            if (at < size)                  chunk[i] = bytes[at];
+            else if (at == size)            chunk[i] = 0x80;
+            else if (at >= total - 8)       chunk[i] = static_cast<std::uint8_t> (bitLength >> (8 * (total - 1 - at)));
+            else                            chunk[i] = 0;
+        }
+
+        std::uint32_t w[80];
+
+        for (int i = 0; i < 16; ++i)
+            w[i] = static_cast<std::uint32_t> (chunk[4 * i]) << 24 | static_cast<std::uint32_t> (chunk[4 * i + 1]) << 16
+                 | static_cast<std::uint32_t> (chunk[4 * i + 2]) << 8 | chunk[4 * i + 3];
+
+        for (int i = 16; i < 80; ++i)
+            w[i] = rotateLeft (w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+
+        for (int i = 0; i < 80; ++i)
+        {
+            std::uint32_t f, k;
+
+            if (i < 20)         { f = (b & c) | (~b & d);            k = 0x5a827999; }
+            else if (i < 40)    { f = b ^ c ^ d;                     k = 0x6ed9eba1; }
+            else if (i < 60)    { f = (b & c) | (b & d) | (c & d);   k = 0x8f1bbcdc; }
+            else                { f = b ^ c ^ d;                     k = 0xca62c1d6; }
+
+            const auto t = rotateLeft (a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotateLeft (b, 30);
+            b = a;
+            a = t;
+        }
+
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    std::array<std::uint8_t, 20> digest {};
+
+    for (int i = 0; i < 20; ++i)
+        digest[static_cast<std::size_t> (i)] = static_cast<std::uint8_t> (h[i / 4] >> (24 - 8 * (i % 4)));
+
+    return digest;
+}
+
+std::string base64 (const std::uint8_t* data, std::size_t size)
+{
+    static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve ((size + 2) / 3 * 4);
+
+    for (std::size_t i = 0; i < size; i += 3)
+    {
+        const std::uint32_t n = static_cast<std::uint32_t> (data[i]) << 16
+                              | (i + 1 < size ? static_cast<std::uint32_t> (data[i + 1]) << 8 : 0)
+                              | (i + 2 < size ? data[i + 2] : 0);
+
+        out += alphabet[(n >> 18) & 63];
+        out += alphabet[(n >> 12) & 63];
+        out += i + 1 < size ? alphabet[(n >> 6) & 63] : '=';
+        out += i + 2 < size ? alphabet[n & 63] : '=';
+    }
+
+    return out;
+}
+
+std::string acceptKey (std::string_view clientKey)
+{
+    std::string combined (clientKey);
+    combined += handshakeGuid;
+    const auto digest = sha1 (combined.data(), combined.size());
+    return base64 (digest.data(), digest.size());
+}
+
+//==============================================================================
+std::size_t writeFrameHeader (std::uint8_t* out, const FrameHeader& h) noexcept
+{
+    std::size_t size = 0;
+    out[size++] = static_cast<std::uint8_t> ((h.final ? 0x80 : 0) | h.opcode);
+    const std::uint8_t maskBit = h.masked ? 0x80 : 0;
+
+    if (h.payloadSize < 126)
+    {
+        out[size++] = static_cast<std::uint8_t> (maskBit | h.payloadSize);
+    }
+    else if (h.payloadSize <= 0xffff)
+    {
+        out[size++] = maskBit | 126;
+        out[size++] = static_cast<std::uint8_t> (h.payloadSize >> 8);
+        out[size++] = static_cast<std::uint8_t> (h.payloadSize);
+    }
+    else
+    {
+        out[size++] = maskBit | 127;
+
+        for (int i = 7; i >= 0; --i)
+            out[size++] = static_cast<std::uint8_t> (h.payloadSize >> (8 * i));
+    }
+
+    if (h.masked)
+    {
+        std::memcpy (out + size, h.mask.data(), 4);
+        size += 4;
+    }
+
+    return size;
+}
+
+int parseFrameHeader (const std::uint8_t* data, std::size_t size, FrameHeader& h) noexcept
+{
+    if (size < 2)
+        return 0;
+
+    if ((data[0] & 0x70) != 0)
+        return -1;
+
+    h.final = (data[0] & 0x80) != 0;
+    h.opcode = static_cast<Opcode> (data[0] & 0x0f);
+    h.masked = (data[1] & 0x80) != 0;
+
+    std::size_t used = 2;
+    const auto length = data[1] & 0x7f;
+
+    if (length < 126)
+    {
+        h.payloadSize = length;
+    }
+    else
+    {
+        const std::size_t bytes = length == 126 ? 2 : 8;
+
+        if (size < used + bytes)
+            return 0;
+
+        h.payloadSize = 0;
+
+        for (std::size_t i = 0; i < bytes; ++i)
+            h.payloadSize = h.payloadSize << 8 | data[used + i];
+
+        used += bytes;
+    }
+
+    // Control frames are short and never fragmented.
+    if ((h.opcode & 0x8) != 0 && (h.payloadSize > 125 || ! h.final))
+        return -1;
+
+    if (h.masked)
+    {
+        if (size < used + 4)
+            return 0;
+
+        std::memcpy (h.mask.data(), data + used, 4);
+        used += 4;
+    }
+
+    return static_cast<int> (used);
+}
+
+void applyMask (std::uint8_t* data, std::size_t size, const std::array<std::uint8_t, 4>& mask, std::size_t offset) noexcept
+{
+    for (std::size_t i = 0; i < size; ++i)
+        data[i] ^= mask[(offset + i) & 3];
+}
+
+std::string_view findHeader (std::string_view request, std::string_view name) noexcept
+{
+    while (! request.empty())
+    {
+        const auto end = request.find ("\r\n");
+        const auto line = request.substr (0, end);
+        request = end == std::string_view::npos ? std::string_view() : request.substr (end + 2);
+
+        const auto colon = line.find (':');
+
+        if (colon != std::string_view::npos && equalsIgnoringCase (trim (line.substr (0, colon)), name))
+            return trim (line.substr (colon + 1));
+    }
+
+    return {};
+}
+
+} // namespace dawinfo::websocket
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace dawinfo
+{
+
+/**
+    The parts of RFC 6455 both ends need: the opening handshake's accept key
+    and frame headers. No sockets here; see WebSocketServer.
+*/
+namespace websocket
+{
+    enum Opcode : std::uint8_t
+    {
+        continuation    = 0x0,
+        text            = 0x1,
+        binary          = 0x2,
+        close           = 0x8,
+        ping            = 0x9,
+        pong            = 0xa
+    };
+
+    /** Longest header: 2 bytes, 8 of length, 4 of mask. */
+    constexpr std::size_t maxHeaderSize = 14;
+
+    struct FrameHeader
+    {
+        bool final = true;
+        Opcode opcode = binary;
+        bool masked = false;
+        std::array<std::uint8_t, 4> mask {};
+        std::uint64_t payloadSize = 0;
+    };
+
+    std::array<std::uint8_t, 20> sha1 (const void* data, std::size_t size) noexcept;
+    std::string base64 (const std::uint8_t* data, std::size_t size);
+
+    /** Sec-WebSocket-Accept for a client's Sec-WebSocket-Key. */
+    std::string acceptKey (std::string_view clientKey);
+
+    /** Writes a header into out (maxHeaderSize bytes) and returns its size. */
+    std::size_t writeFrameHeader (std::uint8_t* out, const FrameHeader&) noexcept;
+
+    /** Returns the header's size, 0 if more bytes are needed, or -1 if it
+        isn't a valid header (reserved bits set, oversized control frame).
+    */
+    int parseFrameHeader (const std::uint8_t* data, std::size_t size, FrameHeader&) noexcept;
+
+    /** XORs a payload with its mask, in place. offset is the payload byte data[0] is at. */
+    void applyMask (std::uint8_t* data, std::size_t size, const std::array<std::uint8_t, 4>& mask, std::size_t offset = 0) noexcept;
+
+    /** The value of an HTTP header in a request, matched case-insensitively;
+        empty if it isn't there.
+    */
+    std::string_view findHeader (std::string_view request, std::string_view name) noexcept;
+}
+
+} // namespace dawinfo
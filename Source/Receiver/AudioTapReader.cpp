@@ -0,0 +1,140 @@
+#include "Receiver/AudioTapReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dawinfo
+{
+
+bool AudioTapReader::open (const std::string& name)
+{
+    close();
+
+    if (! memory.open (name) || memory.getSize() < sizeof (AudioTapHeader))
+    {
+        memory.close();
+        return false;
+    }
+
+    const auto* h = static_cast<const AudioTapHeader*> (memory.getData());
+
+    if (h->magic.load (std::memory_order_acquire) != AudioTapHeader::magicValue
+         || h->version != AudioTapHeader::currentVersion
+         || h->numChannels < 1 || h->numChannels > audiotap::maxChannels
+         || h->capacityFrames == 0 || (h->capacityFrames & (h->capacityFrames - 1)) != 0
+         || memory.getSize() < audiotap::regionSize (h->numChannels, h->capacityFrames))
+    {
+        memory.close();
+        return false;
+    }
+
+    header = h;
+    numChannels = h->numChannels;
+    capacity = h->capacityFrames;
+    readFrame = h->writeEnd.load (std::memory_order_acquire);
+    stats = {};
+    return true;
+}
+
+void AudioTapReader::close() noexcept
+{
+    header = nullptr;
+    memory.close();
+}
+
+std::uint64_t AudioTapReader::getAvailable() const noexcept
+{
+    return header != nullptr ? header->writeEnd.load (std::memory_order_acquire) - readFrame : 0;
+}
+
+void AudioTapReader::catchUp (std::uint64_t end) noexcept
+{
+    if (end - readFrame <= capacity)
+        return;
+
+    const auto resumeAt = end - capacity / 2;
+    stats.framesLost += resumeAt - readFrame;
+    ++stats.overruns;
+    readFrame = resumeAt;
+}
+
+AudioTapReader::View AudioTapReader::acquire (int maxFrames) noexcept
+{
+    View v;
+
+    if (header == nullptr || maxFrames <= 0)
+        return v;
+
+    const auto end = header->writeEnd.load (std::memory_order_acquire);
+    catchUp (end);
+
+    const auto available = end - readFrame;
+
+    // Short of a block the writer has started but not finished: ahead of it.
+    if (available < static_cast<std::uint64_t> (maxFrames) && header->writeStart.load (std::memory_order_relaxed) > end)
+        ++stats.underruns;
+
+    const auto offset = static_cast<std::uint32_t> (readFrame & (capacity - 1));
+    const auto wanted = std::min<std::uint64_t> (available, static_cast<std::uint64_t> (maxFrames));
+
+    v.firstFrame = readFrame;
+    v.numFrames = static_cast<std::uint32_t> (std::min<std::uint64_t> (wanted, capacity - offset));
+
+    for (std::uint32_t c = 0; c < numChannels; ++c)
+        v.channels[c] = audiotap::channelData (memory.getData(), capacity, c) + offset;
+
+    return v;
+}
+
+bool AudioTapReader::release (const View& v) noexcept
+{
+    if (header == nullptr || v.numFrames == 0 || v.firstFrame != readFrame)
+        return false;
+
+    // Seqlock check: has the writer started on anything we just used?
+    std::atomic_thread_fence (std::memory_order_acquire);
+    const auto writerReached = header->writeStart.load (std::memory_order_relaxed);
+
+    readFrame += v.numFrames;
+
+    if (writerReached - v.firstFrame > capacity)
+    {
+        stats.framesLost += v.numFrames;
+        ++stats.overruns;
+        return false;
+    }
+
+    stats.framesRead += v.numFrames;
+    return true;
+}
+
+int AudioTapReader::read (float* const* dest, int numDestChannels, int numFrames) noexcept
+{
+    int done = 0;
+    const auto underrunsBefore = stats.underruns;
+
+    while (done < numFrames)
+    {
+        const auto v = acquire (numFrames - done);
+
+        if (v.numFrames == 0)
+            break;
+
+        for (int c = 0; c < std::min (numDestChannels, static_cast<int> (numChannels)); ++c)
+            std::memcpy (dest[c] + done, v.getChannel (c), v.numFrames * sizeof (float));
+
+        if (! release (v))
+        {
+            // Torn: the frames copied so far are still good, this run isn't.
+            break;
+        }
+
+        done += static_cast<int> (v.numFrames);
+    }
+
+    // One short read is one underrun, however many runs it took.
+    stats.underruns = std::min (stats.underruns, underrunsBefore + 1);
+    return done;
+}
+
+} // namespace dawinfo
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Common/AudioTapLayout.h"
+#include "Common/SharedMemory.h"
+
+#include <string>
+
+namespace dawinfo
+{
+
+//==============================================================================
+/**
+    Reads the sender's AudioTap from another local process.
+
+    Reading starts at the newest frame. Either copy frames out with read(),
+    or work on them in place: acquire() returns pointers straight into the
+    shared rings and release() says whether the writer left them alone
+    meanwhile. Results computed from a view that fails release() must be
+    thrown away.
+
+    A reader that falls more than the ring's capacity behind has lost data:
+    the next read counts an overrun and jumps to half a ring behind the
+    writer. Asking for more frames than have been written just returns what
+    there is, but a reader that reaches past writeEnd while the writer is
+    still copying those frames in has caught up with the writer: that read
+    counts an underrun, and a reader that sees them often should read
+    further behind.
+
+    Single threaded.
+*/
+class AudioTapReader
+{
+public:
+    struct Stats
+    {
+        std::uint64_t framesRead = 0;
+        std::uint64_t framesLost = 0;
+        std::uint64_t overruns = 0;
+        std::uint64_t underruns = 0;        // reads that reached a block still being written
+    };
+
+    /** A contiguous run of frames in the shared rings. */
+    struct View
+    {
+        std::uint64_t firstFrame = 0;
+        std::uint32_t numFrames = 0;
+
+        const float* getChannel (int channel) const noexcept     { return channels[channel]; }
+
+    private:
+        friend class AudioTapReader;
+        const float* channels[audiotap::maxChannels] {};
+    };
+
+    /** Returns false if the tap doesn't exist, isn't ready or has another layout version. */
+    bool open (const std::string& name);
+    void close() noexcept;
+
+    bool isOpen() const noexcept                { return header != nullptr; }
+    int getNumChannels() const noexcept         { return static_cast<int> (numChannels); }
+    std::uint32_t getCapacity() const noexcept  { return capacity; }
+    double getSampleRate() const noexcept       { return header != nullptr ? header->sampleRate : 0.0; }
+
+    /** Frames written but not yet read. */
+    std::uint64_t getAvailable() const noexcept;
+
+    /** Copies up to numFrames frames into dest (numChannels pointers; extra
+        tap channels are skipped). Returns the frames copied.
+    */
+    int read (float* const* dest, int numChannels, int numFrames) noexcept;
+
+    /** Zero-copy access to up to maxFrames frames. May return fewer than are
+        available when the run reaches the end of the ring; call again for the rest.
+    */
+    View acquire (int maxFrames) noexcept;
+
+    /** Consumes a view. Returns false, and counts an overrun, if the writer
+        may have overwritten it while it was in use.
+    */
+    bool release (const View&) noexcept;
+
+    Stats getStats() const noexcept             { return stats; }
+
+private:
+    void catchUp (std::uint64_t end) noexcept;
+
+    SharedMemory memory;
+    const AudioTapHeader* header = nullptr;
+    std::uint32_t numChannels = 0, capacity = 0;
+    std::uint64_t readFrame = 0;
+    Stats stats;
+};
+
+} // namespace dawinfo
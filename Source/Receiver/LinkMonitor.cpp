@@ -0,0 +1,88 @@
+#include "Receiver/LinkMonitor.h"
+
+namespace dawinfo
+{
+
+LinkMonitor::Window::Result LinkMonitor::observe (StreamId id, std::uint32_t seq) noexcept
+{
+    auto& s = streams[static_cast<std::size_t> (id)];
+    std::uint32_t skipped = 0;
+    const auto result = s.window.accept (seq, &skipped);
+
+    ++s.stats.received;
+
+    switch (result)
+    {
+        case Window::Result::first:
+            if (s.stats.received > 1)
+                ++s.stats.resyncs;
+            break;
+
+        case Window::Result::inOrder:
+            break;
+
+        case Window::Result::gap:
+            s.stats.lost += skipped;
+            break;
+
+        case Window::Result::late:
+            ++s.stats.late;
+            if (s.stats.lost > 0)
+                --s.stats.lost;
+            break;
+
+        case Window::Result::duplicate:
+            ++s.stats.duplicates;
+            break;
+
+        case Window::Result::tooOld:
+            ++s.stats.tooOld;
+            break;
+    }
+
+    return result;
+}
+
+bool LinkMonitor::observePacket (const std::uint8_t* data, std::size_t size) noexcept
+{
+    bool found = false;
+    StreamId stream {};
+    std::uint32_t seq = 0;
+
+    // The sequence message is always the first element of the bundle.
+    forEachOscMessage (data, size, [&] (const OscMessage& m)
+    {
+        if (! found)
+            found = decodeSequence (m, stream, seq);
+    });
+
+    if (found)
+        observe (stream, seq);
+
+    return found;
+}
+
+LinkStats LinkMonitor::getTotals() const noexcept
+{
+    LinkStats t;
+
+    for (auto& s : streams)
+    {
+        t.received   += s.stats.received;
+        t.lost       += s.stats.lost;
+        t.late       += s.stats.late;
+        t.duplicates += s.stats.duplicates;
+        t.tooOld     += s.stats.tooOld;
+        t.resyncs    += s.stats.resyncs;
+    }
+
+    return t;
+}
+
+void LinkMonitor::reset() noexcept
+{
+    for (auto& s : streams)
+        s = {};
+}
+
+} // namespace dawinfo
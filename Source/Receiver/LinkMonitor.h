@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Common/Protocol.h"
+#include "Common/SequenceWindow.h"
+
+#include <array>
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/** Gap and reordering counters for one packet stream. */
+struct LinkStats
+{
+    std::uint64_t received = 0;
+    std::uint64_t lost = 0;         // numbers skipped and not (yet) filled in
+    std::uint64_t late = 0;         // arrived after a higher number
+    std::uint64_t duplicates = 0;
+    std::uint64_t tooOld = 0;
+    std::uint64_t resyncs = 0;
+
+    double lossRatio() const noexcept
+    {
+        const auto expected = received - duplicates - tooOld + lost;
+        return expected > 0 ? static_cast<double> (lost) / static_cast<double> (expected) : 0.0;
+    }
+};
+
+//==============================================================================
+/**
+    Tracks the sequence numbers of every stream a receiver hears and counts
+    gaps, late arrivals and duplicates. A late packet fills the gap it left,
+    so after reordering settles `lost` is the true number of missing packets.
+*/
+class LinkMonitor
+{
+public:
+    using Window = SequenceWindow<128>;
+
+    /** Records a packet's sequence number and returns how it was classified. */
+    Window::Result observe (StreamId, std::uint32_t seq) noexcept;
+
+    /** Reads the sequence message that starts a packet and records it.
+        Returns false if the packet has no valid sequence header.
+    */
+    bool observePacket (const std::uint8_t* data, std::size_t size) noexcept;
+
+    const LinkStats& getStats (StreamId s) const noexcept { return streams[static_cast<std::size_t> (s)].stats; }
+    LinkStats getTotals() const noexcept;
+
+    void reset() noexcept;
+
+private:
+    struct Stream
+    {
+        Window window;
+        LinkStats stats;
+    };
+
+    std::array<Stream, numStreams> streams {};
+};
+
+//==============================================================================
+/**
+    Drops repeated copies of discrete events sent with EventRedundancy.
+    Event ids increase by one per event, so a sliding window suffices; it must
+    cover the events that fit in (redundancy + 1) packets.
+*/
+class EventDeduplicator
+{
+public:
+    /** Returns true the first time an id is seen. */
+    bool accept (std::uint32_t id) noexcept
+    {
+        const auto r = window.accept (id);
+        const bool isNew = r != Window::Result::duplicate && r != Window::Result::tooOld;
+        (isNew ? accepted : dropped)++;
+        return isNew;
+    }
+
+    std::uint64_t getAccepted() const noexcept  { return accepted; }
+    std::uint64_t getDropped() const noexcept   { return dropped; }
+
+    void reset() noexcept { window.reset(); accepted = dropped = 0; }
+
+private:
+    using Window = SequenceWindow<1024>;
+    Window window;
+    std::uint64_t accepted = 0, dropped = 0;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,89 @@
+#include "Receiver/MetadataMirror.h"
+
+namespace dawinfo
+{
+
+bool MetadataMirror::handlePacket (const std::uint8_t* data, std::size_t size)
+{
+    bool accepted = false, rejected = false;
+
+    const bool wellFormed = forEachOscMessage (data, size, [&] (const OscMessage& m)
+    {
+        if (rejected)
+            return;
+
+        if (! accepted)
+        {
+            metadata::Header h;
+
+            if (! metadata::decodeHeader (m, h))
+                return;     // the sequence message, or junk before the header
+
+            const auto result = updates.acceptPart ({ h.baseVersion, h.version, h.part, h.numParts, h.isFullSync });
+
+            if (result == UpdateAssembler::Result::ignored)
+            {
+                rejected = true;
+                return;
+            }
+
+            if (result == UpdateAssembler::Result::started && h.isFullSync)
+            {
+                tracks.clear();
+                order.clear();
+            }
+
+            accepted = true;
+            return;
+        }
+
+        TrackInfo t;
+        std::uint32_t id = 0;
+        std::size_t offset = 0, total = 0, numIds = 0;
+        const std::uint8_t* ids = nullptr;
+
+        if (metadata::decodeTrack (m, t))
+        {
+            tracks[t.id] = std::move (t);
+        }
+        else if (metadata::decodeRemoved (m, id))
+        {
+            tracks.erase (id);
+        }
+        else if (metadata::decodeOrderChunk (m, offset, total, ids, numIds))
+        {
+            order.resize (total);
+
+            for (std::size_t i = 0; i < numIds; ++i)
+                order[offset + i] = readBigEndian32 (ids + i * 4);
+        }
+    });
+
+    if (! accepted)
+        return false;
+
+    if (updates.partDone())
+        updates.complete();
+
+    return wellFormed;
+}
+
+std::vector<TrackInfo> MetadataMirror::getTracks() const
+{
+    std::vector<TrackInfo> result;
+    result.reserve (order.size());
+
+    for (auto id : order)
+        if (auto* t = findTrack (id))
+            result.push_back (*t);
+
+    return result;
+}
+
+const TrackInfo* MetadataMirror::findTrack (std::uint32_t id) const
+{
+    auto found = tracks.find (id);
+    return found != tracks.end() ? &found->second : nullptr;
+}
+
+} // namespace dawinfo
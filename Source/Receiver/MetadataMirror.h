@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Common/Metadata.h"
+#include "Receiver/UpdateAssembler.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace dawinfo
+{
+
+/**
+    Receiver-side copy of the sender's MetadataCache.
+
+    Deltas are applied as their packets arrive; the mirror's version moves on
+    once every part of an update has been seen. A delta whose base version
+    isn't the mirror's own means an update was missed, so the mirror stops
+    applying deltas and reports needsFullSync() until a full sync arrives.
+    The same goes for a full sync that a newer update overtakes before all
+    its parts arrive. Ask the sender for one when that happens.
+*/
+class MetadataMirror
+{
+public:
+    /** Handles one packet from the metadata stream. Returns false if it was
+        malformed or ignored.
+    */
+    bool handlePacket (const std::uint8_t* data, std::size_t size);
+
+    bool needsFullSync() const noexcept          { return updates.needsFullSync(); }
+    std::uint32_t getVersion() const noexcept    { return updates.getVersion(); }
+
+    /** Tracks in display order. */
+    std::vector<TrackInfo> getTracks() const;
+    const TrackInfo* findTrack (std::uint32_t id) const;
+
+private:
+    std::unordered_map<std::uint32_t, TrackInfo> tracks;
+    std::vector<std::uint32_t> order;
+    UpdateAssembler updates;
+};
+
+} // namespace dawinfo
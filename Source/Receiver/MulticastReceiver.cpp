@@ -0,0 +1,50 @@
+#include "Receiver/MulticastReceiver.h"
+
+namespace dawinfo
+{
+
+bool MulticastReceiver::join (const std::string& groupName, int port, const std::string& interfaceName, std::string& error)
+{
+    leave();
+
+    Endpoint target, local;
+
+    if (! resolveEndpoint (groupName, port, target) || ! target.isMulticast())
+    {
+        error = "'" + groupName + "' is not a multicast group";
+        return false;
+    }
+
+    if (! interfaceName.empty() && ! resolveEndpoint (interfaceName, 1, local))
+    {
+        error = "bad interface address '" + interfaceName + "'";
+        return false;
+    }
+
+    if (! socket.open (port, false, true))
+    {
+        error = "couldn't bind port " + std::to_string (port);
+        return false;
+    }
+
+    if (! socket.joinGroup (target.address, local.address))
+    {
+        socket.close();
+        error = "couldn't join " + groupName;
+        return false;
+    }
+
+    group = target.address;
+    interface = local.address;
+    return true;
+}
+
+void MulticastReceiver::leave() noexcept
+{
+    if (socket.isOpen())
+        socket.leaveGroup (group, interface);
+
+    socket.close();
+}
+
+} // namespace dawinfo
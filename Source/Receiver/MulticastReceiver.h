@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Common/UdpSocket.h"
+
+#include <string>
+
+namespace dawinfo
+{
+
+//==============================================================================
+/**
+    Joins a sender's multicast group and receives its packets.
+
+    Several receivers on one host can join the same group and port; each gets
+    its own copy of every packet. Pass the received bytes on as usual, e.g.
+    to a LinkMonitor or TransportClock.
+*/
+class MulticastReceiver
+{
+public:
+    MulticastReceiver() = default;
+    ~MulticastReceiver()    { leave(); }
+
+    /** Binds the group's port and joins the group on the interface (empty
+        for the default one).
+    */
+    bool join (const std::string& group, int port, const std::string& interface, std::string& error);
+
+    void leave() noexcept;
+
+    bool isJoined() const noexcept          { return socket.isOpen(); }
+
+    /** Waits up to timeoutMs for a packet; see UdpSocket::receive(). */
+    long receive (std::uint8_t* buffer, std::size_t capacity, Endpoint& from, int timeoutMs) noexcept
+    {
+        return socket.receive (buffer, capacity, from, timeoutMs);
+    }
+
+private:
+    UdpSocket socket;
+    std::uint32_t group = 0, interface = 0;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,71 @@
+#include "Receiver/ParameterMirror.h"
+#include "Common/Messages.h"
+
+#include <algorithm>
+
+namespace dawinfo
+{
+
+ParameterMirror::ParameterMirror (std::size_t segmentsPerParameter)
+    : maxSegments (std::max<std::size_t> (segmentsPerParameter, 1))
+{
+}
+
+bool ParameterMirror::handlePacket (const std::uint8_t* data, std::size_t size)
+{
+    return forEachOscMessage (data, size, [this] (const OscMessage& m)
+    {
+        ParameterSegment s;
+
+        if (schema::Codec<messages::Parameter>::decode (m, s))
+            addSegment (s);
+    });
+}
+
+void ParameterMirror::addSegment (const ParameterSegment& s)
+{
+    auto& lane = lanes[s.paramId];
+
+    // Segments normally arrive in order; a reordered one slots into place.
+    auto pos = lane.end();
+
+    while (pos != lane.begin() && std::prev (pos)->startNs > s.startNs)
+        --pos;
+
+    lane.insert (pos, s);
+
+    if (lane.size() > maxSegments)
+        lane.pop_front();
+}
+
+bool ParameterMirror::hasParameter (std::int32_t paramId) const
+{
+    return lanes.count (paramId) > 0;
+}
+
+float ParameterMirror::valueAt (std::int32_t paramId, HostTimeNs timeNs) const
+{
+    const auto it = lanes.find (paramId);
+
+    if (it == lanes.end() || it->second.empty())
+        return 0.0f;
+
+    const auto& lane = it->second;
+
+    // The last segment starting at or before the time.
+    auto next = std::upper_bound (lane.begin(), lane.end(), timeNs,
+                                  [] (HostTimeNs t, const ParameterSegment& s) { return t < s.startNs; });
+
+    if (next == lane.begin())
+        return lane.front().startValue;
+
+    return std::prev (next)->valueAt (timeNs);
+}
+
+float ParameterMirror::latestValue (std::int32_t paramId) const
+{
+    const auto it = lanes.find (paramId);
+    return it == lanes.end() || it->second.empty() ? 0.0f : it->second.back().endValue;
+}
+
+} // namespace dawinfo
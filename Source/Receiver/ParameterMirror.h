@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Common/Parameters.h"
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+namespace dawinfo
+{
+
+/**
+    Receiver-side reconstruction of the sender's parameter automation.
+
+    Keeps the most recent segments of each parameter and answers valueAt()
+    by interpolating the segment covering the requested time. Before the
+    first segment the curve starts at its first value; after the last one,
+    and across any gap left by a lost packet, it holds the last value.
+
+    Not thread safe; feed and query from the same thread.
+*/
+class ParameterMirror
+{
+public:
+    explicit ParameterMirror (std::size_t segmentsPerParameter = 64);
+
+    /** Handles one packet from the parameters stream. Returns false if it was malformed. */
+    bool handlePacket (const std::uint8_t* data, std::size_t size);
+
+    void addSegment (const ParameterSegment&);
+
+    bool hasParameter (std::int32_t paramId) const;
+
+    /** The parameter's value at the given sender time, or 0 if it has never been seen. */
+    float valueAt (std::int32_t paramId, HostTimeNs timeNs) const;
+
+    /** The most recent value received. */
+    float latestValue (std::int32_t paramId) const;
+
+private:
+    const std::size_t maxSegments;
+    std::unordered_map<std::int32_t, std::deque<ParameterSegment>> lanes;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,86 @@
+#include "Receiver/TempoMapMirror.h"
+#include "Common/Messages.h"
+
+#include <algorithm>
+
+namespace dawinfo
+{
+
+void TempoMapMirror::startUpdate (const TempoMapHeader& h)
+{
+    const auto keep = static_cast<std::size_t> (h.replaceFrom);
+    update = h;
+
+    pending.segments.assign (map.segments.begin(), map.segments.begin() + static_cast<std::ptrdiff_t> (keep));
+    pending.segments.resize (static_cast<std::size_t> (h.numSegments));
+    pending.isLooping = h.isLooping;
+    pending.loopStartPpq = h.loopStartPpq;
+    pending.loopEndPpq = h.loopEndPpq;
+}
+
+bool TempoMapMirror::handlePacket (const std::uint8_t* data, std::size_t size)
+{
+    bool accepted = false, rejected = false;
+    std::size_t next = 0;
+
+    const bool wellFormed = forEachOscMessage (data, size, [&] (const OscMessage& m)
+    {
+        if (rejected)
+            return;
+
+        if (! accepted)
+        {
+            TempoMapHeader h;
+
+            if (! schema::Codec<messages::TempoHeader>::decode (m, h))
+                return;     // the sequence message, or junk before the header
+
+            const bool sameUpdate = update.replaceFrom == h.replaceFrom && update.numSegments == h.numSegments;
+            const bool canStart = static_cast<std::size_t> (h.replaceFrom) <= map.segments.size();
+            const auto result = updates.acceptPart ({ h.baseVersion, h.version, h.part, h.numParts, h.replaceFrom == 0 },
+                                                    sameUpdate, canStart);
+
+            if (result == UpdateAssembler::Result::ignored)
+            {
+                rejected = true;
+                return;
+            }
+
+            if (result == UpdateAssembler::Result::started)
+                startUpdate (h);
+
+            next = static_cast<std::size_t> (h.firstSegment);
+            accepted = true;
+            return;
+        }
+
+        TempoSegment s;
+
+        if (schema::Codec<messages::TempoSegment>::decode (m, s) && next < pending.segments.size())
+            pending.segments[next++] = s;
+    });
+
+    if (! accepted)
+        return false;
+
+    if (updates.partDone())
+    {
+        // TempoMap searches by startPpq; a map out of order is corrupt.
+        if (! std::is_sorted (pending.segments.begin(), pending.segments.end(),
+                              [] (const TempoSegment& a, const TempoSegment& b) { return a.startPpq < b.startPpq; }))
+        {
+            updates.abandon();
+            return false;
+        }
+
+        map.segments.swap (pending.segments);
+        map.isLooping = pending.isLooping;
+        map.loopStartPpq = pending.loopStartPpq;
+        map.loopEndPpq = pending.loopEndPpq;
+        updates.complete();
+    }
+
+    return wellFormed;
+}
+
+} // namespace dawinfo
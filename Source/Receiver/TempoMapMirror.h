@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Common/TempoMap.h"
+#include "Receiver/UpdateAssembler.h"
+
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/**
+    Receiver-side copy of the sender's tempo map, from StreamId::tempo.
+
+    An update keeps the segments before its replaceFrom and replaces the
+    rest; it takes effect once every part has arrived, so getMap() never
+    shows half an update. An update based on a version the mirror doesn't
+    have means one was missed: the mirror stops applying updates and reports
+    needsFullSync() until one that replaces the whole map arrives. So does
+    a whole map that a newer update overtakes before all its parts arrive.
+    Ask the sender for one when that happens.
+
+    Not thread safe; feed and query from the same thread.
+*/
+class TempoMapMirror
+{
+public:
+    /** Handles one packet from the tempo stream. Returns false if it was
+        malformed or ignored.
+    */
+    bool handlePacket (const std::uint8_t* data, std::size_t size);
+
+    bool needsFullSync() const noexcept          { return updates.needsFullSync(); }
+    std::uint32_t getVersion() const noexcept    { return updates.getVersion(); }
+
+    /** The map as of the last complete update. Empty until one arrives. */
+    const TempoMap& getMap() const noexcept      { return map; }
+
+private:
+    void startUpdate (const TempoMapHeader&);
+
+    TempoMap map;
+    UpdateAssembler updates;
+
+    // The update currently being received.
+    TempoMapHeader update;
+    TempoMap pending;
+};
+
+} // namespace dawinfo
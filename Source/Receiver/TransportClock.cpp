@@ -0,0 +1,150 @@
+#include "Receiver/TransportClock.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dawinfo
+{
+
+namespace
+{
+    double beatsPerNsForTempo (double bpm) noexcept
+    {
+        return bpm > 0.0 ? bpm / 60.0e9 : 0.0;
+    }
+}
+
+TransportClock::TransportClock() : TransportClock (Options()) {}
+
+TransportClock::TransportClock (const Options& o) : options (o) {}
+
+void TransportClock::reset() noexcept
+{
+    stats = {};
+    last = {};
+    valid = false;
+    anchorTimeNs = slewEndNs = 0;
+    anchorPpq = 0.0;
+    nominalBeatsPerNs = beatsPerNs = 0.0;
+}
+
+bool TransportClock::update (const TransportSnapshot& s) noexcept
+{
+    if (valid && s.timeNs <= anchorTimeNs)
+    {
+        ++stats.staleDropped;
+        return false;
+    }
+
+    ++stats.updates;
+
+    if (! valid || ! s.isPlaying || ! last.isPlaying)
+    {
+        snapTo (s);
+        return true;
+    }
+
+    // Loop settings are taken from the new snapshot before predicting, so a
+    // wrap the sender already performed is not mistaken for a seek.
+    last.isLooping = s.isLooping;
+    last.loopStartPpq = s.loopStartPpq;
+    last.loopEndPpq = s.loopEndPpq;
+
+    const double predicted = ppqAt (s.timeNs);
+    double error = s.ppq - predicted;
+
+    const double loopLength = s.loopEndPpq - s.loopStartPpq;
+    if (s.isLooping && loopLength > 0.0 && std::abs (error) > loopLength * 0.5)
+        error -= std::copysign (loopLength, error);
+
+    stats.lastErrorBeats = error;
+
+    if (std::abs (error) > options.snapThresholdBeats)
+    {
+        snapTo (s);
+        return true;
+    }
+
+    // Continue from where the prediction says we are and bend the rate so the
+    // error is gone after the slew window.
+    anchorTimeNs = s.timeNs;
+    anchorPpq = predicted;
+    nominalBeatsPerNs = beatsPerNsForTempo (s.bpm);
+
+    const double slewBeats = nominalBeatsPerNs * options.slewTimeSeconds * 1.0e9;
+    const double correction = slewBeats > 0.0
+        ? std::clamp (error / slewBeats, -options.maxRateDeviation, options.maxRateDeviation)
+        : 0.0;
+
+    beatsPerNs = nominalBeatsPerNs * (1.0 + correction);
+    slewEndNs = s.timeNs + static_cast<HostTimeNs> (options.slewTimeSeconds * 1.0e9);
+    last = s;
+    return false;
+}
+
+void TransportClock::snapTo (const TransportSnapshot& s) noexcept
+{
+    ++stats.snaps;
+    last = s;
+    valid = true;
+    anchorTimeNs = slewEndNs = s.timeNs;
+    anchorPpq = s.ppq;
+    nominalBeatsPerNs = beatsPerNs = beatsPerNsForTempo (s.bpm);
+}
+
+double TransportClock::unwrappedPpqAt (HostTimeNs t) const noexcept
+{
+    if (! last.isPlaying)
+        return anchorPpq;
+
+    if (t <= slewEndNs)
+        return anchorPpq + static_cast<double> (t - anchorTimeNs) * beatsPerNs;
+
+    return anchorPpq + static_cast<double> (slewEndNs - anchorTimeNs) * beatsPerNs
+                     + static_cast<double> (t - slewEndNs) * nominalBeatsPerNs;
+}
+
+double TransportClock::wrapToLoop (double ppq) const noexcept
+{
+    const double loopLength = last.loopEndPpq - last.loopStartPpq;
+
+    if (! last.isLooping || loopLength <= 0.0 || ppq < last.loopEndPpq)
+        return ppq;
+
+    return last.loopStartPpq + std::fmod (ppq - last.loopStartPpq, loopLength);
+}
+
+double TransportClock::ppqAt (HostTimeNs t) const noexcept
+{
+    if (! valid)
+        return 0.0;
+
+    return wrapToLoop (unwrappedPpqAt (t));
+}
+
+TransportPosition TransportClock::positionAt (HostTimeNs t) const noexcept
+{
+    TransportPosition p;
+    p.ppq = ppqAt (t);
+    p.bpm = last.bpm;
+    p.isPlaying = valid && last.isPlaying;
+
+    const double barLength = last.quarterNotesPerBar();
+    const double beatLength = last.timeSigDenominator > 0 ? 4.0 / last.timeSigDenominator : 1.0;
+
+    const double barsSinceAnchor = std::floor ((p.ppq - last.barStartPpq) / barLength);
+    const double inBar = p.ppq - last.barStartPpq - barsSinceAnchor * barLength;
+    const double beats = inBar / beatLength;
+
+    p.bar = last.barNumber + static_cast<std::int32_t> (barsSinceAnchor);
+    p.beat = static_cast<std::int32_t> (std::floor (beats));
+    p.beatFraction = beats - std::floor (beats);
+    return p;
+}
+
+double TransportClock::getRateCorrection() const noexcept
+{
+    return nominalBeatsPerNs > 0.0 ? beatsPerNs / nominalBeatsPerNs - 1.0 : 0.0;
+}
+
+} // namespace dawinfo
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Common/Transport.h"
+
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/** Musical position as seen by a receiver at a given instant. */
+struct TransportPosition
+{
+    double ppq = 0.0;
+    double bpm = 120.0;
+    std::int32_t bar = 0;           // zero-based
+    std::int32_t beat = 0;          // zero-based, in time-signature beats
+    double beatFraction = 0.0;      // [0, 1)
+    bool isPlaying = false;
+};
+
+//==============================================================================
+/**
+    Receiver-side model of the sender's transport.
+
+    Snapshots arrive at block rate with network jitter and the occasional
+    loss, while visuals want a position every frame. The clock extrapolates
+    from the last snapshot using its tempo, and when a new snapshot disagrees
+    with the prediction it bends the playback rate so the error is absorbed
+    over a short slew window instead of showing up as a jump. Once the window
+    has passed the clock runs at the nominal tempo again, so a long gap
+    between snapshots does not keep the correction going. Large errors
+    (seeks, loop wraps, play/stop) snap straight to the new position.
+
+    Snapshot times must already be in the receiver's time base, typically the
+    local arrival time. Not thread safe; feed and query from the same thread.
+*/
+class TransportClock
+{
+public:
+    struct Options
+    {
+        double slewTimeSeconds = 0.25;      // time over which a small error is absorbed
+        double maxRateDeviation = 0.05;     // cap on the rate correction, as a ratio
+        double snapThresholdBeats = 0.25;   // errors larger than this snap
+    };
+
+    struct Stats
+    {
+        std::uint64_t updates = 0;
+        std::uint64_t snaps = 0;
+        std::uint64_t staleDropped = 0;
+        double lastErrorBeats = 0.0;
+    };
+
+    TransportClock();
+    explicit TransportClock (const Options&);
+
+    void reset() noexcept;
+
+    /** Feeds a new snapshot. Returns true if the clock snapped to it. */
+    bool update (const TransportSnapshot&) noexcept;
+
+    /** Returns the extrapolated ppq at the given time, wrapped into the loop. */
+    double ppqAt (HostTimeNs) const noexcept;
+
+    /** Returns the extrapolated position including bar and beat. */
+    TransportPosition positionAt (HostTimeNs) const noexcept;
+
+    bool hasSnapshot() const noexcept         { return valid; }
+    double getRateCorrection() const noexcept;
+    const Stats& getStats() const noexcept    { return stats; }
+
+private:
+    double unwrappedPpqAt (HostTimeNs) const noexcept;
+    double wrapToLoop (double ppq) const noexcept;
+    void snapTo (const TransportSnapshot&) noexcept;
+
+    Options options;
+    Stats stats;
+    TransportSnapshot last;
+    bool valid = false;
+
+    HostTimeNs anchorTimeNs = 0;
+    double anchorPpq = 0.0;
+    double nominalBeatsPerNs = 0.0;
+    double beatsPerNs = 0.0;           // applies up to slewEndNs, nominal after
+    HostTimeNs slewEndNs = 0;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,61 @@
+#include "Receiver/UpdateAssembler.h"
+
+namespace dawinfo
+{
+
+UpdateAssembler::Result UpdateAssembler::acceptPart (const Part& p, bool sameUpdate, bool canStart)
+{
+    const bool continuesUpdate = inUpdate && sameUpdate && updateVersion == p.version && updateIsFull == p.isFullSync
+                                  && partsSeen.size() == static_cast<std::size_t> (p.numParts);
+    auto result = Result::continued;
+
+    if (! continuesUpdate)
+    {
+        const bool applies = p.isFullSync || (! syncNeeded && ! inUpdate && p.baseVersion == version);
+
+        if (! applies || ! canStart)
+        {
+            // Based on a version we never completed: an update was lost. A
+            // newer update while a full sync is still open means one of its
+            // parts was; that sync is abandoned.
+            if (! (inUpdate && updateIsFull))
+                syncNeeded = true;
+            else if (static_cast<std::int32_t> (p.version - updateVersion) > 0)
+                abandon();
+
+            return Result::ignored;
+        }
+
+        inUpdate = true;
+        updateVersion = p.version;
+        updateIsFull = p.isFullSync;
+        partsSeen.assign (static_cast<std::size_t> (p.numParts), false);
+        partsLeft = p.numParts;
+        result = Result::started;
+    }
+
+    const auto part = static_cast<std::size_t> (p.part);
+
+    if (partsSeen[part])
+        return Result::ignored;
+
+    partsSeen[part] = true;
+    return result;
+}
+
+void UpdateAssembler::complete() noexcept
+{
+    version = updateVersion;
+    inUpdate = false;
+
+    if (updateIsFull)
+        syncNeeded = false;
+}
+
+void UpdateAssembler::abandon() noexcept
+{
+    inUpdate = false;
+    syncNeeded = true;
+}
+
+} // namespace dawinfo
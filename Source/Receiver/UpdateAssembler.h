@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace dawinfo
+{
+
+/**
+    Tracks which parts of a versioned multi-part update have arrived, for
+    mirrors of state the sender sends as versioned updates split across
+    packets (MetadataMirror, TempoMapMirror).
+
+    An update either replaces the whole state (a full sync) or applies to
+    the version before it. A partial update based on a version the mirror
+    doesn't have means one was missed, so no more are accepted and
+    needsFullSync() stays set until a full sync completes. So does a full
+    sync that a newer update overtakes before all its parts arrive, since
+    waiting for it would never end.
+
+    The mirror decodes each packet's header into a Part, calls acceptPart(),
+    applies the packet's contents if it was accepted, then partDone(), and
+    once that returns true checks the result and calls complete() or
+    abandon().
+*/
+class UpdateAssembler
+{
+public:
+    struct Part
+    {
+        std::uint32_t baseVersion = 0;
+        std::uint32_t version = 0;
+        std::int32_t part = 0;          // 0 <= part < numParts
+        std::int32_t numParts = 1;
+        bool isFullSync = false;
+    };
+
+    enum class Result
+    {
+        ignored,        // lost, stale or repeated; don't apply it
+        started,        // the first part of a new update; reset, then apply it
+        continued       // another part of the open update; apply it
+    };
+
+    /** sameUpdate says whatever the mirror's own header adds matches the open
+        update; canStart is false if the mirror can't apply this one at all.
+    */
+    Result acceptPart (const Part&, bool sameUpdate = true, bool canStart = true);
+
+    /** After applying an accepted part: true once every part has been. */
+    bool partDone() noexcept                    { return --partsLeft == 0; }
+
+    /** The update is whole: the version moves on, and a full sync ends needsFullSync(). */
+    void complete() noexcept;
+
+    /** Drops the open update as unusable and waits for a full sync. */
+    void abandon() noexcept;
+
+    bool needsFullSync() const noexcept          { return syncNeeded; }
+    std::uint32_t getVersion() const noexcept    { return version; }
+
+private:
+    std::uint32_t version = 0;
+    bool syncNeeded = false;
+
+    // The update currently being received.
+    bool inUpdate = false;
+    std::uint32_t updateVersion = 0;
+    bool updateIsFull = false;
+    std::vector<bool> partsSeen;
+    std::int32_t partsLeft = 0;
+};
+
+} // namespace dawinfo
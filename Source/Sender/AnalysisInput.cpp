@@ -0,0 +1,108 @@
+#include "Sender/AnalysisInput.h"
+#include "Sender/MemoryBudget.h"
+
+#include <algorithm>
+
+namespace dawinfo
+{
+
+namespace
+{
+    void allocate (std::vector<std::vector<float>>& buffers, std::vector<float*>& writers, int numChannels, int numFrames)
+    {
+        buffers.assign (static_cast<std::size_t> (numChannels), std::vector<float> (static_cast<std::size_t> (numFrames)));
+        writers.clear();
+
+        for (auto& b : buffers)
+            writers.push_back (b.data());
+    }
+}
+
+bool AnalysisInput::prepare (double hostRate, int numHostChannels, ChannelLayout layout, int maxBlockSize)
+{
+    const int numOutputs = std::clamp (options.numOutputs, 1, 2);
+    numHostChannels = std::clamp (numHostChannels, 1, DownmixMatrix::maxInputs);
+    maxBlockSize = std::max (maxBlockSize, 1);
+
+    // Nothing changes until the resampler accepts the rate, so a failed
+    // prepare leaves the matrix and buffers matching each other.
+    const auto matrix = DownmixMatrix::create (layout, numHostChannels, numOutputs);
+
+    if (! resampler.prepare (hostRate, options.analysisRate, numOutputs, maxBlockSize, options.tapsPerPhase))
+        return false;
+
+    downmix = matrix;
+    maxBlock = maxBlockSize;
+    resampling = resampler.getUpFactor() != resampler.getDownFactor();
+
+    allocate (planar, planarWriters, numHostChannels, maxBlock);
+    allocate (mixed, mixedWriters, numOutputs, maxBlock);
+    allocate (resampled, resampledWriters, numOutputs, resampling ? resampler.getMaxOutputFrames() : 0);
+    planarPointers.assign (planarWriters.begin(), planarWriters.end());
+    outputPointers.assign (static_cast<std::size_t> (numOutputs), nullptr);
+    return true;
+}
+
+//==============================================================================
+AnalysisInput::Block AnalysisInput::process (const float* const* channels, int numChannels, int numFrames) noexcept
+{
+    const int available = std::min (numChannels, downmix.numInputs);
+
+    // Missing host channels read as silence.
+    for (int c = 0; c < downmix.numInputs; ++c)
+        planarPointers[static_cast<std::size_t> (c)] = c < available ? channels[c] : nullptr;
+
+    return convert (planarPointers.data(), numFrames);
+}
+
+AnalysisInput::Block AnalysisInput::processInterleaved (const float* frames, int numChannels, int numFrames) noexcept
+{
+    if (numChannels != downmix.numInputs)
+        return {};
+
+    numFrames = std::min (numFrames, maxBlock);
+    kernels::deinterleave (frames, numChannels, numFrames, planarWriters.data());
+    planarPointers.assign (planarWriters.begin(), planarWriters.end());
+    return convert (planarPointers.data(), numFrames);
+}
+
+AnalysisInput::Block AnalysisInput::processInterleaved (const std::int16_t* frames, int numChannels, int numFrames) noexcept
+{
+    if (numChannels != downmix.numInputs)
+        return {};
+
+    numFrames = std::min (numFrames, maxBlock);
+    kernels::deinterleave (frames, numChannels, numFrames, planarWriters.data());
+    planarPointers.assign (planarWriters.begin(), planarWriters.end());
+    return convert (planarPointers.data(), numFrames);
+}
+
+AnalysisInput::Block AnalysisInput::convert (const float* const* channels, int numFrames) noexcept
+{
+    const int numOutputs = downmix.numOutputs;
+    const int consumed = std::clamp (numFrames, 0, maxBlock);
+    kernels::downmix (channels, consumed, downmix, mixedWriters.data());
+
+    numFrames = resampling ? resampler.process (mixedWriters.data(), consumed, resampledWriters.data()) : consumed;
+
+    const auto& source = resampling ? resampledWriters : mixedWriters;
+    std::copy (source.begin(), source.end(), outputPointers.begin());
+    return { outputPointers.data(), numOutputs, numFrames, consumed };
+}
+
+void AnalysisInput::reportMemory (MemoryReport& report) const
+{
+    std::size_t bytes = resampler.getMemoryUsage();
+
+    for (auto* buffers : { &planar, &mixed, &resampled })
+        for (auto& b : *buffers)
+            bytes += b.capacity() * sizeof (float);
+
+    bytes += (planarPointers.capacity() + outputPointers.capacity()) * sizeof (const float*)
+           + (planarWriters.capacity() + mixedWriters.capacity() + resampledWriters.capacity()) * sizeof (float*);
+
+    report.add (MemoryReport::analysis, bytes);
+    report.add (MemoryReport::shared, resampler.getSharedMemoryUsage());
+}
+
+} // namespace dawinfo
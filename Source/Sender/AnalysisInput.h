@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Sender/PolyphaseResampler.h"
+#include "Sender/SampleKernels.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+//==============================================================================
+/**
+    Brings whatever the host plays - mono to 7.1.4, 44.1 to 192 kHz, planar
+    or interleaved - to the one format the analysis stages are written for:
+    one or two float channels at a fixed analysis rate.
+
+    Each block is folded down with the layout's DownmixMatrix first, so only
+    the analysis channels are resampled, then taken to the analysis rate by a
+    PolyphaseResampler (skipped when the host already runs at it). Analysis
+    cost per second of audio is then the same at any host rate.
+
+    prepare() allocates and is not for the audio thread; the process
+    functions never allocate or block. Their output stays valid until the
+    next call. They take at most the prepared block size per call: a longer
+    host block reports how much of it was used in Block::framesConsumed,
+    and the rest goes in further calls.
+*/
+class AnalysisInput
+{
+public:
+    struct Options
+    {
+        double analysisRate = 48000.0;
+        int numOutputs = 2;             // 1 for mono analysis
+        int tapsPerPhase = 24;
+    };
+
+    /** A view of the converted block. */
+    struct Block
+    {
+        const float* const* channels = nullptr;
+        int numChannels = 0;
+        int numFrames = 0;
+        int framesConsumed = 0;         // host frames used; fewer than given if the block was too long
+    };
+
+    AnalysisInput() = default;
+    explicit AnalysisInput (const Options& o) : options (o) {}
+
+    /** False if the rate pair is one the resampler can't do exactly; the
+        previous preparation, if any, then stays in place.
+    */
+    bool prepare (double hostRate, int numHostChannels, ChannelLayout, int maxBlockSize);
+
+    bool prepare (double hostRate, int numHostChannels, int maxBlockSize)
+    {
+        return prepare (hostRate, numHostChannels, layoutForChannelCount (numHostChannels), maxBlockSize);
+    }
+
+    /** One buffer per host channel. Channels past the prepared count are ignored. */
+    Block process (const float* const* channels, int numChannels, int numFrames) noexcept;
+
+    /** Interleaved host frames, float or 16-bit. */
+    Block processInterleaved (const float* frames, int numChannels, int numFrames) noexcept;
+    Block processInterleaved (const std::int16_t* frames, int numChannels, int numFrames) noexcept;
+
+    const DownmixMatrix& getDownmix() const noexcept        { return downmix; }
+    const PolyphaseResampler& getResampler() const noexcept { return resampler; }
+    bool isResampling() const noexcept                      { return resampling; }
+
+    /** The conversion buffers, and the resampler's shared filter bank. */
+    void reportMemory (MemoryReport&) const;
+
+private:
+    Block convert (const float* const* channels, int numFrames) noexcept;
+
+    Options options;
+    DownmixMatrix downmix;
+    PolyphaseResampler resampler;
+    bool resampling = false;
+    int maxBlock = 0;
+
+    std::vector<std::vector<float>> planar, mixed, resampled;
+    std::vector<const float*> planarPointers;
+    std::vector<float*> planarWriters, mixedWriters, resampledWriters;
+    std::vector<const float*> outputPointers;
+};
+
+} // namespace dawinfo
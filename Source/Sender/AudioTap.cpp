@@ -0,0 +1,107 @@
+#include "Sender/AudioTap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <thread>
+
+namespace dawinfo
+{
+
+bool AudioTap::open (const std::string& name, int channels, std::size_t capacityFrames, double sampleRate)
+{
+    close();
+
+    if (channels < 1 || channels > audiotap::maxChannels || capacityFrames == 0 || capacityFrames > (1u << 24))
+        return false;
+
+    std::uint32_t frames = 1;
+
+    while (frames < capacityFrames)
+        frames <<= 1;
+
+    const auto n = static_cast<std::uint32_t> (channels);
+
+    if (! memory.create (name, audiotap::regionSize (n, frames)))
+        return false;
+
+    auto* h = new (memory.getData()) AudioTapHeader;
+    h->version = AudioTapHeader::currentVersion;
+    h->numChannels = n;
+    h->capacityFrames = frames;
+    h->sampleRate = sampleRate;
+    h->writeStart.store (0, std::memory_order_relaxed);
+    h->writeEnd.store (0, std::memory_order_relaxed);
+    h->magic.store (AudioTapHeader::magicValue, std::memory_order_release);
+
+    numChannels = n;
+    capacity = frames;
+    header.store (h, std::memory_order_seq_cst);
+    return true;
+}
+
+void AudioTap::close() noexcept
+{
+    // Pairs with write(): once header is null and writing is clear, the audio
+    // thread can't be holding the old mapping.
+    header.store (nullptr, std::memory_order_seq_cst);
+
+    while (writing.load (std::memory_order_seq_cst))
+        std::this_thread::yield();
+
+    memory.close();
+}
+
+void AudioTap::write (const float* const* channels, int numInputChannels, int numSamples) noexcept
+{
+    writing.store (true, std::memory_order_seq_cst);
+
+    if (auto* h = header.load (std::memory_order_seq_cst); h != nullptr && numSamples > 0)
+        writeBlock (*h, channels, numInputChannels, numSamples);
+
+    writing.store (false, std::memory_order_release);
+}
+
+void AudioTap::writeBlock (AudioTapHeader& h, const float* const* channels, int numInputChannels, int numSamples) noexcept
+{
+    auto start = h.writeEnd.load (std::memory_order_relaxed);
+    const auto mask = capacity - 1;
+
+    // A block longer than the ring only leaves its tail behind.
+    const auto skip = static_cast<std::uint32_t> (numSamples) > capacity ? static_cast<std::uint32_t> (numSamples) - capacity : 0u;
+    const auto numFrames = static_cast<std::uint32_t> (numSamples) - skip;
+    start += skip;
+
+    h.writeStart.store (start + numFrames, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    const auto offset = static_cast<std::uint32_t> (start & mask);
+    const auto firstPart = std::min (numFrames, capacity - offset);
+
+    for (std::uint32_t c = 0; c < numChannels; ++c)
+    {
+        auto* ring = audiotap::channelData (&h, capacity, c);
+
+        if (static_cast<int> (c) < numInputChannels && channels[c] != nullptr)
+        {
+            const float* src = channels[c] + skip;
+            std::memcpy (ring + offset, src, firstPart * sizeof (float));
+            std::memcpy (ring, src + firstPart, (numFrames - firstPart) * sizeof (float));
+        }
+        else
+        {
+            std::memset (ring + offset, 0, firstPart * sizeof (float));
+            std::memset (ring, 0, (numFrames - firstPart) * sizeof (float));
+        }
+    }
+
+    h.writeEnd.store (start + numFrames, std::memory_order_release);
+}
+
+std::uint64_t AudioTap::getFramesWritten() const noexcept
+{
+    const auto* h = header.load (std::memory_order_acquire);
+    return h != nullptr ? h->writeEnd.load (std::memory_order_relaxed) : 0;
+}
+
+} // namespace dawinfo
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Common/AudioTapLayout.h"
+#include "Common/SharedMemory.h"
+
+#include <atomic>
+#include <string>
+
+namespace dawinfo
+{
+
+//==============================================================================
+/**
+    Optional raw audio tap: publishes the block's samples into a named
+    shared-memory ring (see Common/AudioTapLayout.h) for local analysis tools
+    that need the audio itself. Readers attach with AudioTapReader from
+    another process; nothing goes over a socket.
+
+    The tap is off until open() succeeds. write() is the only call the audio
+    thread makes: per channel one memcpy (two at the ring's wrap point) and
+    two counter stores. Readers never hold the writer back; one that falls
+    more than the capacity behind loses data, and finds out when it next
+    reads.
+
+    open() and close() may run while the audio thread keeps calling write():
+    close() unpublishes the region, then waits for a write() that already
+    picked it up to finish before unmapping it.
+*/
+class AudioTap
+{
+public:
+    AudioTap() = default;
+
+    /** Message thread: creates the region. capacityFrames is rounded up to a
+        power of two and should cover several blocks. Returns false if shared
+        memory is unavailable.
+    */
+    bool open (const std::string& name, int numChannels, std::size_t capacityFrames, double sampleRate);
+    void close() noexcept;
+
+    bool isOpen() const noexcept    { return header.load (std::memory_order_acquire) != nullptr; }
+
+    /** Audio thread: appends a block. Missing channels are written as
+        silence, extra ones ignored. Does nothing while closed.
+    */
+    void write (const float* const* channels, int numChannels, int numSamples) noexcept;
+
+    /** Frames written since open(). */
+    std::uint64_t getFramesWritten() const noexcept;
+
+private:
+    void writeBlock (AudioTapHeader&, const float* const* channels, int numInputChannels, int numSamples) noexcept;
+
+    SharedMemory memory;
+    std::atomic<AudioTapHeader*> header { nullptr };
+    std::atomic<bool> writing { false };
+    std::uint32_t numChannels = 0, capacity = 0;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,171 @@
+#include "Sender/CoalescingQueue.h"
+#include "Sender/MemoryBudget.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dawinfo
+{
+
+CoalescingQueue::CoalescingQueue() : CoalescingQueue (Options()) {}
+
+CoalescingQueue::CoalescingQueue (const Options& options)
+    : fifo (static_cast<std::size_t> (std::max (options.fifoCapacity, 1)))
+{
+    for (std::size_t i = 0; i < numStreams; ++i)
+        policies[i] = defaultPolicy (static_cast<StreamId> (i));
+}
+
+CoalescingQueue::Policy CoalescingQueue::defaultPolicy (StreamId stream) noexcept
+{
+    switch (stream)
+    {
+        case StreamId::transport:
+        case StreamId::levels:
+        case StreamId::spectrum:
+        case StreamId::stereo:
+            return Policy::latest;
+
+        default:
+            return Policy::fifo;
+    }
+}
+
+void CoalescingQueue::setPolicy (StreamId stream, Policy policy) noexcept
+{
+    policies[static_cast<std::size_t> (stream)] = policy;
+}
+
+bool CoalescingQueue::findStream (const std::uint8_t* data, std::size_t size, StreamId& stream) noexcept
+{
+    bool found = false, first = true;
+    std::uint32_t seq = 0;
+
+    // The sequence message is always the first element of the bundle.
+    forEachOscMessage (data, size, [&] (const OscMessage& m)
+    {
+        if (first)
+            found = decodeSequence (m, stream, seq) && stream < StreamId::numStreams;
+
+        first = false;
+    });
+
+    return found;
+}
+
+CoalescingQueue::Key CoalescingQueue::keyFor (const std::uint8_t* data, std::size_t size) const noexcept
+{
+    Key key;
+
+    if (findStream (data, size, key.stream))
+        key.policy = policies[static_cast<std::size_t> (key.stream)];
+
+    return key;
+}
+
+//==============================================================================
+void CoalescingQueue::store (Entry& e, const std::uint8_t* prefix, std::size_t prefixSize,
+                             const std::uint8_t* data, std::size_t size)
+{
+    e.data.resize (prefixSize + size);
+
+    if (prefixSize > 0)
+        std::memcpy (e.data.data(), prefix, prefixSize);
+
+    if (size > 0)
+        std::memcpy (e.data.data() + prefixSize, data, size);
+
+    e.pending = true;
+}
+
+bool CoalescingQueue::push (Key key, const std::uint8_t* data, std::size_t size,
+                            const std::uint8_t* prefix, std::size_t prefixSize)
+{
+    ++stats.pushed;
+
+    if (key.policy == Policy::latest)
+    {
+        auto& slot = slots[static_cast<std::size_t> (key.stream)];
+        const bool replacing = slot.pending;
+
+        // A replacement keeps the turn of the packet it replaces.
+        if (replacing)
+            ++stats.coalesced;
+        else
+            slot.order = nextOrder++;
+
+        store (slot, prefix, prefixSize, data, size);
+        return replacing;
+    }
+
+    bool displaced = false;
+
+    if (fifoCount == fifo.size())
+    {
+        fifo[fifoHead].pending = false;
+        fifoHead = (fifoHead + 1) % fifo.size();
+        --fifoCount;
+        ++stats.dropped;
+        displaced = true;
+    }
+
+    auto& e = fifo[(fifoHead + fifoCount) % fifo.size()];
+    e.order = nextOrder++;
+    store (e, prefix, prefixSize, data, size);
+    ++fifoCount;
+    return displaced;
+}
+
+bool CoalescingQueue::pop (std::vector<std::uint8_t>& out)
+{
+    Entry* next = fifoCount > 0 ? &fifo[fifoHead] : nullptr;
+
+    for (auto& slot : slots)
+        if (slot.pending && (next == nullptr || slot.order < next->order))
+            next = &slot;
+
+    if (next == nullptr)
+        return false;
+
+    if (next == &fifo[fifoHead] && fifoCount > 0)
+    {
+        fifoHead = (fifoHead + 1) % fifo.size();
+        --fifoCount;
+    }
+
+    std::swap (out, next->data);
+    next->pending = false;
+    ++stats.popped;
+    return true;
+}
+
+std::size_t CoalescingQueue::size() const noexcept
+{
+    return fifoCount + static_cast<std::size_t> (std::count_if (slots.begin(), slots.end(), [] (const Entry& e) { return e.pending; }));
+}
+
+void CoalescingQueue::clear() noexcept
+{
+    for (auto& slot : slots)
+        slot.pending = false;
+
+    for (auto& e : fifo)
+        e.pending = false;
+
+    fifoHead = fifoCount = 0;
+}
+
+void CoalescingQueue::reportMemory (MemoryReport& report) const
+{
+    std::size_t bytes = fifo.capacity() * sizeof (Entry);
+
+    for (auto& slot : slots)
+        bytes += slot.data.capacity();
+
+    for (auto& e : fifo)
+        bytes += e.data.capacity();
+
+    report.add (MemoryReport::queues, bytes);
+}
+
+} // namespace dawinfo
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Common/Protocol.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+/**
+    One receiver's backlog, for links that can fall behind the sender.
+
+    State streams (transport, levels, spectrum, stereo) are latest-wins: each has a
+    single slot, and a new packet for a stream that still has one pending
+    replaces it in place, keeping its turn. However slow the link, at most
+    one packet per state stream waits, and what goes out next is the newest
+    state rather than the oldest. Everything else - events, MIDI, parameter
+    segments, waveform bins, metadata, replies - is a FIFO, since receivers
+    need every one of those; a full FIFO drops its oldest.
+
+    pop() hands out whichever pending packet has waited longest. Packets are
+    classified by their sequence header; one without it goes in the FIFO.
+
+    Not thread-safe: the owner serialises push() and pop(). Buffers are
+    swapped rather than copied out, so once every slot has held a packet of
+    a given size nothing allocates.
+*/
+class CoalescingQueue
+{
+public:
+    enum class Policy
+    {
+        latest,
+        fifo
+    };
+
+    struct Options
+    {
+        int fifoCapacity = 64;              // packets; a full FIFO drops its oldest
+    };
+
+    struct Stats
+    {
+        std::uint64_t pushed = 0;
+        std::uint64_t coalesced = 0;        // pending state packets replaced by newer ones
+        std::uint64_t dropped = 0;          // pushed out of a full FIFO
+        std::uint64_t popped = 0;
+    };
+
+    /** Where a packet goes. */
+    struct Key
+    {
+        Policy policy = Policy::fifo;
+        StreamId stream = StreamId::events;
+    };
+
+    CoalescingQueue();
+    explicit CoalescingQueue (const Options&);
+
+    /** Transport, levels, spectrum and stereo are latest-wins; the rest are FIFO. */
+    static Policy defaultPolicy (StreamId) noexcept;
+    void setPolicy (StreamId, Policy) noexcept;
+
+    /** The stream named by a packet's sequence message; false if it has none. */
+    static bool findStream (const std::uint8_t* data, std::size_t size, StreamId&) noexcept;
+
+    Key keyFor (const std::uint8_t* data, std::size_t size) const noexcept;
+
+    /** Queues data, with an optional prefix (a frame header, say) stored in
+        front of it. Returns true if an older packet was displaced.
+    */
+    bool push (Key, const std::uint8_t* data, std::size_t size,
+               const std::uint8_t* prefix = nullptr, std::size_t prefixSize = 0);
+
+    bool push (const std::uint8_t* data, std::size_t size)      { return push (keyFor (data, size), data, size); }
+
+    /** Swaps the longest-waiting packet into out; false if there is none.
+        out's old buffer is kept for reuse.
+    */
+    bool pop (std::vector<std::uint8_t>& out);
+
+    std::size_t size() const noexcept;
+    bool isEmpty() const noexcept           { return size() == 0; }
+    void clear() noexcept;
+
+    const Stats& getStats() const noexcept  { return stats; }
+
+    /** Every slot's buffer, which grows to the largest packet it has held. */
+    void reportMemory (MemoryReport&) const;
+
+private:
+    struct Entry
+    {
+        std::vector<std::uint8_t> data;
+        std::uint64_t order = 0;            // push order of the packet it replaced, for slots
+        bool pending = false;
+    };
+
+    static void store (Entry&, const std::uint8_t* prefix, std::size_t prefixSize, const std::uint8_t* data, std::size_t size);
+
+    std::array<Policy, numStreams> policies {};
+    std::array<Entry, numStreams> slots;
+    std::vector<Entry> fifo;
+    std::size_t fifoHead = 0, fifoCount = 0;
+    std::uint64_t nextOrder = 0;
+    Stats stats;
+};
+
+} // namespace dawinfo
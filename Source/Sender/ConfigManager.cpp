@@ -0,0 +1,99 @@
+#include "Sender/ConfigManager.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace dawinfo
+{
+
+ConfigManager::ConfigManager()
+    : store (std::make_unique<SenderConfig>())
+{
+}
+
+bool ConfigManager::loadFile (const std::string& path, std::string& error)
+{
+    std::ifstream file (path);
+
+    if (! file)
+    {
+        error = "cannot read " + path;
+        std::lock_guard<std::mutex> l (lock);
+        ++rejected;
+        return false;
+    }
+
+    std::ostringstream text;
+    text << file.rdbuf();
+    return loadText (text.str(), error);
+}
+
+bool ConfigManager::loadText (std::string_view text, std::string& error)
+{
+    SenderConfig next;
+
+    if (! config::parse (text, next, error))
+    {
+        std::lock_guard<std::mutex> l (lock);
+        ++rejected;
+        return false;
+    }
+
+    return apply (std::move (next), error);
+}
+
+bool ConfigManager::handleMessage (const OscMessage& m, std::string& error)
+{
+    std::lock_guard<std::mutex> l (lock);
+    auto next = std::make_unique<SenderConfig> (store.getForWriter());
+
+    if (! config::applyMessage (m, *next, error))
+    {
+        ++rejected;
+        return false;
+    }
+
+    next->version = nextVersion++;
+    awaiting = store.publish (std::move (next));
+    return true;
+}
+
+bool ConfigManager::apply (SenderConfig next, std::string& error)
+{
+    std::lock_guard<std::mutex> l (lock);
+
+    if (! config::validate (next, error))
+    {
+        ++rejected;
+        return false;
+    }
+
+    next.version = nextVersion++;
+    awaiting = store.publish (std::make_unique<SenderConfig> (std::move (next)));
+    return true;
+}
+
+std::size_t ConfigManager::collect()
+{
+    std::lock_guard<std::mutex> l (lock);
+    return awaiting = store.collect();
+}
+
+SenderConfig ConfigManager::getCopy() const
+{
+    std::lock_guard<std::mutex> l (lock);
+    return store.getForWriter();
+}
+
+ConfigManager::Stats ConfigManager::getStats() const
+{
+    std::lock_guard<std::mutex> l (lock);
+    Stats s;
+    s.applied = store.getPublished();
+    s.rejected = rejected;
+    s.reclaimed = store.getReclaimed();
+    s.awaitingReclaim = awaiting;
+    return s;
+}
+
+} // namespace dawinfo
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Common/Config.h"
+#include "Common/RcuPointer.h"
+
+#include <mutex>
+#include <string>
+
+namespace dawinfo
+{
+
+//==============================================================================
+/**
+    Owns the live SenderConfig and swaps in new ones while the plugin runs.
+
+    Every change - a reloaded file, a full replacement or a single key set
+    over OSC - builds and validates a complete new config on the calling
+    thread, then publishes it through an RcuPointer. The audio and sender
+    threads register as readers once and take a ReadScope per block or per
+    round; they see the change at their next scope, never allocate or lock
+    to do so, and the config they hold stays valid until their scope ends.
+    Replaced configs are freed later by whichever writer runs next, or by
+    collect(). A rejected change leaves the live config untouched.
+
+    Not for the audio thread except through ReadScope.
+*/
+class ConfigManager
+{
+public:
+    using Store = RcuPointer<SenderConfig>;
+    using Reader = Store::Reader;
+    using ReadScope = Store::ReadScope;
+
+    struct Stats
+    {
+        std::uint64_t applied = 0;
+        std::uint64_t rejected = 0;
+        std::uint64_t reclaimed = 0;
+        std::size_t awaitingReclaim = 0;
+    };
+
+    ConfigManager();
+
+    /** Replaces the config with defaults overlaid by the file's contents. */
+    bool loadFile (const std::string& path, std::string& error);
+
+    /** Replaces the config with defaults overlaid by the text. */
+    bool loadText (std::string_view text, std::string& error);
+
+    /** Changes one key of the live config from a /dawinfo/config/<key> message. */
+    bool handleMessage (const OscMessage&, std::string& error);
+
+    /** Validates and publishes a complete config. */
+    bool apply (SenderConfig next, std::string& error);
+
+    /** Once per reading thread, before it starts reading. */
+    Reader registerReader()                         { return store.registerReader(); }
+    void unregisterReader (Reader& r)               { store.unregisterReader (r); }
+
+    /** Frees replaced configs no reader still holds. */
+    std::size_t collect();
+
+    /** A copy of the live config, for non-real-time code. */
+    SenderConfig getCopy() const;
+
+    Stats getStats() const;
+
+private:
+    mutable std::mutex lock;    // makes read-modify-publish atomic across writers
+    Store store;
+    std::uint64_t nextVersion = 1;
+    std::uint64_t rejected = 0;
+    std::size_t awaiting = 0;
+};
+
+} // namespace dawinfo
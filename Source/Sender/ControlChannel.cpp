@@ -0,0 +1,356 @@
+#include "Sender/ControlChannel.h"
+#include "Common/Clock.h"
+#include "Common/Messages.h"
+#include "Sender/MemoryBudget.h"
+
+#include <algorithm>
+
+namespace dawinfo
+{
+
+namespace
+{
+    /** How often the listener looks up from the socket to see if it should stop. */
+    constexpr int listenerPollMs = 50;
+
+    /** Largest datagram the listener reads; commands are tens of bytes. */
+    constexpr std::size_t maxCommandPacket = 1500;
+
+    /** Room for the largest history chunk and the sequence message before it. */
+    constexpr std::size_t maxHistoryPacket = 1400;
+}
+
+ControlChannel::ControlChannel (std::size_t queueCapacity, std::size_t mailboxCapacity)
+    : queue (queueCapacity), mailbox (mailboxCapacity)
+{
+    subscribers.reserve (maxSubscribers);
+    historyStreams.reserve (maxHistoryStreams);
+}
+
+ControlChannel::~ControlChannel()
+{
+    stop();
+}
+
+bool ControlChannel::start (int port, bool loopbackOnly)
+{
+    stop();
+
+    if (! socket.open (port, loopbackOnly))
+        return false;
+
+    running = true;
+    listener = std::thread ([this] { listen(); });
+    return true;
+}
+
+void ControlChannel::stop()
+{
+    running = false;
+
+    if (listener.joinable())
+        listener.join();
+
+    socket.close();
+}
+
+//==============================================================================
+void ControlChannel::listen()
+{
+    std::uint8_t buffer[maxCommandPacket];
+
+    while (running.load (std::memory_order_relaxed))
+    {
+        Endpoint from;
+        const auto size = socket.receive (buffer, sizeof (buffer), from, listenerPollMs);
+
+        if (size <= 0)
+            continue;
+
+        packets.fetch_add (1, std::memory_order_relaxed);
+        const auto receivedNs = monotonicNowNs();
+        bool queuedAny = false;
+
+        const bool wellFormed = forEachOscMessage (buffer, static_cast<std::size_t> (size), [&] (const OscMessage& m)
+        {
+            Received r { {}, from, receivedNs };
+
+            if (! control::decodeCommand (m, r.command))
+            {
+                malformed.fetch_add (1, std::memory_order_relaxed);
+                return;
+            }
+
+            if (queue.push (r))
+            {
+                commands.fetch_add (1, std::memory_order_relaxed);
+                queuedAny = true;
+            }
+            else
+            {
+                dropped.fetch_add (1, std::memory_order_relaxed);
+            }
+        });
+
+        if (! wellFormed)
+            malformed.fetch_add (1, std::memory_order_relaxed);
+
+        if (queuedAny)
+        {
+            // Taking the lock orders the push before a waiter's check.
+            { std::lock_guard<std::mutex> lock (wakeLock); }
+            wake.notify_one();
+        }
+    }
+}
+
+bool ControlChannel::waitForCommands (int timeoutMs)
+{
+    if (isStreamingHistory())
+        return true;
+
+    std::unique_lock<std::mutex> lock (wakeLock);
+    return wake.wait_for (lock, std::chrono::milliseconds (timeoutMs), [this] { return ! queue.isEmpty(); });
+}
+
+//==============================================================================
+std::size_t ControlChannel::service (StreamSequencer& seq, HostTimeNs nowNs)
+{
+    subscribers.erase (std::remove_if (subscribers.begin(), subscribers.end(),
+                                       [nowNs] (const Subscriber& s) { return s.expiresNs <= nowNs; }),
+                       subscribers.end());
+
+    std::size_t count = 0;
+    Received r;
+
+    while (queue.pop (r))
+    {
+        handle (r, seq, nowNs);
+        ++count;
+    }
+
+    handled += count;
+    streamHistory (seq);
+    return count;
+}
+
+void ControlChannel::handle (const Received& r, StreamSequencer& seq, HostTimeNs nowNs)
+{
+    using control::CommandType;
+
+    switch (r.command.type)
+    {
+        case CommandType::ping:
+            reply (r, control::Status::ok, seq);
+            break;
+
+        case CommandType::querySnapshot:
+        {
+            const auto t = transport.load();
+            reply (r, control::Status::ok, seq, &t);
+            break;
+        }
+
+        case CommandType::subscribe:
+            reply (r, subscribe (r, nowNs), seq);
+            break;
+
+        case CommandType::unsubscribe:
+            subscribers.erase (std::remove_if (subscribers.begin(), subscribers.end(),
+                                               [&] (const Subscriber& s) { return s.endpoint == r.from; }),
+                               subscribers.end());
+            reply (r, control::Status::ok, seq);
+            break;
+
+        case CommandType::play:
+        case CommandType::stop:
+        case CommandType::locate:
+        {
+            const bool queued = mailbox.push (r.command);
+            mailboxFull += queued ? 0 : 1;
+            reply (r, queued ? control::Status::ok : control::Status::busy, seq);
+            break;
+        }
+
+        case CommandType::queryHistory:
+            reply (r, queryHistory (r), seq);
+            break;
+
+        case CommandType::queryPeaks:
+            answerPeaks (r, seq);
+            break;
+    }
+}
+
+control::Status ControlChannel::subscribe (const Received& r, HostTimeNs nowNs)
+{
+    const auto durationMs = r.command.durationMs > 0 ? r.command.durationMs : control::defaultSubscriptionMs;
+    const auto expiresNs = nowNs + static_cast<HostTimeNs> (durationMs) * 1000000;
+
+    for (auto& s : subscribers)
+    {
+        if (s.endpoint == r.from)
+        {
+            s.streams = r.command.streams;
+            s.expiresNs = expiresNs;
+            return control::Status::ok;
+        }
+    }
+
+    if (subscribers.size() >= maxSubscribers)
+        return control::Status::rejected;
+
+    subscribers.push_back ({ r.from, r.command.streams, expiresNs });
+    return control::Status::ok;
+}
+
+//==============================================================================
+void ControlChannel::setHistory (history::Feature feature, const FeatureHistory* h) noexcept
+{
+    // Ranges found in the old history mean nothing in the new one.
+    historyStreams.erase (std::remove_if (historyStreams.begin(), historyStreams.end(),
+                                          [feature] (const HistoryStream& s) { return s.feature == feature; }),
+                          historyStreams.end());
+
+    histories[static_cast<std::size_t> (feature)] = h;
+}
+
+control::Status ControlChannel::queryHistory (const Received& r)
+{
+    const auto& c = r.command;
+    const auto* h = histories[static_cast<std::size_t> (c.feature)];
+
+    if (h == nullptr || historyStreams.size() >= maxHistoryStreams)
+        return control::Status::rejected;
+
+    auto absolute = [&r] (HostTimeNs t) { return t <= 0 ? r.receivedNs + t : t; };
+    const auto maxFrames = c.maxFrames > 0 ? c.maxFrames : control::defaultHistoryFrames;
+
+    historyStreams.push_back ({ r.from, c.token, c.feature, h->find (absolute (c.fromNs), absolute (c.toNs), maxFrames) });
+    ++historyQueries;
+    return control::Status::ok;
+}
+
+void ControlChannel::streamHistory (StreamSequencer& seq)
+{
+    std::uint8_t buffer[maxHistoryPacket];
+
+    // Round robin, so a long answer doesn't hold up a short one behind it.
+    for (int i = 0; i < historyBudget && ! historyStreams.empty(); ++i)
+    {
+        nextHistoryStream %= historyStreams.size();
+        auto& s = historyStreams[nextHistoryStream];
+        const auto* h = histories[static_cast<std::size_t> (s.feature)];
+
+        const auto unsent = s.range;
+        OscWriter w (buffer, sizeof (buffer));
+        seq.beginPacket (w, StreamId::control);
+        h->writeChunk (w, s.token, s.feature, s.range, history::maxFramesPerChunk (h->getNumValues()));
+
+        if (! w.hasOverflowed())
+        {
+            const auto congestedBefore = socket.getCongestedSends();
+
+            if (! socket.sendTo (s.to, w.getData(), w.getSize()))
+            {
+                const bool congested = socket.getCongestedSends() != congestedBefore;
+
+                if (congested && ++s.retries <= maxHistoryRetries)
+                {
+                    // A full socket buffer: put the chunk back and try again
+                    // next cycle, so the last chunk is never lost.
+                    s.range = unsent;
+                    ++historyRetries;
+                    break;
+                }
+
+                // The destination can't be reached, or stays congested:
+                // give up rather than hold the slot and keep the sender busy.
+                historyStreams.erase (historyStreams.begin() + static_cast<std::ptrdiff_t> (nextHistoryStream));
+                ++historyDropped;
+                continue;
+            }
+
+            s.retries = 0;
+            ++historyChunks;
+            historyBytes += w.getSize();
+        }
+
+        if (s.range.size() == 0)
+            historyStreams.erase (historyStreams.begin() + static_cast<std::ptrdiff_t> (nextHistoryStream));
+        else
+            ++nextHistoryStream;
+    }
+}
+
+//==============================================================================
+void ControlChannel::answerPeaks (const Received& r, StreamSequencer& seq)
+{
+    if (waveform == nullptr || ! waveform->isPrepared())
+    {
+        reply (r, control::Status::rejected, seq);
+        return;
+    }
+
+    reply (r, control::Status::ok, seq);
+
+    UdpSink to (socket, r.from);
+    waveform->update();
+    peaksBytes += waveform->answer (r.command.peaks, to, seq);
+    ++peaksQueries;
+}
+
+void ControlChannel::reply (const Received& r, control::Status status, StreamSequencer& seq, const TransportSnapshot* t)
+{
+    std::uint8_t buffer[256];
+    OscWriter w (buffer, sizeof (buffer));
+    seq.beginPacket (w, StreamId::control);
+    schema::Codec<messages::ControlReply>::write (w, { r.command.token, r.command.type, status, r.receivedNs });
+
+    if (t != nullptr)
+        schema::Codec<messages::Transport>::write (w, *t);
+
+    const bool sent = ! w.hasOverflowed() && socket.sendTo (r.from, w.getData(), w.getSize());
+    replies += sent ? 1 : 0;
+    replyFailures += sent ? 0 : 1;
+}
+
+int ControlChannel::sendToSubscribers (StreamId stream, const std::uint8_t* data, std::size_t size) noexcept
+{
+    int sent = 0;
+
+    for (auto& s : subscribers)
+        if ((s.streams & control::streamBit (stream)) != 0 && socket.sendTo (s.endpoint, data, size))
+            ++sent;
+
+    return sent;
+}
+
+ControlChannel::Stats ControlChannel::getStats() const noexcept
+{
+    Stats s;
+    s.packets = packets.load (std::memory_order_relaxed);
+    s.commands = commands.load (std::memory_order_relaxed);
+    s.dropped = dropped.load (std::memory_order_relaxed);
+    s.malformed = malformed.load (std::memory_order_relaxed);
+    s.handled = handled;
+    s.replies = replies;
+    s.replyFailures = replyFailures;
+    s.mailboxFull = mailboxFull;
+    s.historyQueries = historyQueries;
+    s.historyChunks = historyChunks;
+    s.historyBytes = historyBytes;
+    s.historyRetries = historyRetries;
+    s.historyDropped = historyDropped;
+    s.peaksQueries = peaksQueries;
+    s.peaksBytes = peaksBytes;
+    return s;
+}
+
+void ControlChannel::reportMemory (MemoryReport& report) const
+{
+    report.add (MemoryReport::rings, queue.getMemoryUsage() + mailbox.getMemoryUsage());
+    report.add (MemoryReport::state, subscribers.capacity() * sizeof (Subscriber) + historyStreams.capacity() * sizeof (HistoryStream));
+}
+
+} // namespace dawinfo
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "Common/Control.h"
+#include "Common/LatestValue.h"
+#include "Common/SpscRing.h"
+#include "Common/UdpSocket.h"
+#include "Sender/FeatureHistory.h"
+#include "Sender/StreamSequencer.h"
+#include "Sender/WaveformPublisher.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+//==============================================================================
+/**
+    The inbound side of the link: a UDP port controllers send commands to
+    (see Common/Control.h), answered from the same socket.
+
+    Three threads touch it, each through its own calls:
+
+    - The listener thread, started by start(), receives and decodes packets
+      and queues each command in a bounded ring. When the ring is full the
+      command is dropped and counted; nothing else is held back, so a flood
+      can't grow memory or delay the other threads.
+    - The sender thread calls service(), which drains the queue and replies:
+      pings and snapshot queries are answered straight away, subscriptions
+      are kept in a list for the sender's fan-out, and transport commands are
+      handed to the audio thread. A history query is answered from the
+      FeatureHistory given to setHistory(), streamed a few chunks per call
+      so a long window never holds up the sender's live output. A chunk
+      whose send meets a full socket buffer is retried on a later call; any
+      other send failure, or too many retries, abandons the query. A peaks
+      request is answered in one go by the WaveformPublisher given to
+      setWaveform(); it is clipped to one pyramid level, so it stays short.
+      waitForCommands() lets it sleep until something arrives, and doesn't
+      sleep while history is still being streamed.
+    - The audio thread only calls publishTransport(), a seqlock store of the
+      block's state that snapshot queries read, and popTransportCommand(), a
+      read from a lock-free mailbox. It never waits on the others.
+*/
+class ControlChannel
+{
+public:
+    struct Subscriber
+    {
+        Endpoint endpoint;
+        std::uint32_t streams = 0;
+        HostTimeNs expiresNs = 0;
+    };
+
+    struct Stats
+    {
+        std::uint64_t packets = 0;          // listener thread
+        std::uint64_t commands = 0;         // queued
+        std::uint64_t dropped = 0;          // queue full
+        std::uint64_t malformed = 0;        // unparsable packets or unknown commands
+        std::uint64_t handled = 0;          // sender thread
+        std::uint64_t replies = 0;
+        std::uint64_t replyFailures = 0;
+        std::uint64_t mailboxFull = 0;
+        std::uint64_t historyQueries = 0;
+        std::uint64_t historyChunks = 0;
+        std::uint64_t historyBytes = 0;
+        std::uint64_t historyRetries = 0;   // chunks resent after a congested send
+        std::uint64_t historyDropped = 0;   // queries abandoned after a failed send
+        std::uint64_t peaksQueries = 0;
+        std::uint64_t peaksBytes = 0;
+    };
+
+    static constexpr std::size_t maxSubscribers = 16;
+    static constexpr std::size_t maxHistoryStreams = 8;
+
+    /** Congested sends in a row after which a history query is abandoned. */
+    static constexpr int maxHistoryRetries = 64;
+
+    explicit ControlChannel (std::size_t queueCapacity = 256, std::size_t mailboxCapacity = 16);
+    ~ControlChannel();
+
+    /** Binds the port (0 picks one) and starts the listener thread. */
+    bool start (int port = 0, bool loopbackOnly = false);
+    void stop();
+
+    int getPort() const noexcept                    { return socket.getPort(); }
+
+    //==============================================================================
+    /** Audio thread: the state snapshot queries answer with. Wait-free. */
+    void publishTransport (const TransportSnapshot& t) noexcept     { transport.store (t); }
+
+    /** Audio thread: the next play, stop or locate to carry out. Wait-free. */
+    bool popTransportCommand (control::Command& c) noexcept         { return mailbox.pop (c); }
+
+    //==============================================================================
+    /** Sender thread: sleeps until a command is queued or the timeout passes.
+        Returns true if there is something to service.
+    */
+    bool waitForCommands (int timeoutMs);
+
+    /** Sender thread: answers everything queued and drops expired
+        subscriptions. Returns the number of commands handled.
+    */
+    std::size_t service (StreamSequencer&, HostTimeNs nowNs);
+
+    /** Sender thread: the history queries for a feature are answered from.
+        nullptr, the default, rejects them. The history must outlive the
+        channel or be replaced first.
+    */
+    void setHistory (history::Feature, const FeatureHistory*) noexcept;
+
+    /** Sender thread: the waveform peaks requests are answered from.
+        nullptr, the default, rejects them. It must outlive the channel or
+        be replaced first.
+    */
+    void setWaveform (WaveformPublisher* w) noexcept        { waveform = w; }
+
+    /** Sender thread: history chunks service() sends per call, over all
+        queries. Each is about a kilobyte.
+    */
+    void setHistoryBudget (int chunksPerService) noexcept   { historyBudget = std::max (chunksPerService, 1); }
+
+    /** Sender thread: whether queries are still being streamed. */
+    bool isStreamingHistory() const noexcept                { return ! historyStreams.empty(); }
+
+    /** Sender thread: current subscriptions. */
+    const std::vector<Subscriber>& getSubscribers() const noexcept  { return subscribers; }
+
+    /** Sender thread: sends a packet to every subscriber of its stream.
+        Returns how many it went to.
+    */
+    int sendToSubscribers (StreamId, const std::uint8_t* data, std::size_t size) noexcept;
+
+    /** Sender thread (listener counters are read atomically). */
+    Stats getStats() const noexcept;
+
+    /** Sender thread. */
+    void reportMemory (MemoryReport&) const;
+
+private:
+    struct Received
+    {
+        control::Command command;
+        Endpoint from;
+        HostTimeNs receivedNs;
+    };
+
+    /** A history query still being answered. */
+    struct HistoryStream
+    {
+        Endpoint to;
+        std::int32_t token = 0;
+        history::Feature feature = history::Feature::levels;
+        FeatureHistory::Range range;
+        int retries = 0;                // congested sends since the last chunk went out
+    };
+
+    void listen();
+    void handle (const Received&, StreamSequencer&, HostTimeNs nowNs);
+    control::Status queryHistory (const Received&);
+    void streamHistory (StreamSequencer&);
+    void answerPeaks (const Received&, StreamSequencer&);
+    void reply (const Received&, control::Status, StreamSequencer&, const TransportSnapshot* = nullptr);
+    control::Status subscribe (const Received&, HostTimeNs nowNs);
+
+    UdpSocket socket;
+    std::thread listener;
+    std::atomic<bool> running { false };
+
+    SpscRing<Received> queue;
+    std::mutex wakeLock;
+    std::condition_variable wake;
+
+    LatestValue<TransportSnapshot> transport;
+    SpscRing<control::Command> mailbox;
+
+    std::vector<Subscriber> subscribers;
+
+    std::array<const FeatureHistory*, static_cast<std::size_t> (history::Feature::numFeatures)> histories {};
+    std::vector<HistoryStream> historyStreams;
+    std::size_t nextHistoryStream = 0;
+    int historyBudget = 4;
+
+    WaveformPublisher* waveform = nullptr;
+
+    std::atomic<std::uint64_t> packets { 0 }, commands { 0 }, dropped { 0 }, malformed { 0 };
+    std::uint64_t handled = 0, replies = 0, replyFailures = 0, mailboxFull = 0;
+    std::uint64_t historyQueries = 0, historyChunks = 0, historyBytes = 0, historyRetries = 0, historyDropped = 0;
+    std::uint64_t peaksQueries = 0, peaksBytes = 0;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,87 @@
+#include "Sender/EventRedundancy.h"
+#include "Common/Messages.h"
+
+#include <algorithm>
+
+namespace dawinfo
+{
+
+EventRedundancy::EventRedundancy (int r) noexcept
+{
+    setRedundancy (r);
+}
+
+void EventRedundancy::setRedundancy (int r) noexcept
+{
+    redundancy = std::clamp (r, 0, maxRedundancy);
+}
+
+std::uint32_t EventRedundancy::push (EventType type, HostTimeNs timeNs, float value) noexcept
+{
+    if (tail - head == capacity)
+    {
+        ++stats.evicted;
+        ++head;
+    }
+
+    auto& slot = slots[tail % capacity];
+    slot.event.id = nextId++;
+    slot.event.type = type;
+    slot.event.timeNs = timeNs;
+    slot.event.value = value;
+    slot.sendsLeft = 1 + redundancy;
+    slot.sentOnce = false;
+    ++tail;
+
+    ++stats.eventsPushed;
+    return slot.event.id;
+}
+
+int EventRedundancy::writePending (OscWriter& w) noexcept
+{
+    constexpr auto eventSize = 4 + schema::Codec<messages::Event>::wireSize;
+    int written = 0;
+    auto i = partway ? std::max (resumeAt, head) : head;
+    partway = false;
+
+    for (; i != tail; ++i)
+    {
+        auto& slot = slots[i % capacity];
+
+        if (slot.sendsLeft <= 0)
+            continue;
+
+        if (w.hasOverflowed() || w.getSize() + eventSize > w.getCapacity())
+        {
+            resumeAt = i;
+            partway = true;
+            break;
+        }
+
+        const auto before = w.getSize();
+        writeEvent (w, slot.event);
+        const auto bytes = static_cast<std::uint64_t> (w.getSize() - before);
+
+        if (slot.sentOnce)
+        {
+            ++stats.repeatSends;
+            stats.repeatBytes += bytes;
+        }
+        else
+        {
+            ++stats.firstSends;
+            stats.firstSendBytes += bytes;
+            slot.sentOnce = true;
+        }
+
+        --slot.sendsLeft;
+        ++written;
+    }
+
+    while (head != tail && slots[head % capacity].sendsLeft <= 0)
+        ++head;
+
+    return written;
+}
+
+} // namespace dawinfo
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Common/Protocol.h"
+
+#include <array>
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/**
+    Repeats discrete events in the packets that follow their first send.
+
+    Each pushed event gets an id and is written into the next packet and then
+    into the following `redundancy` packets, so it survives up to that many
+    consecutive losses. Receivers drop the copies with an EventDeduplicator.
+    Setting redundancy to zero turns repetition off.
+
+    The byte counters separate first sends from repeats, which makes the
+    bandwidth cost of a redundancy setting directly measurable.
+
+    Sender thread only; events are queued into a fixed ring and never allocate.
+*/
+class EventRedundancy
+{
+public:
+    static constexpr int maxRedundancy = 8;
+    static constexpr std::size_t capacity = 256;
+
+    struct Stats
+    {
+        std::uint64_t eventsPushed = 0;
+        std::uint64_t firstSends = 0;
+        std::uint64_t repeatSends = 0;
+        std::uint64_t firstSendBytes = 0;
+        std::uint64_t repeatBytes = 0;
+        std::uint64_t evicted = 0;      // dropped before all copies went out
+
+        /** Extra bytes spent on repeats, relative to sending each event once. */
+        double overheadRatio() const noexcept
+        {
+            return firstSendBytes > 0 ? static_cast<double> (repeatBytes) / static_cast<double> (firstSendBytes) : 0.0;
+        }
+    };
+
+    explicit EventRedundancy (int redundancy = 2) noexcept;
+
+    /** Clamped to [0, maxRedundancy]. Applies to events pushed afterwards. */
+    void setRedundancy (int) noexcept;
+    int getRedundancy() const noexcept      { return redundancy; }
+
+    /** Queues an event and returns the id assigned to it. */
+    std::uint32_t push (EventType, HostTimeNs, float value = 0.0f) noexcept;
+
+    /** Appends the events still owed a send to the packet being written, as
+        many as fit. If the packet fills up, the next call carries on from
+        the first event left out, so a burst can be split across packets.
+        An event only counts as sent once it has been written whole.
+        Returns the number of event messages written.
+    */
+    int writePending (OscWriter&) noexcept;
+
+    bool hasPending() const noexcept        { return head != tail; }
+
+    /** True when the last writePending() ran out of room before the end. */
+    bool hasMoreToWrite() const noexcept    { return partway; }
+    const Stats& getStats() const noexcept  { return stats; }
+    void resetStats() noexcept              { stats = {}; }
+
+private:
+    struct Slot
+    {
+        DiscreteEvent event;
+        int sendsLeft = 0;
+        bool sentOnce = false;
+    };
+
+    std::array<Slot, capacity> slots {};
+    std::size_t head = 0, tail = 0;     // monotonically increasing; index with % capacity
+    std::size_t resumeAt = 0;           // where a packet that filled up left off
+    bool partway = false;
+    std::uint32_t nextId = 0;
+    int redundancy;
+    Stats stats;
+};
+
+} // namespace dawinfo
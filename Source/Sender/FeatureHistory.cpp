@@ -0,0 +1,228 @@
+#include "Sender/FeatureHistory.h"
+#include "Sender/MemoryBudget.h"
+
+namespace dawinfo
+{
+
+namespace
+{
+    std::size_t roundUpToPowerOfTwo (std::size_t n) noexcept
+    {
+        std::size_t p = 2;
+
+        while (p < n)
+            p <<= 1;
+
+        return p;
+    }
+
+    constexpr int maxTiers = 8;
+}
+
+FeatureHistory::FeatureHistory() : FeatureHistory (Options()) {}
+
+FeatureHistory::FeatureHistory (const Options& o)
+    : numValues (std::clamp (o.numValues, 1, history::maxValues)),
+      numTiers (std::clamp (o.numTiers, 1, maxTiers)),
+      tierFactor (std::max (o.tierFactor, 2)),
+      capacity (roundUpToPowerOfTwo (o.framesPerTier)),
+      mask (capacity - 1),
+      reduction (o.reduction)
+{
+}
+
+void FeatureHistory::allocate()
+{
+    if (isAllocated())
+        return;
+
+    tiers.resize (static_cast<std::size_t> (numTiers));
+
+    for (std::size_t t = 0; t < tiers.size(); ++t)
+    {
+        tiers[t].times.resize (capacity);
+        tiers[t].values.resize (capacity * static_cast<std::size_t> (numValues));
+
+        if (t > 0)
+            tiers[t].pending.resize (static_cast<std::size_t> (numValues));
+    }
+}
+
+//==============================================================================
+void FeatureHistory::append (HostTimeNs timeNs, const float* values) noexcept
+{
+    if (! isAllocated())
+        return;
+
+    newestNs = tiers[0].count == 0 ? timeNs : std::max (timeNs, newestNs);
+    store (0, newestNs, values);
+
+    if (numTiers > 1)
+        accumulate (1, newestNs, values);
+}
+
+void FeatureHistory::store (std::size_t tier, HostTimeNs timeNs, const float* values) noexcept
+{
+    auto& t = tiers[tier];
+    const auto s = slot (t.count);
+
+    t.times[s] = timeNs;
+
+    for (std::size_t v = 0; v < static_cast<std::size_t> (numValues); ++v)
+        t.values[v * capacity + s] = values[v];
+
+    ++t.count;
+}
+
+void FeatureHistory::accumulate (std::size_t tier, HostTimeNs timeNs, const float* values) noexcept
+{
+    auto& t = tiers[tier];
+    const auto n = static_cast<std::size_t> (numValues);
+
+    if (t.numPending == 0)
+    {
+        t.pendingNs = timeNs;
+        std::copy (values, values + n, t.pending.begin());
+    }
+    else if (reduction == Reduction::max)
+    {
+        for (std::size_t v = 0; v < n; ++v)
+            t.pending[v] = std::max (t.pending[v], values[v]);
+    }
+    else
+    {
+        for (std::size_t v = 0; v < n; ++v)
+            t.pending[v] += values[v];
+    }
+
+    if (++t.numPending < tierFactor)
+        return;
+
+    if (reduction == Reduction::mean)
+        for (auto& p : t.pending)
+            p /= static_cast<float> (tierFactor);
+
+    t.numPending = 0;
+    store (tier, t.pendingNs, t.pending.data());
+
+    if (tier + 1 < tiers.size())
+        accumulate (tier + 1, t.pendingNs, t.pending.data());
+}
+
+//==============================================================================
+std::int64_t FeatureHistory::lowerBound (int tier, HostTimeNs timeNs) const noexcept
+{
+    auto lo = getBegin (tier), hi = getEnd (tier);
+
+    while (lo < hi)
+    {
+        const auto mid = lo + (hi - lo) / 2;
+
+        if (getTime (tier, mid) < timeNs)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+std::int64_t FeatureHistory::upperBound (int tier, HostTimeNs timeNs) const noexcept
+{
+    auto lo = getBegin (tier), hi = getEnd (tier);
+
+    while (lo < hi)
+    {
+        const auto mid = lo + (hi - lo) / 2;
+
+        if (getTime (tier, mid) <= timeNs)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+FeatureHistory::Range FeatureHistory::find (HostTimeNs fromNs, HostTimeNs toNs, std::int64_t maxFrames) const noexcept
+{
+    Range r;
+
+    if (tiers.empty())
+        return r;
+
+    maxFrames = std::max<std::int64_t> (maxFrames, 1);
+    Range coarsest;     // the coarsest tier with frames in the window
+
+    for (int tier = 0; tier < numTiers; ++tier)
+    {
+        r = { tier, lowerBound (tier, fromNs), upperBound (tier, toNs) };
+        r.end = std::max (r.end, r.begin);
+
+        // A coarse tier that hasn't filled its ring "reaches back", but may
+        // not have built a frame of a recent window yet.
+        if (r.size() == 0 && coarsest.size() > 0)
+            continue;
+
+        const auto oldest = getBegin (tier);
+        const bool reachesBack = oldest == 0 || getTime (tier, oldest) <= fromNs;
+
+        if (reachesBack && r.size() <= maxFrames)
+            return r;
+
+        coarsest = r;
+    }
+
+    coarsest.begin = std::max (coarsest.begin, coarsest.end - maxFrames);
+    return coarsest;
+}
+
+void FeatureHistory::writeChunk (OscWriter& w, std::int32_t token, history::Feature feature,
+                                 Range& range, std::int32_t framesPerChunk) const noexcept
+{
+    HostTimeNs times[history::maxChunkBytes / 8];
+    float values[history::maxChunkBytes / 4];
+
+    range.begin = std::max (range.begin, getBegin (range.tier));
+    range.end = std::max (range.end, range.begin);
+
+    const auto n = static_cast<std::int32_t> (std::min<std::int64_t> (range.size(),
+                                                                      std::min (framesPerChunk, history::maxFramesPerChunk (numValues))));
+
+    for (std::int32_t i = 0; i < n; ++i)
+    {
+        times[i] = getTime (range.tier, range.begin + i);
+
+        for (int v = 0; v < numValues; ++v)
+            values[i * numValues + v] = getValue (range.tier, range.begin + i, v);
+    }
+
+    range.begin += std::max (n, 0);
+
+    history::ChunkHeader h;
+    h.token = token;
+    h.feature = feature;
+    h.tier = range.tier;
+    h.numValues = numValues;
+    h.numFrames = std::max (n, 0);
+    h.isLast = range.size() == 0;
+    h.firstNs = n > 0 ? times[0] : 0;
+    history::writeChunk (w, h, times, values);
+}
+
+std::size_t FeatureHistory::getMemoryUsage() const noexcept
+{
+    std::size_t bytes = tiers.capacity() * sizeof (Tier);
+
+    for (auto& t : tiers)
+        bytes += t.times.capacity() * sizeof (HostTimeNs) + (t.values.capacity() + t.pending.capacity()) * sizeof (float);
+
+    return bytes;
+}
+
+void FeatureHistory::reportMemory (MemoryReport& report) const
+{
+    report.add (MemoryReport::pyramids, getMemoryUsage());
+}
+
+} // namespace dawinfo
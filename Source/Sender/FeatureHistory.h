@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Common/History.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+//==============================================================================
+/**
+    The recent history of one feature, levels or a spectrum, kept so that a
+    receiver that joins late can draw the last few seconds straight away.
+
+    Storage is fixed once allocated: a ring of framesPerTier frames per tier,
+    stored as columns, one of time stamps and one per value, so finding the
+    ends of a window searches one contiguous column. Tier 0 holds the
+    frames as they were appended; each frame of tier T + 1 reduces
+    tierFactor frames of tier T, by maximum or mean, and is built when the
+    last of them arrives. With the defaults, 1024 frames of levels at 60 Hz
+    is 17 s at full rate, 2.3 minutes at 8x and 18 minutes at 64x. The
+    coarser tiers lag the finest by up to one of their own frames.
+
+    A query names a time window; find() picks the finest tier that still
+    reaches back to its start without exceeding the frame limit, and
+    writeChunk() then sends the range a chunk at a time, so a long answer can
+    be spread over several sender cycles (see ControlChannel).
+
+    The storage is allocated by allocate(), so an instance whose feature
+    never runs costs only its options. Not thread safe: everything
+    runs on the sender thread.
+*/
+class FeatureHistory
+{
+public:
+    enum class Reduction
+    {
+        max,    // levels: a coarse frame shows the loudest moment it covers
+        mean    // spectra
+    };
+
+    struct Options
+    {
+        int numValues = 2;
+        std::size_t framesPerTier = 1024;   // rounded up to a power of two
+        int numTiers = 3;
+        int tierFactor = 8;
+        Reduction reduction = Reduction::max;
+    };
+
+    /** Frames [begin, end) of one tier. */
+    struct Range
+    {
+        int tier = 0;
+        std::int64_t begin = 0, end = 0;
+
+        std::int64_t size() const noexcept  { return end - begin; }
+    };
+
+    FeatureHistory();
+    explicit FeatureHistory (const Options&);
+
+    /** Allocates the tiers; later calls do nothing. */
+    void allocate();
+
+    bool isAllocated() const noexcept                   { return ! tiers.empty(); }
+
+    /** Adds a frame of numValues values. Times that go backwards are held at
+        the newest so far. Does nothing before allocate().
+    */
+    void append (HostTimeNs timeNs, const float* values) noexcept;
+
+    int getNumValues() const noexcept                   { return numValues; }
+    int getNumTiers() const noexcept                    { return numTiers; }
+    std::size_t getFramesPerTier() const noexcept       { return capacity; }
+
+    /** One past the newest frame of the tier, counted since the first append. */
+    std::int64_t getEnd (int tier) const noexcept       { return tiers.empty() ? 0 : tiers[static_cast<std::size_t> (tier)].count; }
+
+    /** The oldest frame the tier still holds. */
+    std::int64_t getBegin (int tier) const noexcept
+    {
+        return std::max<std::int64_t> (0, getEnd (tier) - static_cast<std::int64_t> (capacity));
+    }
+
+    /** For a frame in [getBegin(), getEnd()). */
+    HostTimeNs getTime (int tier, std::int64_t index) const noexcept
+    {
+        return tiers[static_cast<std::size_t> (tier)].times[slot (index)];
+    }
+
+    float getValue (int tier, std::int64_t index, int value) const noexcept
+    {
+        return tiers[static_cast<std::size_t> (tier)].values[static_cast<std::size_t> (value) * capacity + slot (index)];
+    }
+
+    /** The frames time stamped within [fromNs, toNs], from the finest tier
+        that reaches back to fromNs with at most maxFrames of them. If none
+        does, the newest maxFrames of the coarsest tier with any frames in
+        the window.
+    */
+    Range find (HostTimeNs fromNs, HostTimeNs toNs, std::int64_t maxFrames) const noexcept;
+
+    /** Writes the next chunk of the range, at most framesPerChunk frames,
+        and moves range.begin past them. Frames that have fallen out of the
+        ring since the range was found are skipped. isLast is set once the
+        range is used up.
+    */
+    void writeChunk (OscWriter&, std::int32_t token, history::Feature, Range&, std::int32_t framesPerChunk) const noexcept;
+
+    /** Heap bytes held; nothing before allocate(). */
+    std::size_t getMemoryUsage() const noexcept;
+
+    void reportMemory (MemoryReport&) const;
+
+private:
+    struct Tier
+    {
+        std::vector<HostTimeNs> times;
+        std::vector<float> values;          // column-major: numValues columns of capacity
+        std::int64_t count = 0;
+
+        // Frames of the tier below gathered so far for this tier's next frame.
+        std::vector<float> pending;
+        HostTimeNs pendingNs = 0;
+        int numPending = 0;
+    };
+
+    std::size_t slot (std::int64_t index) const noexcept    { return static_cast<std::size_t> (index) & mask; }
+
+    void store (std::size_t tier, HostTimeNs, const float* values) noexcept;
+    void accumulate (std::size_t tier, HostTimeNs, const float* values) noexcept;
+    std::int64_t lowerBound (int tier, HostTimeNs) const noexcept;
+    std::int64_t upperBound (int tier, HostTimeNs) const noexcept;
+
+    const int numValues, numTiers, tierFactor;
+    const std::size_t capacity, mask;
+    const Reduction reduction;
+
+    std::vector<Tier> tiers;
+    HostTimeNs newestNs = 0;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,158 @@
+#include "Sender/FramePublisher.h"
+#include "Common/Messages.h"
+#include "Sender/MemoryBudget.h"
+
+#include <algorithm>
+
+namespace dawinfo
+{
+
+namespace
+{
+    /** Events packets one cycle can build; a burst that needs more carries
+        on in the next cycle.
+    */
+    constexpr std::size_t maxEventPacketsPerCycle = 8;
+
+    /** Packets one cycle can build: transport plus events. */
+    constexpr std::size_t maxPacketsPerCycle = 1 + maxEventPacketsPerCycle;
+}
+
+FramePublisher::FramePublisher (std::size_t numFrames, int eventRedundancy, std::size_t maxPacket, std::size_t arenaBytes)
+    : pool (numFrames), events (eventRedundancy),
+      arena (std::max (arenaBytes, minimumArenaBytes (numFrames, maxPacket))),
+      maxPacketSize (maxPacket)
+{
+}
+
+std::size_t FramePublisher::minimumArenaBytes (std::size_t numFrames, std::size_t maxPacket) noexcept
+{
+    // Every allocation may lose up to an alignment's worth to padding.
+    const auto packetBuffers = maxPacketsPerCycle * (maxPacket + 4);
+    const auto lists = numFrames * sizeof (Frame*) + maxPacketsPerCycle * sizeof (Packet) + 2 * alignof (std::max_align_t);
+    return packetBuffers + lists;
+}
+
+FramePublisher::Frame* FramePublisher::beginFrame() noexcept
+{
+    auto* f = pool.acquire();
+
+    if (f == nullptr)
+    {
+        framesSkipped.fetch_add (1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    f->clear();
+    return f;
+}
+
+void FramePublisher::submitFrame (Frame* f) noexcept
+{
+    pool.submit (f);
+    framesSubmitted.fetch_add (1, std::memory_order_relaxed);
+}
+
+//==============================================================================
+std::size_t FramePublisher::publish (PacketSink* const* sinks, int numSinks, StreamSequencer& seq)
+{
+    auto** frames = arena.allocateArray<Frame*> (pool.getSize());
+    auto* built = arena.allocateArray<Packet> (maxPacketsPerCycle);
+
+    if (frames == nullptr || built == nullptr)
+    {
+        arena.reset();
+        return 0;
+    }
+
+    std::size_t numFrames = 0, numPackets = 0;
+
+    while (auto* f = pool.next())
+        frames[numFrames++] = f;
+
+    // Every frame's events, but only the newest transport: older ones are stale.
+    for (std::size_t i = 0; i < numFrames; ++i)
+        for (int e = 0; e < frames[i]->numEvents; ++e)
+            events.push (frames[i]->events[static_cast<std::size_t> (e)].type,
+                         frames[i]->events[static_cast<std::size_t> (e)].timeNs,
+                         frames[i]->events[static_cast<std::size_t> (e)].value);
+
+    auto build = [&] (StreamId stream, auto&& writeBody)
+    {
+        auto* buffer = static_cast<std::uint8_t*> (arena.allocate (maxPacketSize, 4));
+
+        if (buffer == nullptr)
+            return false;
+
+        OscWriter w (buffer, maxPacketSize);
+        seq.beginPacket (w, stream);
+        writeBody (w);
+
+        if (w.hasOverflowed())
+            return false;
+
+        built[numPackets++] = { w.getData(), w.getSize() };
+        return true;
+    };
+
+    if (numFrames > 0 && sendsTransport)
+        build (StreamId::transport, [&] (OscWriter& w) { schema::Codec<messages::Transport>::write (w, frames[numFrames - 1]->transport); });
+
+    // Split across packets, as PacketBatcher does, when they don't all fit in one.
+    if (events.hasPending())
+    {
+        int written = 0;
+
+        for (std::size_t p = 0; p < maxEventPacketsPerCycle; ++p)
+        {
+            if (! build (StreamId::events, [&] (OscWriter& w) { written = events.writePending (w); })
+                  || written == 0 || ! events.hasMoreToWrite())
+                break;
+        }
+    }
+
+    for (std::size_t i = 0; i < numFrames; ++i)
+        pool.recycle (frames[i]);
+
+    std::size_t sent = 0;
+
+    for (std::size_t p = 0; p < numPackets; ++p)
+    {
+        for (int s = 0; s < numSinks; ++s)
+        {
+            if (sinks[s]->send (built[p].data, built[p].size))
+            {
+                sent += built[p].size;
+                ++sends;
+            }
+        }
+    }
+
+    packets += numPackets;
+    bytes += sent;
+    ++cycles;
+    arena.reset();
+    return sent;
+}
+
+FramePublisher::Stats FramePublisher::getStats() const noexcept
+{
+    Stats s;
+    s.frames = framesSubmitted.load (std::memory_order_relaxed);
+    s.framesSkipped = framesSkipped.load (std::memory_order_relaxed);
+    s.cycles = cycles;
+    s.packets = packets;
+    s.sends = sends;
+    s.bytes = bytes;
+    s.arenaOverflows = arena.getOverflows();
+    s.arenaHighWater = arena.getHighWater();
+    return s;
+}
+
+void FramePublisher::reportMemory (MemoryReport& report) const
+{
+    report.add (MemoryReport::rings, pool.getMemoryUsage());
+    report.add (MemoryReport::packets, arena.getCapacity());
+}
+
+} // namespace dawinfo
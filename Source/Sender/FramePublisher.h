@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Common/FrameArena.h"
+#include "Common/PacketSink.h"
+#include "Common/SnapshotPool.h"
+#include "Sender/EventRedundancy.h"
+#include "Sender/StreamSequencer.h"
+
+#include <array>
+#include <atomic>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+//==============================================================================
+/**
+    The per-frame publish cycle: the block's transport state and discrete
+    events, captured on the audio thread and sent to every destination by the
+    sender thread.
+
+    The audio thread fills a Frame taken from a recycled SnapshotPool in
+    place and submits it; nothing is copied or allocated. If every frame is
+    still in flight the block is skipped and counted.
+
+    publish() drains the submitted frames, builds this cycle's packets -
+    newest transport on StreamId::transport, new and repeated events on
+    StreamId::events, split over several packets when a burst doesn't fit in
+    one - and sends each to every sink. The frame list, packet buffers and
+    packet list all come from the publisher's FrameArena, which is reset
+    when the cycle ends, so a steady-state cycle never touches the heap
+    however many sinks there are.
+*/
+class FramePublisher
+{
+public:
+    static constexpr int maxEventsPerFrame = 16;
+
+    struct Frame
+    {
+        TransportSnapshot transport;
+        int numEvents = 0;
+        std::array<DiscreteEvent, maxEventsPerFrame> events {};   // ids are assigned on publish
+
+        void clear() noexcept       { numEvents = 0; }
+
+        /** Returns false once the frame is full. */
+        bool addEvent (EventType type, HostTimeNs timeNs, float value = 0.0f) noexcept
+        {
+            if (numEvents == maxEventsPerFrame)
+                return false;
+
+            events[static_cast<std::size_t> (numEvents++)] = { 0, type, timeNs, value };
+            return true;
+        }
+    };
+
+    struct Stats
+    {
+        std::uint64_t frames = 0;           // submitted by the audio thread
+        std::uint64_t framesSkipped = 0;    // pool exhausted
+        std::uint64_t cycles = 0;
+        std::uint64_t packets = 0;          // built; each goes to every sink
+        std::uint64_t sends = 0;
+        std::uint64_t bytes = 0;            // summed over sinks
+        std::uint64_t arenaOverflows = 0;
+        std::size_t arenaHighWater = 0;
+    };
+
+    /** arenaBytes is raised to minimumArenaBytes() if it is smaller, so a
+        larger maxPacketSize can't leave the arena short of a full cycle.
+    */
+    FramePublisher (std::size_t numFrames = 8, int eventRedundancy = 2,
+                    std::size_t maxPacketSize = 1400, std::size_t arenaBytes = 16 * 1024);
+
+    /** What the busiest cycle takes from the arena: a buffer for every
+        packet it can build, plus the frame and packet lists.
+    */
+    static std::size_t minimumArenaBytes (std::size_t numFrames, std::size_t maxPacketSize) noexcept;
+
+    /** Audio thread: a cleared frame to fill, or nullptr if none is free. */
+    Frame* beginFrame() noexcept;
+
+    /** Audio thread: hands the filled frame to the sender thread. */
+    void submitFrame (Frame*) noexcept;
+
+    /** Sender thread: one cycle. Returns the bytes sent, summed over sinks. */
+    std::size_t publish (PacketSink* const* sinks, int numSinks, StreamSequencer&);
+
+    /** Sender thread: leaves transport out of the cycle's packets, for when
+        a PacedOutput sends it instead. Events are unaffected.
+    */
+    void setSendsTransport (bool shouldSend) noexcept   { sendsTransport = shouldSend; }
+
+    /** Sender thread. */
+    EventRedundancy& getEvents() noexcept           { return events; }
+    const FrameArena& getArena() const noexcept     { return arena; }
+
+    /** Sender thread (audio-thread counters are read atomically). */
+    Stats getStats() const noexcept;
+
+    /** The frame pool and its rings, and the arena. */
+    void reportMemory (MemoryReport&) const;
+
+private:
+    struct Packet
+    {
+        const std::uint8_t* data;
+        std::size_t size;
+    };
+
+    SnapshotPool<Frame> pool;
+    EventRedundancy events;
+    FrameArena arena;
+    const std::size_t maxPacketSize;
+    bool sendsTransport = true;
+
+    std::atomic<std::uint64_t> framesSubmitted { 0 }, framesSkipped { 0 };
+    std::uint64_t cycles = 0, packets = 0, sends = 0, bytes = 0;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,60 @@
+#include "Sender/MemoryBudget.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dawinfo
+{
+
+std::size_t MemoryReport::getTotal() const noexcept
+{
+    std::size_t total = 0;
+
+    for (int s = 0; s < numSubsystems; ++s)
+        if (s != shared)
+            total += bytes[static_cast<std::size_t> (s)];
+
+    return total;
+}
+
+const char* MemoryReport::getName (Subsystem s) noexcept
+{
+    switch (s)
+    {
+        case rings:         return "rings";
+        case analysis:      return "analysis";
+        case pyramids:      return "pyramids";
+        case queues:        return "queues";
+        case packets:       return "packets";
+        case state:         return "state";
+        case shared:        return "shared";
+        default:            return "";
+    }
+}
+
+//==============================================================================
+BufferSizes BufferSizes::choose (const SenderConfig& config, double sampleRate, int blockSize,
+                                 int numParameters, int samplesPerWaveformBin)
+{
+    BufferSizes sizes;
+
+    if (! config.compactMemory || sampleRate <= 0.0)
+        return sizes;
+
+    // The sender thread wakes for its fastest stream, and drains every ring each time.
+    const double drainHz = std::max ({ config.transportRateHz, config.levelsRateHz, config.spectrumRateHz });
+
+    auto fit = [&] (double perSecond, std::size_t worstCase)
+    {
+        return std::clamp (static_cast<std::size_t> (std::ceil (perSecond * compactSlack / drainHz)), std::size_t (64), worstCase);
+    };
+
+    // At most two points per parameter per block: the held value and the change.
+    const double blocksPerSecond = sampleRate / std::max (blockSize, 1);
+    sizes.parameterRing = fit (2.0 * std::max (numParameters, 1) * blocksPerSecond, sizes.parameterRing);
+    sizes.midiRing = fit (compactMidiEventsPerSecond, sizes.midiRing);
+    sizes.waveformRing = fit (sampleRate / std::max (samplesPerWaveformBin, 1), 4096);
+    return sizes;
+}
+
+} // namespace dawinfo
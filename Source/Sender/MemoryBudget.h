@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Common/Config.h"
+
+#include <array>
+#include <cstddef>
+
+namespace dawinfo
+{
+
+//==============================================================================
+/**
+    Heap bytes held by one sender instance, by subsystem.
+
+    Each component adds what it owns with reportMemory(): the storage behind
+    its rings, analysis buffers, pyramid, queues and packet buffers. The
+    objects themselves are the owner's to count, with sizeof. Figures come
+    from capacities, not from the allocator, so they are cheap to take and
+    the same on every platform; strings and other small pieces are left out.
+
+    Read-only tables shared by every instance in the process, like the
+    resampler's filter banks, go under shared and are left out of
+    getTotal(): a session pays for them once, not per instance.
+
+    Sender thread, or any thread while the sender isn't running.
+*/
+struct MemoryReport
+{
+    enum Subsystem
+    {
+        rings,          // audio-thread to sender-thread handoff
+        analysis,       // downmix and resampling buffers
+        pyramids,       // waveform and feature history
+        queues,         // per-client and outgoing packet queues
+        packets,        // packet assembly buffers and arenas
+        state,          // per-parameter, per-track and per-subscriber state
+        shared,         // process-wide read-only tables
+        numSubsystems
+    };
+
+    std::array<std::size_t, numSubsystems> bytes {};
+
+    void add (Subsystem s, std::size_t n) noexcept      { bytes[s] += n; }
+    std::size_t get (Subsystem s) const noexcept        { return bytes[s]; }
+
+    /** Everything but shared. */
+    std::size_t getTotal() const noexcept;
+
+    static const char* getName (Subsystem) noexcept;
+};
+
+//==============================================================================
+/**
+    Capacities for the rings an instance hands data across on, and how
+    they're chosen.
+
+    The defaults are sized for the worst case: 8192 MIDI events or parameter
+    points, and the waveform's whole level-0 history, waiting at once. In
+    compact mode (memory.compact = 1) each ring instead holds what the audio
+    thread produces over a few of the sender's cycles at the configured
+    rates, with room for the sender running late, which at 60 Hz is a few
+    hundred entries rather than thousands. If the sender stalls for longer
+    than that, the ring overflows and says so in its Stats.
+*/
+struct BufferSizes
+{
+    std::size_t midiRing = 8192;            // MidiForwarder ring capacity
+    std::size_t parameterRing = 8192;       // ParameterObserver ring capacity
+    std::size_t waveformRing = 0;           // WaveformPublisher::prepare(); 0 for its default
+
+    /** Drain intervals' worth of data a compact ring holds. */
+    static constexpr int compactSlack = 4;
+
+    /** The MIDI event rate a compact ring is sized for: a dense controller
+        sweep on every channel of a port.
+    */
+    static constexpr double compactMidiEventsPerSecond = 4000.0;
+
+    /** The defaults, or compact sizes when the config asks for them.
+        blockSize is the smallest block the host is expected to deliver.
+    */
+    static BufferSizes choose (const SenderConfig&, double sampleRate, int blockSize,
+                               int numParameters, int samplesPerWaveformBin = 64);
+};
+
+} // namespace dawinfo
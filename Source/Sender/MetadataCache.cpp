@@ -0,0 +1,239 @@
+#include "Sender/MetadataCache.h"
+#include "Common/Messages.h"
+#include "Sender/MemoryBudget.h"
+
+#include <algorithm>
+
+namespace dawinfo
+{
+
+namespace
+{
+    constexpr std::size_t bundleHeaderSize = 16;
+    constexpr std::size_t sequenceSize = 4 + schema::Codec<messages::Sequence>::wireSize;
+
+    std::size_t itemBudget (std::size_t maxPacketSize) noexcept
+    {
+        const auto overhead = bundleHeaderSize + sequenceSize + metadata::headerSize();
+        return maxPacketSize - std::min (maxPacketSize, overhead);
+    }
+}
+
+MetadataCache::MetadataCache (std::size_t maxPacket)
+    : maxPacketSize (std::max (maxPacket, getMinPacketSize())), buffer (maxPacketSize)
+{
+}
+
+std::size_t MetadataCache::getMinPacketSize() noexcept
+{
+    TrackInfo longest;
+    longest.name.assign (maxNameLength, ' ');
+    const auto largestItem = std::max ({ metadata::trackSize (longest), metadata::removedSize(), metadata::orderChunkSize (1) });
+    return bundleHeaderSize + sequenceSize + metadata::headerSize() + largestItem;
+}
+
+void MetadataCache::setTracks (std::vector<TrackInfo> tracksInOrder)
+{
+    for (auto& t : tracksInOrder)
+        if (t.name.size() > maxNameLength)
+            t.name.resize (maxNameLength);
+
+    const std::lock_guard<std::mutex> sl (pendingLock);
+    pending = std::move (tracksInOrder);
+    hasPending = true;
+}
+
+bool MetadataCache::takePending()
+{
+    const std::lock_guard<std::mutex> sl (pendingLock);
+
+    if (! hasPending)
+        return false;
+
+    current.swap (pending);
+    hasPending = false;
+    return true;
+}
+
+std::size_t MetadataCache::publish (PacketSink& sink, StreamSequencer& sequencer)
+{
+    const bool hasNewList = takePending();
+    const bool fullSync = fullSyncRequested.exchange (false, std::memory_order_acq_rel);
+
+    trackList.clear();
+    removedIds.clear();
+    orderChanged = false;
+
+    if (hasNewList)
+    {
+        currentIds.clear();
+
+        for (auto& t : current)
+        {
+            currentIds.push_back (t.id);
+            auto found = published.find (t.id);
+
+            if (found == published.end() || found->second != t)
+                trackList.push_back (&t);
+        }
+
+        std::sort (currentIds.begin(), currentIds.end());
+
+        for (auto id : publishedOrder)
+            if (! std::binary_search (currentIds.begin(), currentIds.end(), id))
+                removedIds.push_back (id);
+
+        orderChanged = current.size() != publishedOrder.size()
+                        || ! std::equal (current.begin(), current.end(), publishedOrder.begin(),
+                                         [] (const TrackInfo& t, std::uint32_t id) { return t.id == id; });
+
+        for (auto* t : trackList)
+            published[t->id] = *t;
+
+        for (auto id : removedIds)
+            published.erase (id);
+
+        if (orderChanged)
+        {
+            publishedOrder.clear();
+
+            for (auto& t : current)
+                publishedOrder.push_back (t.id);
+        }
+    }
+
+    const bool changed = ! trackList.empty() || ! removedIds.empty() || orderChanged;
+
+    if (! changed && ! fullSync)
+        return 0;
+
+    const auto baseVersion = version;
+
+    if (changed)
+        ++version;
+
+    if (fullSync)
+    {
+        trackList.clear();
+        removedIds.clear();
+        orderChanged = true;
+
+        for (auto id : publishedOrder)
+            trackList.push_back (&published[id]);
+    }
+
+    planItems();
+    const auto sent = sendItems (sink, sequencer, baseVersion, fullSync);
+    ++(fullSync ? stats.fullSyncs : stats.deltas);
+    return sent;
+}
+
+void MetadataCache::planItems()
+{
+    items.clear();
+
+    for (std::size_t i = 0; i < trackList.size(); ++i)
+        items.push_back ({ Item::Kind::track, i, 0, metadata::trackSize (*trackList[i]) });
+
+    for (std::size_t i = 0; i < removedIds.size(); ++i)
+        items.push_back ({ Item::Kind::removed, i, 0, metadata::removedSize() });
+
+    if (orderChanged)
+    {
+        const auto budget = itemBudget (maxPacketSize);
+        const auto idsPerChunk = std::clamp<std::size_t> ((budget - metadata::orderChunkSize (0)) / 4,
+                                                          1, metadata::maxIdsPerOrderChunk);
+        std::size_t offset = 0;
+
+        do
+        {
+            const auto n = std::min (idsPerChunk, publishedOrder.size() - offset);
+            items.push_back ({ Item::Kind::order, offset, n, metadata::orderChunkSize (n) });
+            offset += n;
+        }
+        while (offset < publishedOrder.size());
+    }
+}
+
+std::size_t MetadataCache::sendItems (PacketSink& sink, StreamSequencer& sequencer,
+                                      std::uint32_t baseVersion, bool fullSync)
+{
+    const auto budget = itemBudget (maxPacketSize);
+
+    // First pass: where each part starts.
+    partStarts.assign (1, 0);
+    std::size_t used = 0;
+
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        if (used + items[i].size > budget && used > 0)
+        {
+            partStarts.push_back (i);
+            used = 0;
+        }
+
+        used += items[i].size;
+    }
+
+    partStarts.push_back (items.size());
+
+    const auto numParts = static_cast<std::int32_t> (partStarts.size() - 1);
+    std::size_t bytes = 0;
+
+    for (std::int32_t part = 0; part < numParts; ++part)
+    {
+        OscWriter w (buffer.data(), buffer.size());
+        sequencer.beginPacket (w, StreamId::metadata);
+        metadata::writeHeader (w, { baseVersion, version, part, numParts, fullSync });
+
+        for (auto i = partStarts[static_cast<std::size_t> (part)]; i < partStarts[static_cast<std::size_t> (part) + 1]; ++i)
+        {
+            const auto& item = items[i];
+
+            switch (item.kind)
+            {
+                case Item::Kind::track:    metadata::writeTrack (w, *trackList[item.index]); break;
+                case Item::Kind::removed:  metadata::writeRemoved (w, removedIds[item.index]); break;
+                case Item::Kind::order:
+                    metadata::writeOrderChunk (w, item.index, publishedOrder.size(),
+                                               publishedOrder.data() + item.index, item.count);
+                    break;
+            }
+        }
+
+        // Every item fits in getMinPacketSize(), so this shouldn't happen; if
+        // it does, receivers can't complete this update, so the rest of it
+        // isn't sent and they get a full sync instead.
+        if (w.hasOverflowed())
+        {
+            fullSyncRequested.store (true, std::memory_order_release);
+            break;
+        }
+
+        sink.send (w.getData(), w.getSize());
+        bytes += w.getSize();
+        ++stats.packets;
+    }
+
+    stats.bytes += bytes;
+    return bytes;
+}
+
+void MetadataCache::reportMemory (MemoryReport& report) const
+{
+    std::size_t pendingCapacity = 0;
+
+    {
+        // setTracks() swaps pending on the message thread.
+        const std::lock_guard<std::mutex> sl (pendingLock);
+        pendingCapacity = pending.capacity();
+    }
+
+    report.add (MemoryReport::state, (pendingCapacity + current.capacity()) * sizeof (TrackInfo)
+                                       + (publishedOrder.capacity() + currentIds.capacity() + removedIds.capacity()) * sizeof (std::uint32_t)
+                                       + trackList.capacity() * sizeof (const TrackInfo*)
+                                       + items.capacity() * sizeof (Item) + partStarts.capacity() * sizeof (std::size_t));
+    report.add (MemoryReport::packets, buffer.capacity());
+}
+
+} // namespace dawinfo
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Common/Metadata.h"
+#include "Common/PacketSink.h"
+#include "Sender/StreamSequencer.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+/**
+    Versioned cache of track metadata that only sends what changed.
+
+    The message thread queries the host when it is told something changed and
+    hands the whole track list to setTracks(); that is the only expensive
+    part and it never touches the audio thread. The sender thread calls
+    publish(), which diffs the latest list against what it last sent and
+    writes only the changed tracks, removals and, if the order moved, the new
+    order. Each publish with changes bumps the version by one.
+
+    When a receiver joins, requestFullSync() makes the next publish resend
+    everything, flagged so receivers replace rather than patch their copy.
+*/
+class MetadataCache
+{
+public:
+    static constexpr std::size_t maxNameLength = 255;
+
+    struct Stats
+    {
+        std::uint64_t deltas = 0;
+        std::uint64_t fullSyncs = 0;
+        std::uint64_t packets = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    /** maxPacketSize is raised to getMinPacketSize() if it's smaller. */
+    explicit MetadataCache (std::size_t maxPacketSize = 1400);
+
+    /** The smallest packet that holds a header and any one item: a track
+        with a maxNameLength name.
+    */
+    static std::size_t getMinPacketSize() noexcept;
+
+    /** Message thread: the full list as queried from the host, in display order.
+        Names longer than maxNameLength are truncated.
+    */
+    void setTracks (std::vector<TrackInfo> tracksInOrder);
+
+    /** Any thread: makes the next publish() send the whole state. */
+    void requestFullSync() noexcept     { fullSyncRequested.store (true, std::memory_order_release); }
+
+    /** Sender thread: sends pending changes. Returns the number of bytes sent. */
+    std::size_t publish (PacketSink&, StreamSequencer&);
+
+    /** Sender thread: the version receivers will have after the last publish. */
+    std::uint32_t getVersion() const noexcept   { return version; }
+    const Stats& getStats() const noexcept      { return stats; }
+
+    /** Sender thread: track lists and the packet buffer; track names aren't counted. */
+    void reportMemory (MemoryReport&) const;
+
+private:
+    struct Item
+    {
+        enum class Kind { track, removed, order } kind;
+        std::size_t index;      // into trackList / removedIds / order chunk start
+        std::size_t count;      // ids, for order chunks
+        std::size_t size;
+    };
+
+    bool takePending();
+    void planItems();
+    std::size_t sendItems (PacketSink&, StreamSequencer&, std::uint32_t baseVersion, bool fullSync);
+
+    const std::size_t maxPacketSize;
+
+    mutable std::mutex pendingLock;
+    std::vector<TrackInfo> pending;
+    bool hasPending = false;
+
+    std::atomic<bool> fullSyncRequested { false };
+
+    // Sender thread state: what receivers have been told.
+    std::unordered_map<std::uint32_t, TrackInfo> published;
+    std::vector<std::uint32_t> publishedOrder;
+    std::uint32_t version = 0;
+
+    // Scratch, reused between publishes.
+    std::vector<TrackInfo> current;
+    std::vector<std::uint32_t> currentIds;     // sorted
+    std::vector<const TrackInfo*> trackList;
+    std::vector<std::uint32_t> removedIds;
+    bool orderChanged = false;
+    std::vector<Item> items;
+    std::vector<std::size_t> partStarts;
+    std::vector<std::uint8_t> buffer;
+    Stats stats;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,210 @@
+#include "Sender/MidiForwarder.h"
+#include "Common/Messages.h"
+#include "Sender/MemoryBudget.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace dawinfo
+{
+
+namespace
+{
+    std::uint32_t packFilter (const MidiForwarder::Filter& f) noexcept
+    {
+        return static_cast<std::uint32_t> (f.channelMask) | (static_cast<std::uint32_t> (f.typeMask) << 16);
+    }
+}
+
+MidiForwarder::MidiForwarder (std::size_t ringCapacity, std::size_t maxPacketSize)
+    : ring (ringCapacity),
+      filterBits (packFilter (Filter())),
+      batcher (StreamId::midi, maxPacketSize)
+{
+    heldControllers.reserve (controllers.size());
+}
+
+void MidiForwarder::setFilter (const Filter& f) noexcept
+{
+    filterBits.store (packFilter (f), std::memory_order_relaxed);
+}
+
+void MidiForwarder::setThinning (const Thinning& t) noexcept
+{
+    minIntervalNs.store (t.minIntervalNs, std::memory_order_relaxed);
+    minDelta.store (t.minDelta, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void MidiForwarder::pushBlock (const BlockMidiEvent* events, int numEvents,
+                               HostTimeNs blockStartNs, double sampleRate) noexcept
+{
+    const auto bits = filterBits.load (std::memory_order_relaxed);
+    const double nsPerSample = sampleRate > 0.0 ? 1.0e9 / sampleRate : 0.0;
+    std::uint64_t numFiltered = 0, numMalformed = 0, numOverflowed = 0;
+
+    for (int i = 0; i < numEvents; ++i)
+    {
+        const auto& in = events[i];
+
+        MidiEvent e;
+        e.status = in.size > 0 ? in.data[0] : 0;
+        e.data1 = in.size > 1 ? in.data[1] : 0;
+        e.data2 = in.size > 2 ? in.data[2] : 0;
+
+        if (e.isChannelMessage()
+             && (in.size != e.getLength() || (e.data1 | e.data2) >= 0x80))
+        {
+            // The controller table is indexed by data1, so this is a bounds check too.
+            ++numMalformed;
+            continue;
+        }
+
+        if (! e.isChannelMessage()
+             || (bits & (1u << e.getChannel())) == 0
+             || ((bits >> 16) & (1u << e.getTypeIndex())) == 0)
+        {
+            ++numFiltered;
+            continue;
+        }
+
+        e.timeNs = blockStartNs + static_cast<HostTimeNs> (std::llround (in.sampleOffset * nsPerSample));
+
+        if (! ring.push (e))
+            ++numOverflowed;
+    }
+
+    received.fetch_add (static_cast<std::uint64_t> (numEvents), std::memory_order_relaxed);
+
+    if (numFiltered > 0)
+        filtered.fetch_add (numFiltered, std::memory_order_relaxed);
+
+    if (numMalformed > 0)
+        malformed.fetch_add (numMalformed, std::memory_order_relaxed);
+
+    if (numOverflowed > 0)
+        ringOverflows.fetch_add (numOverflowed, std::memory_order_relaxed);
+}
+
+//==============================================================================
+std::size_t MidiForwarder::forward (PacketSink& s, StreamSequencer& seq, HostTimeNs nowNs)
+{
+    batcher.begin (s, seq);
+
+    const Thinning thinning { minIntervalNs.load (std::memory_order_relaxed),
+                              minDelta.load (std::memory_order_relaxed) };
+    const bool thinningEnabled = thinning.minIntervalNs > 0 || thinning.minDelta > 0;
+
+    MidiEvent e;
+
+    while (ring.pop (e))
+    {
+        if (thinningEnabled && e.isController())
+            handleController (e, thinning);
+        else
+            emit (e);
+    }
+
+    flushHeld (nowNs, thinning);
+    return batcher.end();
+}
+
+void MidiForwarder::handleController (const MidiEvent& e, const Thinning& thinning)
+{
+    const auto index = static_cast<std::size_t> (e.getChannel() * 128 + e.data1);
+    auto& c = controllers[index];
+
+    if (c.lastValue >= 0)
+    {
+        const bool isEndpoint = e.data2 == 0 || e.data2 == 127;
+
+        if (thinning.minDelta > 0 && ! isEndpoint && std::abs (e.data2 - c.lastValue) < thinning.minDelta)
+        {
+            // Back near what receivers already have: nothing worth sending,
+            // and any held value is now stale.
+            ++stats.thinnedByDelta;
+            c.hasHeld = false;
+            return;
+        }
+
+        if (thinning.minIntervalNs > 0 && e.timeNs - c.lastSentNs < thinning.minIntervalNs)
+        {
+            if (c.hasHeld)
+                ++stats.thinnedByRate;
+
+            // A delta drop clears hasHeld but leaves the index listed.
+            if (! c.isListed)
+            {
+                heldControllers.push_back (static_cast<std::uint16_t> (index));
+                c.isListed = true;
+            }
+
+            c.held = e;
+            c.hasHeld = true;
+            return;
+        }
+    }
+
+    emit (e);
+    c.lastValue = e.data2;
+    c.lastSentNs = e.timeNs;
+    c.hasHeld = false;
+}
+
+void MidiForwarder::flushHeld (HostTimeNs nowNs, const Thinning& thinning)
+{
+    std::size_t kept = 0;
+
+    for (auto index : heldControllers)
+    {
+        auto& c = controllers[index];
+
+        if (! c.hasHeld)
+        {
+            c.isListed = false;
+            continue;
+        }
+
+        if (nowNs - c.lastSentNs >= thinning.minIntervalNs)
+        {
+            emit (c.held);
+            c.lastValue = c.held.data2;
+            c.lastSentNs = c.held.timeNs;
+            c.hasHeld = false;
+            c.isListed = false;
+        }
+        else
+        {
+            heldControllers[kept++] = index;
+        }
+    }
+
+    heldControllers.resize (kept);
+}
+
+void MidiForwarder::emit (const MidiEvent& e)
+{
+    batcher.add<messages::Midi> (e);
+    ++stats.sent;
+}
+
+MidiForwarder::Stats MidiForwarder::getStats() const noexcept
+{
+    auto s = stats;
+    s.packets = batcher.getPackets();
+    s.bytes = batcher.getBytes();
+    s.received = received.load (std::memory_order_relaxed);
+    s.filtered = filtered.load (std::memory_order_relaxed);
+    s.malformed = malformed.load (std::memory_order_relaxed);
+    s.ringOverflows = ringOverflows.load (std::memory_order_relaxed);
+    return s;
+}
+
+void MidiForwarder::reportMemory (MemoryReport& report) const
+{
+    report.add (MemoryReport::rings, ring.getMemoryUsage());
+    report.add (MemoryReport::state, heldControllers.capacity() * sizeof (std::uint16_t));
+    report.add (MemoryReport::packets, batcher.getMemoryUsage());
+}
+
+} // namespace dawinfo
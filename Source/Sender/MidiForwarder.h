@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Common/Midi.h"
+#include "Common/PacketSink.h"
+#include "Common/SpscRing.h"
+#include "Sender/PacketBatcher.h"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+/** A MIDI message as the host hands it over: raw bytes at a sample offset. */
+struct BlockMidiEvent
+{
+    std::int32_t sampleOffset = 0;
+    std::uint8_t data[3] {};
+    std::uint8_t size = 0;
+};
+
+//==============================================================================
+/**
+    Forwards host MIDI to receivers alongside transport.
+
+    The audio thread calls pushBlock() with the block's events. Each one that
+    is a well-formed channel message and passes the channel/type filter is stamped with a host time derived from
+    its sample offset and copied into a preallocated lock-free ring; nothing
+    else happens there.
+
+    The sender thread calls forward(), which drains the ring, thins dense
+    controller streams and packs the rest into bundles of /dawinfo/midi
+    messages on StreamId::midi, each bundle as full as the packet size allows.
+
+    Controller thinning is per channel and controller number. A value within
+    minDelta of the last one sent is dropped (0 and 127 always pass, so the
+    ends of a sweep arrive). A value arriving sooner than minInterval after
+    the last send is held, replaced by any newer one, and sent once the
+    interval has passed, so the final position of a fast move is never lost.
+*/
+class MidiForwarder
+{
+public:
+    struct Filter
+    {
+        std::uint16_t channelMask = 0xffff;         // bit n = channel n (0-based)
+        std::uint8_t typeMask = midi::allTypes;     // see midi::TypeBits
+    };
+
+    struct Thinning
+    {
+        HostTimeNs minIntervalNs = 0;   // 0 = no rate limit
+        int minDelta = 0;               // 0 = no delta limit
+    };
+
+    struct Stats
+    {
+        std::uint64_t received = 0;         // events handed to pushBlock
+        std::uint64_t filtered = 0;
+        std::uint64_t malformed = 0;        // wrong length or data bytes >= 0x80
+        std::uint64_t ringOverflows = 0;
+        std::uint64_t thinnedByDelta = 0;
+        std::uint64_t thinnedByRate = 0;    // held values replaced by newer ones
+        std::uint64_t sent = 0;
+        std::uint64_t packets = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    explicit MidiForwarder (std::size_t ringCapacity = 8192, std::size_t maxPacketSize = 1400);
+
+    /** Any thread. */
+    void setFilter (const Filter&) noexcept;
+    void setThinning (const Thinning&) noexcept;
+
+    /** Audio thread: copies a block's events into the ring. Never blocks or allocates. */
+    void pushBlock (const BlockMidiEvent*, int numEvents, HostTimeNs blockStartNs, double sampleRate) noexcept;
+
+    /** Sender thread: drains the ring and sends. Returns the bytes sent. */
+    std::size_t forward (PacketSink&, StreamSequencer&, HostTimeNs nowNs);
+
+    /** Sender thread (audio-thread counters are read atomically). */
+    Stats getStats() const noexcept;
+
+    /** Sender thread. The controller table is part of the object, not counted here. */
+    void reportMemory (MemoryReport&) const;
+
+private:
+    struct ControllerState
+    {
+        std::int16_t lastValue = -1;
+        bool hasHeld = false;
+        bool isListed = false;          // in heldControllers, held or not
+        HostTimeNs lastSentNs = 0;
+        MidiEvent held;
+    };
+
+    void handleController (const MidiEvent&, const Thinning&);
+    void flushHeld (HostTimeNs nowNs, const Thinning&);
+    void emit (const MidiEvent&);
+
+    SpscRing<MidiEvent> ring;
+
+    std::atomic<std::uint32_t> filterBits;
+    std::atomic<HostTimeNs> minIntervalNs { 0 };
+    std::atomic<int> minDelta { 0 };
+
+    std::atomic<std::uint64_t> received { 0 }, filtered { 0 }, malformed { 0 }, ringOverflows { 0 };
+
+    // Sender thread state.
+    std::array<ControllerState, 16 * 128> controllers {};
+    std::vector<std::uint16_t> heldControllers;
+    PacketBatcher batcher;
+    Stats stats;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,40 @@
+#include "Sender/MulticastSink.h"
+
+namespace dawinfo
+{
+
+bool MulticastSink::open (const MulticastOutput& output, std::string& error)
+{
+    close();
+
+    Endpoint target, local;
+    MulticastOptions options;
+    options.ttl = output.ttl;
+    options.loopback = output.loopback;
+
+    if (! resolveEndpoint (output.group, output.port, target) || ! target.isMulticast())
+    {
+        error = "'" + output.group + "' is not a multicast group";
+        return false;
+    }
+
+    if (! output.interface.empty() && ! resolveEndpoint (output.interface, 1, local))
+    {
+        error = "bad interface address '" + output.interface + "'";
+        return false;
+    }
+
+    options.interface = local.address;
+
+    if (! socket.open() || ! socket.setMulticastOptions (options))
+    {
+        socket.close();
+        error = "couldn't open a multicast socket";
+        return false;
+    }
+
+    group = target;
+    return true;
+}
+
+} // namespace dawinfo
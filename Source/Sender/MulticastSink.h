@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Common/Config.h"
+#include "Common/UdpSocket.h"
+
+#include <string>
+
+namespace dawinfo
+{
+
+//==============================================================================
+/**
+    Sends every packet once, to a multicast group, however many receivers
+    have joined it. The network replicates it, so fanning out to a whole
+    stage of visuals costs the sender one send per packet instead of one per
+    receiver.
+
+    TTL bounds how many routers a packet crosses (1 keeps it on the local
+    subnet). The interface picks which network it leaves by on a multi-homed
+    machine. Loopback also delivers to receivers on the sending host; turn it
+    off when none run there.
+*/
+class MulticastSink : public PacketSink
+{
+public:
+    MulticastSink() = default;
+
+    /** Message thread: opens a socket for the configured group. */
+    bool open (const MulticastOutput&, std::string& error);
+    void close() noexcept                   { socket.close(); }
+
+    bool isOpen() const noexcept            { return socket.isOpen(); }
+    const Endpoint& getGroup() const noexcept   { return group; }
+
+    /** Sender thread. */
+    bool send (const std::uint8_t* data, std::size_t size) override
+    {
+        return socket.sendTo (group, data, size);
+    }
+
+private:
+    UdpSocket socket;
+    Endpoint group;
+};
+
+} // namespace dawinfo
@@ -0,0 +1,251 @@
+#include "Sender/PacedOutput.h"
+#include "Common/Clock.h"
+#include "Common/Messages.h"
+#include "Sender/MemoryBudget.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <time.h>
+
+namespace dawinfo
+{
+
+namespace
+{
+    /** Sleeps until an absolute time on the clock monotonicNowNs() reads. */
+    void sleepUntil (HostTimeNs deadline) noexcept
+    {
+        timespec ts;
+        ts.tv_sec = static_cast<time_t> (deadline / 1'000'000'000);
+        ts.tv_nsec = static_cast<long> (deadline % 1'000'000'000);
+
+        while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+        {
+        }
+    }
+
+    /** Whether b carries on smoothly from a, so positions between them can
+        be interpolated: both playing, in the same meter, and b about where
+        a's tempo would have taken it.
+    */
+    bool isContinuous (const TransportSnapshot& a, const TransportSnapshot& b) noexcept
+    {
+        if (! a.isPlaying || ! b.isPlaying || b.timeNs <= a.timeNs
+             || a.timeSigNumerator != b.timeSigNumerator || a.timeSigDenominator != b.timeSigDenominator)
+            return false;
+
+        const double expected = a.ppq + static_cast<double> (b.timeNs - a.timeNs) * a.bpm / 60.0e9;
+        return b.ppq >= a.ppq && std::abs (b.ppq - expected) < 0.1;
+    }
+
+    /** Moves the bar fields along to wherever ppq has got to. */
+    void updateBar (TransportSnapshot& s) noexcept
+    {
+        const double barLength = s.quarterNotesPerBar();
+
+        if (barLength <= 0.0)
+            return;
+
+        const double bars = std::floor ((s.ppq - s.barStartPpq) / barLength);
+        s.barStartPpq += bars * barLength;
+        s.barNumber += static_cast<std::int32_t> (bars);
+    }
+}
+
+PacedOutput::PacedOutput() : PacedOutput (Options()) {}
+
+PacedOutput::PacedOutput (const Options& o)
+    : options (o), rateHz (o.rateHz), queue (o.queueCapacity), buffer (o.maxPacketSize)
+{
+}
+
+PacedOutput::~PacedOutput()
+{
+    stop();
+}
+
+void PacedOutput::push (const TransportSnapshot& s) noexcept
+{
+    if (queue.push (s))
+        snapshots.fetch_add (1, std::memory_order_relaxed);
+    else
+        snapshotsDropped.fetch_add (1, std::memory_order_relaxed);
+}
+
+bool PacedOutput::start (std::vector<PacketSink*> newSinks)
+{
+    if (running.load())
+        return false;
+
+    sinks = std::move (newSinks);
+    running = true;
+    thread = std::thread ([this] { run(); });
+    return true;
+}
+
+void PacedOutput::stop()
+{
+    running = false;
+
+    if (thread.joinable())
+        thread.join();
+}
+
+void PacedOutput::run()
+{
+    auto deadline = monotonicNowNs();
+
+    while (running.load (std::memory_order_relaxed))
+    {
+        const auto period = static_cast<HostTimeNs> (1.0e9 / std::clamp (rateHz.load (std::memory_order_relaxed), 1.0, 1000.0));
+        deadline += period;
+        sleepUntil (deadline);
+
+        const auto now = monotonicNowNs();
+        const auto lateness = std::max<HostTimeNs> (now - deadline, 0);
+        totalLatenessNs.fetch_add (lateness, std::memory_order_relaxed);
+
+        if (lateness > maxLatenessNs.load (std::memory_order_relaxed))
+            maxLatenessNs.store (lateness, std::memory_order_relaxed);
+
+        tick (sinks.data(), static_cast<int> (sinks.size()), now);
+
+        // Ticks slept through are skipped, not sent late in a burst.
+        if (lateness >= period)
+        {
+            const auto missed = lateness / period;
+            missedTicks.fetch_add (static_cast<std::uint64_t> (missed), std::memory_order_relaxed);
+            deadline += missed * period;
+        }
+    }
+}
+
+void PacedOutput::drain() noexcept
+{
+    TransportSnapshot s;
+
+    while (queue.pop (s))
+    {
+        if (historyCount == historySize)
+        {
+            std::move (history.begin() + 1, history.end(), history.begin());
+            --historyCount;
+        }
+
+        history[historyCount++] = s;
+    }
+}
+
+//==============================================================================
+TransportSnapshot PacedOutput::extrapolate (const TransportSnapshot& from, HostTimeNs t) const noexcept
+{
+    auto s = from;
+    s.timeNs = t;
+
+    if (! from.isPlaying)
+        return s;
+
+    const auto dt = std::clamp<HostTimeNs> (t - from.timeNs, -options.maxExtrapolationNs, options.maxExtrapolationNs);
+    s.ppq = from.ppq + static_cast<double> (dt) * from.bpm / 60.0e9;
+
+    const double loopLength = from.loopEndPpq - from.loopStartPpq;
+
+    if (from.isLooping && loopLength > 0.0 && from.ppq < from.loopEndPpq && s.ppq >= from.loopEndPpq)
+        s.ppq = from.loopStartPpq + std::fmod (s.ppq - from.loopEndPpq, loopLength);
+
+    updateBar (s);
+    return s;
+}
+
+bool PacedOutput::stateAt (HostTimeNs t, TransportSnapshot& out) noexcept
+{
+    drain();
+
+    if (historyCount == 0)
+        return false;
+
+    // The newest snapshot at or before t, and the one after it if any.
+    auto i = historyCount;
+
+    while (i > 0 && history[i - 1].timeNs > t)
+        --i;
+
+    if (i == 0)
+    {
+        out = extrapolate (history[0], t);
+        extrapolated.fetch_add (1, std::memory_order_relaxed);
+        return true;
+    }
+
+    const auto& a = history[i - 1];
+
+    if (i < historyCount && isContinuous (a, history[i]))
+    {
+        const auto& b = history[i];
+        const double f = static_cast<double> (t - a.timeNs) / static_cast<double> (b.timeNs - a.timeNs);
+
+        out = a;
+        out.timeNs = t;
+        out.ppq = a.ppq + f * (b.ppq - a.ppq);
+        out.bpm = a.bpm + f * (b.bpm - a.bpm);
+        updateBar (out);
+        interpolated.fetch_add (1, std::memory_order_relaxed);
+        return true;
+    }
+
+    out = extrapolate (a, t);
+    extrapolated.fetch_add (1, std::memory_order_relaxed);
+    return true;
+}
+
+std::size_t PacedOutput::tick (PacketSink* const* sinks, int numSinks, HostTimeNs nowNs)
+{
+    ticks.fetch_add (1, std::memory_order_relaxed);
+
+    TransportSnapshot state;
+
+    if (! stateAt (nowNs - options.delayNs, state))
+        return 0;
+
+    OscWriter w (buffer.data(), buffer.size());
+    sequencer.beginPacket (w, StreamId::transport);
+    schema::Codec<messages::Transport>::write (w, state);
+
+    if (w.hasOverflowed())
+        return 0;
+
+    std::size_t sent = 0;
+
+    for (int i = 0; i < numSinks; ++i)
+        if (sinks[i]->send (w.getData(), w.getSize()))
+            sent += w.getSize();
+
+    packets.fetch_add (1, std::memory_order_relaxed);
+    bytes.fetch_add (sent, std::memory_order_relaxed);
+    return sent;
+}
+
+PacedOutput::Stats PacedOutput::getStats() const noexcept
+{
+    Stats s;
+    s.snapshots = snapshots.load (std::memory_order_relaxed);
+    s.snapshotsDropped = snapshotsDropped.load (std::memory_order_relaxed);
+    s.ticks = ticks.load (std::memory_order_relaxed);
+    s.missedTicks = missedTicks.load (std::memory_order_relaxed);
+    s.interpolated = interpolated.load (std::memory_order_relaxed);
+    s.extrapolated = extrapolated.load (std::memory_order_relaxed);
+    s.packets = packets.load (std::memory_order_relaxed);
+    s.bytes = bytes.load (std::memory_order_relaxed);
+    s.maxLatenessNs = maxLatenessNs.load (std::memory_order_relaxed);
+    s.totalLatenessNs = totalLatenessNs.load (std::memory_order_relaxed);
+    return s;
+}
+
+void PacedOutput::reportMemory (MemoryReport& report) const
+{
+    report.add (MemoryReport::rings, queue.getMemoryUsage());
+    report.add (MemoryReport::packets, buffer.capacity());
+}
+
+} // namespace dawinfo
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Common/PacketSink.h"
+#include "Common/SpscRing.h"
+#include "Sender/StreamSequencer.h"
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+//==============================================================================
+/**
+    Sends transport on a steady clock of its own instead of whenever the
+    host's blocks happen to arrive.
+
+    Left to the host, output follows the buffer size: a 1024-sample buffer
+    delivers state in bursts every 21 ms, a 32-sample one floods the network
+    with 1500 packets a second. Here the audio thread only pushes each
+    block's timestamped snapshot into a wait-free queue. The pacing thread,
+    started by start(), wakes on absolute deadlines from clock_nanosleep on
+    the monotonic clock, so it neither drifts nor bunches up, and at each
+    tick sends the transport as it stands at that instant: interpolated
+    between the two snapshots either side when it has them, otherwise
+    extrapolated from the newest along its tempo and wrapped into the loop.
+    A locate, loop wrap or play/stop between two snapshots is never smoothed
+    over.
+
+    Options::delayNs trades latency for accuracy. At 0 each tick reports the
+    present, which usually means extrapolating; set it to about a host block
+    and the tick reports a moment that already lies between two snapshots.
+
+    The pacing thread owns its own sequence numbers on StreamId::transport,
+    so the FramePublisher should stop sending transport (setSendsTransport).
+    The sinks are called from the pacing thread while the sender thread may
+    be calling them too, so give it sinks that allow that, such as the UDP
+    and multicast sinks, or sinks of its own.
+*/
+class PacedOutput
+{
+public:
+    struct Options
+    {
+        double rateHz = 60.0;
+        HostTimeNs delayNs = 0;
+        HostTimeNs maxExtrapolationNs = 250'000'000;    // past this, hold rather than guess
+        std::size_t queueCapacity = 64;
+        std::size_t maxPacketSize = 1400;
+    };
+
+    struct Stats
+    {
+        std::uint64_t snapshots = 0;            // audio thread
+        std::uint64_t snapshotsDropped = 0;     // queue full
+        std::uint64_t ticks = 0;                // pacing thread
+        std::uint64_t missedTicks = 0;          // woke too late for them
+        std::uint64_t interpolated = 0;
+        std::uint64_t extrapolated = 0;
+        std::uint64_t packets = 0;
+        std::uint64_t bytes = 0;                // summed over sinks
+        HostTimeNs maxLatenessNs = 0;           // wake-up after the deadline
+        HostTimeNs totalLatenessNs = 0;
+    };
+
+    PacedOutput();
+    explicit PacedOutput (const Options&);
+    ~PacedOutput();
+
+    /** Audio thread: the block's transport. Wait-free; dropped and counted
+        if the pacing thread has fallen a whole queue behind.
+    */
+    void push (const TransportSnapshot&) noexcept;
+
+    /** Starts the pacing thread, sending to the given sinks, which must
+        outlive it. Returns false if it is already running.
+    */
+    bool start (std::vector<PacketSink*> sinks);
+    void stop();
+    bool isRunning() const noexcept     { return running.load (std::memory_order_relaxed); }
+
+    /** Any thread: takes effect from the next tick. */
+    void setRate (double hz) noexcept   { rateHz.store (hz, std::memory_order_relaxed); }
+
+    /** Pacing thread, or a caller driving it by hand while it isn't running:
+        takes the queued snapshots and sends the state at nowNs - delayNs.
+        Returns the bytes sent, summed over sinks.
+    */
+    std::size_t tick (PacketSink* const* sinks, int numSinks, HostTimeNs nowNs);
+
+    /** Pacing thread: the transport at a given time, from the snapshots
+        taken so far. Returns false before the first snapshot.
+    */
+    bool stateAt (HostTimeNs, TransportSnapshot&) noexcept;
+
+    /** Any thread; counters are read atomically. */
+    Stats getStats() const noexcept;
+
+    void reportMemory (MemoryReport&) const;
+
+private:
+    static constexpr std::size_t historySize = 8;
+
+    void run();
+    void drain() noexcept;
+    TransportSnapshot extrapolate (const TransportSnapshot&, HostTimeNs) const noexcept;
+
+    const Options options;
+    std::atomic<double> rateHz;
+
+    SpscRing<TransportSnapshot> queue;
+    std::atomic<std::uint64_t> snapshots { 0 }, snapshotsDropped { 0 };
+
+    // Pacing thread: the newest snapshots, oldest first.
+    std::array<TransportSnapshot, historySize> history {};
+    std::size_t historyCount = 0;
+
+    std::vector<PacketSink*> sinks;
+    StreamSequencer sequencer;
+    std::vector<std::uint8_t> buffer;
+
+    std::thread thread;
+    std::atomic<bool> running { false };
+
+    std::atomic<std::uint64_t> ticks { 0 }, missedTicks { 0 }, interpolated { 0 }, extrapolated { 0 },
+                               packets { 0 }, bytes { 0 };
+    std::atomic<HostTimeNs> maxLatenessNs { 0 }, totalLatenessNs { 0 };
+};
+
+} // namespace dawinfo
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Common/PacketSink.h"
+#include "Common/Schema.h"
+#include "Sender/StreamSequencer.h"
+
+#include <vector>
+
+namespace dawinfo
+{
+
+/**
+    Packs schema messages for one stream into bundles no larger than the
+    packet size, opening a new sequenced bundle whenever the current one is
+    full. Used by the sender-thread stages that emit many small messages.
+
+    Call begin() with the round's sink and sequencer, add() messages, then
+    end() to send whatever is left.
+*/
+class PacketBatcher
+{
+public:
+    PacketBatcher (StreamId stream, std::size_t maxPacketSize)
+        : stream (stream), buffer (maxPacketSize), writer (buffer.data(), buffer.size())
+    {
+    }
+
+    void begin (PacketSink& s, StreamSequencer& seq) noexcept
+    {
+        sink = &s;
+        sequencer = &seq;
+        bytesThisRound = 0;
+    }
+
+    template <typename Msg>
+    void add (const typename Msg::Value& value)
+    {
+        constexpr auto size = 4 + schema::Codec<Msg>::wireSize;
+
+        if (packetOpen && writer.getSize() + size > writer.getCapacity())
+            flush();
+
+        if (! packetOpen)
+        {
+            sequencer->beginPacket (writer, stream);
+            packetOpen = true;
+        }
+
+        schema::Codec<Msg>::write (writer, value);
+        ++messages;
+    }
+
+    /** Sends the open packet, if any. A packet that overflowed (a packet
+        size too small for even one message) is dropped rather than sent cut short.
+    */
+    void flush()
+    {
+        if (! packetOpen)
+            return;
+
+        packetOpen = false;
+
+        if (writer.hasOverflowed())
+            return;
+
+        sink->send (writer.getData(), writer.getSize());
+        bytesThisRound += writer.getSize();
+        bytes += writer.getSize();
+        ++packets;
+    }
+
+    /** Flushes and returns the bytes sent since begin(). */
+    std::size_t end()
+    {
+        flush();
+        return bytesThisRound;
+    }
+
+    std::uint64_t getPackets() const noexcept   { return packets; }
+    std::uint64_t getBytes() const noexcept     { return bytes; }
+    std::uint64_t getMessages() const noexcept  { return messages; }
+    std::size_t getMemoryUsage() const noexcept { return buffer.capacity(); }
+
+private:
+    const StreamId stream;
+    std::vector<std::uint8_t> buffer;
+    OscWriter writer;
+    PacketSink* sink = nullptr;
+    StreamSequencer* sequencer = nullptr;
+    bool packetOpen = false;
+    std::size_t bytesThisRound = 0;
+    std::uint64_t packets = 0, bytes = 0, messages = 0;
+};
+
+} // namespace dawinfo
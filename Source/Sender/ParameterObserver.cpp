@@ -0,0 +1,198 @@
+#include "Sender/ParameterObserver.h"
+#include "Common/Messages.h"
+#include "Sender/MemoryBudget.h"
+
+#include <algorithm>
+
+namespace dawinfo
+{
+
+ParameterObserver::ParameterObserver (int numParameters, std::size_t ringCapacity, std::size_t maxPacketSize)
+    : ring (ringCapacity),
+      audioState (static_cast<std::size_t> (std::max (numParameters, 0))),
+      lanes (audioState.size()),
+      batcher (StreamId::parameters, maxPacketSize)
+{
+    activeLanes.reserve (lanes.size());
+}
+
+//==============================================================================
+void ParameterObserver::observe (int index, float value, HostTimeNs timeNs) noexcept
+{
+    if (index < 0 || static_cast<std::size_t> (index) >= audioState.size())
+        return;
+
+    auto& s = audioState[static_cast<std::size_t> (index)];
+    const bool changed = ! s.seen || value != s.lastValue;
+    std::uint64_t numQueued = 0, numOverflowed = 0;
+
+    auto push = [&] (float v, HostTimeNs t)
+    {
+        if (ring.push ({ index, v, t }))
+            ++numQueued;
+        else
+            ++numOverflowed;
+    };
+
+    if (changed)
+    {
+        // The value held until the block before this one.
+        if (s.seen && ! s.lastQueued)
+            push (s.lastValue, s.lastTimeNs);
+
+        push (value, timeNs);
+    }
+
+    s.lastValue = value;
+    s.lastTimeNs = timeNs;
+    s.seen = true;
+    s.lastQueued = changed;
+
+    if (numQueued > 0)
+        queued.fetch_add (numQueued, std::memory_order_relaxed);
+
+    if (numOverflowed > 0)
+        ringOverflows.fetch_add (numOverflowed, std::memory_order_relaxed);
+}
+
+//==============================================================================
+std::size_t ParameterObserver::publish (PacketSink& s, StreamSequencer& seq, HostTimeNs nowNs)
+{
+    batcher.begin (s, seq);
+
+    Point p;
+
+    while (ring.pop (p))
+    {
+        auto& lane = lanes[static_cast<std::size_t> (p.index)];
+
+        // Listed once, even when addPoint() drops an out-of-order point and
+        // leaves the lane looking unlisted.
+        if (! lane.isActive)
+        {
+            activeLanes.push_back (p.index);
+            lane.isActive = true;
+        }
+
+        addPoint (lane, p.index, p.timeNs, p.value);
+    }
+
+    std::size_t kept = 0;
+
+    for (auto index : activeLanes)
+    {
+        auto& lane = lanes[static_cast<std::size_t> (index)];
+        const auto latestNs = lane.hasLast ? lane.lastNs : lane.anchorNs;
+
+        if (nowNs - latestNs < options.idleFlushNs)
+        {
+            activeLanes[kept++] = index;
+            continue;
+        }
+
+        lane.isActive = false;
+
+        if (lane.hasLast)
+        {
+            closeSegment (lane, index);
+        }
+        else if (! lane.anchorSent)
+        {
+            // A lone value: send it as a point.
+            const auto v = static_cast<float> (lane.anchorValue);
+            batcher.add<messages::Parameter> ({ index, lane.anchorNs, 0, v, v });
+            ++segments;
+            lane.anchorSent = true;
+        }
+    }
+
+    activeLanes.resize (kept);
+    return batcher.end();
+}
+
+void ParameterObserver::addPoint (Lane& lane, std::int32_t index, HostTimeNs timeNs, double value)
+{
+    if (! lane.hasAnchor)
+    {
+        lane.hasAnchor = true;
+        lane.anchorSent = false;
+        lane.hasLast = false;
+        lane.anchorNs = timeNs;
+        lane.anchorValue = value;
+        return;
+    }
+
+    if (timeNs <= (lane.hasLast ? lane.lastNs : lane.anchorNs))
+        return;     // out of order after an overflow; nothing sensible to do with it
+
+    const double tolerance = options.tolerance;
+    auto dt = static_cast<double> (timeNs - lane.anchorNs);
+    double low = (value - tolerance - lane.anchorValue) / dt;
+    double high = (value + tolerance - lane.anchorValue) / dt;
+
+    if (lane.hasLast)
+    {
+        const bool tooLong = timeNs - lane.anchorNs > options.maxSegmentNs;
+        const auto narrowedLow = std::max (low, lane.slopeLow);
+        const auto narrowedHigh = std::min (high, lane.slopeHigh);
+
+        if (tooLong || narrowedLow > narrowedHigh)
+        {
+            // The door has closed: finish at the previous point and start
+            // again from where that segment ends.
+            closeSegment (lane, index);
+            dt = static_cast<double> (timeNs - lane.anchorNs);
+            low = (value - tolerance - lane.anchorValue) / dt;
+            high = (value + tolerance - lane.anchorValue) / dt;
+        }
+        else
+        {
+            low = narrowedLow;
+            high = narrowedHigh;
+        }
+    }
+
+    lane.slopeLow = low;
+    lane.slopeHigh = high;
+    lane.lastNs = timeNs;
+    lane.lastValue = value;
+    lane.hasLast = true;
+}
+
+void ParameterObserver::closeSegment (Lane& lane, std::int32_t index)
+{
+    const auto durationNs = lane.lastNs - lane.anchorNs;
+    const auto direct = (lane.lastValue - lane.anchorValue) / static_cast<double> (durationNs);
+    const auto slope = std::clamp (direct, lane.slopeLow, lane.slopeHigh);
+    const auto endValue = lane.anchorValue + slope * static_cast<double> (durationNs);
+
+    batcher.add<messages::Parameter> ({ index, lane.anchorNs, durationNs,
+                                        static_cast<float> (lane.anchorValue), static_cast<float> (endValue) });
+    ++segments;
+
+    lane.anchorNs = lane.lastNs;
+    lane.anchorValue = static_cast<float> (endValue);
+    lane.anchorSent = true;
+    lane.hasLast = false;
+}
+
+ParameterObserver::Stats ParameterObserver::getStats() const noexcept
+{
+    Stats s;
+    s.points = queued.load (std::memory_order_relaxed);
+    s.ringOverflows = ringOverflows.load (std::memory_order_relaxed);
+    s.segments = segments;
+    s.packets = batcher.getPackets();
+    s.bytes = batcher.getBytes();
+    return s;
+}
+
+void ParameterObserver::reportMemory (MemoryReport& report) const
+{
+    report.add (MemoryReport::rings, ring.getMemoryUsage());
+    report.add (MemoryReport::state, audioState.capacity() * sizeof (AudioState) + lanes.capacity() * sizeof (Lane)
+                                       + activeLanes.capacity() * sizeof (std::int32_t));
+    report.add (MemoryReport::packets, batcher.getMemoryUsage());
+}
+
+} // namespace dawinfo
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Common/PacketSink.h"
+#include "Common/Parameters.h"
+#include "Common/SpscRing.h"
+#include "Sender/PacketBatcher.h"
+
+#include <atomic>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+//==============================================================================
+/**
+    Mirrors plugin parameter automation as piecewise-linear segments.
+
+    The audio thread calls observe() once per block for every watched
+    parameter. Only changes are queued: a value that differs from the last
+    one, plus the last held value just before it, so a step after a long
+    hold lands where it happened rather than ramping across the hold.
+
+    The sender thread calls publish(), which drains the queue and compresses
+    each parameter's points with a swinging-door filter: a segment grows for
+    as long as one straight line stays within the tolerance of every point it
+    covers, then is sent as /dawinfo/param on StreamId::parameters. Each
+    segment starts where the previous one ended, so receivers see a
+    continuous curve. A segment is also closed once it spans maxSegment, so
+    receivers never lag a long ramp by more than that, and when a parameter
+    has been still for idleFlush, so the end of a move arrives promptly.
+*/
+class ParameterObserver
+{
+public:
+    struct Options
+    {
+        float tolerance = 0.002f;                   // in parameter units (usually 0..1)
+        HostTimeNs maxSegmentNs = 250000000;
+        HostTimeNs idleFlushNs = 30000000;
+    };
+
+    struct Stats
+    {
+        std::uint64_t points = 0;           // changes queued by the audio thread
+        std::uint64_t ringOverflows = 0;
+        std::uint64_t segments = 0;
+        std::uint64_t packets = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    explicit ParameterObserver (int numParameters, std::size_t ringCapacity = 8192, std::size_t maxPacketSize = 1400);
+
+    /** Sender thread. */
+    void setOptions (const Options& o) noexcept     { options = o; }
+
+    /** Audio thread: records the parameter's value for this block. Never
+        blocks or allocates. Indexes outside [0, numParameters) are ignored.
+    */
+    void observe (int index, float value, HostTimeNs timeNs) noexcept;
+
+    /** Sender thread: drains the queue and sends any finished segments.
+        Returns the bytes sent.
+    */
+    std::size_t publish (PacketSink&, StreamSequencer&, HostTimeNs nowNs);
+
+    /** Sender thread (audio-thread counters are read atomically). */
+    Stats getStats() const noexcept;
+
+    /** Sender thread. */
+    void reportMemory (MemoryReport&) const;
+
+private:
+    struct Point
+    {
+        std::int32_t index;
+        float value;
+        HostTimeNs timeNs;
+    };
+
+    struct AudioState
+    {
+        float lastValue = 0.0f;
+        HostTimeNs lastTimeNs = 0;
+        bool seen = false;
+        bool lastQueued = false;
+    };
+
+    struct Lane
+    {
+        bool hasAnchor = false, anchorSent = false, hasLast = false;
+        bool isActive = false;                  // in activeLanes
+        HostTimeNs anchorNs = 0, lastNs = 0;
+        double anchorValue = 0, lastValue = 0;
+        double slopeLow = 0, slopeHigh = 0;     // per ns
+    };
+
+    void addPoint (Lane&, std::int32_t index, HostTimeNs timeNs, double value);
+    void closeSegment (Lane&, std::int32_t index);
+
+    SpscRing<Point> ring;
+    std::atomic<std::uint64_t> queued { 0 }, ringOverflows { 0 };
+
+    // Audio thread state.
+    std::vector<AudioState> audioState;
+
+    // Sender thread state.
+    Options options;
+    std::vector<Lane> lanes;
+    std::vector<std::int32_t> activeLanes;      // lanes with points not yet sent
+    PacketBatcher batcher;
+    std::uint64_t segments = 0;
+};
+
+} // namespace dawinfo
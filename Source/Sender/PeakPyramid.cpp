@@ -0,0 +1,63 @@
+#include "Sender/PeakPyramid.h"
+
+namespace dawinfo
+{
+
+namespace
+{
+    int log2Ceil (std::size_t n) noexcept
+    {
+        int shift = 1;
+
+        while ((std::size_t (1) << shift) < n)
+            ++shift;
+
+        return shift;
+    }
+}
+
+PeakPyramid::PeakPyramid (int channels, int numLevels, std::size_t bins)
+    : numChannels (std::clamp (channels, 1, peaks::maxChannels)),
+      binsPerLevel (std::size_t (1) << log2Ceil (bins)),
+      mask (binsPerLevel - 1),
+      levelShift (log2Ceil (bins)),
+      counts (static_cast<std::size_t> (std::max (numLevels, 1)), 0)
+{
+}
+
+void PeakPyramid::allocate()
+{
+    if (! isAllocated())
+        storage.resize (binsPerLevel * counts.size() * static_cast<std::size_t> (numChannels));
+}
+
+void PeakPyramid::append (const PeakBin* bins) noexcept
+{
+    if (! isAllocated())
+        return;
+
+    const auto n = static_cast<std::size_t> (numChannels);
+
+    std::copy (bins, bins + n, storage.begin() + static_cast<std::ptrdiff_t> (slotOffset (0, counts[0])));
+    ++counts[0];
+
+    // Each completed pair becomes a bin of the level above.
+    for (int level = 0; level + 1 < getNumLevels() && (counts[static_cast<std::size_t> (level)] & 1) == 0; ++level)
+    {
+        const auto end = counts[static_cast<std::size_t> (level)];
+        const auto* first = getBin (level, end - 2);
+        const auto* second = getBin (level, end - 1);
+        auto& above = counts[static_cast<std::size_t> (level) + 1];
+        auto* out = storage.data() + slotOffset (level + 1, above);
+
+        for (std::size_t c = 0; c < n; ++c)
+        {
+            out[c] = first[c];
+            out[c].merge (second[c]);
+        }
+
+        ++above;
+    }
+}
+
+} // namespace dawinfo
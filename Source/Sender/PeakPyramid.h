@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Common/Peaks.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace dawinfo
+{
+
+/**
+    Multi-resolution min/max summary of an audio stream, like a mipmap.
+
+    Level 0 holds the bins it is fed; each bin of level L + 1 merges two of
+    level L and is built the moment its second half arrives, so every level
+    is always current. Each level keeps its most recent binsPerLevel bins in
+    a ring; older bins fall off. The storage is allocated by allocate(), so
+    a pyramid that is never used costs only its counters.
+
+    Not thread safe.
+*/
+class PeakPyramid
+{
+public:
+    /** binsPerLevel is rounded up to a power of two, and at least 2. */
+    PeakPyramid (int numChannels, int numLevels, std::size_t binsPerLevel);
+
+    /** Allocates the storage; later calls do nothing. */
+    void allocate();
+
+    bool isAllocated() const noexcept               { return ! storage.empty(); }
+
+    /** Adds one level-0 bin: numChannels entries. Does nothing before allocate(). */
+    void append (const PeakBin* bins) noexcept;
+
+    int getNumChannels() const noexcept             { return numChannels; }
+    int getNumLevels() const noexcept               { return static_cast<int> (counts.size()); }
+    std::size_t getBinsPerLevel() const noexcept    { return binsPerLevel; }
+
+    std::size_t getMemoryUsage() const noexcept
+    {
+        return storage.capacity() * sizeof (PeakBin) + counts.capacity() * sizeof (std::int64_t);
+    }
+
+    /** One past the newest complete bin at the level. */
+    std::int64_t getEnd (int level) const noexcept  { return counts[static_cast<std::size_t> (level)]; }
+
+    /** The oldest bin the level still holds. */
+    std::int64_t getBegin (int level) const noexcept
+    {
+        return std::max<std::int64_t> (0, getEnd (level) - static_cast<std::int64_t> (binsPerLevel));
+    }
+
+    /** numChannels entries for the bin, which must lie in [getBegin(), getEnd()). */
+    const PeakBin* getBin (int level, std::int64_t index) const noexcept
+    {
+        return storage.data() + slotOffset (level, index);
+    }
+
+private:
+    std::size_t slotOffset (int level, std::int64_t index) const noexcept
+    {
+        return ((static_cast<std::size_t> (level) << levelShift) + (static_cast<std::size_t> (index) & mask))
+                 * static_cast<std::size_t> (numChannels);
+    }
+
+    const int numChannels;
+    const std::size_t binsPerLevel, mask;
+    const int levelShift;
+    std::vector<PeakBin> storage;
+    std::vector<std::int64_t> counts;
+};
+
+} // namespace dawinfo
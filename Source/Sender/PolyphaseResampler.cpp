@@ -0,0 +1,253 @@
+#include "Sender/PolyphaseResampler.h"
+#include "Common/Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <numeric>
+
+namespace dawinfo
+{
+
+namespace
+{
+    constexpr int maxChannels = 16;
+    constexpr double kaiserBeta = 8.0;      // about 80 dB stop band
+    constexpr double passbandShare = 0.9;   // cut-off, as a share of the lower Nyquist frequency
+
+    constexpr double pi = 3.14159265358979323846;
+
+    double besselI0 (double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 64 && term > 1.0e-12 * sum; ++k)
+        {
+            const double t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    bool toWholeRate (double rate, long long& out) noexcept
+    {
+        out = std::llround (rate);
+        return rate > 0.0 && std::abs (rate - static_cast<double> (out)) < 1.0e-6;
+    }
+
+    float dot (const float* a, const float* b, int n) noexcept
+    {
+        auto acc0 = simd::Float4::zero(), acc1 = simd::Float4::zero();
+        int i = 0;
+
+        for (; i + 8 <= n; i += 8)
+        {
+            acc0 += simd::Float4::load (a + i) * simd::Float4::load (b + i);
+            acc1 += simd::Float4::load (a + i + 4) * simd::Float4::load (b + i + 4);
+        }
+
+        for (; i + 4 <= n; i += 4)
+            acc0 += simd::Float4::load (a + i) * simd::Float4::load (b + i);
+
+        float sum = (acc0 + acc1).sum();
+
+        for (; i < n; ++i)
+            sum += a[i] * b[i];
+
+        return sum;
+    }
+
+    /** Phase p applies h[p + k*up] to the input k frames back; stored oldest first. */
+    std::vector<float> designBank (int up, int down, int taps)
+    {
+        if (up == 1 && down == 1)
+            return std::vector<float> (1, 1.0f);
+
+        const int length = taps * up;
+        const double cutoff = 0.5 * passbandShare / std::max (up, down);     // cycles per upsampled sample
+        const double centre = (length - 1) / 2.0;
+        const double windowScale = 1.0 / besselI0 (kaiserBeta);
+        std::vector<double> prototype (static_cast<std::size_t> (length));
+
+        for (int i = 0; i < length; ++i)
+        {
+            const double t = i - centre;
+            const double x = 2.0 * cutoff * t;
+            const double sinc = std::abs (x) < 1.0e-12 ? 1.0 : std::sin (pi * x) / (pi * x);
+            const double r = t / (centre > 0.0 ? centre : 1.0);
+            const double window = besselI0 (kaiserBeta * std::sqrt (std::max (0.0, 1.0 - r * r))) * windowScale;
+            prototype[static_cast<std::size_t> (i)] = up * 2.0 * cutoff * sinc * window;
+        }
+
+        std::vector<float> bank (static_cast<std::size_t> (length), 0.0f);
+
+        for (int p = 0; p < up; ++p)
+            for (int j = 0; j < taps; ++j)
+                bank[static_cast<std::size_t> (p * taps + j)] = static_cast<float> (prototype[static_cast<std::size_t> (p + (taps - 1 - j) * up)]);
+
+        return bank;
+    }
+
+    /** Every resampler with the same ratio and length shares one bank, made
+        by the first: an instance on each track, or a host scanning plugins
+        over and over, designs it once. Banks are kept for the life of the
+        process: there are only as many as rate pairs in use, typically a
+        few tens of kilobytes each.
+    */
+    std::shared_ptr<const std::vector<float>> findBank (int up, int down, int taps)
+    {
+        struct Entry
+        {
+            int up, down, taps;
+            std::shared_ptr<const std::vector<float>> bank;
+        };
+
+        static std::mutex lock;
+        static std::vector<Entry> cache;
+
+        std::lock_guard<std::mutex> scoped (lock);
+
+        for (auto& e : cache)
+            if (e.up == up && e.down == down && e.taps == taps)
+                return e.bank;
+
+        auto bank = std::make_shared<const std::vector<float>> (designBank (up, down, taps));
+        cache.push_back ({ up, down, taps, bank });
+        return bank;
+    }
+}
+
+bool PolyphaseResampler::prepare (double inputRate, double outputRate, int channels, int maxInputFrames, int tapsPerPhase)
+{
+    long long in = 0, out = 0;
+
+    if (! toWholeRate (inputRate, in) || ! toWholeRate (outputRate, out)
+         || channels < 1 || channels > maxChannels || maxInputFrames < 1
+         || tapsPerPhase < 4 || tapsPerPhase > 256)
+        return false;
+
+    const auto common = std::gcd (in, out);
+
+    if (out / common > maxUpFactor)
+        return false;
+
+    up = static_cast<int> (out / common);
+    down = static_cast<int> (in / common);
+    numChannels = channels;
+    maxInput = maxInputFrames;
+    maxOutput = getMaxOutputFrames (maxInput);
+
+    if (up == 1 && down == 1)
+    {
+        taps = 1;
+    }
+    else
+    {
+        // Wider phases when decimating keep the transition band the same width in output terms.
+        const int widened = static_cast<int> (std::ceil (tapsPerPhase * std::max (1.0, static_cast<double> (down) / up)));
+        taps = (widened + 3) / 4 * 4;
+    }
+
+    bank = findBank (up, down, taps);
+
+    history.assign (static_cast<std::size_t> (numChannels), std::vector<float> (static_cast<std::size_t> (taps + maxInput)));
+    reset();
+    return true;
+}
+
+std::size_t PolyphaseResampler::getMemoryUsage() const noexcept
+{
+    std::size_t bytes = history.capacity() * sizeof (std::vector<float>);
+
+    for (auto& h : history)
+        bytes += h.capacity() * sizeof (float);
+
+    return bytes;
+}
+
+void PolyphaseResampler::reset() noexcept
+{
+    for (auto& h : history)
+        std::fill (h.begin(), h.end(), 0.0f);
+
+    filled = taps - 1;
+    phase = 0;
+}
+
+int PolyphaseResampler::getMaxOutputFrames (int numInputFrames) const noexcept
+{
+    // The phase carries across pieces, so a long block makes no more than one piece would.
+    return static_cast<int> ((static_cast<long long> (std::max (numInputFrames, 0)) * up + down - 1) / down) + 1;
+}
+
+double PolyphaseResampler::getLatency() const noexcept
+{
+    return (taps * up - 1) / 2.0 / down;
+}
+
+//==============================================================================
+int PolyphaseResampler::process (const float* const* in, int numFrames, float* const* out) noexcept
+{
+    if (taps == 0)
+        return 0;
+
+    const float* input[maxChannels];
+    float* output[maxChannels];
+    int written = 0;
+
+    for (int start = 0; start < numFrames; start += maxInput)
+    {
+        for (int c = 0; c < numChannels; ++c)
+        {
+            input[c] = in[c] != nullptr ? in[c] + start : nullptr;
+            output[c] = out[c] + written;
+        }
+
+        written += processChunk (input, std::min (maxInput, numFrames - start), output);
+    }
+
+    return written;
+}
+
+int PolyphaseResampler::processChunk (const float* const* in, int numFrames, float* const* out) noexcept
+{
+    for (int c = 0; c < numChannels; ++c)
+    {
+        float* dest = history[static_cast<std::size_t> (c)].data() + filled;
+
+        if (in[c] != nullptr)
+            std::memcpy (dest, in[c], static_cast<std::size_t> (numFrames) * sizeof (float));
+        else
+            std::fill (dest, dest + numFrames, 0.0f);
+    }
+
+    filled += numFrames;
+
+    int produced = 0, position = 0;
+
+    while (position + taps <= filled)
+    {
+        const float* coefficients = bank->data() + static_cast<std::size_t> (phase * taps);
+
+        for (int c = 0; c < numChannels; ++c)
+            out[c][produced] = dot (coefficients, history[static_cast<std::size_t> (c)].data() + position, taps);
+
+        ++produced;
+        phase += down;
+        position += phase / up;
+        phase %= up;
+    }
+
+    // Keep what the next outputs still need.
+    filled -= position;
+
+    for (auto& h : history)
+        std::memmove (h.data(), h.data() + position, static_cast<std::size_t> (filled) * sizeof (float));
+
+    return produced;
+}
+
+} // namespace dawinfo
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace dawinfo
+{
+
+//==============================================================================
+/**
+    Converts one to a few channels between two fixed sample rates by a
+    rational factor up/down, using a bank of precomputed polyphase filters.
+
+    prepare() reduces the rates to up/down, designs one windowed-sinc
+    low-pass with its cut-off below both Nyquist frequencies, and splits it
+    into `up` phases of tapsPerPhase taps each. Downsampling by more than one
+    widens the phases so the stop band stays put. Each output sample is then
+    one dot product of a phase with the latest input, computed four taps at
+    a time with simd::Float4. Banks are shared process-wide: resamplers with
+    the same ratio and length use one copy, designed by the first of them
+    and kept, so preparing another instance costs only its buffers.
+
+    process() consumes every input frame and writes as many output frames as
+    they complete; the remainder is carried into the next call. After
+    prepare() it never allocates, so it can run on the audio thread.
+*/
+class PolyphaseResampler
+{
+public:
+    /** The largest `up` factor accepted; 44.1 <-> 48 kHz needs 160. */
+    static constexpr int maxUpFactor = 640;
+
+    PolyphaseResampler() = default;
+
+    /** Not for the audio thread. False if the rates don't reduce to a
+        ratio with up <= maxUpFactor, or the arguments are out of range.
+    */
+    bool prepare (double inputRate, double outputRate, int numChannels, int maxInputFrames, int tapsPerPhase = 24);
+
+    /** Clears the carried input so the next block starts from silence. */
+    void reset() noexcept;
+
+    /** Resamples numFrames from each input channel. Returns the frames
+        written to each output, at most getMaxOutputFrames (numFrames).
+        numFrames above the prepared maximum is processed in pieces, so size
+        the outputs for the block actually passed.
+    */
+    int process (const float* const* in, int numFrames, float* const* out) noexcept;
+
+    int getUpFactor() const noexcept            { return up; }
+    int getDownFactor() const noexcept          { return down; }
+    int getTapsPerPhase() const noexcept        { return taps; }
+
+    /** The most frames process() writes for a block of the prepared maximum. */
+    int getMaxOutputFrames() const noexcept     { return maxOutput; }
+
+    /** The most frames process() writes for a block of numInputFrames. */
+    int getMaxOutputFrames (int numInputFrames) const noexcept;
+
+    /** The carried input. */
+    std::size_t getMemoryUsage() const noexcept;
+
+    /** The filter bank, which is shared rather than owned. */
+    std::size_t getSharedMemoryUsage() const noexcept   { return bank != nullptr ? bank->size() * sizeof (float) : 0; }
+
+    /** The prepared bank, shared with every resampler of the same ratio and length. */
+    const float* getCoefficients() const noexcept   { return bank != nullptr ? bank->data() : nullptr; }
+
+    /** Delay through the filter, in output samples. */
+    double getLatency() const noexcept;
+
+private:
+    int processChunk (const float* const* in, int numFrames, float* const* out) noexcept;
+
+    int up = 1, down = 1, taps = 0, numChannels = 0;
+    int maxInput = 0, maxOutput = 0;
+    std::shared_ptr<const std::vector<float>> bank;     // up phases of `taps` coefficients, oldest input first
+    std::vector<std::vector<float>> history;    // per channel: carried input, then the new block
+    int filled = 0;                             // frames in each history buffer
+    int phase = 0;                              // position between input frames, in 1/up steps
+};
+
+} // namespace dawinfo
@@ -0,0 +1,171 @@
+#include "Sender/QualityGovernor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dawinfo
+{
+
+namespace
+{
+    std::uint32_t toPermille (double fraction) noexcept
+    {
+        return static_cast<std::uint32_t> (std::clamp (fraction, 0.0, 1000.0) * 1000.0 + 0.5);
+    }
+}
+
+void QualityGovernor::raiseTo (std::atomic<std::uint32_t>& worst, std::uint32_t value) noexcept
+{
+    auto current = worst.load (std::memory_order_relaxed);
+
+    while (value > current && ! worst.compare_exchange_weak (current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+//==============================================================================
+void QualityGovernor::reportBlock (HostTimeNs callbackNs, HostTimeNs blockNs) noexcept
+{
+    if (blockNs <= 0)
+        return;
+
+    const double load = static_cast<double> (callbackNs) / static_cast<double> (blockNs);
+    raiseTo (worstLoadPermille, toPermille (load));
+    blocks.fetch_add (1, std::memory_order_relaxed);
+
+    if (load > options.loadHigh)
+        blocksOverHigh.fetch_add (1, std::memory_order_relaxed);
+
+    if (load >= options.loadLow)
+        blocksOverLow.fetch_add (1, std::memory_order_relaxed);
+}
+
+void QualityGovernor::reportBacklog (std::size_t queued, std::size_t capacity) noexcept
+{
+    if (capacity > 0)
+        raiseTo (worstBacklogPermille, toPermille (static_cast<double> (queued) / static_cast<double> (capacity)));
+}
+
+void QualityGovernor::reportSends (std::uint64_t attempted, std::uint64_t failed) noexcept
+{
+    sendsAttempted.fetch_add (attempted, std::memory_order_relaxed);
+    sendsFailed.fetch_add (failed, std::memory_order_relaxed);
+}
+
+//==============================================================================
+bool QualityGovernor::update (HostTimeNs nowNs) noexcept
+{
+    if (windowStartNs < 0)
+        windowStartNs = nowNs;
+
+    if (nowNs - windowStartNs < options.windowNs)
+        return false;
+
+    windowStartNs = nowNs;
+    ++stats.windows;
+
+    const double worstLoad = worstLoadPermille.exchange (0, std::memory_order_relaxed) / 1000.0;
+    const auto numBlocks = std::max<std::uint32_t> (blocks.exchange (0, std::memory_order_relaxed), 1);
+    const double overHighShare = blocksOverHigh.exchange (0, std::memory_order_relaxed) / static_cast<double> (numBlocks);
+    const double overLowShare = blocksOverLow.exchange (0, std::memory_order_relaxed) / static_cast<double> (numBlocks);
+    const double backlogFraction = worstBacklogPermille.exchange (0, std::memory_order_relaxed) / 1000.0;
+    const auto attempted = sendsAttempted.exchange (0, std::memory_order_relaxed);
+    const auto failed = sendsFailed.exchange (0, std::memory_order_relaxed);
+    const double failureRate = attempted > 0 ? static_cast<double> (failed) / static_cast<double> (attempted) : 0.0;
+
+    std::uint32_t pressure = 0;
+
+    if (overHighShare > options.loadedBlockShare)   pressure |= cpu;
+    if (backlogFraction > options.backlogHigh)      pressure |= backlog;
+    if (failureRate > options.sendFailureHigh)      pressure |= network;
+
+    const bool calm = overLowShare <= options.loadedBlockShare && backlogFraction < options.backlogLow && failed == 0;
+
+    stats.lastPressure = pressure;
+    stats.lastLoad = worstLoad;
+    stats.lastLoadedShare = overHighShare;
+    stats.lastBacklog = backlogFraction;
+    stats.lastSendFailureRate = failureRate;
+
+    if (settling)
+    {
+        settling = false;
+        return false;
+    }
+
+    const int current = level.load (std::memory_order_relaxed);
+    int next = current;
+
+    if (pressure != 0)
+    {
+        calmWindows = 0;
+        next = std::min (current + 1, maxLevel);
+    }
+    else if (calm)
+    {
+        if (++calmWindows >= options.recoverWindows)
+            next = std::max (current - 1, 0);
+    }
+    else
+    {
+        calmWindows = 0;
+    }
+
+    if (next == current)
+        return false;
+
+    if (next > current)
+        ++stats.stepsDown;
+    else
+        ++stats.stepsUp;
+
+    level.store (next, std::memory_order_relaxed);
+    calmWindows = 0;
+    settling = true;
+    return true;
+}
+
+QualityGovernor::Stats QualityGovernor::getStats() const noexcept
+{
+    auto s = stats;
+    s.level = getLevel();
+    return s;
+}
+
+//==============================================================================
+SenderConfig QualityGovernor::shape (const SenderConfig& full, int level)
+{
+    auto c = full;
+
+    if (level >= 1)
+    {
+        c.levelsRateHz *= 0.5;
+        c.spectrumRateHz *= 0.5;
+    }
+
+    if (level >= 2)
+    {
+        c.features &= ~static_cast<std::uint32_t> (feature::spectrum | feature::stereoImage | feature::waveform
+                                                     | feature::parameters | feature::audioTap);
+        c.transportRateHz = std::min (c.transportRateHz, 30.0);
+        c.waveformLiveLevel = -1;
+    }
+
+    if (level >= 3)
+    {
+        c.levelsRateHz = std::min (c.levelsRateHz, 10.0);
+        c.midiMinIntervalMs = std::max (c.midiMinIntervalMs, 10.0);
+        c.midiMinDelta = std::max (c.midiMinDelta, 2);
+        c.eventRedundancy = std::min (c.eventRedundancy, 1);
+    }
+
+    if (level >= 4)
+    {
+        c.features &= static_cast<std::uint32_t> (feature::transport | feature::events);
+        c.transportRateHz = std::min (c.transportRateHz, 15.0);
+    }
+
+    return c;
+}
+
+} // namespace dawinfo
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Common/Config.h"
+#include "Common/Transport.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace dawinfo
+{
+
+//==============================================================================
+/**
+    Steps the sender's output down when the host or the link is under
+    pressure, and back up once it has been calm for a while.
+
+    Three signals feed it, each from the thread that sees it:
+
+    - The audio thread calls reportBlock() with how long its share of the
+      block took, as a fraction of the block length: the closer to 1, the
+      smaller the margin before the deadline. The CPU signal is the share of
+      a window's blocks past each mark, so one block delayed by the
+      scheduler doesn't count as overload.
+    - The analysis or sender thread calls reportBacklog() with how full the
+      queue it drains is.
+    - Whoever sends calls reportSends() with attempts and failures (including
+      EAGAIN/ENOBUFS; see UdpSocket::getCongestedSends()).
+
+    The sender thread calls update() regularly. At the end of each window the
+    governor steps down one level if any signal is above its high mark, and
+    up one level only after recoverWindows consecutive windows with every
+    signal below its low mark. Between the marks it holds. The window after
+    a change is discarded, since it still mixes in the old level's cost.
+
+    What a level means is decided by shape(): it derives the config to run
+    from the full-quality one, so the user's config is never lost and coming
+    back up restores it exactly.
+
+        0   everything as configured
+        1   levels and spectrum at half rate
+        2   spectrum, stereo image, waveform, parameters and the audio tap off;
+            transport <= 30 Hz
+        3   levels <= 10 Hz, MIDI controllers thinned, events repeated at most once
+        4   transport (<= 15 Hz) and events only
+
+    The report functions never block or allocate; update() is for one thread.
+*/
+class QualityGovernor
+{
+public:
+    static constexpr int maxLevel = 4;
+
+    struct Options
+    {
+        HostTimeNs windowNs = 250000000;
+        double loadHigh = 0.75, loadLow = 0.45;         // callback time / block length
+        double loadedBlockShare = 0.1;                  // blocks past a mark that make it count
+        double backlogHigh = 0.5, backlogLow = 0.1;     // queue fill, 0..1
+        double sendFailureHigh = 0.01;                  // failed / attempted; calm means none failed
+        int recoverWindows = 8;
+    };
+
+    /** Which signals were above their high mark in a window. */
+    enum Pressure : std::uint32_t
+    {
+        cpu     = 1 << 0,
+        backlog = 1 << 1,
+        network = 1 << 2
+    };
+
+    struct Stats
+    {
+        int level = 0;
+        std::uint64_t windows = 0;
+        std::uint64_t stepsDown = 0;
+        std::uint64_t stepsUp = 0;
+        std::uint32_t lastPressure = 0;     // Pressure bits of the last window judged
+        double lastLoad = 0.0;              // worst block of the last window
+        double lastLoadedShare = 0.0;       // blocks past loadHigh in the last window
+        double lastBacklog = 0.0;
+        double lastSendFailureRate = 0.0;
+    };
+
+    QualityGovernor() = default;
+    explicit QualityGovernor (const Options& o) : options (o) {}
+
+    /** Audio thread, once per block. */
+    void reportBlock (HostTimeNs callbackNs, HostTimeNs blockNs) noexcept;
+
+    /** Analysis or sender thread, whenever it looks at its queue. */
+    void reportBacklog (std::size_t queued, std::size_t capacity) noexcept;
+
+    /** Any thread that sends. */
+    void reportSends (std::uint64_t attempted, std::uint64_t failed) noexcept;
+
+    /** Sender thread. Closes the window if it is over and returns true if
+        the level changed, in which case the caller should apply
+        shape (fullConfig, getLevel()).
+    */
+    bool update (HostTimeNs nowNs) noexcept;
+
+    /** Any thread. */
+    int getLevel() const noexcept       { return level.load (std::memory_order_relaxed); }
+
+    /** Sender thread. */
+    Stats getStats() const noexcept;
+
+    /** The config to run at a level, derived from the full-quality one. */
+    static SenderConfig shape (const SenderConfig& full, int level);
+
+private:
+    static void raiseTo (std::atomic<std::uint32_t>&, std::uint32_t) noexcept;
+
+    const Options options;
+    std::atomic<int> level { 0 };
+
+    // Written by the reporting threads, taken by update().
+    std::atomic<std::uint32_t> worstLoadPermille { 0 }, worstBacklogPermille { 0 };
+    std::atomic<std::uint32_t> blocks { 0 }, blocksOverHigh { 0 }, blocksOverLow { 0 };
+    std::atomic<std::uint64_t> sendsAttempted { 0 }, sendsFailed { 0 };
+
+    // Sender thread state.
+    HostTimeNs windowStartNs = -1;
+    int calmWindows = 0;
+    bool settling = false;
+    Stats stats;
+};
+
+} // namespace dawinfo
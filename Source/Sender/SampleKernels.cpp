@@ -0,0 +1,339 @@
+#include "Sender/SampleKernels.h"
+#include "Common/Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace dawinfo
+{
+
+namespace
+{
+    constexpr float minus3dB = 0.70710678f;
+    constexpr float minus6dB = 0.5f;
+    constexpr float int16Scale = 1.0f / 32768.0f;
+
+    struct Pan
+    {
+        float left, right;
+    };
+
+    /** Where one input channel goes, before normalisation. */
+    Pan panFor (ChannelLayout layout, int channel, int numInputs) noexcept
+    {
+        static constexpr Pan surround[] = {
+            { 1.0f, 0.0f }, { 0.0f, 1.0f },             // L R
+            { minus3dB, minus3dB }, { 0.0f, 0.0f },     // C LFE
+            { minus3dB, 0.0f }, { 0.0f, minus3dB },     // Ls Rs (rear surrounds in 7.1)
+            { minus3dB, 0.0f }, { 0.0f, minus3dB },     // side surrounds
+            { minus6dB, 0.0f }, { 0.0f, minus6dB },     // top front
+            { minus6dB, 0.0f }, { 0.0f, minus6dB }      // top rear
+        };
+
+        int layoutChannels = 0;
+
+        switch (layout)
+        {
+            case ChannelLayout::mono:           return { 1.0f, 1.0f };
+            case ChannelLayout::stereo:         layoutChannels = 2; break;
+            case ChannelLayout::surround51:     layoutChannels = 6; break;
+            case ChannelLayout::surround71:     layoutChannels = 8; break;
+            case ChannelLayout::surround714:    layoutChannels = 12; break;
+            case ChannelLayout::discrete:       break;
+        }
+
+        if (channel < layoutChannels)
+            return surround[channel];
+
+        if (numInputs == 1)
+            return { 1.0f, 1.0f };
+
+        return channel % 2 == 0 ? Pan { 1.0f, 0.0f } : Pan { 0.0f, 1.0f };
+    }
+
+    /** The inputs an output actually takes, so silent ones cost nothing. */
+    struct Taps
+    {
+        int channels[DownmixMatrix::maxInputs];
+        float gains[DownmixMatrix::maxInputs];
+        int size = 0;
+
+        Taps (const float* const* in, const DownmixMatrix& m, int output) noexcept
+        {
+            for (int c = 0; c < m.numInputs; ++c)
+            {
+                if (m.gains[output][c] != 0.0f && in[c] != nullptr)
+                {
+                    channels[size] = c;
+                    gains[size] = m.gains[output][c];
+                    ++size;
+                }
+            }
+        }
+    };
+}
+
+ChannelLayout layoutForChannelCount (int numChannels) noexcept
+{
+    switch (numChannels)
+    {
+        case 1:     return ChannelLayout::mono;
+        case 2:     return ChannelLayout::stereo;
+        case 6:     return ChannelLayout::surround51;
+        case 8:     return ChannelLayout::surround71;
+        case 12:    return ChannelLayout::surround714;
+        default:    return ChannelLayout::discrete;
+    }
+}
+
+DownmixMatrix DownmixMatrix::create (ChannelLayout layout, int numInputs, int numOutputs) noexcept
+{
+    DownmixMatrix m;
+    m.numInputs = std::clamp (numInputs, 0, maxInputs);
+    m.numOutputs = std::clamp (numOutputs, 1, 2);
+
+    for (int c = 0; c < m.numInputs; ++c)
+    {
+        const auto pan = panFor (layout, c, m.numInputs);
+
+        if (m.numOutputs == 1)
+        {
+            m.gains[0][c] = layout == ChannelLayout::mono || m.numInputs == 1 ? 1.0f : pan.left + pan.right;
+        }
+        else
+        {
+            m.gains[0][c] = pan.left;
+            m.gains[1][c] = pan.right;
+        }
+    }
+
+    for (int o = 0; o < m.numOutputs; ++o)
+    {
+        float total = 0.0f;
+
+        for (int c = 0; c < m.numInputs; ++c)
+            total += std::abs (m.gains[o][c]);
+
+        if (total > 1.0f)
+            for (int c = 0; c < m.numInputs; ++c)
+                m.gains[o][c] /= total;
+    }
+
+    return m;
+}
+
+//==============================================================================
+namespace kernels
+{
+    namespace scalar
+    {
+        void deinterleave (const float* in, int numChannels, int numFrames, float* const* out) noexcept
+        {
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < numFrames; ++i)
+                    out[c][i] = in[i * numChannels + c];
+        }
+
+        void deinterleave (const std::int16_t* in, int numChannels, int numFrames, float* const* out) noexcept
+        {
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < numFrames; ++i)
+                    out[c][i] = in[i * numChannels + c] * int16Scale;
+        }
+
+        void downmix (const float* const* in, int numFrames, const DownmixMatrix& m, float* const* out) noexcept
+        {
+            for (int o = 0; o < m.numOutputs; ++o)
+            {
+                for (int i = 0; i < numFrames; ++i)
+                {
+                    float sum = 0.0f;
+
+                    for (int c = 0; c < m.numInputs; ++c)
+                        if (in[c] != nullptr)
+                            sum += m.gains[o][c] * in[c][i];
+
+                    out[o][i] = sum;
+                }
+            }
+        }
+
+        StereoSums stereoSums (const float* left, const float* right, int numFrames) noexcept
+        {
+            StereoSums s;
+
+            for (int i = 0; i < numFrames; ++i)
+            {
+                s.ll += static_cast<double> (left[i]) * left[i];
+                s.rr += static_cast<double> (right[i]) * right[i];
+                s.lr += static_cast<double> (left[i]) * right[i];
+            }
+
+            return s;
+        }
+    }
+
+    //==============================================================================
+    void deinterleave (const float* in, int numChannels, int numFrames, float* const* out) noexcept
+    {
+        if (numFrames <= 0)
+            return;
+
+        if (numChannels == 1)
+        {
+            std::memcpy (out[0], in, static_cast<std::size_t> (numFrames) * sizeof (float));
+            return;
+        }
+
+        if (numChannels != 2)
+        {
+            scalar::deinterleave (in, numChannels, numFrames, out);
+            return;
+        }
+
+        int i = 0;
+
+        for (; i + 4 <= numFrames; i += 4)
+        {
+            simd::Float4 left, right;
+            simd::Float4::deinterleave (simd::Float4::load (in + 2 * i), simd::Float4::load (in + 2 * i + 4), left, right);
+            left.store (out[0] + i);
+            right.store (out[1] + i);
+        }
+
+        for (; i < numFrames; ++i)
+        {
+            out[0][i] = in[2 * i];
+            out[1][i] = in[2 * i + 1];
+        }
+    }
+
+    void deinterleave (const std::int16_t* in, int numChannels, int numFrames, float* const* out) noexcept
+    {
+        if (numChannels != 2)
+        {
+            scalar::deinterleave (in, numChannels, numFrames, out);
+            return;
+        }
+
+        int i = 0;
+
+       #if DAWINFO_SIMD_SSE2
+        const __m128 scale = _mm_set1_ps (int16Scale);
+
+        // Four samples to floats: pairing each with itself and shifting the
+        // 32-bit lanes right sign-extends them.
+        auto load = [&] (const std::int16_t* p) -> simd::Float4
+        {
+            const __m128i samples = _mm_loadl_epi64 (reinterpret_cast<const __m128i*> (p));
+            return { _mm_mul_ps (_mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpacklo_epi16 (samples, samples), 16)), scale) };
+        };
+
+        for (; i + 4 <= numFrames; i += 4)
+        {
+            simd::Float4 left, right;
+            simd::Float4::deinterleave (load (in + 2 * i), load (in + 2 * i + 4), left, right);
+            left.store (out[0] + i);
+            right.store (out[1] + i);
+        }
+       #elif DAWINFO_SIMD_NEON
+        const float32x4_t scale = vdupq_n_f32 (int16Scale);
+
+        for (; i + 8 <= numFrames; i += 8)
+        {
+            const int16x8x2_t frames = vld2q_s16 (in + 2 * i);
+
+            for (int c = 0; c < 2; ++c)
+            {
+                vst1q_f32 (out[c] + i, vmulq_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_low_s16 (frames.val[c]))), scale));
+                vst1q_f32 (out[c] + i + 4, vmulq_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_high_s16 (frames.val[c]))), scale));
+            }
+        }
+       #endif
+
+        for (; i < numFrames; ++i)
+        {
+            out[0][i] = in[2 * i] * int16Scale;
+            out[1][i] = in[2 * i + 1] * int16Scale;
+        }
+    }
+
+    void downmix (const float* const* in, int numFrames, const DownmixMatrix& m, float* const* out) noexcept
+    {
+        for (int o = 0; o < m.numOutputs; ++o)
+        {
+            const Taps taps (in, m, o);
+            float* dest = out[o];
+            int i = 0;
+
+            if (taps.size == 0)
+            {
+                std::fill (dest, dest + numFrames, 0.0f);
+                continue;
+            }
+
+            for (; i + 8 <= numFrames; i += 8)
+            {
+                auto g = simd::Float4::broadcast (taps.gains[0]);
+                const float* first = in[taps.channels[0]] + i;
+                auto a = g * simd::Float4::load (first);
+                auto b = g * simd::Float4::load (first + 4);
+
+                for (int t = 1; t < taps.size; ++t)
+                {
+                    g = simd::Float4::broadcast (taps.gains[t]);
+                    const float* src = in[taps.channels[t]] + i;
+                    a += g * simd::Float4::load (src);
+                    b += g * simd::Float4::load (src + 4);
+                }
+
+                a.store (dest + i);
+                b.store (dest + i + 4);
+            }
+
+            for (; i < numFrames; ++i)
+            {
+                float sum = 0.0f;
+
+                for (int t = 0; t < taps.size; ++t)
+                    sum += taps.gains[t] * in[taps.channels[t]][i];
+
+                dest[i] = sum;
+            }
+        }
+    }
+
+    StereoSums stereoSums (const float* left, const float* right, int numFrames) noexcept
+    {
+        // Two sets of accumulators, so consecutive adds don't wait on each other.
+        auto ll0 = simd::Float4::zero(), rr0 = ll0, lr0 = ll0, ll1 = ll0, rr1 = ll0, lr1 = ll0;
+        int i = 0;
+
+        for (; i + 8 <= numFrames; i += 8)
+        {
+            const auto l0 = simd::Float4::load (left + i), r0 = simd::Float4::load (right + i);
+            const auto l1 = simd::Float4::load (left + i + 4), r1 = simd::Float4::load (right + i + 4);
+            ll0 += l0 * l0;
+            rr0 += r0 * r0;
+            lr0 += l0 * r0;
+            ll1 += l1 * l1;
+            rr1 += r1 * r1;
+            lr1 += l1 * r1;
+        }
+
+        StereoSums s { (ll0 + ll1).sum(), (rr0 + rr1).sum(), (lr0 + lr1).sum() };
+
+        for (; i < numFrames; ++i)
+        {
+            s.ll += left[i] * left[i];
+            s.rr += right[i] * right[i];
+            s.lr += left[i] * right[i];
+        }
+
+        return s;
+    }
+
+}
+
+} // namespace dawinfo
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/** Host channel layouts the analysis input knows how to fold down. Channel
+    order follows WAVE/SMPTE: L R C LFE, then surrounds, then heights.
+*/
+enum class ChannelLayout : std::int32_t
+{
+    mono,
+    stereo,
+    surround51,     // L R C LFE Ls Rs
+    surround71,     // L R C LFE Lrs Rrs Lss Rss
+    surround714,    // 7.1 + Ltf Rtf Ltr Rtr
+    discrete        // anything else: even channels left, odd right
+};
+
+/** The layout a host bus of that many channels most likely has. */
+ChannelLayout layoutForChannelCount (int numChannels) noexcept;
+
+//==============================================================================
+/**
+    Gains from up to maxInputs host channels to one or two analysis channels.
+
+    Centre and surrounds go in at -3 dB, heights at -6 dB, LFE not at all
+    (ITU-R BS.775 style). Each output is then normalised so a full-scale
+    signal on every input channel it takes can't push it past full scale.
+*/
+struct DownmixMatrix
+{
+    static constexpr int maxInputs = 16;
+
+    int numInputs = 0;
+    int numOutputs = 0;
+    float gains[2][maxInputs] {};
+
+    static DownmixMatrix create (ChannelLayout, int numInputs, int numOutputs) noexcept;
+};
+
+/** Sums of L * L, R * R and L * R over a block: everything a stereo image
+    meter needs, since mid and side energy are (LL + RR +- 2 LR) / 4.
+*/
+struct StereoSums
+{
+    double ll = 0.0, rr = 0.0, lr = 0.0;
+};
+
+//==============================================================================
+/**
+    Sample kernels: format conversion for the analysis input, and the sums
+    the stereo image meter runs on. The plain functions use
+    simd::Float4 across frames; the scalar:: ones are straightforward loops
+    kept as the reference for tests and benchmarks. Both take any frame
+    count, write only the frames asked for and never allocate.
+*/
+namespace kernels
+{
+    /** Interleaved frames to one buffer per channel. */
+    void deinterleave (const float* interleaved, int numChannels, int numFrames, float* const* out) noexcept;
+
+    /** 16-bit interleaved PCM to float channels in [-1, 1). */
+    void deinterleave (const std::int16_t* interleaved, int numChannels, int numFrames, float* const* out) noexcept;
+
+    /** Applies the matrix; out has matrix.numOutputs buffers. Null inputs read as silence. */
+    void downmix (const float* const* in, int numFrames, const DownmixMatrix&, float* const* out) noexcept;
+
+    /** Accumulates in float lanes, so expect float rounding against the reference. */
+    StereoSums stereoSums (const float* left, const float* right, int numFrames) noexcept;
+
+    namespace scalar
+    {
+        void deinterleave (const float* interleaved, int numChannels, int numFrames, float* const* out) noexcept;
+        void deinterleave (const std::int16_t* interleaved, int numChannels, int numFrames, float* const* out) noexcept;
+        void downmix (const float* const* in, int numFrames, const DownmixMatrix&, float* const* out) noexcept;
+        StereoSums stereoSums (const float* left, const float* right, int numFrames) noexcept;
+    }
+}
+
+} // namespace dawinfo
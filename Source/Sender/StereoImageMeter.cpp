@@ -0,0 +1,126 @@
+#include "Sender/StereoImageMeter.h"
+#include "Common/Messages.h"
+
+#include <cmath>
+
+namespace dawinfo
+{
+
+namespace
+{
+    /** Energy below this reads as silence. */
+    constexpr double silence = 1.0e-12;
+
+    float toDb (double meanSquare) noexcept
+    {
+        return meanSquare > silence ? std::max (static_cast<float> (10.0 * std::log10 (meanSquare)), StereoMeter::minDb)
+                                    : StereoMeter::minDb;
+    }
+
+    /** A full cloud of maxPoints comes to about 1.2 KB with the meter. */
+    constexpr std::size_t maxPacketSize = 1400;
+}
+
+StereoImageMeter::StereoImageMeter() : StereoImageMeter (Options()) {}
+
+StereoImageMeter::StereoImageMeter (const Options& o)
+    : options (o),
+      capacity (std::clamp (o.pointsPerFrame, 1, vectorscope::maxPoints)),
+      integrationSamples (std::max (o.sampleRate * o.integrationMs * 0.001, 1.0)),
+      random (o.seed != 0 ? o.seed : 1)
+{
+}
+
+void StereoImageMeter::reset() noexcept
+{
+    sums = {};
+    weight = 0.0;
+    candidates = 0;
+    phase = 0;
+}
+
+//==============================================================================
+void StereoImageMeter::process (const float* left, const float* right, int numFrames) noexcept
+{
+    if (numFrames <= 0)
+        return;
+
+    // The block counts in full and what came before decays by its length.
+    const auto block = kernels::stereoSums (left, right, numFrames);
+    const double decay = std::exp (-numFrames / integrationSamples);
+
+    sums.ll = sums.ll * decay + block.ll;
+    sums.rr = sums.rr * decay + block.rr;
+    sums.lr = sums.lr * decay + block.lr;
+    weight = weight * decay + numFrames;
+
+    // Reservoir sampling (Vitter's algorithm R) over the candidates.
+    const int step = std::max (options.decimation, 1);
+    int i = phase;
+
+    for (; i < numFrames; i += step)
+    {
+        const vectorscope::Point p { (right[i] - left[i]) * 0.5f, (left[i] + right[i]) * 0.5f };
+
+        if (candidates < static_cast<std::uint64_t> (capacity))
+        {
+            reservoir[static_cast<std::size_t> (candidates)] = p;
+        }
+        else
+        {
+            const auto slot = (static_cast<std::uint64_t> (nextRandom()) * (candidates + 1)) >> 32;
+
+            if (slot < static_cast<std::uint64_t> (capacity))
+                reservoir[static_cast<std::size_t> (slot)] = p;
+        }
+
+        ++candidates;
+    }
+
+    phase = i - numFrames;
+}
+
+StereoMeter StereoImageMeter::getMeter (HostTimeNs timeNs) const noexcept
+{
+    StereoMeter m;
+    m.timeNs = timeNs;
+
+    if (weight <= 0.0)
+        return m;
+
+    const double power = sums.ll * sums.rr;
+
+    if (power > silence * silence)
+        m.correlation = static_cast<float> (std::clamp (sums.lr / std::sqrt (power), -1.0, 1.0));
+
+    if (sums.ll + sums.rr > silence)
+        m.balance = static_cast<float> (std::clamp ((sums.rr - sums.ll) / (sums.rr + sums.ll), -1.0, 1.0));
+
+    m.midDb = toDb ((sums.ll + sums.rr + 2.0 * sums.lr) * 0.25 / weight);
+    m.sideDb = toDb ((sums.ll + sums.rr - 2.0 * sums.lr) * 0.25 / weight);
+    return m;
+}
+
+void StereoImageMeter::endFrame (HostTimeNs timeNs, Frame& frame) noexcept
+{
+    frame.meter = getMeter (timeNs);
+    frame.numPoints = static_cast<int> (std::min<std::uint64_t> (candidates, static_cast<std::uint64_t> (capacity)));
+    std::copy_n (reservoir.begin(), frame.numPoints, frame.points.begin());
+    candidates = 0;
+}
+
+std::size_t StereoImageMeter::publish (const Frame& frame, PacketSink& sink, StreamSequencer& seq) noexcept
+{
+    std::uint8_t buffer[maxPacketSize];
+    OscWriter w (buffer, sizeof (buffer));
+    seq.beginPacket (w, StreamId::stereo);
+    schema::Codec<messages::Stereo>::write (w, frame.meter);
+    vectorscope::writePoints (w, frame.meter.timeNs, frame.points.data(), frame.numPoints);
+
+    if (w.hasOverflowed() || ! sink.send (w.getData(), w.getSize()))
+        return 0;
+
+    return w.getSize();
+}
+
+} // namespace dawinfo
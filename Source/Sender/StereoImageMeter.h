@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Common/PacketSink.h"
+#include "Common/StereoImage.h"
+#include "Sender/SampleKernels.h"
+#include "Sender/StreamSequencer.h"
+
+#include <array>
+#include <cstdint>
+
+namespace dawinfo
+{
+
+//==============================================================================
+/**
+    Correlation, balance and mid/side meters for the stereo analysis
+    channels, and the point cloud a vectorscope draws.
+
+    process() runs kernels::stereoSums() over each block and folds the sums
+    into running ones that decay with the integration time (300 ms, like a
+    hardware correlation meter), so the reading is the same whatever the
+    block size. From the three sums: correlation LR / sqrt (LL RR), balance
+    (RR - LL) / (RR + LL), and mid and side energy (LL + RR +- 2 LR) / 4.
+
+    For the vectorscope, every decimation-th sample is a candidate and a
+    reservoir keeps a uniform random sample of pointsPerFrame of them for the
+    current output frame, however long the frame runs: receivers get a cloud
+    of the same size at any host rate or frame rate, with no bias towards
+    the start or end of the frame. endFrame() hands the cloud over and
+    starts the next.
+
+    Everything lives in the object; nothing is allocated. Not thread safe:
+    process() and endFrame() belong to the thread that runs the analysis
+    (see AnalysisInput), and publish() to whichever thread the frame is
+    handed to.
+*/
+class StereoImageMeter
+{
+public:
+    struct Options
+    {
+        double sampleRate = 48000.0;
+        double integrationMs = 300.0;
+        int pointsPerFrame = 256;       // at most vectorscope::maxPoints
+        int decimation = 2;
+        std::uint32_t seed = 0x9e3779b9;
+    };
+
+    /** One output frame: the reading, and the points kept since the last one. */
+    struct Frame
+    {
+        StereoMeter meter;
+        int numPoints = 0;
+        std::array<vectorscope::Point, vectorscope::maxPoints> points {};
+    };
+
+    StereoImageMeter();
+    explicit StereoImageMeter (const Options&);
+
+    /** Forgets the running sums and the current frame's points. */
+    void reset() noexcept;
+
+    /** Analysis thread: one block of the left and right analysis channels. */
+    void process (const float* left, const float* right, int numFrames) noexcept;
+
+    /** Analysis thread: the reading so far. */
+    StereoMeter getMeter (HostTimeNs) const noexcept;
+
+    /** Analysis thread: ends the output frame and starts the next. */
+    void endFrame (HostTimeNs, Frame&) noexcept;
+
+    /** Samples offered to the reservoir since the last endFrame(). */
+    std::uint64_t getCandidates() const noexcept    { return candidates; }
+
+    /** Sends a frame as /dawinfo/stereo then /dawinfo/vectorscope, in one
+        packet on StreamId::stereo. Returns the bytes sent.
+    */
+    static std::size_t publish (const Frame&, PacketSink&, StreamSequencer&) noexcept;
+
+private:
+    std::uint32_t nextRandom() noexcept
+    {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        return random;
+    }
+
+    const Options options;
+    const int capacity;
+    const double integrationSamples;
+
+    // Running sums, and the weight of the samples in them.
+    StereoSums sums;
+    double weight = 0.0;
+
+    std::array<vectorscope::Point, vectorscope::maxPoints> reservoir {};
+    std::uint64_t candidates = 0;
+    int phase = 0;                      // samples until the next candidate
+    std::uint32_t random;
+};
+
+} // namespace dawinfo
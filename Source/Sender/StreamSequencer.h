@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Common/Protocol.h"
+
+#include <array>
+#include <cstdint>
+
+namespace dawinfo
+{
+
+/** Hands out per-stream packet sequence numbers. Sender thread only. */
+class StreamSequencer
+{
+public:
+    /** Returns the number for the next packet on the stream and advances it. */
+    std::uint32_t next (StreamId stream) noexcept
+    {
+        return counters[static_cast<std::size_t> (stream)]++;
+    }
+
+    /** Starts a packet: opens a bundle and writes the sequence message. */
+    void beginPacket (OscWriter& w, StreamId stream, std::uint64_t timeTag = oscImmediateTimeTag) noexcept
+    {
+        w.beginBundle (timeTag);
+        writeSequence (w, stream, next (stream));
+    }
+
+    std::uint32_t peek (StreamId stream) const noexcept
+    {
+        return counters[static_cast<std::size_t> (stream)];
+    }
+
+private:
+    std::array<std::uint32_t, numStreams> counters {};
+};
+
+} // namespace dawinfo
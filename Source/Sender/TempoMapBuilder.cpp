@@ -0,0 +1,245 @@
+#include "Sender/TempoMapBuilder.h"
+#include "Common/Messages.h"
+#include "Sender/MemoryBudget.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dawinfo
+{
+
+namespace
+{
+    constexpr std::size_t bundleHeaderSize = 16;
+    constexpr std::size_t sequenceSize = 4 + schema::Codec<messages::Sequence>::wireSize;
+    constexpr std::size_t headerSize = 4 + schema::Codec<messages::TempoHeader>::wireSize;
+    constexpr std::size_t segmentSize = 4 + schema::Codec<messages::TempoSegment>::wireSize;
+}
+
+TempoMapBuilder::TempoMapBuilder() : TempoMapBuilder (Options()) {}
+
+TempoMapBuilder::TempoMapBuilder (const Options& o)
+    : options (o), buffer (o.maxPacketSize)
+{
+}
+
+void TempoMapBuilder::observe (const TransportSnapshot& s)
+{
+    ++stats.observations;
+
+    const bool loopDiffers = s.isLooping != map.isLooping
+                              || (s.isLooping && (s.loopStartPpq != map.loopStartPpq || s.loopEndPpq != map.loopEndPpq));
+
+    if (loopDiffers)
+    {
+        map.isLooping = s.isLooping;
+        map.loopStartPpq = s.loopStartPpq;
+        map.loopEndPpq = s.loopEndPpq;
+        loopChanged = true;
+    }
+
+    if (! s.isPlaying)
+    {
+        hasPrevious = false;
+        rampCandidate = -1;
+        return;
+    }
+
+    TempoSegment seen;
+    seen.startPpq = s.ppq;
+    seen.bpm = std::clamp (s.bpm, TempoSegment::minBpm, TempoSegment::maxBpm);
+    seen.barStartPpq = s.barStartPpq;
+    seen.barNumber = s.barNumber;
+    seen.timeSigNumerator = std::max (s.timeSigNumerator, 1);
+    seen.timeSigDenominator = s.timeSigDenominator > 0 ? s.timeSigDenominator : 4;
+
+    // A ramp can only be traced along playback that moved forwards.
+    const bool movedOn = hasPrevious && s.ppq > previousPpq;
+
+    if (! movedOn)
+        rampCandidate = -1;
+
+    const auto remember = [&]
+    {
+        hasPrevious = true;
+        previousPpq = s.ppq;
+    };
+
+    const auto* current = map.findSegment (s.ppq);
+    const bool isCandidate = rampCandidate >= 0 && current == &map.segments[static_cast<std::size_t> (rampCandidate)];
+
+    if (current != nullptr && s.ppq >= current->startPpq && current->sameMeter (seen))
+    {
+        const double departure = std::abs (current->bpmAt (s.ppq) - seen.bpm);
+
+        if (isCandidate && departure <= 0.1 * options.bpmTolerance)
+        {
+            settledPpq = s.ppq;
+            settledBpm = seen.bpm;
+        }
+
+        if (departure <= options.bpmTolerance)
+        {
+            remember();
+            return;
+        }
+    }
+
+    // A line through the candidate's start and this tempo becomes a ramp if
+    // it also explains the last observation that sat squarely on the
+    // candidate. After a steady stretch that rules out a step, and it stops
+    // a ramp that starts late in a segment bending the whole segment.
+    if (isCandidate && current->sameMeter (seen) && s.ppq > current->startPpq)
+    {
+        auto& ramp = map.segments[static_cast<std::size_t> (rampCandidate)];
+        const double slope = (seen.bpm - ramp.bpm) / (s.ppq - ramp.startPpq);
+
+        if (std::abs (ramp.bpm + slope * (settledPpq - ramp.startPpq) - settledBpm) <= options.bpmTolerance)
+        {
+            ramp.bpmPerQuarter = slope;
+            markChanged (static_cast<std::size_t> (rampCandidate));
+            ++stats.rampsFitted;
+            rampCandidate = -1;
+            remember();
+            return;
+        }
+    }
+
+    // A new meter comes in on a bar line, which may be a little behind us.
+    const bool fromBarLine = current != nullptr && ! current->sameMeter (seen)
+                              && seen.barStartPpq > current->startPpq && seen.barStartPpq < s.ppq;
+
+    if (fromBarLine)
+        seen.startPpq = seen.barStartPpq;
+
+    const auto index = insertSegment (seen);
+    rampCandidate = fromBarLine ? -1 : static_cast<std::ptrdiff_t> (index);
+    settledPpq = map.segments[index].startPpq;
+    settledBpm = map.segments[index].bpm;
+    remember();
+}
+
+std::size_t TempoMapBuilder::insertSegment (const TempoSegment& segment)
+{
+    auto& segments = map.segments;
+    auto at = std::lower_bound (segments.begin(), segments.end(), segment.startPpq,
+                                [] (const TempoSegment& s, double p) { return s.startPpq < p; });
+
+    auto index = static_cast<std::size_t> (at - segments.begin());
+
+    // A segment that was first seen a little later, say a block later on an
+    // earlier loop cycle, starts here instead.
+    const bool extendsNext = at != segments.end() && at->sameMeter (segment)
+                              && std::abs (at->bpm + at->bpmPerQuarter * (segment.startPpq - at->startPpq) - segment.bpm) <= options.bpmTolerance;
+
+    if (extendsNext)
+    {
+        at->bpm += at->bpmPerQuarter * (segment.startPpq - at->startPpq);
+        at->startPpq = segment.startPpq;
+    }
+    else if (at != segments.end() && std::abs (at->startPpq - segment.startPpq) < 1.0e-9)
+    {
+        *at = segment;
+    }
+    else
+    {
+        segments.insert (at, segment);
+    }
+
+    ++stats.segmentsAdded;
+    markChanged (index);
+
+    // Over the cap, the oldest goes, unless that's the one just learnt.
+    if (segments.size() > static_cast<std::size_t> (std::max (options.maxSegments, 1)))
+    {
+        if (index > 0)
+        {
+            segments.erase (segments.begin());
+            markChanged (0);
+            --index;
+        }
+        else
+        {
+            segments.pop_back();
+        }
+    }
+
+    return index;
+}
+
+void TempoMapBuilder::markChanged (std::size_t index) noexcept
+{
+    if (! segmentsChanged || index < firstChanged)
+        firstChanged = index;
+
+    segmentsChanged = true;
+}
+
+std::size_t TempoMapBuilder::publish (PacketSink& sink, StreamSequencer& sequencer)
+{
+    const bool fullSync = fullSyncRequested.exchange (false, std::memory_order_acq_rel);
+    const bool changed = segmentsChanged || loopChanged;
+
+    if (! changed && ! fullSync)
+        return 0;
+
+    const auto baseVersion = version;
+
+    if (changed)
+        ++version;
+
+    const auto numSegments = map.segments.size();
+    const auto replaceFrom = fullSync ? 0 : segmentsChanged ? std::min (firstChanged, numSegments) : numSegments;
+    segmentsChanged = loopChanged = false;
+
+    const auto budget = options.maxPacketSize - std::min (options.maxPacketSize, bundleHeaderSize + sequenceSize + headerSize);
+    const auto perPacket = std::max<std::size_t> (budget / segmentSize, 1);
+    const auto numParts = std::max<std::size_t> ((numSegments - replaceFrom + perPacket - 1) / perPacket, 1);
+
+    TempoMapHeader header;
+    header.baseVersion = baseVersion;
+    header.version = version;
+    header.numParts = static_cast<std::int32_t> (numParts);
+    header.replaceFrom = static_cast<std::int32_t> (replaceFrom);
+    header.numSegments = static_cast<std::int32_t> (numSegments);
+    header.isLooping = map.isLooping;
+    header.loopStartPpq = map.loopStartPpq;
+    header.loopEndPpq = map.loopEndPpq;
+
+    std::size_t bytes = 0;
+
+    for (std::size_t part = 0; part < numParts; ++part)
+    {
+        const auto first = replaceFrom + part * perPacket;
+        const auto end = std::min (first + perPacket, numSegments);
+
+        header.part = static_cast<std::int32_t> (part);
+        header.firstSegment = static_cast<std::int32_t> (first);
+
+        OscWriter w (buffer.data(), buffer.size());
+        sequencer.beginPacket (w, StreamId::tempo);
+        schema::Codec<messages::TempoHeader>::write (w, header);
+
+        for (auto i = first; i < end; ++i)
+            schema::Codec<messages::TempoSegment>::write (w, map.segments[i]);
+
+        if (w.hasOverflowed())
+            continue;   // only if maxPacketSize can't hold a single segment
+
+        sink.send (w.getData(), w.getSize());
+        bytes += w.getSize();
+        ++stats.packets;
+    }
+
+    ++(fullSync ? stats.fullSyncs : stats.updates);
+    stats.bytes += bytes;
+    return bytes;
+}
+
+void TempoMapBuilder::reportMemory (MemoryReport& report) const
+{
+    report.add (MemoryReport::state, map.segments.capacity() * sizeof (TempoSegment));
+    report.add (MemoryReport::packets, buffer.capacity());
+}
+
+} // namespace dawinfo
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Common/PacketSink.h"
+#include "Common/TempoMap.h"
+#include "Sender/StreamSequencer.h"
+
+#include <atomic>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+/**
+    Learns the host's tempo map from the transport it reports, and publishes
+    it on StreamId::tempo.
+
+    Hosts only say what the tempo is now, so the map is built as the playhead
+    passes: an observation that the map already explains changes nothing, a
+    tempo that departs from it starts a new segment, and one that keeps
+    moving along a line through the new segment's start turns it into a
+    ramp. A meter change starts its segment at the bar line it came in on.
+    A change seen a little earlier than before, as happens when blocks fall
+    differently on the next loop cycle, moves its segment back; once the
+    loop has been learnt, more cycles cost nothing on the wire.
+
+    Everything except requestFullSync() runs on the sender thread. publish()
+    bumps the version only when the map changed, and sends only the segments
+    from the first one that changed, so a receiver mirrors the map from a
+    handful of small packets. When a receiver joins, requestFullSync() makes
+    the next publish resend the whole map.
+*/
+class TempoMapBuilder
+{
+public:
+    struct Options
+    {
+        double bpmTolerance = 0.05;         // departures smaller than this are the same tempo
+        std::int32_t maxSegments = 1024;    // the oldest are dropped beyond this
+        std::size_t maxPacketSize = 1400;
+    };
+
+    struct Stats
+    {
+        std::uint64_t observations = 0;
+        std::uint64_t segmentsAdded = 0;
+        std::uint64_t rampsFitted = 0;
+        std::uint64_t updates = 0;
+        std::uint64_t fullSyncs = 0;
+        std::uint64_t packets = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    TempoMapBuilder();
+    explicit TempoMapBuilder (const Options&);
+
+    /** Sender thread: learns from one transport snapshot. Only playback teaches
+        tempo; the loop is taken whether playing or not.
+    */
+    void observe (const TransportSnapshot&);
+
+    /** Any thread: makes the next publish() send the whole map. */
+    void requestFullSync() noexcept     { fullSyncRequested.store (true, std::memory_order_release); }
+
+    /** Sender thread: sends pending changes. Returns the number of bytes sent. */
+    std::size_t publish (PacketSink&, StreamSequencer&);
+
+    /** Sender thread: the map as learnt so far, and the version receivers will
+        have after the last publish.
+    */
+    const TempoMap& getMap() const noexcept     { return map; }
+    std::uint32_t getVersion() const noexcept   { return version; }
+    const Stats& getStats() const noexcept      { return stats; }
+
+    void reportMemory (MemoryReport&) const;
+
+private:
+    std::size_t insertSegment (const TempoSegment&);
+    void markChanged (std::size_t index) noexcept;
+
+    const Options options;
+    TempoMap map;
+
+    std::atomic<bool> fullSyncRequested { false };
+
+    // The last observation while playing, the newest segment if it may
+    // still become a ramp, and the last point that sat squarely on it.
+    bool hasPrevious = false;
+    double previousPpq = 0.0;
+    std::ptrdiff_t rampCandidate = -1;
+    double settledPpq = 0.0, settledBpm = 0.0;
+
+    // Since the last publish.
+    std::size_t firstChanged = 0;
+    bool segmentsChanged = false, loopChanged = false;
+    std::uint32_t version = 0;
+
+    std::vector<std::uint8_t> buffer;
+    Stats stats;
+};
+
+} // namespace dawinfo
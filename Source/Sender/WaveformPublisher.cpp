@@ -0,0 +1,197 @@
+#include "Sender/WaveformPublisher.h"
+#include "Common/Messages.h"
+#include "Sender/MemoryBudget.h"
+
+#include <algorithm>
+
+namespace dawinfo
+{
+
+namespace
+{
+    /** Bundle header plus the sequence message that opens every packet. */
+    constexpr std::size_t packetOverhead = 16 + 4 + schema::Codec<messages::Sequence>::wireSize;
+}
+
+WaveformPublisher::WaveformPublisher (int channels, int binSize, int numLevels,
+                                      std::size_t bins, std::size_t packetSize)
+    : numChannels (std::clamp (channels, 1, peaks::maxChannels)),
+      samplesPerBin (std::max (binSize, 1)),
+      binsPerLevel (bins),
+      maxPacketSize (packetSize),
+      pyramid (numChannels, numLevels, bins)
+{
+    binsPerPacket = peaks::maxBinsPerSummary (numChannels);
+
+    while (binsPerPacket > 1 && packetOverhead + peaks::summarySize (binsPerPacket, numChannels) > maxPacketSize)
+        --binsPerPacket;
+}
+
+void WaveformPublisher::prepare (std::size_t ringCapacity)
+{
+    if (isPrepared())
+        return;
+
+    ring = std::make_unique<SpscRing<LevelZeroBin>> (ringCapacity > 0 ? ringCapacity : std::max<std::size_t> (binsPerLevel, 256));
+    pyramid.allocate();
+    buffer.resize (maxPacketSize);
+    scratch.resize (static_cast<std::size_t> (binsPerPacket * numChannels));
+    prepared.store (true, std::memory_order_release);
+}
+
+//==============================================================================
+void WaveformPublisher::pushBlock (const float* const* channels, int numInputChannels, int numSamples) noexcept
+{
+    if (! prepared.load (std::memory_order_acquire))
+        return;
+
+    std::uint64_t numQueued = 0, numOverflowed = 0;
+
+    for (int start = 0; start < numSamples;)
+    {
+        const int n = std::min (numSamples - start, samplesPerBin - samplesInBin);
+
+        for (int c = 0; c < numChannels; ++c)
+        {
+            auto& bin = current.channels[static_cast<std::size_t> (c)];
+            float lo = samplesInBin == 0 ? 0.0f : bin.min;
+            float hi = samplesInBin == 0 ? 0.0f : bin.max;
+
+            if (c < numInputChannels && channels[c] != nullptr)
+            {
+                const float* data = channels[c] + start;
+
+                if (samplesInBin == 0)
+                    lo = hi = data[0];
+
+                for (int i = 0; i < n; ++i)
+                {
+                    lo = data[i] < lo ? data[i] : lo;
+                    hi = data[i] > hi ? data[i] : hi;
+                }
+            }
+
+            bin = { lo, hi };
+        }
+
+        samplesInBin += n;
+        start += n;
+
+        if (samplesInBin == samplesPerBin)
+        {
+            if (ring->push (current))
+                ++numQueued;
+            else
+                ++numOverflowed;
+
+            samplesInBin = 0;
+        }
+    }
+
+    if (numQueued > 0)
+        queued.fetch_add (numQueued, std::memory_order_relaxed);
+
+    if (numOverflowed > 0)
+        ringOverflows.fetch_add (numOverflowed, std::memory_order_relaxed);
+}
+
+//==============================================================================
+void WaveformPublisher::update() noexcept
+{
+    if (! isPrepared())
+        return;
+
+    LevelZeroBin bin;
+
+    while (ring->pop (bin))
+        pyramid.append (bin.channels.data());
+}
+
+void WaveformPublisher::setLiveLevel (int level) noexcept
+{
+    liveLevel = level >= 0 && level < pyramid.getNumLevels() ? level : -1;
+
+    if (liveLevel >= 0)
+        liveNext = pyramid.getEnd (liveLevel);
+}
+
+std::size_t WaveformPublisher::publish (PacketSink& sink, StreamSequencer& seq)
+{
+    update();
+
+    if (liveLevel < 0)
+        return 0;
+
+    const auto end = pyramid.getEnd (liveLevel);
+    const auto first = std::max (liveNext, pyramid.getBegin (liveLevel));
+    liveNext = end;
+    return sendRange (StreamId::waveform, liveLevel, first, end, sink, seq);
+}
+
+std::size_t WaveformPublisher::answer (const peaks::Request& r, PacketSink& sink, StreamSequencer& seq)
+{
+    if (r.level < 0 || r.level >= pyramid.getNumLevels() || r.numBins <= 0)
+        return 0;
+
+    const auto begin = pyramid.getBegin (r.level);
+    const auto end = pyramid.getEnd (r.level);
+    // firstBin comes off the network: clip it before adding to it.
+    const auto first = std::clamp (r.firstBin < 0 ? end - r.numBins : r.firstBin, begin, end);
+    const auto last = std::min (first + r.numBins, end);
+
+    return sendRange (StreamId::control, r.level, first, last, sink, seq);
+}
+
+std::size_t WaveformPublisher::sendRange (StreamId stream, int level, std::int64_t first, std::int64_t end,
+                                          PacketSink& sink, StreamSequencer& seq)
+{
+    std::size_t sent = 0;
+    const auto n = static_cast<std::size_t> (numChannels);
+
+    while (first < end)
+    {
+        const auto count = static_cast<std::int32_t> (std::min<std::int64_t> (end - first, binsPerPacket));
+
+        for (std::int32_t i = 0; i < count; ++i)
+            std::copy_n (pyramid.getBin (level, first + i), n, scratch.begin() + static_cast<std::ptrdiff_t> (static_cast<std::size_t> (i) * n));
+
+        OscWriter w (buffer.data(), buffer.size());
+        seq.beginPacket (w, stream);
+        peaks::writeSummary (w, { level, numChannels, count, first }, scratch.data());
+
+        // binsPerPacket is sized to fit, so this means the packet size is too
+        // small for even one bin; the rest wouldn't fit either.
+        if (w.hasOverflowed())
+            break;
+
+        sink.send (w.getData(), w.getSize());
+
+        sent += w.getSize();
+        ++summaries;
+        first += count;
+    }
+
+    bytes += sent;
+    return sent;
+}
+
+WaveformPublisher::Stats WaveformPublisher::getStats() const noexcept
+{
+    Stats s;
+    s.bins = queued.load (std::memory_order_relaxed);
+    s.ringOverflows = ringOverflows.load (std::memory_order_relaxed);
+    s.summaries = summaries;
+    s.bytes = bytes;
+    return s;
+}
+
+void WaveformPublisher::reportMemory (MemoryReport& report) const
+{
+    if (ring != nullptr)
+        report.add (MemoryReport::rings, ring->getMemoryUsage());
+
+    report.add (MemoryReport::pyramids, pyramid.getMemoryUsage());
+    report.add (MemoryReport::packets, buffer.capacity() + scratch.capacity() * sizeof (PeakBin));
+}
+
+} // namespace dawinfo
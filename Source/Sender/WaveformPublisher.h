@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Common/PacketSink.h"
+#include "Common/SpscRing.h"
+#include "Sender/PeakPyramid.h"
+#include "Sender/StreamSequencer.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+//==============================================================================
+/**
+    Publishes a scrolling waveform overview of the master bus.
+
+    The audio thread calls pushBlock(), which reduces the block to level-0
+    min/max bins of samplesPerBin samples and queues each finished bin in a
+    lock-free ring. The sender thread drains the ring into a PeakPyramid, so
+    every zoom level is prebuilt and a request for any of them is answered
+    from memory instead of raw samples.
+
+    Receivers either follow one level live (setLiveLevel(); publish() sends
+    the bins completed since the last call) or ask for a range with a
+    /dawinfo/peaks/request, which ControlChannel hands to answer(). Both go
+    out as /dawinfo/peaks summaries, one per packet: live bins on
+    StreamId::waveform, answers on StreamId::control like history chunks, so
+    one client's requests don't open gaps in everyone's waveform sequence.
+
+    The constructor only records the sizes. The ring, pyramid and packet
+    buffers - about a megabyte between them at the defaults - are allocated
+    by prepare() when the feature is first enabled, so an instance that
+    never shows a waveform doesn't pay for one.
+*/
+class WaveformPublisher
+{
+public:
+    struct Stats
+    {
+        std::uint64_t bins = 0;             // level-0 bins queued by the audio thread
+        std::uint64_t ringOverflows = 0;
+        std::uint64_t summaries = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    WaveformPublisher (int numChannels, int samplesPerBin = 64, int numLevels = 12,
+                       std::size_t binsPerLevel = 4096, std::size_t maxPacketSize = 1400);
+
+    /** Not for the audio thread. Allocates the storage; later calls do nothing.
+        ringCapacity is in level-0 bins; 0 sizes the ring for a whole level
+        of history (see BufferSizes for a smaller one).
+    */
+    void prepare (std::size_t ringCapacity = 0);
+
+    bool isPrepared() const noexcept                { return prepared.load (std::memory_order_acquire); }
+
+    /** Audio thread: summarises a block. Never blocks or allocates. Missing
+        channels read as silence; extra ones are ignored. Before prepare()
+        the block is ignored.
+    */
+    void pushBlock (const float* const* channels, int numChannels, int numSamples) noexcept;
+
+    /** Sender thread: -1 stops live updates. Live updates start from the newest bin. */
+    void setLiveLevel (int level) noexcept;
+    int getLiveLevel() const noexcept               { return liveLevel; }
+
+    /** Sender thread: drains the ring and sends new bins at the live level.
+        Returns the bytes sent; nothing before prepare().
+    */
+    std::size_t publish (PacketSink&, StreamSequencer&);
+
+    /** Sender thread: sends the requested range, clipped to what the pyramid
+        still holds. Returns the bytes sent.
+    */
+    std::size_t answer (const peaks::Request&, PacketSink&, StreamSequencer&);
+
+    /** Sender thread: drains the ring without sending. */
+    void update() noexcept;
+
+    const PeakPyramid& getPyramid() const noexcept  { return pyramid; }
+    int getSamplesPerBin() const noexcept           { return samplesPerBin; }
+
+    /** Sender thread (audio-thread counters are read atomically). */
+    Stats getStats() const noexcept;
+
+    /** Sender thread. Only the pyramid's counters until prepare(). */
+    void reportMemory (MemoryReport&) const;
+
+private:
+    struct LevelZeroBin
+    {
+        std::array<PeakBin, peaks::maxChannels> channels;
+    };
+
+    std::size_t sendRange (StreamId, int level, std::int64_t first, std::int64_t end, PacketSink&, StreamSequencer&);
+
+    const int numChannels, samplesPerBin;
+    const std::size_t binsPerLevel, maxPacketSize;
+
+    // Audio thread state.
+    std::unique_ptr<SpscRing<LevelZeroBin>> ring;
+    std::atomic<bool> prepared { false };
+    LevelZeroBin current {};
+    int samplesInBin = 0;
+    std::atomic<std::uint64_t> queued { 0 }, ringOverflows { 0 };
+
+    // Sender thread state.
+    PeakPyramid pyramid;
+    std::vector<std::uint8_t> buffer;
+    std::vector<PeakBin> scratch;
+    std::int32_t binsPerPacket = 0;
+    int liveLevel = -1;
+    std::int64_t liveNext = 0;
+    std::uint64_t summaries = 0, bytes = 0;
+};
+
+} // namespace dawinfo
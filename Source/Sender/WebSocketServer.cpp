@@ -0,0 +1,553 @@
+#include "Sender/WebSocketServer.h"
+#include "Common/Clock.h"
+#include "Sender/MemoryBudget.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+namespace dawinfo
+{
+
+namespace
+{
+    /** How often the server thread looks up to see if it should stop. */
+    constexpr int serverPollMs = 50;
+
+    /** Largest message accepted from a browser; they have nothing to say. */
+    constexpr std::uint64_t maxIncomingPayload = 65536;
+    constexpr std::uint64_t maxControlPayload = 125;       // RFC 6455 5.5
+
+   #ifdef MSG_NOSIGNAL
+    constexpr int sendFlags = MSG_NOSIGNAL;
+   #else
+    constexpr int sendFlags = 0;
+   #endif
+
+    void setNonBlocking (int fd) noexcept
+    {
+        ::fcntl (fd, F_SETFL, ::fcntl (fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    bool isUpgradeRequest (std::string_view request) noexcept
+    {
+        const auto upgrade = websocket::findHeader (request, "Upgrade");
+
+        return request.substr (0, 4) == "GET "
+            && upgrade.size() == 9 && (upgrade[0] == 'w' || upgrade[0] == 'W')
+            && upgrade.substr (1) == "ebsocket"
+            && websocket::findHeader (request, "Sec-WebSocket-Version") == "13"
+            && ! websocket::findHeader (request, "Sec-WebSocket-Key").empty();
+    }
+}
+
+//==============================================================================
+struct WebSocketServer::Client
+{
+    explicit Client (const CoalescingQueue::Options& o) : queue (o) {}
+
+    // Shared with send(), under lock.
+    std::mutex lock;
+    std::atomic<bool> open { false };
+    CoalescingQueue queue;
+
+    // Server thread only.
+    int fd = -1;
+    bool upgraded = false;
+    HostTimeNs acceptedNs = 0;
+    std::string request;
+    std::vector<std::uint8_t> incoming;
+    std::vector<std::uint8_t> inFlight;
+    std::size_t inFlightSent = 0;
+    std::vector<std::uint8_t> control;      // pongs and closes, sent between frames
+    bool closeAfterFlush = false;
+};
+
+WebSocketServer::WebSocketServer() : WebSocketServer (Options()) {}
+
+WebSocketServer::WebSocketServer (const Options& o) : options (o) {}
+
+WebSocketServer::~WebSocketServer()
+{
+    stop();
+}
+
+bool WebSocketServer::start (int requestedPort, bool loopbackOnly)
+{
+    stop();
+
+    if (requestedPort < 0 || requestedPort > 65535)
+        return false;
+
+    listenFd = ::socket (AF_INET, SOCK_STREAM, 0);
+
+    if (listenFd < 0)
+        return false;
+
+    const int yes = 1;
+    ::setsockopt (listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof (yes));
+
+    sockaddr_in local {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl (loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+    local.sin_port = htons (static_cast<std::uint16_t> (requestedPort));
+    socklen_t length = sizeof (local);
+
+    if (::bind (listenFd, reinterpret_cast<const sockaddr*> (&local), sizeof (local)) != 0
+         || ::listen (listenFd, 64) != 0
+         || ::getsockname (listenFd, reinterpret_cast<sockaddr*> (&local), &length) != 0
+         || ::pipe (wakeFds) != 0)
+    {
+        stop();
+        return false;
+    }
+
+    // The client slots are made on the first start, and kept across restarts.
+    if (clients.empty())
+    {
+        CoalescingQueue::Options queueOptions;
+        queueOptions.fifoCapacity = options.queueFrames;
+
+        for (int i = 0; i < std::max (options.maxClients, 1); ++i)
+            clients.push_back (std::make_unique<Client> (queueOptions));
+    }
+
+    setNonBlocking (listenFd);
+    setNonBlocking (wakeFds[0]);
+    setNonBlocking (wakeFds[1]);
+    port = ntohs (local.sin_port);
+
+    // A wake byte written just before the last stop() may never have been read.
+    wakePending = false;
+    running = true;
+    thread = std::thread ([this] { serve(); });
+    return true;
+}
+
+void WebSocketServer::stop()
+{
+    running = false;
+
+    if (thread.joinable())
+        thread.join();
+
+    for (auto& c : clients)
+        if (c->fd >= 0)
+            disconnect (*c);
+
+    for (int* fd : { &listenFd, &wakeFds[0], &wakeFds[1] })
+    {
+        if (*fd >= 0)
+            ::close (*fd);
+
+        *fd = -1;
+    }
+
+    port = 0;
+}
+
+//==============================================================================
+bool WebSocketServer::send (const std::uint8_t* data, std::size_t size)
+{
+    if (size > options.maxFrameSize)
+        return false;
+
+    packets.fetch_add (1, std::memory_order_relaxed);
+
+    if (clients.empty())
+        return true;
+
+    std::uint8_t header[websocket::maxHeaderSize];
+    websocket::FrameHeader h;
+    h.payloadSize = size;
+    const auto headerSize = websocket::writeFrameHeader (header, h);
+    const auto key = clients.front()->queue.keyFor (data, size);
+    std::uint64_t queued = 0, dropped = 0;
+
+    for (auto& c : clients)
+    {
+        if (! c->open.load (std::memory_order_acquire))
+            continue;
+
+        std::lock_guard<std::mutex> lock (c->lock);
+
+        if (! c->open.load (std::memory_order_relaxed))
+            continue;
+
+        if (c->queue.push (key, data, size, header, headerSize))
+            ++dropped;
+
+        ++queued;
+    }
+
+    if (queued > 0)
+    {
+        framesQueued.fetch_add (queued, std::memory_order_relaxed);
+        framesDropped.fetch_add (dropped, std::memory_order_relaxed);
+        wake();
+    }
+
+    return true;
+}
+
+void WebSocketServer::wake() noexcept
+{
+    if (! wakePending.exchange (true, std::memory_order_acq_rel))
+    {
+        const std::uint8_t byte = 1;
+        [[maybe_unused]] const auto written = ::write (wakeFds[1], &byte, 1);
+    }
+}
+
+WebSocketServer::Stats WebSocketServer::getStats() const noexcept
+{
+    Stats s;
+    s.clients = numOpen.load (std::memory_order_relaxed);
+    s.accepted = accepted.load (std::memory_order_relaxed);
+    s.rejected = rejected.load (std::memory_order_relaxed);
+    s.closed = closed.load (std::memory_order_relaxed);
+    s.packets = packets.load (std::memory_order_relaxed);
+    s.framesQueued = framesQueued.load (std::memory_order_relaxed);
+    s.framesDropped = framesDropped.load (std::memory_order_relaxed);
+    s.framesSent = framesSent.load (std::memory_order_relaxed);
+    s.bytesSent = bytesSent.load (std::memory_order_relaxed);
+    return s;
+}
+
+//==============================================================================
+void WebSocketServer::serve()
+{
+    std::vector<pollfd> fds;
+    std::vector<Client*> polled;
+
+    while (running.load (std::memory_order_relaxed))
+    {
+        fds.assign ({ { listenFd, POLLIN, 0 }, { wakeFds[0], POLLIN, 0 } });
+        polled.clear();
+
+        for (auto& c : clients)
+        {
+            if (c->fd < 0)
+                continue;
+
+            // A client that sends faster than it reads its replies is left
+            // unread until they go out, so the replies can't pile up.
+            const bool pending = c->inFlightSent < c->inFlight.size() || ! c->control.empty();
+            const bool readable = c->control.empty() && ! c->closeAfterFlush;
+            fds.push_back ({ c->fd, static_cast<short> ((readable ? POLLIN : 0) | (pending ? POLLOUT : 0)), 0 });
+            polled.push_back (c.get());
+        }
+
+        // A timeout still falls through to the flush below, so a missed
+        // wake-up delays frames by one poll at most.
+        if (::poll (fds.data(), static_cast<nfds_t> (fds.size()), serverPollMs) < 0)
+            continue;
+
+        if ((fds[1].revents & POLLIN) != 0)
+        {
+            wakePending.store (false, std::memory_order_release);
+            std::uint8_t drain[64];
+
+            while (::read (wakeFds[0], drain, sizeof (drain)) > 0)
+            {
+            }
+        }
+
+        if ((fds[0].revents & POLLIN) != 0)
+            accept();
+
+        for (std::size_t i = 0; i < polled.size(); ++i)
+        {
+            auto& c = *polled[i];
+            const auto events = fds[i + 2].revents;
+
+            if ((events & (POLLERR | POLLHUP | POLLNVAL)) != 0 && (events & POLLIN) == 0)
+            {
+                disconnect (c);
+                continue;
+            }
+
+            if ((events & POLLIN) != 0)
+                onReadable (c);
+        }
+
+        // Anything queued since, or waiting for room in the socket.
+        for (auto& c : clients)
+            if (c->fd >= 0 && c->upgraded && ! flush (*c))
+                disconnect (*c);
+
+        closeStalledHandshakes();
+    }
+}
+
+/** A connection that never finishes its upgrade would hold a slot for good. */
+void WebSocketServer::closeStalledHandshakes()
+{
+    const auto deadlineNs = monotonicNowNs() - static_cast<HostTimeNs> (options.handshakeTimeoutMs) * 1'000'000;
+
+    for (auto& c : clients)
+    {
+        if (c->fd >= 0 && ! c->upgraded && c->acceptedNs < deadlineNs)
+        {
+            rejected.fetch_add (1, std::memory_order_relaxed);
+            disconnect (*c);
+        }
+    }
+}
+
+void WebSocketServer::accept()
+{
+    for (;;)
+    {
+        const int fd = ::accept (listenFd, nullptr, nullptr);
+
+        if (fd < 0)
+            return;
+
+        auto free = std::find_if (clients.begin(), clients.end(), [] (const auto& c) { return c->fd < 0; });
+
+        if (free == clients.end())
+        {
+            rejected.fetch_add (1, std::memory_order_relaxed);
+            ::close (fd);
+            continue;
+        }
+
+        const int yes = 1;
+        ::setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof (yes));
+       #ifdef SO_NOSIGPIPE
+        ::setsockopt (fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof (yes));
+       #endif
+        setNonBlocking (fd);
+
+        auto& c = **free;
+        c.fd = fd;
+        c.upgraded = false;
+        c.acceptedNs = monotonicNowNs();
+        c.closeAfterFlush = false;
+        c.request.clear();
+        c.incoming.clear();
+        c.inFlight.clear();
+        c.inFlightSent = 0;
+        c.control.clear();
+    }
+}
+
+void WebSocketServer::onReadable (Client& c)
+{
+    std::uint8_t buffer[4096];
+
+    for (;;)
+    {
+        const auto n = ::recv (c.fd, buffer, sizeof (buffer), 0);
+
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            disconnect (c);
+            return;
+        }
+
+        if (n < 0)
+            return;
+
+        bool ok = true;
+
+        if (! c.upgraded)
+        {
+            c.request.append (reinterpret_cast<const char*> (buffer), static_cast<std::size_t> (n));
+            ok = handleHandshake (c);
+        }
+        else
+        {
+            c.incoming.insert (c.incoming.end(), buffer, buffer + n);
+            ok = handleFrames (c);
+        }
+
+        if (! ok)
+        {
+            disconnect (c);
+            return;
+        }
+
+        if (c.fd < 0)
+            return;
+    }
+}
+
+bool WebSocketServer::handleHandshake (Client& c)
+{
+    const auto end = c.request.find ("\r\n\r\n");
+
+    if (end == std::string::npos)
+    {
+        if (c.request.size() <= options.maxRequestSize)
+            return true;
+    }
+    else if (isUpgradeRequest (std::string_view (c.request).substr (0, end + 2)))
+    {
+        const auto key = websocket::findHeader (c.request, "Sec-WebSocket-Key");
+        const auto response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                              "Sec-WebSocket-Accept: " + websocket::acceptKey (key) + "\r\n\r\n";
+
+        if (::send (c.fd, response.data(), response.size(), sendFlags) != static_cast<ssize_t> (response.size()))
+            return false;
+
+        c.upgraded = true;
+        c.request.clear();
+
+        {
+            std::lock_guard<std::mutex> lock (c.lock);
+            c.queue.clear();
+            c.open.store (true, std::memory_order_release);
+        }
+
+        numOpen.fetch_add (1, std::memory_order_relaxed);
+        accepted.fetch_add (1, std::memory_order_relaxed);
+        return true;
+    }
+
+    static constexpr std::string_view badRequest = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    ::send (c.fd, badRequest.data(), badRequest.size(), sendFlags);
+    rejected.fetch_add (1, std::memory_order_relaxed);
+    return false;
+}
+
+bool WebSocketServer::handleFrames (Client& c)
+{
+    std::size_t used = 0;
+
+    while (used < c.incoming.size())
+    {
+        websocket::FrameHeader h;
+        const int headerSize = websocket::parseFrameHeader (c.incoming.data() + used, c.incoming.size() - used, h);
+
+        if (headerSize < 0 || (headerSize > 0 && (! h.masked || h.payloadSize > maxIncomingPayload)))
+            return false;
+
+        if (headerSize == 0 || c.incoming.size() - used < headerSize + h.payloadSize)
+            break;
+
+        if ((h.opcode == websocket::ping || h.opcode == websocket::close) && h.payloadSize > maxControlPayload)
+            return false;
+
+        auto* payload = c.incoming.data() + used + headerSize;
+        const auto size = static_cast<std::size_t> (h.payloadSize);
+        websocket::applyMask (payload, size, h.mask);
+        used += static_cast<std::size_t> (headerSize) + size;
+
+        if (h.opcode == websocket::ping || h.opcode == websocket::close)
+        {
+            websocket::FrameHeader reply;
+            reply.opcode = h.opcode == websocket::ping ? websocket::pong : websocket::close;
+            reply.payloadSize = size;
+
+            std::uint8_t header[websocket::maxHeaderSize];
+            const auto replyHeaderSize = websocket::writeFrameHeader (header, reply);
+
+            // Only the latest ping needs its pong (RFC 6455 5.5.3), so at
+            // most one reply waits here.
+            c.control.assign (header, header + replyHeaderSize);
+            c.control.insert (c.control.end(), payload, payload + size);
+
+            if (h.opcode == websocket::close)
+            {
+                // Anything after the close is ignored.
+                used = c.incoming.size();
+                c.closeAfterFlush = true;
+
+                // Nothing more goes out after the close.
+                std::lock_guard<std::mutex> lock (c.lock);
+                c.open.store (false, std::memory_order_relaxed);
+                c.queue.clear();
+            }
+        }
+    }
+
+    c.incoming.erase (c.incoming.begin(), c.incoming.begin() + static_cast<std::ptrdiff_t> (used));
+    return true;
+}
+
+/** Writes as much as the socket takes. False if the connection failed. */
+bool WebSocketServer::flush (Client& c)
+{
+    for (;;)
+    {
+        if (c.inFlightSent == c.inFlight.size())
+        {
+            // Between frames: control replies go first, then the oldest queued frame.
+            if (! c.control.empty())
+            {
+                std::swap (c.inFlight, c.control);
+                c.control.clear();
+            }
+            else
+            {
+                if (c.closeAfterFlush)
+                {
+                    disconnect (c);
+                    return true;
+                }
+
+                std::lock_guard<std::mutex> lock (c.lock);
+
+                if (! c.queue.pop (c.inFlight))
+                    return true;
+
+                framesSent.fetch_add (1, std::memory_order_relaxed);
+            }
+
+            c.inFlightSent = 0;
+        }
+
+        const auto n = ::send (c.fd, c.inFlight.data() + c.inFlightSent, c.inFlight.size() - c.inFlightSent, sendFlags);
+
+        if (n < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+        c.inFlightSent += static_cast<std::size_t> (n);
+        bytesSent.fetch_add (static_cast<std::uint64_t> (n), std::memory_order_relaxed);
+    }
+}
+
+void WebSocketServer::disconnect (Client& c)
+{
+    {
+        std::lock_guard<std::mutex> lock (c.lock);
+
+        if (c.upgraded)
+            numOpen.fetch_sub (1, std::memory_order_relaxed);
+
+        c.open.store (false, std::memory_order_relaxed);
+        c.queue.clear();
+    }
+
+    if (c.upgraded)
+        closed.fetch_add (1, std::memory_order_relaxed);
+
+    ::close (c.fd);
+    c.fd = -1;
+    c.upgraded = false;
+    c.inFlight.clear();
+    c.inFlightSent = 0;
+    c.control.clear();
+}
+
+void WebSocketServer::reportMemory (MemoryReport& report) const
+{
+    report.add (MemoryReport::queues, clients.capacity() * sizeof (std::unique_ptr<Client>) + clients.size() * sizeof (Client));
+
+    for (auto& c : clients)
+    {
+        std::lock_guard<std::mutex> lock (c->lock);
+        c->queue.reportMemory (report);
+    }
+}
+
+} // namespace dawinfo
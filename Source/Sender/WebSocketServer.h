@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Common/PacketSink.h"
+#include "Common/WebSocket.h"
+#include "Sender/CoalescingQueue.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dawinfo
+{
+
+struct MemoryReport;
+
+//==============================================================================
+/**
+    Serves the sender's packets to browsers as binary WebSocket frames, so a
+    dashboard needs no OSC-to-WebSocket relay in between. Each frame carries
+    exactly the bundle the UDP destinations get.
+
+    It is a PacketSink: the sender thread adds it to its sinks, and send()
+    copies the packet into each connected client's CoalescingQueue. A state
+    packet replaces the one for its stream still waiting, and events queue
+    in a bounded FIFO that drops its oldest, so a browser that falls behind
+    sees the newest state once it catches up, and never holds back the
+    sender or the other clients. send() takes one uncontended lock per
+    client and allocates nothing once each queue slot has held a packet
+    that size.
+
+    Everything else - accepting, the HTTP upgrade, writing queued frames
+    with non-blocking sends, answering pings and closes - happens on the
+    server's own thread, started by start(). Messages from browsers are read
+    and discarded. Until the first start() the server holds no sockets,
+    thread or client slots, and send() returns straight away. Call start()
+    and stop() on the sender thread, or while it isn't sending.
+
+    POSIX only.
+*/
+class WebSocketServer : public PacketSink
+{
+public:
+    struct Options
+    {
+        int maxClients = 64;
+        int queueFrames = 8;                    // per client, for FIFO streams; a full queue drops its oldest
+        std::size_t maxFrameSize = 65507;       // larger packets are refused
+        std::size_t maxRequestSize = 4096;      // the HTTP upgrade request
+        int handshakeTimeoutMs = 5000;          // a connection not upgraded by then is closed
+    };
+
+    struct Stats
+    {
+        int clients = 0;                        // open connections
+        std::uint64_t accepted = 0;             // successful upgrades
+        std::uint64_t rejected = 0;             // server full, or a bad or unfinished handshake
+        std::uint64_t closed = 0;
+        std::uint64_t packets = 0;              // send() calls
+        std::uint64_t framesQueued = 0;         // summed over clients
+        std::uint64_t framesDropped = 0;        // stale frames replaced or pushed out of full queues
+        std::uint64_t framesSent = 0;
+        std::uint64_t bytesSent = 0;
+    };
+
+    WebSocketServer();
+    explicit WebSocketServer (const Options&);
+    ~WebSocketServer() override;
+
+    /** Listens on the port (0 picks one) and starts the server thread. */
+    bool start (int port = 0, bool loopbackOnly = false);
+    void stop();
+
+    int getPort() const noexcept        { return port; }
+
+    /** Sender thread: queues the packet as a binary frame for every open client. */
+    bool send (const std::uint8_t* data, std::size_t size) override;
+
+    /** Any thread. */
+    Stats getStats() const noexcept;
+
+    /** Any thread. The client slots and their queues; the server thread's
+        read and write buffers aren't counted.
+    */
+    void reportMemory (MemoryReport&) const;
+
+private:
+    struct Client;
+
+    void serve();
+    void accept();
+    void onReadable (Client&);
+    bool handleHandshake (Client&);
+    bool handleFrames (Client&);
+    bool flush (Client&);
+    void disconnect (Client&);
+    void closeStalledHandshakes();
+    void wake() noexcept;
+
+    const Options options;
+    std::vector<std::unique_ptr<Client>> clients;
+
+    int listenFd = -1;
+    int wakeFds[2] = { -1, -1 };
+    int port = 0;
+    std::thread thread;
+    std::atomic<bool> running { false }, wakePending { false };
+
+    std::atomic<int> numOpen { 0 };
+    std::atomic<std::uint64_t> accepted { 0 }, rejected { 0 }, closed { 0 }, packets { 0 };
+    std::atomic<std::uint64_t> framesQueued { 0 }, framesDropped { 0 }, framesSent { 0 }, bytesSent { 0 };
+};
+
+} // namespace dawinfo
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/*  Counts heap allocations made by threads that opt in, by replacing the
+    global operator new. Include from exactly one file per test executable.
+*/
+namespace dawinfo::test
+{
+    inline thread_local bool countThisThread = false;
+    inline std::atomic<std::uint64_t> countedAllocations { 0 };
+
+    /** Counts this thread's allocations while alive. */
+    struct ScopedAllocationCount
+    {
+        ScopedAllocationCount() noexcept     { countThisThread = true; }
+        ~ScopedAllocationCount()             { countThisThread = false; }
+    };
+
+    inline std::uint64_t allocationCount() noexcept  { return countedAllocations.load(); }
+}
+
+// operator new is malloc underneath, so freeing its memory is correct.
+#if defined (__GNUC__) && ! defined (__clang__)
+ #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new (std::size_t size)
+{
+    if (dawinfo::test::countThisThread)
+        dawinfo::test::countedAllocations.fetch_add (1, std::memory_order_relaxed);
+
+    if (void* p = std::malloc (size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)                         { return operator new (size); }
+void operator delete (void* p) noexcept                         { std::free (p); }
+void operator delete[] (void* p) noexcept                       { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept            { std::free (p); }
+void operator delete[] (void* p, std::size_t) noexcept          { std::free (p); }
@@ -0,0 +1,304 @@
+#include "AllocationCounter.h"
+#include "Sender/AnalysisInput.h"
+#include "TestHarness.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    struct Buffers
+    {
+        std::vector<std::vector<float>> data;
+        std::vector<float*> pointers;
+
+        Buffers (int numChannels, int numFrames)
+            : data (static_cast<std::size_t> (numChannels), std::vector<float> (static_cast<std::size_t> (numFrames)))
+        {
+            for (auto& d : data)
+                pointers.push_back (d.data());
+        }
+    };
+
+    float maxDifference (const Buffers& a, const Buffers& b, int numChannels, int numFrames)
+    {
+        float worst = 0.0f;
+
+        for (int c = 0; c < numChannels; ++c)
+            for (int i = 0; i < numFrames; ++i)
+                worst = std::max (worst, std::abs (a.data[c][i] - b.data[c][i]));
+
+        return worst;
+    }
+
+    void testKernelsMatchScalar()
+    {
+        std::mt19937 random (7);
+        std::uniform_real_distribution<float> sample (-1.0f, 1.0f);
+
+        for (const int numChannels : { 1, 2, 5, 6, 8, 12 })
+        {
+            for (const int numFrames : { 0, 1, 3, 8, 61, 512 })
+            {
+                Buffers in (numChannels, numFrames);
+                std::vector<float> interleaved (static_cast<std::size_t> (numChannels * numFrames));
+                std::vector<std::int16_t> pcm (interleaved.size());
+
+                for (std::size_t i = 0; i < interleaved.size(); ++i)
+                {
+                    interleaved[i] = sample (random);
+                    pcm[i] = static_cast<std::int16_t> (interleaved[i] * 32767.0f);
+                }
+
+                // Deinterleaving is exact either way.
+                Buffers fast (numChannels, numFrames), reference (numChannels, numFrames);
+                kernels::deinterleave (interleaved.data(), numChannels, numFrames, fast.pointers.data());
+                kernels::scalar::deinterleave (interleaved.data(), numChannels, numFrames, reference.pointers.data());
+                DAWINFO_CHECK (maxDifference (fast, reference, numChannels, numFrames) == 0.0f);
+
+                kernels::deinterleave (pcm.data(), numChannels, numFrames, fast.pointers.data());
+                kernels::scalar::deinterleave (pcm.data(), numChannels, numFrames, reference.pointers.data());
+                DAWINFO_CHECK (maxDifference (fast, reference, numChannels, numFrames) == 0.0f);
+
+                if (numFrames > 0)
+                    DAWINFO_CHECK (fast.data[0][0] == pcm[0] / 32768.0f);
+
+                // Downmixing only differs by rounding.
+                for (const int numOutputs : { 1, 2 })
+                {
+                    const auto m = DownmixMatrix::create (layoutForChannelCount (numChannels), numChannels, numOutputs);
+                    Buffers mixed (numOutputs, numFrames), mixedReference (numOutputs, numFrames);
+                    const std::vector<const float*> inputs (reference.pointers.begin(), reference.pointers.end());
+
+                    kernels::downmix (inputs.data(), numFrames, m, mixed.pointers.data());
+                    kernels::scalar::downmix (inputs.data(), numFrames, m, mixedReference.pointers.data());
+                    DAWINFO_CHECK (maxDifference (mixed, mixedReference, numOutputs, numFrames) < 1.0e-6f);
+                }
+            }
+        }
+    }
+
+    void testDownmixMatrix()
+    {
+        const auto stereo = DownmixMatrix::create (ChannelLayout::stereo, 2, 2);
+        DAWINFO_CHECK (stereo.gains[0][0] == 1.0f && stereo.gains[0][1] == 0.0f && stereo.gains[1][1] == 1.0f);
+
+        const auto toMono = DownmixMatrix::create (ChannelLayout::stereo, 2, 1);
+        DAWINFO_CHECK (toMono.gains[0][0] == 0.5f && toMono.gains[0][1] == 0.5f);
+
+        const auto monoToStereo = DownmixMatrix::create (ChannelLayout::mono, 1, 2);
+        DAWINFO_CHECK (monoToStereo.gains[0][0] == 1.0f && monoToStereo.gains[1][0] == 1.0f);
+
+        // 5.1: centre equally in both sides, LFE nowhere, left surround only left.
+        const auto surround = DownmixMatrix::create (ChannelLayout::surround51, 6, 2);
+        DAWINFO_CHECK (surround.gains[0][2] == surround.gains[1][2] && surround.gains[0][2] > 0.0f);
+        DAWINFO_CHECK (surround.gains[0][3] == 0.0f && surround.gains[1][3] == 0.0f);
+        DAWINFO_CHECK (surround.gains[0][4] > 0.0f && surround.gains[1][4] == 0.0f);
+
+        // No output can exceed full scale with every input at full scale.
+        for (const int n : { 6, 8, 12, 16 })
+        {
+            const auto m = DownmixMatrix::create (layoutForChannelCount (n), n, 2);
+
+            for (int o = 0; o < 2; ++o)
+            {
+                float total = 0.0f;
+
+                for (int c = 0; c < n; ++c)
+                    total += m.gains[o][c];
+
+                DAWINFO_CHECK (total <= 1.0001f && total > 0.5f);
+            }
+        }
+    }
+
+    /** RMS of (output - the tone it should be) over the settled part. */
+    double toneError (double inputRate, double frequency, double& outputRms, int& numOutput)
+    {
+        PolyphaseResampler r;
+        DAWINFO_CHECK (r.prepare (inputRate, 48000.0, 1, 512));
+
+        const int numInput = static_cast<int> (inputRate);
+        std::vector<float> in (static_cast<std::size_t> (numInput));
+        std::vector<float> out (static_cast<std::size_t> (numInput * 48000.0 / inputRate) + 1024);
+
+        for (int i = 0; i < numInput; ++i)
+            in[static_cast<std::size_t> (i)] = 0.5f * static_cast<float> (std::sin (2.0 * pi * frequency * i / inputRate));
+
+        numOutput = 0;
+
+        for (int start = 0; start < numInput; start += 512)
+        {
+            const float* block[] = { in.data() + start };
+            float* dest[] = { out.data() + numOutput };
+            numOutput += r.process (block, std::min (512, numInput - start), dest);
+        }
+
+        const double latency = r.getLatency();
+        double error = 0.0, power = 0.0;
+        int count = 0;
+
+        for (int n = 4096; n < numOutput - 4096; ++n)
+        {
+            const double expected = 0.5 * std::sin (2.0 * pi * frequency * (n - latency) / 48000.0);
+            error += (out[n] - expected) * (out[n] - expected);
+            power += out[n] * out[n];
+            ++count;
+        }
+
+        outputRms = std::sqrt (power / count);
+        return std::sqrt (error / count);
+    }
+
+    void testResampler()
+    {
+        for (const double rate : { 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 })
+        {
+            double rms = 0.0;
+            int numOutput = 0;
+            const double error = toneError (rate, 1000.0, rms, numOutput);
+
+            std::printf ("%6.0f Hz -> 48 kHz: %d frames out, 1 kHz tone error %.2e (rms %.3f)\n", rate, numOutput, error, rms);
+
+            // One second in, one second out (less what the filter still holds).
+            DAWINFO_CHECK (numOutput <= 48000 && numOutput > 48000 - 200);
+            DAWINFO_CHECK (error < 1.0e-3);
+            DAWINFO_CHECK_NEAR (rms, 0.5 / std::sqrt (2.0), 1.0e-3);
+        }
+
+        // Content above the analysis Nyquist frequency is filtered out, not folded back.
+        double rms = 0.0;
+        int numOutput = 0;
+        toneError (96000.0, 30000.0, rms, numOutput);
+        std::printf ("30 kHz tone from 96 kHz: rms %.2e\n", rms);
+        DAWINFO_CHECK (rms < 0.5 * 0.01);
+
+        toneError (192000.0, 60000.0, rms, numOutput);
+        DAWINFO_CHECK (rms < 0.5 * 0.01);
+
+        PolyphaseResampler r;
+        DAWINFO_CHECK (r.prepare (44100.0, 48000.0, 2, 256) && r.getUpFactor() == 160 && r.getDownFactor() == 147);
+        DAWINFO_CHECK (r.prepare (192000.0, 48000.0, 2, 256) && r.getUpFactor() == 1 && r.getDownFactor() == 4);
+        DAWINFO_CHECK (! r.prepare (44100.5, 48000.0, 2, 256));
+        DAWINFO_CHECK (! r.prepare (47999.0, 48000.0, 2, 256));        // 48000/47999: up too large
+        DAWINFO_CHECK (! r.prepare (48000.0, 48000.0, 0, 256));
+
+        // A block longer than prepared is done in pieces, within the bound for its length.
+        DAWINFO_CHECK (r.prepare (44100.0, 48000.0, 1, 64));
+        std::vector<float> longIn (640, 0.25f), longOut (static_cast<std::size_t> (r.getMaxOutputFrames (640)));
+        const float* longInput[] = { longIn.data() };
+        float* longOutput[] = { longOut.data() };
+        int longTotal = 0;
+
+        for (int block = 0; block < 20; ++block)
+        {
+            const auto written = r.process (longInput, 640, longOutput);
+            DAWINFO_CHECK (written > r.getMaxOutputFrames() && written <= r.getMaxOutputFrames (640));
+            longTotal += written;
+        }
+
+        DAWINFO_CHECK (std::abs (longTotal - 20 * 640 * 160 / 147) <= 2);
+
+        // Resamplers of the same ratio and length share one filter bank.
+        PolyphaseResampler a, b, c;
+        DAWINFO_CHECK (a.prepare (44100.0, 48000.0, 2, 256) && b.prepare (88200.0, 96000.0, 1, 512) && c.prepare (44100.0, 48000.0, 2, 256, 32));
+        DAWINFO_CHECK (a.getCoefficients() != nullptr && a.getCoefficients() == b.getCoefficients());
+        DAWINFO_CHECK (a.getCoefficients() != c.getCoefficients());
+    }
+
+    void testAnalysisInput()
+    {
+        AnalysisInput input;
+        DAWINFO_CHECK (input.prepare (96000.0, 12, 256));
+        DAWINFO_CHECK (input.isResampling() && input.getDownmix().numInputs == 12);
+
+        Buffers host (12, 256);
+
+        for (int i = 0; i < 256; ++i)
+            for (int c = 0; c < 12; ++c)
+                host.data[c][i] = 0.25f * static_cast<float> (std::sin (0.01 * i * (c + 1)));
+
+        const std::vector<const float*> channels (host.pointers.begin(), host.pointers.end());
+        int total = 0;
+
+        {
+            test::ScopedAllocationCount counting;
+
+            for (int block = 0; block < 100; ++block)
+            {
+                const auto out = input.process (channels.data(), 12, 256);
+                DAWINFO_CHECK (out.numChannels == 2 && out.numFrames >= 127 && out.numFrames <= 129);
+                total += out.numFrames;
+            }
+
+            DAWINFO_CHECK (test::allocationCount() == 0);
+        }
+
+        DAWINFO_CHECK (std::abs (total - 12800) < 64);
+
+        // A host block longer than prepared goes in over several calls.
+        Buffers longHost (12, 640);
+        std::vector<const float*> rest (longHost.pointers.begin(), longHost.pointers.end());
+        int used = 0, calls = 0;
+        total = 0;
+
+        while (used < 640)
+        {
+            const auto out = input.process (rest.data(), 12, 640 - used);
+            DAWINFO_CHECK (out.framesConsumed == std::min (256, 640 - used));
+            used += out.framesConsumed;
+            total += out.numFrames;
+            ++calls;
+
+            for (auto& p : rest)
+                p += out.framesConsumed;
+        }
+
+        DAWINFO_CHECK (calls == 3 && std::abs (total - 320) <= 2);
+
+        // At the analysis rate the block passes straight through the downmix.
+        AnalysisInput same;
+        DAWINFO_CHECK (same.prepare (48000.0, 2, 64) && ! same.isResampling());
+        std::vector<std::int16_t> pcm (128);
+
+        for (int i = 0; i < 64; ++i)
+        {
+            pcm[2 * i] = static_cast<std::int16_t> (i * 100);
+            pcm[2 * i + 1] = static_cast<std::int16_t> (-i * 100);
+        }
+
+        const auto out = same.processInterleaved (pcm.data(), 2, 64);
+        DAWINFO_CHECK (out.numFrames == 64 && out.channels[0][10] == 1000 / 32768.0f && out.channels[1][10] == -1000 / 32768.0f);
+        DAWINFO_CHECK (same.processInterleaved (pcm.data(), 6, 10).numFrames == 0);
+
+        // Missing host channels read as silence.
+        const float* onlyLeft[] = { host.pointers[0] };
+        const auto partial = same.process (onlyLeft, 1, 64);
+        DAWINFO_CHECK (partial.channels[1][5] == 0.0f && partial.channels[0][5] == host.data[0][5]);
+
+        // A rate the resampler refuses changes nothing: the stereo setup keeps
+        // working, and an input never prepared converts nothing.
+        DAWINFO_CHECK (! same.prepare (44100.5, 12, 256));
+        DAWINFO_CHECK (same.getDownmix().numInputs == 2 && same.process (channels.data(), 12, 64).numFrames == 64);
+
+        AnalysisInput unprepared;
+        DAWINFO_CHECK (! unprepared.prepare (44100.5, 12, 256));
+        const auto empty = unprepared.process (channels.data(), 12, 256);
+        DAWINFO_CHECK (empty.numChannels == 0 && empty.numFrames == 0 && empty.framesConsumed == 0);
+    }
+}
+
+int main()
+{
+    testKernelsMatchScalar();
+    testDownmixMatrix();
+    testResampler();
+    testAnalysisInput();
+    return dawinfo::test::finish ("AnalysisInputTests");
+}
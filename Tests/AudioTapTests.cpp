@@ -0,0 +1,411 @@
+#include "Common/Clock.h"
+#include "Receiver/AudioTapReader.h"
+#include "Sender/AudioTap.h"
+#include "TestHarness.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace dawinfo;
+
+namespace
+{
+    std::string tapName (const char* suffix)
+    {
+        return "/dawinfo_tap_test_" + std::to_string (::getpid()) + "_" + suffix;
+    }
+
+    /** Every sample encodes its frame number and channel, so any torn or
+        misplaced frame shows up.
+    */
+    float sampleFor (std::uint64_t frame, int channel)
+    {
+        return static_cast<float> ((frame * 2 + static_cast<std::uint64_t> (channel)) & 0xffffff);
+    }
+
+    struct Block
+    {
+        std::vector<std::vector<float>> data;
+        std::vector<const float*> pointers;
+
+        Block (int numChannels, int numFrames)
+            : data (static_cast<std::size_t> (numChannels), std::vector<float> (static_cast<std::size_t> (numFrames)))
+        {
+            for (auto& d : data)
+                pointers.push_back (d.data());
+        }
+
+        void fill (std::uint64_t firstFrame)
+        {
+            for (std::size_t c = 0; c < data.size(); ++c)
+                for (std::size_t i = 0; i < data[c].size(); ++i)
+                    data[c][i] = sampleFor (firstFrame + i, static_cast<int> (c));
+        }
+    };
+
+    /** Reads up to numFrames and counts frames that aren't what was written. */
+    int readAndCheck (AudioTapReader& reader, int numFrames, std::uint64_t& mismatches)
+    {
+        const auto v = reader.acquire (numFrames);
+        std::uint64_t bad = 0;
+
+        for (std::uint32_t i = 0; i < v.numFrames; ++i)
+            for (int c = 0; c < reader.getNumChannels(); ++c)
+                bad += v.getChannel (c)[i] == sampleFor (v.firstFrame + i, c) ? 0 : 1;
+
+        if (! reader.release (v))
+            return 0;
+
+        mismatches += bad;
+        return static_cast<int> (v.numFrames);
+    }
+
+    void testRoundTrip()
+    {
+        const auto name = tapName ("roundtrip");
+        AudioTap tap;
+        DAWINFO_CHECK (tap.open (name, 2, 1000, 48000.0));
+
+        AudioTapReader reader;
+        DAWINFO_CHECK (reader.open (name));
+        DAWINFO_CHECK (reader.getNumChannels() == 2 && reader.getCapacity() == 1024 && reader.getSampleRate() == 48000.0);
+
+        // Nothing written yet.
+        float left[600], right[600];
+        float* dest[] = { left, right };
+        DAWINFO_CHECK (reader.read (dest, 2, 100) == 0);
+        DAWINFO_CHECK (reader.getStats().overruns == 0 && reader.getStats().framesLost == 0);
+
+        // Blocks that straddle the ring's end come back intact.
+        Block block (2, 300);
+        std::uint64_t written = 0, mismatches = 0;
+
+        for (int b = 0; b < 10; ++b)
+        {
+            block.fill (written);
+            tap.write (block.pointers.data(), 2, 300);
+            written += 300;
+
+            DAWINFO_CHECK (reader.read (dest, 2, 300) == 300);
+
+            for (int i = 0; i < 300; ++i)
+                mismatches += (left[i] == sampleFor (written - 300 + static_cast<std::uint64_t> (i), 0) ? 0 : 1)
+                            + (right[i] == sampleFor (written - 300 + static_cast<std::uint64_t> (i), 1) ? 0 : 1);
+        }
+
+        DAWINFO_CHECK (mismatches == 0);
+        DAWINFO_CHECK (tap.getFramesWritten() == written);
+        DAWINFO_CHECK (reader.getStats().framesRead == written && reader.getStats().overruns == 0);
+
+        // A short read returns what there is, and loses nothing.
+        tap.write (block.pointers.data(), 2, 100);
+        DAWINFO_CHECK (reader.read (dest, 2, 600) == 100);
+        DAWINFO_CHECK (reader.getStats().overruns == 0 && reader.getStats().framesLost == 0);
+
+        // Missing channels read as silence.
+        tap.write (block.pointers.data(), 1, 50);
+        DAWINFO_CHECK (reader.read (dest, 2, 50) == 50 && right[0] == 0.0f && right[49] == 0.0f);
+
+        // Once the writer closes, the name is gone.
+        tap.close();
+        AudioTapReader late;
+        DAWINFO_CHECK (! late.open (name));
+    }
+
+    void testOverrun()
+    {
+        const auto name = tapName ("overrun");
+        AudioTap tap;
+        DAWINFO_CHECK (tap.open (name, 2, 1024, 48000.0));
+        AudioTapReader reader;
+        DAWINFO_CHECK (reader.open (name));
+
+        Block block (2, 256);
+        std::uint64_t written = 0, mismatches = 0;
+
+        for (int b = 0; b < 20; ++b)
+        {
+            block.fill (written);
+            tap.write (block.pointers.data(), 2, 256);
+            written += 256;
+        }
+
+        // 5120 frames behind with a 1024-frame ring: resumes half a ring back.
+        const auto got = readAndCheck (reader, 4096, mismatches);
+        const auto stats = reader.getStats();
+        DAWINFO_CHECK (stats.overruns == 1);
+        DAWINFO_CHECK (stats.framesLost == written - 512);
+        DAWINFO_CHECK (got == 512 && mismatches == 0);
+
+        // A view the writer laps while it is held is rejected.
+        block.fill (written);
+        tap.write (block.pointers.data(), 2, 256);
+        written += 256;
+        const auto v = reader.acquire (256);
+
+        for (int b = 0; b < 5; ++b)
+        {
+            block.fill (written);
+            tap.write (block.pointers.data(), 2, 256);
+            written += 256;
+        }
+
+        DAWINFO_CHECK (v.numFrames == 256);
+        DAWINFO_CHECK (! reader.release (v));
+        DAWINFO_CHECK (reader.getStats().overruns == 2);
+    }
+
+    /** A reader that polls faster than blocks arrive is fine; one that reaches
+        into a block the writer is still copying has got ahead of it. The
+        writer here is played by hand, frozen halfway through a block.
+    */
+    void testUnderrun()
+    {
+        const auto name = tapName ("underrun");
+        SharedMemory memory;
+        DAWINFO_CHECK (memory.create (name, audiotap::regionSize (1, 1024)));
+
+        auto* h = new (memory.getData()) AudioTapHeader;
+        h->version = AudioTapHeader::currentVersion;
+        h->numChannels = 1;
+        h->capacityFrames = 1024;
+        h->sampleRate = 48000.0;
+        h->writeStart.store (0);
+        h->writeEnd.store (0);
+        h->magic.store (AudioTapHeader::magicValue);
+
+        AudioTapReader reader;
+        DAWINFO_CHECK (reader.open (name));
+
+        float samples[512];
+        float* dest[] = { samples };
+
+        // Nothing written, or less than asked for: a short read, not an underrun.
+        DAWINFO_CHECK (reader.read (dest, 1, 256) == 0);
+        h->writeStart.store (100);
+        h->writeEnd.store (100);
+        DAWINFO_CHECK (reader.read (dest, 1, 256) == 100);
+        DAWINFO_CHECK (reader.read (dest, 1, 256) == 0);
+        DAWINFO_CHECK (reader.getStats().underruns == 0);
+
+        // The writer has claimed frames up to 356 but committed only 228.
+        h->writeStart.store (356);
+        h->writeEnd.store (228);
+        DAWINFO_CHECK (reader.read (dest, 1, 256) == 128);
+        DAWINFO_CHECK (reader.getStats().underruns == 1);
+
+        // Once the block is done, the rest reads normally.
+        h->writeEnd.store (356);
+        DAWINFO_CHECK (reader.read (dest, 1, 128) == 128);
+        DAWINFO_CHECK (reader.getStats().underruns == 1 && reader.getStats().overruns == 0);
+        DAWINFO_CHECK (reader.getStats().framesRead == 356 && reader.getStats().framesLost == 0);
+    }
+
+    /** A writer at full speed against a reader that keeps stalling: whatever
+        the reader accepts must be exactly what was written.
+    */
+    void testConcurrentReadsAreNeverTorn()
+    {
+        const auto name = tapName ("concurrent");
+        AudioTap tap;
+        DAWINFO_CHECK (tap.open (name, 4, 2048, 48000.0));
+        AudioTapReader reader;
+        DAWINFO_CHECK (reader.open (name));
+
+        constexpr std::uint64_t totalFrames = 4000000;
+        std::atomic<bool> done { false };
+
+        std::thread writer ([&]
+        {
+            Block block (4, 128);
+
+            for (std::uint64_t frame = 0; frame < totalFrames; frame += 128)
+            {
+                block.fill (frame);
+                tap.write (block.pointers.data(), 4, 128);
+
+                if ((frame / 128) % 8 == 0)
+                    std::this_thread::yield();
+            }
+
+            done = true;
+        });
+
+        std::uint64_t mismatches = 0;
+        int reads = 0;
+
+        while (! done.load() || reader.getAvailable() > 0)
+        {
+            readAndCheck (reader, 333, mismatches);
+
+            // Now and then stall long enough to be lapped.
+            if (++reads % 2000 == 0)
+                std::this_thread::sleep_for (std::chrono::milliseconds (2));
+            else if (reads % 64 == 0)
+                std::this_thread::yield();
+        }
+
+        writer.join();
+        const auto stats = reader.getStats();
+
+        std::printf ("Concurrent: %llu frames read, %llu lost in %llu overruns, %llu underruns, %llu bad samples\n",
+                     static_cast<unsigned long long> (stats.framesRead), static_cast<unsigned long long> (stats.framesLost),
+                     static_cast<unsigned long long> (stats.overruns), static_cast<unsigned long long> (stats.underruns),
+                     static_cast<unsigned long long> (mismatches));
+
+        DAWINFO_CHECK (mismatches == 0);
+        DAWINFO_CHECK (stats.framesRead + stats.framesLost == totalFrames);
+        DAWINFO_CHECK (stats.framesRead > 0);
+    }
+
+    /** The message thread reopens and closes the tap under a running audio thread. */
+    void testCloseWhileWriting()
+    {
+        const auto name = tapName ("reopen");
+        AudioTap tap;
+        std::atomic<bool> done { false };
+        std::atomic<std::uint64_t> blocks { 0 };
+
+        std::thread audio ([&]
+        {
+            Block block (2, 64);
+
+            while (! done.load())
+            {
+                block.fill (0);
+                tap.write (block.pointers.data(), 2, 64);
+                blocks.fetch_add (1);
+            }
+        });
+
+        int opened = 0;
+
+        for (int i = 0; i < 200; ++i)
+        {
+            opened += tap.open (name, 1 + i % 2, 256 << (i % 4), 48000.0) ? 1 : 0;
+            const auto before = blocks.load();
+
+            while (blocks.load() < before + 4)
+                std::this_thread::yield();
+
+            tap.close();
+        }
+
+        done = true;
+        audio.join();
+
+        DAWINFO_CHECK (opened == 200 && ! tap.isOpen() && tap.getFramesWritten() == 0);
+    }
+
+    /** The reader in a separate process, as real clients are. */
+    void testSeparateProcess()
+    {
+        const auto name = tapName ("process");
+        AudioTap tap;
+        DAWINFO_CHECK (tap.open (name, 2, 8192, 48000.0));
+
+        constexpr std::uint64_t framesWanted = 48000;
+        const pid_t child = ::fork();
+
+        if (child == 0)
+        {
+            AudioTapReader reader;
+
+            if (! reader.open (name))
+                ::_exit (2);
+
+            std::uint64_t mismatches = 0, frames = 0;
+            const auto deadline = monotonicNowNs() + 10000000000LL;
+
+            while (frames < framesWanted && monotonicNowNs() < deadline)
+            {
+                const auto n = readAndCheck (reader, 512, mismatches);
+
+                if (n == 0)
+                    std::this_thread::sleep_for (std::chrono::microseconds (500));
+
+                frames += static_cast<std::uint64_t> (n);
+            }
+
+            ::_exit (frames >= framesWanted && mismatches == 0 && reader.getStats().overruns == 0 ? 0 : 1);
+        }
+
+        // Play 512-frame blocks at roughly real time until the child is done.
+        Block block (2, 512);
+        std::uint64_t written = 0;
+        int status = -1;
+
+        for (int b = 0; b < 2000; ++b)
+        {
+            block.fill (written);
+            tap.write (block.pointers.data(), 2, 512);
+            written += 512;
+
+            if (::waitpid (child, &status, WNOHANG) == child)
+                break;
+
+            std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        }
+
+        if (! WIFEXITED (status))
+            ::waitpid (child, &status, 0);
+
+        DAWINFO_CHECK (WIFEXITED (status) && WEXITSTATUS (status) == 0);
+    }
+
+    /** The audio thread's cost next to copying the same bytes. */
+    void testWriteCost()
+    {
+        const auto name = tapName ("cost");
+        AudioTap tap;
+        DAWINFO_CHECK (tap.open (name, 2, 16384, 48000.0));
+
+        constexpr int blockSize = 512, numBlocks = 20000;
+        Block block (2, blockSize);
+        block.fill (0);
+        std::vector<float> target (16384 * 2);
+
+        const auto t0 = monotonicNowNs();
+
+        for (int b = 0; b < numBlocks; ++b)
+            tap.write (block.pointers.data(), 2, blockSize);
+
+        const auto t1 = monotonicNowNs();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            const auto offset = static_cast<std::size_t> (b * blockSize) & 16383;
+            std::memcpy (target.data() + offset, block.pointers[0], blockSize * sizeof (float));
+            std::memcpy (target.data() + 16384 + offset, block.pointers[1], blockSize * sizeof (float));
+        }
+
+        const auto t2 = monotonicNowNs();
+        const double tapNs = static_cast<double> (t1 - t0) / numBlocks;
+        const double copyNs = static_cast<double> (t2 - t1) / numBlocks;
+
+        std::printf ("Tap write, %d-frame stereo block: %.0f ns (plain memcpy %.0f ns)\n", blockSize, tapNs, copyNs);
+
+        // Generous: timing on shared machines is noisy.
+        DAWINFO_CHECK (tapNs < copyNs * 3.0 + 200.0);
+    }
+}
+
+int main()
+{
+    testRoundTrip();
+    testOverrun();
+    testUnderrun();
+    testConcurrentReadsAreNeverTorn();
+    testCloseWhileWriting();
+    testSeparateProcess();
+    testWriteCost();
+    return dawinfo::test::finish ("AudioTapTests");
+}
@@ -0,0 +1,299 @@
+#include "AllocationCounter.h"
+#include "Common/Messages.h"
+#include "Sender/CoalescingQueue.h"
+#include "Sender/StreamSequencer.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    constexpr HostTimeNs ms = 1000000;
+
+    struct Packet
+    {
+        std::uint8_t data[256];
+        std::size_t size = 0;
+    };
+
+    Packet makeTransport (StreamSequencer& seq, HostTimeNs timeNs)
+    {
+        Packet p;
+        OscWriter w (p.data, sizeof (p.data));
+        seq.beginPacket (w, StreamId::transport);
+        TransportSnapshot t;
+        t.timeNs = timeNs;
+        schema::Codec<messages::Transport>::write (w, t);
+        p.size = w.getSize();
+        return p;
+    }
+
+    Packet makeEvent (StreamSequencer& seq, std::uint32_t id, HostTimeNs timeNs)
+    {
+        Packet p;
+        OscWriter w (p.data, sizeof (p.data));
+        seq.beginPacket (w, StreamId::events);
+        writeEvent (w, { id, EventType::beat, timeNs, 0.0f });
+        p.size = w.getSize();
+        return p;
+    }
+
+    /** What a receiver makes of a packet: its stream and the time it carries. */
+    bool decode (const std::vector<std::uint8_t>& packet, StreamId& stream, HostTimeNs& timeNs, std::uint32_t& eventId)
+    {
+        bool ok = CoalescingQueue::findStream (packet.data(), packet.size(), stream);
+
+        forEachOscMessage (packet.data(), packet.size(), [&] (const OscMessage& m)
+        {
+            TransportSnapshot t;
+            DiscreteEvent e;
+
+            if (schema::Codec<messages::Transport>::decode (m, t))
+                timeNs = t.timeNs;
+            else if (decodeEvent (m, e))
+            {
+                timeNs = e.timeNs;
+                eventId = e.id;
+            }
+        });
+
+        return ok;
+    }
+
+    void testOrdering()
+    {
+        StreamSequencer seq;
+        CoalescingQueue q;
+        std::vector<std::uint8_t> out;
+
+        DAWINFO_CHECK (! q.pop (out) && q.isEmpty());
+
+        const auto t0 = makeTransport (seq, 100);
+        const auto e0 = makeEvent (seq, 0, 150);
+        const auto t1 = makeTransport (seq, 200);
+        const auto e1 = makeEvent (seq, 1, 250);
+        const auto t2 = makeTransport (seq, 300);
+
+        DAWINFO_CHECK (q.keyFor (t0.data, t0.size).policy == CoalescingQueue::Policy::latest);
+        DAWINFO_CHECK (q.keyFor (e0.data, e0.size).policy == CoalescingQueue::Policy::fifo);
+
+        DAWINFO_CHECK (! q.push (t0.data, t0.size));
+        DAWINFO_CHECK (! q.push (e0.data, e0.size));
+        DAWINFO_CHECK (q.push (t1.data, t1.size));          // replaces t0
+        DAWINFO_CHECK (! q.push (e1.data, e1.size));
+        DAWINFO_CHECK (q.push (t2.data, t2.size));          // replaces t1
+        DAWINFO_CHECK (q.size() == 3);
+
+        // The newest transport, in the first transport's place; then both events.
+        StreamId stream {};
+        HostTimeNs timeNs = 0;
+        std::uint32_t id = 99;
+
+        DAWINFO_CHECK (q.pop (out) && decode (out, stream, timeNs, id) && stream == StreamId::transport && timeNs == 300);
+        DAWINFO_CHECK (q.pop (out) && decode (out, stream, timeNs, id) && stream == StreamId::events && id == 0);
+        DAWINFO_CHECK (q.pop (out) && decode (out, stream, timeNs, id) && stream == StreamId::events && id == 1);
+        DAWINFO_CHECK (! q.pop (out));
+
+        const auto& stats = q.getStats();
+        DAWINFO_CHECK (stats.pushed == 5 && stats.coalesced == 2 && stats.dropped == 0 && stats.popped == 3);
+
+        // Turning coalescing off for a stream queues every packet.
+        q.setPolicy (StreamId::transport, CoalescingQueue::Policy::fifo);
+        q.push (t0.data, t0.size);
+        q.push (t1.data, t1.size);
+        DAWINFO_CHECK (q.size() == 2);
+        q.clear();
+        DAWINFO_CHECK (q.isEmpty() && ! q.pop (out));
+    }
+
+    void testFifoBoundsAndPrefix()
+    {
+        StreamSequencer seq;
+        CoalescingQueue::Options options;
+        options.fifoCapacity = 4;
+        CoalescingQueue q (options);
+        std::vector<std::uint8_t> out;
+
+        for (std::uint32_t i = 0; i < 10; ++i)
+        {
+            const auto e = makeEvent (seq, i, i);
+            DAWINFO_CHECK (q.push (e.data, e.size) == (i >= 4));
+        }
+
+        // The oldest went; the newest four remain, in order.
+        DAWINFO_CHECK (q.size() == 4 && q.getStats().dropped == 6);
+
+        for (std::uint32_t i = 6; i < 10; ++i)
+        {
+            StreamId stream {};
+            HostTimeNs timeNs = 0;
+            std::uint32_t id = 0;
+            DAWINFO_CHECK (q.pop (out) && decode (out, stream, timeNs, id) && id == i);
+        }
+
+        // Without a sequence header a packet can't be coalesced, so it queues.
+        const std::uint8_t raw[] = { 1, 2, 3, 4, 5 };
+        const std::uint8_t prefix[] = { 0x82, 5 };
+        const auto key = q.keyFor (raw, sizeof (raw));
+        DAWINFO_CHECK (key.policy == CoalescingQueue::Policy::fifo);
+
+        q.push (key, raw, sizeof (raw), prefix, sizeof (prefix));
+        q.push (key, raw, sizeof (raw), prefix, sizeof (prefix));
+        DAWINFO_CHECK (q.size() == 2);
+        DAWINFO_CHECK (q.pop (out) && out == std::vector<std::uint8_t> ({ 0x82, 5, 1, 2, 3, 4, 5 }));
+    }
+
+    void testNoAllocation()
+    {
+        StreamSequencer seq;
+        CoalescingQueue q;
+        std::vector<std::uint8_t> out;
+        std::vector<Packet> packets;
+
+        for (int i = 0; i < 64; ++i)
+            packets.push_back (i % 4 == 0 ? makeEvent (seq, static_cast<std::uint32_t> (i), i) : makeTransport (seq, i));
+
+        auto cycle = [&]
+        {
+            for (auto& p : packets)
+            {
+                q.push (p.data, p.size);
+
+                if (q.size() > 8)
+                    q.pop (out);
+            }
+
+            while (q.pop (out)) {}
+        };
+
+        // Buffers move between slots as they are swapped out; once each has
+        // held the largest packet, it is all swaps.
+        for (int i = 0; i < 100; ++i)
+            cycle();
+
+        test::ScopedAllocationCount counting;
+
+        for (int i = 0; i < 100; ++i)
+            cycle();
+
+        DAWINFO_CHECK (test::allocationCount() == 0);
+    }
+
+    struct Staleness
+    {
+        std::vector<HostTimeNs> transport;      // receive time minus the state's time
+        std::vector<HostTimeNs> events;
+        std::uint32_t eventsReceived = 0;
+        bool eventsInOrder = true;
+        std::size_t maxQueued = 0;
+
+        static double percentileMs (std::vector<HostTimeNs> v, double p)
+        {
+            if (v.empty())
+                return 0.0;
+
+            std::sort (v.begin(), v.end());
+            return static_cast<double> (v[static_cast<std::size_t> (p * static_cast<double> (v.size() - 1))]) / ms;
+        }
+    };
+
+    /** Ten seconds of a 1 kHz transport stream and a beat every 125 ms,
+        through a link that only carries one packet every 4 ms and takes
+        half a millisecond to deliver it.
+    */
+    Staleness runThrottled (CoalescingQueue::Policy transportPolicy)
+    {
+        constexpr HostTimeNs durationNs = 10000 * ms, linkIntervalNs = 4 * ms, transitNs = ms / 2;
+
+        CoalescingQueue::Options options;
+        options.fifoCapacity = 1 << 16;
+        CoalescingQueue q (options);
+        q.setPolicy (StreamId::transport, transportPolicy);
+
+        StreamSequencer seq;
+        Staleness result;
+        std::vector<std::uint8_t> out;
+        std::uint32_t nextEvent = 0;
+
+        for (HostTimeNs now = 0; now < durationNs; now += ms)
+        {
+            const auto t = makeTransport (seq, now);
+            q.push (t.data, t.size);
+
+            if (now % (125 * ms) == 0)
+            {
+                const auto e = makeEvent (seq, nextEvent++, now);
+                q.push (e.data, e.size);
+            }
+
+            result.maxQueued = std::max (result.maxQueued, q.size());
+
+            if (now % linkIntervalNs == 0 && q.pop (out))
+            {
+                StreamId stream {};
+                HostTimeNs timeNs = 0;
+                std::uint32_t id = 0;
+                decode (out, stream, timeNs, id);
+                const auto arrivedNs = now + transitNs;
+
+                if (stream == StreamId::transport)
+                {
+                    result.transport.push_back (arrivedNs - timeNs);
+                }
+                else
+                {
+                    result.eventsInOrder = result.eventsInOrder && id == result.eventsReceived;
+                    result.events.push_back (arrivedNs - timeNs);
+                    ++result.eventsReceived;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    /** How old the state a throttled receiver sees is, coalescing against
+        queueing everything.
+    */
+    void testThrottledReceiver()
+    {
+        const auto coalesced = runThrottled (CoalescingQueue::Policy::latest);
+        const auto queued = runThrottled (CoalescingQueue::Policy::fifo);
+
+        std::printf ("Throttled receiver (1 kHz state, link at 250 packets/s), staleness:\n");
+        std::printf ("  %-10s %10s %10s %10s %10s %8s\n", "", "state p50", "state p99", "event p50", "event p99", "queued");
+
+        for (auto* r : { &coalesced, &queued })
+            std::printf ("  %-10s %7.1f ms %7.1f ms %7.1f ms %7.1f ms %8zu\n", r == &coalesced ? "coalesced" : "fifo",
+                         Staleness::percentileMs (r->transport, 0.5), Staleness::percentileMs (r->transport, 0.99),
+                         Staleness::percentileMs (r->events, 0.5), Staleness::percentileMs (r->events, 0.99), r->maxQueued);
+
+        // Every beat arrives, in order, either way.
+        DAWINFO_CHECK (coalesced.eventsReceived == 80 && coalesced.eventsInOrder);
+
+        // State is never more than a couple of link slots old, and the
+        // backlog is bounded by the number of streams.
+        DAWINFO_CHECK (Staleness::percentileMs (coalesced.transport, 1.0) <= 8.0);
+        DAWINFO_CHECK (coalesced.maxQueued <= 2);
+
+        // Beats aren't stuck behind stale state either.
+        DAWINFO_CHECK (Staleness::percentileMs (coalesced.events, 1.0) <= 8.0);
+
+        // Queueing everything lets both grow with the run.
+        DAWINFO_CHECK (Staleness::percentileMs (queued.transport, 0.99) > 1000.0);
+        DAWINFO_CHECK (Staleness::percentileMs (queued.events, 0.99) > 1000.0);
+    }
+}
+
+int main()
+{
+    testOrdering();
+    testFifoBoundsAndPrefix();
+    testNoAllocation();
+    testThrottledReceiver();
+    return dawinfo::test::finish ("CoalescingQueueTests");
+}
@@ -0,0 +1,288 @@
+#include "AllocationCounter.h"
+#include "HeadlessHost.h"
+#include "Sender/ConfigManager.h"
+#include "Sender/MidiForwarder.h"
+#include "Sender/WaveformPublisher.h"
+#include "TestHarness.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    template <typename AddArguments>
+    OscMessage makeMessage (std::vector<std::uint8_t>& buffer, const char* key, const char* tags, AddArguments&& addArguments)
+    {
+        buffer.assign (256, 0);
+        OscWriter w (buffer.data(), buffer.size());
+        w.beginMessage (std::string (config::oscPrefix) + key, tags);
+        addArguments (w);
+        w.endMessage();
+
+        OscMessage m;
+        parseOscMessage (w.getData(), w.getSize(), m);
+        return m;
+    }
+
+    void testParseAndFormat()
+    {
+        const char* text =
+            "# studio rig\n"
+            "destinations = 10.0.0.5:9000, visuals.local:9100\n"
+            "features = transport midi waveform   # no levels\n"
+            "\n"
+            "transport.rate = 120\n"
+            "midi.minIntervalMs = 7.5\n"
+            "waveform.liveLevel = 3\n";
+
+        SenderConfig c;
+        std::string error;
+        DAWINFO_CHECK (config::parse (text, c, error));
+        DAWINFO_CHECK (c.destinations.size() == 2 && c.destinations[1].host == "visuals.local" && c.destinations[1].port == 9100);
+        DAWINFO_CHECK (c.features == (feature::transport | feature::midi | feature::waveform));
+        DAWINFO_CHECK (c.transportRateHz == 120.0 && c.midiMinIntervalMs == 7.5 && c.waveformLiveLevel == 3);
+        DAWINFO_CHECK (c.levelsRateHz == SenderConfig().levelsRateHz);
+
+        // What format() writes parses back to the same config.
+        SenderConfig again;
+        DAWINFO_CHECK (config::parse (config::format (c), again, error));
+        DAWINFO_CHECK (again.destinations == c.destinations && again.features == c.features
+                        && again.transportRateHz == c.transportRateHz && again.midiMinIntervalMs == c.midiMinIntervalMs
+                        && again.parameterTolerance == c.parameterTolerance && again.waveformLiveLevel == c.waveformLiveLevel);
+
+        // Errors name the line, and leave the config alone.
+        SenderConfig untouched;
+        DAWINFO_CHECK (! config::parse ("transport.rate = 30\nlevels.rat = 10\n", untouched, error));
+        DAWINFO_CHECK (error.find ("line 2") != std::string::npos);
+        DAWINFO_CHECK (untouched.transportRateHz == SenderConfig().transportRateHz);
+
+        DAWINFO_CHECK (! config::parse ("events.redundancy = 12", untouched, error));
+        DAWINFO_CHECK (! config::parse ("destinations = nohost", untouched, error));
+        DAWINFO_CHECK (! config::parse ("features = transport lasers", untouched, error));
+        DAWINFO_CHECK (! config::parse ("transport.rate = 60hz", untouched, error));
+
+        SenderConfig nowhere;
+        DAWINFO_CHECK (config::parse ("destinations =", nowhere, error) && nowhere.destinations.empty());
+        DAWINFO_CHECK (! config::validate (nowhere, error));
+    }
+
+    void testOscControl()
+    {
+        ConfigManager manager;
+        std::vector<std::uint8_t> buffer;
+        std::string error;
+
+        auto reader = manager.registerReader();
+        const auto before = ConfigManager::ReadScope (reader)->version;
+
+        DAWINFO_CHECK (manager.handleMessage (makeMessage (buffer, "transport.rate", "f", [] (OscWriter& w) { w.addFloat32 (30.0f); }), error));
+        DAWINFO_CHECK (manager.handleMessage (makeMessage (buffer, "features", "s", [] (OscWriter& w) { w.addString ("transport midi"); }), error));
+        DAWINFO_CHECK (manager.handleMessage (makeMessage (buffer, "midi.minDelta", "i", [] (OscWriter& w) { w.addInt32 (3); }), error));
+
+        {
+            ConfigManager::ReadScope c (reader);
+            DAWINFO_CHECK (c->transportRateHz == 30.0 && c->features == (feature::transport | feature::midi) && c->midiMinDelta == 3);
+            DAWINFO_CHECK (c->version == before + 3);
+        }
+
+        // Rejected changes leave the live config as it was.
+        DAWINFO_CHECK (! manager.handleMessage (makeMessage (buffer, "events.redundancy", "i", [] (OscWriter& w) { w.addInt32 (9); }), error));
+        DAWINFO_CHECK (! manager.handleMessage (makeMessage (buffer, "destinations", "s", [] (OscWriter& w) { w.addString (""); }), error));
+        DAWINFO_CHECK (! manager.handleMessage (makeMessage (buffer, "transport.rate", "ff", [] (OscWriter& w) { w.addFloat32 (1); w.addFloat32 (2); }), error));
+        DAWINFO_CHECK (manager.getCopy().version == before + 3 && manager.getCopy().eventRedundancy == 2);
+        DAWINFO_CHECK (manager.getStats().rejected == 3);
+
+        DAWINFO_CHECK (! manager.loadFile ("/nonexistent/dawinfo.conf", error));
+        manager.unregisterReader (reader);
+    }
+
+    struct Tracked
+    {
+        static inline int alive = 0;
+        int value;
+
+        explicit Tracked (int v) : value (v)    { ++alive; }
+        ~Tracked()                              { --alive; }
+    };
+
+    void testDeferredReclaim()
+    {
+        {
+            RcuPointer<Tracked> cell (std::make_unique<Tracked> (0));
+            auto audio = cell.registerReader();
+            auto idleReader = cell.registerReader();
+            DAWINFO_CHECK (audio.isValid() && idleReader.isValid());
+
+            {
+                RcuPointer<Tracked>::ReadScope held (audio);
+                DAWINFO_CHECK (held->value == 0);
+
+                // Both replaced objects wait: the reader started before either swap.
+                DAWINFO_CHECK (cell.publish (std::make_unique<Tracked> (1)) == 1);
+                DAWINFO_CHECK (cell.publish (std::make_unique<Tracked> (2)) == 2);
+                DAWINFO_CHECK (Tracked::alive == 3);
+                DAWINFO_CHECK (held->value == 0);     // still valid
+
+                // A reader starting now sees the newest and pins nothing older.
+                RcuPointer<Tracked>::ReadScope fresh (idleReader);
+                DAWINFO_CHECK (fresh->value == 2);
+            }
+
+            // Idle readers hold nothing back.
+            DAWINFO_CHECK (cell.collect() == 0);
+            DAWINFO_CHECK (Tracked::alive == 1);
+            DAWINFO_CHECK (cell.getReclaimed() == 2);
+        }
+
+        DAWINFO_CHECK (Tracked::alive == 0);
+    }
+
+    /** Two configs that differ everywhere the audio thread looks, each
+        internally consistent, so a torn or freed read shows up as a broken
+        invariant.
+    */
+    const char* configVariants[2] = {
+        "features = transport midi waveform\ntransport.rate = 60\nlevels.rate = 30\nmidi.minDelta = 2\nevents.redundancy = 1\n",
+        "features = transport levels\ntransport.rate = 100\nlevels.rate = 50\nmidi.minDelta = 5\nevents.redundancy = 4\n",
+    };
+
+    bool isConsistent (const SenderConfig& c)
+    {
+        const bool first = c.transportRateHz == 60.0 && c.levelsRateHz == 30.0 && c.midiMinDelta == 2
+                            && c.eventRedundancy == 1 && c.features == (feature::transport | feature::midi | feature::waveform);
+        const bool second = c.transportRateHz == 100.0 && c.levelsRateHz == 50.0 && c.midiMinDelta == 5
+                             && c.eventRedundancy == 4 && c.features == (feature::transport | feature::levels);
+        return first || second;
+    }
+
+    /** 1000 reloads a second while a headless host runs the audio thread. */
+    void testHotReloadStress()
+    {
+        ConfigManager manager;
+        std::string error;
+        DAWINFO_CHECK (manager.loadText (configVariants[0], error));
+
+        MidiForwarder midi;
+        WaveformPublisher waveform (2);
+        waveform.prepare();
+        auto audioReader = manager.registerReader();
+        auto senderReader = manager.registerReader();
+
+        std::vector<float> left (256), right (256);
+        for (std::size_t i = 0; i < left.size(); ++i)
+            left[i] = right[i] = std::sin (static_cast<float> (i) * 0.1f);
+
+        const BlockMidiEvent notes[] = { { 0, { 0x90, 60, 100 }, 3 }, { 128, { 0xb0, 1, 64 }, 3 } };
+
+        std::atomic<int> inconsistent { 0 }, versionChanges { 0 };
+        std::uint64_t lastVersion = 0;
+
+        test::HeadlessHost host (48000.0, 256);
+
+        host.start ([&] (HostTimeNs blockStart, int)
+        {
+            test::ScopedAllocationCount counting;
+            ConfigManager::ReadScope config (audioReader);
+
+            if (! isConsistent (*config))
+                inconsistent.fetch_add (1, std::memory_order_relaxed);
+
+            if (config->version != lastVersion)
+            {
+                versionChanges.fetch_add (1, std::memory_order_relaxed);
+                lastVersion = config->version;
+            }
+
+            if (config->isEnabled (feature::midi))
+            {
+                midi.setThinning ({ 0, config->midiMinDelta });
+                midi.pushBlock (notes, 2, blockStart, host.sampleRate);
+            }
+
+            if (config->isEnabled (feature::waveform))
+            {
+                const float* channels[] = { left.data(), right.data() };
+                waveform.pushBlock (channels, 2, host.blockSize);
+            }
+        });
+
+        // A sender thread reading the same config at its own pace.
+        std::atomic<bool> running { true };
+        std::atomic<int> senderInconsistent { 0 };
+
+        std::thread sender ([&]
+        {
+            while (running)
+            {
+                {
+                    ConfigManager::ReadScope config (senderReader);
+
+                    if (! isConsistent (*config) || config->destinations.empty())
+                        ++senderInconsistent;
+                }
+
+                waveform.update();
+                std::this_thread::sleep_for (std::chrono::milliseconds (5));
+            }
+        });
+
+        // Reload every millisecond for two seconds.
+        constexpr double seconds = 2.0;
+        const auto start = monotonicNowNs();
+        const auto end = start + static_cast<HostTimeNs> (seconds * 1.0e9);
+        int reloads = 0, failedReloads = 0;
+        std::size_t maxAwaiting = 0;
+
+        for (auto next = start; next < end; next += 1000000)
+        {
+            std::this_thread::sleep_until (std::chrono::steady_clock::time_point (std::chrono::nanoseconds (next)));
+
+            if (! manager.loadText (configVariants[(reloads + 1) % 2], error))
+                ++failedReloads;
+
+            ++reloads;
+            maxAwaiting = std::max (maxAwaiting, manager.getStats().awaitingReclaim);
+        }
+
+        const auto elapsed = (monotonicNowNs() - start) / 1.0e9;
+        host.stop();
+        running = false;
+        sender.join();
+
+        const auto& hostStats = host.getStats();
+        manager.unregisterReader (audioReader);
+        manager.unregisterReader (senderReader);
+        manager.collect();
+        const auto stats = manager.getStats();
+
+        std::printf ("Hot reload: %d reloads in %.2f s (%.0f/s), audio saw %d changes over %d blocks, "
+                     "%d late, %d over budget, max callback %.1f us, %llu audio-thread allocations, "
+                     "at most %zu configs awaiting reclaim\n",
+                     reloads, elapsed, reloads / elapsed, versionChanges.load(), hostStats.blocks, hostStats.lateBlocks, hostStats.overBudgetBlocks,
+                     hostStats.maxCallbackNs / 1000.0, static_cast<unsigned long long> (test::allocationCount()), maxAwaiting);
+
+        DAWINFO_CHECK (failedReloads == 0);
+        DAWINFO_CHECK (reloads / elapsed > 900.0);
+        DAWINFO_CHECK (inconsistent == 0 && senderInconsistent == 0);
+        DAWINFO_CHECK (versionChanges > 50);
+        DAWINFO_CHECK (test::allocationCount() == 0);
+        DAWINFO_CHECK (hostStats.overBudgetBlocks == 0);
+        DAWINFO_CHECK (hostStats.maxCallbackNs < host.blockNs / 4);
+        // The host thread isn't real-time here, so allow the odd late wake-up.
+        DAWINFO_CHECK (hostStats.lateBlocks <= hostStats.blocks / 50);
+        DAWINFO_CHECK (stats.awaitingReclaim == 0 && stats.reclaimed == stats.applied);
+        DAWINFO_CHECK (midi.getStats().ringOverflows == 0);
+    }
+}
+
+int main()
+{
+    testParseAndFormat();
+    testOscControl();
+    testDeferredReclaim();
+    testHotReloadStress();
+    return dawinfo::test::finish ("ConfigReloadTests");
+}
@@ -0,0 +1,639 @@
+#include "AllocationCounter.h"
+#include "HeadlessHost.h"
+#include "Common/Messages.h"
+#include "Common/SequenceWindow.h"
+#include "Sender/ControlChannel.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    /** A controller on the loopback interface. */
+    struct Client
+    {
+        struct Answer
+        {
+            control::Reply reply;
+            bool hasTransport = false;
+            TransportSnapshot transport;
+        };
+
+        UdpSocket socket;
+        Endpoint sender;
+
+        explicit Client (int senderPort)
+            : sender { Endpoint::loopbackAddress, static_cast<std::uint16_t> (senderPort) }
+        {
+            socket.open (0, true);
+        }
+
+        bool send (const control::Command& c)
+        {
+            std::uint8_t buffer[128];
+            OscWriter w (buffer, sizeof (buffer));
+            control::writeCommand (w, c);
+            return socket.sendTo (sender, w.getData(), w.getSize());
+        }
+
+        /** Waits for the reply carrying the token, skipping stale ones. */
+        bool receive (std::int32_t token, Answer& answer, int timeoutMs = 1000)
+        {
+            const auto deadline = monotonicNowNs() + static_cast<HostTimeNs> (timeoutMs) * 1000000;
+
+            for (HostTimeNs now = monotonicNowNs(); now < deadline; now = monotonicNowNs())
+            {
+                std::uint8_t buffer[512];
+                Endpoint from;
+                const auto size = socket.receive (buffer, sizeof (buffer), from, static_cast<int> ((deadline - now) / 1000000) + 1);
+
+if (size <= 0)
+                    continue;
+
+                Answer a;
+                bool hasReply = false;
+
+                forEachOscMessage (buffer, static_cast<std::size_t> (size), [&] (const OscMessage& m)
+                {
+                    hasReply |= schema::Codec<messages::ControlReply>::decode (m, a.reply);
+                    a.hasTransport |= schema::Codec<messages::Transport>::decode (m, a.transport);
+                });
+
+                if (hasReply && a.reply.token == token)
+                {
+                    answer = a;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool request (const control::Command& c, Answer& answer)
+        {
+            return send (c) && receive (c.token, answer);
+        }
+
+        /** Collects a history query's chunks until the last one. */
+        bool receiveHistory (std::int32_t token, std::vector<history::ChunkHeader>& chunks,
+                             std::vector<HostTimeNs>& times, std::vector<float>& values, int timeoutMs = 1000)
+        {
+            const auto deadline = monotonicNowNs() + static_cast<HostTimeNs> (timeoutMs) * 1000000;
+            bool last = false;
+
+            for (HostTimeNs now = monotonicNowNs(); now < deadline && ! last; now = monotonicNowNs())
+            {
+                std::uint8_t buffer[1500];
+                Endpoint from;
+                const auto size = socket.receive (buffer, sizeof (buffer), from, static_cast<int> ((deadline - now) / 1000000) + 1);
+
+                if (size <= 0)
+                    continue;
+
+                forEachOscMessage (buffer, static_cast<std::size_t> (size), [&] (const OscMessage& m)
+                {
+                    history::ChunkHeader c;
+                    const std::uint8_t* t = nullptr;
+                    const std::uint8_t* v = nullptr;
+
+                    if (! history::decodeChunk (m, c, t, v) || c.token != token)
+                        return;
+
+                    for (std::size_t i = 0; i < static_cast<std::size_t> (c.numFrames); ++i)
+                        times.push_back (history::timeAt (c, t, i));
+
+                    for (std::size_t i = 0; i < static_cast<std::size_t> (c.numFrames * c.numValues); ++i)
+                        values.push_back (history::valueAt (v, i));
+
+                    chunks.push_back (c);
+                    last = c.isLast;
+                });
+            }
+
+            return last;
+        }
+
+        /** Collects peak summaries until numBins bins have arrived. */
+        bool receivePeaks (std::int32_t numBins, std::vector<peaks::SummaryHeader>& summaries, int timeoutMs = 1000)
+        {
+            const auto deadline = monotonicNowNs() + static_cast<HostTimeNs> (timeoutMs) * 1000000;
+            std::int32_t received = 0;
+
+            for (HostTimeNs now = monotonicNowNs(); now < deadline && received < numBins; now = monotonicNowNs())
+            {
+                std::uint8_t buffer[1500];
+                Endpoint from;
+                const auto size = socket.receive (buffer, sizeof (buffer), from, static_cast<int> ((deadline - now) / 1000000) + 1);
+
+if (size <= 0)
+                    continue;
+
+                forEachOscMessage (buffer, static_cast<std::size_t> (size), [&] (const OscMessage& m)
+                {
+                    peaks::SummaryHeader s;
+                    const std::uint8_t* packed = nullptr;
+
+                    if (peaks::decodeSummary (m, s, packed))
+                    {
+                        summaries.push_back (s);
+                        received += s.numBins;
+                    }
+                });
+            }
+
+            return received == numBins;
+        }
+    };
+
+    /** The sender thread's part: services commands as they arrive. */
+    struct SenderThread
+    {
+        ControlChannel& channel;
+        StreamSequencer seq;
+        std::atomic<bool> running { true };
+        std::thread thread;
+
+        explicit SenderThread (ControlChannel& c) : channel (c)
+        {
+            thread = std::thread ([this]
+            {
+                while (running)
+                    if (channel.waitForCommands (20))
+                        channel.service (seq, monotonicNowNs());
+            });
+        }
+
+        ~SenderThread()     { stop(); }
+
+        void stop()
+        {
+            running = false;
+
+            if (thread.joinable())
+                thread.join();
+        }
+    };
+
+    void testCommandEncoding()
+    {
+        const control::Command commands[] = {
+            { control::CommandType::ping, 7, 0, 0, 0.0 },
+            { control::CommandType::querySnapshot, -3, 0, 0, 0.0 },
+            { control::CommandType::subscribe, 1, control::streamBit (StreamId::transport) | control::streamBit (StreamId::midi), 2500, 0.0 },
+            { control::CommandType::unsubscribe, 2, 0, 0, 0.0 },
+            { control::CommandType::play, 3, 0, 0, 0.0 },
+            { control::CommandType::stop, 4, 0, 0, 0.0 },
+            { control::CommandType::locate, 5, 0, 0, 33.25 },
+            { control::CommandType::queryHistory, 6, 0, 0, 0.0, history::Feature::spectrum, -10'000'000'000, 0, 256 },
+            { control::CommandType::queryPeaks, 8, 0, 0, 0.0, history::Feature::levels, 0, 0, 0, { 3, 1'000'000'000'000, 4096 } },
+        };
+
+        for (auto& c : commands)
+        {
+            std::uint8_t buffer[128];
+            OscWriter w (buffer, sizeof (buffer));
+            control::writeCommand (w, c);
+            OscMessage m;
+            control::Command decoded;
+            DAWINFO_CHECK (parseOscMessage (w.getData(), w.getSize(), m) && control::decodeCommand (m, decoded));
+            DAWINFO_CHECK (decoded.type == c.type && decoded.token == c.token && decoded.streams == c.streams
+                            && decoded.durationMs == c.durationMs && decoded.ppq == c.ppq);
+            DAWINFO_CHECK (decoded.feature == c.feature && decoded.fromNs == c.fromNs && decoded.toNs == c.toNs
+                            && decoded.maxFrames == c.maxFrames);
+            DAWINFO_CHECK (decoded.peaks.level == c.peaks.level && decoded.peaks.firstBin == c.peaks.firstBin
+                            && decoded.peaks.numBins == c.peaks.numBins);
+        }
+
+        // Hand-written controller messages: no token, float ppq.
+        auto decodeBare = [] (std::string_view address, const char* tags, float argument, control::Command& c)
+        {
+            std::uint8_t buffer[64];
+            OscWriter w (buffer, sizeof (buffer));
+            w.beginMessage (address, tags);
+
+            if (*tags == 'f')
+                w.addFloat32 (argument);
+            else if (*tags == 'i')
+                w.addInt32 (static_cast<std::int32_t> (argument));
+
+            w.endMessage();
+            OscMessage m;
+            return parseOscMessage (w.getData(), w.getSize(), m) && control::decodeCommand (m, c);
+        };
+
+        control::Command c;
+        DAWINFO_CHECK (decodeBare ("/ping", "", 0, c) && c.type == control::CommandType::ping && c.token == 0);
+        DAWINFO_CHECK (decodeBare ("/transport/locate", "f", 8.5f, c) && c.ppq == 8.5);
+        DAWINFO_CHECK (decodeBare ("/subscribe", "i", 3, c) && c.streams == 3 && c.durationMs == 0);
+        DAWINFO_CHECK (! decodeBare ("/subscribe", "", 0, c));
+        DAWINFO_CHECK (! decodeBare ("/transport/locate", "i", 8, c));
+        DAWINFO_CHECK (! decodeBare ("/transport/locate", "f", std::numeric_limits<float>::quiet_NaN(), c));
+        DAWINFO_CHECK (! decodeBare ("/transport/locate", "f", -std::numeric_limits<float>::infinity(), c));
+
+        // The double form is checked the same way.
+        for (const double ppq : { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity() })
+        {
+            control::Command locate;
+            locate.type = control::CommandType::locate;
+            locate.ppq = ppq;
+
+            std::uint8_t buffer[64];
+            OscWriter w (buffer, sizeof (buffer));
+            control::writeCommand (w, locate);
+            OscMessage m;
+            DAWINFO_CHECK (parseOscMessage (w.getData(), w.getSize(), m) && ! control::decodeCommand (m, c));
+        }
+        DAWINFO_CHECK (! decodeBare ("/ping", "f", 1, c));
+        DAWINFO_CHECK (! decodeBare ("/reboot", "", 0, c));
+    }
+
+    /** Queries, subscriptions and remote transport against a running host. */
+    void testCommands()
+    {
+        ControlChannel channel;
+        DAWINFO_CHECK (channel.start (0, true));
+        SenderThread sender (channel);
+
+        // A toy transport driven only by the mailbox.
+        test::HeadlessHost host (48000.0, 256);
+        TransportSnapshot state;
+        const double ppqPerBlock = 256 / 48000.0 * 2.0;
+
+        host.start ([&] (HostTimeNs blockStart, int)
+        {
+            test::ScopedAllocationCount counting;
+            control::Command c;
+
+            while (channel.popTransportCommand (c))
+            {
+                if (c.type == control::CommandType::play)          state.isPlaying = true;
+                else if (c.type == control::CommandType::stop)     state.isPlaying = false;
+                else if (c.type == control::CommandType::locate)   state.ppq = c.ppq;
+            }
+
+            state.timeNs = blockStart;
+            channel.publishTransport (state);
+            state.ppq += state.isPlaying ? ppqPerBlock : 0.0;
+        });
+
+        Client client (channel.getPort());
+        Client::Answer a;
+
+        DAWINFO_CHECK (client.request ({ control::CommandType::ping, 11, 0, 0, 0.0 }, a));
+        DAWINFO_CHECK (a.reply.command == control::CommandType::ping && a.reply.status == control::Status::ok && ! a.hasTransport);
+
+        DAWINFO_CHECK (client.request ({ control::CommandType::locate, 12, 0, 0, 16.0 }, a) && a.reply.status == control::Status::ok);
+        DAWINFO_CHECK (client.request ({ control::CommandType::play, 13, 0, 0, 0.0 }, a) && a.reply.status == control::Status::ok);
+        std::this_thread::sleep_for (std::chrono::milliseconds (50));
+
+        DAWINFO_CHECK (client.request ({ control::CommandType::querySnapshot, 14, 0, 0, 0.0 }, a));
+        DAWINFO_CHECK (a.hasTransport && a.transport.isPlaying && a.transport.ppq > 16.0 && a.transport.ppq < 20.0);
+
+        DAWINFO_CHECK (client.request ({ control::CommandType::stop, 15, 0, 0, 0.0 }, a));
+        std::this_thread::sleep_for (std::chrono::milliseconds (20));
+        DAWINFO_CHECK (client.request ({ control::CommandType::querySnapshot, 16, 0, 0, 0.0 }, a) && ! a.transport.isPlaying);
+
+        // Subscriptions feed the sender's fan-out until they lapse.
+        DAWINFO_CHECK (client.request ({ control::CommandType::subscribe, 17, control::streamBit (StreamId::transport), 150, 0.0 }, a));
+        DAWINFO_CHECK (a.reply.status == control::Status::ok);
+        host.stop();
+
+        // The sender thread owns the list; stop it before looking.
+        sender.stop();
+        DAWINFO_CHECK (channel.getSubscribers().size() == 1);
+        DAWINFO_CHECK (channel.getSubscribers()[0].endpoint.port == client.socket.getPort());
+
+        const std::uint8_t packet[4] = {};
+        DAWINFO_CHECK (channel.sendToSubscribers (StreamId::transport, packet, 4) == 1);
+        DAWINFO_CHECK (channel.sendToSubscribers (StreamId::levels, packet, 4) == 0);
+
+        channel.service (sender.seq, monotonicNowNs() + 200000000);
+        DAWINFO_CHECK (channel.getSubscribers().empty());
+
+        const auto stats = channel.getStats();
+        DAWINFO_CHECK (stats.commands == 7 && stats.handled == 7 && stats.replies == 7 && stats.dropped == 0);
+        DAWINFO_CHECK (test::allocationCount() == 0);
+    }
+
+    /** A burst bigger than the queue loses the excess and nothing else. */
+    void testBoundedQueue()
+    {
+        ControlChannel channel (16);
+        DAWINFO_CHECK (channel.start (0, true));
+        Client client (channel.getPort());
+
+        // One bundle of 60 pings, with nobody servicing the queue.
+        std::vector<std::uint8_t> buffer (1500);
+        OscWriter w (buffer.data(), buffer.size());
+        w.beginBundle();
+
+        for (int i = 0; i < 60; ++i)
+            control::writeCommand (w, { control::CommandType::ping, i, 0, 0, 0.0 });
+
+        DAWINFO_CHECK (! w.hasOverflowed());
+        DAWINFO_CHECK (client.socket.sendTo (client.sender, w.getData(), w.getSize()));
+        DAWINFO_CHECK (channel.waitForCommands (1000));
+
+        // Let the listener finish the bundle.
+        for (int i = 0; i < 100 && channel.getStats().commands + channel.getStats().dropped < 60; ++i)
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+        StreamSequencer seq;
+        DAWINFO_CHECK (channel.service (seq, monotonicNowNs()) == 16);
+
+        const auto stats = channel.getStats();
+        DAWINFO_CHECK (stats.commands == 16 && stats.dropped == 44 && stats.replies == 16);
+
+        // The first 16 were kept, in order, and the channel carries on.
+        Client::Answer a;
+        DAWINFO_CHECK (client.receive (0, a) && client.receive (15, a));
+        DAWINFO_CHECK (client.send ({ control::CommandType::ping, 500, 0, 0, 0.0 }));
+        DAWINFO_CHECK (channel.waitForCommands (1000) && channel.service (seq, monotonicNowNs()) == 1);
+        DAWINFO_CHECK (client.receive (500, a));
+
+        // Garbage is counted, not queued.
+        const std::uint8_t junk[] = { 1, 2, 3 };
+        client.socket.sendTo (client.sender, junk, sizeof (junk));
+
+        for (int i = 0; i < 100 && channel.getStats().malformed == 0; ++i)
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+        DAWINFO_CHECK (channel.getStats().malformed == 1 && channel.getStats().commands == 17);
+    }
+
+    /** A late joiner asks for the last ten seconds of levels, and gets them a
+        few chunks per sender cycle.
+    */
+    void testHistoryQueries()
+    {
+        ControlChannel channel;
+        DAWINFO_CHECK (channel.start (0, true));
+        channel.setHistoryBudget (2);
+
+        // Twenty seconds of levels at 60 Hz, the newest just now.
+        FeatureHistory levels;
+        levels.allocate();
+        const auto start = monotonicNowNs();
+        constexpr int numFrames = 1200;
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            const float frame[] = { static_cast<float> (i), 0.5f };
+            levels.append (start - static_cast<HostTimeNs> (numFrames - 1 - i) * 1'000'000'000 / 60, frame);
+        }
+
+        channel.setHistory (history::Feature::levels, &levels);
+
+        Client client (channel.getPort());
+        StreamSequencer seq;
+        Client::Answer a;
+
+        // Nothing keeps a spectrum history here.
+        DAWINFO_CHECK (client.send ({ control::CommandType::queryHistory, 1, 0, 0, 0.0, history::Feature::spectrum, -10'000'000'000, 0, 0 }));
+        DAWINFO_CHECK (channel.waitForCommands (1000) && channel.service (seq, monotonicNowNs()) == 1);
+        DAWINFO_CHECK (client.receive (1, a) && a.reply.status == control::Status::rejected && ! channel.isStreamingHistory());
+
+        DAWINFO_CHECK (client.send ({ control::CommandType::queryHistory, 2, 0, 0, 0.0, history::Feature::levels, -10'000'000'000, 0, 0 }));
+        DAWINFO_CHECK (channel.waitForCommands (1000) && channel.service (seq, monotonicNowNs()) == 1);
+        DAWINFO_CHECK (client.receive (2, a) && a.reply.status == control::Status::ok);
+
+        // Each sender cycle sends at most the budget, and the cycle never
+        // waits while there is more to send.
+        int cycles = 1;
+        bool withinBudget = channel.getStats().historyChunks == 2;
+
+        while (channel.isStreamingHistory())
+        {
+            const auto before = channel.getStats().historyChunks;
+            DAWINFO_CHECK (channel.waitForCommands (1000));
+            channel.service (seq, monotonicNowNs());
+            withinBudget &= channel.getStats().historyChunks - before <= 2;
+            ++cycles;
+        }
+
+        std::vector<history::ChunkHeader> chunks;
+        std::vector<HostTimeNs> times;
+        std::vector<float> values;
+        DAWINFO_CHECK (client.receiveHistory (2, chunks, times, values));
+
+        const auto stats = channel.getStats();
+        std::printf ("Last 10 s of levels: %zu frames in %zu chunks (%.1f KB), over %d sender cycles at 2 chunks each\n",
+                     times.size(), chunks.size(), static_cast<double> (stats.historyBytes) / 1024.0, cycles);
+
+        DAWINFO_CHECK (withinBudget && stats.historyQueries == 1 && stats.historyChunks == chunks.size());
+        DAWINFO_CHECK (cycles == static_cast<int> ((chunks.size() + 1) / 2));
+        DAWINFO_CHECK (times.size() >= 590 && times.size() <= 601 && values.size() == times.size() * 2);
+        DAWINFO_CHECK (std::is_sorted (times.begin(), times.end()) && chunks.front().tier == 0);
+        DAWINFO_CHECK (values[values.size() - 2] == static_cast<float> (numFrames - 1) && values.back() == 0.5f);
+        DAWINFO_CHECK (times.front() >= start - 10'000'000'000);
+    }
+
+    /** A query whose answer can't be sent for a reason other than a full
+        buffer is dropped, rather than holding its slot and keeping the
+        sender from sleeping.
+    */
+    void testHistorySendFailureDropsQuery()
+    {
+        ControlChannel channel;
+        DAWINFO_CHECK (channel.start (0, true));
+
+        FeatureHistory levels;
+        levels.allocate();
+        const auto start = monotonicNowNs();
+
+        for (int i = 0; i < 600; ++i)
+        {
+            const float frame[] = { static_cast<float> (i), 0.5f };
+            levels.append (start - static_cast<HostTimeNs> (599 - i) * 1'000'000'000 / 60, frame);
+        }
+
+        channel.setHistory (history::Feature::levels, &levels);
+
+        Client client (channel.getPort());
+        StreamSequencer seq;
+        DAWINFO_CHECK (client.send ({ control::CommandType::queryHistory, 3, 0, 0, 0.0, history::Feature::levels, -10'000'000'000, 0, 0 }));
+
+        for (int i = 0; i < 1000 && channel.getStats().commands == 0; ++i)
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+        // Closing the socket makes every send fail, and not with congestion.
+        channel.stop();
+        DAWINFO_CHECK (channel.service (seq, monotonicNowNs()) == 1);
+
+        const auto stats = channel.getStats();
+        DAWINFO_CHECK (! channel.isStreamingHistory() && ! channel.waitForCommands (0));
+        DAWINFO_CHECK (stats.historyQueries == 1 && stats.historyDropped == 1);
+        DAWINFO_CHECK (stats.historyRetries == 0 && stats.historyChunks == 0);
+    }
+
+    /** Peaks requests on the control port are answered from the waveform. */
+    void testPeaksQueries()
+    {
+        ControlChannel channel;
+        DAWINFO_CHECK (channel.start (0, true));
+
+        Client client (channel.getPort());
+        StreamSequencer seq;
+        Client::Answer a;
+        control::Command request { control::CommandType::queryPeaks, 1, 0, 0, 0.0 };
+        request.peaks = { 0, -1, 100 };
+
+        // No waveform to answer from yet.
+        DAWINFO_CHECK (client.send (request));
+        DAWINFO_CHECK (channel.waitForCommands (1000) && channel.service (seq, monotonicNowNs()) == 1);
+        DAWINFO_CHECK (client.receive (1, a) && a.reply.status == control::Status::rejected);
+
+        // One second of a stereo ramp, 750 bins at 64 samples each.
+        WaveformPublisher waveform (2);
+        waveform.prepare();
+        std::vector<float> samples (48000);
+
+        for (std::size_t i = 0; i < samples.size(); ++i)
+            samples[i] = static_cast<float> (i % 480) / 480.0f;
+
+        const float* channels[] = { samples.data(), samples.data() };
+        waveform.pushBlock (channels, 2, static_cast<int> (samples.size()));
+        channel.setWaveform (&waveform);
+
+        request.token = 2;
+        DAWINFO_CHECK (client.send (request));
+        DAWINFO_CHECK (channel.waitForCommands (1000) && channel.service (seq, monotonicNowNs()) == 1);
+        DAWINFO_CHECK (client.receive (2, a) && a.reply.status == control::Status::ok);
+
+        std::vector<peaks::SummaryHeader> summaries;
+        DAWINFO_CHECK (client.receivePeaks (100, summaries));
+        DAWINFO_CHECK (! summaries.empty() && summaries.front().level == 0 && summaries.front().numChannels == 2);
+        DAWINFO_CHECK (summaries.front().firstBin == waveform.getPyramid().getEnd (0) - 100);
+
+        // A range past the end of the pyramid is answered, with nothing.
+        const auto bytes = channel.getStats().peaksBytes;
+        request.token = 3;
+        request.peaks = { 0, std::numeric_limits<std::int64_t>::max() - 5, 10 };
+        DAWINFO_CHECK (client.send (request));
+        DAWINFO_CHECK (channel.waitForCommands (1000) && channel.service (seq, monotonicNowNs()) == 1);
+        DAWINFO_CHECK (client.receive (3, a) && a.reply.status == control::Status::ok);
+
+        const auto stats = channel.getStats();
+        DAWINFO_CHECK (stats.peaksQueries == 2 && stats.peaksBytes == bytes && bytes > 0);
+
+        // A receiver following the live level meanwhile sees every waveform
+        // packet, however many requests another client makes.
+        struct LiveReceiver : PacketSink
+        {
+            SequenceWindow<> window;
+            int packets = 0, gaps = 0;
+
+            bool send (const std::uint8_t* data, std::size_t size) override
+            {
+                forEachOscMessage (data, size, [&] (const OscMessage& m)
+                {
+                    StreamId stream;
+                    std::uint32_t number = 0;
+
+                    if (decodeSequence (m, stream, number) && stream == StreamId::waveform)
+                    {
+                        ++packets;
+                        gaps += window.accept (number) == SequenceWindow<>::Result::gap ? 1 : 0;
+                    }
+                });
+
+                return true;
+            }
+        };
+
+        LiveReceiver live;
+        waveform.setLiveLevel (0);
+        request.peaks = { 1, -1, 50 };
+
+        for (int i = 0; i < 8; ++i)
+        {
+            waveform.pushBlock (channels, 2, 4800);
+            waveform.publish (live, seq);
+
+            request.token = 10 + i;
+            summaries.clear();
+            DAWINFO_CHECK (client.send (request));
+            DAWINFO_CHECK (channel.waitForCommands (1000) && channel.service (seq, monotonicNowNs()) == 1);
+            DAWINFO_CHECK (client.receive (request.token, a) && a.reply.status == control::Status::ok);
+            DAWINFO_CHECK (client.receivePeaks (50, summaries));
+        }
+
+        DAWINFO_CHECK (live.packets >= 8 && live.gaps == 0);
+    }
+
+    /** Request-to-reply round trips while the audio thread runs. */
+    void testLatency()
+    {
+        ControlChannel channel;
+        DAWINFO_CHECK (channel.start (0, true));
+        SenderThread sender (channel);
+
+        test::HeadlessHost host (48000.0, 128);
+        TransportSnapshot state;
+
+        host.start ([&] (HostTimeNs blockStart, int)
+        {
+            state.timeNs = blockStart;
+            state.ppq += 0.005;
+            channel.publishTransport (state);
+        });
+
+        Client client (channel.getPort());
+        constexpr int numRequests = 2000;
+        std::vector<double> pingUs, snapshotUs;
+        int lost = 0;
+
+        for (int i = 0; i < numRequests; ++i)
+        {
+            const auto type = i % 2 == 0 ? control::CommandType::ping : control::CommandType::querySnapshot;
+            Client::Answer a;
+            const auto t0 = monotonicNowNs();
+
+            if (! client.request ({ type, i, 0, 0, 0.0 }, a))
+            {
+                ++lost;
+                continue;
+            }
+
+            const auto us = static_cast<double> (monotonicNowNs() - t0) / 1000.0;
+            (type == control::CommandType::ping ? pingUs : snapshotUs).push_back (us);
+        }
+
+        host.stop();
+
+        auto percentile = [] (std::vector<double>& v, double p)
+        {
+            std::sort (v.begin(), v.end());
+            return v.empty() ? 0.0 : v[std::min (v.size() - 1, static_cast<std::size_t> (p * static_cast<double> (v.size())))];
+        };
+
+        for (auto* set : { &pingUs, &snapshotUs })
+            std::printf ("%s round trip over loopback (%zu requests): p50 %.0f us, p90 %.0f us, p99 %.0f us, max %.0f us\n",
+                         set == &pingUs ? "Ping    " : "Snapshot", set->size(), percentile (*set, 0.5),
+                         percentile (*set, 0.9), percentile (*set, 0.99), percentile (*set, 1.0));
+
+        DAWINFO_CHECK (lost == 0);
+        // Generous: a shared machine without real-time scheduling.
+        DAWINFO_CHECK (percentile (pingUs, 0.5) < 2000.0);
+        DAWINFO_CHECK (percentile (snapshotUs, 0.99) < 20000.0);
+        DAWINFO_CHECK (channel.getStats().dropped == 0);
+    }
+}
+
+int main()
+{
+    testCommandEncoding();
+    testCommands();
+    testBoundedQueue();
+    testHistoryQueries();
+    testHistorySendFailureDropsQuery();
+    testPeaksQueries();
+    testLatency();
+    return dawinfo::test::finish ("ControlChannelTests");
+}
@@ -0,0 +1,332 @@
+#include "AllocationCounter.h"
+#include "Common/Clock.h"
+#include "Common/Control.h"
+#include "Sender/FeatureHistory.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    constexpr HostTimeNs ms = 1'000'000;
+
+    /** A query's chunks, decoded and joined back together. */
+    struct Answer
+    {
+        std::vector<history::ChunkHeader> chunks;
+        std::vector<HostTimeNs> times;
+        std::vector<float> values;
+        std::size_t bytes = 0, largestPacket = 0;
+    };
+
+    Answer stream (const FeatureHistory& h, FeatureHistory::Range range, std::int32_t token = 1)
+    {
+        Answer a;
+        std::vector<std::uint8_t> buffer (1400);
+
+        for (bool last = false, decoded = true; decoded && ! last;)
+        {
+            decoded = false;
+            OscWriter w (buffer.data(), buffer.size());
+            w.beginBundle();
+            h.writeChunk (w, token, history::Feature::spectrum, range, history::maxFramesPerChunk (h.getNumValues()));
+            DAWINFO_CHECK (! w.hasOverflowed());
+
+            a.bytes += w.getSize();
+            a.largestPacket = std::max (a.largestPacket, w.getSize());
+
+            forEachOscMessage (w.getData(), w.getSize(), [&] (const OscMessage& m)
+            {
+                history::ChunkHeader c;
+                const std::uint8_t* times = nullptr;
+                const std::uint8_t* values = nullptr;
+
+                if (! history::decodeChunk (m, c, times, values))
+                    return;
+
+                for (std::size_t i = 0; i < static_cast<std::size_t> (c.numFrames); ++i)
+                    a.times.push_back (history::timeAt (c, times, i));
+
+                for (std::size_t i = 0; i < static_cast<std::size_t> (c.numFrames * c.numValues); ++i)
+                    a.values.push_back (history::valueAt (values, i));
+
+                a.chunks.push_back (c);
+                last = c.isLast;
+                decoded = true;
+            });
+        }
+
+        return a;
+    }
+
+    /** Frames 10 ms apart holding { i, -i }. */
+    void fill (FeatureHistory& h, int first, int count)
+    {
+        for (int i = first; i < first + count; ++i)
+        {
+            const float frame[] = { static_cast<float> (i), static_cast<float> (-i) };
+            h.append (i * 10 * ms, frame);
+        }
+    }
+
+    void testTiers()
+    {
+        FeatureHistory::Options o;
+        o.framesPerTier = 12;   // rounds up to 16
+        o.numTiers = 3;
+        o.tierFactor = 4;
+
+        FeatureHistory peaks (o);
+        DAWINFO_CHECK (peaks.getMemoryUsage() == 0 && peaks.getEnd (0) == 0);
+
+        // Nothing is kept, or allocated, before allocate().
+        fill (peaks, 0, 10);
+        DAWINFO_CHECK (peaks.getMemoryUsage() == 0 && peaks.getEnd (0) == 0);
+
+        peaks.allocate();
+        fill (peaks, 0, 100);
+
+        DAWINFO_CHECK (peaks.getFramesPerTier() == 16);
+        DAWINFO_CHECK (peaks.getEnd (0) == 100 && peaks.getBegin (0) == 84);
+        DAWINFO_CHECK (peaks.getEnd (1) == 25 && peaks.getBegin (1) == 9);
+        DAWINFO_CHECK (peaks.getEnd (2) == 6 && peaks.getBegin (2) == 0);
+
+        // Tier 0 is what went in; a coarse frame starts where its first input
+        // did and keeps the largest of each value.
+        DAWINFO_CHECK (peaks.getTime (0, 99) == 990 * ms && peaks.getValue (0, 99, 1) == -99.0f);
+        DAWINFO_CHECK (peaks.getTime (1, 20) == 800 * ms && peaks.getValue (1, 20, 0) == 83.0f && peaks.getValue (1, 20, 1) == -80.0f);
+        DAWINFO_CHECK (peaks.getTime (2, 5) == 800 * ms && peaks.getValue (2, 5, 0) == 95.0f);
+
+        o.reduction = FeatureHistory::Reduction::mean;
+        FeatureHistory means (o);
+        means.allocate();
+        fill (means, 0, 100);
+        DAWINFO_CHECK_NEAR (means.getValue (1, 20, 0), 81.5, 1.0e-6);
+        DAWINFO_CHECK_NEAR (means.getValue (2, 5, 1), -87.5, 1.0e-6);
+
+        // Time stamps never go backwards.
+        const float frame[] = { 0.0f, 0.0f };
+        means.append (5 * ms, frame);
+        DAWINFO_CHECK (means.getTime (0, 100) == 990 * ms);
+
+        // The storage is fixed: more frames, same memory.
+        const auto before = peaks.getMemoryUsage();
+        test::ScopedAllocationCount counting;
+        const auto allocations = test::allocationCount();
+        fill (peaks, 100, 10000);
+        DAWINFO_CHECK (peaks.getMemoryUsage() == before && test::allocationCount() == allocations);
+    }
+
+    void testFind()
+    {
+        FeatureHistory::Options o;
+        o.framesPerTier = 16;
+        o.numTiers = 3;
+        o.tierFactor = 4;
+
+        FeatureHistory h (o);
+        h.allocate();
+        DAWINFO_CHECK (h.find (0, 1000 * ms, 100).size() == 0);
+        fill (h, 0, 100);
+
+        // Recent: full rate, both ends inclusive.
+        auto r = h.find (890 * ms, 990 * ms, 100);
+        DAWINFO_CHECK (r.tier == 0 && r.begin == 89 && r.end == 100);
+
+        // Past tier 0's reach: the next tier that goes back far enough.
+        r = h.find (500 * ms, 990 * ms, 100);
+        DAWINFO_CHECK (r.tier == 1 && r.begin == 13 && r.end == 25);
+
+        // Within reach but over the frame limit: coarser.
+        r = h.find (850 * ms, 990 * ms, 5);
+        DAWINFO_CHECK (r.tier == 1 && r.size() == 3 && h.getTime (1, r.begin) == 880 * ms);
+
+        // Everything: the coarsest, capped at its newest frames.
+        r = h.find (0, 990 * ms, 4);
+        DAWINFO_CHECK (r.tier == 2 && r.begin == 2 && r.end == 6);
+
+        // A window with nothing in it.
+        r = h.find (2000 * ms, 3000 * ms, 100);
+        DAWINFO_CHECK (r.size() == 0);
+
+        // A recent window too long for maxFrames, while the coarser tiers
+        // are still filling: they have no frames in it yet, so the answer is
+        // the newest frames of the finest tier, not an empty range.
+        FeatureHistory young;
+        young.allocate();
+
+        for (int i = 0; i < 20; ++i)
+        {
+            const float frame[] = { static_cast<float> (i), 0.0f };
+            young.append (i * ms, frame);
+        }
+
+        r = young.find (14 * ms, 19 * ms, 3);
+        DAWINFO_CHECK (r.tier == 0 && r.begin == 17 && r.end == 20);
+    }
+
+    void testChunks()
+    {
+        FeatureHistory::Options o;
+        o.numValues = 2;
+        o.framesPerTier = 1024;
+
+        FeatureHistory h (o);
+        h.allocate();
+        fill (h, 0, 1000);
+
+        // A window several chunks long comes back whole and in order.
+        const auto a = stream (h, h.find (0, 10000 * ms, 2000), 42);
+        const auto perChunk = static_cast<std::size_t> (history::maxFramesPerChunk (2));
+        DAWINFO_CHECK (a.times.size() == 1000 && a.values.size() == 2000);
+        DAWINFO_CHECK (a.chunks.size() == (1000 + perChunk - 1) / perChunk);
+        DAWINFO_CHECK (a.chunks.front().token == 42 && a.chunks.back().isLast && ! a.chunks.front().isLast);
+        DAWINFO_CHECK (a.largestPacket <= 1400);
+
+        bool exact = true;
+
+        for (std::size_t i = 0; i < a.times.size(); ++i)
+            exact &= a.times[i] == static_cast<HostTimeNs> (i) * 10 * ms
+                       && a.values[i * 2] == static_cast<float> (i) && a.values[i * 2 + 1] == -static_cast<float> (i);
+
+        DAWINFO_CHECK (exact);
+
+        // Nothing in the window: one empty, final chunk.
+        const auto empty = stream (h, h.find (50000 * ms, 60000 * ms, 100));
+        DAWINFO_CHECK (empty.chunks.size() == 1 && empty.chunks[0].numFrames == 0 && empty.chunks[0].isLast);
+
+        // Frames that fall out of the ring mid-answer are skipped.
+        auto range = h.find (0, 10000 * ms, 2000);
+        std::vector<std::uint8_t> buffer (1400);
+        OscWriter w (buffer.data(), buffer.size());
+        h.writeChunk (w, 0, history::Feature::levels, range, 50);
+        DAWINFO_CHECK (range.begin == 50);
+
+        fill (h, 1000, 500);
+        const auto rest = stream (h, range);
+        DAWINFO_CHECK (! rest.times.empty() && rest.times.front() == h.getTime (0, h.getBegin (0)));
+        DAWINFO_CHECK (rest.times.size() == static_cast<std::size_t> (1000 - h.getBegin (0)));
+
+        // A first time too near the end of the clock to add offsets to is refused.
+        history::ChunkHeader edge;
+        edge.numValues = 1;
+        edge.firstNs = std::numeric_limits<HostTimeNs>::max() - 1000;
+        w.reset();
+        history::writeChunk (w, edge, nullptr, nullptr);
+
+        bool refused = false;
+        forEachOscMessage (w.getData(), w.getSize(), [&] (const OscMessage& m)
+        {
+            history::ChunkHeader c;
+            const std::uint8_t* times = nullptr;
+            const std::uint8_t* values = nullptr;
+            refused = m.address == history::chunkAddress && ! history::decodeChunk (m, c, times, values);
+        });
+
+        DAWINFO_CHECK (refused);
+    }
+
+    /** Spectra of 64 bins at 60 Hz, with tier 0 holding each history length. */
+    void testLatencyAndMemory()
+    {
+        constexpr double rateHz = 60.0;
+        constexpr int numBins = 64, numQueries = 200;
+        const auto frameNs = static_cast<HostTimeNs> (1.0e9 / rateHz);
+
+        std::printf ("Spectrum history, %d bins at %.0f Hz, 3 tiers of 8x; answers streamed to a buffer:\n", numBins, rateHz);
+        std::printf ("  %8s %9s %9s | %9s %12s %12s | %12s %12s %7s\n", "history", "frames", "memory",
+                     "find us", "last 10 s us", "last 10 s KB", "all us", "all KB", "tier");
+
+        for (double seconds : { 10.0, 60.0, 300.0 })
+        {
+            FeatureHistory::Options o;
+            o.numValues = numBins;
+            o.framesPerTier = static_cast<std::size_t> (seconds * rateHz);
+            o.reduction = FeatureHistory::Reduction::mean;
+            FeatureHistory h (o);
+            h.allocate();
+
+            // Enough to fill every tier.
+            std::vector<float> frame (numBins);
+            const auto numFrames = static_cast<std::int64_t> (h.getFramesPerTier()) * 64 + 100;
+            HostTimeNs now = 0;
+
+            for (std::int64_t i = 0; i < numFrames; ++i)
+            {
+                frame[static_cast<std::size_t> (i % numBins)] = static_cast<float> (i);
+                now = 1000 * ms + i * frameNs;
+                h.append (now, frame.data());
+            }
+
+            const auto expectedBytes = h.getFramesPerTier() * 3 * (sizeof (HostTimeNs) + numBins * sizeof (float))
+                                         + 2 * numBins * sizeof (float);
+            DAWINFO_CHECK (h.getMemoryUsage() >= expectedBytes && h.getMemoryUsage() < expectedBytes + 1024);
+
+            std::vector<double> us;
+            us.reserve (numQueries);
+
+            test::ScopedAllocationCount counting;
+            const auto allocations = test::allocationCount();
+
+            auto time = [&] (auto&& body)
+            {
+                us.clear();
+
+                for (int q = 0; q < numQueries; ++q)
+                {
+                    const auto t0 = monotonicNowNs();
+                    body();
+                    us.push_back (static_cast<double> (monotonicNowNs() - t0) / 1000.0);
+                }
+
+                std::sort (us.begin(), us.end());
+                return us[us.size() / 2];
+            };
+
+            std::uint8_t buffer[1400];
+            std::size_t recentBytes = 0, allBytes = 0;
+            FeatureHistory::Range all;
+
+            const auto findUs = time ([&] { all = h.find (0, now, control::defaultHistoryFrames); });
+
+            auto drain = [&] (FeatureHistory::Range r, std::size_t& bytes)
+            {
+                bytes = 0;
+
+                while (r.size() > 0)
+                {
+                    OscWriter w (buffer, sizeof (buffer));
+                    h.writeChunk (w, 0, history::Feature::spectrum, r, history::maxFramesPerChunk (numBins));
+                    bytes += w.getSize();
+                }
+            };
+
+            const auto recentUs = time ([&] { drain (h.find (now - 10'000 * ms, now, control::defaultHistoryFrames), recentBytes); });
+            const auto allUs = time ([&] { drain (h.find (0, now, control::defaultHistoryFrames), allBytes); });
+
+            std::printf ("  %7.0fs %9zu %8.0fK | %9.2f %12.1f %12.1f | %12.1f %12.1f %7d\n", seconds, h.getFramesPerTier(),
+                         static_cast<double> (h.getMemoryUsage()) / 1024.0, findUs, recentUs,
+                         static_cast<double> (recentBytes) / 1024.0, allUs, static_cast<double> (allBytes) / 1024.0, all.tier);
+
+            DAWINFO_CHECK (test::allocationCount() == allocations);
+            // Generous: a shared machine. Finding is a pair of binary searches.
+            DAWINFO_CHECK (findUs < 100.0);
+            DAWINFO_CHECK (recentUs < 20000.0);
+            DAWINFO_CHECK (all.size() <= 1024 && all.size() > 0);
+        }
+    }
+}
+
+int main()
+{
+    testTiers();
+    testFind();
+    testChunks();
+    testLatencyAndMemory();
+    return dawinfo::test::finish ("FeatureHistoryTests");
+}
@@ -0,0 +1,351 @@
+#include "AllocationCounter.h"
+#include "HeadlessHost.h"
+#include "Common/Messages.h"
+#include "Sender/FramePublisher.h"
+#include "Sender/MetadataCache.h"
+#include "TestHarness.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    /** Counts what arrives and keeps the newest transport and event ids.
+        Allocates nothing, so it can sit inside a counted scope.
+    */
+    struct CountingSink : PacketSink
+    {
+        std::size_t packets = 0, bytes = 0, largestPacket = 0;
+        std::size_t transports = 0, events = 0;
+        TransportSnapshot lastTransport;
+        std::uint32_t highestEventId = 0;
+
+        bool send (const std::uint8_t* data, std::size_t size) override
+        {
+            ++packets;
+            bytes += size;
+            largestPacket = std::max (largestPacket, size);
+
+            forEachOscMessage (data, size, [&] (const OscMessage& m)
+            {
+                DiscreteEvent e;
+
+                if (schema::Codec<messages::Transport>::decode (m, lastTransport))
+                {
+                    ++transports;
+                }
+                else if (decodeEvent (m, e))
+                {
+                    ++events;
+                    highestEventId = std::max (highestEventId, e.id);
+                }
+            });
+
+            return true;
+        }
+    };
+
+    void testArena()
+    {
+        FrameArena arena (1024);
+
+        auto* a = static_cast<std::uint8_t*> (arena.allocate (3, 1));
+        auto* b = arena.allocateArray<double> (4);
+        DAWINFO_CHECK (a != nullptr && b != nullptr);
+        DAWINFO_CHECK (reinterpret_cast<std::uintptr_t> (b) % alignof (double) == 0);
+        DAWINFO_CHECK (b[0] == 0.0 && b[3] == 0.0);
+        DAWINFO_CHECK (arena.getUsed() >= 35 && arena.getUsed() < 48);
+
+        // Too much fails cleanly and leaves earlier allocations alone.
+        DAWINFO_CHECK (arena.allocate (2000) == nullptr);
+        DAWINFO_CHECK (arena.getOverflows() == 1 && arena.getUsed() < 48);
+
+        // Reset gives everything back at once.
+        const auto used = arena.getUsed();
+        arena.reset();
+        DAWINFO_CHECK (arena.getUsed() == 0 && arena.getHighWater() == used);
+        DAWINFO_CHECK (arena.allocate (1024, 1) == a);
+    }
+
+    struct Scratch
+    {
+        std::vector<float> samples;
+        int tag = 0;
+    };
+
+    void testPool()
+    {
+        SnapshotPool<Scratch> pool (4);
+
+        for (auto& s : pool)
+            s.samples.reserve (512);
+
+        // Everything in flight: the producer has to skip.
+        Scratch* taken[4];
+
+        for (int i = 0; i < 4; ++i)
+        {
+            taken[i] = pool.acquire();
+            taken[i]->tag = i;
+            pool.submit (taken[i]);
+        }
+
+        DAWINFO_CHECK (pool.acquire() == nullptr);
+
+        // In order, and each object comes back as it was left.
+        for (int i = 0; i < 4; ++i)
+        {
+            auto* s = pool.next();
+            DAWINFO_CHECK (s == taken[i] && s->tag == i);
+            pool.recycle (s);
+        }
+
+        DAWINFO_CHECK (pool.next() == nullptr);
+
+        test::ScopedAllocationCount counting;
+
+        for (int round = 0; round < 1000; ++round)
+        {
+            auto* s = pool.acquire();
+            s->samples.assign (512, static_cast<float> (round));
+            pool.submit (s);
+            pool.recycle (pool.next());
+        }
+
+        DAWINFO_CHECK (test::allocationCount() == 0);
+    }
+
+    void testCycle()
+    {
+        FramePublisher publisher (4, 2);
+        StreamSequencer seq;
+        CountingSink a, b;
+        PacketSink* sinks[] = { &a, &b };
+
+        // Nothing submitted, nothing sent.
+        DAWINFO_CHECK (publisher.publish (sinks, 2, seq) == 0);
+
+        // Three blocks between cycles: the newest transport wins, every event goes out.
+        for (int block = 0; block < 3; ++block)
+        {
+            auto* f = publisher.beginFrame();
+            f->transport.ppq = block;
+            f->transport.timeNs = 1000 * block;
+
+            if (block != 1)
+                f->addEvent (EventType::beat, 1000 * block);
+
+            publisher.submitFrame (f);
+        }
+
+        const auto sent = publisher.publish (sinks, 2, seq);
+        DAWINFO_CHECK (sent == a.bytes + b.bytes && a.bytes == b.bytes);
+        DAWINFO_CHECK (a.packets == 2 && a.transports == 1 && a.events == 2);
+        DAWINFO_CHECK (a.lastTransport.ppq == 2.0 && b.lastTransport.ppq == 2.0);
+        DAWINFO_CHECK (seq.peek (StreamId::transport) == 1 && seq.peek (StreamId::events) == 1);
+
+        // The events repeat in the next two cycles, then stop.
+        for (int cycle = 0; cycle < 3; ++cycle)
+        {
+            auto* f = publisher.beginFrame();
+            f->transport.ppq = 10 + cycle;
+            publisher.submitFrame (f);
+            publisher.publish (sinks, 2, seq);
+        }
+
+        DAWINFO_CHECK (a.events == 6 && a.transports == 4 && a.lastTransport.ppq == 12.0);
+
+        // With transport paced elsewhere, only events go out.
+        publisher.setSendsTransport (false);
+        auto* paced = publisher.beginFrame();
+        paced->addEvent (EventType::downbeat, 5000);
+        publisher.submitFrame (paced);
+        publisher.publish (sinks, 2, seq);
+        DAWINFO_CHECK (a.transports == 4 && a.events == 7 && seq.peek (StreamId::transport) == 4);
+        publisher.setSendsTransport (true);
+
+        // A full pool makes the audio thread skip, not wait.
+        for (int i = 0; i < 4; ++i)
+            publisher.submitFrame (publisher.beginFrame());
+
+        DAWINFO_CHECK (publisher.beginFrame() == nullptr);
+
+        const auto stats = publisher.getStats();
+        DAWINFO_CHECK (stats.framesSkipped == 1 && stats.frames == 11);
+        DAWINFO_CHECK (stats.arenaOverflows == 0 && stats.arenaHighWater > 0);
+        DAWINFO_CHECK (publisher.getArena().getUsed() == 0);
+    }
+
+    /** More events in one cycle than fit in a packet go out over several,
+        each with its own sequence number, and none are lost.
+    */
+    void testEventBurst()
+    {
+        FramePublisher publisher (8, 0);
+        StreamSequencer seq;
+        CountingSink sink;
+        PacketSink* sinks[] = { &sink };
+
+        for (int block = 0; block < 8; ++block)
+        {
+            auto* f = publisher.beginFrame();
+
+            for (int e = 0; e < FramePublisher::maxEventsPerFrame; ++e)
+                f->addEvent (EventType::onset, 1000 * block + e);
+
+            publisher.submitFrame (f);
+        }
+
+        publisher.publish (sinks, 1, seq);
+
+        const auto eventPackets = sink.packets - 1;
+        DAWINFO_CHECK (sink.events == 8 * FramePublisher::maxEventsPerFrame && sink.transports == 1);
+        DAWINFO_CHECK (eventPackets > 1 && seq.peek (StreamId::events) == eventPackets);
+        DAWINFO_CHECK (sink.largestPacket <= 1400 && sink.highestEventId == sink.events - 1);
+        DAWINFO_CHECK (! publisher.getEvents().hasPending());
+
+        // Jumbo packets get an arena big enough for a full cycle of them.
+        FramePublisher jumbo (8, 0, 8192);
+        DAWINFO_CHECK (jumbo.getArena().getCapacity() >= FramePublisher::minimumArenaBytes (8, 8192));
+        DAWINFO_CHECK (jumbo.getArena().getCapacity() > 9 * 8192);
+
+        for (int block = 0; block < 8; ++block)
+        {
+            auto* f = jumbo.beginFrame();
+
+            for (int e = 0; e < FramePublisher::maxEventsPerFrame; ++e)
+                f->addEvent (EventType::onset, 1000 * block + e);
+
+            jumbo.submitFrame (f);
+        }
+
+        CountingSink jumboSink;
+        PacketSink* jumboSinks[] = { &jumboSink };
+        jumbo.publish (jumboSinks, 1, seq);
+        DAWINFO_CHECK (jumboSink.events == 8 * FramePublisher::maxEventsPerFrame && jumbo.getStats().arenaOverflows == 0);
+    }
+
+    /** A headless host feeding the publisher while a sender thread sends to
+        many receivers; after a warm-up neither thread touches the heap.
+    */
+    void testSteadyStateHasNoAllocations()
+    {
+        constexpr int numSinks = 32;
+        FramePublisher publisher (16, 2);
+        std::vector<CountingSink> receivers (numSinks);
+        std::vector<PacketSink*> sinks;
+
+        for (auto& r : receivers)
+            sinks.push_back (&r);
+
+        test::HeadlessHost host (48000.0, 128);
+
+        host.start ([&] (HostTimeNs blockStart, int block)
+        {
+            test::ScopedAllocationCount counting;
+
+            if (auto* f = publisher.beginFrame())
+            {
+                f->transport.timeNs = blockStart;
+                f->transport.ppq = block * 128 / 24000.0;
+                f->transport.isPlaying = true;
+
+                if (block % 94 == 0)
+                    f->addEvent (EventType::beat, blockStart);
+
+                publisher.submitFrame (f);
+            }
+        });
+
+        std::atomic<bool> running { true };
+        int cycles = 0;
+
+        std::thread sender ([&]
+        {
+            StreamSequencer seq;
+            test::ScopedAllocationCount counting;
+
+            while (running)
+            {
+                publisher.publish (sinks.data(), numSinks, seq);
+                ++cycles;
+                std::this_thread::sleep_for (std::chrono::milliseconds (4));
+            }
+        });
+
+        std::this_thread::sleep_for (std::chrono::milliseconds (1500));
+        host.stop();
+        running = false;
+        sender.join();
+
+        const auto stats = publisher.getStats();
+        const auto& last = receivers.back();
+
+        std::printf ("Steady state: %llu frames, %d cycles, %llu packets to %d receivers (%llu sends, %.1f KB), "
+                     "arena high water %zu bytes, %llu heap allocations\n",
+                     static_cast<unsigned long long> (stats.frames), cycles, static_cast<unsigned long long> (stats.packets),
+                     numSinks, static_cast<unsigned long long> (stats.sends), stats.bytes / 1024.0,
+                     stats.arenaHighWater, static_cast<unsigned long long> (test::allocationCount()));
+
+        DAWINFO_CHECK (test::allocationCount() == 0);
+        DAWINFO_CHECK (stats.frames > 500 && stats.framesSkipped == 0);
+        DAWINFO_CHECK (stats.arenaOverflows == 0);
+        DAWINFO_CHECK (last.transports > 100 && last.events >= 3 * (stats.frames / 94));
+        DAWINFO_CHECK (last.packets == receivers.front().packets);
+    }
+
+    /** Metadata publishes reuse their scratch too, once it has grown. */
+    void testMetadataSteadyState()
+    {
+        MetadataCache cache;
+        StreamSequencer seq;
+        CountingSink sink;
+
+        std::vector<TrackInfo> a (64), b;
+
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            a[i].id = static_cast<std::uint32_t> (i + 1);
+            a[i].name = "Track " + std::to_string (i);
+        }
+
+        b = a;
+        b[7].name = "Renamed";
+        std::swap (b[3], b[4]);
+
+        cache.setTracks (a);
+        cache.publish (sink, seq);
+        cache.setTracks (b);
+        cache.publish (sink, seq);
+
+        std::uint64_t allocations = 0;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            cache.setTracks (i % 2 == 0 ? a : b);
+
+            const auto before = test::allocationCount();
+            test::ScopedAllocationCount counting;
+            cache.publish (sink, seq);
+            allocations += test::allocationCount() - before;
+        }
+
+        DAWINFO_CHECK (cache.getStats().deltas == 102);
+        DAWINFO_CHECK (allocations == 0);
+    }
+}
+
+int main()
+{
+    testArena();
+    testPool();
+    testCycle();
+    testEventBurst();
+    testSteadyStateHasNoAllocations();
+    testMetadataSteadyState();
+    return dawinfo::test::finish ("FramePublisherTests");
+}
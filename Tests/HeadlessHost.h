@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Common/Clock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace dawinfo::test
+{
+
+/**
+    Stands in for a DAW: calls a process callback from its own thread at the
+    pace a real audio device would, and records how the callback kept up.
+
+    A block is over budget when its callback alone takes longer than the
+    block lasts: a glitch whatever the scheduler does. It is late when the
+    callback finishes after the block's deadline, the time the next block is
+    due; without real-time priority that also counts wake-up delays.
+*/
+class HeadlessHost
+{
+public:
+    struct Stats
+    {
+        int blocks = 0;
+        int lateBlocks = 0;
+        int overBudgetBlocks = 0;
+        HostTimeNs maxCallbackNs = 0;
+        HostTimeNs totalCallbackNs = 0;
+    };
+
+    HeadlessHost (double sampleRate, int blockSize)
+        : sampleRate (sampleRate), blockSize (blockSize),
+          blockNs (static_cast<HostTimeNs> (blockSize * 1.0e9 / sampleRate))
+    {
+    }
+
+    ~HeadlessHost()     { stop(); }
+
+    /** Starts calling process (blockStartNs, blockIndex) on the host's own thread. */
+    template <typename Callback>
+    void start (Callback process)
+    {
+        running = true;
+
+        thread = std::thread ([this, process]() mutable
+        {
+            const auto startNs = monotonicNowNs();
+
+            for (int b = 0; running.load (std::memory_order_relaxed); ++b)
+            {
+                const auto due = startNs + b * blockNs;
+                std::this_thread::sleep_until (std::chrono::steady_clock::time_point (std::chrono::nanoseconds (due)));
+
+                const auto begin = monotonicNowNs();
+                process (due, b);
+                const auto end = monotonicNowNs();
+
+                stats.blocks = b + 1;
+                stats.maxCallbackNs = std::max (stats.maxCallbackNs, end - begin);
+                stats.totalCallbackNs += end - begin;
+
+                if (end > due + blockNs)
+                    ++stats.lateBlocks;
+
+                if (end - begin > blockNs)
+                    ++stats.overBudgetBlocks;
+            }
+        });
+    }
+
+    void stop()
+    {
+        running = false;
+
+        if (thread.joinable())
+            thread.join();
+    }
+
+    /** After stop(). */
+    const Stats& getStats() const noexcept  { return stats; }
+
+    const double sampleRate;
+    const int blockSize;
+    const HostTimeNs blockNs;
+
+private:
+    std::thread thread;
+    std::atomic<bool> running { false };
+    Stats stats;
+};
+
+} // namespace dawinfo::test
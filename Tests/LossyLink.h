@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace dawinfo::test
+{
+
+/**
+    In-process stand-in for a bad Wi-Fi link. Packets pushed in come out of
+    deliver() with some dropped and some held back and released a few packets
+    later, out of order.
+*/
+class LossyLink
+{
+public:
+    using Packet = std::vector<std::uint8_t>;
+
+    LossyLink (double dropProbability, double reorderProbability, int maxHoldPackets = 3,
+               std::uint32_t seed = 42)
+        : drop (dropProbability), reorder (reorderProbability), maxHold (maxHoldPackets), rng (seed)
+    {
+    }
+
+    /** Sends a packet and returns the ones that arrive as a result, in arrival order. */
+    std::vector<Packet> send (const std::uint8_t* data, std::size_t size)
+    {
+        std::vector<Packet> arrived;
+        ++sent;
+
+        for (auto& h : held)
+            --h.packetsLeft;
+
+        if (unit (rng) < drop)
+        {
+            ++dropped;
+        }
+        else if (unit (rng) < reorder)
+        {
+            ++reordered;
+            held.push_back ({ Packet (data, data + size), 1 + static_cast<int> (unit (rng) * maxHold) });
+        }
+        else
+        {
+            arrived.emplace_back (data, data + size);
+        }
+
+        while (! held.empty() && held.front().packetsLeft <= 0)
+        {
+            arrived.push_back (std::move (held.front().packet));
+            held.pop_front();
+        }
+
+        return arrived;
+    }
+
+    /** Releases everything still held. */
+    std::vector<Packet> flush()
+    {
+        std::vector<Packet> arrived;
+
+        for (auto& h : held)
+            arrived.push_back (std::move (h.packet));
+
+        held.clear();
+        return arrived;
+    }
+
+    std::uint64_t sent = 0, dropped = 0, reordered = 0;
+
+private:
+    struct Held { Packet packet; int packetsLeft; };
+
+    double drop, reorder;
+    int maxHold;
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> unit { 0.0, 1.0 };
+    std::deque<Held> held;
+};
+
+} // namespace dawinfo::test
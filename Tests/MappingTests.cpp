@@ -0,0 +1,205 @@
+#include "AllocationCounter.h"
+#include "Common/Config.h"
+#include "Common/Mapping.h"
+#include "TestHarness.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    Mapping compile (const char* text)
+    {
+        Mapping m;
+        std::string error;
+
+        if (! Mapping::compile (text, m, error))
+            std::printf ("'%s': %s\n", text, error.c_str());
+
+        return m;
+    }
+
+    bool fails (const char* text, const char* expectedError)
+    {
+        Mapping m;
+        std::string error;
+        const bool failed = ! Mapping::compile (text, m, error);
+
+        if (failed && error != expectedError)
+            std::printf ("'%s': %s\n", text, error.c_str());
+
+        return failed && error == expectedError;
+    }
+
+    void testLanguage()
+    {
+        DAWINFO_CHECK (Mapping().isIdentity() && compile ("").isIdentity() && compile ("  x ").isIdentity());
+        DAWINFO_CHECK (Mapping().evaluate (0.3f) == 0.3f);
+
+        // Precedence and associativity.
+        DAWINFO_CHECK (compile ("1 + 2 * x").evaluate (3.0f) == 7.0f);
+        DAWINFO_CHECK (compile ("(1 + 2) * x").evaluate (3.0f) == 9.0f);
+        DAWINFO_CHECK (compile ("x - 1 - 1").evaluate (5.0f) == 3.0f);
+        DAWINFO_CHECK (compile ("x / 2 / 2").evaluate (8.0f) == 2.0f);
+        DAWINFO_CHECK (compile ("2 ^ x ^ 2").evaluate (3.0f) == 512.0f);
+        DAWINFO_CHECK (compile ("-x ^ 2").evaluate (3.0f) == -9.0f);
+        DAWINFO_CHECK (compile ("--x").evaluate (3.0f) == 3.0f);
+        DAWINFO_CHECK (compile ("1 - x").evaluate (0.25f) == 0.75f);
+        DAWINFO_CHECK (compile ("2 / x").evaluate (4.0f) == 0.5f);
+
+        // Functions and constants.
+        DAWINFO_CHECK (compile ("clamp ((x - 60) / 120, 0, 1)").evaluate (120.0f) == 0.5f);
+        DAWINFO_CHECK (compile ("clamp ((x - 60) / 120, 0, 1)").evaluate (240.0f) == 1.0f);
+        DAWINFO_CHECK (compile ("clamp (x, x - 1, 2)").evaluate (5.0f) == 2.0f);
+        DAWINFO_CHECK_NEAR (compile ("db (x)").evaluate (0.5f), -6.0206, 1e-4);
+        DAWINFO_CHECK (compile ("db (x)").evaluate (0.0f) == -200.0f);
+        DAWINFO_CHECK_NEAR (compile ("gain (-6.0206)").evaluate (0.0f), 0.5, 1e-5);
+        DAWINFO_CHECK_NEAR (compile ("scale (x, -60, 0, 0, 1)").evaluate (-15.0f), 0.75, 1e-6);
+        DAWINFO_CHECK_NEAR (compile ("scale (x, 0, 1, x, 2 * x)").evaluate (0.5f), 0.75, 1e-6);
+        DAWINFO_CHECK_NEAR (compile ("sqrt (abs (x)) + log (exp (1)) + log10 (100) + floor (1.5)").evaluate (-4.0f), 6.0, 1e-5);
+        DAWINFO_CHECK (compile ("min (x, 1) + max (x, 1) + pow (x, 2)").evaluate (3.0f) == 13.0f);
+        DAWINFO_CHECK_NEAR (compile ("pi").evaluate (0.0f), 3.14159265, 1e-6);
+        DAWINFO_CHECK (compile ("x + i / n").evaluate (1.0f, 2, 4) == 1.5f);
+        DAWINFO_CHECK (compile (".5e1").evaluate (0.0f) == 5.0f);
+
+        // Errors say where.
+        DAWINFO_CHECK (fails ("x +", "at column 4: expected a value"));
+        DAWINFO_CHECK (fails ("(x", "at column 3: expected ')'"));
+        DAWINFO_CHECK (fails ("x x", "at column 3: unexpected 'x'"));
+        DAWINFO_CHECK (fails ("y * 2", "at column 1: unknown name 'y'"));
+        DAWINFO_CHECK (fails ("clamp (x, 0)", "at column 12: clamp takes 3 arguments"));
+        DAWINFO_CHECK (fails ("db (x, 1)", "at column 6: db takes 1 argument"));
+        DAWINFO_CHECK (fails ("scale (x, 1, 1, 0, 1)", "at column 22: scale needs an input range that isn't empty"));
+        DAWINFO_CHECK (fails ("x $ 2", "at column 3: unexpected '$'"));
+        DAWINFO_CHECK (fails ("1e99", "at column 1: bad number"));
+        DAWINFO_CHECK (fails ((std::string (100, '(') + "x" + std::string (100, ')')).c_str(), "at column 65: nested too deeply"));
+
+        // Limits on the program's length and the evaluation stack.
+        std::string longSum = "x", deepSum = "x";
+
+        for (int i = 0; i < 40; ++i)
+            longSum += " + x";
+
+        for (int i = 0; i < 16; ++i)
+            deepSum = "x + (" + deepSum + ")";
+
+        DAWINFO_CHECK (fails (longSum.c_str(), "at column 131: too long"));
+        DAWINFO_CHECK (fails (deepSum.c_str(), "at column 82: needs too deep a stack"));
+    }
+
+    void testFolding()
+    {
+        // Constants fold away; a right-hand constant rides in the instruction.
+        DAWINFO_CHECK (compile ("(2 + 3) * 4").getNumInstructions() == 1);
+        DAWINFO_CHECK (compile ("db (1) + gain (0)").getNumInstructions() == 1);
+        DAWINFO_CHECK (compile ("clamp ((x - 60) / 120, 0, 1)").getNumInstructions() == 4);
+
+        // A fixed scale is one multiply-add after the input.
+        const auto scale = compile ("scale (x, 60, 180, 0, 1)");
+        DAWINFO_CHECK (scale.getNumInstructions() == 2 && scale.getInstruction (1).op == Mapping::Op::mulAddK);
+        DAWINFO_CHECK_NEAR (scale.evaluate (120.0f), 0.5, 1e-6);
+
+        const auto levels = compile ("scale (db (x), -60, 0, 0, 1)");
+        DAWINFO_CHECK (levels.getNumInstructions() == 3);
+    }
+
+    /** The array form gives the same answers as one value at a time, for
+        every length around the block size.
+    */
+    void testVectorised()
+    {
+        const char* mappings[] = {
+            "x",
+            "clamp ((x - 60) / 120, 0, 1)",
+            "scale (db (x), -60, 0, 0, 1)",
+            "x * gain (3 * log10 (i + 1))",
+            "(x - 0.5) * (x - 0.5) * 4 - i / n",
+            "min (x, 0.5) + max (x, i / n) - abs (-x) / 2",
+            "clamp (x, i / n, 1 - i / 2 / n) ^ 2",
+            "scale (x, 0, n, i, 2 * i) / (1 + x)",
+            "-sqrt (x) + floor (x * 10) + exp (x) - log (x + 1) + pow (x, i / n)",
+        };
+
+        for (const auto* text : mappings)
+        {
+            const auto m = compile (text);
+
+            for (const int n : { 1, 3, 4, 63, 64, 65, 130, 512 })
+            {
+                std::vector<float> in (static_cast<std::size_t> (n)), out (in.size());
+
+                for (int j = 0; j < n; ++j)
+                    in[static_cast<std::size_t> (j)] = 0.001f + static_cast<float> (j % 97) / 97.0f;
+
+                m.evaluate (in.data(), out.data(), n);
+                int mismatches = 0;
+
+                for (int j = 0; j < n; ++j)
+                    if (std::abs (out[static_cast<std::size_t> (j)] - m.evaluate (in[static_cast<std::size_t> (j)], j, n)) > 1e-6f)
+                        ++mismatches;
+
+                if (mismatches > 0)
+                    std::printf ("'%s', n = %d: %d mismatches\n", text, n, mismatches);
+
+                DAWINFO_CHECK (mismatches == 0);
+            }
+        }
+
+        // In place.
+        const auto m = compile ("x * 2 + i");
+        std::vector<float> values (100, 1.0f);
+        m.evaluate (values.data(), values.data(), 100);
+        DAWINFO_CHECK (values[0] == 2.0f && values[99] == 101.0f);
+    }
+
+    void testNoAllocation()
+    {
+        const auto m = compile ("scale (db (x), -60, 0, 0, 1)");
+        std::vector<float> in (512, 0.5f), out (512);
+
+        test::ScopedAllocationCount counting;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            m.evaluate (in.data(), out.data(), 512);
+            out[0] += m.evaluate (0.25f);
+        }
+
+        DAWINFO_CHECK (test::allocationCount() == 0);
+    }
+
+    void testConfigKeys()
+    {
+        SenderConfig c;
+        std::string error;
+        DAWINFO_CHECK (config::parse ("map.bpm = clamp ((x - 60) / 120, 0, 1)\nmap.levels = scale (db (x), -60, 0, 0, 1)\n", c, error));
+        DAWINFO_CHECK (c.bpmMapping.evaluate (120.0f) == 0.5f && ! c.levelsMapping.isIdentity());
+        DAWINFO_CHECK (c.spectrumMapping.isIdentity() && c.parameterMapping.isIdentity());
+
+        SenderConfig again;
+        DAWINFO_CHECK (config::parse (config::format (c), again, error));
+        DAWINFO_CHECK (again.bpmMapping.getSource() == c.bpmMapping.getSource());
+        DAWINFO_CHECK (again.levelsMapping.getSource() == c.levelsMapping.getSource());
+
+        // A bad mapping is refused with the compiler's message, and the config is left alone.
+        DAWINFO_CHECK (! config::setValue (c, "map.spectrum", "db (x", error));
+        DAWINFO_CHECK (error == "map.spectrum at column 6: expected ')'");
+        DAWINFO_CHECK (c.spectrumMapping.isIdentity());
+
+        DAWINFO_CHECK (config::setValue (c, "map.bpm", "", error) && c.bpmMapping.isIdentity());
+    }
+}
+
+int main()
+{
+    testLanguage();
+    testFolding();
+    testVectorised();
+    testNoAllocation();
+    testConfigKeys();
+    return dawinfo::test::finish ("MappingTests");
+}
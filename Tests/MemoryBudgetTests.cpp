@@ -0,0 +1,223 @@
+#include "Common/Config.h"
+#include "Sender/AnalysisInput.h"
+#include "Sender/CoalescingQueue.h"
+#include "Sender/FramePublisher.h"
+#include "Sender/MemoryBudget.h"
+#include "Sender/MetadataCache.h"
+#include "Sender/MidiForwarder.h"
+#include "Sender/ParameterObserver.h"
+#include "Sender/WaveformPublisher.h"
+#include "TestHarness.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#if defined (__GLIBC__)
+ #include <malloc.h>
+#endif
+
+using namespace dawinfo;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512, numParameters = 64;
+
+    /** The sender components of one plugin instance, built the way a
+        plugin builds them, with the waveform on if asked.
+    */
+    struct Instance
+    {
+        explicit Instance (const BufferSizes& sizes, bool waveformOn)
+            : midi (sizes.midiRing), parameters (numParameters, sizes.parameterRing)
+        {
+            analysis.prepare (sampleRate, 2, blockSize);
+
+            if (waveformOn)
+            {
+                const std::vector<float> silence (64);
+                const float* channels[] = { silence.data(), silence.data() };
+                waveform.prepare (sizes.waveformRing);
+                waveform.pushBlock (channels, 2, 64);
+                waveform.update();
+            }
+        }
+
+        MemoryReport report() const
+        {
+            MemoryReport r;
+            frames.reportMemory (r);
+            midi.reportMemory (r);
+            parameters.reportMemory (r);
+            metadata.reportMemory (r);
+            waveform.reportMemory (r);
+            analysis.reportMemory (r);
+            return r;
+        }
+
+        FramePublisher frames;
+        MidiForwarder midi;
+        ParameterObserver parameters;
+        MetadataCache metadata;
+        WaveformPublisher waveform { 2 };
+        AnalysisInput analysis;
+    };
+
+    /** Heap bytes in use, or 0 where the allocator can't say. */
+    std::size_t heapInUse()
+    {
+       #if defined (__GLIBC__)
+        const auto info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+       #else
+        return 0;
+       #endif
+    }
+
+    void testReport()
+    {
+        MemoryReport r;
+        r.add (MemoryReport::rings, 100);
+        r.add (MemoryReport::shared, 1000);
+        r.add (MemoryReport::rings, 20);
+        DAWINFO_CHECK (r.get (MemoryReport::rings) == 120 && r.getTotal() == 120);
+        DAWINFO_CHECK (std::string (MemoryReport::getName (MemoryReport::pyramids)) == "pyramids");
+
+        // The waveform owns only its pyramid's counters until it's prepared.
+        WaveformPublisher waveform (2);
+        MemoryReport before;
+        waveform.reportMemory (before);
+        DAWINFO_CHECK (before.getTotal() == 8 * 12);       // the pyramid's counters
+
+        waveform.prepare (64);
+        MemoryReport prepared;
+        waveform.reportMemory (prepared);
+        DAWINFO_CHECK (prepared.get (MemoryReport::rings) > 0 && prepared.get (MemoryReport::rings) <= 64 * 64);
+        DAWINFO_CHECK (prepared.get (MemoryReport::pyramids) >= 2 * 12 * 4096 * sizeof (PeakBin));
+
+        // A coalescing queue grows with what it holds.
+        CoalescingQueue queue;
+        MemoryReport empty, holding;
+        queue.reportMemory (empty);
+        const std::vector<std::uint8_t> packet (1000);
+        queue.push (packet.data(), packet.size());
+        queue.reportMemory (holding);
+        DAWINFO_CHECK (holding.get (MemoryReport::queues) >= empty.get (MemoryReport::queues) + 1000);
+
+        // The resampler's bank is shared, so it isn't part of an instance's total.
+        AnalysisInput analysis;
+        analysis.prepare (44100.0, 2, blockSize);
+        MemoryReport a;
+        analysis.reportMemory (a);
+        DAWINFO_CHECK (a.get (MemoryReport::shared) > 0 && a.get (MemoryReport::analysis) > 0);
+        DAWINFO_CHECK (a.getTotal() == a.get (MemoryReport::analysis));
+    }
+
+    void testCompactSizes()
+    {
+        SenderConfig config;
+        DAWINFO_CHECK (! config.compactMemory);
+
+        const auto defaults = BufferSizes::choose (config, sampleRate, blockSize, numParameters);
+        DAWINFO_CHECK (defaults.midiRing == 8192 && defaults.parameterRing == 8192 && defaults.waveformRing == 0);
+
+        std::string error;
+        DAWINFO_CHECK (config::setValue (config, "memory.compact", "1", error) && config.compactMemory);
+        DAWINFO_CHECK (! config::setValue (config, "memory.compact", "2", error) && config.compactMemory);
+
+        SenderConfig again;
+        DAWINFO_CHECK (config::parse (config::format (config), again, error) && again.compactMemory);
+
+        // Four 60 Hz cycles: 93.75 blocks/s of up to two points per parameter,
+        // 4000 MIDI events/s, and 750 waveform bins/s (at least 64 of each).
+        const auto compact = BufferSizes::choose (config, sampleRate, blockSize, numParameters);
+        DAWINFO_CHECK (compact.parameterRing == 800 && compact.midiRing == 267 && compact.waveformRing == 64);
+
+        // Slower streams mean longer between drains, and bigger rings, up to the defaults.
+        config.transportRateHz = config.levelsRateHz = config.spectrumRateHz = 1.0;
+        const auto slow = BufferSizes::choose (config, sampleRate, 64, numParameters);
+        DAWINFO_CHECK (slow.parameterRing == 8192 && slow.midiRing == 8192 && slow.waveformRing == 3000);
+    }
+
+    struct Footprint
+    {
+        std::size_t reported = 0, measured = 0;
+        MemoryReport report;
+    };
+
+    Footprint measure (const SenderConfig& config, bool waveformOn)
+    {
+        constexpr int numInstances = 20;
+        const auto sizes = BufferSizes::choose (config, sampleRate, blockSize, numParameters);
+
+        // Makes the shared bank before measuring, as the first instance would.
+        Instance warm (sizes, waveformOn);
+
+        Footprint f;
+        std::vector<std::unique_ptr<Instance>> instances;
+        const auto before = heapInUse();
+
+        for (int i = 0; i < numInstances; ++i)
+            instances.push_back (std::make_unique<Instance> (sizes, waveformOn));
+
+        f.measured = (heapInUse() - before) / numInstances;
+        f.report = instances.front()->report();
+        f.reported = sizeof (Instance) + f.report.getTotal();
+        return f;
+    }
+
+    /** Per-instance memory, as reported and as the heap sees it, against a budget. */
+    void testInstanceBudget()
+    {
+        SenderConfig worstCase, compact;
+        compact.compactMemory = true;
+
+        struct Case
+        {
+            const char* name;
+            const SenderConfig* config;
+            bool waveformOn;
+            std::size_t budgetKb;
+        };
+
+        const Case cases[] = {
+            { "default",           &worstCase, false, 512 },
+            { "compact",           &compact,   false, 160 },
+            { "compact, waveform", &compact,   true,  1024 },
+        };
+
+        std::printf ("Per-instance memory (%d parameters, %.0f Hz, %d-sample blocks):\n", numParameters, sampleRate, blockSize);
+        std::printf ("  %-18s %9s %9s %9s %9s %9s %9s %9s %9s\n", "", "rings", "analysis", "pyramids", "packets",
+                     "state", "objects", "reported", "measured");
+
+        for (const auto& c : cases)
+        {
+            const auto f = measure (*c.config, c.waveformOn);
+            const auto kb = [] (std::size_t bytes) { return static_cast<double> (bytes) / 1024.0; };
+
+            std::printf ("  %-18s %6.1f KB %6.1f KB %6.1f KB %6.1f KB %6.1f KB %6.1f KB %6.1f KB %6.1f KB\n", c.name,
+                         kb (f.report.get (MemoryReport::rings)), kb (f.report.get (MemoryReport::analysis)),
+                         kb (f.report.get (MemoryReport::pyramids)), kb (f.report.get (MemoryReport::packets)),
+                         kb (f.report.get (MemoryReport::state)), kb (sizeof (Instance)), kb (f.reported), kb (f.measured));
+
+            DAWINFO_CHECK (f.reported < c.budgetKb * 1024);
+
+            // The report accounts for what the heap holds, give or take
+            // allocator overhead and the small pieces it leaves out.
+            if (f.measured > 0)
+            {
+                DAWINFO_CHECK (f.measured < c.budgetKb * 1024);
+                DAWINFO_CHECK_NEAR (static_cast<double> (f.reported), static_cast<double> (f.measured), 0.1 * static_cast<double> (f.measured));
+            }
+        }
+    }
+}
+
+int main()
+{
+    testReport();
+    testCompactSizes();
+    testInstanceBudget();
+    return dawinfo::test::finish ("MemoryBudgetTests");
+}
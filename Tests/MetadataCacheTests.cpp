@@ -0,0 +1,278 @@
+#include "MirrorSink.h"
+#include "Receiver/MetadataMirror.h"
+#include "Sender/MetadataCache.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    using MirrorSink = test::MirrorSink<MetadataMirror>;
+
+    std::vector<TrackInfo> makeSession (int numTracks)
+    {
+        std::vector<TrackInfo> tracks;
+
+        for (int i = 0; i < numTracks; ++i)
+        {
+            TrackInfo t;
+            t.id = static_cast<std::uint32_t> (1000 + i);
+            t.name = "Track " + std::to_string (i + 1) + (i % 3 == 0 ? " - Drums Bus" : "");
+            t.colour = 0xff000000u | static_cast<std::uint32_t> (i * 2654435761u & 0xffffffu);
+            t.numChannels = i % 5 == 0 ? 1 : 2;
+            tracks.push_back (t);
+        }
+
+        return tracks;
+    }
+
+    bool mirrorMatches (const MetadataMirror& mirror, const std::vector<TrackInfo>& expected)
+    {
+        return mirror.getTracks() == expected;
+    }
+
+    /** What it would cost to resend everything on every change. */
+    std::size_t naiveResendBytes (const std::vector<TrackInfo>& session)
+    {
+        MetadataCache fresh;
+        StreamSequencer seq;
+        MirrorSink sink;
+        fresh.setTracks (session);
+        return fresh.publish (sink, seq);
+    }
+
+    void testScriptedSession()
+    {
+        MetadataCache cache;
+        StreamSequencer seq;
+        MirrorSink sink;
+        auto session = makeSession (200);
+        std::mt19937 rng (99);
+
+        std::printf ("Scripted 200-track session, bytes sent per step:\n");
+        std::printf ("  %-34s %8s %8s %8s\n", "step", "delta", "naive", "packets");
+
+        std::size_t totalDelta = 0, totalNaive = 0;
+
+        auto step = [&] (const char* name)
+        {
+            const auto packetsBefore = sink.packets;
+            cache.setTracks (session);
+            const auto delta = cache.publish (sink, seq);
+            const auto naive = naiveResendBytes (session);
+            totalDelta += delta;
+            totalNaive += naive;
+
+            std::printf ("  %-34s %8zu %8zu %8zu\n", name, delta, naive, sink.packets - packetsBefore);
+            DAWINFO_CHECK (mirrorMatches (sink.mirror, session));
+            DAWINFO_CHECK (sink.mirror.getVersion() == cache.getVersion());
+            return delta;
+        };
+
+        const auto initial = step ("initial");
+        DAWINFO_CHECK (initial > 0);
+
+        DAWINFO_CHECK (step ("no change") == 0);
+
+        for (int i = 0; i < 5; ++i)
+            session[static_cast<std::size_t> (rng() % session.size())].name += " (edit)";
+        const auto renamed = step ("rename 5 tracks");
+        DAWINFO_CHECK (renamed > 0 && renamed < initial / 20);
+
+        std::rotate (session.begin() + 10, session.begin() + 11, session.begin() + 150);
+        const auto moved = step ("move one track");
+        DAWINFO_CHECK (moved < initial / 4);
+
+        std::shuffle (session.begin(), session.end(), rng);
+        const auto shuffled = step ("shuffle all tracks");
+        DAWINFO_CHECK (shuffled < initial / 4);
+
+        session[3].colour ^= 0x00ffffffu;
+        session.erase (session.begin() + 7);
+        session.erase (session.begin() + 70);
+        TrackInfo added;
+        added.id = 5000;
+        added.name = "New Audio Track";
+        session.insert (session.begin() + 20, added);
+        step ("recolour, remove 2, add 1");
+
+        for (int i = 0; i < 50; ++i)
+        {
+            auto& t = session[static_cast<std::size_t> (rng() % session.size())];
+            t.name = "Renamed " + std::to_string (i);
+            std::swap (t, session[static_cast<std::size_t> (rng() % session.size())]);
+        }
+        step ("rename and reorder 50");
+
+        std::printf ("  %-34s %8zu %8zu\n", "total", totalDelta, totalNaive);
+        DAWINFO_CHECK (totalDelta * 2 < totalNaive);
+
+        // A receiver joining late asks for everything.
+        MirrorSink late;
+        cache.requestFullSync();
+        const auto full = cache.publish (late, seq);
+        std::printf ("  %-34s %8zu\n", "full sync for a new receiver", full);
+        DAWINFO_CHECK (mirrorMatches (late.mirror, session));
+        DAWINFO_CHECK (late.mirror.getVersion() == cache.getVersion());
+        DAWINFO_CHECK (cache.getStats().fullSyncs == 1);
+    }
+
+    void testLostDeltaNeedsFullSync()
+    {
+        MetadataCache cache;
+        StreamSequencer seq;
+        MirrorSink sink;
+        auto session = makeSession (20);
+
+        cache.setTracks (session);
+        cache.publish (sink, seq);
+        DAWINFO_CHECK (mirrorMatches (sink.mirror, session));
+
+        session[0].name = "lost rename";
+        sink.dropNext = 1;
+        cache.setTracks (session);
+        cache.publish (sink, seq);
+
+        session[1].name = "next rename";
+        cache.setTracks (session);
+        cache.publish (sink, seq);
+
+        DAWINFO_CHECK (sink.mirror.needsFullSync());
+        DAWINFO_CHECK (sink.mirror.findTrack (session[1].id)->name != "next rename");
+
+        cache.requestFullSync();
+        cache.publish (sink, seq);
+        DAWINFO_CHECK (! sink.mirror.needsFullSync());
+        DAWINFO_CHECK (mirrorMatches (sink.mirror, session));
+    }
+
+    void testLostFullSyncPartNeedsFullSync()
+    {
+        MetadataCache cache (512);
+        StreamSequencer seq;
+        MirrorSink sink;
+        auto session = makeSession (100);
+
+        cache.setTracks (session);
+        cache.publish (sink, seq);
+        DAWINFO_CHECK (mirrorMatches (sink.mirror, session));
+
+        // The first part of a multi-part full sync goes missing.
+        const auto before = sink.packets;
+        sink.dropNext = 1;
+        cache.requestFullSync();
+        cache.publish (sink, seq);
+        DAWINFO_CHECK (sink.packets > before + 2 && sink.mirror.getVersion() == 1);
+
+        session[0].name = "renamed";
+        cache.setTracks (session);
+        cache.publish (sink, seq);
+        DAWINFO_CHECK (sink.mirror.needsFullSync());
+
+        cache.requestFullSync();
+        cache.publish (sink, seq);
+        DAWINFO_CHECK (! sink.mirror.needsFullSync());
+        DAWINFO_CHECK (sink.mirror.getVersion() == cache.getVersion());
+        DAWINFO_CHECK (mirrorMatches (sink.mirror, session));
+    }
+
+    void testMultiPartUpdates()
+    {
+        // A small MTU forces every update to be split.
+        MetadataCache cache (512);
+        StreamSequencer seq;
+        MirrorSink sink;
+        auto session = makeSession (600);
+
+        cache.setTracks (session);
+        cache.publish (sink, seq);
+        DAWINFO_CHECK (sink.packets > 40);
+        DAWINFO_CHECK (mirrorMatches (sink.mirror, session));
+
+        std::reverse (session.begin(), session.end());
+        session[5].name = std::string (400, 'x');   // truncated by the cache
+        cache.setTracks (session);
+        cache.publish (sink, seq);
+
+        session[5].name.resize (MetadataCache::maxNameLength);
+        DAWINFO_CHECK (mirrorMatches (sink.mirror, session));
+    }
+
+    void testTinyPacketSize()
+    {
+        // Too small for even the header: raised to fit one long-named track.
+        MetadataCache cache (16);
+        StreamSequencer seq;
+        MirrorSink sink;
+        auto session = makeSession (20);
+
+        for (auto& t : session)
+            t.name.assign (MetadataCache::maxNameLength, 'n');
+
+        cache.setTracks (session);
+        DAWINFO_CHECK (cache.publish (sink, seq) > 0);
+        DAWINFO_CHECK (sink.packets >= session.size());
+        DAWINFO_CHECK (! sink.mirror.needsFullSync());
+        DAWINFO_CHECK (sink.mirror.getVersion() == cache.getVersion());
+        DAWINFO_CHECK (mirrorMatches (sink.mirror, session));
+    }
+
+    void testCodecRoundTrip()
+    {
+        std::uint8_t buffer[512];
+        OscWriter w (buffer, sizeof (buffer));
+        w.beginBundle();
+
+        TrackInfo t;
+        t.id = 0xfffffff0u;
+        t.name = "Lead Vox";
+        t.colour = 0xff112233u;
+        t.numChannels = 6;
+        metadata::writeTrack (w, t);
+        const auto afterTrack = w.getSize();
+        DAWINFO_CHECK (afterTrack - 16 == metadata::trackSize (t));
+
+        const std::uint32_t ids[] = { 7, 0x80000000u, 9 };
+        metadata::writeOrderChunk (w, 3, 10, ids, 3);
+        DAWINFO_CHECK (w.getSize() - afterTrack == metadata::orderChunkSize (3));
+
+        int seen = 0;
+        forEachOscMessage (w.getData(), w.getSize(), [&] (const OscMessage& m)
+        {
+            TrackInfo d;
+            std::size_t offset = 0, total = 0, n = 0;
+            const std::uint8_t* p = nullptr;
+
+            if (metadata::decodeTrack (m, d))
+            {
+                DAWINFO_CHECK (d == t);
+                ++seen;
+            }
+            else if (metadata::decodeOrderChunk (m, offset, total, p, n))
+            {
+                DAWINFO_CHECK (offset == 3 && total == 10 && n == 3);
+                DAWINFO_CHECK (readBigEndian32 (p + 4) == 0x80000000u);
+                ++seen;
+            }
+        });
+
+        DAWINFO_CHECK (seen == 2);
+    }
+}
+
+int main()
+{
+    testCodecRoundTrip();
+    testScriptedSession();
+    testLostDeltaNeedsFullSync();
+    testLostFullSyncPartNeedsFullSync();
+    testMultiPartUpdates();
+    testTinyPacketSize();
+    return dawinfo::test::finish ("MetadataCacheTests");
+}
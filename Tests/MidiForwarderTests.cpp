@@ -0,0 +1,382 @@
+#include "Common/Clock.h"
+#include "Common/Messages.h"
+#include "Sender/MemoryBudget.h"
+#include "Sender/MidiForwarder.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    /** Decodes every forwarded packet back into events. */
+    struct DecodingSink : PacketSink
+    {
+        std::vector<MidiEvent> events;
+        std::size_t packets = 0, bytes = 0, largestPacket = 0;
+        bool keepEvents = true;
+        std::atomic<std::uint64_t> count { 0 };
+        HostTimeNs latencySumNs = 0, maxLatencyNs = 0;
+        bool measureLatency = false;
+
+        bool send (const std::uint8_t* data, std::size_t size) override
+        {
+            ++packets;
+            bytes += size;
+            largestPacket = std::max (largestPacket, size);
+            const auto now = measureLatency ? monotonicNowNs() : 0;
+
+            forEachOscMessage (data, size, [&] (const OscMessage& m)
+            {
+                MidiEvent e;
+
+                if (schema::Codec<messages::Midi>::decode (m, e))
+                {
+                    ++count;
+
+                    if (measureLatency)
+                    {
+                        latencySumNs += now - e.timeNs;
+                        maxLatencyNs = std::max (maxLatencyNs, now - e.timeNs);
+                    }
+
+                    if (keepEvents)
+                        events.push_back (e);
+                }
+            });
+
+            return true;
+        }
+    };
+
+    BlockMidiEvent make (int offset, std::uint8_t status, std::uint8_t d1, std::uint8_t d2)
+    {
+        BlockMidiEvent e;
+        e.sampleOffset = offset;
+        e.data[0] = status;
+        e.data[1] = d1;
+        e.data[2] = d2;
+        e.size = 3;
+        return e;
+    }
+
+    void testTimestampsAndBatching()
+    {
+        MidiForwarder forwarder;
+        StreamSequencer seq;
+        DecodingSink sink;
+
+        std::vector<BlockMidiEvent> block;
+        for (int i = 0; i < 100; ++i)
+            block.push_back (make (i * 5, 0x90, static_cast<std::uint8_t> (i), 100));
+
+        const HostTimeNs start = 1000000000;
+        forwarder.pushBlock (block.data(), static_cast<int> (block.size()), start, 48000.0);
+        forwarder.forward (sink, seq, start);
+
+        DAWINFO_CHECK (sink.events.size() == 100);
+        DAWINFO_CHECK (sink.events[0].timeNs == start);
+        // Offset 480 at 48 kHz is exactly 10 ms after the block start.
+        DAWINFO_CHECK (sink.events[96].timeNs == start + 10000000);
+        DAWINFO_CHECK (sink.events[99].data1 == 99 && sink.events[99].status == 0x90);
+
+        // 48-byte messages batched into MTU-sized bundles.
+        DAWINFO_CHECK (sink.packets == 4);
+        DAWINFO_CHECK (sink.largestPacket <= 1400);
+        DAWINFO_CHECK (seq.peek (StreamId::midi) == 4);
+
+        // A packet size too small for one message sends nothing, rather than cut-off bundles.
+        MidiForwarder tiny (256, 48);
+        DecodingSink tinySink;
+        tiny.pushBlock (block.data(), 4, start, 48000.0);
+        tiny.forward (tinySink, seq, start);
+        DAWINFO_CHECK (tinySink.packets == 0 && tiny.getStats().packets == 0);
+    }
+
+    void testFiltering()
+    {
+        MidiForwarder forwarder;
+        StreamSequencer seq;
+        DecodingSink sink;
+
+        MidiForwarder::Filter f;
+        f.channelMask = 1u << 0 | 1u << 9;                  // channels 1 and 10
+        f.typeMask = midi::noteOn | midi::noteOff;
+        forwarder.setFilter (f);
+
+        const BlockMidiEvent block[] = {
+            make (0, 0x90, 60, 100),    // ch 1 note on: kept
+            make (1, 0x91, 60, 100),    // ch 2: dropped
+            make (2, 0x89, 36, 0),      // ch 10 note off: kept
+            make (3, 0xb0, 7, 64),      // CC: dropped
+            make (4, 0xf8, 0, 0),       // clock: not a channel message
+        };
+
+        forwarder.pushBlock (block, 5, 0, 44100.0);
+        forwarder.forward (sink, seq, 0);
+
+        DAWINFO_CHECK (sink.events.size() == 2);
+        DAWINFO_CHECK (forwarder.getStats().filtered == 3);
+        DAWINFO_CHECK (sink.events.size() == 2 && sink.events[1].status == 0x89);
+    }
+
+    void testMalformedInput()
+    {
+        MidiForwarder forwarder;
+        StreamSequencer seq;
+        DecodingSink sink;
+        forwarder.setThinning ({ 10000000, 2 });    // routes controllers through the table
+
+        auto programChange = make (4, 0xc3, 12, 0);
+        programChange.size = 2;
+        auto truncated = make (5, 0x90, 60, 0);
+        truncated.size = 2;
+        auto overlong = programChange;
+        overlong.size = 3;
+
+        const BlockMidiEvent block[] = {
+            make (0, 0xbf, 0x80, 64),   // controller number past the table
+            make (1, 0xb0, 0xff, 0xff),
+            make (2, 0x90, 60, 0x80),   // velocity with the top bit set
+            make (3, 0xe0, 0, 64),      // valid pitch bend
+            programChange,              // valid two-byte message
+            truncated,
+            overlong,
+        };
+
+        forwarder.pushBlock (block, 7, 0, 44100.0);
+        forwarder.forward (sink, seq, 0);
+
+        const auto stats = forwarder.getStats();
+        DAWINFO_CHECK (stats.malformed == 5 && stats.filtered == 0);
+        DAWINFO_CHECK (sink.events.size() == 2);
+        DAWINFO_CHECK (sink.events.size() == 2 && sink.events[0].status == 0xe0 && sink.events[1].status == 0xc3);
+    }
+
+    void testControllerThinning()
+    {
+        MidiForwarder forwarder;
+        StreamSequencer seq;
+        DecodingSink sink;
+        forwarder.setThinning ({ 10000000, 2 });    // 10 ms, 2 steps
+
+        // One second of a 10 kHz controller stream sweeping a sine, in
+        // 480-sample blocks, plus notes that must pass untouched.
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 480;
+        int sentCc = 0;
+        std::uint8_t lastValue = 0;
+
+        for (int b = 0; b < 100; ++b)
+        {
+            std::vector<BlockMidiEvent> block;
+
+            for (int i = 0; i < 100; ++i)
+            {
+                const double t = (b * 100 + i) / 10000.0;
+                lastValue = static_cast<std::uint8_t> (std::lround (63.5 + 63.5 * std::sin (3.14159265358979 * t)));
+                block.push_back (make (i * 4 + 2, 0xb3, 1, lastValue));
+                ++sentCc;
+            }
+
+            block.push_back (make (0, 0x93, 64, 90));
+
+            const HostTimeNs blockStart = static_cast<HostTimeNs> (b) * 10000000;
+            forwarder.pushBlock (block.data(), static_cast<int> (block.size()), blockStart, sampleRate);
+            forwarder.forward (sink, seq, blockStart + blockSize * 1000000000LL / 48000);
+        }
+
+        // One more call after the interval flushes the held final value.
+        forwarder.forward (sink, seq, 2000000000);
+
+        int ccOut = 0, notesOut = 0;
+        MidiEvent lastCc;
+
+        for (auto& e : sink.events)
+        {
+            if (e.isController()) { ++ccOut; lastCc = e; }
+            else ++notesOut;
+        }
+
+        std::printf ("CC thinning: %d controller events in, %d out (%.1f%%), %d notes untouched\n",
+                     sentCc, ccOut, 100.0 * ccOut / sentCc, notesOut);
+
+        DAWINFO_CHECK (notesOut == 100);
+        DAWINFO_CHECK (ccOut <= 110);           // about one per 10 ms
+        DAWINFO_CHECK (ccOut > 50);
+        // The resting value arrives, to within the delta limit.
+        DAWINFO_CHECK (std::abs (lastCc.data2 - lastValue) < 2);
+    }
+
+    /** A controller that keeps being held and then dropped by the delta limit
+        stays on the held list once, however often it goes round.
+    */
+    void testHeldThenDropped()
+    {
+        MidiForwarder forwarder;
+        StreamSequencer seq;
+        DecodingSink sink;
+        forwarder.setThinning ({ 10000000000, 4 });     // 10 s, 4 steps
+
+        const auto first = make (0, 0xb0, 7, 64);
+        forwarder.pushBlock (&first, 1, 0, 48000.0);
+        forwarder.forward (sink, seq, 0);
+
+        MemoryReport before;
+        forwarder.reportMemory (before);
+
+        // Each block: a jump that is held, a step back that drops it, another
+        // jump that is held again.
+        for (int b = 1; b <= 3000; ++b)
+        {
+            const BlockMidiEvent block[] = { make (0, 0xb0, 7, 100), make (1, 0xb0, 7, 65), make (2, 0xb0, 7, 100) };
+            const HostTimeNs blockStart = static_cast<HostTimeNs> (b) * 1000000;
+            forwarder.pushBlock (block, 3, blockStart, 48000.0);
+            forwarder.forward (sink, seq, blockStart + 1000000);
+        }
+
+        MemoryReport after;
+        forwarder.reportMemory (after);
+        DAWINFO_CHECK (after.get (MemoryReport::state) == before.get (MemoryReport::state));
+
+        // The held value still goes out once, when the interval is up.
+        forwarder.forward (sink, seq, 20000000000);
+        DAWINFO_CHECK (sink.events.size() == 2 && sink.events.back().data2 == 100);
+    }
+
+    /** 10k events/s produced in real time by an audio thread, drained by a sender thread. */
+    void testRealTimeThroughput()
+    {
+        MidiForwarder forwarder (4096);
+        DecodingSink sink;
+        sink.keepEvents = false;
+        sink.measureLatency = true;
+
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 256;
+        constexpr double eventsPerSecond = 10000.0;
+        constexpr double seconds = 1.0;
+        const int numBlocks = static_cast<int> (seconds * sampleRate / blockSize);
+
+        std::atomic<bool> done { false };
+
+        std::thread sender ([&]
+        {
+            StreamSequencer seq;
+
+            while (! done.load())
+            {
+                forwarder.forward (sink, seq, monotonicNowNs());
+                std::this_thread::sleep_for (std::chrono::milliseconds (2));
+            }
+
+            forwarder.forward (sink, seq, monotonicNowNs());
+        });
+
+        std::vector<BlockMidiEvent> block;
+        double owed = 0.0;
+        std::uint64_t pushed = 0;
+        const auto startNs = monotonicNowNs();
+        const auto blockNs = static_cast<HostTimeNs> (blockSize * 1.0e9 / sampleRate);
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            block.clear();
+            owed += eventsPerSecond * blockSize / sampleRate;
+
+            for (; owed >= 1.0; owed -= 1.0)
+            {
+                const auto offset = static_cast<int> (block.size() * blockSize / 60);
+                block.push_back (make (offset, static_cast<std::uint8_t> (0x90 | (block.size() & 15)), 60, 1));
+            }
+
+            const auto blockStart = startNs + b * blockNs;
+            std::this_thread::sleep_until (std::chrono::steady_clock::time_point (std::chrono::nanoseconds (blockStart + blockNs)));
+            forwarder.pushBlock (block.data(), static_cast<int> (block.size()), blockStart, sampleRate);
+            pushed += block.size();
+        }
+
+        done = true;
+        sender.join();
+
+        const auto stats = forwarder.getStats();
+        std::printf ("Real-time 10k events/s: %llu pushed, %llu received, %zu packets, %.1f KB/s, "
+                     "mean latency %.2f ms, max %.2f ms, overflows %llu\n",
+                     static_cast<unsigned long long> (pushed), static_cast<unsigned long long> (sink.count.load()),
+                     sink.packets, sink.bytes / 1024.0 / seconds,
+                     sink.count > 0 ? sink.latencySumNs / 1.0e6 / static_cast<double> (sink.count.load()) : 0.0,
+                     sink.maxLatencyNs / 1.0e6, static_cast<unsigned long long> (stats.ringOverflows));
+
+        DAWINFO_CHECK (pushed >= 9900);
+        DAWINFO_CHECK (sink.count == pushed);
+        DAWINFO_CHECK (stats.ringOverflows == 0);
+    }
+
+    /** How far past 10k/s the pipeline goes when nobody sleeps. */
+    void testSaturatedThroughput()
+    {
+        MidiForwarder forwarder (1 << 16);
+        DecodingSink sink;
+        sink.keepEvents = false;
+
+        constexpr int numBlocks = 4000;
+        constexpr int eventsPerBlock = 250;
+        std::atomic<bool> done { false };
+
+        std::thread sender ([&]
+        {
+            StreamSequencer seq;
+
+            while (! done.load())
+                forwarder.forward (sink, seq, 0);
+
+            forwarder.forward (sink, seq, 0);
+        });
+
+        std::vector<BlockMidiEvent> block;
+        for (int i = 0; i < eventsPerBlock; ++i)
+            block.push_back (make (i, 0x80, static_cast<std::uint8_t> (i & 127), 0));
+
+        const auto start = monotonicNowNs();
+        std::uint64_t pushed = 0;
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            // Back off while the ring is mostly full so overflows measure
+            // genuine loss rather than the producer lapping the consumer.
+            while (pushed - sink.count.load() > (1 << 15))
+                std::this_thread::yield();
+
+            forwarder.pushBlock (block.data(), eventsPerBlock, 0, 48000.0);
+            pushed += eventsPerBlock;
+        }
+
+        done = true;
+        sender.join();
+        const auto seconds = (monotonicNowNs() - start) / 1.0e9;
+
+        std::printf ("Saturated: %llu events in %.3f s = %.0f events/s end to end\n",
+                     static_cast<unsigned long long> (sink.count.load()), seconds, static_cast<double> (sink.count.load()) / seconds);
+
+        DAWINFO_CHECK (sink.count + forwarder.getStats().ringOverflows == pushed);
+        DAWINFO_CHECK (static_cast<double> (sink.count.load()) / seconds > 10000.0 * 10);
+    }
+}
+
+int main()
+{
+    testTimestampsAndBatching();
+    testFiltering();
+    testMalformedInput();
+    testControllerThinning();
+    testHeldThenDropped();
+    testRealTimeThroughput();
+    testSaturatedThroughput();
+    return dawinfo::test::finish ("MidiForwarderTests");
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Common/PacketSink.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace dawinfo::test
+{
+
+/**
+    Delivers packets straight to a receiver-side mirror, optionally dropping
+    some, and counts what went through.
+*/
+template <typename Mirror>
+struct MirrorSink : PacketSink
+{
+    Mirror mirror;
+    std::size_t packets = 0, bytes = 0, largest = 0;
+    int dropNext = 0;
+
+    bool send (const std::uint8_t* data, std::size_t size) override
+    {
+        ++packets;
+        bytes += size;
+        largest = std::max (largest, size);
+
+        if (dropNext > 0)
+        {
+            --dropNext;
+            return true;
+        }
+
+        mirror.handlePacket (data, size);
+        return true;
+    }
+};
+
+} // namespace dawinfo::test
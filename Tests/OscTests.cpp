@@ -0,0 +1,142 @@
+#include "Common/Osc.h"
+#include "TestHarness.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    void testMessageRoundTrip()
+    {
+        std::uint8_t buffer[256];
+        OscWriter w (buffer, sizeof (buffer));
+
+        const std::uint8_t blob[] = { 1, 2, 3, 4, 5 };
+        w.beginMessage ("/test/all", "ifhdsb");
+        w.addInt32 (-7);
+        w.addFloat32 (0.25f);
+        w.addInt64 (1234567890123LL);
+        w.addFloat64 (3.5);
+        w.addString ("hello");
+        w.addBlob (blob, sizeof (blob));
+        w.endMessage();
+
+        DAWINFO_CHECK (! w.hasOverflowed());
+        DAWINFO_CHECK (w.getSize() % 4 == 0);
+        DAWINFO_CHECK (w.getSize() == 12 + 8 + 4 + 4 + 8 + 8 + 8 + 12);
+
+        OscMessage m;
+        DAWINFO_CHECK (parseOscMessage (w.getData(), w.getSize(), m));
+        DAWINFO_CHECK (m.address == "/test/all");
+        DAWINFO_CHECK (m.typeTags == "ifhdsb");
+
+        OscArgumentReader r (m);
+        std::int32_t i = 0; float f = 0; std::int64_t h = 0; double d = 0;
+        std::string_view s; const std::uint8_t* b = nullptr; std::size_t bs = 0;
+
+        DAWINFO_CHECK (r.readInt32 (i) && i == -7);
+        DAWINFO_CHECK (r.readFloat32 (f) && f == 0.25f);
+        DAWINFO_CHECK (r.readInt64 (h) && h == 1234567890123LL);
+        DAWINFO_CHECK (r.readFloat64 (d) && d == 3.5);
+        DAWINFO_CHECK (r.readString (s) && s == "hello");
+        DAWINFO_CHECK (r.readBlob (b, bs) && bs == 5 && std::memcmp (b, blob, 5) == 0);
+        DAWINFO_CHECK (r.isAtEnd() && r.isValid());
+        DAWINFO_CHECK (! r.readInt32 (i));
+    }
+
+    void testTypeMismatchInvalidates()
+    {
+        std::uint8_t buffer[64];
+        OscWriter w (buffer, sizeof (buffer));
+        w.beginMessage ("/x", "f");
+        w.addFloat32 (1.0f);
+        w.endMessage();
+
+        OscMessage m;
+        DAWINFO_CHECK (parseOscMessage (w.getData(), w.getSize(), m));
+        OscArgumentReader r (m);
+        std::int32_t i = 0;
+        float f = 0;
+        DAWINFO_CHECK (! r.readInt32 (i));
+        DAWINFO_CHECK (! r.readFloat32 (f));
+        DAWINFO_CHECK (! r.isValid());
+    }
+
+    void testBundle()
+    {
+        std::uint8_t buffer[256];
+        OscWriter w (buffer, sizeof (buffer));
+        w.beginBundle (99);
+
+        for (int n = 0; n < 3; ++n)
+        {
+            w.beginMessage ("/n", "i");
+            w.addInt32 (n);
+            w.endMessage();
+        }
+
+        DAWINFO_CHECK (isOscBundle (w.getData(), w.getSize()));
+        DAWINFO_CHECK (readBigEndian64 (w.getData() + 8) == 99);
+
+        std::vector<int> seen;
+        DAWINFO_CHECK (forEachOscMessage (w.getData(), w.getSize(), [&] (const OscMessage& m)
+        {
+            OscArgumentReader r (m);
+            std::int32_t v = -1;
+            r.readInt32 (v);
+            seen.push_back (v);
+        }));
+
+        DAWINFO_CHECK (seen == (std::vector<int> { 0, 1, 2 }));
+
+        // A truncated bundle is rejected.
+        DAWINFO_CHECK (! forEachOscMessage (w.getData(), w.getSize() - 4, [] (const OscMessage&) {}));
+    }
+
+    void testOverflowIsSticky()
+    {
+        std::uint8_t buffer[16];
+        OscWriter w (buffer, sizeof (buffer));
+        w.beginMessage ("/a/long/address", "i");
+        DAWINFO_CHECK (w.hasOverflowed());
+        w.addInt32 (1);
+        DAWINFO_CHECK (w.hasOverflowed());
+
+        w.reset();
+        w.beginMessage ("/a", "i");
+        w.addInt32 (1);
+        w.endMessage();
+        DAWINFO_CHECK (! w.hasOverflowed() && w.getSize() == 12);
+    }
+
+    void testMalformedInput()
+    {
+        OscMessage m;
+        const std::uint8_t noSlash[] = { 'a', 0, 0, 0, ',', 0, 0, 0 };
+        const std::uint8_t noTerminator[] = { '/', 'a', 'b', 'c', ',', 'i', 0, 0 };
+        const std::uint8_t noComma[] = { '/', 'a', 0, 0, 'i', 0, 0, 0 };
+
+        DAWINFO_CHECK (! parseOscMessage (noSlash, sizeof (noSlash), m));
+        DAWINFO_CHECK (! parseOscMessage (noTerminator, sizeof (noTerminator), m));
+        DAWINFO_CHECK (! parseOscMessage (noComma, sizeof (noComma), m));
+
+        // Declares an int but carries no data.
+        const std::uint8_t missingArg[] = { '/', 'a', 0, 0, ',', 'i', 0, 0 };
+        DAWINFO_CHECK (parseOscMessage (missingArg, sizeof (missingArg), m));
+        OscArgumentReader r (m);
+        std::int32_t i = 0;
+        DAWINFO_CHECK (! r.readInt32 (i));
+    }
+}
+
+int main()
+{
+    testMessageRoundTrip();
+    testTypeMismatchInvalidates();
+    testBundle();
+    testOverflowIsSticky();
+    testMalformedInput();
+    return dawinfo::test::finish ("OscTests");
+}
@@ -0,0 +1,236 @@
+#include "HeadlessHost.h"
+#include "Common/Clock.h"
+#include "Common/Messages.h"
+#include "Sender/PacedOutput.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    /** Keeps every transport it's sent, with when it was sent. */
+    struct RecordingSink : PacketSink
+    {
+        struct Sent
+        {
+            HostTimeNs sentNs;
+            TransportSnapshot transport;
+        };
+
+        std::mutex lock;
+        std::vector<Sent> sent;
+
+        bool send (const std::uint8_t* data, std::size_t size) override
+        {
+            const auto now = monotonicNowNs();
+
+            forEachOscMessage (data, size, [&] (const OscMessage& m)
+            {
+                TransportSnapshot t;
+
+                if (schema::Codec<messages::Transport>::decode (m, t))
+                {
+                    const std::lock_guard<std::mutex> sl (lock);
+                    sent.push_back ({ now, t });
+                }
+            });
+
+            return true;
+        }
+    };
+
+    TransportSnapshot playingAt (HostTimeNs timeNs, double ppq, double bpm = 120.0)
+    {
+        TransportSnapshot s;
+        s.timeNs = timeNs;
+        s.ppq = ppq;
+        s.bpm = bpm;
+        s.isPlaying = true;
+        s.barStartPpq = std::floor (ppq / 4.0) * 4.0;
+        s.barNumber = static_cast<std::int32_t> (s.barStartPpq / 4.0);
+        return s;
+    }
+
+    constexpr HostTimeNs ms = 1'000'000;
+
+    void testInterpolation()
+    {
+        PacedOutput paced;
+        RecordingSink sink;
+        PacketSink* sinks[] = { &sink };
+        TransportSnapshot s;
+
+        DAWINFO_CHECK (! paced.stateAt (0, s));
+        DAWINFO_CHECK (paced.tick (sinks, 1, 0) == 0 && sink.sent.empty());
+
+        // Blocks 20 ms apart at 120 bpm: 0.04 quarters each. A tempo change
+        // arrives with the third.
+        paced.push (playingAt (1000 * ms, 0.0));
+        paced.push (playingAt (1020 * ms, 0.04));
+        paced.push (playingAt (1040 * ms, 0.08, 150.0));
+
+        // Between two snapshots: interpolated.
+        DAWINFO_CHECK (paced.stateAt (1010 * ms, s));
+        DAWINFO_CHECK_NEAR (s.ppq, 0.02, 1.0e-12);
+        DAWINFO_CHECK (s.timeNs == 1010 * ms && paced.getStats().interpolated == 1);
+
+        // Past the newest: extrapolated along its tempo.
+        DAWINFO_CHECK (paced.stateAt (1060 * ms, s));
+        DAWINFO_CHECK_NEAR (s.ppq, 0.08 + 0.05, 1.0e-12);
+        DAWINFO_CHECK (s.bpm == 150.0 && paced.getStats().extrapolated == 1);
+
+        // Across a bar line the bar fields move on.
+        paced.push (playingAt (1060 * ms, 3.99));
+        DAWINFO_CHECK (paced.stateAt (1080 * ms, s));
+        DAWINFO_CHECK_NEAR (s.ppq, 4.03, 1.0e-12);
+        DAWINFO_CHECK (s.barStartPpq == 4.0 && s.barNumber == 1);
+
+        // A locate between two snapshots isn't smoothed over.
+        paced.push (playingAt (1100 * ms, 32.0));
+        DAWINFO_CHECK (paced.stateAt (1090 * ms, s));
+        DAWINFO_CHECK_NEAR (s.ppq, 3.99 + 0.06, 1.0e-12);
+
+        // The loop end wraps.
+        auto looping = playingAt (1200 * ms, 15.9);
+        looping.isLooping = true;
+        looping.loopStartPpq = 8.0;
+        looping.loopEndPpq = 16.0;
+        paced.push (looping);
+        DAWINFO_CHECK (paced.stateAt (1300 * ms, s));
+        DAWINFO_CHECK_NEAR (s.ppq, 8.1, 1.0e-9);
+        DAWINFO_CHECK (s.barStartPpq == 8.0 && s.barNumber == 2);
+
+        // When blocks stop coming, it holds rather than running away.
+        DAWINFO_CHECK (paced.stateAt (5000 * ms, s));
+        DAWINFO_CHECK_NEAR (s.ppq, 8.0 + 0.4, 1.0e-9);
+
+        // Stopped transport holds still.
+        auto stopped = playingAt (6000 * ms, 20.0);
+        stopped.isPlaying = false;
+        paced.push (stopped);
+        DAWINFO_CHECK (paced.stateAt (6100 * ms, s));
+        DAWINFO_CHECK (s.ppq == 20.0 && ! s.isPlaying);
+
+        // A tick sends the state at now minus the delay.
+        PacedOutput::Options delayed;
+        delayed.delayNs = 20 * ms;
+        PacedOutput late (delayed);
+        late.push (playingAt (1000 * ms, 0.0));
+        late.push (playingAt (1020 * ms, 0.04));
+        DAWINFO_CHECK (late.tick (sinks, 1, 1030 * ms) > 0);
+        DAWINFO_CHECK (sink.sent.size() == 1 && sink.sent[0].transport.timeNs == 1010 * ms);
+        DAWINFO_CHECK_NEAR (sink.sent[0].transport.ppq, 0.02, 1.0e-12);
+        DAWINFO_CHECK (late.getStats().interpolated == 1 && late.getStats().packets == 1);
+    }
+
+    struct Intervals
+    {
+        double packetsPerSecond = 0.0;
+        double meanMs = 0.0, p99JitterMs = 0.0, maxJitterMs = 0.0;
+    };
+
+    /** Spacing of send times, and how far the spacing strays from its mean. */
+    Intervals measure (const std::vector<HostTimeNs>& times)
+    {
+        Intervals r;
+
+        if (times.size() < 3)
+            return r;
+
+        std::vector<double> gaps, jitter;
+
+        for (std::size_t i = 1; i < times.size(); ++i)
+            gaps.push_back (static_cast<double> (times[i] - times[i - 1]) * 1.0e-6);
+
+        const double seconds = static_cast<double> (times.back() - times.front()) * 1.0e-9;
+        r.packetsPerSecond = static_cast<double> (gaps.size()) / seconds;
+        r.meanMs = seconds * 1.0e3 / static_cast<double> (gaps.size());
+
+        for (auto g : gaps)
+            jitter.push_back (std::abs (g - r.meanMs));
+
+        std::sort (jitter.begin(), jitter.end());
+        r.p99JitterMs = jitter[jitter.size() * 99 / 100];
+        r.maxJitterMs = jitter.back();
+        return r;
+    }
+
+    /** A headless host at each block size, its transport sent per block and
+        through a 60 Hz PacedOutput, with the spacing of what went out.
+    */
+    void testJitterAcrossBlockSizes()
+    {
+        constexpr double sampleRate = 48000.0, bpm = 120.0, seconds = 1.0;
+
+        std::printf ("Transport output spacing, %.0f s per block size (jitter = |interval - mean|):\n", seconds);
+        std::printf ("  %6s | %-34s | %-44s\n", "block", "per host block", "paced at 60 Hz");
+        std::printf ("  %6s | %8s %8s %7s %7s | %8s %8s %7s %7s %9s\n", "", "pkt/s", "mean ms", "p99 ms", "max ms",
+                     "pkt/s", "mean ms", "p99 ms", "max ms", "err beats");
+
+        std::vector<double> pacedRates;
+
+        for (int blockSize : { 32, 128, 512, 1024 })
+        {
+            PacedOutput paced;
+            RecordingSink sink;
+            std::vector<HostTimeNs> perBlock;
+            perBlock.reserve (static_cast<std::size_t> (seconds * sampleRate / blockSize) + 16);
+
+            test::HeadlessHost host (sampleRate, blockSize);
+            HostTimeNs origin = 0;
+
+            paced.start ({ &sink });
+
+            host.start ([&] (HostTimeNs blockStart, int block)
+            {
+                if (block == 0)
+                    origin = blockStart;
+
+                paced.push (playingAt (blockStart, static_cast<double> (blockStart - origin) * bpm / 60.0e9));
+                perBlock.push_back (monotonicNowNs());
+            });
+
+            std::this_thread::sleep_for (std::chrono::milliseconds (static_cast<int> (seconds * 1000.0)));
+            host.stop();
+            paced.stop();
+
+            // The paced state is the true position for its own time stamp.
+            std::vector<HostTimeNs> pacedTimes;
+            double maxError = 0.0;
+
+            for (auto& s : sink.sent)
+            {
+                pacedTimes.push_back (s.sentNs);
+                maxError = std::max (maxError, std::abs (s.transport.ppq - static_cast<double> (s.transport.timeNs - origin) * bpm / 60.0e9));
+            }
+
+            const auto a = measure (perBlock), b = measure (pacedTimes);
+            std::printf ("  %6d | %8.1f %8.2f %7.2f %7.2f | %8.1f %8.2f %7.2f %7.2f %9.1e\n", blockSize,
+                         a.packetsPerSecond, a.meanMs, a.p99JitterMs, a.maxJitterMs,
+                         b.packetsPerSecond, b.meanMs, b.p99JitterMs, b.maxJitterMs, maxError);
+
+            const auto stats = paced.getStats();
+            DAWINFO_CHECK (stats.snapshotsDropped == 0 && stats.packets == sink.sent.size());
+            DAWINFO_CHECK (maxError < 1.0e-6);
+            DAWINFO_CHECK_NEAR (b.meanMs, 1000.0 / 60.0, 1.0);
+            pacedRates.push_back (b.packetsPerSecond);
+        }
+
+        // The paced rate is the same whatever the host's buffer size.
+        const auto [lowest, highest] = std::minmax_element (pacedRates.begin(), pacedRates.end());
+        DAWINFO_CHECK (*highest - *lowest < 6.0);
+    }
+}
+
+int main()
+{
+    testInterpolation();
+    testJitterAcrossBlockSizes();
+    return dawinfo::test::finish ("PacedOutputTests");
+}
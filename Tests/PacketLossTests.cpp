@@ -0,0 +1,255 @@
+#include "Common/SequenceWindow.h"
+#include "Receiver/LinkMonitor.h"
+#include "Sender/EventRedundancy.h"
+#include "Sender/StreamSequencer.h"
+#include "LossyLink.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    void testSequenceWindow()
+    {
+        using W = SequenceWindow<64>;
+        W w;
+        std::uint32_t skipped = 0;
+
+        DAWINFO_CHECK (w.accept (10) == W::Result::first);
+        DAWINFO_CHECK (w.accept (11) == W::Result::inOrder);
+        DAWINFO_CHECK (w.accept (15, &skipped) == W::Result::gap && skipped == 3);
+        DAWINFO_CHECK (w.accept (13) == W::Result::late);
+        DAWINFO_CHECK (w.accept (13) == W::Result::duplicate);
+        DAWINFO_CHECK (w.accept (15) == W::Result::duplicate);
+        DAWINFO_CHECK (w.accept (200, &skipped) == W::Result::gap && skipped == 184);
+        DAWINFO_CHECK (w.accept (100) == W::Result::tooOld);
+        DAWINFO_CHECK (w.accept (199) == W::Result::late);
+
+        // Wraps through zero without a resync.
+        W wrapping;
+        wrapping.accept (0xfffffffeu);
+        DAWINFO_CHECK (wrapping.accept (0xffffffffu) == W::Result::inOrder);
+        DAWINFO_CHECK (wrapping.accept (1u, &skipped) == W::Result::gap && skipped == 1);
+        DAWINFO_CHECK (wrapping.accept (0u) == W::Result::late);
+
+        // A sender restart far behind the window resynchronises.
+        DAWINFO_CHECK (w.accept (1000000) == W::Result::first);
+        DAWINFO_CHECK (w.accept (0) == W::Result::first);
+
+        // Multi-word windows shift bits across word boundaries.
+        SequenceWindow<256> wide;
+        wide.accept (0);
+        wide.accept (100);
+        DAWINFO_CHECK (wide.accept (0) == SequenceWindow<256>::Result::duplicate);
+        wide.accept (170);
+        DAWINFO_CHECK (wide.accept (0) == SequenceWindow<256>::Result::duplicate);
+        DAWINFO_CHECK (wide.accept (100) == SequenceWindow<256>::Result::duplicate);
+        DAWINFO_CHECK (wide.accept (1) == SequenceWindow<256>::Result::late);
+    }
+
+    struct RunResult
+    {
+        std::uint64_t eventsPushed = 0, eventsDelivered = 0, duplicatesDelivered = 0;
+        std::uint64_t bytesSent = 0;
+        EventRedundancy::Stats redundancy;
+        LinkStats link;
+        std::uint64_t dropped = 0, reordered = 0, sent = 0;
+    };
+
+    RunResult runLossyLink (int redundancy, double drop, double reorder)
+    {
+        constexpr int numPackets = 20000;
+
+        StreamSequencer sequencer;
+        EventRedundancy events (redundancy);
+        LinkMonitor monitor;
+        EventDeduplicator dedup;
+        test::LossyLink link (drop, reorder);
+
+        std::set<std::uint32_t> delivered;
+        RunResult result;
+        std::mt19937 rng (7);
+        std::uniform_real_distribution<double> unit (0.0, 1.0);
+
+        std::uint8_t buffer[1500];
+        OscWriter writer (buffer, sizeof (buffer));
+
+        auto receive = [&] (const test::LossyLink::Packet& p)
+        {
+            DAWINFO_CHECK (monitor.observePacket (p.data(), p.size()));
+
+            forEachOscMessage (p.data(), p.size(), [&] (const OscMessage& m)
+            {
+                DiscreteEvent e;
+
+                if (decodeEvent (m, e) && dedup.accept (e.id))
+                {
+                    ++result.eventsDelivered;
+                    if (! delivered.insert (e.id).second)
+                        ++result.duplicatesDelivered;
+                }
+            });
+        };
+
+        for (int i = 0; i < numPackets; ++i)
+        {
+            const HostTimeNs now = static_cast<HostTimeNs> (i) * 10000000;
+
+            // A beat every 50 packets and sparse onsets in between.
+            if (i % 50 == 0)
+                events.push (i % 200 == 0 ? EventType::downbeat : EventType::beat, now);
+
+            if (unit (rng) < 0.05)
+                events.push (EventType::onset, now, static_cast<float> (unit (rng)));
+
+            sequencer.beginPacket (writer, StreamId::events);
+            events.writePending (writer);
+            DAWINFO_CHECK (! writer.hasOverflowed());
+
+            result.bytesSent += writer.getSize();
+
+            for (auto& p : link.send (writer.getData(), writer.getSize()))
+                receive (p);
+        }
+
+        for (auto& p : link.flush())
+            receive (p);
+
+        result.eventsPushed = events.getStats().eventsPushed;
+        result.redundancy = events.getStats();
+        result.link = monitor.getStats (StreamId::events);
+        result.dropped = link.dropped;
+        result.reordered = link.reordered;
+        result.sent = link.sent;
+        return result;
+    }
+
+    void testLossyLink()
+    {
+        constexpr double drop = 0.10, reorder = 0.05;
+
+        std::printf ("Lossy link: %.0f%% drop, %.0f%% reorder, 20000 packets\n", drop * 100, reorder * 100);
+        std::printf ("  redundancy  delivered   missed  bytes sent  event overhead\n");
+
+        RunResult results[4];
+
+        for (int r = 0; r < 4; ++r)
+        {
+            auto& res = results[r];
+            res = runLossyLink (r, drop, reorder);
+
+            std::printf ("  %10d  %5llu/%-5llu  %5.2f%%  %10llu  %13.0f%%\n", r,
+                         static_cast<unsigned long long> (res.eventsDelivered),
+                         static_cast<unsigned long long> (res.eventsPushed),
+                         100.0 * static_cast<double> (res.eventsPushed - res.eventsDelivered) / static_cast<double> (res.eventsPushed),
+                         static_cast<unsigned long long> (res.bytesSent),
+                         100.0 * res.redundancy.overheadRatio());
+
+            // Gap counters agree with what the link actually dropped once the
+            // reordered packets have all come in.
+            DAWINFO_CHECK (res.link.lost == res.dropped);
+            DAWINFO_CHECK (res.link.received == res.sent - res.dropped);
+            DAWINFO_CHECK (res.link.late > 0);
+            DAWINFO_CHECK (res.link.duplicates == 0);
+            DAWINFO_CHECK (res.duplicatesDelivered == 0);
+            DAWINFO_CHECK (res.redundancy.evicted == 0);
+
+            // Each event is repeated exactly r times.
+            DAWINFO_CHECK (res.redundancy.repeatSends == res.redundancy.firstSends * static_cast<std::uint64_t> (r));
+            DAWINFO_CHECK_NEAR (res.redundancy.overheadRatio(), static_cast<double> (r), 1.0e-9);
+        }
+
+        const auto missed = [] (const RunResult& r)
+        {
+            return static_cast<double> (r.eventsPushed - r.eventsDelivered) / static_cast<double> (r.eventsPushed);
+        };
+
+        DAWINFO_CHECK (missed (results[0]) > 0.05);
+        DAWINFO_CHECK (missed (results[2]) < 0.005);
+        DAWINFO_CHECK (missed (results[3]) < missed (results[1]));
+    }
+
+    void testEvictionWhenFlooded()
+    {
+        EventRedundancy events (1);
+
+        for (std::size_t i = 0; i < EventRedundancy::capacity + 10; ++i)
+            events.push (EventType::onset, 0);
+
+        DAWINFO_CHECK (events.getStats().evicted == 10);
+
+        std::uint8_t buffer[65536];
+        OscWriter writer (buffer, sizeof (buffer));
+        writer.beginBundle();
+        DAWINFO_CHECK (events.writePending (writer) == static_cast<int> (EventRedundancy::capacity));
+        DAWINFO_CHECK (events.hasPending());
+        writer.beginBundle();
+        events.writePending (writer);
+        DAWINFO_CHECK (! events.hasPending());
+    }
+
+    void testOverflowKeepsEventsPending()
+    {
+        // Four frames of 16 events, more than one small packet holds.
+        constexpr int redundancy = 2;
+        EventRedundancy events (redundancy);
+        std::vector<int> copies;
+        std::uint8_t buffer[400];
+        OscWriter writer (buffer, sizeof (buffer));
+        int numPackets = 0;
+
+        auto send = [&]
+        {
+            writer.beginBundle();
+            events.writePending (writer);
+            DAWINFO_CHECK (! writer.hasOverflowed());
+            ++numPackets;
+
+            forEachOscMessage (writer.getData(), writer.getSize(), [&] (const OscMessage& m)
+            {
+                DiscreteEvent e;
+
+                if (decodeEvent (m, e) && e.id < copies.size())
+                    ++copies[e.id];
+            });
+        };
+
+        for (int frame = 0; frame < 4; ++frame)
+        {
+            for (int e = 0; e < 16; ++e)
+            {
+                events.push (EventType::onset, 0);
+                copies.push_back (0);
+            }
+
+            send();
+            DAWINFO_CHECK (events.hasMoreToWrite());
+
+            while (events.hasMoreToWrite())
+                send();
+        }
+
+        while (events.hasPending() && numPackets < 100)
+            send();
+
+        const auto& stats = events.getStats();
+        DAWINFO_CHECK (! events.hasPending());
+        DAWINFO_CHECK (std::all_of (copies.begin(), copies.end(), [] (int n) { return n == 1 + redundancy; }));
+        DAWINFO_CHECK (stats.firstSends == 64 && stats.repeatSends == 64 * redundancy);
+    }
+}
+
+int main()
+{
+    testSequenceWindow();
+    testLossyLink();
+    testEvictionWhenFlooded();
+    testOverflowKeepsEventsPending();
+    return dawinfo::test::finish ("PacketLossTests");
+}
@@ -0,0 +1,242 @@
+#include "AllocationCounter.h"
+#include "Common/Messages.h"
+#include "Receiver/ParameterMirror.h"
+#include "Sender/ParameterObserver.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    struct MirrorSink : PacketSink
+    {
+        ParameterMirror mirror { 4096 };
+        std::size_t packets = 0, bytes = 0, segments = 0;
+        HostTimeNs lfoEndNs = 0;
+
+        bool send (const std::uint8_t* data, std::size_t size) override
+        {
+            ++packets;
+            bytes += size;
+
+            forEachOscMessage (data, size, [&] (const OscMessage& m)
+            {
+                ParameterSegment s;
+
+                if (schema::Codec<messages::Parameter>::decode (m, s))
+                {
+                    mirror.addSegment (s);
+                    ++segments;
+
+                    if (s.paramId == 1)
+                        lfoEndNs = std::max (lfoEndNs, s.getEndNs());
+                }
+            });
+
+            return true;
+        }
+    };
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr double seconds = 10.0;
+    const int numBlocks = static_cast<int> (seconds * sampleRate / blockSize);
+
+    HostTimeNs blockTime (int b)
+    {
+        return static_cast<HostTimeNs> (std::llround (b * blockSize * 1.0e9 / sampleRate));
+    }
+
+    /** Automation lanes of the kinds hosts record, sampled once per block. */
+    struct Lane
+    {
+        const char* name;
+        std::vector<float> values;
+    };
+
+    std::vector<Lane> makeLanes()
+    {
+        std::vector<Lane> lanes { { "ramps", {} }, { "lfo", {} }, { "steps", {} },
+                                  { "drawn", {} }, { "constant", {} } };
+        std::mt19937 rng (7);
+        std::uniform_real_distribution<float> uniform (0.0f, 1.0f);
+        float step = 0.5f, target = 0.5f, drawn = 0.5f;
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            const double t = b * blockSize / sampleRate;
+
+            // Up over 2 s, down over 2 s.
+            const double phase = std::fmod (t, 4.0);
+            lanes[0].values.push_back (static_cast<float> (phase < 2.0 ? phase / 2.0 : 2.0 - phase / 2.0));
+
+            lanes[1].values.push_back (static_cast<float> (0.5 + 0.4 * std::sin (2.0 * 3.14159265358979 * 0.5 * t)));
+
+            if (b % 94 == 0)
+                step = std::round (uniform (rng) * 8.0f) / 8.0f;
+
+            lanes[2].values.push_back (step);
+
+            // A hand-drawn move: wandering target, smoothed.
+            if (b % 20 == 0)
+                target = uniform (rng);
+
+            drawn += 0.08f * (target - drawn);
+            lanes[3].values.push_back (drawn);
+
+            lanes[4].values.push_back (0.7f);
+        }
+
+        return lanes;
+    }
+
+    void testHoldThenStep()
+    {
+        ParameterObserver observer (2);
+        StreamSequencer seq;
+        MirrorSink sink;
+
+        // Held at 0.25 for a second, then jumps to 0.75.
+        for (int b = 0; b < 100; ++b)
+        {
+            observer.observe (0, b < 94 ? 0.25f : 0.75f, blockTime (b));
+            observer.observe (5, 1.0f, blockTime (b));     // out of range: ignored
+            observer.publish (sink, seq, blockTime (b));
+        }
+
+        observer.publish (sink, seq, blockTime (200));
+
+        // Only the first value, the last held one and the new one are queued.
+        DAWINFO_CHECK (observer.getStats().points == 3);
+        DAWINFO_CHECK (sink.mirror.valueAt (0, blockTime (50)) == 0.25f);
+        DAWINFO_CHECK (sink.mirror.valueAt (0, blockTime (93)) == 0.25f);
+        DAWINFO_CHECK (sink.mirror.valueAt (0, blockTime (94)) == 0.75f);
+        DAWINFO_CHECK (sink.mirror.latestValue (0) == 0.75f);
+        DAWINFO_CHECK (! sink.mirror.hasParameter (1));
+        DAWINFO_CHECK (seq.peek (StreamId::parameters) == sink.packets);
+    }
+
+    void testLoneValueIsFlushed()
+    {
+        ParameterObserver observer (1);
+        StreamSequencer seq;
+        MirrorSink sink;
+
+        observer.observe (0, 0.4f, 1000);
+        observer.publish (sink, seq, 1000);
+        DAWINFO_CHECK (sink.segments == 0);
+
+        observer.publish (sink, seq, 1000 + ParameterObserver::Options().idleFlushNs);
+        DAWINFO_CHECK (sink.segments == 1);
+        DAWINFO_CHECK (sink.mirror.valueAt (0, 0) == 0.4f);
+        DAWINFO_CHECK (sink.mirror.valueAt (0, 5000000000) == 0.4f);
+    }
+
+    /** Points that arrive out of order after an overflow are dropped, and
+        must not list their lane again each time.
+    */
+    void testOutOfOrderPointsListLaneOnce()
+    {
+        ParameterObserver observer (1);
+        StreamSequencer seq;
+        MirrorSink sink;
+        const auto idleNs = ParameterObserver::Options().idleFlushNs;
+
+        observer.observe (0, 0.1f, 1000000);
+        observer.publish (sink, seq, 1000000);
+        observer.publish (sink, seq, 1000000 + idleNs);
+        DAWINFO_CHECK (sink.segments == 1);
+
+        for (int i = 1; i <= 10; ++i)
+            observer.observe (0, 0.1f + 0.05f * static_cast<float> (i), 1000000 - i * 1000);
+
+        {
+            test::ScopedAllocationCount counting;
+            const auto allocations = test::allocationCount();
+            observer.publish (sink, seq, 1000000 + idleNs);
+            DAWINFO_CHECK (test::allocationCount() == allocations);
+        }
+
+        // The lane still works once points are in order again.
+        observer.observe (0, 0.9f, 2000000 + idleNs);
+        observer.publish (sink, seq, 2000000 + 3 * idleNs);
+        DAWINFO_CHECK (sink.mirror.latestValue (0) == 0.9f);
+    }
+
+    /** Reconstruction error against message count for recorded lanes. */
+    void testReconstruction()
+    {
+        const auto lanes = makeLanes();
+        const auto numLanes = static_cast<int> (lanes.size());
+        const std::size_t perBlockMessages = lanes.size() * static_cast<std::size_t> (numBlocks);
+
+        for (const float tolerance : { 0.0005f, 0.002f, 0.01f })
+        {
+            ParameterObserver observer (numLanes);
+            StreamSequencer seq;
+            MirrorSink sink;
+
+            ParameterObserver::Options options;
+            options.tolerance = tolerance;
+            observer.setOptions (options);
+
+            HostTimeNs worstLagNs = 0;
+
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                const auto t = blockTime (b);
+
+                for (int l = 0; l < numLanes; ++l)
+                    observer.observe (l, lanes[static_cast<std::size_t> (l)].values[static_cast<std::size_t> (b)], t);
+
+                observer.publish (sink, seq, t);
+
+                // How far behind the always-moving LFO the receiver runs.
+                if (sink.mirror.hasParameter (1))
+                    worstLagNs = std::max (worstLagNs, t - sink.lfoEndNs);
+            }
+
+            observer.publish (sink, seq, blockTime (numBlocks) + options.idleFlushNs);
+
+            std::printf ("tolerance %.4f: %zu segments (%zu packets, %zu bytes) vs %zu per-block values, "
+                         "worst receiver lag %.1f ms\n",
+                         tolerance, sink.segments, sink.packets, sink.bytes, perBlockMessages, worstLagNs / 1.0e6);
+
+            for (int l = 0; l < numLanes; ++l)
+            {
+                const auto& lane = lanes[static_cast<std::size_t> (l)];
+                double maxError = 0.0, sumSquares = 0.0;
+
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    const double error = std::abs (sink.mirror.valueAt (l, blockTime (b)) - lane.values[static_cast<std::size_t> (b)]);
+                    maxError = std::max (maxError, error);
+                    sumSquares += error * error;
+                }
+
+                std::printf ("    %-9s max error %.5f, rms %.5f\n", lane.name, maxError, std::sqrt (sumSquares / numBlocks));
+                DAWINFO_CHECK (maxError <= tolerance + 1.0e-5);
+            }
+
+            DAWINFO_CHECK (observer.getStats().ringOverflows == 0);
+            DAWINFO_CHECK (observer.getStats().segments == sink.segments);
+            DAWINFO_CHECK (worstLagNs <= options.maxSegmentNs + 2 * blockTime (1));
+            DAWINFO_CHECK (sink.segments * 4 < perBlockMessages);
+        }
+    }
+}
+
+int main()
+{
+    testHoldThenStep();
+    testLoneValueIsFlushed();
+    testOutOfOrderPointsListLaneOnce();
+    testReconstruction();
+    return dawinfo::test::finish ("ParameterStreamTests");
+}
@@ -0,0 +1,286 @@
+#include "Common/Clock.h"
+#include "Common/UdpSocket.h"
+#include "Sender/QualityGovernor.h"
+#include "TestHarness.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    constexpr HostTimeNs ms = 1000000;
+
+    QualityGovernor::Options fastOptions()
+    {
+        QualityGovernor::Options o;
+        o.windowNs = 100 * ms;
+        o.recoverWindows = 4;
+        return o;
+    }
+
+    /** Runs one window with every block at the given load. */
+    bool window (QualityGovernor& g, HostTimeNs& now, double load)
+    {
+        for (int i = 0; i < 10; ++i)
+            g.reportBlock (static_cast<HostTimeNs> (load * 1000.0), 1000);
+
+        now += 100 * ms;
+        return g.update (now);
+    }
+
+    void testShape()
+    {
+        SenderConfig full;
+        full.features = feature::all;
+        full.transportRateHz = 120.0;
+        full.levelsRateHz = 60.0;
+        full.eventRedundancy = 3;
+        full.waveformLiveLevel = 2;
+
+        const auto same = QualityGovernor::shape (full, 0);
+        DAWINFO_CHECK (same.features == full.features && same.levelsRateHz == 60.0 && same.waveformLiveLevel == 2);
+
+        const auto one = QualityGovernor::shape (full, 1);
+        DAWINFO_CHECK (one.features == full.features && one.levelsRateHz == 30.0 && one.spectrumRateHz == 15.0);
+
+        const auto two = QualityGovernor::shape (full, 2);
+        DAWINFO_CHECK (! two.isEnabled (feature::spectrum) && ! two.isEnabled (feature::waveform));
+        DAWINFO_CHECK (! two.isEnabled (feature::audioTap) && two.isEnabled (feature::midi));
+        DAWINFO_CHECK (two.transportRateHz == 30.0 && two.waveformLiveLevel == -1);
+
+        const auto three = QualityGovernor::shape (full, 3);
+        DAWINFO_CHECK (three.levelsRateHz == 10.0 && three.eventRedundancy == 1 && three.midiMinIntervalMs >= 10.0);
+
+        const auto four = QualityGovernor::shape (full, 4);
+        DAWINFO_CHECK (four.features == (feature::transport | feature::events) && four.transportRateHz == 15.0);
+
+        // Every level is still a config the manager accepts.
+        std::string error;
+
+        for (int level = 0; level <= QualityGovernor::maxLevel; ++level)
+            DAWINFO_CHECK (config::validate (QualityGovernor::shape (full, level), error));
+    }
+
+    void testHysteresis()
+    {
+        QualityGovernor g (fastOptions());
+        HostTimeNs now = 0;
+        g.update (now);
+
+        // Quiet: stays at full quality.
+        for (int i = 0; i < 5; ++i)
+            DAWINFO_CHECK (! window (g, now, 0.2));
+
+        // Overloaded: one step per judged window; the window after a change is skipped.
+        DAWINFO_CHECK (window (g, now, 0.9) && g.getLevel() == 1);
+        DAWINFO_CHECK (! window (g, now, 0.9) && g.getLevel() == 1);
+        DAWINFO_CHECK (window (g, now, 0.9) && g.getLevel() == 2);
+        DAWINFO_CHECK (g.getStats().lastPressure == QualityGovernor::cpu);
+
+        // Between the marks: holds however long it lasts.
+        for (int i = 0; i < 20; ++i)
+            DAWINFO_CHECK (! window (g, now, 0.6));
+
+        DAWINFO_CHECK (g.getLevel() == 2);
+
+        // Calm: recovers only after recoverWindows calm windows in a row...
+        for (int i = 0; i < 3; ++i)
+            DAWINFO_CHECK (! window (g, now, 0.2));
+
+        // ...and a single busy window starts the count again.
+        DAWINFO_CHECK (! window (g, now, 0.6));
+
+        for (int i = 0; i < 3; ++i)
+            DAWINFO_CHECK (! window (g, now, 0.2));
+
+        DAWINFO_CHECK (window (g, now, 0.2) && g.getLevel() == 1);
+
+        // Never past the ends.
+        for (int i = 0; i < 40; ++i)
+            window (g, now, 0.2);
+
+        DAWINFO_CHECK (g.getLevel() == 0);
+
+        for (int i = 0; i < 40; ++i)
+            window (g, now, 1.5);
+
+        DAWINFO_CHECK (g.getLevel() == QualityGovernor::maxLevel);
+
+        const auto stats = g.getStats();
+        DAWINFO_CHECK (stats.stepsDown == 2 + QualityGovernor::maxLevel && stats.stepsUp == 2);
+    }
+
+    void testBacklogAndNetwork()
+    {
+        QualityGovernor g (fastOptions());
+        HostTimeNs now = 0;
+        g.update (now);
+
+        // Analysis queue filling up.
+        g.reportBacklog (700, 1024);
+        now += 100 * ms;
+        DAWINFO_CHECK (g.update (now) && g.getLevel() == 1);
+        DAWINFO_CHECK (g.getStats().lastPressure == QualityGovernor::backlog);
+
+        now += 100 * ms;
+        g.update (now);
+
+        // Sends failing on a saturated link.
+        g.reportSends (1000, 50);
+        now += 100 * ms;
+        DAWINFO_CHECK (g.update (now) && g.getLevel() == 2);
+        DAWINFO_CHECK (g.getStats().lastPressure == QualityGovernor::network);
+        DAWINFO_CHECK_NEAR (g.getStats().lastSendFailureRate, 0.05, 1e-9);
+
+        // A stray failure isn't pressure, but it isn't calm either.
+        for (int i = 0; i < 10; ++i)
+        {
+            g.reportSends (1000, 1);
+            now += 100 * ms;
+            DAWINFO_CHECK (! g.update (now));
+        }
+
+        DAWINFO_CHECK (g.getLevel() == 2);
+    }
+
+   #if DAWINFO_NETWORK_TESTS
+    /** A burst into a tiny send queue: the sends fail at once as congested
+        rather than blocking, and that is enough to step the governor down.
+        Loopback never queues, so this sends off the host, to a documentation
+        address nobody answers; without a route there is nothing to measure.
+        Only built with -DDAWINFO_NETWORK_TESTS=ON, since it puts real
+        traffic on the network.
+    */
+    void testCongestedSocket()
+    {
+        UdpSocket socket;
+        DAWINFO_CHECK (socket.open() && socket.setSendBufferSize (1));
+
+        Endpoint unreachable;
+        DAWINFO_CHECK (resolveEndpoint ("198.51.100.1", 9, unreachable));
+
+        constexpr int attempts = 2000;
+        const std::vector<std::uint8_t> packet (1400);
+        int failures = 0;
+        const auto start = monotonicNowNs();
+
+        for (int i = 0; i < attempts; ++i)
+            failures += socket.sendTo (unreachable, packet.data(), packet.size()) ? 0 : 1;
+
+        const auto elapsedMs = static_cast<double> (monotonicNowNs() - start) / 1.0e6;
+
+        if (failures == attempts && socket.getCongestedSends() == 0)
+        {
+            std::printf ("Congested socket: no route off this host, skipped\n");
+            return;
+        }
+
+        std::printf ("Congested socket: %d of %d sends failed, %llu congested, in %.1f ms\n", failures, attempts,
+                     static_cast<unsigned long long> (socket.getCongestedSends()), elapsedMs);
+
+        DAWINFO_CHECK (socket.getCongestedSends() > 0 && socket.getCongestedSends() == socket.getSendFailures());
+
+        QualityGovernor g (fastOptions());
+        HostTimeNs now = 0;
+        g.update (now);
+        g.reportSends (attempts, socket.getSendFailures());
+        now += 100 * ms;
+        DAWINFO_CHECK (g.update (now) && g.getStats().lastPressure == QualityGovernor::network);
+    }
+   #endif
+
+    /** A simulated host whose blocks cost a share of the block that depends
+        on the quality level, as features and rates would, scaled by a load
+        that changes over the run, with now and then one block held up by
+        the scheduler. The governor should step down until the margin is
+        back, hold there, and recover once the load goes away.
+
+        Time is simulated, so the run is the same on a busy machine.
+    */
+    void testUnderSyntheticLoad()
+    {
+        constexpr double costAtLevel[] = { 1.0, 0.8, 0.45, 0.35, 0.3 };
+        constexpr HostTimeNs blockNs = 128 * 1000000000LL / 48000;
+        constexpr HostTimeNs updateNs = 10 * ms;
+
+        // Long enough windows that a stray slow block or two is well under
+        // the loaded share.
+        auto options = fastOptions();
+        options.windowNs = 200 * ms;
+
+        QualityGovernor governor (options);
+        std::vector<std::pair<HostTimeNs, int>> changes;
+        HostTimeNs now = 0, nextUpdate = 0;
+        int blocks = 0, overBudgetAtLevel0 = 0;
+
+        auto phase = [&] (double load, HostTimeNs duration) -> int
+        {
+            for (const auto end = now + duration; now < end; now += blockNs)
+            {
+                const int level = governor.getLevel();
+                const double stall = ++blocks % 97 == 0 ? 2.0 : 1.0;
+                const auto callbackNs = static_cast<HostTimeNs> (stall * load * costAtLevel[level] * static_cast<double> (blockNs));
+                governor.reportBlock (callbackNs, blockNs);
+
+                if (callbackNs > blockNs && level == 0)
+                    ++overBudgetAtLevel0;
+
+                if (now >= nextUpdate)
+                {
+                    if (governor.update (now))
+                        changes.push_back ({ now, governor.getLevel() });
+
+                    nextUpdate += updateNs;
+                }
+            }
+
+            return governor.getLevel();
+        };
+
+        const int quietLevel = phase (0.3, 600 * ms);
+        const auto changesBeforeLoad = changes.size();
+        const int loadedLevel = phase (1.1, 1500 * ms);
+        const auto changesWhileLoaded = changes.size() - changesBeforeLoad;
+        const int heldLevel = phase (1.1, 1000 * ms);
+        const auto changesWhileHolding = changes.size() - changesBeforeLoad - changesWhileLoaded;
+        const int recoveredLevel = phase (0.3, 4000 * ms);
+
+        std::printf ("Governor under synthetic load (%d blocks):", blocks);
+
+        for (const auto& c : changes)
+            std::printf (" %.2fs->%d", c.first / 1.0e9, c.second);
+
+        std::printf ("\n");
+
+        // Quiet start: untouched.
+        DAWINFO_CHECK (quietLevel == 0 && changesBeforeLoad == 0);
+
+        // Overload: steps down to the first level with margin (0.45 * 1.1 = 0.5 of
+        // the block, between the marks) and no further.
+        DAWINFO_CHECK (loadedLevel == 2 && changesWhileLoaded == 2);
+
+        // Holds without hunting.
+        DAWINFO_CHECK (heldLevel == 2 && changesWhileHolding == 0);
+
+        // Load gone: back to full quality, one step at a time.
+        DAWINFO_CHECK (recoveredLevel == 0 && changes.size() == 4);
+        DAWINFO_CHECK (governor.getStats().stepsDown == 2 && governor.getStats().stepsUp == 2);
+
+        // Only the blocks before the first step down missed the deadline.
+        DAWINFO_CHECK (overBudgetAtLevel0 > 0 && overBudgetAtLevel0 < 300);
+    }
+}
+
+int main()
+{
+    testShape();
+    testHysteresis();
+    testBacklogAndNetwork();
+   #if DAWINFO_NETWORK_TESTS
+    testCongestedSocket();
+   #endif
+    testUnderSyntheticLoad();
+    return dawinfo::test::finish ("QualityGovernorTests");
+}
@@ -0,0 +1,664 @@
+#include "Common/Config.h"
+#include "Common/History.h"
+#include "Common/Messages.h"
+#include "Common/Metadata.h"
+#include "Common/Peaks.h"
+#include "Common/WebSocket.h"
+#include "TestHarness.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace dawinfo;
+
+/*  Property tests: for every encoder and decoder pair, random values go out
+    and come back the same. Each property runs over many cases, each seeded
+    from its case number, so a failure names a case that can be rerun. The
+    fuzz targets in Fuzz/ cover the other direction, from bytes.
+*/
+namespace
+{
+    constexpr int numCases = 1000;
+
+    /** Runs property (std::mt19937&) -> bool over numCases cases. */
+    template <typename Property>
+    void forAll (const char* name, Property&& property)
+    {
+        int failures = 0, firstFailure = -1;
+
+        for (int i = 0; i < numCases; ++i)
+        {
+            std::mt19937 random (static_cast<std::uint32_t> (i) * 2654435761u + 1);
+
+            if (! property (random) && failures++ == 0)
+                firstFailure = i;
+        }
+
+        if (failures == 0)
+            std::printf ("%-24s %5d cases  ok\n", name, numCases);
+        else
+            std::printf ("%-24s %5d cases  %d failed, the first case %d\n", name, numCases, failures, firstFailure);
+
+        DAWINFO_CHECK (failures == 0);
+    }
+
+    template <typename T>
+    bool sameBits (T a, T b)
+    {
+        return std::memcmp (&a, &b, sizeof (T)) == 0;
+    }
+
+    int uniform (std::mt19937& random, int lo, int hi)
+    {
+        return std::uniform_int_distribution<int> (lo, hi) (random);
+    }
+
+    std::int64_t random64 (std::mt19937& random)
+    {
+        return static_cast<std::int64_t> ((static_cast<std::uint64_t> (random()) << 32) | random());
+    }
+
+    /** Any value of a wire type, leaning towards the small numbers enums,
+        flags and counts take, and with every float bit pattern possible.
+    */
+    template <typename T>
+    T randomWire (std::mt19937& random)
+    {
+        const auto choice = random() % 4;
+
+        if constexpr (std::is_integral_v<T>)
+        {
+            if (choice == 0)        return static_cast<T> (random() % 8);
+            if (choice == 1)        return static_cast<T> (random() % 256);     // MIDI bytes, status and data
+            if (choice == 2)        return static_cast<T> (uniform (random, -200, 200));
+            return static_cast<T> (random64 (random));
+        }
+        else
+        {
+            if (choice == 0)        return static_cast<T> (random() % 256);
+            if (choice == 1)        return static_cast<T> (std::uniform_real_distribution<double> (-1.0, 1.0) (random));
+            if (choice == 2)        return static_cast<T> (std::uniform_real_distribution<double> (-1.0e6, 1.0e6) (random));
+
+            const auto bits = random64 (random);
+            T v;
+            std::memcpy (&v, &bits, sizeof (v));
+            return v;
+        }
+    }
+
+    std::string randomName (std::mt19937& random, int maxLength)
+    {
+        std::string s (static_cast<std::size_t> (uniform (random, 0, maxLength)), ' ');
+
+        for (auto& c : s)
+            c = static_cast<char> (uniform (random, 1, 255));     // anything but the terminator
+
+        return s;
+    }
+
+    //==============================================================================
+    /** Every argument type, alone and in nested bundles. */
+    void testOscArguments()
+    {
+        struct Argument
+        {
+            char tag;
+            std::int64_t i = 0;
+            double d = 0;
+            std::string bytes;
+        };
+
+        forAll ("osc arguments", [] (std::mt19937& random)
+        {
+            std::vector<std::vector<Argument>> messages (static_cast<std::size_t> (uniform (random, 1, 4)));
+            std::vector<std::string> addresses;
+            std::vector<std::uint8_t> buffer (8192);
+            OscWriter w (buffer.data(), buffer.size());
+            const bool bundled = messages.size() > 1 || random() % 2 == 0;
+
+            if (bundled)
+                w.beginBundle (random64 (random));
+
+            for (auto& args : messages)
+            {
+                addresses.push_back ("/" + randomName (random, 20));
+                args.resize (static_cast<std::size_t> (uniform (random, 0, 8)));
+                std::string tags;
+
+                for (auto& a : args)
+                {
+                    a.tag = "ifhdsb"[random() % 6];
+                    tags += a.tag;
+                    a.i = randomWire<std::int64_t> (random);
+                    a.d = randomWire<double> (random);
+                    a.bytes = randomName (random, 40);
+
+                    if (a.tag == 'i')   a.i = static_cast<std::int32_t> (a.i);
+                    if (a.tag == 'f')   a.d = randomWire<float> (random);
+                }
+
+                w.beginMessage (addresses.back(), tags);
+
+                for (const auto& a : args)
+                {
+                    switch (a.tag)
+                    {
+                        case 'i':   w.addInt32 (static_cast<std::int32_t> (a.i)); break;
+                        case 'f':   w.addFloat32 (static_cast<float> (a.d)); break;
+                        case 'h':   w.addInt64 (a.i); break;
+                        case 'd':   w.addFloat64 (a.d); break;
+                        case 's':   w.addString (a.bytes); break;
+                        default:    w.addBlob (a.bytes.data(), a.bytes.size()); break;
+                    }
+                }
+
+                w.endMessage();
+            }
+
+            std::size_t index = 0;
+            bool same = ! w.hasOverflowed() && w.getSize() % 4 == 0;
+
+            same &= forEachOscMessage (w.getData(), w.getSize(), [&] (const OscMessage& m)
+            {
+                if (index >= messages.size() || m.address != addresses[index])
+                {
+                    same = false;
+                    return;
+                }
+
+                OscArgumentReader r (m);
+
+                for (const auto& a : messages[index])
+                {
+                    std::int32_t i32 = 0; float f = 0; std::int64_t i64 = 0; double d = 0;
+                    std::string_view s; const std::uint8_t* blob = nullptr; std::size_t blobSize = 0;
+
+                    switch (a.tag)
+                    {
+                        case 'i':   same &= r.readInt32 (i32) && i32 == a.i; break;
+                        case 'f':   same &= r.readFloat32 (f) && sameBits (f, static_cast<float> (a.d)); break;
+                        case 'h':   same &= r.readInt64 (i64) && i64 == a.i; break;
+                        case 'd':   same &= r.readFloat64 (d) && sameBits (d, a.d); break;
+                        case 's':   same &= r.readString (s) && s == a.bytes; break;
+                        default:    same &= r.readBlob (blob, blobSize) && std::string_view (reinterpret_cast<const char*> (blob), blobSize) == a.bytes; break;
+                    }
+                }
+
+                same &= r.isAtEnd() && r.isValid();
+                ++index;
+            });
+
+            return same && index == messages.size();
+        });
+    }
+
+    //==============================================================================
+    /** A message of Msg with random wire values in about half its fields,
+        and the default value's in the rest, so that messages with several
+        fields to validate get through often enough.
+    */
+    template <typename Msg>
+    void writeRandomFields (OscWriter& w, std::mt19937& random)
+    {
+        using Codec = schema::Codec<Msg>;
+        const typename Msg::Value defaults {};
+
+        w.beginMessage (Msg::address, Codec::typeTags.substr (1));
+
+        std::apply ([&] (auto... fields)
+        {
+            auto add = [&] (auto field)
+            {
+                using Wire = typename decltype (field)::WireT;
+                const auto v = random() % 2 == 0 ? randomWire<Wire> (random) : decltype (field)::toWire (defaults);
+
+                if constexpr (std::is_same_v<Wire, std::int32_t>)   w.addInt32 (v);
+                if constexpr (std::is_same_v<Wire, std::int64_t>)   w.addInt64 (v);
+                if constexpr (std::is_same_v<Wire, float>)          w.addFloat32 (v);
+                if constexpr (std::is_same_v<Wire, double>)         w.addFloat64 (v);
+            };
+
+            (add (fields), ...);
+        }, typename Msg::Layout {});
+
+        w.endMessage();
+    }
+
+    template <typename Msg>
+    bool sameFields (const typename Msg::Value& a, const typename Msg::Value& b)
+    {
+        return std::apply ([&] (auto... fields)
+        {
+            return (sameBits (decltype (fields)::toWire (a), decltype (fields)::toWire (b)) && ...);
+        }, typename Msg::Layout {});
+    }
+
+    /** Any value a decoder accepts encodes to bytes that decode to the same
+        value, and encoding that gives the same bytes again.
+    */
+    void testSchemaMessages()
+    {
+        messages::Published::forEach ([] (auto msg)
+        {
+            using Msg = decltype (msg);
+            using Codec = schema::Codec<Msg>;
+            int accepted = 0;
+
+            forAll (Msg::address.data(), [&] (std::mt19937& random)
+            {
+                std::uint8_t raw[256], first[Codec::wireSize], second[Codec::wireSize];
+                OscWriter w (raw, sizeof (raw));
+                writeRandomFields<Msg> (w, random);
+
+                typename Msg::Value value {}, decoded {};
+
+                if (w.getSize() != Codec::wireSize || ! Codec::decode (w.getData(), w.getSize(), value))
+                    return w.getSize() == Codec::wireSize;
+
+                ++accepted;
+                Codec::encode (first, value);
+
+                if (! Codec::decode (first, sizeof (first), decoded) || ! sameFields<Msg> (value, decoded))
+                    return false;
+
+                Codec::encode (second, decoded);
+                return std::memcmp (first, second, sizeof (first)) == 0;
+            });
+
+            // Enough cases get past validate() to say something.
+            DAWINFO_CHECK (accepted >= numCases / 50);
+        });
+    }
+
+    //==============================================================================
+    bool sameCommand (const control::Command& a, const control::Command& b)
+    {
+        return a.type == b.type && a.token == b.token && a.streams == b.streams && a.durationMs == b.durationMs
+                && sameBits (a.ppq, b.ppq) && a.feature == b.feature && a.fromNs == b.fromNs && a.toNs == b.toNs
+                && a.maxFrames == b.maxFrames && a.peaks.level == b.peaks.level && a.peaks.firstBin == b.peaks.firstBin
+                && a.peaks.numBins == b.peaks.numBins;
+    }
+
+    void testControlCommands()
+    {
+        forAll ("control commands", [] (std::mt19937& random)
+        {
+            control::Command c;
+            c.type = static_cast<control::CommandType> (uniform (random, 0, static_cast<int> (control::CommandType::queryPeaks)));
+            c.token = static_cast<std::int32_t> (random());
+
+            switch (c.type)
+            {
+                case control::CommandType::subscribe:
+                    c.streams = random();
+                    c.durationMs = uniform (random, 0, control::maxSubscriptionMs);
+                    break;
+
+                case control::CommandType::locate:
+                    c.ppq = randomWire<double> (random);
+                    break;
+
+                case control::CommandType::queryHistory:
+                    c.feature = static_cast<history::Feature> (uniform (random, 0, static_cast<int> (history::Feature::numFeatures) - 1));
+                    c.fromNs = random64 (random);
+                    c.toNs = random64 (random);
+                    c.maxFrames = uniform (random, 0, control::maxHistoryFrames);
+                    break;
+
+                case control::CommandType::queryPeaks:
+                    c.peaks.level = uniform (random, 0, 40);
+                    c.peaks.firstBin = random64 (random);
+                    c.peaks.numBins = uniform (random, 0, 1 << 20);
+                    break;
+
+                default:
+                    break;
+            }
+
+            std::uint8_t buffer[128];
+            OscWriter w (buffer, sizeof (buffer));
+            control::writeCommand (w, c);
+
+            OscMessage m;
+            control::Command decoded;
+            const bool decodes = parseOscMessage (w.getData(), w.getSize(), m) && control::decodeCommand (m, decoded);
+
+            // A locate target that isn't a number is refused rather than passed to the host.
+            if (c.type == control::CommandType::locate && ! std::isfinite (c.ppq))
+                return ! decodes;
+
+            return decodes && sameCommand (c, decoded);
+        });
+    }
+
+    //==============================================================================
+    /** Packing rounds minima down and maxima up to the next 1/127th, and a
+        summary made from unpacked bins packs to the same bytes.
+    */
+    void testPeakSummaries()
+    {
+        forAll ("peaks", [] (std::mt19937& random)
+        {
+            peaks::SummaryHeader h;
+            h.level = uniform (random, 0, 20);
+            h.numChannels = uniform (random, 1, peaks::maxChannels);
+            h.numBins = uniform (random, 0, peaks::maxBinsPerSummary (h.numChannels));
+            h.firstBin = random64 (random) & 0xffffffffff;
+
+            std::uniform_real_distribution<float> sample (-1.0f, 1.0f);
+            std::vector<PeakBin> bins (static_cast<std::size_t> (h.numBins * h.numChannels));
+
+            for (auto& b : bins)
+            {
+                const auto x = sample (random), y = sample (random);
+                b = { std::min (x, y), std::max (x, y) };
+            }
+
+            std::vector<std::uint8_t> buffer (2048), again (2048);
+            OscWriter w (buffer.data(), buffer.size());
+            peaks::writeSummary (w, h, bins.data());
+
+            OscMessage m;
+            peaks::SummaryHeader decoded;
+            const std::uint8_t* packed = nullptr;
+
+            if (! (parseOscMessage (w.getData(), w.getSize(), m) && peaks::decodeSummary (m, decoded, packed)))
+                return false;
+
+            if (decoded.level != h.level || decoded.numChannels != h.numChannels || decoded.numBins != h.numBins || decoded.firstBin != h.firstBin)
+                return false;
+
+            std::vector<PeakBin> unpacked (bins.size());
+            bool outward = true;
+
+            for (std::size_t i = 0; i < bins.size(); ++i)
+            {
+                unpacked[i] = peaks::unpack (packed, i);
+                outward &= unpacked[i].min <= bins[i].min && bins[i].min - unpacked[i].min <= 1.0f / 127.0f
+                             && unpacked[i].max >= bins[i].max && unpacked[i].max - bins[i].max <= 1.0f / 127.0f;
+            }
+
+            OscWriter w2 (again.data(), again.size());
+            peaks::writeSummary (w2, decoded, unpacked.data());
+            return outward && w2.getSize() == w.getSize() && std::equal (buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t> (w.getSize()), again.begin());
+        });
+    }
+
+    void testHistoryChunks()
+    {
+        forAll ("history", [] (std::mt19937& random)
+        {
+            history::ChunkHeader h;
+            h.token = static_cast<std::int32_t> (random());
+            h.feature = static_cast<history::Feature> (random() % 2);
+            h.tier = uniform (random, 0, 7);
+            h.numValues = uniform (random, 1, history::maxValues);
+            h.numFrames = uniform (random, 0, history::maxFramesPerChunk (h.numValues));
+            h.isLast = random() % 2 == 0;
+            h.firstNs = random64 (random) & 0xffffffffffff;
+
+            // Whole microseconds from firstNs, within an int32, come back exactly.
+            std::vector<HostTimeNs> times (static_cast<std::size_t> (h.numFrames));
+            std::vector<float> values (times.size() * static_cast<std::size_t> (h.numValues));
+            HostTimeNs t = h.firstNs;
+
+            for (auto& time : times)
+                time = (t += 1000 * static_cast<HostTimeNs> (uniform (random, 0, 100000)));
+
+            for (auto& v : values)
+                v = randomWire<float> (random);
+
+            std::vector<std::uint8_t> buffer (4096);
+            OscWriter w (buffer.data(), buffer.size());
+            history::writeChunk (w, h, times.data(), values.data());
+
+            OscMessage m;
+            history::ChunkHeader decoded;
+            const std::uint8_t* packedTimes = nullptr;
+            const std::uint8_t* packedValues = nullptr;
+
+            if (w.getSize() + 4 != history::chunkSize (h.numFrames, h.numValues))
+                return false;
+
+            if (! (parseOscMessage (w.getData(), w.getSize(), m) && history::decodeChunk (m, decoded, packedTimes, packedValues)))
+                return false;
+
+            bool same = decoded.token == h.token && decoded.feature == h.feature && decoded.tier == h.tier && decoded.numValues == h.numValues
+                         && decoded.numFrames == h.numFrames && decoded.isLast == h.isLast && decoded.firstNs == h.firstNs;
+
+            for (std::size_t i = 0; i < times.size(); ++i)
+                same &= history::timeAt (decoded, packedTimes, i) == times[i];
+
+            for (std::size_t i = 0; i < values.size(); ++i)
+                same &= sameBits (history::valueAt (packedValues, i), values[i]);
+
+            return same;
+        });
+    }
+
+    void testVectorscope()
+    {
+        forAll ("vectorscope", [] (std::mt19937& random)
+        {
+            std::vector<vectorscope::Point> points (static_cast<std::size_t> (uniform (random, 0, vectorscope::maxPoints)));
+            std::uniform_real_distribution<float> sample (-1.0f, 1.0f);
+            const auto timeNs = random64 (random);
+
+            for (auto& p : points)
+                p = { sample (random), sample (random) };
+
+            std::vector<std::uint8_t> buffer (2048), again (2048);
+            OscWriter w (buffer.data(), buffer.size());
+            vectorscope::writePoints (w, timeNs, points.data(), static_cast<int> (points.size()));
+
+            OscMessage m;
+            HostTimeNs decodedNs = 0;
+            int numPoints = 0;
+            const std::uint8_t* packed = nullptr;
+
+            if (! (parseOscMessage (w.getData(), w.getSize(), m) && vectorscope::decodePoints (m, decodedNs, numPoints, packed)))
+                return false;
+
+            if (decodedNs != timeNs || numPoints != static_cast<int> (points.size()) || w.getSize() + 4 != vectorscope::pointsSize (numPoints))
+                return false;
+
+            std::vector<vectorscope::Point> unpacked (points.size());
+            bool close = true;
+
+            for (std::size_t i = 0; i < points.size(); ++i)
+            {
+                unpacked[i] = vectorscope::unpack (packed, i);
+                close &= std::abs (unpacked[i].side - points[i].side) < 1.0f / 127.0f && std::abs (unpacked[i].mid - points[i].mid) < 1.0f / 127.0f;
+            }
+
+            OscWriter w2 (again.data(), again.size());
+            vectorscope::writePoints (w2, decodedNs, unpacked.data(), numPoints);
+            return close && w2.getSize() == w.getSize() && std::equal (buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t> (w.getSize()), again.begin());
+        });
+    }
+
+    void testMetadata()
+    {
+        forAll ("metadata", [] (std::mt19937& random)
+        {
+            metadata::Header h;
+            h.baseVersion = random();
+            h.version = random();
+            h.numParts = uniform (random, 1, 50);
+            h.part = uniform (random, 0, h.numParts - 1);
+            h.isFullSync = random() % 2 == 0;
+
+            TrackInfo track;
+            track.id = random();
+            track.name = randomName (random, 64);
+            track.colour = random();
+            track.numChannels = uniform (random, 0, 64);
+
+            const auto removed = static_cast<std::uint32_t> (random());
+            std::vector<std::uint32_t> ids (static_cast<std::size_t> (uniform (random, 0, static_cast<int> (metadata::maxIdsPerOrderChunk))));
+
+            for (auto& id : ids)
+                id = random();
+
+            const auto offset = static_cast<std::size_t> (uniform (random, 0, 1000));
+            const auto total = offset + ids.size() + static_cast<std::size_t> (uniform (random, 0, 1000));
+
+            std::vector<std::uint8_t> buffer (4096);
+            OscWriter w (buffer.data(), buffer.size());
+            w.beginBundle();
+            metadata::writeHeader (w, h);
+            metadata::writeTrack (w, track);
+            metadata::writeRemoved (w, removed);
+            metadata::writeOrderChunk (w, offset, total, ids.data(), ids.size());
+
+            const auto expectedSize = 16 + metadata::headerSize() + metadata::trackSize (track) + metadata::removedSize()
+                                        + metadata::orderChunkSize (ids.size());
+            int seen = 0;
+            bool same = w.getSize() == expectedSize;
+
+            same &= forEachOscMessage (w.getData(), w.getSize(), [&] (const OscMessage& m)
+            {
+                metadata::Header decodedHeader;
+                TrackInfo decodedTrack;
+                std::uint32_t decodedRemoved = 0;
+                std::size_t decodedOffset = 0, decodedTotal = 0, numIds = 0;
+                const std::uint8_t* packedIds = nullptr;
+
+                switch (seen++)
+                {
+                    case 0:
+                        same &= metadata::decodeHeader (m, decodedHeader) && decodedHeader.baseVersion == h.baseVersion
+                                 && decodedHeader.version == h.version && decodedHeader.part == h.part
+                                 && decodedHeader.numParts == h.numParts && decodedHeader.isFullSync == h.isFullSync;
+                        break;
+
+                    case 1:
+                        same &= metadata::decodeTrack (m, decodedTrack) && decodedTrack == track;
+                        break;
+
+                    case 2:
+                        same &= metadata::decodeRemoved (m, decodedRemoved) && decodedRemoved == removed;
+                        break;
+
+                    default:
+                        same &= metadata::decodeOrderChunk (m, decodedOffset, decodedTotal, packedIds, numIds)
+                                 && decodedOffset == offset && decodedTotal == total && numIds == ids.size();
+
+                        for (std::size_t i = 0; same && i < numIds; ++i)
+                            same &= readBigEndian32 (packedIds + i * 4) == ids[i];
+
+                        break;
+                }
+            });
+
+            return same && seen == 4;
+        });
+    }
+
+    //==============================================================================
+    void testWebSocketFrameHeaders()
+    {
+        forAll ("websocket frames", [] (std::mt19937& random)
+        {
+            constexpr websocket::Opcode opcodes[] = { websocket::continuation, websocket::text, websocket::binary,
+                                                      websocket::close, websocket::ping, websocket::pong };
+            websocket::FrameHeader h;
+            h.opcode = opcodes[random() % std::size (opcodes)];
+            h.masked = random() % 2 == 0;
+            h.mask = { static_cast<std::uint8_t> (random()), static_cast<std::uint8_t> (random()),
+                       static_cast<std::uint8_t> (random()), static_cast<std::uint8_t> (random()) };
+
+            // Control frames are short and never fragmented.
+            const bool control = (h.opcode & 0x8) != 0;
+            h.final = control || random() % 2 == 0;
+
+            switch (control ? 0 : random() % 3)
+            {
+                case 0:     h.payloadSize = static_cast<std::uint64_t> (uniform (random, 0, 125)); break;
+                case 1:     h.payloadSize = static_cast<std::uint64_t> (uniform (random, 126, 0xffff)); break;
+                default:    h.payloadSize = static_cast<std::uint64_t> (random64 (random)) >> 1; break;
+            }
+
+            std::uint8_t out[websocket::maxHeaderSize];
+            websocket::FrameHeader decoded;
+            const auto size = websocket::writeFrameHeader (out, h);
+
+            // One byte short asks for more.
+            if (websocket::parseFrameHeader (out, size - 1, decoded) != 0)
+                return false;
+
+            return websocket::parseFrameHeader (out, size, decoded) == static_cast<int> (size)
+                    && decoded.final == h.final && decoded.opcode == h.opcode && decoded.masked == h.masked
+                    && decoded.payloadSize == h.payloadSize && (! h.masked || decoded.mask == h.mask);
+        });
+    }
+
+    //==============================================================================
+    /** A config set key by key comes back the same through format() and parse(). */
+    void testConfigText()
+    {
+        forAll ("config", [] (std::mt19937& random)
+        {
+            const char* mappings[] = { "x * 2", "clamp ((x - 60) / 120, 0, 1)", "scale (db (x), -60, 0, 0, 1)", "x * gain (3 * i / n)" };
+            SenderConfig c;
+            std::string error, destinations;
+
+            for (int i = uniform (random, 0, 4); i > 0; --i)
+                destinations += (destinations.empty() ? "" : ", ") + std::to_string (uniform (random, 1, 254)) + "."
+                                  + std::to_string (random() % 256) + ".0." + std::to_string (random() % 256)
+                                  + ":" + std::to_string (uniform (random, 1, 65535));
+
+            std::string features;
+
+            for (const auto name : config::featureNames)
+                if (random() % 2 == 0)
+                    features += std::string (name) + " ";
+
+            char rate[32], tolerance[32];
+            std::snprintf (rate, sizeof (rate), "%.17g", std::uniform_real_distribution<double> (0.1, 1000.0) (random));
+            std::snprintf (tolerance, sizeof (tolerance), "%.9g", std::uniform_real_distribution<double> (0.0, 1.0) (random));
+
+            const std::pair<const char*, std::string> keys[] = {
+                { "destinations",           destinations.empty() ? "127.0.0.1:9000" : destinations },
+                { "features",               features.empty() ? "transport" : features },
+                { "transport.rate",         rate },
+                { "events.redundancy",      std::to_string (uniform (random, 0, 8)) },
+                { "packet.maxSize",         std::to_string (uniform (random, 256, 65507)) },
+                { "parameters.tolerance",   tolerance },
+                { "waveform.liveLevel",     std::to_string (uniform (random, -1, 31)) },
+                { "websocket.port",         std::to_string (uniform (random, 0, 65535)) },
+                { "map.levels",             mappings[random() % std::size (mappings)] },
+            };
+
+            for (const auto& [key, value] : keys)
+                if (random() % 3 != 0 && ! config::setValue (c, key, value, error))
+                    return false;
+
+            const auto text = config::format (c);
+            SenderConfig reloaded;
+
+            return config::parse (text, reloaded, error) && config::format (reloaded) == text
+                    && reloaded.transportRateHz == c.transportRateHz && reloaded.parameterTolerance == c.parameterTolerance
+                    && reloaded.features == c.features && reloaded.destinations.size() == c.destinations.size()
+                    && reloaded.levelsMapping.getSource() == c.levelsMapping.getSource();
+        });
+    }
+}
+
+int main()
+{
+    testOscArguments();
+    testSchemaMessages();
+    testControlCommands();
+    testPeakSummaries();
+    testHistoryChunks();
+    testVectorscope();
+    testMetadata();
+    testWebSocketFrameHeaders();
+    testConfigText();
+    return dawinfo::test::finish ("RoundTripTests");
+}
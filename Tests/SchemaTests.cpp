@@ -0,0 +1,257 @@
+#include "Common/Messages.h"
+#include "Common/SchemaDocumentation.h"
+#include "TestHarness.h"
+
+#include <sstream>
+
+using namespace dawinfo;
+using schema::Codec;
+
+//==============================================================================
+// Layout stability. These pin the wire format; if one fails, a published
+// layout changed and every receiver needs updating.
+static_assert (Codec<messages::Sequence>::typeTags == ",ii");
+static_assert (Codec<messages::Sequence>::headerSize == 20);
+static_assert (Codec<messages::Sequence>::offsetOf<0> == 20);
+static_assert (Codec<messages::Sequence>::offsetOf<1> == 24);
+static_assert (Codec<messages::Sequence>::wireSize == 28);
+
+static_assert (Codec<messages::Transport>::typeTags == ",hdddiiiiidd");
+static_assert (Codec<messages::Transport>::headerSize == 36);
+static_assert (Codec<messages::Transport>::offsetOf<0> == 36);     // timeNs
+static_assert (Codec<messages::Transport>::offsetOf<1> == 44);     // ppq
+static_assert (Codec<messages::Transport>::offsetOf<4> == 68);     // barNumber
+static_assert (Codec<messages::Transport>::offsetOf<7> == 80);     // isPlaying
+static_assert (Codec<messages::Transport>::offsetOf<10> == 96);    // loopEndPpq
+static_assert (Codec<messages::Transport>::wireSize == 104);
+
+static_assert (Codec<messages::Event>::typeTags == ",iihf");
+static_assert (Codec<messages::Event>::headerSize == 24);
+static_assert (Codec<messages::Event>::offsetOf<2> == 32);
+static_assert (Codec<messages::Event>::wireSize == 44);
+
+static_assert (Codec<messages::Midi>::typeTags == ",hiii");
+static_assert (Codec<messages::Midi>::headerSize == 24);
+static_assert (Codec<messages::Midi>::offsetOf<1> == 32);
+static_assert (Codec<messages::Midi>::wireSize == 44);
+
+static_assert (Codec<messages::Parameter>::typeTags == ",ihhff");
+static_assert (Codec<messages::Parameter>::headerSize == 24);
+static_assert (Codec<messages::Parameter>::offsetOf<1> == 28);
+static_assert (Codec<messages::Parameter>::offsetOf<3> == 44);
+static_assert (Codec<messages::Parameter>::wireSize == 52);
+
+static_assert (Codec<messages::ControlReply>::typeTags == ",iiih");
+static_assert (Codec<messages::ControlReply>::headerSize == 24);
+static_assert (Codec<messages::ControlReply>::offsetOf<3> == 36);
+static_assert (Codec<messages::ControlReply>::wireSize == 44);
+
+static_assert (Codec<messages::TempoHeader>::typeTags == ",iiiiiiiidd");
+static_assert (Codec<messages::TempoHeader>::headerSize == 36);
+static_assert (Codec<messages::TempoHeader>::offsetOf<8> == 68);    // loopStartPpq
+static_assert (Codec<messages::TempoHeader>::wireSize == 84);
+
+static_assert (Codec<messages::TempoSegment>::typeTags == ",ddddiii");
+static_assert (Codec<messages::TempoSegment>::headerSize == 36);
+static_assert (Codec<messages::TempoSegment>::offsetOf<4> == 68);    // barNumber
+static_assert (Codec<messages::TempoSegment>::wireSize == 80);
+
+static_assert (Codec<messages::Stereo>::typeTags == ",hffff");
+static_assert (Codec<messages::Stereo>::headerSize == 24);
+static_assert (Codec<messages::Stereo>::offsetOf<1> == 32);         // correlation
+static_assert (Codec<messages::Stereo>::wireSize == 48);
+
+static_assert (messages::Published::size == 9);
+static_assert (messages::Published::addressTable[1].address == "/dawinfo/transport");
+static_assert (messages::Published::addressTable[2].rate == schema::RateClass::onEvent);
+
+// Every message is 4-byte aligned as OSC requires.
+static_assert (Codec<messages::Sequence>::wireSize % 4 == 0);
+static_assert (Codec<messages::Transport>::wireSize % 4 == 0);
+static_assert (Codec<messages::Event>::wireSize % 4 == 0);
+static_assert (Codec<messages::Midi>::wireSize % 4 == 0);
+static_assert (Codec<messages::Parameter>::wireSize % 4 == 0);
+static_assert (Codec<messages::ControlReply>::wireSize % 4 == 0);
+static_assert (Codec<messages::TempoHeader>::wireSize % 4 == 0);
+static_assert (Codec<messages::TempoSegment>::wireSize % 4 == 0);
+static_assert (Codec<messages::Stereo>::wireSize % 4 == 0);
+
+namespace
+{
+    TransportSnapshot exampleTransport()
+    {
+        TransportSnapshot t;
+        t.timeNs = 123456789012345LL;
+        t.ppq = 17.25;
+        t.bpm = 127.5;
+        t.barStartPpq = 16.0;
+        t.barNumber = 4;
+        t.timeSigNumerator = 7;
+        t.timeSigDenominator = 8;
+        t.isPlaying = true;
+        t.isLooping = true;
+        t.loopStartPpq = 8.0;
+        t.loopEndPpq = 24.0;
+        return t;
+    }
+
+    void testRoundTrip()
+    {
+        std::uint8_t buffer[Codec<messages::Transport>::wireSize];
+        const auto t = exampleTransport();
+        Codec<messages::Transport>::encode (buffer, t);
+
+        TransportSnapshot d;
+        DAWINFO_CHECK (Codec<messages::Transport>::decode (buffer, sizeof (buffer), d));
+        DAWINFO_CHECK (d.timeNs == t.timeNs && d.ppq == t.ppq && d.bpm == t.bpm);
+        DAWINFO_CHECK (d.barStartPpq == t.barStartPpq && d.barNumber == t.barNumber);
+        DAWINFO_CHECK (d.timeSigNumerator == 7 && d.timeSigDenominator == 8);
+        DAWINFO_CHECK (d.isPlaying && d.isLooping);
+        DAWINFO_CHECK (d.loopStartPpq == 8.0 && d.loopEndPpq == 24.0);
+    }
+
+    void testMatchesGenericParser()
+    {
+        // The fixed-offset encoder must produce plain OSC any library can read.
+        std::uint8_t buffer[Codec<messages::Transport>::wireSize];
+        const auto t = exampleTransport();
+        Codec<messages::Transport>::encode (buffer, t);
+
+        OscMessage m;
+        DAWINFO_CHECK (parseOscMessage (buffer, sizeof (buffer), m));
+        DAWINFO_CHECK (m.address == messages::Transport::address);
+        DAWINFO_CHECK (m.typeTags == Codec<messages::Transport>::typeTags.substr (1));
+
+        OscArgumentReader r (m);
+        std::int64_t timeNs = 0;
+        double ppq = 0, bpm = 0;
+        DAWINFO_CHECK (r.readInt64 (timeNs) && timeNs == t.timeNs);
+        DAWINFO_CHECK (r.readFloat64 (ppq) && ppq == t.ppq);
+        DAWINFO_CHECK (r.readFloat64 (bpm) && bpm == t.bpm);
+
+        // And the schema decoder reads what the generic writer produces.
+        std::uint8_t generic[64];
+        OscWriter w (generic, sizeof (generic));
+        w.beginMessage ("/dawinfo/event", "iihf");
+        w.addInt32 (9);
+        w.addInt32 (static_cast<std::int32_t> (EventType::onset));
+        w.addInt64 (555);
+        w.addFloat32 (0.5f);
+        w.endMessage();
+
+        DiscreteEvent e;
+        DAWINFO_CHECK (Codec<messages::Event>::decode (generic, w.getSize(), e));
+        DAWINFO_CHECK (e.id == 9 && e.type == EventType::onset && e.timeNs == 555 && e.value == 0.5f);
+    }
+
+    void testRejectsMismatches()
+    {
+        std::uint8_t buffer[Codec<messages::Event>::wireSize];
+        DiscreteEvent e;
+        e.type = EventType::stop;
+        Codec<messages::Event>::encode (buffer, e);
+
+        DiscreteEvent d;
+        DAWINFO_CHECK (! Codec<messages::Event>::decode (buffer, sizeof (buffer) - 4, d));
+
+        SequenceHeader h;
+        DAWINFO_CHECK (! Codec<messages::Sequence>::decode (buffer, sizeof (buffer), h));
+
+        // Wrong type tag.
+        buffer[Codec<messages::Event>::addressSize + 1] = 'f';
+        DAWINFO_CHECK (! Codec<messages::Event>::decode (buffer, sizeof (buffer), d));
+        buffer[Codec<messages::Event>::addressSize + 1] = 'i';
+
+        // Out-of-range enum fails validation.
+        buffer[Codec<messages::Event>::offsetOf<1> + 3] = 99;
+        DAWINFO_CHECK (! Codec<messages::Event>::decode (buffer, sizeof (buffer), d));
+    }
+
+    /** Writes msg with one int32 field replaced by a raw wire value. */
+    template <typename Msg, std::size_t I>
+    bool decodesWith (const typename Msg::Value& v, std::int32_t wire)
+    {
+        std::uint8_t buffer[Codec<Msg>::wireSize];
+        Codec<Msg>::encode (buffer, v);
+        schema::detail::storeBigEndian (buffer + Codec<Msg>::template offsetOf<I>, wire);
+
+        typename Msg::Value d {};
+        return Codec<Msg>::decode (buffer, sizeof (buffer), d);
+    }
+
+    void testRejectsValuesTooWideForTheirMember()
+    {
+        // Range checks see the value that was sent, not what a narrowing
+        // cast made of it: 0x100 is not stream 0, nor 0x180 data byte 0.
+        DAWINFO_CHECK ((decodesWith<messages::Sequence, 0> ({}, static_cast<std::int32_t> (StreamId::midi))));
+        DAWINFO_CHECK (! (decodesWith<messages::Sequence, 0> ({}, 0x100)));
+        DAWINFO_CHECK (! (decodesWith<messages::Sequence, 0> ({}, -1)));
+
+        MidiEvent note;
+        note.status = 0x90;
+        DAWINFO_CHECK ((decodesWith<messages::Midi, 2> (note, 0x7f)));
+        DAWINFO_CHECK (! (decodesWith<messages::Midi, 1> (note, 0x190)));
+        DAWINFO_CHECK (! (decodesWith<messages::Midi, 2> (note, 0x180)));
+        DAWINFO_CHECK (! (decodesWith<messages::Midi, 3> (note, -256)));
+
+        // A bool is 0 or 1.
+        DAWINFO_CHECK ((decodesWith<messages::Transport, 7> ({}, 1)));
+        DAWINFO_CHECK (! (decodesWith<messages::Transport, 7> ({}, 5)));
+
+        // Same-width unsigned members keep their full range.
+        DAWINFO_CHECK ((decodesWith<messages::Sequence, 1> ({}, -1)));
+    }
+
+    void testDispatch()
+    {
+        std::uint8_t buffer[256];
+        OscWriter w (buffer, sizeof (buffer));
+        w.beginBundle();
+        writeSequence (w, StreamId::transport, 41);
+        schema::Codec<messages::Transport>::write (w, exampleTransport());
+        DAWINFO_CHECK (! w.hasOverflowed());
+        DAWINFO_CHECK (w.getSize() == 16 + 4 + 28 + 4 + 104);
+
+        int sequences = 0, transports = 0, unknown = 0;
+
+        forEachOscMessage (w.getData(), w.getSize(), [&] (const OscMessage& m)
+        {
+            const bool handled = messages::Published::dispatch (m, [&] (auto msg, const auto& value)
+            {
+                using Msg = decltype (msg);
+
+                if constexpr (std::is_same_v<Msg, messages::Sequence>)
+                    sequences += value.seq == 41 ? 1 : 100;
+                else if constexpr (std::is_same_v<Msg, messages::Transport>)
+                    transports += value.bpm == 127.5 ? 1 : 100;
+            });
+
+            unknown += handled ? 0 : 1;
+        });
+
+        DAWINFO_CHECK (sequences == 1 && transports == 1 && unknown == 0);
+    }
+
+    void testDocumentation()
+    {
+        std::ostringstream out;
+        writeSchemaMarkdown (out);
+        const auto doc = out.str();
+
+        for (auto& e : messages::Published::addressTable)
+            DAWINFO_CHECK (doc.find (e.address) != std::string::npos);
+
+        DAWINFO_CHECK (doc.find ("`loopEndPpq` | float64 | 96") != std::string::npos);
+    }
+}
+
+int main()
+{
+    testRoundTrip();
+    testMatchesGenericParser();
+    testRejectsMismatches();
+    testRejectsValuesTooWideForTheirMember();
+    testDispatch();
+    testDocumentation();
+    return dawinfo::test::finish ("SchemaTests");
+}
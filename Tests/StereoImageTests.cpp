@@ -0,0 +1,288 @@
+#include "AllocationCounter.h"
+#include "Common/Messages.h"
+#include "Sender/CoalescingQueue.h"
+#include "Sender/StereoImageMeter.h"
+#include "TestHarness.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double sampleRate = 48000.0;
+
+    struct Signal
+    {
+        std::vector<float> left, right;
+    };
+
+    /** One second of a 997 Hz sine: left at gainL, right at gainR. */
+    Signal sine (float gainL, float gainR)
+    {
+        Signal s;
+
+        for (int i = 0; i < static_cast<int> (sampleRate); ++i)
+        {
+            const auto x = static_cast<float> (std::sin (2.0 * pi * 997.0 * i / sampleRate));
+            s.left.push_back (gainL * x);
+            s.right.push_back (gainR * x);
+        }
+
+        return s;
+    }
+
+    /** One second of independent white noise per channel, RMS 1/sqrt(3). */
+    Signal noise()
+    {
+        std::mt19937 random (11);
+        std::uniform_real_distribution<float> sample (-1.0f, 1.0f);
+        Signal s;
+
+        for (int i = 0; i < static_cast<int> (sampleRate); ++i)
+        {
+            s.left.push_back (sample (random));
+            s.right.push_back (sample (random));
+        }
+
+        return s;
+    }
+
+    /** Runs the signal through in host-sized blocks and returns the last reading. */
+    StereoMeter measure (const Signal& s, int blockSize = 512)
+    {
+        StereoImageMeter meter;
+        const int n = static_cast<int> (s.left.size());
+
+        for (int i = 0; i < n; i += blockSize)
+            meter.process (s.left.data() + i, s.right.data() + i, std::min (blockSize, n - i));
+
+        return meter.getMeter (0);
+    }
+
+    void testKernelMatchesScalar()
+    {
+        std::mt19937 random (3);
+        std::uniform_real_distribution<float> sample (-1.0f, 1.0f);
+
+        for (const int numFrames : { 0, 1, 3, 8, 61, 512, 4096 })
+        {
+            std::vector<float> left (static_cast<std::size_t> (numFrames)), right (left.size());
+
+            for (std::size_t i = 0; i < left.size(); ++i)
+            {
+                left[i] = sample (random);
+                right[i] = 0.5f * left[i] + 0.5f * sample (random);
+            }
+
+            const auto fast = kernels::stereoSums (left.data(), right.data(), numFrames);
+            const auto reference = kernels::scalar::stereoSums (left.data(), right.data(), numFrames);
+            const double tolerance = 1.0e-5 * std::max (numFrames, 1);
+
+            DAWINFO_CHECK_NEAR (fast.ll, reference.ll, tolerance);
+            DAWINFO_CHECK_NEAR (fast.rr, reference.rr, tolerance);
+            DAWINFO_CHECK_NEAR (fast.lr, reference.lr, tolerance);
+        }
+    }
+
+    void testKnownSignals()
+    {
+        const float minusThree = static_cast<float> (10.0 * std::log10 (0.5));
+
+        // Mono: all mid, no side, fully correlated.
+        auto m = measure (sine (1.0f, 1.0f));
+        DAWINFO_CHECK_NEAR (m.correlation, 1.0, 1.0e-4);
+        DAWINFO_CHECK_NEAR (m.balance, 0.0, 1.0e-6);
+        DAWINFO_CHECK_NEAR (m.midDb, minusThree, 0.01);
+        DAWINFO_CHECK (m.sideDb == StereoMeter::minDb);
+
+        // Anti-phase: the mirror image.
+        m = measure (sine (1.0f, -1.0f));
+        DAWINFO_CHECK_NEAR (m.correlation, -1.0, 1.0e-4);
+        DAWINFO_CHECK_NEAR (m.sideDb, minusThree, 0.01);
+        DAWINFO_CHECK (m.midDb == StereoMeter::minDb);
+
+        // Uncorrelated noise: correlation near zero, mid and side equal.
+        m = measure (noise());
+        DAWINFO_CHECK (std::abs (m.correlation) < 0.05f);
+        DAWINFO_CHECK (std::abs (m.balance) < 0.05f);
+        DAWINFO_CHECK_NEAR (m.midDb, m.sideDb, 0.5);
+        DAWINFO_CHECK_NEAR (m.midDb, 10.0 * std::log10 (1.0 / 6.0), 0.5);
+
+        // One side only, and a pan: balance follows the energy.
+        m = measure (sine (1.0f, 0.0f));
+        DAWINFO_CHECK (m.balance == -1.0f && m.correlation == 0.0f);
+        m = measure (sine (0.5f, 1.0f));
+        DAWINFO_CHECK_NEAR (m.balance, 0.6, 1.0e-4);
+        DAWINFO_CHECK_NEAR (m.correlation, 1.0, 1.0e-4);
+
+        // The reading doesn't depend on the block size.
+        const auto s = noise();
+        const auto small = measure (s, 32), large = measure (s, 2048);
+        DAWINFO_CHECK_NEAR (small.correlation, large.correlation, 0.02);
+        DAWINFO_CHECK_NEAR (small.midDb, large.midDb, 0.2);
+
+        // Silence reads as silence.
+        m = measure (sine (0.0f, 0.0f));
+        DAWINFO_CHECK (m.correlation == 0.0f && m.balance == 0.0f && m.midDb == StereoMeter::minDb);
+    }
+
+    void testReservoir()
+    {
+        StereoImageMeter::Options o;
+        o.pointsPerFrame = 128;
+        o.decimation = 2;
+        StereoImageMeter meter (o);
+        StereoImageMeter::Frame frame;
+
+        // Mono lands on the mid axis, anti-phase on the side axis.
+        const auto mono = sine (0.8f, 0.8f), anti = sine (0.8f, -0.8f);
+        meter.process (mono.left.data(), mono.right.data(), 800);
+        DAWINFO_CHECK (meter.getCandidates() == 400);
+        meter.endFrame (1, frame);
+        DAWINFO_CHECK (frame.numPoints == 128 && meter.getCandidates() == 0);
+
+        bool onAxis = true;
+
+        for (int i = 0; i < frame.numPoints; ++i)
+            onAxis &= frame.points[static_cast<std::size_t> (i)].side == 0.0f && std::abs (frame.points[static_cast<std::size_t> (i)].mid) <= 0.8f;
+
+        meter.process (anti.left.data(), anti.right.data(), 800);
+        meter.endFrame (2, frame);
+
+        for (int i = 0; i < frame.numPoints; ++i)
+            onAxis &= frame.points[static_cast<std::size_t> (i)].mid == 0.0f;
+
+        DAWINFO_CHECK (onAxis);
+
+        // A short frame keeps every candidate; decimation carries across blocks.
+        meter.process (mono.left.data(), mono.right.data(), 7);
+        meter.process (mono.left.data(), mono.right.data(), 7);
+        meter.endFrame (3, frame);
+        DAWINFO_CHECK (frame.numPoints == 7);
+
+        // Uniform over the frame: a ramp from 0 to 1 in mid should come back
+        // with a mean near 0.5 and both halves equally represented, however
+        // long the frame.
+        for (const int frameLength : { 400, 4000, 40000 })
+        {
+            std::vector<float> ramp (static_cast<std::size_t> (frameLength));
+
+            for (int i = 0; i < frameLength; ++i)
+                ramp[static_cast<std::size_t> (i)] = static_cast<float> (i) / static_cast<float> (frameLength);
+
+            double mean = 0.0;
+            int firstHalf = 0, total = 0;
+            constexpr int numFrames = 200;
+
+            for (int f = 0; f < numFrames; ++f)
+            {
+                for (int i = 0; i < frameLength; i += 256)
+                    meter.process (ramp.data() + i, ramp.data() + i, std::min (256, frameLength - i));
+
+                meter.endFrame (f, frame);
+                DAWINFO_CHECK (frame.numPoints == 128);
+
+                for (int i = 0; i < frame.numPoints; ++i)
+                {
+                    const auto mid = frame.points[static_cast<std::size_t> (i)].mid;
+                    mean += mid;
+                    firstHalf += mid < 0.5f ? 1 : 0;
+                    ++total;
+                }
+            }
+
+            mean /= total;
+            DAWINFO_CHECK_NEAR (mean, 0.5, 0.01);
+            DAWINFO_CHECK_NEAR (static_cast<double> (firstHalf) / total, 0.5, 0.02);
+        }
+
+        // Nothing allocates.
+        test::ScopedAllocationCount counting;
+        const auto before = test::allocationCount();
+        meter.process (mono.left.data(), mono.right.data(), 4096);
+        meter.endFrame (4, frame);
+        DAWINFO_CHECK (test::allocationCount() == before);
+    }
+
+    struct CaptureSink : PacketSink
+    {
+        std::vector<std::uint8_t> last;
+
+        bool send (const std::uint8_t* data, std::size_t size) override
+        {
+            last.assign (data, data + size);
+            return true;
+        }
+    };
+
+    void testPacket()
+    {
+        StereoImageMeter meter;
+        StereoImageMeter::Frame frame;
+        const auto s = sine (0.9f, 0.3f);
+        meter.process (s.left.data(), s.right.data(), 4096);
+        meter.endFrame (123456789, frame);
+        DAWINFO_CHECK (frame.numPoints == 256);
+
+        CaptureSink sink;
+        StreamSequencer seq;
+        const auto bytes = StereoImageMeter::publish (frame, sink, seq);
+        DAWINFO_CHECK (bytes > 0 && bytes == sink.last.size() && bytes <= 1400);
+        DAWINFO_CHECK (bytes == 16 + 4 + 28 + 4 + schema::Codec<messages::Stereo>::wireSize + vectorscope::pointsSize (256));
+
+        StereoMeter decoded;
+        int stereos = 0, clouds = 0;
+        bool exact = true;
+
+        forEachOscMessage (sink.last.data(), sink.last.size(), [&] (const OscMessage& m)
+        {
+            stereos += schema::Codec<messages::Stereo>::decode (m, decoded) ? 1 : 0;
+
+            HostTimeNs timeNs = 0;
+            int numPoints = 0;
+            const std::uint8_t* packed = nullptr;
+
+            if (vectorscope::decodePoints (m, timeNs, numPoints, packed))
+            {
+                ++clouds;
+                exact &= timeNs == 123456789 && numPoints == frame.numPoints;
+
+                for (int i = 0; i < numPoints; ++i)
+                {
+                    const auto p = vectorscope::unpack (packed, static_cast<std::size_t> (i));
+                    const auto& q = frame.points[static_cast<std::size_t> (i)];
+                    exact &= std::abs (p.side - q.side) <= 1.0f / 127.0f && std::abs (p.mid - q.mid) <= 1.0f / 127.0f;
+                }
+            }
+        });
+
+        DAWINFO_CHECK (stereos == 1 && clouds == 1 && exact);
+        DAWINFO_CHECK (decoded.timeNs == 123456789 && decoded.correlation == frame.meter.correlation
+                        && decoded.balance == frame.meter.balance && decoded.midDb == frame.meter.midDb);
+
+        // Its own stream, so a slow link's queue keeps it apart from the levels.
+        DAWINFO_CHECK (seq.peek (StreamId::stereo) == 1 && seq.peek (StreamId::levels) == 0);
+
+        std::uint8_t levels[64];
+        OscWriter w (levels, sizeof (levels));
+        seq.beginPacket (w, StreamId::levels);
+
+        CoalescingQueue queue;
+        DAWINFO_CHECK (! queue.push (sink.last.data(), sink.last.size()) && ! queue.push (w.getData(), w.getSize()));
+        DAWINFO_CHECK (queue.size() == 2 && queue.getStats().coalesced == 0);
+    }
+}
+
+int main()
+{
+    testKernelMatchesScalar();
+    testKnownSignals();
+    testReservoir();
+    testPacket();
+    return dawinfo::test::finish ("StereoImageTests");
+}
@@ -0,0 +1,566 @@
+#include "Common/Messages.h"
+#include "Common/TempoMap.h"
+#include "MirrorSink.h"
+#include "Receiver/TempoMapMirror.h"
+#include "Sender/TempoMapBuilder.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512, subStep = 16;
+
+    /** A time signature from a bar line on. */
+    struct Meter
+    {
+        double startPpq = 0.0;
+        std::int32_t numerator = 4, denominator = 4, barNumber = 0;
+
+        double beatLength() const   { return 4.0 / denominator; }
+        double barLength() const    { return numerator * beatLength(); }
+    };
+
+    /** A host session's tempo automation, meters and loop: the truth the
+        builder has to discover from block-rate transport.
+    */
+    struct Script
+    {
+        std::function<double (double)> bpmAt;
+        std::vector<Meter> meters { Meter() };
+        bool looping = false;
+        double loopStartPpq = 0.0, loopEndPpq = 0.0;
+
+        const Meter& meterAt (double ppq) const
+        {
+            const Meter* m = &meters.front();
+
+            for (auto& next : meters)
+                if (next.startPpq <= ppq + 1.0e-9)
+                    m = &next;
+
+            return *m;
+        }
+
+        /** The first beat at or after ppq (or strictly after). */
+        double nextBeat (double ppq, bool inclusive) const
+        {
+            const auto& m = meterAt (ppq);
+            const double in = (ppq - m.startPpq) / m.beatLength();
+            double index = std::ceil (in - 1.0e-9);
+
+            if (! inclusive && index <= in + 1.0e-9)
+                index += 1.0;
+
+            double q = m.startPpq + index * m.beatLength();
+
+            for (auto& next : meters)
+                if (next.startPpq > ppq && next.startPpq < q)
+                    q = next.startPpq;
+
+            return q;
+        }
+
+        BeatTime beatAt (double q, double seconds) const
+        {
+            const auto& m = meterAt (q);
+            const auto bars = std::floor ((q - m.startPpq) / m.barLength() + 1.0e-9);
+
+            BeatTime b;
+            b.timeNs = static_cast<HostTimeNs> (std::llround (seconds * 1.0e9));
+            b.ppq = q;
+            b.bar = m.barNumber + static_cast<std::int32_t> (bars);
+            b.beat = static_cast<std::int32_t> (std::lround ((q - m.startPpq - bars * m.barLength()) / m.beatLength()));
+            return b;
+        }
+
+        TransportSnapshot report (double ppq, double seconds) const
+        {
+            const auto& m = meterAt (ppq);
+            const auto bars = std::floor ((ppq - m.startPpq) / m.barLength() + 1.0e-9);
+
+            TransportSnapshot s;
+            s.timeNs = static_cast<HostTimeNs> (std::llround (seconds * 1.0e9));
+            s.ppq = ppq;
+            s.bpm = bpmAt (ppq);
+            s.barStartPpq = m.startPpq + bars * m.barLength();
+            s.barNumber = m.barNumber + static_cast<std::int32_t> (bars);
+            s.timeSigNumerator = m.numerator;
+            s.timeSigDenominator = m.denominator;
+            s.isPlaying = true;
+            s.isLooping = looping;
+            s.loopStartPpq = loopStartPpq;
+            s.loopEndPpq = loopEndPpq;
+            return s;
+        }
+    };
+
+    /** What the host reported at each block, and when each beat really fell. */
+    struct Run
+    {
+        std::vector<TransportSnapshot> blocks;
+        std::vector<BeatTime> beats;
+    };
+
+    /** Plays the script from ppq 0, integrating its tempo finely between blocks. */
+    Run play (const Script& script, double seconds)
+    {
+        Run run;
+        const double dt = subStep / sampleRate;
+        const int stepsPerBlock = blockSize / subStep;
+        const auto numSteps = static_cast<int> (seconds / dt);
+
+        auto addCrossings = [&] (double from, double to, bool inclusive, double t0, double t1)
+        {
+            for (double q = script.nextBeat (from, inclusive); q <= to; q = script.nextBeat (q, false))
+                run.beats.push_back (script.beatAt (q, t0 + (t1 - t0) * (to > from ? (q - from) / (to - from) : 0.0)));
+        };
+
+        double p = 0.0;
+        addCrossings (0.0, 0.0, true, 0.0, 0.0);
+
+        for (int i = 0; i < numSteps; ++i)
+        {
+            const double t = i * dt;
+
+            if (i % stepsPerBlock == 0)
+                run.blocks.push_back (script.report (p, t));
+
+            const double mid = p + script.bpmAt (p) * dt / 120.0;
+            double next = p + script.bpmAt (mid) * dt / 60.0;
+
+            if (script.looping && next >= script.loopEndPpq)
+            {
+                const double wrapTime = t + dt * (script.loopEndPpq - p) / (next - p);
+                addCrossings (p, script.loopEndPpq - 1.0e-9, false, t, wrapTime);
+
+                next = script.loopStartPpq + (next - script.loopEndPpq);
+                addCrossings (script.loopStartPpq, next, true, wrapTime, t + dt);
+            }
+            else
+            {
+                addCrossings (p, next, false, t, t + dt);
+            }
+
+            p = next;
+        }
+
+        return run;
+    }
+
+    using MirrorSink = test::MirrorSink<TempoMapMirror>;
+
+    bool mapsMatch (const TempoMap& a, const TempoMap& b)
+    {
+        return a.segments == b.segments && a.isLooping == b.isLooping
+                && a.loopStartPpq == b.loopStartPpq && a.loopEndPpq == b.loopEndPpq;
+    }
+
+    /** What a receiver without the map would assume: the current tempo, forever. */
+    TempoMap constantTempo (const TransportSnapshot& s)
+    {
+        TempoMap m;
+        TempoSegment seg;
+        seg.startPpq = s.ppq;
+        seg.bpm = s.bpm;
+        seg.barStartPpq = s.barStartPpq;
+        seg.barNumber = s.barNumber;
+        seg.timeSigNumerator = s.timeSigNumerator;
+        seg.timeSigDenominator = s.timeSigDenominator;
+        m.segments.push_back (seg);
+        m.isLooping = s.isLooping;
+        m.loopStartPpq = s.loopStartPpq;
+        m.loopEndPpq = s.loopEndPpq;
+        return m;
+    }
+
+    struct Accuracy
+    {
+        int compared = 0;
+        bool gridMatches = true;
+        double maxErrorMs = 0.0;
+    };
+
+    /** Predicts beats from a block and scores them against when they really fell. */
+    Accuracy score (const TempoMap& map, const TransportSnapshot& from, const Run& run, int numBeats)
+    {
+        std::vector<BeatTime> predicted (static_cast<std::size_t> (numBeats));
+        const int n = map.predictBeats (from.ppq, from.timeNs, predicted.data(), numBeats);
+
+        auto truth = std::lower_bound (run.beats.begin(), run.beats.end(), from.timeNs,
+                                       [] (const BeatTime& b, HostTimeNs t) { return b.timeNs < t; });
+
+        Accuracy a;
+
+        for (int i = 0; i < n && truth != run.beats.end(); ++i, ++truth)
+        {
+            const auto& p = predicted[static_cast<std::size_t> (i)];
+            a.gridMatches = a.gridMatches && std::abs (p.ppq - truth->ppq) < 1.0e-6
+                                && p.bar == truth->bar && p.beat == truth->beat;
+            a.maxErrorMs = std::max (a.maxErrorMs, std::abs (static_cast<double> (p.timeNs - truth->timeNs)) * 1.0e-6);
+            ++a.compared;
+        }
+
+        a.gridMatches = a.gridMatches && a.compared == numBeats;
+        return a;
+    }
+
+    /** The first block at or after the given time whose position isn't right
+        on a beat, so there's no doubt which beat comes next.
+    */
+    std::size_t blockAt (const Run& run, double seconds)
+    {
+        auto i = static_cast<std::size_t> (seconds * sampleRate / blockSize);
+
+        while (i + 1 < run.blocks.size() && std::abs (run.blocks[i].ppq * 2.0 - std::round (run.blocks[i].ppq * 2.0)) < 1.0e-3)
+            ++i;
+
+        return i;
+    }
+
+    /** Feeds the builder block by block up to (not including) a block,
+        publishing after each, as the sender thread would.
+    */
+    struct Learner
+    {
+        TempoMapBuilder builder;
+        StreamSequencer seq;
+        MirrorSink sink;
+        std::size_t next = 0;
+
+        void learnUntil (const Run& run, std::size_t block)
+        {
+            for (; next < block && next < run.blocks.size(); ++next)
+            {
+                builder.observe (run.blocks[next]);
+                builder.publish (sink, seq);
+            }
+        }
+    };
+
+    void report (const char* name, const Accuracy& learnt, const Accuracy& constant)
+    {
+        std::printf ("  %-34s %3d beats  map %7.3f ms  constant tempo %9.3f ms\n",
+                     name, learnt.compared, learnt.maxErrorMs, constant.maxErrorMs);
+    }
+
+    //==============================================================================
+    void testSegmentMaths()
+    {
+        TempoMap map;
+        TempoSegment a;
+        a.bpm = 120.0;
+        map.segments.push_back (a);
+
+        DAWINFO_CHECK_NEAR (map.secondsBetween (0.0, 8.0), 4.0, 1.0e-12);
+
+        // 60 to 120 bpm across 4 quarters: 60/k ln(120/60) seconds with k = 15.
+        TempoSegment ramp = a;
+        ramp.startPpq = 8.0;
+        ramp.bpm = 60.0;
+        ramp.bpmPerQuarter = 15.0;
+        map.segments.push_back (ramp);
+        DAWINFO_CHECK_NEAR (map.secondsBetween (8.0, 12.0), 4.0 * std::log (2.0), 1.0e-12);
+        DAWINFO_CHECK_NEAR (map.bpmAt (10.0), 90.0, 1.0e-12);
+
+        // Past maxBpm the line is held.
+        DAWINFO_CHECK (map.bpmAt (1000.0) == TempoSegment::maxBpm);
+        const double toLimit = (TempoSegment::maxBpm - 60.0) / 15.0;
+        DAWINFO_CHECK_NEAR (map.secondsBetween (8.0 + toLimit, 8.0 + toLimit + 10.0), 0.6, 1.0e-9);
+
+        // Meters match across whole bars only, with bar numbers to suit.
+        TempoSegment later = a;
+        later.barStartPpq = 12.0;
+        later.barNumber = 3;
+        DAWINFO_CHECK (a.sameMeter (later));
+        later.barNumber = 4;
+        DAWINFO_CHECK (! a.sameMeter (later));
+        later.barStartPpq = 14.0;
+        later.barNumber = 3;
+        DAWINFO_CHECK (! a.sameMeter (later));
+
+        // Beats wrap at the loop end, and the loop start is a beat of its own.
+        TempoMap loop;
+        loop.segments.push_back (a);
+        loop.isLooping = true;
+        loop.loopStartPpq = 4.0;
+        loop.loopEndPpq = 6.0;
+
+        BeatTime beats[4];
+        DAWINFO_CHECK (loop.predictBeats (4.5, 0, beats, 4) == 4);
+        DAWINFO_CHECK (beats[0].ppq == 5.0 && beats[1].ppq == 4.0 && beats[2].ppq == 5.0 && beats[3].ppq == 4.0);
+        DAWINFO_CHECK (beats[1].bar == 1 && beats[1].isDownbeat() && beats[2].beat == 1);
+        DAWINFO_CHECK (beats[0].timeNs == 250'000'000 && beats[1].timeNs == 750'000'000);
+    }
+
+    void testConstantAndRamp()
+    {
+        std::printf ("Beat predictions against the scripted timeline (worst error):\n");
+
+        Script steady;
+        steady.bpmAt = [] (double) { return 120.0; };
+        const auto steadyRun = play (steady, 15.0);
+
+        Learner a;
+        const auto from = blockAt (steadyRun, 5.0);
+        a.learnUntil (steadyRun, from + 1);
+        const auto steadyAccuracy = score (a.sink.mirror.getMap(), steadyRun.blocks[from], steadyRun, 16);
+        report ("steady 120 bpm", steadyAccuracy, score (constantTempo (steadyRun.blocks[from]), steadyRun.blocks[from], steadyRun, 16));
+        DAWINFO_CHECK (steadyAccuracy.gridMatches && steadyAccuracy.maxErrorMs < 0.1);
+        DAWINFO_CHECK (a.builder.getMap().segments.size() == 1 && a.builder.getVersion() == 1);
+
+        // 100 to 160 bpm from quarter 4 to 36, linear in position.
+        Script ramp;
+        ramp.bpmAt = [] (double ppq) { return 100.0 + 60.0 * std::clamp ((ppq - 4.0) / 32.0, 0.0, 1.0); };
+        const auto rampRun = play (ramp, 30.0);
+
+        Learner b;
+        const auto mid = blockAt (rampRun, 7.0);
+        b.learnUntil (rampRun, mid + 1);
+        const auto& learnt = b.sink.mirror.getMap();
+        DAWINFO_CHECK (b.builder.getStats().rampsFitted == 1 && learnt.segments.size() == 2);
+        DAWINFO_CHECK_NEAR (learnt.segments.back().bpmPerQuarter, 60.0 / 32.0, 1.0e-6);
+
+        const auto rampAccuracy = score (learnt, rampRun.blocks[mid], rampRun, 8);
+        const auto rampConstant = score (constantTempo (rampRun.blocks[mid]), rampRun.blocks[mid], rampRun, 8);
+        report ("ramp 100 -> 160 bpm, mid-ramp", rampAccuracy, rampConstant);
+        DAWINFO_CHECK (rampAccuracy.gridMatches && rampAccuracy.maxErrorMs < 1.0);
+        DAWINFO_CHECK (rampConstant.maxErrorMs > 20.0 * rampAccuracy.maxErrorMs);
+
+        // Once the ramp ends the map learns the hold, and stays small.
+        b.learnUntil (rampRun, rampRun.blocks.size());
+        DAWINFO_CHECK (b.builder.getMap().segments.size() <= 4);
+        DAWINFO_CHECK_NEAR (b.builder.getMap().bpmAt (rampRun.blocks.back().ppq), 160.0, 0.05);
+        DAWINFO_CHECK (mapsMatch (b.sink.mirror.getMap(), b.builder.getMap()));
+    }
+
+    void testMeterChange()
+    {
+        // Four bars of 4/4, then 7/8 from bar 4.
+        Script script;
+        script.bpmAt = [] (double) { return 120.0; };
+        script.meters.push_back ({ 16.0, 7, 8, 4 });
+        const auto run = play (script, 20.0);
+
+        Learner l;
+        const auto from = blockAt (run, 9.0);
+        l.learnUntil (run, from + 1);
+
+        const auto& map = l.sink.mirror.getMap();
+        DAWINFO_CHECK (map.segments.size() == 2 && map.segments[1].startPpq == 16.0);
+        DAWINFO_CHECK (map.segments[1].timeSigNumerator == 7 && map.segments[1].barNumber == 4);
+
+        const auto accuracy = score (map, run.blocks[from], run, 21);
+        report ("4/4 -> 7/8 at bar 4", accuracy, score (constantTempo (run.blocks[from]), run.blocks[from], run, 21));
+        DAWINFO_CHECK (accuracy.gridMatches && accuracy.maxErrorMs < 0.1);
+
+        // Bars keep counting across the change.
+        BeatTime beats[8];
+        map.predictBeats (15.2, 0, beats, 8);
+        DAWINFO_CHECK (beats[0].ppq == 15.0 + 1.0 && beats[0].bar == 4 && beats[0].isDownbeat());
+        DAWINFO_CHECK (beats[7].bar == 5 && beats[7].isDownbeat());
+    }
+
+    void testLoopWithTempoChange()
+    {
+        // A four-bar loop: 120 bpm for two bars, then 90.
+        Script script;
+        script.bpmAt = [] (double ppq) { return ppq < 8.0 ? 120.0 : 90.0; };
+        script.looping = true;
+        script.loopEndPpq = 16.0;
+        const auto run = play (script, 40.0);
+
+        const double cycleSeconds = 4.0 + 8.0 * 60.0 / 90.0;
+
+        // Early in the first cycle nothing past now is known...
+        Learner l;
+        const auto early = blockAt (run, 2.0);
+        l.learnUntil (run, early + 1);
+        const auto blind = score (l.sink.mirror.getMap(), run.blocks[early], run, 24);
+        DAWINFO_CHECK (blind.maxErrorMs > 100.0);
+
+        // ...but once round, the whole loop is. Blocks fall half a block
+        // differently on the second cycle, which pins the change down further.
+        const auto from = blockAt (run, 2.0 * cycleSeconds + 2.0);
+        l.learnUntil (run, from + 1);
+        const auto accuracy = score (l.sink.mirror.getMap(), run.blocks[from], run, 24);
+        const auto constant = score (constantTempo (run.blocks[from]), run.blocks[from], run, 24);
+        report ("loop, 120 -> 90 bpm inside", accuracy, constant);
+        DAWINFO_CHECK (accuracy.gridMatches && accuracy.maxErrorMs < 2.0);
+        DAWINFO_CHECK (constant.maxErrorMs > 1000.0);
+
+        // Going round again teaches nothing new, and so sends nothing.
+        const auto version = l.builder.getVersion();
+        const auto packets = l.sink.packets;
+        l.learnUntil (run, run.blocks.size());
+        DAWINFO_CHECK (l.builder.getVersion() == version && l.sink.packets == packets);
+        DAWINFO_CHECK (l.builder.getMap().segments.size() == 2 && l.builder.getMap().hasLoop());
+    }
+
+    //==============================================================================
+    void testIncrementalUpdates()
+    {
+        // A new tempo every bar.
+        Script script;
+        script.bpmAt = [] (double ppq) { return 100.0 + 10.0 * std::fmod (std::floor (ppq / 4.0), 5.0); };
+        const auto run = play (script, 60.0);
+
+        Learner l;
+        l.learnUntil (run, run.blocks.size());
+
+        const auto& map = l.builder.getMap();
+        const auto numSegments = map.segments.size();
+        DAWINFO_CHECK (numSegments > 20);
+        DAWINFO_CHECK (mapsMatch (l.sink.mirror.getMap(), map));
+        DAWINFO_CHECK (l.sink.mirror.getVersion() == l.builder.getVersion());
+
+        // One update per change, each carrying only the new segment.
+        constexpr std::size_t oneSegment = 16 + 4 + 28 + 4 + 84 + 4 + 80;
+        DAWINFO_CHECK (l.builder.getVersion() == numSegments && l.sink.packets == numSegments);
+        DAWINFO_CHECK (l.sink.largest == oneSegment);
+
+        std::size_t resendEverything = 0;
+
+        for (std::size_t n = 1; n <= numSegments; ++n)
+            resendEverything += oneSegment + (n - 1) * 84;
+
+        std::printf ("  %zu tempo changes: %zu bytes sent, %zu resending the map each time\n",
+                     numSegments, l.sink.bytes, resendEverything);
+
+        // A receiver joining late asks for everything; a small MTU splits it.
+        TempoMapBuilder::Options small;
+        small.maxPacketSize = 512;
+        TempoMapBuilder splitting (small);
+
+        for (auto& b : run.blocks)
+            splitting.observe (b);
+
+        MirrorSink late;
+        StreamSequencer seq;
+        splitting.publish (late, seq);
+        DAWINFO_CHECK (late.packets > 4 && mapsMatch (late.mirror.getMap(), map));
+
+        l.builder.requestFullSync();
+        MirrorSink again;
+        l.builder.publish (again, seq);
+        DAWINFO_CHECK (mapsMatch (again.mirror.getMap(), map) && l.builder.getStats().fullSyncs == 1);
+    }
+
+    void testLostUpdateNeedsFullSync()
+    {
+        Script script;
+        script.bpmAt = [] (double ppq) { return ppq < 8.0 ? 120.0 : ppq < 16.0 ? 140.0 : 110.0; };
+        const auto run = play (script, 16.0);
+
+        Learner l;
+        const auto firstChange = blockAt (run, 4.1);
+        l.learnUntil (run, firstChange - 10);
+        DAWINFO_CHECK (l.sink.mirror.getVersion() == 1);
+
+        l.sink.dropNext = 1;
+        l.learnUntil (run, run.blocks.size());
+        DAWINFO_CHECK (l.builder.getVersion() == 3 && l.sink.mirror.getVersion() == 1);
+        DAWINFO_CHECK (l.sink.mirror.needsFullSync());
+
+        l.builder.requestFullSync();
+        l.builder.publish (l.sink, l.seq);
+        DAWINFO_CHECK (! l.sink.mirror.needsFullSync() && l.sink.mirror.getVersion() == 3);
+        DAWINFO_CHECK (mapsMatch (l.sink.mirror.getMap(), l.builder.getMap()));
+
+        // Headers that don't add up are rejected before they touch the map.
+        TempoMapHeader bad;
+        bad.numSegments = TempoMap::maxSegments + 1;
+        std::uint8_t buffer[256];
+        OscWriter w (buffer, sizeof (buffer));
+        w.beginBundle();
+        schema::Codec<messages::TempoHeader>::write (w, bad);
+        DAWINFO_CHECK (! l.sink.mirror.handlePacket (w.getData(), w.getSize()));
+        DAWINFO_CHECK (mapsMatch (l.sink.mirror.getMap(), l.builder.getMap()));
+
+        bad = {};
+        bad.isLooping = true;
+        bad.loopEndPpq = std::numeric_limits<double>::infinity();
+        w.reset();
+        schema::Codec<messages::TempoHeader>::write (w, bad);
+        DAWINFO_CHECK (! l.sink.mirror.handlePacket (w.getData(), w.getSize()));
+
+        // So is a map out of order, once it is complete.
+        TempoMapHeader full;
+        full.version = 9;
+        full.numSegments = 2;
+        TempoSegment later, earlier;
+        later.startPpq = 8.0;
+        w.reset();
+        w.beginBundle();
+        schema::Codec<messages::TempoHeader>::write (w, full);
+        schema::Codec<messages::TempoSegment>::write (w, later);
+        schema::Codec<messages::TempoSegment>::write (w, earlier);
+        DAWINFO_CHECK (! l.sink.mirror.handlePacket (w.getData(), w.getSize()));
+        DAWINFO_CHECK (l.sink.mirror.getVersion() == 3 && l.sink.mirror.needsFullSync());
+        DAWINFO_CHECK (mapsMatch (l.sink.mirror.getMap(), l.builder.getMap()));
+    }
+
+    void testLostFullSyncPartNeedsFullSync()
+    {
+        Script script;
+        script.bpmAt = [] (double ppq) { return 100.0 + 10.0 * std::fmod (std::floor (ppq / 4.0), 5.0); };
+        const auto run = play (script, 60.0);
+
+        TempoMapBuilder::Options small;
+        small.maxPacketSize = 512;
+        TempoMapBuilder builder (small);
+        StreamSequencer seq;
+        MirrorSink sink;
+
+        auto learn = [&] (std::size_t from, std::size_t to)
+        {
+            for (auto i = from; i < to; ++i)
+            {
+                builder.observe (run.blocks[i]);
+                builder.publish (sink, seq);
+            }
+        };
+
+        const auto half = run.blocks.size() / 2;
+        learn (0, half);
+        DAWINFO_CHECK (mapsMatch (sink.mirror.getMap(), builder.getMap()));
+
+        // The first part of a multi-part full map goes missing.
+        const auto version = builder.getVersion();
+        const auto before = sink.packets;
+        sink.dropNext = 1;
+        builder.requestFullSync();
+        builder.publish (sink, seq);
+        DAWINFO_CHECK (sink.packets > before + 2 && sink.mirror.getVersion() == version);
+
+        // The next incremental update gives the open map up.
+        learn (half, run.blocks.size());
+        DAWINFO_CHECK (builder.getVersion() > version + 1);
+        DAWINFO_CHECK (sink.mirror.needsFullSync() && sink.mirror.getVersion() == version);
+
+        builder.requestFullSync();
+        builder.publish (sink, seq);
+        DAWINFO_CHECK (! sink.mirror.needsFullSync() && sink.mirror.getVersion() == builder.getVersion());
+        DAWINFO_CHECK (mapsMatch (sink.mirror.getMap(), builder.getMap()));
+    }
+}
+
+int main()
+{
+    testSegmentMaths();
+    testConstantAndRamp();
+    testMeterChange();
+    testLoopWithTempoChange();
+    testIncrementalUpdates();
+    testLostUpdateNeedsFullSync();
+    testLostFullSyncPartNeedsFullSync();
+    return dawinfo::test::finish ("TempoMapTests");
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdio>
+
+/*  Minimal assertion helpers shared by the test executables. Each test file
+    is its own executable; main() returns the failure count so ctest picks it
+    up without pulling in a framework.
+*/
+namespace dawinfo::test
+{
+    inline int& failureCount() { static int count = 0; return count; }
+
+    inline int finish (const char* suiteName)
+    {
+        if (failureCount() == 0)
+            std::printf ("%s: all checks passed\n", suiteName);
+        else
+            std::printf ("%s: %d check(s) FAILED\n", suiteName, failureCount());
+
+        return failureCount() == 0 ? 0 : 1;
+    }
+}
+
+#define DAWINFO_CHECK(cond) \
+    do { if (! (cond)) { ++dawinfo::test::failureCount(); \
+         std::printf ("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); } } while (false)
+
+#define DAWINFO_CHECK_NEAR(a, b, tol) \
+    do { const double va_ = (a), vb_ = (b); \
+         if (! (va_ - vb_ <= (tol) && vb_ - va_ <= (tol))) { ++dawinfo::test::failureCount(); \
+         std::printf ("%s:%d: check failed: %s == %s (%g vs %g, tol %g)\n", \
+                      __FILE__, __LINE__, #a, #b, va_, vb_, static_cast<double> (tol)); } } while (false)
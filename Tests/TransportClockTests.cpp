@@ -0,0 +1,281 @@
+#include "Receiver/TransportClock.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    constexpr double bpm = 120.0;
+    constexpr double beatsPerSecond = bpm / 60.0;
+    constexpr HostTimeNs blockNs = 512 * 1000000000LL / 48000;
+    constexpr HostTimeNs frameNs = 1000000000LL / 120;
+
+    TransportSnapshot playingAt (HostTimeNs t, double ppq)
+    {
+        TransportSnapshot s;
+        s.timeNs = t;
+        s.ppq = ppq;
+        s.bpm = bpm;
+        s.isPlaying = true;
+        return s;
+    }
+
+    struct PhaseStats
+    {
+        double rmsError = 0.0;
+        double maxError = 0.0;
+        double maxStepDeviation = 0.0;  // relative to the ideal per-frame advance
+        int backwardSteps = 0;
+    };
+
+    /** Runs a 20 s simulated link and samples the clock at 120 fps. Arrival
+        time is used as the snapshot time, as a real receiver would.
+    */
+    template <typename Sampler>
+    PhaseStats simulate (double lossRate, HostTimeNs maxJitterNs, Sampler&& sample)
+    {
+        std::mt19937 rng (1234);
+        std::uniform_real_distribution<double> unit (0.0, 1.0);
+
+        constexpr HostTimeNs baseLatencyNs = 2000000;
+        const HostTimeNs meanLatencyNs = baseLatencyNs + maxJitterNs / 2;
+        const HostTimeNs endNs = 20LL * 1000000000LL;
+
+        PhaseStats stats;
+        double sumSquares = 0.0;
+        int frames = 0;
+        double previous = 0.0;
+
+        HostTimeNs nextSend = 0, nextFrame = frameNs * 30;
+
+        auto feed = [&] (HostTimeNs until, auto& onPacket)
+        {
+            while (nextSend <= until)
+            {
+                if (unit (rng) >= lossRate)
+                {
+                    const auto arrival = nextSend + baseLatencyNs
+                                       + static_cast<HostTimeNs> (unit (rng) * static_cast<double> (maxJitterNs));
+                    onPacket (playingAt (arrival, static_cast<double> (nextSend) * 1.0e-9 * beatsPerSecond));
+                }
+                nextSend += blockNs;
+            }
+        };
+
+        for (; nextFrame < endNs; nextFrame += frameNs)
+        {
+            const double ppq = sample (nextFrame, feed);
+            const double truth = static_cast<double> (nextFrame - meanLatencyNs) * 1.0e-9 * beatsPerSecond;
+            const double error = ppq - truth;
+
+            sumSquares += error * error;
+            stats.maxError = std::max (stats.maxError, std::abs (error));
+
+            if (frames > 0)
+            {
+                const double ideal = beatsPerSecond / 120.0;
+                const double step = ppq - previous;
+                stats.maxStepDeviation = std::max (stats.maxStepDeviation, std::abs (step - ideal) / ideal);
+                stats.backwardSteps += step < 0.0 ? 1 : 0;
+            }
+
+            previous = ppq;
+            ++frames;
+        }
+
+        stats.rmsError = std::sqrt (sumSquares / frames);
+        return stats;
+    }
+
+    void print (const char* name, const PhaseStats& s)
+    {
+        std::printf ("  %-24s rms %.5f beats  max %.5f beats  max step deviation %5.1f%%  backward %d\n",
+                     name, s.rmsError, s.maxError, s.maxStepDeviation * 100.0, s.backwardSteps);
+    }
+
+    //==============================================================================
+    void testJitterAndLoss()
+    {
+        constexpr double lossRate = 0.1;
+        constexpr HostTimeNs jitterNs = 6000000;
+
+        std::printf ("Phase error, 10%% loss, 6 ms jitter, 120 fps sampling:\n");
+
+        // Packets are held until their arrival time, so both receivers below
+        // see exactly the same stream.
+        std::vector<TransportSnapshot> inFlight;
+
+        auto runReceiver = [&] (auto&& onSnapshot, auto&& query)
+        {
+            inFlight.clear();
+            return simulate (lossRate, jitterNs, [&] (HostTimeNs now, auto& feed)
+            {
+                auto onPacket = [&] (const TransportSnapshot& s) { inFlight.push_back (s); };
+                feed (now, onPacket);
+
+                std::size_t kept = 0;
+                for (auto& s : inFlight)
+                {
+                    if (s.timeNs <= now)
+                        onSnapshot (s);
+                    else
+                        inFlight[kept++] = s;
+                }
+                inFlight.resize (kept);
+                return query (now);
+            });
+        };
+
+        // Naive receiver: extrapolate from whichever packet arrived last.
+        TransportSnapshot latest;
+        bool haveLatest = false;
+        auto extrapolating = runReceiver ([&] (const TransportSnapshot& s) { latest = s; haveLatest = true; },
+                                          [&] (HostTimeNs now)
+                                          {
+                                              return haveLatest ? latest.ppq + static_cast<double> (now - latest.timeNs) * 1.0e-9 * beatsPerSecond
+                                                                : 0.0;
+                                          });
+
+        TransportClock clock;
+        auto modelled = runReceiver ([&] (const TransportSnapshot& s) { clock.update (s); },
+                                     [&] (HostTimeNs now) { return clock.ppqAt (now); });
+
+        print ("naive extrapolation", extrapolating);
+        print ("TransportClock", modelled);
+        std::printf ("  clock: %llu updates, %llu snaps\n",
+                     static_cast<unsigned long long> (clock.getStats().updates),
+                     static_cast<unsigned long long> (clock.getStats().snaps));
+
+        DAWINFO_CHECK (modelled.rmsError < 0.002);
+        DAWINFO_CHECK (modelled.maxError < 0.005);
+        DAWINFO_CHECK (modelled.backwardSteps == 0);
+        DAWINFO_CHECK (modelled.maxStepDeviation <= 0.051);
+        DAWINFO_CHECK (modelled.maxStepDeviation < extrapolating.maxStepDeviation / 4.0);
+        DAWINFO_CHECK (clock.getStats().snaps == 1);
+    }
+
+    void testSeekSnaps()
+    {
+        TransportClock clock;
+        clock.update (playingAt (0, 0.0));
+        clock.update (playingAt (blockNs, beatsPerSecond * blockNs * 1.0e-9));
+
+        // A jump of several bars is a seek, not jitter.
+        DAWINFO_CHECK (clock.update (playingAt (2 * blockNs, 32.0)));
+        DAWINFO_CHECK_NEAR (clock.ppqAt (2 * blockNs), 32.0, 1.0e-9);
+        DAWINFO_CHECK_NEAR (clock.getRateCorrection(), 0.0, 1.0e-12);
+    }
+
+    void testSmallErrorSlews()
+    {
+        TransportClock clock;
+        clock.update (playingAt (0, 0.0));
+
+        // The snapshot says we are 0.02 beats ahead of the prediction.
+        const HostTimeNs t = 100000000;
+        const double expected = beatsPerSecond * 0.1;
+        DAWINFO_CHECK (! clock.update (playingAt (t, expected + 0.02)));
+
+        // No jump at the moment of the update...
+        DAWINFO_CHECK_NEAR (clock.ppqAt (t), expected, 1.0e-9);
+        DAWINFO_CHECK (clock.getRateCorrection() > 0.0);
+
+        // ...and the error is absorbed after the slew window.
+        const HostTimeNs later = t + 250000000;
+        DAWINFO_CHECK_NEAR (clock.ppqAt (later), expected + 0.02 + beatsPerSecond * 0.25, 1.0e-6);
+
+        // With no further snapshot the clock runs at the nominal tempo rather
+        // than carrying the correction on and overshooting.
+        const HostTimeNs muchLater = t + 2000000000;
+        DAWINFO_CHECK_NEAR (clock.ppqAt (muchLater), expected + 0.02 + beatsPerSecond * 2.0, 1.0e-6);
+    }
+
+    void testLoopWrapDoesNotSnap()
+    {
+        TransportClock clock;
+        auto s = playingAt (0, 7.9);
+        s.isLooping = true;
+        s.loopStartPpq = 4.0;
+        s.loopEndPpq = 8.0;
+        clock.update (s);
+
+        // Extrapolation wraps at the loop end.
+        DAWINFO_CHECK_NEAR (clock.ppqAt (100000000), 4.1, 1.0e-9);
+
+        // The sender reports the wrapped position; that is consistent.
+        auto wrapped = s;
+        wrapped.timeNs = 100000000;
+        wrapped.ppq = 4.1;
+        DAWINFO_CHECK (! clock.update (wrapped));
+        DAWINFO_CHECK_NEAR (clock.getStats().lastErrorBeats, 0.0, 1.0e-9);
+
+        // Turning the loop off mid-flight and jumping away does snap.
+        auto jumped = wrapped;
+        jumped.timeNs = 200000000;
+        jumped.isLooping = false;
+        jumped.ppq = 12.0;
+        DAWINFO_CHECK (clock.update (jumped));
+    }
+
+    void testStopHoldsPosition()
+    {
+        TransportClock clock;
+        clock.update (playingAt (0, 1.0));
+
+        auto stopped = playingAt (blockNs, 1.5);
+        stopped.isPlaying = false;
+        DAWINFO_CHECK (clock.update (stopped));
+        DAWINFO_CHECK_NEAR (clock.ppqAt (blockNs * 100), 1.5, 1.0e-12);
+        DAWINFO_CHECK (! clock.positionAt (blockNs * 100).isPlaying);
+    }
+
+    void testBarAndBeat()
+    {
+        TransportClock clock;
+        auto s = playingAt (0, 9.0);
+        s.timeSigNumerator = 6;
+        s.timeSigDenominator = 8;   // 3 quarter notes per bar
+        s.barStartPpq = 9.0;
+        s.barNumber = 3;
+        clock.update (s);
+
+        // 0.5 s at 2 beats/s is one quarter note: two eighths into bar 3.
+        const auto p = clock.positionAt (500000000);
+        DAWINFO_CHECK_NEAR (p.ppq, 10.0, 1.0e-9);
+        DAWINFO_CHECK (p.bar == 3);
+        DAWINFO_CHECK (p.beat == 2);
+        DAWINFO_CHECK_NEAR (p.beatFraction, 0.0, 1.0e-9);
+
+        // Two seconds later we are one bar and one quarter further on.
+        const auto q = clock.positionAt (2000000000);
+        DAWINFO_CHECK (q.bar == 4);
+        DAWINFO_CHECK (q.beat == 2);
+    }
+
+    void testStaleSnapshotIgnored()
+    {
+        TransportClock clock;
+        clock.update (playingAt (blockNs, 0.5));
+        DAWINFO_CHECK (! clock.update (playingAt (0, 0.0)));
+        DAWINFO_CHECK (clock.getStats().staleDropped == 1);
+        DAWINFO_CHECK_NEAR (clock.ppqAt (blockNs), 0.5, 1.0e-12);
+    }
+}
+
+int main()
+{
+    testJitterAndLoss();
+    testSeekSnaps();
+    testSmallErrorSlews();
+    testLoopWrapDoesNotSnap();
+    testStopHoldsPosition();
+    testBarAndBeat();
+    testStaleSnapshotIgnored();
+    return dawinfo::test::finish ("TransportClockTests");
+}
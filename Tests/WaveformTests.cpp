@@ -0,0 +1,337 @@
+#include "AllocationCounter.h"
+#include "Common/Clock.h"
+#include "Sender/WaveformPublisher.h"
+#include "TestHarness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace dawinfo;
+
+namespace
+{
+    struct SummarySink : PacketSink
+    {
+        struct Summary
+        {
+            peaks::SummaryHeader header;
+            std::vector<PeakBin> bins;
+        };
+
+        std::vector<Summary> summaries;
+        std::size_t packets = 0, bytes = 0, largestPacket = 0;
+
+        bool send (const std::uint8_t* data, std::size_t size) override
+        {
+            ++packets;
+            bytes += size;
+            largestPacket = std::max (largestPacket, size);
+
+            forEachOscMessage (data, size, [&] (const OscMessage& m)
+            {
+                Summary s;
+                const std::uint8_t* packed = nullptr;
+
+                if (! peaks::decodeSummary (m, s.header, packed))
+                    return;
+
+                const auto n = static_cast<std::size_t> (s.header.numBins * s.header.numChannels);
+
+                for (std::size_t i = 0; i < n; ++i)
+                    s.bins.push_back (peaks::unpack (packed, i));
+
+                summaries.push_back (std::move (s));
+            });
+
+            return true;
+        }
+    };
+
+    /** A stereo test signal: noise bursts over a decaying tone. */
+    std::vector<std::vector<float>> makeSignal (int numSamples)
+    {
+        std::vector<std::vector<float>> channels (2, std::vector<float> (static_cast<std::size_t> (numSamples)));
+        std::mt19937 rng (3);
+        std::uniform_real_distribution<float> noise (-1.0f, 1.0f);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float envelope = std::exp (-static_cast<float> (i % 24000) / 8000.0f);
+            const float tone = 0.8f * envelope * std::sin (static_cast<float> (i) * 0.05f);
+            channels[0][static_cast<std::size_t> (i)] = tone + ((i / 4800) % 3 == 0 ? 0.1f * noise (rng) : 0.0f);
+            channels[1][static_cast<std::size_t> (i)] = -0.5f * tone;
+        }
+
+        return channels;
+    }
+
+    void pushSignal (WaveformPublisher& publisher, const std::vector<std::vector<float>>& signal,
+                     int blockSize, int start, int end)
+    {
+        for (int pos = start; pos < end; pos += blockSize)
+        {
+            const float* channels[] = { signal[0].data() + pos, signal[1].data() + pos };
+            publisher.pushBlock (channels, 2, std::min (blockSize, end - pos));
+            publisher.update();
+        }
+    }
+
+    PeakBin bruteForce (const std::vector<float>& samples, std::int64_t first, std::int64_t count)
+    {
+        const auto begin = samples.begin() + first;
+        const auto range = std::minmax_element (begin, begin + count);
+        return { *range.first, *range.second };
+    }
+
+    void testPyramidMatchesBruteForce()
+    {
+        constexpr int samplesPerBin = 64, numLevels = 8;
+        const auto signal = makeSignal (48000 * 3);
+        WaveformPublisher publisher (2, samplesPerBin, numLevels, 1024);
+        publisher.prepare();
+
+        // An odd block size so bins straddle blocks.
+        pushSignal (publisher, signal, 441, 0, 48000 * 3);
+
+        const auto& pyramid = publisher.getPyramid();
+        DAWINFO_CHECK (pyramid.getEnd (0) == 48000 * 3 / samplesPerBin);
+        DAWINFO_CHECK (pyramid.getBegin (0) == pyramid.getEnd (0) - 1024);     // older bins have rolled off
+        int mismatches = 0;
+
+        for (int level = 0; level < numLevels; ++level)
+        {
+            DAWINFO_CHECK (pyramid.getEnd (level) == pyramid.getEnd (0) >> level);
+            const std::int64_t width = std::int64_t (samplesPerBin) << level;
+
+            for (auto i = pyramid.getBegin (level); i < pyramid.getEnd (level); ++i)
+            {
+                for (int c = 0; c < 2; ++c)
+                {
+                    const auto expected = bruteForce (signal[static_cast<std::size_t> (c)], i * width, width);
+                    const auto& actual = pyramid.getBin (level, i)[c];
+                    mismatches += expected.min == actual.min && expected.max == actual.max ? 0 : 1;
+                }
+            }
+        }
+
+        DAWINFO_CHECK (mismatches == 0);
+    }
+
+    /** Nothing is allocated until prepare(), and blocks before it are dropped. */
+    void testLazyStorage()
+    {
+        const auto signal = makeSignal (48000);
+        StreamSequencer seq;
+        SummarySink sink;
+        std::uint64_t constructing = 0;
+
+        {
+            test::ScopedAllocationCount counting;
+            WaveformPublisher publisher (2);
+            constructing = test::allocationCount();
+
+            publisher.setLiveLevel (0);
+            pushSignal (publisher, signal, 512, 0, 4096);
+            DAWINFO_CHECK (publisher.publish (sink, seq) == 0 && publisher.answer ({ 0, -1, 64 }, sink, seq) == 0);
+            DAWINFO_CHECK (publisher.getStats().bins == 0 && sink.packets == 0);
+            DAWINFO_CHECK (test::allocationCount() == constructing);
+        }
+
+        // The pyramid's counters are all there is.
+        DAWINFO_CHECK (constructing == 1);
+
+        WaveformPublisher publisher (2);
+        publisher.prepare();
+        publisher.prepare();
+        publisher.setLiveLevel (0);
+        pushSignal (publisher, signal, 512, 0, 4096);
+        DAWINFO_CHECK (publisher.getStats().bins == 4096 / 64);
+        DAWINFO_CHECK (publisher.publish (sink, seq) > 0 && sink.packets > 0);
+    }
+
+    void testRequests()
+    {
+        const auto signal = makeSignal (48000 * 2);
+        WaveformPublisher publisher (2);
+        publisher.prepare();
+        StreamSequencer seq;
+        SummarySink sink;
+
+        pushSignal (publisher, signal, 512, 0, 48000 * 2);
+
+        // The request message itself round-trips.
+        std::uint8_t message[64];
+        OscWriter w (message, sizeof (message));
+        peaks::writeRequest (w, { 2, -1, 300 });
+        OscMessage m;
+        peaks::Request request;
+        DAWINFO_CHECK (parseOscMessage (w.getData(), w.getSize(), m) && peaks::decodeRequest (m, request));
+        DAWINFO_CHECK (request.level == 2 && request.firstBin == -1 && request.numBins == 300);
+
+        // The most recent 300 bins at level 2, split across packets.
+        DAWINFO_CHECK (publisher.answer (request, sink, seq) == sink.bytes);
+        DAWINFO_CHECK (sink.largestPacket <= 1400);
+        DAWINFO_CHECK (sink.packets == sink.summaries.size() && sink.packets > 1);
+        DAWINFO_CHECK (seq.peek (StreamId::control) == sink.packets && seq.peek (StreamId::waveform) == 0);
+
+        const auto& pyramid = publisher.getPyramid();
+        auto expectedFirst = pyramid.getEnd (2) - 300;
+        int received = 0, understated = 0, coarse = 0;
+
+        for (auto& s : sink.summaries)
+        {
+            DAWINFO_CHECK (s.header.level == 2 && s.header.numChannels == 2);
+            DAWINFO_CHECK (s.header.firstBin == expectedFirst);
+            expectedFirst += s.header.numBins;
+            received += s.header.numBins;
+
+            for (std::size_t i = 0; i < s.bins.size(); ++i)
+            {
+                const auto& exact = pyramid.getBin (2, s.header.firstBin + static_cast<std::int64_t> (i / 2))[i % 2];
+                understated += s.bins[i].min <= exact.min && s.bins[i].max >= exact.max ? 0 : 1;
+                coarse += exact.min - s.bins[i].min < 1.0f / 127 + 1.0e-6f && s.bins[i].max - exact.max < 1.0f / 127 + 1.0e-6f ? 0 : 1;
+            }
+        }
+
+        DAWINFO_CHECK (received == 300);
+        DAWINFO_CHECK (understated == 0 && coarse == 0);
+
+        // Ranges are clipped to what is held; nonsense gets nothing.
+        sink.summaries.clear();
+        publisher.answer ({ 4, pyramid.getEnd (4) - 10, 100 }, sink, seq);
+        DAWINFO_CHECK (sink.summaries.size() == 1 && sink.summaries[0].header.numBins == 10);
+        DAWINFO_CHECK (publisher.answer ({ 40, 0, 10 }, sink, seq) == 0);
+        DAWINFO_CHECK (publisher.answer ({ 0, pyramid.getEnd (0), 10 }, sink, seq) == 0);
+        DAWINFO_CHECK (publisher.answer ({ 0, std::numeric_limits<std::int64_t>::max() - 5, 10 }, sink, seq) == 0);
+
+        // A packet size too small for one bin sends nothing rather than cut-off summaries.
+        WaveformPublisher tiny (2, 64, 12, 1024, 48);
+        tiny.prepare();
+        pushSignal (tiny, signal, 512, 0, 4096);
+        SummarySink tinySink;
+        DAWINFO_CHECK (tiny.answer ({ 0, -1, 10 }, tinySink, seq) == 0 && tinySink.packets == 0);
+    }
+
+    void testLiveLevel()
+    {
+        const auto signal = makeSignal (48000 * 2);
+        WaveformPublisher publisher (2);
+        publisher.prepare();
+        StreamSequencer seq;
+        SummarySink sink;
+
+        pushSignal (publisher, signal, 512, 0, 48000);
+        publisher.setLiveLevel (3);
+        const auto start = publisher.getPyramid().getEnd (3);
+
+        for (int pos = 48000; pos < 48000 * 2; pos += 512)
+        {
+            pushSignal (publisher, signal, 512, pos, std::min (pos + 512, 48000 * 2));
+            publisher.publish (sink, seq);
+        }
+
+        // Contiguous, no gaps or repeats.
+        auto next = start;
+
+        for (auto& s : sink.summaries)
+        {
+            DAWINFO_CHECK (s.header.level == 3 && s.header.firstBin == next);
+            next += s.header.numBins;
+        }
+
+        DAWINFO_CHECK (next == publisher.getPyramid().getEnd (3));
+        DAWINFO_CHECK (next > start);
+    }
+
+    /** Per-block cost on both threads, and bandwidth by zoom level. */
+    void benchmark()
+    {
+        constexpr int blockSize = 512;
+        constexpr double sampleRate = 48000.0;
+        const int numSamples = 48000 * 60;
+        const auto signal = makeSignal (numSamples);
+        const int numBlocks = numSamples / blockSize;
+
+        WaveformPublisher publisher (2);
+        publisher.prepare();
+        HostTimeNs pushNs = 0, updateNs = 0;
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            const float* channels[] = { signal[0].data() + b * blockSize, signal[1].data() + b * blockSize };
+
+            const auto t0 = monotonicNowNs();
+            publisher.pushBlock (channels, 2, blockSize);
+            const auto t1 = monotonicNowNs();
+            publisher.update();
+            const auto t2 = monotonicNowNs();
+
+            pushNs += t1 - t0;
+            updateNs += t2 - t1;
+        }
+
+        const double blockNs = blockSize * 1.0e9 / sampleRate;
+        const double pushPerBlock = static_cast<double> (pushNs) / numBlocks;
+        const double updatePerBlock = static_cast<double> (updateNs) / numBlocks;
+
+        std::printf ("Per %d-sample stereo block: audio thread %.0f ns (%.3f%% of the block), sender thread %.0f ns\n",
+                     blockSize, pushPerBlock, 100.0 * pushPerBlock / blockNs, updatePerBlock);
+
+        // Timing is reported, not checked: metering/peak_block_stereo_512
+        // in the benchmarks tracks it against the baseline.
+        DAWINFO_CHECK (publisher.getStats().ringOverflows == 0);
+
+        // Live bandwidth: publish at about 47 Hz (every other block) for 10 s.
+        const double rawBytesPerSecond = sampleRate * 2 * sizeof (float);
+        std::printf ("Raw stereo float PCM: %.1f KB/s\n", rawBytesPerSecond / 1024.0);
+
+        for (const int level : { 0, 2, 4, 6, 8, 10 })
+        {
+            WaveformPublisher live (2);
+            live.prepare();
+            StreamSequencer seq;
+            SummarySink sink;
+            live.setLiveLevel (level);
+            const int liveBlocks = static_cast<int> (10.0 * sampleRate / blockSize);
+
+            for (int b = 0; b < liveBlocks; ++b)
+            {
+                const float* channels[] = { signal[0].data() + b * blockSize, signal[1].data() + b * blockSize };
+                live.pushBlock (channels, 2, blockSize);
+
+                if (b % 2 == 1)
+                    live.publish (sink, seq);
+            }
+
+            // A full screen of history at this zoom.
+            SummarySink screen;
+            live.answer ({ level, -1, 1024 }, screen, seq);
+            std::int64_t screenBins = 0;
+
+            for (auto& s : screen.summaries)
+                screenBins += s.header.numBins;
+
+            const double secondsPerBin = (64 << level) / sampleRate;
+            std::printf ("    level %2d (%7.2f ms/bin): live %7.2f KB/s in %5.1f packets/s, "
+                         "%4lld-bin screen %6zu bytes in %zu packets\n",
+                         level, secondsPerBin * 1000.0, sink.bytes / 10.0 / 1024.0, sink.packets / 10.0,
+                         static_cast<long long> (screenBins), screen.bytes, screen.packets);
+
+            DAWINFO_CHECK (sink.bytes / 10.0 < rawBytesPerSecond / 10.0);
+        }
+    }
+}
+
+int main()
+{
+    testPyramidMatchesBruteForce();
+    testLazyStorage();
+    testRequests();
+    testLiveLevel();
+    benchmark();
+    return dawinfo::test::finish ("WaveformTests");
+}
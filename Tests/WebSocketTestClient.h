@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Common/WebSocket.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace dawinfo::test
+{
+
+/**
+    A minimal blocking WebSocket client for tests: connects to localhost,
+    upgrades with the RFC 6455 example key, and reads whole frames. A small
+    receive buffer makes it easy to stand in for a slow browser.
+*/
+class WebSocketTestClient
+{
+public:
+    static constexpr const char* exampleKey = "dGhlIHNhbXBsZSBub25jZQ==";
+    static constexpr const char* exampleAccept = "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=";
+
+    WebSocketTestClient() = default;
+    ~WebSocketTestClient()      { close(); }
+
+    WebSocketTestClient (const WebSocketTestClient&) = delete;
+    WebSocketTestClient& operator= (const WebSocketTestClient&) = delete;
+
+    /** Connects and upgrades. receiveBuffer > 0 shrinks the socket's buffer first. */
+    bool connect (int port, int receiveBuffer = 0)
+    {
+        if (! open (port, receiveBuffer))
+            return false;
+
+        const std::string request = "GET /dawinfo HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+                                    "Connection: Upgrade\r\nSec-WebSocket-Key: " + std::string (exampleKey)
+                                  + "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+        return sendRaw (request.data(), request.size()) && readResponse();
+    }
+
+    /** Just the TCP connection, for writing a handshake by hand. */
+    bool open (int port, int receiveBuffer = 0)
+    {
+        fd = ::socket (AF_INET, SOCK_STREAM, 0);
+
+        if (fd < 0)
+            return false;
+
+        if (receiveBuffer > 0)
+            ::setsockopt (fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof (receiveBuffer));
+
+        sockaddr_in to {};
+        to.sin_family = AF_INET;
+        to.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+        to.sin_port = htons (static_cast<std::uint16_t> (port));
+
+        return ::connect (fd, reinterpret_cast<const sockaddr*> (&to), sizeof (to)) == 0;
+    }
+
+    void close()
+    {
+        if (fd >= 0)
+            ::close (fd);
+
+        fd = -1;
+    }
+
+    int getFd() const noexcept          { return fd; }
+    const std::string& getResponse() const noexcept     { return response; }
+
+    bool sendRaw (const void* data, std::size_t size)
+    {
+        return ::send (fd, data, size, MSG_NOSIGNAL) == static_cast<ssize_t> (size);
+    }
+
+    /** A masked frame, as browsers send. */
+    bool sendFrame (websocket::Opcode opcode, const std::string& payload)
+    {
+        websocket::FrameHeader h;
+        h.opcode = opcode;
+        h.masked = true;
+        h.mask = { 0x12, 0x34, 0x56, 0x78 };
+        h.payloadSize = payload.size();
+
+        std::vector<std::uint8_t> frame (websocket::maxHeaderSize);
+        frame.resize (websocket::writeFrameHeader (frame.data(), h));
+        frame.insert (frame.end(), payload.begin(), payload.end());
+        websocket::applyMask (frame.data() + frame.size() - payload.size(), payload.size(), h.mask);
+        return sendRaw (frame.data(), frame.size());
+    }
+
+    /** Waits up to timeoutMs for a whole frame. */
+    bool receiveFrame (websocket::FrameHeader& header, std::vector<std::uint8_t>& payload, int timeoutMs)
+    {
+        for (;;)
+        {
+            const int headerSize = websocket::parseFrameHeader (buffer.data(), buffer.size(), header);
+
+            if (headerSize < 0)
+                return false;
+
+            if (headerSize > 0 && buffer.size() >= headerSize + header.payloadSize)
+            {
+                payload.assign (buffer.begin() + headerSize, buffer.begin() + headerSize + static_cast<std::ptrdiff_t> (header.payloadSize));
+                buffer.erase (buffer.begin(), buffer.begin() + headerSize + static_cast<std::ptrdiff_t> (header.payloadSize));
+                return true;
+            }
+
+            if (! readMore (timeoutMs))
+                return false;
+        }
+    }
+
+    /** Reads whatever has arrived without waiting; false once the connection is gone. */
+    bool readMore (int timeoutMs)
+    {
+        pollfd p { fd, POLLIN, 0 };
+
+        if (::poll (&p, 1, timeoutMs) <= 0)
+            return false;
+
+        std::uint8_t chunk[65536];
+        const auto n = ::recv (fd, chunk, sizeof (chunk), 0);
+
+        if (n <= 0)
+            return false;
+
+        buffer.insert (buffer.end(), chunk, chunk + n);
+        return true;
+    }
+
+    /** Reads the server's HTTP response; true if it accepted the upgrade. */
+    bool readResponse()
+    {
+        while (response.find ("\r\n\r\n") == std::string::npos)
+        {
+            char chunk[512];
+            pollfd p { fd, POLLIN, 0 };
+
+            if (::poll (&p, 1, 2000) <= 0)
+                return false;
+
+            const auto n = ::recv (fd, chunk, sizeof (chunk), 0);
+
+            if (n <= 0)
+                return false;
+
+            response.append (chunk, static_cast<std::size_t> (n));
+        }
+
+        // Frames may follow the response in the same read.
+        const auto end = response.find ("\r\n\r\n") + 4;
+        buffer.assign (response.begin() + static_cast<std::ptrdiff_t> (end), response.end());
+        response.resize (end);
+
+        return response.rfind ("HTTP/1.1 101", 0) == 0
+            && websocket::findHeader (response, "Sec-WebSocket-Accept") == exampleAccept;
+    }
+
+private:
+    int fd = -1;
+    std::string response;
+    std::vector<std::uint8_t> buffer;
+};
+
+} // namespace dawinfo::test
@@ -0,0 +1,589 @@
+#include "Common/Clock.h"
+#include "Common/Config.h"
+#include "Common/Messages.h"
+#include "Sender/StreamSequencer.h"
+#include "Sender/WebSocketServer.h"
+#include "TestHarness.h"
+#include "WebSocketTestClient.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace dawinfo;
+using test::WebSocketTestClient;
+
+namespace
+{
+    template <typename Predicate>
+    bool waitFor (Predicate done, int timeoutMs = 2000)
+    {
+        for (int waited = 0; waited < timeoutMs; ++waited)
+        {
+            if (done())
+                return true;
+
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        }
+
+        return done();
+    }
+
+    /** A packet whose first bytes are its index and the time it was sent. */
+    std::vector<std::uint8_t> makePacket (std::uint32_t index, std::size_t size)
+    {
+        std::vector<std::uint8_t> packet (std::max<std::size_t> (size, 12), 0x5a);
+        const auto sentNs = monotonicNowNs();
+        std::memcpy (packet.data(), &index, 4);
+        std::memcpy (packet.data() + 4, &sentNs, 8);
+        return packet;
+    }
+
+    std::uint32_t packetIndex (const std::vector<std::uint8_t>& payload)
+    {
+        std::uint32_t index = 0;
+        std::memcpy (&index, payload.data(), 4);
+        return index;
+    }
+
+    HostTimeNs packetSentNs (const std::vector<std::uint8_t>& payload)
+    {
+        HostTimeNs sentNs = 0;
+        std::memcpy (&sentNs, payload.data() + 4, 8);
+        return sentNs;
+    }
+
+    void testProtocolHelpers()
+    {
+        const auto digest = websocket::sha1 ("abc", 3);
+        const std::uint8_t expected[] = { 0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+                                          0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d };
+        DAWINFO_CHECK (std::memcmp (digest.data(), expected, 20) == 0);
+
+        // Crosses a block boundary with the padding.
+        const std::string longer (60, 'a');
+        DAWINFO_CHECK (websocket::base64 (websocket::sha1 (longer.data(), longer.size()).data(), 20)
+                        == "E9lWAz2a9Em/4sTveMF8IEacS/E=");
+
+        const std::uint8_t bytes[] = { 'f', 'o', 'o', 'b', 'a' };
+        DAWINFO_CHECK (websocket::base64 (bytes, 3) == "Zm9v");
+        DAWINFO_CHECK (websocket::base64 (bytes, 4) == "Zm9vYg==");
+        DAWINFO_CHECK (websocket::base64 (bytes, 5) == "Zm9vYmE=");
+
+        // The example in RFC 6455.
+        DAWINFO_CHECK (websocket::acceptKey (WebSocketTestClient::exampleKey) == WebSocketTestClient::exampleAccept);
+
+        for (const std::uint64_t size : { 0ull, 125ull, 126ull, 65535ull, 65536ull, 1ull << 33 })
+        {
+            websocket::FrameHeader h, back;
+            h.masked = size % 2 == 0;
+            h.mask = { 1, 2, 3, 4 };
+            h.payloadSize = size;
+
+            std::uint8_t buffer[websocket::maxHeaderSize];
+            const auto written = websocket::writeFrameHeader (buffer, h);
+            DAWINFO_CHECK (websocket::parseFrameHeader (buffer, written, back) == static_cast<int> (written));
+            DAWINFO_CHECK (back.payloadSize == size && back.masked == h.masked && back.opcode == websocket::binary);
+            DAWINFO_CHECK (! h.masked || back.mask == h.mask);
+            DAWINFO_CHECK (websocket::parseFrameHeader (buffer, written - 1, back) == 0);
+        }
+
+        const std::uint8_t reserved[] = { 0xc2, 0x00 };
+        const std::uint8_t longPing[] = { 0x89, 126, 0, 200 };
+        websocket::FrameHeader h;
+        DAWINFO_CHECK (websocket::parseFrameHeader (reserved, sizeof (reserved), h) < 0);
+        DAWINFO_CHECK (websocket::parseFrameHeader (longPing, sizeof (longPing), h) < 0);
+
+        const std::string request = "GET / HTTP/1.1\r\nHost: x\r\nsec-websocket-KEY:  abc \r\n\r\n";
+        DAWINFO_CHECK (websocket::findHeader (request, "Sec-WebSocket-Key") == "abc");
+        DAWINFO_CHECK (websocket::findHeader (request, "Upgrade").empty());
+    }
+
+    void testConfigKey()
+    {
+        SenderConfig c;
+        std::string error;
+        DAWINFO_CHECK (config::parse ("destinations =\nwebsocket.port = 8080\n", c, error) && c.websocketPort == 8080);
+
+        // A WebSocket port alone is somewhere to send.
+        DAWINFO_CHECK (config::validate (c, error));
+
+        SenderConfig again;
+        DAWINFO_CHECK (config::parse (config::format (c), again, error) && again.websocketPort == 8080);
+
+        DAWINFO_CHECK (! config::parse ("websocket.port = 70000", c, error));
+        DAWINFO_CHECK (config::parse ("websocket.port = 0", c, error) && ! config::validate (c, error));
+    }
+
+    void testDelivery()
+    {
+        WebSocketServer server;
+        DAWINFO_CHECK (server.start (0, true));
+
+        std::vector<std::unique_ptr<WebSocketTestClient>> clients;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            clients.push_back (std::make_unique<WebSocketTestClient>());
+            DAWINFO_CHECK (clients.back()->connect (server.getPort()));
+        }
+
+        DAWINFO_CHECK (waitFor ([&] { return server.getStats().clients == 3; }));
+
+        for (std::uint32_t i = 0; i < 5; ++i)
+        {
+            const auto packet = makePacket (i, 200 + i * 100);
+            DAWINFO_CHECK (server.send (packet.data(), packet.size()));
+            std::this_thread::sleep_for (std::chrono::milliseconds (2));
+        }
+
+        // Every client gets every packet, in order, as one binary frame each.
+        for (auto& c : clients)
+        {
+            for (std::uint32_t i = 0; i < 5; ++i)
+            {
+                websocket::FrameHeader h;
+                std::vector<std::uint8_t> payload;
+                DAWINFO_CHECK (c->receiveFrame (h, payload, 1000));
+                DAWINFO_CHECK (h.opcode == websocket::binary && ! h.masked && h.final);
+                DAWINFO_CHECK (payload.size() == 200 + i * 100 && packetIndex (payload) == i);
+            }
+        }
+
+        // Pings are answered with the same payload.
+        websocket::FrameHeader h;
+        std::vector<std::uint8_t> payload;
+        DAWINFO_CHECK (clients[0]->sendFrame (websocket::ping, "hello"));
+        DAWINFO_CHECK (clients[0]->receiveFrame (h, payload, 1000));
+        DAWINFO_CHECK (h.opcode == websocket::pong && std::string (payload.begin(), payload.end()) == "hello");
+
+        // Anything else a browser sends is ignored.
+        DAWINFO_CHECK (clients[0]->sendFrame (websocket::text, "{\"subscribe\":\"all\"}"));
+
+        // A close is echoed, then the connection ends.
+        DAWINFO_CHECK (clients[1]->sendFrame (websocket::close, std::string ("\x03\xe8", 2)));
+        DAWINFO_CHECK (clients[1]->receiveFrame (h, payload, 1000) && h.opcode == websocket::close);
+        DAWINFO_CHECK (! clients[1]->receiveFrame (h, payload, 1000));
+        DAWINFO_CHECK (waitFor ([&] { return server.getStats().clients == 2 && server.getStats().closed == 1; }));
+
+        // One that just goes away is noticed too.
+        clients[2]->close();
+        DAWINFO_CHECK (waitFor ([&] { return server.getStats().clients == 1; }));
+
+        const auto packet = makePacket (99, 64);
+        DAWINFO_CHECK (server.send (packet.data(), packet.size()));
+        DAWINFO_CHECK (clients[0]->receiveFrame (h, payload, 1000) && packetIndex (payload) == 99);
+
+        // Plain HTTP, and unmasked client frames, are refused.
+        WebSocketTestClient plain;
+        DAWINFO_CHECK (plain.open (server.getPort()));
+        const std::string get = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        DAWINFO_CHECK (plain.sendRaw (get.data(), get.size()));
+        DAWINFO_CHECK (! plain.readResponse() && plain.getResponse().rfind ("HTTP/1.1 400", 0) == 0);
+
+        const std::uint8_t unmasked[] = { 0x89, 0x00 };
+        DAWINFO_CHECK (clients[0]->sendRaw (unmasked, sizeof (unmasked)));
+        DAWINFO_CHECK (waitFor ([&] { return server.getStats().clients == 0; }));
+
+        const auto stats = server.getStats();
+        DAWINFO_CHECK (stats.accepted == 3 && stats.rejected == 1 && stats.framesDropped == 0);
+
+        // Too big for one UDP datagram, so not something the sender makes.
+        std::vector<std::uint8_t> huge (70000);
+        DAWINFO_CHECK (! server.send (huge.data(), huge.size()));
+
+        server.stop();
+        DAWINFO_CHECK (server.getPort() == 0);
+    }
+
+    /** Stopping straight after a send can leave a wake-up unread; frames
+        still reach clients after the restart.
+    */
+    void testRestart()
+    {
+        WebSocketServer server;
+
+        for (std::uint32_t round = 0; round < 5; ++round)
+        {
+            DAWINFO_CHECK (server.start (0, true));
+            WebSocketTestClient client;
+            DAWINFO_CHECK (client.connect (server.getPort()));
+            DAWINFO_CHECK (waitFor ([&] { return server.getStats().clients == 1; }));
+
+            const auto packet = makePacket (round, 64);
+            DAWINFO_CHECK (server.send (packet.data(), packet.size()));
+
+            if (round > 0)
+            {
+                websocket::FrameHeader h;
+                std::vector<std::uint8_t> payload;
+                DAWINFO_CHECK (client.receiveFrame (h, payload, 1000) && packetIndex (payload) == round);
+            }
+
+            server.stop();
+        }
+    }
+
+    /** A connection that never sends its upgrade request gives its slot up. */
+    void testHandshakeDeadline()
+    {
+        WebSocketServer::Options options;
+        options.maxClients = 1;
+        options.handshakeTimeoutMs = 100;
+
+        WebSocketServer server (options);
+        DAWINFO_CHECK (server.start (0, true));
+
+        WebSocketTestClient silent;
+        DAWINFO_CHECK (silent.open (server.getPort()));
+        DAWINFO_CHECK (waitFor ([&] { return server.getStats().rejected == 1; }));
+
+        WebSocketTestClient client;
+        DAWINFO_CHECK (client.connect (server.getPort()));
+        DAWINFO_CHECK (waitFor ([&] { return server.getStats().clients == 1; }));
+        server.stop();
+    }
+
+    /** A client that pings without reading the pongs: the server stops
+        reading it rather than buffering a pong per ping.
+    */
+    void testPingFlood()
+    {
+        WebSocketServer server;
+        DAWINFO_CHECK (server.start (0, true));
+        WebSocketTestClient client;
+        DAWINFO_CHECK (client.connect (server.getPort(), 4096));
+        DAWINFO_CHECK (waitFor ([&] { return server.getStats().clients == 1; }));
+
+        // More pongs, at the largest control payload, than any socket buffer
+        // holds. Each ping starts with its index.
+        constexpr int numPings = 50000;
+        constexpr std::size_t bodySize = 125;
+        websocket::FrameHeader header;
+        header.opcode = websocket::ping;
+        header.masked = true;
+        header.payloadSize = bodySize;
+
+        std::uint8_t headerBytes[websocket::maxHeaderSize];
+        const auto headerSize = static_cast<std::size_t> (websocket::writeFrameHeader (headerBytes, header));
+        const auto pingSize = headerSize + bodySize;
+        std::vector<std::uint8_t> pings;
+
+        for (int i = 0; i < numPings; ++i)
+        {
+            pings.insert (pings.end(), headerBytes, headerBytes + headerSize);
+            const auto bodyStart = pings.size();
+            pings.resize (bodyStart + bodySize, 'p');
+            std::memcpy (pings.data() + bodyStart, &i, sizeof (i));
+        }
+
+        // Send without blocking while the server takes them.
+        std::size_t sent = 0;
+        auto idleSince = monotonicNowNs();
+
+        while (sent < pings.size() && monotonicNowNs() - idleSince < 500'000'000)
+        {
+            const auto n = ::send (client.getFd(), pings.data() + sent, pings.size() - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+            if (n > 0)
+            {
+                sent += static_cast<std::size_t> (n);
+                idleSince = monotonicNowNs();
+            }
+            else
+            {
+                std::this_thread::sleep_for (std::chrono::milliseconds (5));
+            }
+        }
+
+        const auto pingsSent = static_cast<int> (sent / pingSize);
+        DAWINFO_CHECK (pingsSent > 0);
+
+        // What comes back is the latest pong per read, not one per ping,
+        // ending with the one for the last whole ping sent.
+        websocket::FrameHeader h;
+        std::vector<std::uint8_t> payload;
+        int pongs = 0, lastPong = -1;
+
+        while (lastPong != pingsSent - 1 && client.receiveFrame (h, payload, 5000))
+        {
+            if (h.opcode == websocket::pong && payload.size() == bodySize)
+            {
+                std::memcpy (&lastPong, payload.data(), sizeof (lastPong));
+                ++pongs;
+            }
+        }
+
+        std::printf ("Ping flood: %d pongs for %d pings\n", pongs, pingsSent);
+        DAWINFO_CHECK (lastPong == pingsSent - 1);
+        DAWINFO_CHECK (pongs < pingsSent);
+        DAWINFO_CHECK (server.getStats().clients == 1);
+        server.stop();
+    }
+
+    /** A client that stops reading loses old frames, not the sender's time or
+        the other clients' frames, and gets the newest state when it resumes.
+    */
+    void testSlowClient()
+    {
+        WebSocketServer::Options options;
+        options.queueFrames = 4;
+        WebSocketServer server (options);
+        DAWINFO_CHECK (server.start (0, true));
+
+        WebSocketTestClient slow, fast;
+        DAWINFO_CHECK (slow.connect (server.getPort(), 4096));
+        DAWINFO_CHECK (fast.connect (server.getPort()));
+        DAWINFO_CHECK (waitFor ([&] { return server.getStats().clients == 2; }));
+
+        constexpr std::uint32_t numPackets = 1500;
+        std::uint32_t fastReceived = 0, fastLast = 0;
+        HostTimeNs worstSendNs = 0;
+
+        for (std::uint32_t i = 0; i < numPackets; ++i)
+        {
+            const auto packet = makePacket (i, 16384);
+            const auto t0 = monotonicNowNs();
+            server.send (packet.data(), packet.size());
+            worstSendNs = std::max (worstSendNs, monotonicNowNs() - t0);
+
+            // The fast client keeps up; the slow one reads nothing.
+            websocket::FrameHeader h;
+            std::vector<std::uint8_t> payload;
+
+            while (fast.receiveFrame (h, payload, i % 16 == 0 ? 1 : 0))
+            {
+                ++fastReceived;
+                fastLast = packetIndex (payload);
+            }
+        }
+
+        websocket::FrameHeader h;
+        std::vector<std::uint8_t> payload;
+
+        while (fast.receiveFrame (h, payload, 200))
+        {
+            ++fastReceived;
+            fastLast = packetIndex (payload);
+        }
+
+        // Now the slow client catches up: whatever it gets, the last is the newest.
+        std::uint32_t slowReceived = 0, slowLast = 0;
+
+        while (slow.receiveFrame (h, payload, 200))
+        {
+            ++slowReceived;
+            slowLast = packetIndex (payload);
+        }
+
+        const auto stats = server.getStats();
+        std::printf ("Slow client: %u of %u frames (%llu dropped), fast client %u; worst send() %.1f us\n",
+                     slowReceived, numPackets, static_cast<unsigned long long> (stats.framesDropped),
+                     fastReceived, worstSendNs / 1000.0);
+
+        DAWINFO_CHECK (stats.framesDropped > 0);
+        DAWINFO_CHECK (slowReceived < numPackets && slowLast == numPackets - 1);
+        DAWINFO_CHECK (fastLast == numPackets - 1 && fastReceived > slowReceived);
+        DAWINFO_CHECK (stats.clients == 2);
+
+        // Never waits on a socket: at worst a copy per client and a scheduling hiccup.
+        DAWINFO_CHECK (worstSendNs < 20'000'000);
+    }
+
+    /** With real streams, a client that stops reading keeps one transport
+        frame pending and every event, however much the sender sends.
+    */
+    void testSlowClientCoalesces()
+    {
+        WebSocketServer::Options options;
+        options.queueFrames = 256;
+        WebSocketServer server (options);
+        DAWINFO_CHECK (server.start (0, true));
+
+        WebSocketTestClient slow;
+        DAWINFO_CHECK (slow.connect (server.getPort(), 4096));
+        DAWINFO_CHECK (waitFor ([&] { return server.getStats().clients == 1; }));
+
+        StreamSequencer seq;
+        constexpr int numTransports = 2000, eventEvery = 20;
+        std::uint8_t buffer[1024];
+
+        for (int i = 0; i < numTransports; ++i)
+        {
+            // Padded out so the socket fills quickly.
+            OscWriter w (buffer, sizeof (buffer));
+            seq.beginPacket (w, StreamId::transport);
+            TransportSnapshot t;
+            t.timeNs = i;
+            schema::Codec<messages::Transport>::write (w, t);
+            const std::uint8_t padding[800] = {};
+            w.beginMessage ("/pad", "b");
+            w.addBlob (padding, sizeof (padding));
+            w.endMessage();
+            server.send (w.getData(), w.getSize());
+
+            if (i % eventEvery == 0)
+            {
+                OscWriter e (buffer, sizeof (buffer));
+                seq.beginPacket (e, StreamId::events);
+                writeEvent (e, { static_cast<std::uint32_t> (i / eventEvery), EventType::beat, i, 0.0f });
+                server.send (e.getData(), e.getSize());
+            }
+        }
+
+        websocket::FrameHeader h;
+        std::vector<std::uint8_t> payload;
+        std::uint32_t events = 0, transports = 0;
+        HostTimeNs lastTransport = -1;
+        bool inOrder = true;
+
+        while (slow.receiveFrame (h, payload, 200))
+        {
+            forEachOscMessage (payload.data(), payload.size(), [&] (const OscMessage& m)
+            {
+                TransportSnapshot t;
+                DiscreteEvent e;
+
+                if (schema::Codec<messages::Transport>::decode (m, t))
+                {
+                    lastTransport = t.timeNs;
+                    ++transports;
+                }
+                else if (decodeEvent (m, e))
+                {
+                    inOrder = inOrder && e.id == events;
+                    ++events;
+                }
+            });
+        }
+
+        std::printf ("Slow client, coalesced: %u of %d transport frames, %u of %d events\n",
+                     transports, numTransports, events, numTransports / eventEvery);
+
+        DAWINFO_CHECK (events == numTransports / eventEvery && inOrder);
+        DAWINFO_CHECK (transports < numTransports && lastTransport == numTransports - 1);
+        DAWINFO_CHECK (server.getStats().framesDropped == static_cast<std::uint64_t> (numTransports - transports));
+    }
+
+    /** The sender's cost per packet and the delivery latency with 50
+        dashboards connected, all read by one polling thread.
+    */
+    void testFanOut()
+    {
+        constexpr int numClients = 50, numPackets = 300;
+        constexpr std::size_t packetSize = 1024;
+
+        WebSocketServer server;
+        DAWINFO_CHECK (server.start (0, true));
+
+        std::vector<std::unique_ptr<WebSocketTestClient>> clients;
+
+        for (int i = 0; i < numClients; ++i)
+        {
+            clients.push_back (std::make_unique<WebSocketTestClient>());
+            DAWINFO_CHECK (clients.back()->connect (server.getPort()));
+        }
+
+        DAWINFO_CHECK (waitFor ([&] { return server.getStats().clients == numClients; }));
+
+        std::atomic<bool> sending { true };
+        std::vector<HostTimeNs> latencies;
+        latencies.reserve (static_cast<std::size_t> (numClients * numPackets));
+
+        std::thread reader ([&]
+        {
+            std::vector<pollfd> fds;
+
+            for (auto& c : clients)
+                fds.push_back ({ c->getFd(), POLLIN, 0 });
+
+            HostTimeNs quietSince = 0;
+
+            for (;;)
+            {
+                const int ready = ::poll (fds.data(), static_cast<nfds_t> (fds.size()), 10);
+                const auto now = monotonicNowNs();
+
+                if (ready <= 0)
+                {
+                    if (sending.load())
+                        continue;
+
+                    if (quietSince == 0)
+                        quietSince = now;
+                    else if (now - quietSince > 200'000'000)
+                        break;
+
+                    continue;
+                }
+
+                quietSince = 0;
+
+                for (std::size_t i = 0; i < fds.size(); ++i)
+                {
+                    if ((fds[i].revents & POLLIN) == 0)
+                        continue;
+
+                    websocket::FrameHeader h;
+                    std::vector<std::uint8_t> payload;
+
+                    while (clients[i]->receiveFrame (h, payload, 0))
+                        latencies.push_back (monotonicNowNs() - packetSentNs (payload));
+                }
+            }
+        });
+
+        HostTimeNs sendNs = 0;
+
+        for (std::uint32_t i = 0; i < numPackets; ++i)
+        {
+            const auto packet = makePacket (i, packetSize);
+            const auto t0 = monotonicNowNs();
+            server.send (packet.data(), packet.size());
+            sendNs += monotonicNowNs() - t0;
+
+            // About a 500 Hz publish rate.
+            std::this_thread::sleep_for (std::chrono::milliseconds (2));
+        }
+
+        sending = false;
+        reader.join();
+
+        const auto stats = server.getStats();
+        const auto delivered = latencies.size();
+        std::sort (latencies.begin(), latencies.end());
+
+        const auto percentile = [&] (double p)
+        {
+            return latencies.empty() ? 0.0 : latencies[static_cast<std::size_t> (p * static_cast<double> (latencies.size() - 1))] / 1000.0;
+        };
+
+        std::printf ("Fan-out to %d clients, %zu-byte packets: send() %.1f us/packet, "
+                     "delivered %zu of %d (%llu dropped), latency p50 %.0f us, p99 %.0f us\n",
+                     numClients, packetSize, sendNs / 1000.0 / numPackets, delivered, numClients * numPackets,
+                     static_cast<unsigned long long> (stats.framesDropped), percentile (0.5), percentile (0.99));
+
+        DAWINFO_CHECK (delivered + stats.framesDropped == static_cast<std::size_t> (numClients * numPackets));
+        DAWINFO_CHECK (delivered >= static_cast<std::size_t> (numClients * numPackets) * 9 / 10);
+        DAWINFO_CHECK (stats.framesSent == delivered);
+    }
+}
+
+int main()
+{
+    testProtocolHelpers();
+    testConfigKey();
+    testDelivery();
+    testRestart();
+    testHandshakeDeadline();
+    testPingFlood();
+    testSlowClient();
+    testSlowClientCoalesces();
+    testFanOut();
+    return dawinfo::test::finish ("WebSocketTests");
+}
@@ -0,0 +1,25 @@
+#include "Common/SchemaDocumentation.h"
+
+#include <fstream>
+#include <iostream>
+
+/*  Prints the OSC schema reference. With an argument, writes it to that file. */
+int main (int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        std::ofstream file (argv[1]);
+
+        if (! file)
+        {
+            std::cerr << "cannot write " << argv[1] << "\n";
+            return 1;
+        }
+
+        dawinfo::writeSchemaMarkdown (file);
+        return 0;
+    }
+
+    dawinfo::writeSchemaMarkdown (std::cout);
+    return 0;
+}
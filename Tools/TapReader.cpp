@@ -0,0 +1,89 @@
+#include "Receiver/AudioTapReader.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/*  Example audio tap client: attaches to a running sender's tap and prints
+    each channel's RMS level once a second, working on the shared rings in
+    place.
+
+        dawinfo_tap_reader /dawinfo_tap [seconds]
+*/
+int main (int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf (stderr, "usage: %s <tap name> [seconds]\n", argv[0]);
+        return 1;
+    }
+
+    dawinfo::AudioTapReader reader;
+
+    if (! reader.open (argv[1]))
+    {
+        std::fprintf (stderr, "cannot open audio tap %s\n", argv[1]);
+        return 1;
+    }
+
+    const int seconds = argc > 2 ? std::atoi (argv[2]) : 10;
+    const int numChannels = reader.getNumChannels();
+    const auto framesPerReport = static_cast<std::uint64_t> (reader.getSampleRate());
+
+    std::printf ("%s: %d channels at %.0f Hz, %u-frame ring\n",
+                 argv[1], numChannels, reader.getSampleRate(), reader.getCapacity());
+
+    std::vector<double> sumSquares (static_cast<std::size_t> (numChannels));
+    std::uint64_t framesInReport = 0;
+    int reports = 0;
+
+    while (reports < seconds)
+    {
+        const auto view = reader.acquire (4096);
+
+        if (view.numFrames == 0)
+        {
+            std::this_thread::sleep_for (std::chrono::milliseconds (5));
+            continue;
+        }
+
+        std::vector<double> partial (sumSquares.size());
+
+        for (int c = 0; c < numChannels; ++c)
+            for (std::uint32_t i = 0; i < view.numFrames; ++i)
+                partial[static_cast<std::size_t> (c)] += double (view.getChannel (c)[i]) * view.getChannel (c)[i];
+
+        // Only count what survived: the writer may have lapped us mid-sum.
+        if (! reader.release (view))
+            continue;
+
+        for (std::size_t c = 0; c < sumSquares.size(); ++c)
+            sumSquares[c] += partial[c];
+
+        framesInReport += view.numFrames;
+
+        if (framesInReport >= framesPerReport)
+        {
+            std::printf ("rms");
+
+            for (auto& s : sumSquares)
+            {
+                std::printf (" %7.2f dB", 10.0 * std::log10 (s / static_cast<double> (framesInReport) + 1.0e-20));
+                s = 0.0;
+            }
+
+            const auto stats = reader.getStats();
+            std::printf ("   (overruns %llu, frames lost %llu, underruns %llu)\n",
+                         static_cast<unsigned long long> (stats.overruns), static_cast<unsigned long long> (stats.framesLost),
+                         static_cast<unsigned long long> (stats.underruns));
+
+            framesInReport = 0;
+            ++reports;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""Compares two dawinfo_benchmarks JSON files.
+
+    compare_benchmarks.py <baseline.json> <current.json> [--tolerance 0.25]
+
+Prints one line per benchmark and exits with 1 if any got slower than the
+baseline by more than the tolerance (a fraction: 0.25 is 25%). Benchmarks
+missing from either file are listed but don't fail the comparison.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+
+    return {b["name"]: b for b in data.get("benchmarks", [])}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flags benchmark regressions against a baseline.")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--tolerance", type=float, default=0.25,
+                        help="allowed slowdown as a fraction of the baseline (default 0.25)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = []
+
+    print(f"{'benchmark':<36} {'baseline':>12} {'current':>12} {'change':>8}")
+
+    for name in sorted(set(baseline) | set(current)):
+        if name not in current:
+            print(f"{name:<36} {'':>12} {'missing':>12}")
+            continue
+
+        if name not in baseline:
+            print(f"{name:<36} {'new':>12} {current[name]['ns_per_op']:>12.1f}")
+            continue
+
+        before = baseline[name]["ns_per_op"]
+        after = current[name]["ns_per_op"]
+        change = (after - before) / before if before > 0 else 0.0
+        flag = ""
+
+        if change > args.tolerance:
+            flag = "  REGRESSION"
+            regressions.append(name)
+        elif change < -args.tolerance:
+            flag = "  faster"
+
+        print(f"{name:<36} {before:>12.1f} {after:>12.1f} {change:>+7.0%}{flag}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than the baseline by more than {args.tolerance:.0%}")
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())